@@ -0,0 +1,634 @@
+#include "gpcheckcloud.h"
+
+bool hasHeader;
+
+char eolString[EOL_CHARS_MAX_LEN + 1] = "\n";  // LF by default
+
+string s3extErrorMessage;
+
+volatile bool QueryCancelPending = false;
+
+static bool uploadS3(const char *urlWithOptions, const char *fileToUpload);
+static bool downloadS3(const char *urlWithOptions);
+static bool checkConfig(const char *urlWithOptions);
+static bool benchmarkS3(const char *urlWithOptions);
+static void printBucketContents(const ListBucketResult &result);
+static void printTemplate();
+static void validateCommandLineArgs(map<char, string> &optionPairs);
+static map<char, string> parseCommandLineArgs(int argc, char *argv[]);
+static void registerSignalHandler();
+static void printUsage(FILE *stream);
+
+// As we can't catch 'IsAbortInProgress()' in UT, so here consider QueryCancelPending only
+bool S3QueryIsAbortInProgress(void) {
+    return QueryCancelPending;
+}
+
+void MaskThreadSignals() {
+}
+
+void *S3Alloc(size_t size) {
+    return malloc(size);
+}
+
+void S3Free(void *p) {
+    free(p);
+}
+
+static void handleAbortSignal(int signum) {
+    fprintf(stderr, "Interrupted by user (%s), exiting...\n\n", strsignal(signum));
+    QueryCancelPending = true;
+}
+
+static void registerSignalHandler() {
+    signal(SIGHUP, handleAbortSignal);
+    signal(SIGABRT, handleAbortSignal);
+    signal(SIGTERM, handleAbortSignal);
+    signal(SIGINT, handleAbortSignal);
+    signal(SIGTSTP, handleAbortSignal);
+}
+
+static void printUsage(FILE *stream) {
+    fprintf(stream,
+            "Usage: gpcheckcloud -c \"s3://endpoint/bucket/prefix "
+            "config=path_to_config_file [region=region_name]\", to check the configuration.\n"
+            "       gpcheckcloud -d \"s3://endpoint/bucket/prefix "
+            "config=path_to_config_file [region=region_name]\", to download and output to stdout.\n"
+            "       gpcheckcloud -u \"/path/to/file\" \"s3://endpoint/bucket/prefix "
+            "config=path_to_config_file [region=region_name]\", to upload a file.\n"
+            "       gpcheckcloud -b \"s3://endpoint/bucket/prefix "
+            "config=path_to_config_file [region=region_name] [threads=1,2,4,8] "
+            "[chunksizes=8388608,67108864] [size=268435456]\", to benchmark listing, "
+            "downloading and uploading.\n"
+            "       gpcheckcloud -t, to show the config template.\n"
+            "       gpcheckcloud -h, to show this help.\n");
+}
+
+// parse the arguments into char-string value pairs
+static map<char, string> parseCommandLineArgs(int argc, char *argv[]) {
+    int opt = 0;
+    map<char, string> optionPairs;
+
+    while ((opt = getopt(argc, argv, "b:c:d:u:ht")) != -1) {
+        switch (opt) {
+            case 'b':
+            case 'c':
+            case 'd':
+            case 'h':
+            case 't':
+                if (optarg == NULL) {
+                    optionPairs[opt] = "";
+                } else if (optarg[0] == '-') {
+                    fprintf(stderr, "Failed. Invalid argument for -%c: '%s'.\n\n", opt, optarg);
+                    printUsage(stderr);
+                    exit(EXIT_FAILURE);
+                } else {
+                    optionPairs[opt] = optarg;
+                }
+
+                break;
+            case 'u':
+                if (optarg == NULL) {
+                    optionPairs[opt] = "";
+                } else if (optind + 1 == argc) {      // has two option values
+                    optionPairs['f'] = optarg;        // value of option file
+                    optionPairs['u'] = argv[optind];  // value of option url
+                } else {
+                    fprintf(stderr, "Failed. Invalid arguments for -u, please check.\n\n");
+                    printUsage(stderr);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+
+            default:  // '?'
+                printUsage(stderr);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    return optionPairs;
+}
+
+// check if command line arguments are valid
+static void validateCommandLineArgs(map<char, string> &optionPairs) {
+    uint64_t count = optionPairs.count('f') + optionPairs.count('u');
+
+    if ((count == 2) && (optionPairs.size() == 2)) {
+        return;
+    } else if (count == 1) {
+        fprintf(stderr, "Failed. Option \'-u\' must work with \'-f\'.\n\n");
+        printUsage(stderr);
+        exit(EXIT_FAILURE);
+    }
+
+    if (optionPairs.size() > 1) {
+        stringstream ss;
+
+        ss << "Failed. Can't set options ";
+
+        // concatenate all option names
+        // e.g. if we have -c and -d, insert "-c, -d" into the stream.
+        for (map<char, string>::iterator i = optionPairs.begin(); i != optionPairs.end(); i++) {
+            ss << "'-" << i->first << "' ";
+        }
+
+        ss << "at the same time.";
+
+        // example message: "Failed. Can't set options '-c' '-d' at the same time."
+        fprintf(stderr, "%s\n\n", ss.str().c_str());
+        printUsage(stderr);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void printTemplate() {
+    printf(
+        "[default]\n"
+        "secret = \"aws secret\"\n"
+        "accessid = \"aws access id\"\n"
+        "threadnum = 4\n"
+        "chunksize = 67108864\n"
+        "low_speed_limit = 10240\n"
+        "low_speed_time = 60\n"
+        "encryption = true\n"
+        "version = 1\n"
+        "proxy = \"\"\n"
+        "autocompress = true\n"
+        "verifycert = true\n"
+        "server_side_encryption = \"\"\n"
+        "# gpcheckcloud config\n"
+        "gpcheckcloud_newline = \"\\n\"\n");
+}
+
+static void printBucketContents(const ListBucketResult &result) {
+    char urlbuf[256];
+    vector<BucketContent>::const_iterator i;
+
+    for (i = result.contents.begin(); i != result.contents.end(); i++) {
+        snprintf(urlbuf, 256, "%s", i->getName().c_str());
+        printf("File: %s, Size: %" PRIu64 "\n", urlbuf, i->getSize());
+    }
+}
+
+static bool checkConfig(const char *urlWithOptions) {
+    if (!urlWithOptions) {
+        return false;
+    }
+
+    GPReader *reader = reader_init(urlWithOptions);
+    if (!reader) {
+        return false;
+    }
+
+    ListBucketResult result = reader->getKeyList();
+
+    if (result.contents.empty()) {
+        fprintf(stderr,
+                "\nYour configuration works well, however there is no file matching your "
+                "prefix.\n");
+    } else {
+        printBucketContents(result);
+        fprintf(stderr, "\nYour configuration works well.\n");
+    }
+
+    reader_cleanup(&reader);
+
+    return true;
+}
+
+static bool downloadS3(const char *urlWithOptions) {
+    if (!urlWithOptions) {
+        return false;
+    }
+
+    int data_len = BUF_SIZE;
+    char data_buf[BUF_SIZE];
+    bool ret = true;
+
+    thread_setup();
+
+    GPReader *reader = reader_init(urlWithOptions);
+    if (!reader) {
+        return false;
+    }
+
+    strncpy(eolString, reader->getParams().getGpcheckcloud_newline().c_str(), EOL_CHARS_MAX_LEN);
+    eolString[EOL_CHARS_MAX_LEN] = '\0';
+
+    do {
+        data_len = BUF_SIZE;
+
+        if (!reader_transfer_data(reader, data_buf, data_len)) {
+            fprintf(stderr, "Failed to read data from Amazon S3\n");
+            ret = false;
+            break;
+        }
+
+        fwrite(data_buf, (size_t)data_len, 1, stdout);
+    } while (data_len && !S3QueryIsAbortInProgress());
+
+    reader_cleanup(&reader);
+
+    thread_cleanup();
+
+    return ret;
+}
+
+static bool uploadS3(const char *urlWithOptions, const char *fileToUpload) {
+    if (!urlWithOptions) {
+        return false;
+    }
+
+    size_t data_len = BUF_SIZE;
+    char data_buf[BUF_SIZE];
+    size_t read_len = 0;
+    bool ret = true;
+
+    thread_setup();
+
+    GPWriter *writer = writer_init(urlWithOptions);
+    if (!writer) {
+        return false;
+    }
+
+    FILE *fd = fopen(fileToUpload, "r");
+    if (fd == NULL) {
+        fprintf(stderr, "File does not exist\n");
+        ret = false;
+    } else {
+        do {
+            read_len = fread(data_buf, 1, data_len, fd);
+
+            if (read_len == 0) {
+                break;
+            }
+
+            if (!writer_transfer_data(writer, data_buf, (int)read_len)) {
+                fprintf(stderr, "Failed to write data to Amazon S3\n");
+                ret = false;
+                break;
+            }
+        } while (read_len == data_len && !S3QueryIsAbortInProgress());
+
+        if (ferror(fd)) {
+            ret = false;
+        }
+
+        fclose(fd);
+    }
+
+    writer_cleanup(&writer);
+
+    thread_cleanup();
+
+    return ret;
+}
+
+static uint64_t nowInMicroseconds() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+// Parse a comma separated list of numbers, return defaultValues if it is empty.
+static vector<uint64_t> parseNumberList(const string &list, const vector<uint64_t> &defaultValues) {
+    vector<uint64_t> values;
+
+    stringstream ss(list);
+    string item;
+    while (std::getline(ss, item, ',')) {
+        uint64_t value = strtoull(item.c_str(), NULL, 10);
+        if (value > 0) {
+            values.push_back(value);
+        }
+    }
+
+    return values.empty() ? defaultValues : values;
+}
+
+// A benchmark run, requests are taken by threads one at a time.
+struct BenchmarkRun {
+    BenchmarkRun(S3Interface *s3Interface, uint64_t numOfRequests)
+        : s3Interface(s3Interface), numOfRequests(numOfRequests), nextRequest(0), bytes(0),
+          failed(false) {
+        pthread_mutex_init(&this->mutex, NULL);
+    }
+    ~BenchmarkRun() {
+        pthread_mutex_destroy(&this->mutex);
+    }
+
+    // Take the next request, return false if there is none left.
+    bool takeRequest(uint64_t &request) {
+        UniqueLock lock(&this->mutex);
+        if (this->nextRequest >= this->numOfRequests || this->failed ||
+            S3QueryIsAbortInProgress()) {
+            return false;
+        }
+        request = this->nextRequest++;
+        return true;
+    }
+
+    void finishRequest(uint64_t startTime, uint64_t requestBytes) {
+        uint64_t latency = nowInMicroseconds() - startTime;
+
+        UniqueLock lock(&this->mutex);
+        this->latencies.push_back(latency);
+        this->bytes += requestBytes;
+    }
+
+    void fail(const string &message) {
+        UniqueLock lock(&this->mutex);
+        if (!this->failed) {
+            this->failed = true;
+            this->error = message;
+        }
+    }
+
+    S3Interface *s3Interface;
+    uint64_t numOfRequests;
+
+    // Download requests, or the key to upload to in urls[0]
+    vector<S3Url> urls;
+    vector<uint64_t> offsets;
+    vector<uint64_t> lengths;
+
+    // Upload requests
+    string uploadId;
+    uint64_t partSize;
+    map<uint64_t, string> etags;
+
+    pthread_mutex_t mutex;
+    uint64_t nextRequest;
+    vector<uint64_t> latencies;  // microseconds
+    uint64_t bytes;
+    bool failed;
+    string error;
+};
+
+static void *downloadThreadFunc(void *p) {
+    BenchmarkRun *run = static_cast<BenchmarkRun *>(p);
+
+    uint64_t i;
+    while (run->takeRequest(i)) {
+        try {
+            S3VectorUInt8 data;
+            uint64_t startTime = nowInMicroseconds();
+            run->s3Interface->fetchData(run->offsets[i], data, run->lengths[i], run->urls[i]);
+            run->finishRequest(startTime, data.size());
+        } catch (S3Exception &e) {
+            run->fail(e.getMessage());
+        }
+    }
+
+    return NULL;
+}
+
+static void *uploadThreadFunc(void *p) {
+    BenchmarkRun *run = static_cast<BenchmarkRun *>(p);
+
+    S3VectorUInt8 data;
+    for (uint64_t i = 0; i < run->partSize; i++) {
+        data.push_back('a' + i % 26);
+    }
+
+    uint64_t i;
+    while (run->takeRequest(i)) {
+        try {
+            uint64_t startTime = nowInMicroseconds();
+            string etag =
+                run->s3Interface->uploadPartOfData(data, run->urls[0], i + 1, run->uploadId);
+            run->finishRequest(startTime, data.size());
+
+            UniqueLock lock(&run->mutex);
+            run->etags[i + 1] = etag;
+        } catch (S3Exception &e) {
+            run->fail(e.getMessage());
+        }
+    }
+
+    return NULL;
+}
+
+// Run the requests of run by numOfThreads threads, return seconds taken.
+static double runBenchmark(BenchmarkRun &run, uint64_t numOfThreads, void *(*func)(void *)) {
+    uint64_t startTime = nowInMicroseconds();
+
+    vector<pthread_t> threads(numOfThreads);
+    for (uint64_t i = 0; i < numOfThreads; i++) {
+        pthread_create(&threads[i], NULL, func, &run);
+    }
+    for (uint64_t i = 0; i < numOfThreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    return (nowInMicroseconds() - startTime) / 1000000.0;
+}
+
+static double percentile(const vector<uint64_t> &sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = (size_t)(p / 100 * (sorted.size() - 1) + 0.5);
+    return sorted[index] / 1000.0;
+}
+
+static void printBenchmarkHeader() {
+    printf("%-10s %9s %11s %9s %10s %10s %10s %10s %10s\n", "operation", "threadnum", "chunksize",
+           "requests", "MB/s", "p50 ms", "p90 ms", "p99 ms", "max ms");
+}
+
+static void printBenchmarkResult(const char *operation, uint64_t numOfThreads, uint64_t chunkSize,
+                                 BenchmarkRun &run, double seconds) {
+    if (run.failed) {
+        printf("%-10s %9" PRIu64 " %11" PRIu64 " failed: %s\n", operation, numOfThreads, chunkSize,
+               run.error.c_str());
+        return;
+    }
+
+    std::sort(run.latencies.begin(), run.latencies.end());
+    double throughput = seconds > 0 ? run.bytes / seconds / 1024 / 1024 : 0;
+
+    printf("%-10s %9" PRIu64 " %11" PRIu64 " %9zu %10.1f %10.1f %10.1f %10.1f %10.1f\n", operation,
+           numOfThreads, chunkSize, run.latencies.size(), throughput,
+           percentile(run.latencies, 50), percentile(run.latencies, 90),
+           percentile(run.latencies, 99), percentile(run.latencies, 100));
+    fflush(stdout);
+}
+
+// Download up to size bytes of the keys listed, in ranges of chunkSize.
+static void benchmarkDownload(S3Interface &s3Interface, S3Params &params,
+                              const ListBucketResult &keyList, uint64_t numOfThreads,
+                              uint64_t chunkSize, uint64_t size) {
+    BenchmarkRun run(&s3Interface, 0);
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < keyList.contents.size() && total < size; i++) {
+        string keyEncoded = UriEncode(keyList.contents[i].getName());
+        FindAndReplace(keyEncoded, "%2F", "/");
+        S3Url keyUrl = params.setPrefix(keyEncoded).getS3Url();
+
+        uint64_t keySize = keyList.contents[i].getSize();
+        for (uint64_t offset = 0; offset < keySize && total < size; offset += chunkSize) {
+            uint64_t length = std::min(std::min(chunkSize, keySize - offset), size - total);
+            run.urls.push_back(keyUrl);
+            run.offsets.push_back(offset);
+            run.lengths.push_back(length);
+            total += length;
+        }
+    }
+    run.numOfRequests = run.offsets.size();
+
+    double seconds = runBenchmark(run, numOfThreads, downloadThreadFunc);
+    printBenchmarkResult("download", numOfThreads, chunkSize, run, seconds);
+}
+
+// Upload size bytes in parts of chunkSize to a key under the prefix, then abort the upload, so
+// that nothing is left behind.
+static void benchmarkUpload(S3Interface &s3Interface, S3Params &params,
+                            uint64_t numOfThreads, uint64_t chunkSize, uint64_t size) {
+    BenchmarkRun run(&s3Interface, (size + chunkSize - 1) / chunkSize);
+
+    stringstream keyName;
+    keyName << params.getS3Url().getPrefix() << "gpcheckcloud_benchmark_" << getpid();
+    run.urls.push_back(params.setPrefix(keyName.str()).getS3Url());
+    run.partSize = chunkSize;
+
+    try {
+        run.uploadId = s3Interface.getUploadId(run.urls[0]);
+    } catch (S3Exception &e) {
+        run.fail(e.getMessage());
+    }
+
+    double seconds = 0;
+    if (!run.failed) {
+        seconds = runBenchmark(run, numOfThreads, uploadThreadFunc);
+
+        try {
+            s3Interface.abortUpload(run.urls[0], run.uploadId);
+        } catch (S3Exception &e) {
+            fprintf(stderr, "Failed to abort upload %s: %s\n", run.uploadId.c_str(),
+                    e.getMessage().c_str());
+        }
+    }
+
+    printBenchmarkResult("upload", numOfThreads, chunkSize, run, seconds);
+}
+
+// Measure listing, then downloading and uploading with every combination of the thread counts and
+// chunk sizes given, to tune threadnum and chunksize.
+static bool benchmarkS3(const char *urlWithOptions) {
+    if (!urlWithOptions) {
+        return false;
+    }
+
+    thread_setup();
+
+    bool ret = true;
+    try {
+        string options(urlWithOptions);
+        S3Params params = InitConfig(options);
+
+        vector<uint64_t> threadNums =
+            parseNumberList(GetOptS3(options, "threads"), vector<uint64_t>{1, 2, 4, 8});
+        vector<uint64_t> chunkSizes =
+            parseNumberList(GetOptS3(options, "chunksizes"), vector<uint64_t>{params.getChunkSize()});
+        uint64_t size = parseNumberList(GetOptS3(options, "size"), vector<uint64_t>{256 << 20})[0];
+
+        S3RESTfulService restfulService(params);
+        S3InterfaceService s3Service(params);
+        s3Service.setRESTfulService(&restfulService);
+        S3Interface &s3Interface = s3Service;
+
+        printBenchmarkHeader();
+
+        // Listing is done a few times, as it is usually much faster than a download.
+        ListBucketResult keyList;
+        BenchmarkRun listRun(&s3Interface, 0);
+        uint64_t listStartTime = nowInMicroseconds();
+        for (int i = 0; i < 5 && !S3QueryIsAbortInProgress(); i++) {
+            S3Url s3Url = params.getS3Url();
+            uint64_t startTime = nowInMicroseconds();
+            keyList = s3Interface.listBucket(s3Url);
+            listRun.finishRequest(startTime, 0);
+        }
+        printBenchmarkResult("list", 1, 0, listRun,
+                             (nowInMicroseconds() - listStartTime) / 1000000.0);
+        fprintf(stderr, "%zu files listed\n", keyList.contents.size());
+
+        for (size_t c = 0; c < chunkSizes.size() && !keyList.contents.empty(); c++) {
+            for (size_t t = 0; t < threadNums.size() && !S3QueryIsAbortInProgress(); t++) {
+                benchmarkDownload(s3Interface, params, keyList, threadNums[t], chunkSizes[c], size);
+            }
+        }
+
+        for (size_t c = 0; c < chunkSizes.size(); c++) {
+            for (size_t t = 0; t < threadNums.size() && !S3QueryIsAbortInProgress(); t++) {
+                benchmarkUpload(s3Interface, params, threadNums[t], chunkSizes[c], size);
+            }
+        }
+    } catch (S3Exception &e) {
+        fprintf(stderr, "Failed to benchmark: %s\n", e.getFullMessage().c_str());
+        ret = false;
+    }
+
+    thread_cleanup();
+
+    return ret;
+}
+
+int main(int argc, char *argv[]) {
+    bool ret = true;
+
+    s3ext_loglevel = EXT_ERROR;
+    s3ext_logtype = STDERR_LOG;
+
+    if (argc == 1) {
+        printUsage(stderr);
+        exit(EXIT_FAILURE);
+    }
+
+    /* Prepare to receive interrupts */
+    registerSignalHandler();
+
+    map<char, string> optionPairs = parseCommandLineArgs(argc, argv);
+
+    validateCommandLineArgs(optionPairs);
+
+    if (!optionPairs.empty()) {
+        const char *arg = optionPairs.begin()->second.c_str();
+
+        switch (optionPairs.begin()->first) {
+            case 'b':
+                ret = benchmarkS3(arg);
+                break;
+            case 'c':
+                ret = checkConfig(arg);
+                break;
+            case 'd':
+                ret = downloadS3(arg);
+                break;
+            case 'u':
+            case 'f':
+                ret = uploadS3(optionPairs['u'].c_str(), optionPairs['f'].c_str());
+                break;
+            case 'h':
+                printUsage(stdout);
+                break;
+            case 't':
+                printTemplate();
+                break;
+            default:
+                printUsage(stderr);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    // Abort should not print the failed info
+    if (ret || S3QueryIsAbortInProgress()) {
+        exit(EXIT_SUCCESS);
+    } else {
+        fprintf(stderr, "Failed. Please check the arguments and configuration file.\n\n");
+        printUsage(stderr);
+        exit(EXIT_FAILURE);
+    }
+}
@@ -1,6 +1,8 @@
 #ifndef INCLUDE_COMPRESS_WRITER_H_
 #define INCLUDE_COMPRESS_WRITER_H_
 
+#include <deque>
+
 #include "s3common_headers.h"
 #include "s3exception.h"
 #include "s3macros.h"
@@ -9,6 +11,24 @@
 // 2MB by default
 extern uint64_t S3_ZIP_COMPRESS_CHUNKSIZE;
 
+// A block of input compressed into a gzip member of its own.
+struct CompressBlock {
+    CompressBlock() : status(Z_OK), done(false) {
+    }
+
+    vector<char> in;
+    vector<char> out;
+    int status;  // zlib status if compression failed
+    bool done;
+};
+
+// CompressWriter writes a gzip stream.
+//
+// With gzip_parallel, input is cut into blocks of S3_ZIP_COMPRESS_CHUNKSIZE,
+// which are compressed by threadnum threads, each into a gzip member of its
+// own, and written out in order. A concatenation of gzip members is a valid
+// gzip file, at the cost of a slightly bigger output, as no block refers to
+// data of the blocks before it.
 class CompressWriter : public Writer {
    public:
     CompressWriter();
@@ -30,12 +50,33 @@ class CompressWriter : public Writer {
     void flush();
     uint64_t writeOneChunk(const char *buf, uint64_t count);
 
+    static void *CompressThreadFunc(void *p);
+    static void compressBlock(CompressBlock &block, int level);
+
+    void startThreads(uint64_t numOfThreads);
+    void stopThreads();
+    void submitBlock();
+    void writeBlocks(size_t maxPending);
+
     Writer *writer;
 
     // zlib related variables.
     z_stream zstream;
     char *out;  // Output buffer for compression.
 
+    int level;
+
+    // Parallel compression, only used with more than one thread.
+    vector<pthread_t> threads;
+    pthread_mutex_t mutex;
+    pthread_cond_t cv;
+    bool stopping;
+
+    vector<char> pendingInput;             // Input of the next block.
+    std::deque<CompressBlock> blocks;      // Submitted blocks not written out, in order.
+    std::deque<CompressBlock *> todoList;  // Blocks waiting for a thread.
+    uint64_t numOfBlocks;                  // Blocks submitted since open().
+
     // add this flag to make close() reentrant
     bool isClosed;
 };
@@ -1,15 +1,38 @@
 #ifndef INCLUDE_DECOMPRESS_READER_H_
 #define INCLUDE_DECOMPRESS_READER_H_
 
+#include <deque>
+
 #include "reader.h"
 #include "s3common_headers.h"
 #include "s3exception.h"
+#include "s3interface.h"
 #include "s3macros.h"
 #include "s3params.h"
 
 // 2MB by default
 extern uint64_t S3_ZIP_DECOMPRESS_CHUNKSIZE;
 
+// Decoder decodes a compressed stream of one format, see newDecoder().
+class Decoder {
+   public:
+    virtual ~Decoder() {
+    }
+
+    // Decode data from in to out, in and out are advanced past the data consumed and produced.
+    // It may produce nothing, e.g. when only a header or a trailer is consumed. Concatenated
+    // streams are decoded one after another. Throw exception if encounters errors.
+    virtual void decode(const char *&in, uint64_t &inLen, char *&out, uint64_t &outLen) = 0;
+};
+
+// Throw exception if gpcloud is built without support of the type.
+Decoder *newDecoder(S3CompressionType type);
+
+// DecompressReader decompresses data of its upstream reader, gzip unless set otherwise.
+//
+// With decompress_thread, data is decompressed on a thread of its own, up to two blocks of
+// S3_ZIP_DECOMPRESS_CHUNKSIZE ahead of read(), so that decompressing overlaps with the caller
+// consuming data and with the upstream reader downloading.
 class DecompressReader : public Reader {
    public:
     DecompressReader();
@@ -21,27 +44,53 @@ class DecompressReader : public Reader {
     // Return 0 if EOF. Throw exception if encounters errors.
     virtual uint64_t read(char *buf, uint64_t count);
 
+    // Data lent stays in the output buffer until the next borrow(), release() has nothing to do.
+    virtual uint64_t borrow(const char **data, uint64_t count);
+
     // This should be reentrant, has no side effects when called multiple times.
     virtual void close();
 
     void setReader(Reader *reader);
 
+    void setCompressionType(S3CompressionType type) {
+        this->compressionType = type;
+    }
+
     void resizeDecompressReaderBuffer(uint64_t size);
 
    private:
-    void decompress();
+    // Decompress data into buf, return 0 if there is no more data to decompress.
+    uint64_t decompress(char *buf, uint64_t count);
 
-    uint64_t getDecompressedBytesNum() {
-        return S3_ZIP_DECOMPRESS_CHUNKSIZE - this->zstream.avail_out;
-    }
+    static void *DecompressThreadFunc(void *p);
+    void startThread();
+    void stopThread();
+    uint64_t borrowFromThread(const char **data, uint64_t count);
 
     Reader *reader;
 
-    // zlib related variables.
-    z_stream zstream;
-    char *in;            // Input buffer for decompression.
-    char *out;           // Output buffer for decompression.
-    uint64_t outOffset;  // Next position to read in out buffer.
+    S3CompressionType compressionType;
+    std::unique_ptr<Decoder> decoder;
+
+    const char *nextIn;   // Next position to decompress in data borrowed from upstream reader.
+    uint64_t availIn;     // Data left to decompress in data borrowed from upstream reader.
+    bool upstreamEnded;   // Upstream reader has no more data.
+    char *out;            // Output buffer for decompression.
+    uint64_t outBufSize;  // Size of out buffer, and of blocks of the decompression thread.
+    uint64_t outOffset;   // Next position to read in out buffer.
+    uint64_t outLen;      // Data decompressed in out buffer.
+
+    // Decompression thread, only used with decompress_thread.
+    bool hasThread;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cv;
+    bool stopping;
+    bool threadEnded;                       // No more blocks will come, at EOF or error.
+    std::exception_ptr threadException;     // Error of the thread, thrown by read().
+    std::deque<vector<char> > readyBlocks;  // Decompressed blocks, in order.
+    std::deque<vector<char> > freeBlocks;   // Blocks read already, kept for reuse.
+    vector<char> currentBlock;              // Block being read.
 
     bool isClosed;
 };
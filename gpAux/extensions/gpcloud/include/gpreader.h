@@ -23,6 +23,9 @@ class GPReader : public Reader {
     // Return 0 if EOF. Throw exception if encounters errors.
     virtual uint64_t read(char *buf, uint64_t count);
 
+    virtual uint64_t borrow(const char **data, uint64_t count);
+    virtual void release();
+
     // This should be reentrant, has no side effects when called multiple times.
     virtual void close();
 
@@ -40,6 +43,9 @@ class GPReader : public Reader {
     S3CommonReader commonReader;
     S3RESTfulService restfulService;
 
+    // Besides commonReader, to open the following keys ahead of reading.
+    vector<std::unique_ptr<S3CommonReader> > prefetchReaders;
+
     S3InterfaceService s3InterfaceService;
 
     // it links to itself by default
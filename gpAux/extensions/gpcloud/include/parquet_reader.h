@@ -0,0 +1,99 @@
+#ifndef INCLUDE_PARQUET_READER_H_
+#define INCLUDE_PARQUET_READER_H_
+
+#include "reader.h"
+#include "s3common_headers.h"
+#include "s3exception.h"
+#include "s3interface.h"
+#include "s3macros.h"
+#include "s3params.h"
+
+// The footer of a Parquet file is mostly within its last 64KB, which are fetched in one request.
+#define S3_PARQUET_FOOTER_PREFETCH_SIZE (64 * 1024)
+
+// Column chunks closer than this are fetched as one range, a request costs about as much time as
+// transferring that many bytes.
+#define S3_PARQUET_RANGE_MERGE_GAP (1024 * 1024)
+
+// A column chunk of a Parquet file, as described in its footer.
+struct ParquetColumnChunk {
+    string column;    // top level column the chunk belongs to
+    uint64_t offset;  // offset of its first page, the dictionary page if there is one
+    uint64_t length;
+};
+
+// Return the column chunks of the footer (FileMetaData in thrift compact protocol) of a Parquet
+// file. Throw S3RuntimeError if the footer is corrupted.
+vector<ParquetColumnChunk> ParseParquetFooter(const uint8_t *footer, uint64_t length);
+
+enum ParquetSegmentType {
+    PARQUET_SEGMENT_ZERO,   // left out, read as zeros
+    PARQUET_SEGMENT_FETCH,  // read by the upstream reader
+    PARQUET_SEGMENT_TAIL,   // fetched along with the footer already
+};
+
+struct ParquetSegment {
+    uint64_t offset;
+    uint64_t length;
+    ParquetSegmentType type;
+};
+
+// ParquetReader reads only the column chunks of the columns in the 'columns' option of a Parquet
+// file.
+//
+// It fetches the footer with a ranged GET first, then reads the byte ranges of the column chunks
+// needed with its upstream reader, one range at a time. What it reads has the size and the layout
+// of the file, with the column chunks left out as zeros, so that the footer is valid still for a
+// Parquet reader reading the chosen columns only. Keys not in Parquet format are read as a whole.
+class ParquetReader : public Reader {
+   public:
+    ParquetReader();
+    virtual ~ParquetReader();
+
+    virtual void open(const S3Params &params);
+
+    // read() attempts to read up to count bytes into the buffer.
+    // Return 0 if EOF. Throw exception if encounters errors.
+    virtual uint64_t read(char *buf, uint64_t count);
+
+    virtual uint64_t borrow(const char **data, uint64_t count);
+    virtual void release();
+
+    // This should be reentrant, has no side effects when called multiple times.
+    virtual void close();
+
+    void setReader(Reader *reader) {
+        this->reader = reader;
+    }
+
+    void setS3InterfaceService(S3Interface *s3Interface) {
+        this->s3Interface = s3Interface;
+    }
+
+    // Segments of the key opened, in order.
+    const vector<ParquetSegment> &getSegments() const {
+        return this->segments;
+    }
+
+   protected:
+    // Plan segments reading the chosen columns, return false if the key is not in Parquet format.
+    bool planSegments();
+    void fetchTail(uint64_t offset);
+    void nextSegment();
+
+    S3Params params;
+
+    S3Interface *s3Interface;
+    Reader *reader;  // Reads the fetched segments.
+    bool readerOpened;
+    bool borrowing;  // Data is borrowed from reader.
+
+    S3VectorUInt8 tail;  // Data of the key from tailOffset to its end, the footer included.
+    uint64_t tailOffset;
+
+    vector<ParquetSegment> segments;
+    uint64_t segmentIndex;   // Segment being read.
+    uint64_t segmentOffset;  // Bytes of it read.
+};
+
+#endif /* INCLUDE_PARQUET_READER_H_ */
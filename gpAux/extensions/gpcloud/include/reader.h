@@ -18,6 +18,26 @@ class Reader {
 
     // This should be reentrant, has no side effects when called multiple times.
     virtual void close() = 0;
+
+    // borrow() lends up to count bytes of data instead of copying them into a buffer as read()
+    // does, *data points to them until release(). Return 0 if EOF. Throw exception if encounters
+    // errors. Each borrow() is followed by a release() before the next borrow(), read() or
+    // close().
+    //
+    // By default data is read into a buffer of the reader, readers that hold data in memory
+    // already lend it directly.
+    virtual uint64_t borrow(const char **data, uint64_t count) {
+        this->borrowBuffer.resize(count);
+        *data = this->borrowBuffer.data();
+        return this->read(this->borrowBuffer.data(), count);
+    }
+
+    // This should be reentrant, has no side effects when called multiple times.
+    virtual void release() {
+    }
+
+   private:
+    vector<char> borrowBuffer;
 };
 
 #endif
@@ -1,12 +1,19 @@
 #ifndef __S3_BUCKET_READER__
 #define __S3_BUCKET_READER__
 
+#include <deque>
+
 #include "reader.h"
 #include "s3common_headers.h"
 #include "s3exception.h"
 #include "s3interface.h"
+#include "s3listing_cache.h"
 
 // S3BucketReader read multiple files in a bucket.
+//
+// Keys are assigned to segments by size, so that every segment reads about
+// the same amount of data. Keys bigger than split_size are split into byte
+// ranges first, each segment reads the lines starting in its ranges.
 class S3BucketReader : public Reader {
    public:
     S3BucketReader();
@@ -16,6 +23,9 @@ class S3BucketReader : public Reader {
     uint64_t read(char *buf, uint64_t count);
     void close();
 
+    uint64_t borrow(const char **data, uint64_t count);
+    void release();
+
     void setS3InterfaceService(S3Interface *s3) {
         this->s3Interface = s3;
     }
@@ -24,10 +34,33 @@ class S3BucketReader : public Reader {
         this->upstreamReader = reader;
     }
 
+    // With prefetch readers, the next keys of this segment are opened ahead of
+    // consumption, one reader per key, as long as their chunks fit in the
+    // threadnum chunks prepared in S3MemoryContext. It keeps the downloading
+    // threads busy when keys are smaller than a chunk. Without them, keys are
+    // opened one at a time with the upstream reader.
+    void setPrefetchReaders(const vector<Reader *> &readers) {
+        this->prefetchReaders = readers;
+        this->idleReaders = readers;
+    }
+
     const ListBucketResult &getKeyList() {
         return keyList;
     }
 
+    // A byte range of a key in keyList, the whole key unless it is split.
+    struct KeyPart {
+        uint64_t keyIndex;
+        uint64_t offset;
+        uint64_t length;
+        bool isSplit;
+    };
+
+    // Parts of keyList read by this segment, in the order of keyList.
+    const vector<KeyPart> &getKeyParts() {
+        return keyParts;
+    }
+
    private:
     S3Params params;
 
@@ -42,14 +75,53 @@ class S3BucketReader : public Reader {
     bool isFirstFile;
 
     // Skip the header line (terminated with eol) if necessary.
-    // copy valid data into buf and return its size.
-    uint64_t readWithoutHeaderLine(char *buf, uint64_t count);
+    // point data to valid data after it and return its size.
+    uint64_t readWithoutHeaderLine(char *buf, const char **data, uint64_t count);
+
+    // Read data into buf, or borrow it from upstream reader if buf is NULL.
+    uint64_t readData(char *buf, const char **data, uint64_t count);
+    uint64_t readUpstream(char *buf, const char **data, uint64_t count);
 
     ListBucketResult keyList;  // List of matched keys/files.
-    uint64_t keyIndex;         // BucketContent index of keylist->contents.
 
-    BucketContent &getNextKey();
-    S3Params constructReaderParams(BucketContent &key);
+    vector<KeyPart> keyParts;
+    uint64_t keyPartIndex;  // Next part of keyParts to open.
+
+    void assignKeyParts();
+    bool isSplittable(uint64_t keyIndex);
+
+    KeyPart &getNextKeyPart();
+    S3Params constructReaderParams(const KeyPart &part);
+
+    // Line alignment of the split part being read: the line crossing its
+    // start belongs to the previous part, and the line crossing its end is
+    // read to its end.
+    bool skippingLine;    // Dropping data up to the first line end.
+    bool lineEnded;       // Last byte read ends a line.
+    bool readingTail;     // Reading past the part, up to the first line end.
+    bool partEnded;       // Nothing more to read from the part.
+    uint64_t readEnd;     // End of the range the upstream reader is opened for.
+    KeyPart currentPart;  // Part being read.
+
+    void startPart(const KeyPart &part);
+    uint64_t readPart(char *buf, const char **data, uint64_t count);
+
+    struct OpenedKey {
+        Reader *reader;
+        KeyPart part;
+        uint64_t numOfChunks;
+    };
+
+    vector<Reader *> prefetchReaders;
+    vector<Reader *> idleReaders;
+    std::deque<OpenedKey> openedKeys;  // The key being read first, then the prefetched ones.
+    uint64_t usedChunks;               // Sum of numOfChunks of openedKeys.
+
+    // Point upstreamReader to the next key, return false if no key is left.
+    bool openNextKey();
+    void closeCurrentKey();
+    void prefetchKeys();
+    uint64_t getNumOfChunksForPart(const KeyPart &part);
 };
 
 #endif
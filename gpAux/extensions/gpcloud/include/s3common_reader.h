@@ -2,6 +2,7 @@
 #define INCLUDE_S3COMMON_READER_H_
 
 #include "decompress_reader.h"
+#include "parquet_reader.h"
 #include "s3common_headers.h"
 #include "s3exception.h"
 #include "s3key_reader.h"
@@ -21,6 +22,9 @@ class S3CommonReader : public Reader {
     // Return 0 if EOF. Throw exception if encounters errors.
     virtual uint64_t read(char* buf, uint64_t count);
 
+    virtual uint64_t borrow(const char** data, uint64_t count);
+    virtual void release();
+
     // This should be reentrant, has no side effects when called multiple times.
     virtual void close();
 
@@ -34,6 +38,7 @@ class S3CommonReader : public Reader {
     S3Interface* s3InterfaceService;
     S3KeyReader keyReader;
     DecompressReader decompressReader;
+    ParquetReader parquetReader;
 };
 
 #endif /* INCLUDE_S3COMMON_READER_H_ */
@@ -0,0 +1,60 @@
+#ifndef __S3_CURL_POOL_H__
+#define __S3_CURL_POOL_H__
+
+#include "s3common_headers.h"
+#include "s3exception.h"
+#include "s3macros.h"
+
+// S3CurlPool keeps idle curl easy handles of this process, keyed by endpoint
+// (scheme://host[:port]), so that a request can reuse the live connection of
+// an earlier request to the same endpoint instead of paying a new TCP and TLS
+// handshake. All handles share one DNS and TLS session cache through a curl
+// share handle.
+//
+// The pool is created on first use and lives until the process exits, it
+// holds its own reference on curl's global state. Create it from the main
+// thread (see S3RESTfulService), as curl_global_init() is not thread safe.
+class S3CurlPool {
+   public:
+    static S3CurlPool& getInstance();
+
+    // Returns a handle for url with default options, attached to the share.
+    CURL* acquire(const string& url);
+
+    // Gives back a handle from acquire(). It is kept for reuse for up to
+    // idleTimeout seconds, unless maxIdle handles of its endpoint are idle
+    // already.
+    void release(const string& url, CURL* handle, uint64_t maxIdle, uint64_t idleTimeout);
+
+    size_t getIdleCount(const string& url);
+
+    static string getEndpoint(const string& url);
+
+   private:
+    struct IdleHandle {
+        CURL* handle;
+        time_t expireAt;
+    };
+
+    S3CurlPool();
+    ~S3CurlPool();
+
+    // Not copyable.
+    S3CurlPool(const S3CurlPool&);
+    S3CurlPool& operator=(const S3CurlPool&);
+
+    void evictExpired(time_t now);
+
+    static void lockShare(CURL* handle, curl_lock_data data, curl_lock_access access, void* userp);
+    static void unlockShare(CURL* handle, curl_lock_data data, void* userp);
+
+    pthread_mutex_t poolLock;
+    pthread_mutex_t shareLocks[CURL_LOCK_DATA_LAST];
+
+    CURLSH* share;
+
+    // Most recently released handle last, it is the warmest one.
+    map<string, vector<IdleHandle> > idleHandles;
+};
+
+#endif
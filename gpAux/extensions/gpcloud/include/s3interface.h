@@ -18,6 +18,9 @@
 enum S3CompressionType {
     S3_COMPRESSION_GZIP,
     S3_COMPRESSION_PLAIN,
+    S3_COMPRESSION_ZSTD,
+    S3_COMPRESSION_LZ4,
+    S3_COMPRESSION_BZIP2,
 };
 
 struct BucketContent {
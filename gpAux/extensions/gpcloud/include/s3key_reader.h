@@ -74,8 +74,10 @@ class S3KeyReader : public Reader {
           curReadingChunk(0),
           transferredKeyLen(0),
           s3Interface(NULL),
+          lendingChunk(NULL),
           hasEol(false),
-          eolAppended(false) {
+          eolAppended(false),
+          readsToKeyEnd(true) {
         pthread_mutex_init(&this->mutexErrorMessage, NULL);
     }
     virtual ~S3KeyReader() {
@@ -87,6 +89,9 @@ class S3KeyReader : public Reader {
     uint64_t read(char* buf, uint64_t count);
     void close();
 
+    uint64_t borrow(const char** data, uint64_t count);
+    void release();
+
     void setS3InterfaceService(S3Interface* s3) {
         this->s3Interface = s3;
     }
@@ -160,10 +165,15 @@ class S3KeyReader : public Reader {
 
     S3Interface* s3Interface;
 
+    ChunkBuffer* lendingChunk;  // Chunk of the data lent by borrow().
+
     void reset();
 
     bool hasEol;
     bool eolAppended;
+
+    // A missing eol is appended only at the end of the key, not of a range before it.
+    bool readsToKeyEnd;
 };
 
 class ChunkBuffer {
@@ -189,6 +199,10 @@ class ChunkBuffer {
     uint64_t read(char* buf, uint64_t len);
     uint64_t fill();
 
+    // Same as read(), but lends data in chunkData until release() instead of copying it.
+    uint64_t borrow(const char** data, uint64_t len);
+    void release();
+
     void setS3InterfaceService(S3Interface* s3) {
         this->s3Interface = s3;
     }
@@ -233,6 +247,9 @@ class ChunkBuffer {
     uint64_t curChunkOffset;
     uint64_t chunkDataSize;
 
+    uint64_t lentLen;  // Data lent by borrow().
+    bool lentAll;      // borrow() lent all data left, the chunk is refilled on release().
+
     S3VectorUInt8 chunkData;
     OffsetMgr& offsetMgr;
     S3Interface* s3Interface;
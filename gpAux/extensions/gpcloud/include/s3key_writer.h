@@ -1,6 +1,8 @@
 #ifndef INCLUDE_S3KEY_WRITER_H_
 #define INCLUDE_S3KEY_WRITER_H_
 
+#include <deque>
+
 #include "s3common_headers.h"
 #include "s3exception.h"
 #include "s3interface.h"
@@ -8,9 +10,35 @@
 
 class WriterBuffer : public vector<uint8_t> {};
 
+// S3 allows up to 10000 parts in a multipart upload.
+#define S3_UPLOAD_MAX_PARTS 10000
+
+// Parts grow by chunksize every this many parts, see getPartSize().
+#define S3_UPLOAD_PARTS_PER_SIZE_STEP 1000
+
+// A failed part is uploaded again up to this many times, waiting twice as
+// long before each retry, starting from S3_UPLOAD_PART_RETRY_DELAY_MS.
+#define S3_UPLOAD_PART_MAX_RETRIES 3
+#define S3_UPLOAD_PART_RETRY_DELAY_MS 1000
+
+struct UploadPart {
+    uint64_t number;
+    S3VectorUInt8 data;
+};
+
+// S3KeyWriter uploads a key in parts, by a pool of threadnum upload threads
+// started by open(). Parts wait in a queue for a thread, no more than
+// threadnum parts are queued or being uploaded at a time, write() waits for
+// one of them to finish before queueing another.
 class S3KeyWriter : public Writer {
    public:
-    S3KeyWriter() : sharedError(false), s3Interface(NULL), partNumber(0), activeThreads(0) {
+    S3KeyWriter()
+        : sharedError(false),
+          s3Interface(NULL),
+          partNumber(0),
+          pendingParts(0),
+          stopping(false),
+          retryDelay(S3_UPLOAD_PART_RETRY_DELAY_MS) {
         pthread_mutex_init(&this->mutex, NULL);
         pthread_cond_init(&this->cv, NULL);
         pthread_mutex_init(&this->exceptionMutex, NULL);
@@ -20,6 +48,8 @@ class S3KeyWriter : public Writer {
             this->close();
         } catch (...) {
         }
+        this->stopThreads();
+
         pthread_mutex_destroy(&this->mutex);
         pthread_cond_destroy(&this->cv);
         pthread_mutex_destroy(&this->exceptionMutex);
@@ -32,6 +62,7 @@ class S3KeyWriter : public Writer {
     virtual uint64_t write(const char* buf, uint64_t count);
 
     // This should be reentrant, has no side effects when called multiple times.
+    // The upload is aborted if it fails to complete.
     virtual void close();
 
     void setS3InterfaceService(S3Interface* s3) {
@@ -41,8 +72,18 @@ class S3KeyWriter : public Writer {
    protected:
     static void* UploadThreadFunc(void* p);
 
+    void startThreads();
+    void stopThreads();
+    void waitForUploads();
+
+    string uploadPart(UploadPart& part);
+    static bool isRetryable(S3Exception& e);
+
+    uint64_t getPartSize() const;
+
     void flushBuffer();
     void completeKeyWriting();
+    void abortKeyWriting();
     void checkQueryCancelSignal();
 
     bool sharedError;
@@ -58,8 +99,13 @@ class S3KeyWriter : public Writer {
     vector<pthread_t> threadList;
     pthread_mutex_t mutex;
     pthread_cond_t cv;
-    uint64_t partNumber;
-    uint64_t activeThreads;
+    uint64_t partNumber;    // Parts queued since open().
+    uint64_t pendingParts;  // Parts queued or being uploaded.
+    bool stopping;
+
+    std::deque<UploadPart> todoList;  // Parts waiting for an upload thread, in order.
+
+    uint64_t retryDelay;  // milliseconds to wait before the first retry of a part
 
     S3Params params;
 };
@@ -0,0 +1,48 @@
+#ifndef __S3_LISTING_CACHE_H__
+#define __S3_LISTING_CACHE_H__
+
+#include "s3common_headers.h"
+#include "s3interface.h"
+#include "s3log.h"
+#include "s3macros.h"
+#include "s3utils.h"
+
+// S3ListingCache keeps bucket listings in files of a directory, one file per
+// location and access id, so that the segments on a host list a location once
+// and share the listing instead of each paging through it on its own.
+//
+// Listing a location is serialized by a lock file next to the listing. The
+// first segment to take the lock lists the bucket and saves the listing, the
+// others find it saved while they waited and read it. A saved listing is also
+// reused by later queries for ttl seconds after it is listed, with ttl 0 it is
+// only shared by the segments waiting for it.
+//
+// The cache is an optimization only, any error of it is logged and the bucket
+// is listed as if there were no cache.
+class S3ListingCache {
+   public:
+    // An empty dir disables the cache.
+    S3ListingCache(const string& dir, uint64_t ttl);
+
+    ListBucketResult listBucket(S3Interface* s3Interface, S3Url& s3Url, const S3Credential& cred);
+
+    static string getCacheKey(const S3Url& s3Url, const S3Credential& cred);
+
+    string getCachePath(const S3Url& s3Url, const S3Credential& cred) const {
+        return this->dir + "/" + getCacheKey(s3Url, cred);
+    }
+
+   private:
+    bool prepareDir();
+
+    // Load a listing finished after freshSince (microseconds since epoch).
+    bool load(const string& path, uint64_t freshSince, ListBucketResult& result);
+    void save(const string& path, const ListBucketResult& result, uint64_t listedAt);
+
+    static uint64_t now();
+
+    string dir;
+    uint64_t ttl;  // seconds a saved listing is reused for
+};
+
+#endif
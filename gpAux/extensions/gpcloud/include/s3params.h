@@ -13,12 +13,21 @@ class S3Params {
              const string& region = "")
         : s3Url(sourceUrl, useHttps, version, region),
           keySize(0),
+          keyRangeOffset(0),
+          keyRangeLength(0),
           chunkSize(0),
           numOfChunks(0),
+          splitSize(0),
           lowSpeedLimit(0),
           lowSpeedTime(0),
+          maxConnections(0),
+          connectionIdleTimeout(0),
+          listCacheTtl(0),
           debugCurl(false),
           autoCompress(false),
+          gzipParallel(false),
+          gzipLevel(Z_DEFAULT_COMPRESSION),
+          decompressThread(false),
           verifyCert(false),
           sseType(SSE_NONE) {
     }
@@ -70,6 +79,28 @@ class S3Params {
         this->keySize = size;
     }
 
+    uint64_t getKeyRangeOffset() const {
+        return keyRangeOffset;
+    }
+
+    uint64_t getKeyRangeLength() const {
+        return keyRangeLength;
+    }
+
+    // Read only length bytes of the key from offset, the whole key if length is 0.
+    void setKeyRange(uint64_t offset, uint64_t length) {
+        this->keyRangeOffset = offset;
+        this->keyRangeLength = length;
+    }
+
+    uint64_t getSplitSize() const {
+        return splitSize;
+    }
+
+    void setSplitSize(uint64_t splitSize) {
+        this->splitSize = splitSize;
+    }
+
     uint64_t getLowSpeedLimit() const {
         return lowSpeedLimit;
     }
@@ -86,6 +117,46 @@ class S3Params {
         this->lowSpeedTime = lowSpeedTime;
     }
 
+    uint64_t getMaxConnections() const {
+        return maxConnections;
+    }
+
+    void setMaxConnections(uint64_t maxConnections) {
+        this->maxConnections = maxConnections;
+    }
+
+    uint64_t getConnectionIdleTimeout() const {
+        return connectionIdleTimeout;
+    }
+
+    void setConnectionIdleTimeout(uint64_t connectionIdleTimeout) {
+        this->connectionIdleTimeout = connectionIdleTimeout;
+    }
+
+    const string& getListCacheDir() const {
+        return listCacheDir;
+    }
+
+    void setListCacheDir(const string& listCacheDir) {
+        this->listCacheDir = listCacheDir;
+    }
+
+    uint64_t getListCacheTtl() const {
+        return listCacheTtl;
+    }
+
+    void setListCacheTtl(uint64_t listCacheTtl) {
+        this->listCacheTtl = listCacheTtl;
+    }
+
+    const vector<string>& getColumns() const {
+        return columns;
+    }
+
+    void setColumns(const vector<string>& columns) {
+        this->columns = columns;
+    }
+
     bool isDebugCurl() const {
         return debugCurl;
     }
@@ -109,6 +180,30 @@ class S3Params {
         this->autoCompress = autoCompress;
     }
 
+    bool isGzipParallel() const {
+        return gzipParallel;
+    }
+
+    void setGzipParallel(bool gzipParallel) {
+        this->gzipParallel = gzipParallel;
+    }
+
+    int getGzipLevel() const {
+        return gzipLevel;
+    }
+
+    void setGzipLevel(int gzipLevel) {
+        this->gzipLevel = gzipLevel;
+    }
+
+    bool isDecompressThread() const {
+        return decompressThread;
+    }
+
+    void setDecompressThread(bool decompressThread) {
+        this->decompressThread = decompressThread;
+    }
+
     const S3MemoryContext& getMemoryContext() const {
         return memoryContext;
     }
@@ -150,18 +245,33 @@ class S3Params {
 
     uint64_t keySize;  // key/file size.
 
+    uint64_t keyRangeOffset;  // start of the byte range to read
+    uint64_t keyRangeLength;  // length of the byte range to read, 0 for the whole key
+
     S3Credential cred;  // S3 credential.
 
     uint64_t chunkSize;    // chunk size
     uint64_t numOfChunks;  // number of chunks(threads).
+    uint64_t splitSize;    // keys bigger than this are read by several segments, 0 disables it
 
     uint64_t lowSpeedLimit;  // low speed limit
     uint64_t lowSpeedTime;   // low speed timeout
 
+    uint64_t maxConnections;         // idle connections kept per endpoint, 0 disables reuse
+    uint64_t connectionIdleTimeout;  // seconds an idle connection is kept
+
+    string listCacheDir;    // directory of bucket listings shared by segments, empty disables it
+    uint64_t listCacheTtl;  // seconds a saved listing is reused by later queries
+
+    vector<string> columns;  // columns to read of Parquet keys, empty to read keys as a whole
+
     string proxy;  // proxy
 
-    bool debugCurl;     // debug curl or not
-    bool autoCompress;  // whether to compress data before uploading
+    bool debugCurl;         // debug curl or not
+    bool autoCompress;      // whether to compress data before uploading
+    bool gzipParallel;      // whether to compress blocks of data in threadnum threads
+    int gzipLevel;          // zlib compression level
+    bool decompressThread;  // whether to decompress data on a thread ahead of reading
     bool verifyCert;  // This option determines whether curl verifies the authenticity of the peer's
                       // certificate.
 
@@ -4,6 +4,7 @@
 #include "gpcommon.h"
 #include "restful_service.h"
 #include "s3common_headers.h"
+#include "s3curl_pool.h"
 #include "s3exception.h"
 #include "s3http_headers.h"
 #include "s3log.h"
@@ -31,6 +32,10 @@ class S3RESTfulService : public RESTfulService {
     uint64_t lowSpeedLimit;
     uint64_t lowSpeedTime;
 
+    // Connection reuse through S3CurlPool, disabled if maxConnections is 0.
+    uint64_t maxConnections;
+    uint64_t connectionIdleTimeout;
+
     string proxy;
 
     bool debugCurl;
@@ -2,8 +2,16 @@
 
 uint64_t S3_ZIP_COMPRESS_CHUNKSIZE = S3_ZIP_DEFAULT_CHUNKSIZE;
 
-CompressWriter::CompressWriter() : writer(NULL), isClosed(true) {
+CompressWriter::CompressWriter()
+    : writer(NULL),
+      level(Z_DEFAULT_COMPRESSION),
+      stopping(false),
+      numOfBlocks(0),
+      isClosed(true) {
     this->out = new char[S3_ZIP_COMPRESS_CHUNKSIZE];
+
+    pthread_mutex_init(&this->mutex, NULL);
+    pthread_cond_init(&this->cv, NULL);
 }
 
 CompressWriter::~CompressWriter() {
@@ -11,28 +19,39 @@ CompressWriter::~CompressWriter() {
         this->close();
     } catch (...) {
     }
+    this->stopThreads();
+
+    pthread_mutex_destroy(&this->mutex);
+    pthread_cond_destroy(&this->cv);
+
     delete this->out;
 }
 
 void CompressWriter::open(const S3Params& params) {
-    this->zstream.zalloc = Z_NULL;
-    this->zstream.zfree = Z_NULL;
-    this->zstream.opaque = Z_NULL;
-
-    // With S3_DEFLATE_WINDOWSBITS, it generates gzip stream with header and trailer
-    int ret = deflateInit2(&this->zstream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
-                           S3_DEFLATE_WINDOWSBITS, 8, Z_DEFAULT_STRATEGY);
+    this->level = params.getGzipLevel();
 
     this->isClosed = false;
 
-    // init them here to get ready for both writer() and close()
-    this->zstream.next_in = NULL;
-    this->zstream.avail_in = 0;
-    this->zstream.next_out = (Byte*)this->out;
-    this->zstream.avail_out = S3_ZIP_COMPRESS_CHUNKSIZE;
+    if (params.isGzipParallel() && params.getNumOfChunks() > 1) {
+        this->startThreads(params.getNumOfChunks());
+    } else {
+        this->zstream.zalloc = Z_NULL;
+        this->zstream.zfree = Z_NULL;
+        this->zstream.opaque = Z_NULL;
+
+        // With S3_DEFLATE_WINDOWSBITS, it generates gzip stream with header and trailer
+        int ret = deflateInit2(&this->zstream, this->level, Z_DEFLATED, S3_DEFLATE_WINDOWSBITS, 8,
+                               Z_DEFAULT_STRATEGY);
 
-    S3_CHECK_OR_DIE(ret == Z_OK, S3RuntimeError,
-                    string("Failed to initialize zlib library: ") + this->zstream.msg);
+        // init them here to get ready for both writer() and close()
+        this->zstream.next_in = NULL;
+        this->zstream.avail_in = 0;
+        this->zstream.next_out = (Byte*)this->out;
+        this->zstream.avail_out = S3_ZIP_COMPRESS_CHUNKSIZE;
+
+        S3_CHECK_OR_DIE(ret == Z_OK, S3RuntimeError,
+                        string("Failed to initialize zlib library: ") + this->zstream.msg);
+    }
 
     this->writer->open(params);
 }
@@ -43,6 +62,14 @@ uint64_t CompressWriter::writeOneChunk(const char* buf, uint64_t count) {
         return 0;
     }
 
+    if (!this->threads.empty()) {
+        this->pendingInput.insert(this->pendingInput.end(), buf, buf + count);
+        if (this->pendingInput.size() >= S3_ZIP_COMPRESS_CHUNKSIZE) {
+            this->submitBlock();
+        }
+        return count;
+    }
+
     this->zstream.next_in = (Byte*)buf;
     this->zstream.avail_in = count;
 
@@ -92,6 +119,28 @@ void CompressWriter::close() {
         return;
     }
 
+    if (!this->threads.empty()) {
+        // The last block, an empty one still makes a valid gzip file if there was no input.
+        if (!this->pendingInput.empty() || this->numOfBlocks == 0) {
+            this->submitBlock();
+        }
+
+        // Mark it closed first, the threads are gone even if writing out fails.
+        this->isClosed = true;
+        try {
+            this->writeBlocks(0);
+        } catch (...) {
+            this->stopThreads();
+            throw;
+        }
+        this->stopThreads();
+
+        S3DEBUG("Parallel compression finished.");
+
+        this->writer->close();
+        return;
+    }
+
     int status;
     do {
         status = deflate(&this->zstream, Z_FINISH);
@@ -123,3 +172,148 @@ void CompressWriter::flush() {
         this->zstream.avail_out = S3_ZIP_COMPRESS_CHUNKSIZE;
     }
 }
+
+// Compress block.in into a complete gzip member in block.out.
+void CompressWriter::compressBlock(CompressBlock& block, int level) {
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+
+    block.status =
+        deflateInit2(&stream, level, Z_DEFLATED, S3_DEFLATE_WINDOWSBITS, 8, Z_DEFAULT_STRATEGY);
+    if (block.status != Z_OK) {
+        return;
+    }
+
+    block.out.resize(deflateBound(&stream, block.in.size()));
+
+    stream.next_in = (Byte*)block.in.data();
+    stream.avail_in = block.in.size();
+    stream.next_out = (Byte*)block.out.data();
+    stream.avail_out = block.out.size();
+
+    // deflateBound() leaves room for all output, so it finishes in one call.
+    block.status = deflate(&stream, Z_FINISH);
+    block.out.resize(block.out.size() - stream.avail_out);
+    deflateEnd(&stream);
+
+    if (block.status == Z_STREAM_END) {
+        block.status = Z_OK;
+    } else if (block.status == Z_OK) {
+        block.status = Z_BUF_ERROR;
+    }
+
+    // Input is not needed anymore, release it before the block is written out.
+    vector<char>().swap(block.in);
+}
+
+void* CompressWriter::CompressThreadFunc(void* p) {
+    MaskThreadSignals();
+
+    CompressWriter* writer = static_cast<CompressWriter*>(p);
+
+    UniqueLock lock(&writer->mutex);
+    while (true) {
+        while (writer->todoList.empty() && !writer->stopping) {
+            pthread_cond_wait(&writer->cv, &writer->mutex);
+        }
+
+        if (writer->stopping) {
+            break;
+        }
+
+        CompressBlock* block = writer->todoList.front();
+        writer->todoList.pop_front();
+
+        pthread_mutex_unlock(&writer->mutex);
+        compressBlock(*block, writer->level);
+        pthread_mutex_lock(&writer->mutex);
+
+        block->done = true;
+        pthread_cond_broadcast(&writer->cv);
+    }
+
+    return NULL;
+}
+
+void CompressWriter::startThreads(uint64_t numOfThreads) {
+    this->stopping = false;
+    this->numOfBlocks = 0;
+
+    for (uint64_t i = 0; i < numOfThreads; i++) {
+        pthread_t thread;
+        pthread_create(&thread, NULL, CompressThreadFunc, this);
+        this->threads.push_back(thread);
+    }
+}
+
+// Stop the threads, and drop blocks not written out yet.
+void CompressWriter::stopThreads() {
+    if (this->threads.empty()) {
+        return;
+    }
+
+    {
+        UniqueLock lock(&this->mutex);
+        this->stopping = true;
+        pthread_cond_broadcast(&this->cv);
+    }
+
+    for (size_t i = 0; i < this->threads.size(); i++) {
+        pthread_join(this->threads[i], NULL);
+    }
+    this->threads.clear();
+
+    this->todoList.clear();
+    this->blocks.clear();
+    this->pendingInput.clear();
+}
+
+void CompressWriter::submitBlock() {
+    {
+        UniqueLock lock(&this->mutex);
+
+        this->blocks.emplace_back();
+        this->blocks.back().in.swap(this->pendingInput);
+        this->todoList.push_back(&this->blocks.back());
+        this->numOfBlocks++;
+
+        pthread_cond_signal(&this->cv);
+    }
+
+    this->pendingInput.reserve(S3_ZIP_COMPRESS_CHUNKSIZE);
+
+    // Keep a block in hand for each thread while the others are written out.
+    this->writeBlocks(this->threads.size() * 2);
+}
+
+// Write out blocks in order, until no more than maxPending blocks are left.
+void CompressWriter::writeBlocks(size_t maxPending) {
+    while (true) {
+        CompressBlock block;
+        {
+            UniqueLock lock(&this->mutex);
+
+            // Write out the blocks already done anyway, it costs nothing to wait for.
+            if (this->blocks.empty() ||
+                (this->blocks.size() <= maxPending && !this->blocks.front().done)) {
+                return;
+            }
+
+            while (!this->blocks.front().done) {
+                pthread_cond_wait(&this->cv, &this->mutex);
+            }
+
+            block.out.swap(this->blocks.front().out);
+            block.status = this->blocks.front().status;
+            this->blocks.pop_front();
+        }
+
+        S3_CHECK_OR_DIE(block.status == Z_OK, S3RuntimeError,
+                        string("Failed to compress data: ") +
+                            std::to_string((unsigned long long)block.status));
+
+        this->writer->write(block.out.data(), block.out.size());
+    }
+}
@@ -1,29 +1,255 @@
 #include "decompress_reader.h"
 
+#include <bzlib.h>
+
+#ifdef GPCLOUD_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef GPCLOUD_WITH_LZ4
+#include <lz4frame.h>
+#endif
+
 uint64_t S3_ZIP_DECOMPRESS_CHUNKSIZE = S3_ZIP_DEFAULT_CHUNKSIZE;
 
-DecompressReader::DecompressReader() : isClosed(true) {
+// Decoder of gzip and zlib streams.
+class GzipDecoder : public Decoder {
+   public:
+    GzipDecoder() {
+        // allocate inflate state for zlib
+        zstream.zalloc = Z_NULL;
+        zstream.zfree = Z_NULL;
+        zstream.opaque = Z_NULL;
+        zstream.next_in = Z_NULL;
+        zstream.avail_in = 0;
+
+        // with S3_INFLATE_WINDOWSBITS, it could recognize and decode both zlib and gzip stream.
+        int ret = inflateInit2(&zstream, S3_INFLATE_WINDOWSBITS);
+        S3_CHECK_OR_DIE(ret == Z_OK, S3RuntimeError, "failed to initialize zlib library");
+    }
+
+    virtual ~GzipDecoder() {
+        inflateEnd(&zstream);
+    }
+
+    virtual void decode(const char *&in, uint64_t &inLen, char *&out, uint64_t &outLen) {
+        zstream.next_in = (Byte *)in;
+        zstream.avail_in = inLen;
+        zstream.next_out = (Byte *)out;
+        zstream.avail_out = outLen;
+
+        int status = inflate(&zstream, Z_NO_FLUSH);
+
+        in = (const char *)zstream.next_in;
+        inLen = zstream.avail_in;
+        out = (char *)zstream.next_out;
+        outLen = zstream.avail_out;
+
+        if (status == Z_STREAM_END) {
+            S3DEBUG("Decompression finished: Z_STREAM_END.");
+
+            // A gzip file may have several members, e.g. written by parallel compression, get
+            // ready for the next one.
+            inflateReset(&zstream);
+        } else if (status == Z_BUF_ERROR) {
+            // No progress is possible without more input, not an error.
+        } else if (status < 0 || status == Z_NEED_DICT) {
+            S3_DIE(S3RuntimeError, string("Failed to decompress data: ") +
+                                       std::to_string((unsigned long long)status));
+        }
+    }
+
+   private:
+    z_stream zstream;
+};
+
+// Decoder of bzip2 streams.
+class Bzip2Decoder : public Decoder {
+   public:
+    Bzip2Decoder() : streamEnded(false) {
+        this->init();
+    }
+
+    virtual ~Bzip2Decoder() {
+        BZ2_bzDecompressEnd(&stream);
+    }
+
+    virtual void decode(const char *&in, uint64_t &inLen, char *&out, uint64_t &outLen) {
+        if (streamEnded) {
+            if (inLen == 0) {
+                return;
+            }
+
+            // Parallel bzip2 tools write a stream per block, start the next one.
+            BZ2_bzDecompressEnd(&stream);
+            this->init();
+        }
+
+        stream.next_in = (char *)in;
+        stream.avail_in = inLen;
+        stream.next_out = out;
+        stream.avail_out = outLen;
+
+        int status = BZ2_bzDecompress(&stream);
+
+        in = stream.next_in;
+        inLen = stream.avail_in;
+        out = stream.next_out;
+        outLen = stream.avail_out;
+
+        if (status == BZ_STREAM_END) {
+            S3DEBUG("Decompression finished: BZ_STREAM_END.");
+            streamEnded = true;
+        } else if (status != BZ_OK) {
+            S3_DIE(S3RuntimeError, string("Failed to decompress bzip2 data: ") +
+                                       std::to_string((long long)status));
+        }
+    }
+
+   private:
+    void init() {
+        memset(&stream, 0, sizeof(stream));
+
+        int ret = BZ2_bzDecompressInit(&stream, 0, 0);
+        S3_CHECK_OR_DIE(ret == BZ_OK, S3RuntimeError, "failed to initialize bzip2 library");
+
+        streamEnded = false;
+    }
+
+    bz_stream stream;
+    bool streamEnded;
+};
+
+#ifdef GPCLOUD_WITH_ZSTD
+// Decoder of zstd frames.
+class ZstdDecoder : public Decoder {
+   public:
+    ZstdDecoder() {
+        stream = ZSTD_createDStream();
+        S3_CHECK_OR_DIE(stream != NULL, S3RuntimeError, "failed to initialize zstd library");
+
+        size_t ret = ZSTD_initDStream(stream);
+        if (ZSTD_isError(ret)) {
+            ZSTD_freeDStream(stream);
+            S3_DIE(S3RuntimeError, "failed to initialize zstd library");
+        }
+    }
+
+    virtual ~ZstdDecoder() {
+        ZSTD_freeDStream(stream);
+    }
+
+    virtual void decode(const char *&in, uint64_t &inLen, char *&out, uint64_t &outLen) {
+        ZSTD_inBuffer input = {in, inLen, 0};
+        ZSTD_outBuffer output = {out, outLen, 0};
+
+        size_t ret = ZSTD_decompressStream(stream, &output, &input);
+        S3_CHECK_OR_DIE(!ZSTD_isError(ret), S3RuntimeError,
+                        string("Failed to decompress zstd data: ") + ZSTD_getErrorName(ret));
+
+        in += input.pos;
+        inLen -= input.pos;
+        out += output.pos;
+        outLen -= output.pos;
+    }
+
+   private:
+    ZSTD_DStream *stream;
+};
+#endif
+
+#ifdef GPCLOUD_WITH_LZ4
+// Decoder of lz4 frames.
+class Lz4Decoder : public Decoder {
+   public:
+    Lz4Decoder() {
+        LZ4F_errorCode_t ret = LZ4F_createDecompressionContext(&context, LZ4F_VERSION);
+        S3_CHECK_OR_DIE(!LZ4F_isError(ret), S3RuntimeError, "failed to initialize lz4 library");
+    }
+
+    virtual ~Lz4Decoder() {
+        LZ4F_freeDecompressionContext(context);
+    }
+
+    virtual void decode(const char *&in, uint64_t &inLen, char *&out, uint64_t &outLen) {
+        size_t srcSize = inLen;
+        size_t dstSize = outLen;
+
+        size_t ret = LZ4F_decompress(context, out, &dstSize, in, &srcSize, NULL);
+        S3_CHECK_OR_DIE(!LZ4F_isError(ret), S3RuntimeError,
+                        string("Failed to decompress lz4 data: ") + LZ4F_getErrorName(ret));
+
+        in += srcSize;
+        inLen -= srcSize;
+        out += dstSize;
+        outLen -= dstSize;
+    }
+
+   private:
+    LZ4F_dctx *context;
+};
+#endif
+
+Decoder *newDecoder(S3CompressionType type) {
+    switch (type) {
+        case S3_COMPRESSION_GZIP:
+            return new GzipDecoder();
+        case S3_COMPRESSION_BZIP2:
+            return new Bzip2Decoder();
+#ifdef GPCLOUD_WITH_ZSTD
+        case S3_COMPRESSION_ZSTD:
+            return new ZstdDecoder();
+#else
+        case S3_COMPRESSION_ZSTD:
+            S3_DIE(S3RuntimeError, "zstd compressed file found, gpcloud is built without zstd");
+#endif
+#ifdef GPCLOUD_WITH_LZ4
+        case S3_COMPRESSION_LZ4:
+            return new Lz4Decoder();
+#else
+        case S3_COMPRESSION_LZ4:
+            S3_DIE(S3RuntimeError, "lz4 compressed file found, gpcloud is built without lz4");
+#endif
+        default:
+            S3_DIE(S3RuntimeError, "unknown compression type");
+    }
+}
+
+DecompressReader::DecompressReader()
+    : compressionType(S3_COMPRESSION_GZIP),
+      hasThread(false),
+      stopping(false),
+      threadEnded(false),
+      isClosed(true) {
     this->reader = NULL;
-    this->in = new char[S3_ZIP_DECOMPRESS_CHUNKSIZE];
-    this->out = new char[S3_ZIP_DECOMPRESS_CHUNKSIZE];
+    this->nextIn = NULL;
+    this->availIn = 0;
+    this->upstreamEnded = false;
+    this->outBufSize = S3_ZIP_DECOMPRESS_CHUNKSIZE;
+    this->out = new char[this->outBufSize];
     this->outOffset = 0;
+    this->outLen = 0;
+
+    pthread_mutex_init(&this->mutex, NULL);
+    pthread_cond_init(&this->cv, NULL);
 }
 
 DecompressReader::~DecompressReader() {
     this->close();
 
-    delete this->in;
+    pthread_mutex_destroy(&this->mutex);
+    pthread_cond_destroy(&this->cv);
+
     delete this->out;
 }
 
 // Used for unit test to adjust buffer size
 void DecompressReader::resizeDecompressReaderBuffer(uint64_t size) {
-    delete this->in;
     delete this->out;
-    this->in = new char[size];
+    this->outBufSize = size;
     this->out = new char[size];
     this->outOffset = 0;
-    this->zstream.avail_out = size;
+    this->outLen = 0;
 }
 
 void DecompressReader::setReader(Reader *reader) {
@@ -31,100 +257,215 @@ void DecompressReader::setReader(Reader *reader) {
 }
 
 void DecompressReader::open(const S3Params &params) {
-    // allocate inflate state for zlib
-    zstream.zalloc = Z_NULL;
-    zstream.zfree = Z_NULL;
-    zstream.opaque = Z_NULL;
-    zstream.next_in = Z_NULL;
-    zstream.next_out = (Byte *)this->out;
-
-    zstream.avail_in = 0;
-    zstream.avail_out = S3_ZIP_DECOMPRESS_CHUNKSIZE;
+    this->decoder.reset(newDecoder(this->compressionType));
 
+    this->nextIn = NULL;
+    this->availIn = 0;
+    this->upstreamEnded = false;
     this->outOffset = 0;
-
-    // with S3_INFLATE_WINDOWSBITS, it could recognize and decode both zlib and gzip stream.
-    int ret = inflateInit2(&zstream, S3_INFLATE_WINDOWSBITS);
-    S3_CHECK_OR_DIE(ret == Z_OK, S3RuntimeError, "failed to initialize zlib library");
+    this->outLen = 0;
 
     this->isClosed = false;
 
     this->reader->open(params);
+
+    if (params.isDecompressThread()) {
+        this->startThread();
+    }
 }
 
 uint64_t DecompressReader::read(char *buf, uint64_t bufSize) {
-    uint64_t remainingOutLen = this->getDecompressedBytesNum() - this->outOffset;
+    const char *data = NULL;
+    uint64_t count = this->borrow(&data, bufSize);
 
-    if (remainingOutLen == 0) {
-        this->decompress();
+    if (count != 0) {
+        memcpy(buf, data, count);
+    }
+
+    this->release();
+
+    return count;
+}
+
+uint64_t DecompressReader::borrow(const char **data, uint64_t bufSize) {
+    if (this->hasThread) {
+        return this->borrowFromThread(data, bufSize);
+    }
+
+    if (this->outOffset == this->outLen) {
         this->outOffset = 0;  // reset cursor for out buffer to read from beginning.
-        remainingOutLen = this->getDecompressedBytesNum();
+        this->outLen = this->decompress(this->out, this->outBufSize);
     }
 
-    uint64_t count = std::min(remainingOutLen, bufSize);
-    memcpy(buf, this->out + outOffset, count);
+    uint64_t count = std::min(this->outLen - this->outOffset, bufSize);
+    *data = this->out + this->outOffset;
 
     this->outOffset += count;
 
     return count;
 }
 
-// Read compressed data from underlying reader and decompress to this->out buffer.
-// If no more data to consume, this->zstream.avail_out == S3_ZIP_DECOMPRESS_CHUNKSIZE;
-void DecompressReader::decompress() {
-    if (this->zstream.avail_in == 0) {
-        this->zstream.avail_out = S3_ZIP_DECOMPRESS_CHUNKSIZE;
-        this->zstream.next_out = (Byte *)this->out;
+// Read compressed data from underlying reader and decompress it into buf.
+// Decompressing may produce nothing, e.g. when only the trailer of a gzip member is decoded, it
+// goes on until there is data or EOF.
+uint64_t DecompressReader::decompress(char *buf, uint64_t count) {
+    while (true) {
+        if (this->availIn == 0 && !this->upstreamEnded) {
+            // Decompress data right where the upstream reader holds it, e.g. in the chunk buffers
+            // of S3KeyReader, instead of copying it first. Once upstream reader reaches EOF, don't
+            // read from it anymore.
+            this->reader->release();
+            this->availIn = this->reader->borrow(&this->nextIn, this->outBufSize);
+
+            if (this->availIn == 0) {
+                this->upstreamEnded = true;
+            }
+        }
 
-        // read S3_ZIP_DECOMPRESS_CHUNKSIZE data from underlying reader and put into this->in
-        // buffer. read() might happen more than once when reaching EOF, make sure every time read()
-        // will return 0.
-        uint64_t hasRead = this->reader->read(this->in, S3_ZIP_DECOMPRESS_CHUNKSIZE);
+        uint64_t availInBefore = this->availIn;
+        char *nextOut = buf;
+        uint64_t availOut = count;
+
+        // Decode even without input at EOF, the decoder may still hold data.
+        this->decoder->decode(this->nextIn, this->availIn, nextOut, availOut);
+
+        if (availOut < count) {
+            return count - availOut;
+        }
 
         // EOF, no more data to decompress.
-        if (hasRead == 0) {
-            S3DEBUG(
-                "No more data to decompress: avail_in = %u, avail_out = %u, total_in = %u, "
-                "total_out = %u",
-                zstream.avail_in, zstream.avail_out, zstream.total_in, zstream.total_out);
-            return;
+        if (this->upstreamEnded && (this->availIn == 0 || this->availIn == availInBefore)) {
+            S3DEBUG("No more data to decompress");
+            return 0;
         }
+    }
+}
+
+void *DecompressReader::DecompressThreadFunc(void *p) {
+    MaskThreadSignals();
+
+    DecompressReader *reader = static_cast<DecompressReader *>(p);
 
-        // Fill this->in as possible as it could, otherwise data in this->in might not be able to be
-        // inflated.
-        while (hasRead < S3_ZIP_DECOMPRESS_CHUNKSIZE) {
-            uint64_t count =
-                this->reader->read(this->in + hasRead, S3_ZIP_DECOMPRESS_CHUNKSIZE - hasRead);
+    try {
+        while (true) {
+            vector<char> block;
+            {
+                UniqueLock lock(&reader->mutex);
 
+                // Stay at most two blocks ahead of read().
+                while (reader->readyBlocks.size() >= 2 && !reader->stopping) {
+                    pthread_cond_wait(&reader->cv, &reader->mutex);
+                }
+
+                if (reader->stopping) {
+                    break;
+                }
+
+                if (!reader->freeBlocks.empty()) {
+                    block.swap(reader->freeBlocks.front());
+                    reader->freeBlocks.pop_front();
+                }
+            }
+
+            block.resize(reader->outBufSize);
+            uint64_t count = reader->decompress(block.data(), block.size());
+            block.resize(count);
+
+            UniqueLock lock(&reader->mutex);
             if (count == 0) {
+                reader->threadEnded = true;
+                pthread_cond_broadcast(&reader->cv);
                 break;
             }
 
-            hasRead += count;
+            reader->readyBlocks.push_back(vector<char>());
+            reader->readyBlocks.back().swap(block);
+            pthread_cond_broadcast(&reader->cv);
         }
+    } catch (S3Exception &e) {
+        S3ERROR("Decompression thread error: %s", e.getMessage().c_str());
+
+        UniqueLock lock(&reader->mutex);
+        reader->threadException = std::current_exception();
+        reader->threadEnded = true;
+        pthread_cond_broadcast(&reader->cv);
+    }
+
+    return NULL;
+}
+
+void DecompressReader::startThread() {
+    this->stopping = false;
+    this->threadEnded = false;
+    this->threadException = nullptr;
+    this->currentBlock.clear();
 
-        this->zstream.next_in = (Byte *)this->in;
-        this->zstream.avail_in = hasRead;
-    } else {
-        // Still have more data in 'in' buffer to decode.
-        this->zstream.avail_out = S3_ZIP_DECOMPRESS_CHUNKSIZE;
-        this->zstream.next_out = (Byte *)this->out;
+    int ret = pthread_create(&this->thread, NULL, DecompressThreadFunc, this);
+    S3_CHECK_OR_DIE(ret == 0, S3RuntimeError, "Failed to create decompression thread");
+
+    this->hasThread = true;
+}
+
+void DecompressReader::stopThread() {
+    if (!this->hasThread) {
+        return;
     }
 
-    int status = inflate(&this->zstream, Z_NO_FLUSH);
-    if (status == Z_STREAM_END) {
-        S3DEBUG("Decompression finished: Z_STREAM_END.");
-    } else if (status < 0 || status == Z_NEED_DICT) {
-        inflateEnd(&this->zstream);
-        S3_CHECK_OR_DIE(
-            false, S3RuntimeError,
-            string("Failed to decompress data: ") + std::to_string((unsigned long long)status));
+    {
+        UniqueLock lock(&this->mutex);
+        this->stopping = true;
+        pthread_cond_broadcast(&this->cv);
+    }
+
+    pthread_join(this->thread, NULL);
+    this->hasThread = false;
+
+    this->readyBlocks.clear();
+    this->freeBlocks.clear();
+    this->currentBlock.clear();
+}
+
+uint64_t DecompressReader::borrowFromThread(const char **data, uint64_t count) {
+    if (this->outOffset == this->currentBlock.size()) {
+        UniqueLock lock(&this->mutex);
+
+        // Give the block read already back to the thread.
+        if (this->currentBlock.capacity() > 0) {
+            this->freeBlocks.push_back(vector<char>());
+            this->freeBlocks.back().swap(this->currentBlock);
+        }
+
+        while (this->readyBlocks.empty() && !this->threadEnded) {
+            pthread_cond_wait(&this->cv, &this->mutex);
+        }
+
+        if (this->readyBlocks.empty()) {
+            if (this->threadException) {
+                std::rethrow_exception(this->threadException);
+            }
+            return 0;
+        }
+
+        this->currentBlock.swap(this->readyBlocks.front());
+        this->readyBlocks.pop_front();
+        this->outOffset = 0;
+
+        pthread_cond_broadcast(&this->cv);
     }
+
+    uint64_t len = std::min(this->currentBlock.size() - this->outOffset, count);
+    *data = this->currentBlock.data() + this->outOffset;
+
+    this->outOffset += len;
+
+    return len;
 }
 
 void DecompressReader::close() {
     if (!this->isClosed) {
-        inflateEnd(&zstream);
+        this->stopThread();
+        this->decoder.reset();
+        this->reader->release();
         this->reader->close();
         this->isClosed = true;
     }
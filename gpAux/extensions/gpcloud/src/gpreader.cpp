@@ -61,6 +61,17 @@ void GPReader::open(const S3Params& params) {
     this->bucketReader.setS3InterfaceService(&this->s3InterfaceService);
     this->bucketReader.setUpstreamReader(&this->commonReader);
     this->commonReader.setS3InterfaceService(&this->s3InterfaceService);
+
+    // One reader per chunk is enough, as each opened key takes at least one chunk.
+    vector<Reader*> readers(1, &this->commonReader);
+    this->prefetchReaders.clear();
+    for (uint64_t i = 1; i < this->params.getNumOfChunks(); i++) {
+        this->prefetchReaders.emplace_back(new S3CommonReader());
+        this->prefetchReaders.back()->setS3InterfaceService(&this->s3InterfaceService);
+        readers.push_back(this->prefetchReaders.back().get());
+    }
+    this->bucketReader.setPrefetchReaders(readers);
+
     this->bucketReader.open(this->params);
 }
 
@@ -70,6 +81,14 @@ uint64_t GPReader::read(char* buf, uint64_t count) {
     return this->bucketReader.read(buf, count);
 }
 
+uint64_t GPReader::borrow(const char** data, uint64_t count) {
+    return this->bucketReader.borrow(data, count);
+}
+
+void GPReader::release() {
+    this->bucketReader.release();
+}
+
 // This should be reentrant, has no side effects when called multiple times.
 void GPReader::close() {
     this->bucketReader.close();
@@ -0,0 +1,532 @@
+#include "parquet_reader.h"
+
+#define PARQUET_MAGIC "PAR1"
+#define PARQUET_MAGIC_LEN 4
+
+// A Parquet file ends with its footer, the footer length in 4 bytes and the magic.
+#define PARQUET_TRAILER_LEN (4 + PARQUET_MAGIC_LEN)
+
+// Nesting of thrift structs and containers in a valid footer is far less deep than this.
+#define THRIFT_MAX_DEPTH 64
+
+// Types of thrift compact protocol.
+enum ThriftCompactType {
+    THRIFT_STOP = 0,
+    THRIFT_BOOLEAN_TRUE = 1,
+    THRIFT_BOOLEAN_FALSE = 2,
+    THRIFT_BYTE = 3,
+    THRIFT_I16 = 4,
+    THRIFT_I32 = 5,
+    THRIFT_I64 = 6,
+    THRIFT_DOUBLE = 7,
+    THRIFT_BINARY = 8,
+    THRIFT_LIST = 9,
+    THRIFT_SET = 10,
+    THRIFT_MAP = 11,
+    THRIFT_STRUCT = 12,
+};
+
+// Field ids of the parquet.thrift structs we need.
+#define FILE_META_DATA_ROW_GROUPS 4
+#define ROW_GROUP_COLUMNS 1
+#define COLUMN_CHUNK_FILE_PATH 1
+#define COLUMN_CHUNK_META_DATA 3
+#define COLUMN_META_DATA_PATH_IN_SCHEMA 3
+#define COLUMN_META_DATA_TOTAL_COMPRESSED_SIZE 7
+#define COLUMN_META_DATA_DATA_PAGE_OFFSET 9
+#define COLUMN_META_DATA_DICTIONARY_PAGE_OFFSET 11
+
+// Zeros lent for the column chunks left out.
+static const char ParquetZeros[64 * 1024] = {0};
+
+// ThriftCompactParser reads the thrift compact protocol, it throws S3RuntimeError at any data out
+// of bounds.
+class ThriftCompactParser {
+   public:
+    ThriftCompactParser(const uint8_t *data, uint64_t length) : p(data), end(data + length) {
+    }
+
+    uint8_t readByte() {
+        S3_CHECK_OR_DIE(this->p < this->end, S3RuntimeError, "Corrupted Parquet footer");
+        return *this->p++;
+    }
+
+    uint64_t readVarint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t byte = this->readByte();
+            value |= (uint64_t)(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+
+        S3_DIE(S3RuntimeError, "Corrupted Parquet footer");
+    }
+
+    int64_t readZigzag() {
+        uint64_t n = this->readVarint();
+        return (int64_t)(n >> 1) ^ -(int64_t)(n & 1);
+    }
+
+    string readBinary() {
+        uint64_t length = this->readVarint();
+        S3_CHECK_OR_DIE(length <= (uint64_t)(this->end - this->p), S3RuntimeError,
+                        "Corrupted Parquet footer");
+
+        string value((const char *)this->p, length);
+        this->p += length;
+        return value;
+    }
+
+    // Read the header of the next field of a struct, return false at the end of the struct.
+    bool readFieldHeader(int16_t &id, uint8_t &type) {
+        uint8_t byte = this->readByte();
+        type = byte & 0x0f;
+        if (type == THRIFT_STOP) {
+            return false;
+        }
+
+        // The id is a delta to the previous one, or follows if it doesn't fit in 4 bits.
+        uint8_t delta = byte >> 4;
+        id = (delta != 0) ? id + delta : (int16_t) this->readZigzag();
+        return true;
+    }
+
+    void readListHeader(uint8_t &elementType, uint64_t &size) {
+        uint8_t byte = this->readByte();
+        elementType = byte & 0x0f;
+        size = byte >> 4;
+        if (size == 15) {
+            size = this->readVarint();
+        }
+
+        // Every element takes a byte at least.
+        S3_CHECK_OR_DIE(size <= (uint64_t)(this->end - this->p), S3RuntimeError,
+                        "Corrupted Parquet footer");
+    }
+
+    // Skip a value, a field value unless it is an element of a container, where booleans take a
+    // byte of their own.
+    void skip(uint8_t type, bool isElement = false, int depth = 0) {
+        S3_CHECK_OR_DIE(depth < THRIFT_MAX_DEPTH, S3RuntimeError, "Corrupted Parquet footer");
+
+        switch (type) {
+            case THRIFT_BOOLEAN_TRUE:
+            case THRIFT_BOOLEAN_FALSE:
+                if (isElement) {
+                    this->readByte();
+                }
+                break;
+            case THRIFT_BYTE:
+                this->readByte();
+                break;
+            case THRIFT_I16:
+            case THRIFT_I32:
+            case THRIFT_I64:
+                this->readVarint();
+                break;
+            case THRIFT_DOUBLE:
+                for (int i = 0; i < 8; i++) {
+                    this->readByte();
+                }
+                break;
+            case THRIFT_BINARY:
+                this->readBinary();
+                break;
+            case THRIFT_LIST:
+            case THRIFT_SET: {
+                uint8_t elementType;
+                uint64_t size;
+                this->readListHeader(elementType, size);
+                for (uint64_t i = 0; i < size; i++) {
+                    this->skip(elementType, true, depth + 1);
+                }
+                break;
+            }
+            case THRIFT_MAP: {
+                uint64_t size = this->readVarint();
+                if (size > 0) {
+                    uint8_t types = this->readByte();
+                    for (uint64_t i = 0; i < size; i++) {
+                        this->skip(types >> 4, true, depth + 1);
+                        this->skip(types & 0x0f, true, depth + 1);
+                    }
+                }
+                break;
+            }
+            case THRIFT_STRUCT: {
+                int16_t id = 0;
+                uint8_t fieldType;
+                while (this->readFieldHeader(id, fieldType)) {
+                    this->skip(fieldType, false, depth + 1);
+                }
+                break;
+            }
+            default:
+                S3_DIE(S3RuntimeError, "Corrupted Parquet footer");
+        }
+    }
+
+   private:
+    const uint8_t *p;
+    const uint8_t *end;
+};
+
+static bool parseColumnMetaData(ThriftCompactParser &parser, ParquetColumnChunk &chunk) {
+    int64_t dataPageOffset = -1;
+    int64_t dictionaryPageOffset = -1;
+    int64_t totalCompressedSize = -1;
+
+    int16_t id = 0;
+    uint8_t type;
+    while (parser.readFieldHeader(id, type)) {
+        if (id == COLUMN_META_DATA_PATH_IN_SCHEMA && type == THRIFT_LIST) {
+            uint8_t elementType;
+            uint64_t size;
+            parser.readListHeader(elementType, size);
+            for (uint64_t i = 0; i < size; i++) {
+                if (i == 0 && elementType == THRIFT_BINARY) {
+                    chunk.column = parser.readBinary();
+                } else {
+                    parser.skip(elementType, true);
+                }
+            }
+        } else if (id == COLUMN_META_DATA_TOTAL_COMPRESSED_SIZE && type == THRIFT_I64) {
+            totalCompressedSize = parser.readZigzag();
+        } else if (id == COLUMN_META_DATA_DATA_PAGE_OFFSET && type == THRIFT_I64) {
+            dataPageOffset = parser.readZigzag();
+        } else if (id == COLUMN_META_DATA_DICTIONARY_PAGE_OFFSET && type == THRIFT_I64) {
+            dictionaryPageOffset = parser.readZigzag();
+        } else {
+            parser.skip(type);
+        }
+    }
+
+    S3_CHECK_OR_DIE(dataPageOffset >= 0 && totalCompressedSize >= 0 && !chunk.column.empty(),
+                    S3RuntimeError, "Corrupted Parquet footer");
+
+    // The dictionary page, if any, comes before the data pages.
+    chunk.offset = (dictionaryPageOffset > 0 && dictionaryPageOffset < dataPageOffset)
+                       ? dictionaryPageOffset
+                       : dataPageOffset;
+    chunk.length = totalCompressedSize;
+    return true;
+}
+
+// Return false if the chunk is in a file other than the one of the footer.
+static bool parseColumnChunk(ThriftCompactParser &parser, ParquetColumnChunk &chunk) {
+    bool hasMetaData = false;
+    bool inOtherFile = false;
+
+    int16_t id = 0;
+    uint8_t type;
+    while (parser.readFieldHeader(id, type)) {
+        if (id == COLUMN_CHUNK_META_DATA && type == THRIFT_STRUCT) {
+            hasMetaData = parseColumnMetaData(parser, chunk);
+        } else if (id == COLUMN_CHUNK_FILE_PATH && type == THRIFT_BINARY) {
+            inOtherFile = !parser.readBinary().empty();
+        } else {
+            parser.skip(type);
+        }
+    }
+
+    S3_CHECK_OR_DIE(hasMetaData || inOtherFile, S3RuntimeError, "Corrupted Parquet footer");
+    return !inOtherFile;
+}
+
+static void parseRowGroup(ThriftCompactParser &parser, vector<ParquetColumnChunk> &chunks) {
+    int16_t id = 0;
+    uint8_t type;
+    while (parser.readFieldHeader(id, type)) {
+        if (id == ROW_GROUP_COLUMNS && type == THRIFT_LIST) {
+            uint8_t elementType;
+            uint64_t size;
+            parser.readListHeader(elementType, size);
+            S3_CHECK_OR_DIE(elementType == THRIFT_STRUCT, S3RuntimeError,
+                            "Corrupted Parquet footer");
+
+            for (uint64_t i = 0; i < size; i++) {
+                ParquetColumnChunk chunk;
+                if (parseColumnChunk(parser, chunk)) {
+                    chunks.push_back(chunk);
+                }
+            }
+        } else {
+            parser.skip(type);
+        }
+    }
+}
+
+vector<ParquetColumnChunk> ParseParquetFooter(const uint8_t *footer, uint64_t length) {
+    vector<ParquetColumnChunk> chunks;
+    ThriftCompactParser parser(footer, length);
+
+    int16_t id = 0;
+    uint8_t type;
+    while (parser.readFieldHeader(id, type)) {
+        if (id == FILE_META_DATA_ROW_GROUPS && type == THRIFT_LIST) {
+            uint8_t elementType;
+            uint64_t size;
+            parser.readListHeader(elementType, size);
+            S3_CHECK_OR_DIE(elementType == THRIFT_STRUCT, S3RuntimeError,
+                            "Corrupted Parquet footer");
+
+            for (uint64_t i = 0; i < size; i++) {
+                parseRowGroup(parser, chunks);
+            }
+        } else {
+            parser.skip(type);
+        }
+    }
+
+    return chunks;
+}
+
+ParquetReader::ParquetReader()
+    : s3Interface(NULL),
+      reader(NULL),
+      readerOpened(false),
+      borrowing(false),
+      tailOffset(0),
+      segmentIndex(0),
+      segmentOffset(0) {
+}
+
+ParquetReader::~ParquetReader() {
+    this->close();
+}
+
+void ParquetReader::open(const S3Params &params) {
+    S3_CHECK_OR_DIE(this->s3Interface != NULL, S3RuntimeError, "s3Interface must not be NULL");
+    S3_CHECK_OR_DIE(this->reader != NULL, S3RuntimeError, "reader must not be NULL");
+
+    this->params = params;
+
+    this->segments.clear();
+    this->segmentIndex = 0;
+    this->segmentOffset = 0;
+
+    if (!this->planSegments()) {
+        this->tail.release();
+        this->tailOffset = this->params.getKeySize();
+
+        ParquetSegment whole = {0, this->params.getKeySize(), PARQUET_SEGMENT_FETCH};
+        this->segments.push_back(whole);
+    }
+}
+
+void ParquetReader::fetchTail(uint64_t offset) {
+    uint64_t length = this->params.getKeySize() - offset;
+
+    this->tail.release();
+    this->tailOffset = offset;
+
+    uint64_t fetched = this->s3Interface->fetchData(offset, this->tail, length,
+                                                    this->params.getS3Url());
+    S3_CHECK_OR_DIE(fetched == length && this->tail.size() == length, S3PartialResponseError,
+                    length, fetched);
+}
+
+bool ParquetReader::planSegments() {
+    uint64_t keySize = this->params.getKeySize();
+    if (keySize < PARQUET_MAGIC_LEN + PARQUET_TRAILER_LEN) {
+        return false;
+    }
+
+    this->fetchTail(keySize - std::min<uint64_t>(keySize, S3_PARQUET_FOOTER_PREFETCH_SIZE));
+
+    const uint8_t *trailer = this->tail.data() + this->tail.size() - PARQUET_TRAILER_LEN;
+    if (memcmp(trailer + 4, PARQUET_MAGIC, PARQUET_MAGIC_LEN) != 0) {
+        S3DEBUG("Key '%s' is not in Parquet format, read it as a whole",
+                this->params.getS3Url().getFullUrlForCurl().c_str());
+        return false;
+    }
+
+    uint64_t footerLength = (uint64_t)trailer[0] | ((uint64_t)trailer[1] << 8) |
+                            ((uint64_t)trailer[2] << 16) | ((uint64_t)trailer[3] << 24);
+    S3_CHECK_OR_DIE(footerLength <= keySize - PARQUET_MAGIC_LEN - PARQUET_TRAILER_LEN,
+                    S3RuntimeError, "Corrupted Parquet footer");
+
+    uint64_t footerOffset = keySize - PARQUET_TRAILER_LEN - footerLength;
+    if (footerOffset < this->tailOffset) {
+        this->fetchTail(footerOffset);
+    }
+
+    vector<ParquetColumnChunk> chunks =
+        ParseParquetFooter(this->tail.data() + (footerOffset - this->tailOffset), footerLength);
+
+    // Byte ranges to read, the leading magic and the chosen column chunks.
+    vector<std::pair<uint64_t, uint64_t> > ranges;
+    ranges.push_back(std::make_pair(0, PARQUET_MAGIC_LEN));
+
+    const vector<string> &columns = this->params.getColumns();
+    vector<bool> columnFound(columns.size(), false);
+    for (size_t i = 0; i < chunks.size(); i++) {
+        S3_CHECK_OR_DIE(chunks[i].offset >= PARQUET_MAGIC_LEN &&
+                            chunks[i].offset <= footerOffset &&
+                            chunks[i].length <= footerOffset - chunks[i].offset,
+                        S3RuntimeError, "Corrupted Parquet footer");
+
+        // Column names are matched case insensitively, as those of the table are lower case.
+        for (size_t j = 0; j < columns.size(); j++) {
+            if (strcasecmp(chunks[i].column.c_str(), columns[j].c_str()) == 0) {
+                ranges.push_back(
+                    std::make_pair(chunks[i].offset, chunks[i].offset + chunks[i].length));
+                columnFound[j] = true;
+                break;
+            }
+        }
+    }
+
+    for (size_t j = 0; j < columns.size(); j++) {
+        if (!columnFound[j]) {
+            S3WARN("Column '%s' is not found in '%s'", columns[j].c_str(),
+                   this->params.getS3Url().getFullUrlForCurl().c_str());
+        }
+    }
+
+    std::sort(ranges.begin(), ranges.end());
+
+    // Walk through the key up to the tail, fetching the ranges and leaving out the gaps, except
+    // for small gaps between ranges, which are fetched along.
+    uint64_t position = 0;
+    uint64_t bytesToFetch = 0;
+    for (size_t i = 0; i < ranges.size(); i++) {
+        uint64_t begin = std::min(ranges[i].first, this->tailOffset);
+        uint64_t end = std::min(ranges[i].second, this->tailOffset);
+        if (end <= position || begin >= end) {
+            continue;
+        }
+
+        begin = std::max(begin, position);
+        if (begin > position) {
+            ParquetSegment gap = {position, begin - position, PARQUET_SEGMENT_ZERO};
+            if (begin - position < S3_PARQUET_RANGE_MERGE_GAP && !this->segments.empty()) {
+                gap.type = PARQUET_SEGMENT_FETCH;
+            }
+
+            if (!this->segments.empty() && this->segments.back().type == gap.type) {
+                this->segments.back().length += gap.length;
+            } else {
+                this->segments.push_back(gap);
+            }
+        }
+
+        if (!this->segments.empty() && this->segments.back().type == PARQUET_SEGMENT_FETCH) {
+            this->segments.back().length += end - begin;
+        } else {
+            ParquetSegment range = {begin, end - begin, PARQUET_SEGMENT_FETCH};
+            this->segments.push_back(range);
+        }
+
+        position = end;
+    }
+
+    if (position < this->tailOffset) {
+        ParquetSegment gap = {position, this->tailOffset - position, PARQUET_SEGMENT_ZERO};
+        this->segments.push_back(gap);
+    }
+
+    ParquetSegment tailSegment = {this->tailOffset, keySize - this->tailOffset,
+                                  PARQUET_SEGMENT_TAIL};
+    this->segments.push_back(tailSegment);
+
+    for (size_t i = 0; i < this->segments.size(); i++) {
+        if (this->segments[i].type != PARQUET_SEGMENT_ZERO) {
+            bytesToFetch += this->segments[i].length;
+        }
+    }
+
+    S3DEBUG("Read %" PRIu64 " of %" PRIu64 " bytes of '%s' in %zu segments", bytesToFetch,
+            keySize, this->params.getS3Url().getFullUrlForCurl().c_str(), this->segments.size());
+    return true;
+}
+
+void ParquetReader::nextSegment() {
+    this->release();
+
+    if (this->readerOpened) {
+        this->reader->close();
+        this->readerOpened = false;
+    }
+
+    this->segmentIndex++;
+    this->segmentOffset = 0;
+}
+
+uint64_t ParquetReader::borrow(const char **data, uint64_t count) {
+    this->release();
+
+    while (this->segmentIndex < this->segments.size()) {
+        const ParquetSegment &segment = this->segments[this->segmentIndex];
+
+        uint64_t length = std::min(count, segment.length - this->segmentOffset);
+        if (length == 0) {
+            this->nextSegment();
+            continue;
+        }
+
+        switch (segment.type) {
+            case PARQUET_SEGMENT_ZERO:
+                length = std::min<uint64_t>(length, sizeof(ParquetZeros));
+                *data = ParquetZeros;
+                break;
+            case PARQUET_SEGMENT_TAIL:
+                *data = (const char *)this->tail.data() + (segment.offset - this->tailOffset) +
+                        this->segmentOffset;
+                break;
+            case PARQUET_SEGMENT_FETCH:
+                if (!this->readerOpened) {
+                    S3Params readerParams = this->params;
+                    readerParams.setKeyRange(segment.offset, segment.length);
+                    this->reader->open(readerParams);
+                    this->readerOpened = true;
+                }
+
+                length = this->reader->borrow(data, length);
+                this->borrowing = true;
+                S3_CHECK_OR_DIE(length > 0, S3PartialResponseError, segment.length,
+                                this->segmentOffset);
+                break;
+        }
+
+        this->segmentOffset += length;
+        return length;
+    }
+
+    return 0;
+}
+
+void ParquetReader::release() {
+    if (this->borrowing) {
+        this->reader->release();
+        this->borrowing = false;
+    }
+}
+
+uint64_t ParquetReader::read(char *buf, uint64_t count) {
+    const char *data = NULL;
+    uint64_t length = this->borrow(&data, count);
+    if (length > 0) {
+        memcpy(buf, data, length);
+    }
+
+    this->release();
+    return length;
+}
+
+// This should be reentrant, has no side effects when called multiple times.
+void ParquetReader::close() {
+    this->release();
+
+    if (this->readerOpened) {
+        this->reader->close();
+        this->readerOpened = false;
+    }
+
+    this->tail.release();
+    this->segments.clear();
+    this->segmentIndex = 0;
+    this->segmentOffset = 0;
+}
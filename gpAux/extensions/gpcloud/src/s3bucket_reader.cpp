@@ -1,13 +1,24 @@
 #include "s3bucket_reader.h"
 
+#include <functional>
+#include <queue>
+
 S3BucketReader::S3BucketReader() : Reader() {
-    this->keyIndex = 0;  // doesn't matter, be set in open()
+    this->keyPartIndex = 0;
 
     this->s3Interface = NULL;
     this->upstreamReader = NULL;
 
     this->needNewReader = true;
     this->isFirstFile = true;
+
+    this->skippingLine = false;
+    this->lineEnded = false;
+    this->readingTail = false;
+    this->partEnded = false;
+    this->readEnd = 0;
+
+    this->usedChunks = 0;
 }
 
 S3BucketReader::~S3BucketReader() {
@@ -17,8 +28,6 @@ S3BucketReader::~S3BucketReader() {
 void S3BucketReader::open(const S3Params& params) {
     this->params = params;
 
-    this->keyIndex = s3ext_segid;  // we may change it in unit tests
-
     S3_CHECK_OR_DIE(this->s3Interface != NULL, S3RuntimeError, "s3Interface is NULL");
 
     S3Url& s3Url = this->params.getS3Url();
@@ -26,16 +35,181 @@ void S3BucketReader::open(const S3Params& params) {
     S3_CHECK_OR_DIE(s3Url.isValidUrl(), S3ConfigError, s3Url.getFullUrlForCurl() + " is not valid",
                     s3Url.getFullUrlForCurl());
 
-    this->keyList = this->s3Interface->listBucket(s3Url);
+    S3ListingCache listingCache(this->params.getListCacheDir(), this->params.getListCacheTtl());
+    this->keyList = listingCache.listBucket(this->s3Interface, s3Url, this->params.getCred());
+
+    this->assignKeyParts();
+}
+
+// Only plain text keys can be split at line ends, and only when there is no header line to skip
+// in each file. Parquet keys read by columns are not text.
+bool S3BucketReader::isSplittable(uint64_t keyIndex) {
+    uint64_t splitSize = std::max(this->params.getSplitSize(), this->params.getChunkSize());
+    if (this->params.getSplitSize() == 0 || this->params.getChunkSize() == 0 ||
+        this->keyList.contents[keyIndex].getSize() <= splitSize) {
+        return false;
+    }
+
+    if (hasHeader || eolString[0] == '\0' || !this->params.getColumns().empty()) {
+        return false;
+    }
+
+    KeyPart whole = {keyIndex, 0, this->keyList.contents[keyIndex].getSize(), false};
+    return this->s3Interface->checkCompressionType(constructReaderParams(whole).getS3Url()) ==
+           S3_COMPRESSION_PLAIN;
+}
+
+// Split big keys, then hand out the parts biggest first, each one to the segment with the least
+// data so far. Every segment computes the same assignment from the same key list, and keeps its
+// own parts.
+void S3BucketReader::assignKeyParts() {
+    this->keyParts.clear();
+    this->keyPartIndex = 0;
+
+    if (s3ext_segnum <= 0 || s3ext_segid < 0) {
+        return;
+    }
+
+    vector<KeyPart> allParts;
+    for (uint64_t i = 0; i < this->keyList.contents.size(); i++) {
+        uint64_t keySize = this->keyList.contents[i].getSize();
+
+        if (!this->isSplittable(i)) {
+            KeyPart part = {i, 0, keySize, false};
+            allParts.push_back(part);
+            continue;
+        }
+
+        uint64_t splitSize = std::max(this->params.getSplitSize(), this->params.getChunkSize());
+        for (uint64_t offset = 0; offset < keySize; offset += splitSize) {
+            KeyPart part = {i, offset, std::min(splitSize, keySize - offset), true};
+            allParts.push_back(part);
+        }
+    }
+
+    vector<size_t> order(allParts.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&allParts](size_t a, size_t b) {
+        return allParts[a].length > allParts[b].length;
+    });
+
+    // (bytes assigned, segment id), the segment with the least bytes and the lowest id on top.
+    typedef std::pair<uint64_t, int32_t> SegmentLoad;
+    std::priority_queue<SegmentLoad, vector<SegmentLoad>, std::greater<SegmentLoad> > loads;
+    for (int32_t i = 0; i < s3ext_segnum; i++) {
+        loads.push(SegmentLoad(0, i));
+    }
+
+    vector<bool> isMine(allParts.size(), false);
+    for (size_t i = 0; i < order.size(); i++) {
+        SegmentLoad load = loads.top();
+        loads.pop();
+
+        isMine[order[i]] = (load.second == s3ext_segid);
+
+        // Count a byte more for each part, so that empty keys are spread too.
+        load.first += allParts[order[i]].length + 1;
+        loads.push(load);
+    }
+
+    for (size_t i = 0; i < allParts.size(); i++) {
+        if (isMine[i]) {
+            this->keyParts.push_back(allParts[i]);
+        }
+    }
+
+    S3DEBUG("Segment %d reads %zu of %zu key parts", s3ext_segid, this->keyParts.size(),
+            allParts.size());
+}
+
+S3BucketReader::KeyPart& S3BucketReader::getNextKeyPart() {
+    return this->keyParts[this->keyPartIndex++];
+}
+
+// Chunks needed to download part, each one holds a block of S3MemoryContext until it is read.
+uint64_t S3BucketReader::getNumOfChunksForPart(const KeyPart& part) {
+    uint64_t chunkSize = this->params.getChunkSize();
+    if (chunkSize == 0) {
+        return std::max<uint64_t>(1, this->params.getNumOfChunks());
+    }
+
+    uint64_t numOfChunks = (part.length + chunkSize - 1) / chunkSize;
+    return std::max<uint64_t>(1, std::min(numOfChunks, this->params.getNumOfChunks()));
+}
+
+void S3BucketReader::prefetchKeys() {
+    while (!this->idleReaders.empty() && this->keyPartIndex < this->keyParts.size()) {
+        const KeyPart& part = this->keyParts[this->keyPartIndex];
+        uint64_t numOfChunks = this->getNumOfChunksForPart(part);
+
+        // Keys are opened in order, a key that doesn't fit waits for the keys before it to be
+        // read. The key to read next is always opened, whatever its size.
+        if (!this->openedKeys.empty() &&
+            this->usedChunks + numOfChunks > this->params.getNumOfChunks()) {
+            break;
+        }
+
+        this->getNextKeyPart();
+
+        S3Params readerParams = this->constructReaderParams(part);
+        readerParams.setNumOfChunks(numOfChunks);
+
+        Reader* reader = this->idleReaders.back();
+        this->idleReaders.pop_back();
+
+        try {
+            reader->open(readerParams);
+        } catch (...) {
+            reader->close();
+            this->idleReaders.push_back(reader);
+            throw;
+        }
+
+        OpenedKey opened = {reader, part, numOfChunks};
+        this->openedKeys.push_back(opened);
+        this->usedChunks += numOfChunks;
+    }
 }
 
-BucketContent& S3BucketReader::getNextKey() {
-    BucketContent& key = this->keyList.contents[this->keyIndex];
-    this->keyIndex += s3ext_segnum;
-    return key;
+bool S3BucketReader::openNextKey() {
+    if (this->prefetchReaders.empty()) {
+        if (this->keyPartIndex >= this->keyParts.size()) {
+            return false;
+        }
+
+        const KeyPart& part = this->getNextKeyPart();
+        this->upstreamReader->open(constructReaderParams(part));
+        this->startPart(part);
+        return true;
+    }
+
+    this->prefetchKeys();
+    if (this->openedKeys.empty()) {
+        return false;
+    }
+
+    this->upstreamReader = this->openedKeys.front().reader;
+    this->startPart(this->openedKeys.front().part);
+    return true;
 }
 
-S3Params S3BucketReader::constructReaderParams(BucketContent& key) {
+void S3BucketReader::closeCurrentKey() {
+    this->upstreamReader->close();
+
+    if (!this->prefetchReaders.empty()) {
+        this->usedChunks -= this->openedKeys.front().numOfChunks;
+        this->openedKeys.pop_front();
+
+        this->idleReaders.push_back(this->upstreamReader);
+        this->upstreamReader = NULL;
+    }
+}
+
+S3Params S3BucketReader::constructReaderParams(const KeyPart& part) {
+    const BucketContent& key = this->keyList.contents[part.keyIndex];
+
     // encode the key name but leave the "/"
     // "/encoded_path/encoded_name"
     string keyEncoded = UriEncode(key.getName());
@@ -45,28 +219,110 @@ S3Params S3BucketReader::constructReaderParams(BucketContent& key) {
 
     readerParams.setKeySize(key.getSize());
 
-    S3DEBUG("key: %s, size: %" PRIu64, readerParams.getS3Url().getFullUrlForCurl().c_str(),
-            readerParams.getKeySize());
+    if (part.isSplit) {
+        // Start a byte early, to know whether a line starts at the part.
+        uint64_t offset = (part.offset == 0) ? 0 : part.offset - 1;
+        readerParams.setKeyRange(offset, part.offset + part.length - offset);
+    }
+
+    S3DEBUG("key: %s, size: %" PRIu64 ", range: %" PRIu64 "+%" PRIu64,
+            readerParams.getS3Url().getFullUrlForCurl().c_str(), readerParams.getKeySize(),
+            readerParams.getKeyRangeOffset(), readerParams.getKeyRangeLength());
     return readerParams;
 }
 
-uint64_t S3BucketReader::readWithoutHeaderLine(char* buf, uint64_t count) {
-    char* current = NULL;
-    char* end = NULL;
+void S3BucketReader::startPart(const KeyPart& part) {
+    this->currentPart = part;
+
+    this->skippingLine = part.isSplit && (part.offset != 0);
+    this->lineEnded = false;
+    this->readingTail = false;
+    this->partEnded = false;
+    this->readEnd = part.offset + part.length;
+}
+
+// A split part has the lines starting in it: the line crossing its start is left to the previous
+// part, and the line crossing its end is read to its end from the next part.
+uint64_t S3BucketReader::readPart(char* buf, const char** data, uint64_t count) {
+    if (!this->currentPart.isSplit) {
+        return this->readUpstream(buf, data, count);
+    }
+
+    // Lines end with the last char of eolString, e.g. '\n' of "\r\n".
+    char lineEnd = eolString[strlen(eolString) - 1];
+    uint64_t keySize = this->keyList.contents[this->currentPart.keyIndex].getSize();
+
+    while (!this->partEnded) {
+        uint64_t readCount = this->readUpstream(buf, data, count);
+
+        if (readCount == 0) {
+            if (this->skippingLine || this->lineEnded || this->readEnd >= keySize) {
+                this->partEnded = true;
+                break;
+            }
+
+            // The last line goes on after the range read so far, continue a chunk at a time.
+            uint64_t length = std::min(this->params.getChunkSize(), keySize - this->readEnd);
+
+            S3Params readerParams = this->constructReaderParams(this->currentPart);
+            readerParams.setKeyRange(this->readEnd, length);
+            readerParams.setNumOfChunks(1);
+
+            this->upstreamReader->release();
+            this->upstreamReader->close();
+            this->upstreamReader->open(readerParams);
+
+            this->readEnd += length;
+            this->readingTail = true;
+            continue;
+        }
+
+        const char* span = *data;
+        this->lineEnded = (span[readCount - 1] == lineEnd);
+
+        if (this->skippingLine) {
+            const char* first = (const char*)memchr(span, lineEnd, readCount);
+            if (first == NULL) {
+                continue;
+            }
+
+            // Skip the data before the line end, it doesn't need to be moved.
+            *data = first + 1;
+            readCount -= first + 1 - span;
+            this->skippingLine = false;
+        } else if (this->readingTail) {
+            const char* first = (const char*)memchr(span, lineEnd, readCount);
+            if (first != NULL) {
+                readCount = first + 1 - span;
+                this->partEnded = true;
+            }
+        }
+
+        if (readCount != 0) {
+            return readCount;
+        }
+    }
+
+    return 0;
+}
+
+uint64_t S3BucketReader::readWithoutHeaderLine(char* buf, const char** data, uint64_t count) {
+    const char* current = NULL;
+    const char* end = NULL;
     char* currentEOL = eolString;
 
     // check one char at a time
     while (*currentEOL != '\0') {
         if (current == end) {
-            uint64_t readCount = this->upstreamReader->read(buf, count);
+            uint64_t readCount = this->readUpstream(buf, data, count);
             // we have reach the end of file but found no matching EOL.
             if (readCount == 0) {
                 S3WARN("%s", "Reach end of file before matching line terminator");
                 return 0;
             }
 
-            current = buf;
-            end = buf + readCount;
+            current = *data;
+            end = *data + readCount;
         }
 
         // skip until we met next newline char
@@ -81,54 +337,92 @@ uint64_t S3BucketReader::readWithoutHeaderLine(char* buf, uint64_t count) {
         }
     }
 
-    // move remained data to front.
-    uint64_t remain = end - current;
-    char* p = buf;
-    while (current != end) {
-        *p = *current;
-        p++;
-        current++;
+    // Skip the header line, the remained data doesn't need to be moved to front.
+    *data = current;
+    return end - current;
+}
+
+// Read data into buf if it is given, otherwise borrow it from upstream reader. *data points to the
+// data, which is in buf or after it when read into buf.
+uint64_t S3BucketReader::readUpstream(char* buf, const char** data, uint64_t count) {
+    this->upstreamReader->release();
+
+    if (buf == NULL) {
+        return this->upstreamReader->borrow(data, count);
     }
 
-    return remain;
+    *data = buf;
+    return this->upstreamReader->read(buf, count);
 }
 
-uint64_t S3BucketReader::read(char* buf, uint64_t count) {
-    S3_CHECK_OR_DIE(this->upstreamReader != NULL, S3RuntimeError, "upstreamReader is NULL");
+uint64_t S3BucketReader::readData(char* buf, const char** data, uint64_t count) {
+    S3_CHECK_OR_DIE(this->upstreamReader != NULL || !this->prefetchReaders.empty(),
+                    S3RuntimeError, "upstreamReader is NULL");
     uint64_t readCount = 0;
     while (true) {
         if (this->needNewReader) {
-            if (this->keyIndex >= this->keyList.contents.size()) {
+            if (!this->openNextKey()) {
                 S3DEBUG("Read finished for segment: %d", s3ext_segid);
                 return 0;
             }
-            BucketContent& key = this->getNextKey();
-
-            this->upstreamReader->open(constructReaderParams(key));
             this->needNewReader = false;
 
             // ignore header line if it is not the first file
             if (hasHeader && !this->isFirstFile) {
-                readCount = readWithoutHeaderLine(buf, count);
+                readCount = readWithoutHeaderLine(buf, data, count);
                 if (readCount != 0) {
                     return readCount;
                 }
             }
         }
 
-        readCount = this->upstreamReader->read(buf, count);
+        readCount = this->readPart(buf, data, count);
         if (readCount != 0) {
             return readCount;
         }
 
         // Finished one file, continue to next
-        this->upstreamReader->close();
+        this->upstreamReader->release();
+        this->closeCurrentKey();
         this->needNewReader = true;
         this->isFirstFile = false;
     }
 }
 
+uint64_t S3BucketReader::read(char* buf, uint64_t count) {
+    const char* data = buf;
+    uint64_t readCount = this->readData(buf, &data, count);
+
+    // move remained data to front.
+    if (readCount != 0 && data != buf) {
+        memmove(buf, data, readCount);
+    }
+
+    return readCount;
+}
+
+uint64_t S3BucketReader::borrow(const char** data, uint64_t count) {
+    return this->readData(NULL, data, count);
+}
+
+void S3BucketReader::release() {
+    if (this->upstreamReader != NULL) {
+        this->upstreamReader->release();
+    }
+}
+
 void S3BucketReader::close() {
+    for (size_t i = 0; i < this->openedKeys.size(); i++) {
+        this->openedKeys[i].reader->close();
+        this->idleReaders.push_back(this->openedKeys[i].reader);
+    }
+    this->openedKeys.clear();
+    this->usedChunks = 0;
+
+    if (!this->prefetchReaders.empty()) {
+        this->upstreamReader = NULL;
+    }
+
     if (this->upstreamReader != NULL) {
         this->upstreamReader->close();
         this->upstreamReader = NULL;
@@ -137,4 +431,7 @@ void S3BucketReader::close() {
     if (!this->keyList.contents.empty()) {
         this->keyList.contents.clear();
     }
+
+    this->keyParts.clear();
+    this->keyPartIndex = 0;
 }
\ No newline at end of file
@@ -7,11 +7,21 @@ void S3CommonReader::open(const S3Params &params) {
 
     switch (compressionType) {
         case S3_COMPRESSION_GZIP:
+        case S3_COMPRESSION_ZSTD:
+        case S3_COMPRESSION_LZ4:
+        case S3_COMPRESSION_BZIP2:
             this->upstreamReader = &this->decompressReader;
+            this->decompressReader.setCompressionType(compressionType);
             this->decompressReader.setReader(&this->keyReader);
             break;
         case S3_COMPRESSION_PLAIN:
-            this->upstreamReader = &this->keyReader;
+            if (params.getColumns().empty()) {
+                this->upstreamReader = &this->keyReader;
+            } else {
+                this->upstreamReader = &this->parquetReader;
+                this->parquetReader.setS3InterfaceService(s3InterfaceService);
+                this->parquetReader.setReader(&this->keyReader);
+            }
             break;
         default:
             S3_CHECK_OR_DIE(false, S3RuntimeError, "unknown file type");
@@ -26,6 +36,16 @@ uint64_t S3CommonReader::read(char *buf, uint64_t count) {
     return this->upstreamReader->read(buf, count);
 }
 
+uint64_t S3CommonReader::borrow(const char **data, uint64_t count) {
+    return this->upstreamReader->borrow(data, count);
+}
+
+void S3CommonReader::release() {
+    if (this->upstreamReader != NULL) {
+        this->upstreamReader->release();
+    }
+}
+
 // This should be reentrant, has no side effects when called multiple times.
 void S3CommonReader::close() {
     if (this->upstreamReader != NULL) {
@@ -70,6 +70,17 @@ S3Params InitConfig(const string& urlWithOptions) {
 
     S3Params params(sourceUrl, useHttps, version, urlRegion);
 
+    // columns to read of Parquet keys, separated by ','
+    vector<string> columns;
+    stringstream columnList(GetOptS3(urlWithOptions, "columns"));
+    string column;
+    while (std::getline(columnList, column, ',')) {
+        if (!column.empty()) {
+            columns.push_back(column);
+        }
+    }
+    params.setColumns(columns);
+
     string sse_type = s3Cfg.Get(configSection, "server_side_encryption", "");
     if (sse_type == "sse-s3") {
         params.setSSEType(SSE_S3);
@@ -85,6 +96,14 @@ S3Params InitConfig(const string& urlWithOptions) {
 
     params.setDebugCurl(s3Cfg.GetBool(configSection, "debug_curl", "false"));
 
+    params.setAutoCompress(s3Cfg.GetBool(configSection, "autocompress", "true"));
+    params.setGzipParallel(s3Cfg.GetBool(configSection, "gzip_parallel", "false"));
+
+    int64_t gzipLevel = s3Cfg.SafeScan("gzip_level", configSection, 6, 1, 9);
+    params.setGzipLevel(gzipLevel);
+
+    params.setDecompressThread(s3Cfg.GetBool(configSection, "decompress_thread", "true"));
+
     params.setCred(s3Cfg.Get(configSection, "accessid", ""), s3Cfg.Get(configSection, "secret", ""),
                    s3Cfg.Get(configSection, "token", ""));
 
@@ -99,12 +118,30 @@ S3Params InitConfig(const string& urlWithOptions) {
                                        8 * 1024 * 1024, 128 * 1024 * 1024);
     params.setChunkSize(chunkSize);
 
+    int64_t splitSize = s3Cfg.SafeScan("split_size", configSection, 0, 0, INT64_MAX);
+    params.setSplitSize(splitSize);
+
     int64_t lowSpeedLimit = s3Cfg.SafeScan("low_speed_limit", configSection, 10240, 0, INT_MAX);
     params.setLowSpeedLimit(lowSpeedLimit);
 
     int64_t lowSpeedTime = s3Cfg.SafeScan("low_speed_time", configSection, 60, 0, INT_MAX);
     params.setLowSpeedTime(lowSpeedTime);
 
+    int64_t maxConnections = s3Cfg.SafeScan("max_connections", configSection, 8, 0, 64);
+    params.setMaxConnections(maxConnections);
+
+    int64_t connectionIdleTimeout =
+        s3Cfg.SafeScan("connection_idle_timeout", configSection, 60, 1, 3600);
+    params.setConnectionIdleTimeout(connectionIdleTimeout);
+
+    if (s3Cfg.GetBool(configSection, "list_cache", "true")) {
+        params.setListCacheDir(
+            s3Cfg.Get(configSection, "list_cache_dir", "/tmp/gpcloud_list_cache"));
+    }
+
+    int64_t listCacheTtl = s3Cfg.SafeScan("list_cache_ttl", configSection, 0, 0, 86400);
+    params.setListCacheTtl(listCacheTtl);
+
     params.setProxy(s3Cfg.Get(configSection, "proxy", ""));
 
     params.setGpcheckcloud_newline(s3Cfg.Get(configSection, "gpcheckcloud_newline", "\n"));
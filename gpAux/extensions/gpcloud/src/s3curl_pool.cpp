@@ -0,0 +1,147 @@
+#include "s3curl_pool.h"
+
+S3CurlPool& S3CurlPool::getInstance() {
+    static S3CurlPool pool;
+    return pool;
+}
+
+S3CurlPool::S3CurlPool() {
+    curl_global_init(CURL_GLOBAL_ALL);
+
+    pthread_mutex_init(&this->poolLock, NULL);
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        pthread_mutex_init(&this->shareLocks[i], NULL);
+    }
+
+    this->share = curl_share_init();
+    curl_share_setopt(this->share, CURLSHOPT_LOCKFUNC, S3CurlPool::lockShare);
+    curl_share_setopt(this->share, CURLSHOPT_UNLOCKFUNC, S3CurlPool::unlockShare);
+    curl_share_setopt(this->share, CURLSHOPT_USERDATA, (void*)this->shareLocks);
+    curl_share_setopt(this->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(this->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+}
+
+S3CurlPool::~S3CurlPool() {
+    map<string, vector<IdleHandle> >::iterator it;
+    for (it = this->idleHandles.begin(); it != this->idleHandles.end(); it++) {
+        for (size_t i = 0; i < it->second.size(); i++) {
+            curl_easy_cleanup(it->second[i].handle);
+        }
+    }
+    this->idleHandles.clear();
+
+    // Handles must be gone before the share they use.
+    curl_share_cleanup(this->share);
+
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        pthread_mutex_destroy(&this->shareLocks[i]);
+    }
+    pthread_mutex_destroy(&this->poolLock);
+
+    curl_global_cleanup();
+}
+
+void S3CurlPool::lockShare(CURL* handle, curl_lock_data data, curl_lock_access access,
+                           void* userp) {
+    pthread_mutex_t* locks = (pthread_mutex_t*)userp;
+    pthread_mutex_lock(&locks[data]);
+}
+
+void S3CurlPool::unlockShare(CURL* handle, curl_lock_data data, void* userp) {
+    pthread_mutex_t* locks = (pthread_mutex_t*)userp;
+    pthread_mutex_unlock(&locks[data]);
+}
+
+// The part of url that identifies the connection, e.g.
+// "https://s3-us-west-2.amazonaws.com" of
+// "https://s3-us-west-2.amazonaws.com/bucket/key".
+string S3CurlPool::getEndpoint(const string& url) {
+    size_t hostBegin = url.find("://");
+    hostBegin = (hostBegin == string::npos) ? 0 : hostBegin + strlen("://");
+
+    size_t hostEnd = url.find_first_of("/?", hostBegin);
+    return url.substr(0, hostEnd);
+}
+
+void S3CurlPool::evictExpired(time_t now) {
+    map<string, vector<IdleHandle> >::iterator it = this->idleHandles.begin();
+    while (it != this->idleHandles.end()) {
+        vector<IdleHandle>& handles = it->second;
+
+        size_t kept = 0;
+        for (size_t i = 0; i < handles.size(); i++) {
+            if (handles[i].expireAt <= now) {
+                curl_easy_cleanup(handles[i].handle);
+            } else {
+                handles[kept++] = handles[i];
+            }
+        }
+        handles.resize(kept);
+
+        if (handles.empty()) {
+            this->idleHandles.erase(it++);
+        } else {
+            it++;
+        }
+    }
+}
+
+CURL* S3CurlPool::acquire(const string& url) {
+    CURL* handle = NULL;
+    {
+        UniqueLock lock(&this->poolLock);
+
+        this->evictExpired(time(NULL));
+
+        map<string, vector<IdleHandle> >::iterator it =
+            this->idleHandles.find(getEndpoint(url));
+        if (it != this->idleHandles.end()) {
+            handle = it->second.back().handle;
+            it->second.pop_back();
+            if (it->second.empty()) {
+                this->idleHandles.erase(it);
+            }
+        }
+    }
+
+    if (handle == NULL) {
+        handle = curl_easy_init();
+        S3_CHECK_OR_DIE(handle != NULL, S3RuntimeError, "Failed to create curl handle");
+    }
+
+    curl_easy_setopt(handle, CURLOPT_SHARE, this->share);
+    return handle;
+}
+
+void S3CurlPool::release(const string& url, CURL* handle, uint64_t maxIdle,
+                         uint64_t idleTimeout) {
+    // Drop the options of the finished request, it keeps its live connection.
+    curl_easy_reset(handle);
+
+    {
+        UniqueLock lock(&this->poolLock);
+
+        time_t now = time(NULL);
+        this->evictExpired(now);
+
+        vector<IdleHandle>& handles = this->idleHandles[getEndpoint(url)];
+        if (handles.size() < maxIdle) {
+            IdleHandle idle = {handle, now + (time_t)idleTimeout};
+            handles.push_back(idle);
+            return;
+        }
+
+        if (handles.empty()) {
+            this->idleHandles.erase(getEndpoint(url));
+        }
+    }
+
+    curl_easy_cleanup(handle);
+}
+
+size_t S3CurlPool::getIdleCount(const string& url) {
+    UniqueLock lock(&this->poolLock);
+
+    map<string, vector<IdleHandle> >::iterator it = this->idleHandles.find(getEndpoint(url));
+    return (it == this->idleHandles.end()) ? 0 : it->second.size();
+}
@@ -29,6 +29,8 @@ ChunkBuffer::ChunkBuffer(const S3Url& s3Url, S3KeyReader& reader, const S3Memory
     status = ReadyToFill;
     eof = false;
     curChunkOffset = 0;
+    lentLen = 0;
+    lentAll = false;
     pthread_mutex_init(&this->statusMutex, NULL);
     pthread_cond_init(&this->statusCondVar, NULL);
 }
@@ -45,6 +47,8 @@ ChunkBuffer& ChunkBuffer::operator=(const ChunkBuffer& other) {
     this->curFileOffset = other.curFileOffset;
     this->curChunkOffset = other.curChunkOffset;
     this->chunkDataSize = other.chunkDataSize;
+    this->lentLen = other.lentLen;
+    this->lentAll = other.lentAll;
 
     return *this;
 }
@@ -53,6 +57,19 @@ ChunkBuffer& ChunkBuffer::operator=(const ChunkBuffer& other) {
 // that's why it checks if leftLen is larger than *or equal to* len below[1], provides a chance ret
 // is 0, which is smaller than len. Otherwise, other functions won't know when to read next buffer.
 uint64_t ChunkBuffer::read(char* buf, uint64_t len) {
+    const char* data = NULL;
+    uint64_t lenToRead = this->borrow(&data, len);
+
+    if (lenToRead != 0) {
+        memcpy(buf, data, lenToRead);
+    }
+
+    this->release();
+
+    return lenToRead;
+}
+
+uint64_t ChunkBuffer::borrow(const char** data, uint64_t len) {
     // GPDB abort signal stops s3_import(), this check is not needed if s3_import() every time calls
     // ChunkBuffer->Read() only once, otherwise(as we did in downstreamReader->read() for
     // decompression feature before), first call sets buffer to ReadyToFill, second call hangs.
@@ -63,21 +80,31 @@ uint64_t ChunkBuffer::read(char* buf, uint64_t len) {
         pthread_cond_wait(&this->statusCondVar, &this->statusMutex);
     }
 
+    this->lentLen = 0;
+    this->lentAll = false;
+
     // Error is shared between all chunks.
     if (this->isError()) {
         return 0;
     }
 
+    // chunkData is not touched by the downloading thread until the chunk is ReadyToFill, which is
+    // not before release().
     uint64_t leftLen = this->chunkDataSize - this->curChunkOffset;
-    uint64_t lenToRead = std::min(len, leftLen);
 
-    if (lenToRead != 0) {
-        memcpy(buf, this->chunkData.data() + this->curChunkOffset, lenToRead);
-    }
+    this->lentLen = std::min(len, leftLen);
+    this->lentAll = (len > leftLen);  // [1]
+    *data = (const char*)this->chunkData.data() + this->curChunkOffset;
+
+    return this->lentLen;
+}
+
+void ChunkBuffer::release() {
+    UniqueLock statusLock(&this->statusMutex);
 
-    if (len <= leftLen) {                   // [1]
-        this->curChunkOffset += lenToRead;  // not empty
-    } else {                                // empty, reset everything
+    if (!this->lentAll) {
+        this->curChunkOffset += this->lentLen;  // not empty
+    } else {                                    // empty, reset everything
         this->curChunkOffset = 0;
 
         if (!this->isEOF()) {
@@ -94,7 +121,8 @@ uint64_t ChunkBuffer::read(char* buf, uint64_t len) {
         }
     }
 
-    return lenToRead;
+    this->lentLen = 0;
+    this->lentAll = false;
 }
 
 // returning uint64_t(-1) means error
@@ -189,9 +217,20 @@ void S3KeyReader::open(const S3Params& params) {
     this->numOfChunks = params.getNumOfChunks();
     S3_CHECK_OR_DIE(this->numOfChunks > 0, S3RuntimeError, "numOfChunks must not be zero");
 
-    this->offsetMgr.setKeySize(params.getKeySize());
+    // Download the requested range only, the offset manager sees its end as the end of key.
+    uint64_t rangeEnd = params.getKeySize();
+    if (params.getKeyRangeLength() != 0) {
+        rangeEnd = std::min(rangeEnd, params.getKeyRangeOffset() + params.getKeyRangeLength());
+    }
+    uint64_t rangeOffset = std::min(params.getKeyRangeOffset(), rangeEnd);
+
+    this->offsetMgr.setKeySize(rangeEnd);
+    this->offsetMgr.setCurPos(rangeOffset);
     this->offsetMgr.setChunkSize(params.getChunkSize());
 
+    this->transferredKeyLen = rangeOffset;
+    this->readsToKeyEnd = (rangeEnd == params.getKeySize());
+
     S3_CHECK_OR_DIE(params.getChunkSize() > 0, S3RuntimeError,
                     "chunk size must be greater than zero");
 
@@ -211,19 +250,30 @@ void S3KeyReader::open(const S3Params& params) {
 }
 
 uint64_t S3KeyReader::read(char* buf, uint64_t count) {
+    const char* data = NULL;
+    uint64_t readLen = this->borrow(&data, count);
+
+    if (readLen != 0) {
+        memcpy(buf, data, readLen);
+    }
+
+    this->release();
+
+    return readLen;
+}
+
+uint64_t S3KeyReader::borrow(const char** data, uint64_t count) {
     uint64_t fileLen = this->offsetMgr.getKeySize();
     uint64_t readLen = 0;
 
     do {
         // confirm there is no more available data, done with this file
         if (this->transferredKeyLen >= fileLen) {
-            if (!this->hasEol && !this->eolAppended) {
-                uint64_t eolLen = strlen(eolString);
-                strncpy(buf, eolString, eolLen);
-
+            if (!this->hasEol && !this->eolAppended && this->readsToKeyEnd) {
                 this->eolAppended = true;
 
-                return eolLen;
+                *data = eolString;
+                return std::min((uint64_t)strlen(eolString), count);
             }
 
             return 0;
@@ -231,9 +281,11 @@ uint64_t S3KeyReader::read(char* buf, uint64_t count) {
 
         ChunkBuffer& buffer = chunkBuffers[this->curReadingChunk % this->numOfChunks];
 
-        readLen = buffer.read(buf, count);
+        readLen = buffer.borrow(data, count);
 
         if (this->isSharedError()) {
+            buffer.release();
+
             if (this->sharedException != NULL) {
                 std::rethrow_exception(this->sharedException);
             } else {
@@ -242,8 +294,8 @@ uint64_t S3KeyReader::read(char* buf, uint64_t count) {
         }
 
         this->transferredKeyLen += readLen;
-        if (this->transferredKeyLen == fileLen) {
-            if (buf[readLen - 1] == '\r' || buf[readLen - 1] == '\n') {
+        if (this->transferredKeyLen == fileLen && readLen != 0) {
+            if ((*data)[readLen - 1] == '\r' || (*data)[readLen - 1] == '\n') {
                 this->hasEol = true;
             }
         }
@@ -252,16 +304,28 @@ uint64_t S3KeyReader::read(char* buf, uint64_t count) {
             this->curReadingChunk++;
         }
 
-        count -= readLen;
+        if (readLen == 0) {
+            buffer.release();
+        } else {
+            this->lendingChunk = &buffer;
+        }
     } while (readLen == 0);  // retry to confirm whether thread reading is finished or chunk size is
                              // divisible by get()'s buffer size
 
     return readLen;
 }
 
+void S3KeyReader::release() {
+    if (this->lendingChunk != NULL) {
+        this->lendingChunk->release();
+        this->lendingChunk = NULL;
+    }
+}
+
 // reset marks before reading next key
 void S3KeyReader::reset() {
     this->sharedError = false;
+    this->lendingChunk = NULL;
     this->curReadingChunk = 0;
     this->transferredKeyLen = 0;
 
@@ -272,6 +336,7 @@ void S3KeyReader::reset() {
 
     this->hasEol = false;
     this->eolAppended = false;
+    this->readsToKeyEnd = true;
 }
 
 void S3KeyReader::close() {
@@ -6,13 +6,19 @@ void S3KeyWriter::open(const S3Params& params) {
     S3_CHECK_OR_DIE(this->s3Interface != NULL, S3RuntimeError, "s3Interface must not be NULL");
     S3_CHECK_OR_DIE(this->params.getChunkSize() > 0, S3RuntimeError, "chunkSize must not be zero");
 
-    buffer.reserve(this->params.getChunkSize());
+    this->partNumber = 0;
+    this->sharedError = false;
+    this->sharedException = std::exception_ptr();
+
+    buffer.reserve(this->getPartSize());
 
     this->uploadId = this->s3Interface->getUploadId(this->params.getS3Url());
     S3_CHECK_OR_DIE(!this->uploadId.empty(), S3RuntimeError, "Failed to get upload id");
 
     S3DEBUG("key: %s, upload id: %s", this->params.getS3Url().getFullUrlForCurl().c_str(),
             this->uploadId.c_str());
+
+    this->startThreads();
 }
 
 // write() first fills up the data buffer before flush it out
@@ -27,13 +33,13 @@ uint64_t S3KeyWriter::write(const char* buf, uint64_t count) {
             std::rethrow_exception(sharedException);
         }
 
-        uint64_t bufferRemaining = this->params.getChunkSize() - this->buffer.size();
+        uint64_t bufferRemaining = this->getPartSize() - this->buffer.size();
         uint64_t dataRemaining = count - offset;
         uint64_t dataToBuffer = bufferRemaining < dataRemaining ? bufferRemaining : dataRemaining;
 
         this->buffer.insert(this->buffer.end(), buf + offset, buf + offset + dataToBuffer);
 
-        if (this->buffer.size() == this->params.getChunkSize()) {
+        if (this->buffer.size() == this->getPartSize()) {
             this->flushBuffer();
         }
 
@@ -45,103 +51,221 @@ uint64_t S3KeyWriter::write(const char* buf, uint64_t count) {
 
 // This should be reentrant, has no side effects when called multiple times.
 void S3KeyWriter::close() {
-    if (!this->uploadId.empty()) {
+    if (this->uploadId.empty()) {
+        return;
+    }
+
+    try {
         this->completeKeyWriting();
+    } catch (S3QueryAbort& e) {
+        throw;
+    } catch (...) {
+        // Do not leave the uploaded parts behind, they are kept and billed until aborted.
+        this->abortKeyWriting();
+        throw;
     }
 }
 
 void S3KeyWriter::checkQueryCancelSignal() {
     if (S3QueryIsAbortInProgress() && !this->uploadId.empty()) {
-        // to avoid dead-lock when other upload threads hold the lock
-        pthread_mutex_unlock(&this->mutex);
+        this->abortKeyWriting();
 
-        // wait for all threads to complete
-        for (size_t i = 0; i < threadList.size(); i++) {
-            pthread_join(threadList[i], NULL);
-        }
-        this->threadList.clear();
+        S3_DIE(S3QueryAbort, "Uploading is interrupted");
+    }
+}
 
-        // to avoid double unlock as other parts may lock it
-        pthread_mutex_lock(&this->mutex);
+// Stop the upload threads and abort the upload. Parts being retried give up.
+void S3KeyWriter::abortKeyWriting() {
+    this->stopThreads();
 
-        S3DEBUG("Start aborting multipart uploading (uploadID: %s, %lu parts uploaded)",
-                this->uploadId.c_str(), this->etagList.size());
+    S3DEBUG("Start aborting multipart uploading (uploadID: %s, %lu parts uploaded)",
+            this->uploadId.c_str(), this->etagList.size());
+    try {
         this->s3Interface->abortUpload(this->params.getS3Url(), this->uploadId);
         S3DEBUG("Finished aborting multipart uploading (uploadID: %s)", this->uploadId.c_str());
+    } catch (S3Exception& e) {
+        S3ERROR("Failed to abort multipart uploading (uploadID: %s): %s", this->uploadId.c_str(),
+                e.getMessage().c_str());
+    }
 
-        this->etagList.clear();
-        this->uploadId.clear();
+    this->buffer.clear();
+    this->etagList.clear();
+    this->uploadId.clear();
+}
 
-        S3_DIE(S3QueryAbort, "Uploading is interrupted");
+// S3 allows no more than S3_UPLOAD_MAX_PARTS parts, parts are bigger by chunksize every
+// S3_UPLOAD_PARTS_PER_SIZE_STEP parts, so that a key of 55 times S3_UPLOAD_PARTS_PER_SIZE_STEP
+// chunks still fits, with parts of no more than 10 chunks.
+uint64_t S3KeyWriter::getPartSize() const {
+    return this->params.getChunkSize() * (1 + this->partNumber / S3_UPLOAD_PARTS_PER_SIZE_STEP);
+}
+
+bool S3KeyWriter::isRetryable(S3Exception& e) {
+    if (dynamic_cast<S3LogicError*>(&e) != NULL) {
+        // Errors of the service side, others such as AccessDenied fail the same way again.
+        const string& code = static_cast<S3LogicError&>(e).awscode;
+        return code == "RequestTimeout" || code == "InternalError" || code == "SlowDown" ||
+               code == "ServiceUnavailable";
     }
+
+    return dynamic_cast<S3ConnectionError*>(&e) != NULL ||
+           dynamic_cast<S3FailedAfterRetry*>(&e) != NULL ||
+           dynamic_cast<S3PartialResponseError*>(&e) != NULL;
 }
 
-struct ThreadParams {
-    S3KeyWriter* keyWriter;
-    S3VectorUInt8 data;
-    uint64_t currentNumber;
-};
+// Upload a part, retrying it with backoff on errors that may go away.
+string S3KeyWriter::uploadPart(UploadPart& part) {
+    uint64_t delay = this->retryDelay;
+    for (uint64_t retry = 0;; retry++) {
+        try {
+            return this->s3Interface->uploadPartOfData(part.data, this->params.getS3Url(),
+                                                       part.number, this->uploadId);
+        } catch (S3Exception& e) {
+            if (retry >= S3_UPLOAD_PART_MAX_RETRIES || !isRetryable(e) ||
+                S3QueryIsAbortInProgress()) {
+                throw;
+            }
+
+            S3WARN("Failed to upload part %" PRIu64 ": %s, retrying in %" PRIu64 " ms",
+                   part.number, e.getMessage().c_str(), delay);
+        }
+
+        // Sleep in steps, to give up soon once the query is cancelled or the upload is aborted.
+        for (uint64_t slept = 0; slept < delay && !this->stopping && !S3QueryIsAbortInProgress();
+             slept += 10) {
+            usleep(10 * 1000);
+        }
+        if (this->stopping || S3QueryIsAbortInProgress()) {
+            return "";
+        }
 
-void* S3KeyWriter::UploadThreadFunc(void* data) {
+        delay *= 2;
+    }
+}
+
+void* S3KeyWriter::UploadThreadFunc(void* p) {
     MaskThreadSignals();
 
-    ThreadParams* params = (ThreadParams*)data;
-    S3KeyWriter* writer = params->keyWriter;
+    S3KeyWriter* writer = static_cast<S3KeyWriter*>(p);
 
-    try {
-        S3DEBUG("Upload thread start: %p, part number: %" PRIu64 ", data size: %" PRIu64,
-                pthread_self(), params->currentNumber, params->data.size());
-        string etag = writer->s3Interface->uploadPartOfData(
-            params->data, writer->params.getS3Url(), params->currentNumber, writer->uploadId);
+    UniqueLock lock(&writer->mutex);
+    while (true) {
+        while (writer->todoList.empty() && !writer->stopping) {
+            pthread_cond_wait(&writer->cv, &writer->mutex);
+        }
 
-        // when unique_lock destructs it will automatically unlock the mutex.
-        UniqueLock threadLock(&writer->mutex);
+        // Parts queued before stopping are uploaded still, no more than threadnum of them.
+        if (writer->todoList.empty()) {
+            break;
+        }
+
+        UploadPart part;
+        part.number = writer->todoList.front().number;
+        part.data.swap(writer->todoList.front().data);
+        writer->todoList.pop_front();
+
+        pthread_mutex_unlock(&writer->mutex);
+
+        string etag;
+        if (!writer->sharedError) {
+            try {
+                S3DEBUG("Upload part start: %p, part number: %" PRIu64 ", data size: %zu",
+                        pthread_self(), part.number, part.data.size());
+                etag = writer->uploadPart(part);
+                S3DEBUG("Upload part finish: %p, eTag: %s, part number: %" PRIu64,
+                        pthread_self(), etag.c_str(), part.number);
+            } catch (S3Exception& e) {
+                S3ERROR("Upload thread error: %s", e.getMessage().c_str());
+                UniqueLock exceptLock(&writer->exceptionMutex);
+                writer->sharedError = true;
+                writer->sharedException = std::current_exception();
+            }
+        }
+
+        // Release the memory of the part before another one is queued.
+        part.data.release();
+
+        pthread_mutex_lock(&writer->mutex);
 
         // etag is empty if the query is cancelled by user.
         if (!etag.empty()) {
-            writer->etagList[params->currentNumber] = etag;
+            writer->etagList[part.number] = etag;
         }
-        writer->activeThreads--;
-        pthread_cond_broadcast(&writer->cv);
-        S3DEBUG("Upload part finish: %p, eTag: %s, part number: %" PRIu64, pthread_self(),
-                etag.c_str(), params->currentNumber);
-    } catch (S3Exception& e) {
-        S3ERROR("Upload thread error: %s", e.getMessage().c_str());
-        UniqueLock exceptLock(&writer->exceptionMutex);
-        writer->sharedError = true;
-        writer->sharedException = std::current_exception();
-
-        // notify the flushBuffer, otherwise it will be locked when trying to create a new thread.
-        writer->activeThreads--;
+        writer->pendingParts--;
         pthread_cond_broadcast(&writer->cv);
     }
 
-    delete params;
     return NULL;
 }
 
+void S3KeyWriter::startThreads() {
+    this->stopping = false;
+    this->pendingParts = 0;
+
+    for (uint64_t i = 0; i < this->params.getNumOfChunks(); i++) {
+        pthread_t thread;
+        pthread_create(&thread, NULL, UploadThreadFunc, this);
+        this->threadList.push_back(thread);
+    }
+}
+
+// Stop the upload threads once they are done with the parts queued.
+void S3KeyWriter::stopThreads() {
+    if (this->threadList.empty()) {
+        return;
+    }
+
+    {
+        UniqueLock lock(&this->mutex);
+        this->stopping = true;
+        pthread_cond_broadcast(&this->cv);
+    }
+
+    for (size_t i = 0; i < this->threadList.size(); i++) {
+        pthread_join(this->threadList[i], NULL);
+    }
+    this->threadList.clear();
+}
+
+void S3KeyWriter::waitForUploads() {
+    UniqueLock lock(&this->mutex);
+    while (this->pendingParts > 0) {
+        pthread_cond_wait(&this->cv, &this->mutex);
+    }
+}
+
 void S3KeyWriter::flushBuffer() {
     if (!this->buffer.empty()) {
-        UniqueLock queueLock(&this->mutex);
-        while (this->activeThreads >= this->params.getNumOfChunks()) {
-            pthread_cond_wait(&this->cv, &this->mutex);
+        {
+            UniqueLock queueLock(&this->mutex);
+            while (this->pendingParts >= this->params.getNumOfChunks() && !this->sharedError) {
+                pthread_cond_wait(&this->cv, &this->mutex);
+            }
         }
 
         // Most time query is canceled during uploadPartOfData(). This is the first chance to cancel
         // and clean up upload.
         this->checkQueryCancelSignal();
 
-        this->activeThreads++;
+        if (this->sharedError) {
+            std::rethrow_exception(this->sharedException);
+        }
+
+        S3_CHECK_OR_DIE(this->partNumber < S3_UPLOAD_MAX_PARTS, S3RuntimeError,
+                        "Too many parts to upload, try a bigger chunksize");
 
-        pthread_t writerThread;
-        ThreadParams* params = new ThreadParams();
-        params->keyWriter = this;
-        params->data.swap(this->buffer);
-        params->currentNumber = ++this->partNumber;
-        pthread_create(&writerThread, NULL, UploadThreadFunc, params);
-        threadList.emplace_back(writerThread);
+        {
+            UniqueLock queueLock(&this->mutex);
 
-        this->buffer.reserve(this->params.getChunkSize());
+            this->todoList.emplace_back();
+            this->todoList.back().number = ++this->partNumber;
+            this->todoList.back().data.swap(this->buffer);
+            this->pendingParts++;
+
+            pthread_cond_signal(&this->cv);
+        }
+
+        this->buffer.reserve(this->getPartSize());
     }
 }
 
@@ -149,14 +273,15 @@ void S3KeyWriter::completeKeyWriting() {
     // make sure the buffer is clear
     this->flushBuffer();
 
-    // wait for all threads to complete
-    for (size_t i = 0; i < threadList.size(); i++) {
-        pthread_join(threadList[i], NULL);
-    }
-    this->threadList.clear();
+    this->waitForUploads();
+    this->stopThreads();
 
     this->checkQueryCancelSignal();
 
+    if (this->sharedError) {
+        std::rethrow_exception(this->sharedException);
+    }
+
     vector<string> etags;
     // it is equivalent to foreach(e in etagList) push_back(e.second);
     // transform(etagList.begin(), etagList.end(), etags.begin(),
@@ -0,0 +1,192 @@
+#include "s3listing_cache.h"
+
+#include <errno.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define S3_LISTING_CACHE_MAGIC "gpcloud listing 1"
+
+// S3 key names are up to 1024 bytes, anything much longer is a corrupted file.
+#define S3_LISTING_CACHE_MAX_STRING_LEN 65536
+
+// Holds an exclusive flock() on a file until it goes out of scope.
+class FileLockHolder {
+   public:
+    FileLockHolder() : fd(-1) {
+    }
+    ~FileLockHolder() {
+        if (this->fd >= 0) {
+            flock(this->fd, LOCK_UN);
+            ::close(this->fd);
+        }
+    }
+
+    bool lock(const string& path) {
+        this->fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0600);
+        if (this->fd < 0) {
+            return false;
+        }
+
+        int ret;
+        do {
+            ret = flock(this->fd, LOCK_EX);
+        } while (ret != 0 && errno == EINTR);
+
+        return ret == 0;
+    }
+
+   private:
+    int fd;
+};
+
+static void writeString(FILE* file, const string& str) {
+    fprintf(file, "%zu ", str.size());
+    fwrite(str.data(), 1, str.size(), file);
+    fputc('\n', file);
+}
+
+static bool readString(FILE* file, string& str) {
+    uint64_t len;
+    if (fscanf(file, "%" SCNu64, &len) != 1 || fgetc(file) != ' ' ||
+        len > S3_LISTING_CACHE_MAX_STRING_LEN) {
+        return false;
+    }
+
+    str.resize(len);
+    if (len > 0 && fread(&str[0], 1, len, file) != len) {
+        return false;
+    }
+
+    return fgetc(file) == '\n';
+}
+
+S3ListingCache::S3ListingCache(const string& dir, uint64_t ttl) : dir(dir), ttl(ttl) {
+}
+
+ListBucketResult S3ListingCache::listBucket(S3Interface* s3Interface, S3Url& s3Url,
+                                            const S3Credential& cred) {
+    if (this->dir.empty() || !this->prepareDir()) {
+        return s3Interface->listBucket(s3Url);
+    }
+
+    string path = this->getCachePath(s3Url, cred);
+
+    // A listing finished after we start waiting is shared even with ttl 0.
+    uint64_t startTime = now();
+    uint64_t freshSince = startTime > this->ttl * 1000000 ? startTime - this->ttl * 1000000 : 0;
+
+    FileLockHolder lockHolder;
+    if (!lockHolder.lock(path + ".lock")) {
+        S3WARN("Failed to lock listing cache '%s': %s", path.c_str(), strerror(errno));
+        return s3Interface->listBucket(s3Url);
+    }
+
+    ListBucketResult result;
+    if (this->load(path, freshSince, result)) {
+        S3INFO("Listing of '%s' is read from cache", s3Url.getFullUrlForCurl().c_str());
+        return result;
+    }
+
+    result = s3Interface->listBucket(s3Url);
+    this->save(path, result, now());
+
+    return result;
+}
+
+// The cache key covers the access id as well, a listing is not shared with a
+// credential that might not be allowed to list the location.
+string S3ListingCache::getCacheKey(const S3Url& s3Url, const S3Credential& cred) {
+    string source =
+        s3Url.getFullUrlForCurl() + "\n" + s3Url.getRegion() + "\n" + cred.accessID + "\n";
+
+    char hash[SHA256_DIGEST_STRING_LENGTH];
+    sha256_hex(source.data(), source.size(), hash);
+
+    return string(hash);
+}
+
+// The directory must be owned by us and accessible by us only, otherwise
+// someone else could feed us a listing.
+bool S3ListingCache::prepareDir() {
+    if (mkdir(this->dir.c_str(), 0700) != 0 && errno != EEXIST) {
+        S3WARN("Failed to create listing cache directory '%s': %s", this->dir.c_str(),
+               strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (lstat(this->dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode) || st.st_uid != geteuid() ||
+        (st.st_mode & (S_IRWXG | S_IRWXO)) != 0) {
+        S3WARN("Listing cache directory '%s' is not a directory accessible by this user only",
+               this->dir.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool S3ListingCache::load(const string& path, uint64_t freshSince, ListBucketResult& result) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (file == NULL) {
+        return false;
+    }
+
+    char magic[sizeof(S3_LISTING_CACHE_MAGIC)];
+    uint64_t listedAt;
+    uint64_t count;
+
+    bool loaded =
+        fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+        memcmp(magic, S3_LISTING_CACHE_MAGIC "\n", sizeof(magic)) == 0 &&
+        fscanf(file, "%" SCNu64 " %" SCNu64, &listedAt, &count) == 2 && fgetc(file) == '\n' &&
+        listedAt > freshSince && readString(file, result.Name) && readString(file, result.Prefix);
+
+    result.contents.clear();
+    for (uint64_t i = 0; loaded && i < count; i++) {
+        BucketContent content;
+        loaded = fscanf(file, "%" SCNu64, &content.size) == 1 && fgetc(file) == ' ' &&
+                 readString(file, content.name);
+        result.contents.push_back(content);
+    }
+
+    loaded = loaded && fgetc(file) == EOF;
+    fclose(file);
+
+    return loaded;
+}
+
+// Write into a temporary file and rename it, so that a listing is never read half written, e.g.
+// after a crash.
+void S3ListingCache::save(const string& path, const ListBucketResult& result, uint64_t listedAt) {
+    string tmpPath = path + ".tmp";
+
+    FILE* file = fopen(tmpPath.c_str(), "w");
+    if (file == NULL) {
+        S3WARN("Failed to save listing cache '%s': %s", path.c_str(), strerror(errno));
+        return;
+    }
+
+    fprintf(file, "%s\n%" PRIu64 " %zu\n", S3_LISTING_CACHE_MAGIC, listedAt,
+            result.contents.size());
+    writeString(file, result.Name);
+    writeString(file, result.Prefix);
+
+    for (size_t i = 0; i < result.contents.size(); i++) {
+        fprintf(file, "%" PRIu64 " ", result.contents[i].size);
+        writeString(file, result.contents[i].name);
+    }
+
+    bool written = !ferror(file);
+    if (fclose(file) != 0 || !written || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        S3WARN("Failed to save listing cache '%s': %s", path.c_str(), strerror(errno));
+        unlink(tmpPath.c_str());
+    }
+}
+
+uint64_t S3ListingCache::now() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
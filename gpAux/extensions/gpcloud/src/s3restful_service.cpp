@@ -3,6 +3,8 @@
 S3RESTfulService::S3RESTfulService()
     : lowSpeedLimit(0),
       lowSpeedTime(0),
+      maxConnections(0),
+      connectionIdleTimeout(0),
       proxy(""),
       debugCurl(false),
       verifyCert(true),
@@ -12,6 +14,8 @@ S3RESTfulService::S3RESTfulService()
 S3RESTfulService::S3RESTfulService(const string &proxy)
     : lowSpeedLimit(0),
       lowSpeedTime(0),
+      maxConnections(0),
+      connectionIdleTimeout(0),
       proxy(proxy),
       debugCurl(false),
       verifyCert(true),
@@ -30,6 +34,13 @@ S3RESTfulService::S3RESTfulService(const S3Params &params)
     this->chunkBufferSize = params.getChunkSize();
     this->verifyCert = params.isVerifyCert();
     this->proxy = params.getProxy();
+
+    this->maxConnections = params.getMaxConnections();
+    this->connectionIdleTimeout = params.getConnectionIdleTimeout();
+    if (this->maxConnections > 0) {
+        // Create the pool here rather than in a thread, for the same reason.
+        S3CurlPool::getInstance();
+    }
 }
 
 S3RESTfulService::~S3RESTfulService() {
@@ -96,10 +107,16 @@ static size_t RESTfulServiceReadFuncCallback(char *ptr, size_t size, size_t nmem
 
 struct CURLWrapper {
     CURLWrapper(const string &url, curl_slist *headers, uint64_t lowSpeedLimit,
-                uint64_t lowSpeedTime, bool debugCurl, string proxy) {
-        curl = curl_easy_init();
+                uint64_t lowSpeedTime, bool debugCurl, string proxy, uint64_t maxConnections,
+                uint64_t connectionIdleTimeout)
+        : url(url), maxConnections(maxConnections), connectionIdleTimeout(connectionIdleTimeout) {
+        if (maxConnections > 0) {
+            curl = S3CurlPool::getInstance().acquire(url);
+        } else {
+            curl = curl_easy_init();
+            curl_easy_setopt(curl, CURLOPT_FORBID_REUSE, 1L);
+        }
         curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_FORBID_REUSE, 1L);
         curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
         curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
         curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, lowSpeedLimit);
@@ -114,9 +131,18 @@ struct CURLWrapper {
         }
     }
     ~CURLWrapper() {
-        curl_easy_cleanup(curl);
+        if (maxConnections > 0) {
+            S3CurlPool::getInstance().release(url, curl, maxConnections, connectionIdleTimeout);
+        } else {
+            curl_easy_cleanup(curl);
+        }
     }
     CURL *curl;
+
+   private:
+    string url;
+    uint64_t maxConnections;
+    uint64_t connectionIdleTimeout;
 };
 
 void S3RESTfulService::performCurl(CURL *curl, Response &response) {
@@ -153,7 +179,8 @@ Response S3RESTfulService::get(const string &url, HTTPHeaders &headers) {
 
     headers.CreateList();
     CURLWrapper wrapper(url, headers.GetList(), this->lowSpeedLimit, this->lowSpeedTime,
-                        this->debugCurl, this->proxy);
+                        this->debugCurl, this->proxy, this->maxConnections,
+                        this->connectionIdleTimeout);
     CURL *curl = wrapper.curl;
 
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&response);
@@ -170,7 +197,8 @@ Response S3RESTfulService::put(const string &url, HTTPHeaders &headers, const S3
 
     headers.CreateList();
     CURLWrapper wrapper(url, headers.GetList(), this->lowSpeedLimit, this->lowSpeedTime,
-                        this->debugCurl, this->proxy);
+                        this->debugCurl, this->proxy, this->maxConnections,
+                        this->connectionIdleTimeout);
     CURL *curl = wrapper.curl;
 
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&response);
@@ -197,7 +225,8 @@ Response S3RESTfulService::post(const string &url, HTTPHeaders &headers,
 
     headers.CreateList();
     CURLWrapper wrapper(url, headers.GetList(), this->lowSpeedLimit, this->lowSpeedTime,
-                        this->debugCurl, this->proxy);
+                        this->debugCurl, this->proxy, this->maxConnections,
+                        this->connectionIdleTimeout);
     CURL *curl = wrapper.curl;
 
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&response);
@@ -226,7 +255,8 @@ ResponseCode S3RESTfulService::head(const string &url, HTTPHeaders &headers) {
 
     headers.CreateList();
     CURLWrapper wrapper(url, headers.GetList(), this->lowSpeedLimit, this->lowSpeedTime,
-                        this->debugCurl, this->proxy);
+                        this->debugCurl, this->proxy, this->maxConnections,
+                        this->connectionIdleTimeout);
     CURL *curl = wrapper.curl;
 
     curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "HEAD");
@@ -243,7 +273,8 @@ Response S3RESTfulService::deleteRequest(const string &url, HTTPHeaders &headers
 
     headers.CreateList();
     CURLWrapper wrapper(url, headers.GetList(), this->lowSpeedLimit, this->lowSpeedTime,
-                        this->debugCurl, this->proxy);
+                        this->debugCurl, this->proxy, this->maxConnections,
+                        this->connectionIdleTimeout);
     CURL *curl = wrapper.curl;
 
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&response);
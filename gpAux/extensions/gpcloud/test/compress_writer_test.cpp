@@ -210,3 +210,102 @@ TEST_F(CompressWriterTest, CompressCompressedData) {
 
     EXPECT_TRUE(memcmp(compressedData.data(), result.get(), compressedData.size()) == 0);
 }
+
+class ParallelCompressWriterTest : public testing::Test {
+   protected:
+    virtual void SetUp() {
+        S3Params params("s3://abc/def/");
+        params.setGzipParallel(true);
+        params.setGzipLevel(1);
+        params.setNumOfChunks(4);
+
+        compressWriter.setWriter(&writer);
+        compressWriter.open(params);
+    }
+
+    virtual void TearDown() {
+        compressWriter.close();
+    }
+
+    // Decompress all gzip members of the output.
+    string gunzip() {
+        z_stream zstream;
+        zstream.zalloc = Z_NULL;
+        zstream.zfree = Z_NULL;
+        zstream.opaque = Z_NULL;
+        inflateInit2(&zstream, S3_INFLATE_WINDOWSBITS);
+
+        zstream.next_in = (Byte *)writer.getRawData();
+        zstream.avail_in = writer.getDataSize();
+
+        string result;
+        vector<char> buffer(1024 * 1024);
+        while (zstream.avail_in > 0) {
+            zstream.next_out = (Byte *)buffer.data();
+            zstream.avail_out = buffer.size();
+
+            int status = inflate(&zstream, Z_NO_FLUSH);
+            result.append(buffer.data(), buffer.size() - zstream.avail_out);
+
+            if (status == Z_STREAM_END) {
+                members++;
+                inflateReset(&zstream);
+            } else if (status != Z_OK) {
+                break;
+            }
+        }
+
+        inflateEnd(&zstream);
+        return result;
+    }
+
+    CompressWriter compressWriter;
+    MockWriter writer;
+    int members = 0;
+};
+
+TEST_F(ParallelCompressWriterTest, AbleToCompressEmptyData) {
+    compressWriter.close();
+
+    EXPECT_EQ("", this->gunzip());
+    EXPECT_EQ(1, members);
+}
+
+TEST_F(ParallelCompressWriterTest, AbleToCompressOneSmallString) {
+    const char input[] = "The quick brown fox jumps over the lazy dog";
+
+    compressWriter.write(input, sizeof(input) - 1);
+    compressWriter.close();
+
+    EXPECT_EQ(input, this->gunzip());
+    EXPECT_EQ(1, members);
+}
+
+TEST_F(ParallelCompressWriterTest, BlocksAreWrittenInOrder) {
+    // Lines with their numbers, so that any reordering of blocks shows.
+    string input;
+    for (int i = 0; input.size() < S3_ZIP_COMPRESS_CHUNKSIZE * 10 + 12345; i++) {
+        input += "The quick brown fox jumps over the lazy dog " + std::to_string(i) + "\n";
+    }
+
+    // Write in pieces not aligned to blocks.
+    for (size_t offset = 0; offset < input.size(); offset += 100000) {
+        compressWriter.write(input.data() + offset, std::min<size_t>(100000, input.size() - offset));
+    }
+    compressWriter.close();
+
+    EXPECT_TRUE(input == this->gunzip());
+
+    // A block is submitted once its input reaches the block size.
+    EXPECT_EQ(10, members);
+}
+
+TEST_F(ParallelCompressWriterTest, CloseMultipleTimes) {
+    char input[10] = {0};
+    compressWriter.write(input, sizeof(input));
+
+    compressWriter.close();
+    compressWriter.close();
+
+    EXPECT_EQ(string(input, sizeof(input)), this->gunzip());
+}
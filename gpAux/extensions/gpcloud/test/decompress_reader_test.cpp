@@ -1,6 +1,14 @@
 #include "decompress_reader.cpp"
 #include "gtest/gtest.h"
 
+#ifdef GPCLOUD_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef GPCLOUD_WITH_LZ4
+#include <lz4frame.h>
+#endif
+
 class MockBufferReader : public Reader {
    public:
     MockBufferReader() {
@@ -311,3 +319,266 @@ TEST_F(DecompressReaderTest, AbleToDecompressWithIncorrectEncodedStream) {
 
     EXPECT_THROW(decompressReader.read(outputBuffer, sizeof(outputBuffer)), S3RuntimeError);
 }
+
+TEST_F(DecompressReaderTest, AbleToDecompressConcatenatedMembers) {
+    // Two gzip members, as parallel compression writes them.
+    const char *parts[] = {"The quick brown fox ", "jumps over the lazy dog"};
+
+    vector<uint8_t> input;
+    for (int i = 0; i < 2; i++) {
+        z_stream zstream;
+        zstream.zalloc = Z_NULL;
+        zstream.zfree = Z_NULL;
+        zstream.opaque = Z_NULL;
+        deflateInit2(&zstream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, S3_DEFLATE_WINDOWSBITS, 8,
+                     Z_DEFAULT_STRATEGY);
+
+        zstream.next_in = (Byte *)parts[i];
+        zstream.avail_in = strlen(parts[i]);
+        zstream.next_out = compressionBuff;
+        zstream.avail_out = sizeof(compressionBuff);
+        ASSERT_EQ(Z_STREAM_END, deflate(&zstream, Z_FINISH));
+        deflateEnd(&zstream);
+
+        input.insert(input.end(), compressionBuff,
+                     compressionBuff + sizeof(compressionBuff) - zstream.avail_out);
+    }
+    this->bufReader.setData(input.data(), input.size());
+
+    char outputBuffer[128] = {0};
+    string output;
+    uint64_t count;
+    while ((count = decompressReader.read(outputBuffer, sizeof(outputBuffer))) != 0) {
+        output.append(outputBuffer, count);
+    }
+
+    EXPECT_EQ("The quick brown fox jumps over the lazy dog", output);
+}
+
+// Read all data of the reader.
+static string readAll(Reader &reader) {
+    char outputBuffer[1000];
+    string output;
+    uint64_t count;
+    while ((count = reader.read(outputBuffer, sizeof(outputBuffer))) != 0) {
+        output.append(outputBuffer, count);
+    }
+    return output;
+}
+
+TEST_F(DecompressReaderTest, AbleToBorrowDecompressedData) {
+    const char hello[] = "The quick brown fox jumps over the lazy dog";
+    setBufReaderByRawData(hello, sizeof(hello));
+
+    const char *data = NULL;
+    uint64_t count = decompressReader.borrow(&data, 10);
+    EXPECT_EQ((uint64_t)10, count);
+    EXPECT_EQ(0, strncmp(hello, data, count));
+    decompressReader.release();
+
+    const char *next = NULL;
+    count = decompressReader.borrow(&next, 1000);
+    EXPECT_EQ(sizeof(hello) - 10, count);
+    EXPECT_EQ(data + 10, next);
+    EXPECT_EQ(0, strncmp(hello + 10, next, count));
+    decompressReader.release();
+
+    EXPECT_EQ((uint64_t)0, decompressReader.borrow(&data, 1000));
+    decompressReader.release();
+}
+
+TEST_F(DecompressReaderTest, AbleToDecompressBzip2Streams) {
+    // Two bzip2 streams, as parallel bzip2 tools write them.
+    const char *parts[] = {"The quick brown fox ", "jumps over the lazy dog"};
+
+    vector<uint8_t> input;
+    for (int i = 0; i < 2; i++) {
+        unsigned int compressedLen = sizeof(compressionBuff);
+        ASSERT_EQ(BZ_OK, BZ2_bzBuffToBuffCompress((char *)compressionBuff, &compressedLen,
+                                                  (char *)parts[i], strlen(parts[i]), 9, 0, 0));
+        input.insert(input.end(), compressionBuff, compressionBuff + compressedLen);
+    }
+    this->bufReader.setData(input.data(), input.size());
+
+    decompressReader.close();
+    decompressReader.setCompressionType(S3_COMPRESSION_BZIP2);
+    decompressReader.open(S3Params("s3://abc/def"));
+
+    EXPECT_EQ("The quick brown fox jumps over the lazy dog", readAll(decompressReader));
+}
+
+TEST_F(DecompressReaderTest, AbleToDecompressWithIncorrectBzip2Stream) {
+    char hello[] = "BZh9abcdefghigklmnopqrstuvwxyz";
+    this->bufReader.setData(hello, sizeof(hello));
+
+    decompressReader.close();
+    decompressReader.setCompressionType(S3_COMPRESSION_BZIP2);
+    decompressReader.open(S3Params("s3://abc/def"));
+
+    char outputBuffer[128] = {0};
+
+    EXPECT_THROW(decompressReader.read(outputBuffer, sizeof(outputBuffer)), S3RuntimeError);
+}
+
+#ifdef GPCLOUD_WITH_ZSTD
+TEST_F(DecompressReaderTest, AbleToDecompressZstdFrames) {
+    const char *parts[] = {"The quick brown fox ", "jumps over the lazy dog"};
+
+    vector<uint8_t> input;
+    for (int i = 0; i < 2; i++) {
+        size_t compressedLen = ZSTD_compress(compressionBuff, sizeof(compressionBuff), parts[i],
+                                             strlen(parts[i]), ZSTD_CLEVEL_DEFAULT);
+        ASSERT_FALSE(ZSTD_isError(compressedLen));
+        input.insert(input.end(), compressionBuff, compressionBuff + compressedLen);
+    }
+    this->bufReader.setData(input.data(), input.size());
+
+    decompressReader.close();
+    decompressReader.setCompressionType(S3_COMPRESSION_ZSTD);
+    decompressReader.open(S3Params("s3://abc/def"));
+
+    EXPECT_EQ("The quick brown fox jumps over the lazy dog", readAll(decompressReader));
+}
+#else
+TEST_F(DecompressReaderTest, OpenZstdWithoutSupport) {
+    decompressReader.close();
+    decompressReader.setCompressionType(S3_COMPRESSION_ZSTD);
+
+    EXPECT_THROW(decompressReader.open(S3Params("s3://abc/def")), S3RuntimeError);
+}
+#endif
+
+#ifdef GPCLOUD_WITH_LZ4
+TEST_F(DecompressReaderTest, AbleToDecompressLz4Frames) {
+    const char *parts[] = {"The quick brown fox ", "jumps over the lazy dog"};
+
+    vector<uint8_t> input;
+    for (int i = 0; i < 2; i++) {
+        size_t compressedLen = LZ4F_compressFrame(compressionBuff, sizeof(compressionBuff),
+                                                  parts[i], strlen(parts[i]), NULL);
+        ASSERT_FALSE(LZ4F_isError(compressedLen));
+        input.insert(input.end(), compressionBuff, compressionBuff + compressedLen);
+    }
+    this->bufReader.setData(input.data(), input.size());
+
+    decompressReader.close();
+    decompressReader.setCompressionType(S3_COMPRESSION_LZ4);
+    decompressReader.open(S3Params("s3://abc/def"));
+
+    EXPECT_EQ("The quick brown fox jumps over the lazy dog", readAll(decompressReader));
+}
+#else
+TEST_F(DecompressReaderTest, OpenLz4WithoutSupport) {
+    decompressReader.close();
+    decompressReader.setCompressionType(S3_COMPRESSION_LZ4);
+
+    EXPECT_THROW(decompressReader.open(S3Params("s3://abc/def")), S3RuntimeError);
+}
+#endif
+
+class DecompressThreadTest : public testing::Test {
+   protected:
+    virtual void SetUp() {
+        S3Params params("s3://abc/def");
+        params.setDecompressThread(true);
+
+        this->bufReader.setChunkSize(1024 * 1024 * 64);
+        decompressReader.setReader(&bufReader);
+        decompressReader.open(params);
+    }
+
+    virtual void TearDown() {
+        decompressReader.close();
+    }
+
+    DecompressReader decompressReader;
+    MockBufferReader bufReader;
+};
+
+TEST_F(DecompressThreadTest, AbleToDecompressEmptyData) {
+    char buf[100];
+    EXPECT_EQ((uint64_t)0, decompressReader.read(buf, sizeof(buf)));
+    EXPECT_EQ((uint64_t)0, decompressReader.read(buf, sizeof(buf)));
+}
+
+TEST_F(DecompressThreadTest, AbleToDecompressManyBlocks) {
+    // Lines with their numbers, so that any reordering of blocks shows.
+    string input;
+    for (int i = 0; input.size() < S3_ZIP_DECOMPRESS_CHUNKSIZE * 5 + 12345; i++) {
+        input += "The quick brown fox jumps over the lazy dog " + std::to_string(i) + "\n";
+    }
+
+    uLong compressedLen = compressBound(input.size());
+    vector<Byte> compressed(compressedLen);
+    ASSERT_EQ(Z_OK, compress(compressed.data(), &compressedLen, (const Bytef *)input.data(),
+                             input.size()));
+
+    // Close the reader opened before the data is set, its thread is at EOF already.
+    decompressReader.close();
+    this->bufReader.setData(compressed.data(), compressedLen);
+    this->bufReader.setChunkSize(100000);
+
+    S3Params params("s3://abc/def");
+    params.setDecompressThread(true);
+    decompressReader.open(params);
+
+    EXPECT_TRUE(input == readAll(decompressReader));
+}
+
+TEST_F(DecompressThreadTest, AbleToBorrowDecompressedData) {
+    decompressReader.close();
+
+    const char hello[] = "The quick brown fox jumps over the lazy dog";
+    Byte compressed[1000];
+    uLong compressedLen = sizeof(compressed);
+    ASSERT_EQ(Z_OK, compress(compressed, &compressedLen, (const Bytef *)hello, sizeof(hello)));
+    this->bufReader.setData(compressed, compressedLen);
+
+    S3Params params("s3://abc/def");
+    params.setDecompressThread(true);
+    decompressReader.open(params);
+
+    const char *data = NULL;
+    EXPECT_EQ(sizeof(hello), decompressReader.borrow(&data, 1000));
+    EXPECT_EQ(0, strncmp(hello, data, sizeof(hello)));
+    decompressReader.release();
+
+    EXPECT_EQ((uint64_t)0, decompressReader.borrow(&data, 1000));
+    decompressReader.release();
+}
+
+TEST_F(DecompressThreadTest, ErrorOfThreadIsThrownByRead) {
+    decompressReader.close();
+
+    char hello[] = "abcdefghigklmnopqrstuvwxyz";
+    this->bufReader.setData(hello, sizeof(hello));
+
+    S3Params params("s3://abc/def");
+    params.setDecompressThread(true);
+    decompressReader.open(params);
+
+    char outputBuffer[128] = {0};
+
+    EXPECT_THROW(decompressReader.read(outputBuffer, sizeof(outputBuffer)), S3RuntimeError);
+}
+
+TEST_F(DecompressThreadTest, CloseBeforeReadingAll) {
+    decompressReader.close();
+
+    string input(S3_ZIP_DECOMPRESS_CHUNKSIZE * 8, 'x');
+    uLong compressedLen = compressBound(input.size());
+    vector<Byte> compressed(compressedLen);
+    ASSERT_EQ(Z_OK, compress(compressed.data(), &compressedLen, (const Bytef *)input.data(),
+                             input.size()));
+    this->bufReader.setData(compressed.data(), compressedLen);
+
+    S3Params params("s3://abc/def");
+    params.setDecompressThread(true);
+    decompressReader.open(params);
+
+    char outputBuffer[128] = {0};
+    EXPECT_EQ(sizeof(outputBuffer), decompressReader.read(outputBuffer, sizeof(outputBuffer)));
+
+    // The thread waits for blocks to be read, it must not hang close().
+    decompressReader.close();
+}
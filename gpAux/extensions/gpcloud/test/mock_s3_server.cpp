@@ -0,0 +1,617 @@
+#include "mock_s3_server.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <cstdlib>
+
+#include "s3utils.h"
+
+namespace {
+
+struct ConnectionArgs {
+    MockS3Server *server;
+    int fd;
+};
+
+string toLower(string s) {
+    std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+    return s;
+}
+
+string trim(const string &s) {
+    size_t begin = s.find_first_not_of(" \t");
+    if (begin == string::npos) {
+        return "";
+    }
+    return s.substr(begin, s.find_last_not_of(" \t") - begin + 1);
+}
+
+string uriDecode(const string &s) {
+    string result;
+    for (size_t i = 0; i < s.size(); i++) {
+        if (s[i] == '%' && i + 2 < s.size() && isxdigit(s[i + 1]) && isxdigit(s[i + 2])) {
+            result.push_back((char)strtol(s.substr(i + 1, 2).c_str(), NULL, 16));
+            i += 2;
+        } else if (s[i] == '+') {
+            result.push_back(' ');
+        } else {
+            result.push_back(s[i]);
+        }
+    }
+    return result;
+}
+
+string xmlEscape(const string &s) {
+    string result;
+    for (size_t i = 0; i < s.size(); i++) {
+        switch (s[i]) {
+            case '&':
+                result += "&amp;";
+                break;
+            case '<':
+                result += "&lt;";
+                break;
+            case '>':
+                result += "&gt;";
+                break;
+            default:
+                result.push_back(s[i]);
+        }
+    }
+    return result;
+}
+
+const char *reasonPhrase(int code) {
+    switch (code) {
+        case 100:
+            return "Continue";
+        case 200:
+            return "OK";
+        case 204:
+            return "No Content";
+        case 206:
+            return "Partial Content";
+        case 400:
+            return "Bad Request";
+        case 404:
+            return "Not Found";
+        case 416:
+            return "Requested Range Not Satisfiable";
+        default:
+            return "Unknown";
+    }
+}
+
+bool sendAll(int fd, const string &data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        sent += n;
+    }
+    return true;
+}
+
+// Receive more data into buffer, return false if the connection is closed.
+bool receiveMore(int fd, string &buffer) {
+    char data[64 * 1024];
+    while (true) {
+        ssize_t n = recv(fd, data, sizeof(data), 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        buffer.append(data, n);
+        return true;
+    }
+}
+
+// Take a line ending with CRLF from the front of buffer, receiving more if needed.
+bool takeLine(int fd, string &buffer, string &line) {
+    size_t end;
+    while ((end = buffer.find("\r\n")) == string::npos) {
+        if (!receiveMore(fd, buffer)) {
+            return false;
+        }
+    }
+    line = buffer.substr(0, end);
+    buffer.erase(0, end + 2);
+    return true;
+}
+
+// Take length bytes from the front of buffer, receiving more if needed.
+bool takeBytes(int fd, string &buffer, size_t length, string &data) {
+    while (buffer.size() < length) {
+        if (!receiveMore(fd, buffer)) {
+            return false;
+        }
+    }
+    data.append(buffer, 0, length);
+    buffer.erase(0, length);
+    return true;
+}
+
+}  // namespace
+
+MockS3Server::MockS3Server()
+    : listenFd(-1),
+      port(0),
+      pageSize(1000),
+      running(false),
+      connectionCount(0),
+      requestCount(0),
+      nextUploadId(1) {
+    pthread_mutex_init(&this->mutex, NULL);
+}
+
+MockS3Server::~MockS3Server() {
+    this->stop();
+    pthread_mutex_destroy(&this->mutex);
+}
+
+bool MockS3Server::start() {
+    this->listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (this->listenFd < 0) {
+        return false;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+
+    socklen_t addrLen = sizeof(addr);
+    if (bind(this->listenFd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(this->listenFd, 64) != 0 ||
+        getsockname(this->listenFd, (struct sockaddr *)&addr, &addrLen) != 0) {
+        close(this->listenFd);
+        this->listenFd = -1;
+        return false;
+    }
+    this->port = ntohs(addr.sin_port);
+
+    this->running = true;
+    if (pthread_create(&this->acceptThread, NULL, acceptThreadFunc, this) != 0) {
+        this->running = false;
+        close(this->listenFd);
+        this->listenFd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+void MockS3Server::stop() {
+    if (!this->running) {
+        return;
+    }
+    this->running = false;
+
+    // Wake up accept(), then the connections waiting for their next request.
+    shutdown(this->listenFd, SHUT_RDWR);
+    pthread_join(this->acceptThread, NULL);
+    close(this->listenFd);
+    this->listenFd = -1;
+
+    vector<pthread_t> threads;
+    {
+        UniqueLock lock(&this->mutex);
+        for (size_t i = 0; i < this->connectionFds.size(); i++) {
+            shutdown(this->connectionFds[i], SHUT_RDWR);
+        }
+        threads.swap(this->connectionThreads);
+    }
+    for (size_t i = 0; i < threads.size(); i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+string MockS3Server::getEndpoint() const {
+    stringstream ss;
+    ss << "http://127.0.0.1:" << this->port;
+    return ss.str();
+}
+
+void MockS3Server::putObject(const string &bucket, const string &key, const string &data) {
+    UniqueLock lock(&this->mutex);
+    this->objects[bucket][key] = data;
+}
+
+bool MockS3Server::getObject(const string &bucket, const string &key, string &data) {
+    UniqueLock lock(&this->mutex);
+    map<string, map<string, string> >::iterator b = this->objects.find(bucket);
+    if (b == this->objects.end() || b->second.find(key) == b->second.end()) {
+        return false;
+    }
+    data = b->second[key];
+    return true;
+}
+
+uint64_t MockS3Server::getConnectionCount() {
+    UniqueLock lock(&this->mutex);
+    return this->connectionCount;
+}
+
+uint64_t MockS3Server::getRequestCount() {
+    UniqueLock lock(&this->mutex);
+    return this->requestCount;
+}
+
+void *MockS3Server::acceptThreadFunc(void *p) {
+    static_cast<MockS3Server *>(p)->acceptConnections();
+    return NULL;
+}
+
+void *MockS3Server::connectionThreadFunc(void *p) {
+    ConnectionArgs *args = static_cast<ConnectionArgs *>(p);
+    args->server->serveConnection(args->fd);
+    delete args;
+    return NULL;
+}
+
+void MockS3Server::acceptConnections() {
+    while (true) {
+        int fd = accept(this->listenFd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR && this->running) {
+                continue;
+            }
+            return;
+        }
+
+        UniqueLock lock(&this->mutex);
+        if (!this->running) {
+            close(fd);
+            return;
+        }
+
+        ConnectionArgs *args = new ConnectionArgs;
+        args->server = this;
+        args->fd = fd;
+
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, connectionThreadFunc, args) != 0) {
+            delete args;
+            close(fd);
+            continue;
+        }
+        this->connectionThreads.push_back(thread);
+        this->connectionFds.push_back(fd);
+        this->connectionCount++;
+    }
+}
+
+void MockS3Server::serveConnection(int fd) {
+    string buffer;
+    Request request;
+
+    while (this->readRequest(fd, buffer, request)) {
+        Reply reply;
+        this->handleRequest(request, reply);
+
+        stringstream out;
+        out << "HTTP/1.1 " << reply.code << " " << reasonPhrase(reply.code) << "\r\n";
+        if (reply.headers.find("Content-Length") == reply.headers.end()) {
+            reply.headers["Content-Length"] = std::to_string((unsigned long long)reply.body.size());
+        }
+        for (map<string, string>::iterator i = reply.headers.begin(); i != reply.headers.end();
+             i++) {
+            out << i->first << ": " << i->second << "\r\n";
+        }
+        out << "\r\n";
+        if (request.method != "HEAD") {
+            out << reply.body;
+        }
+
+        if (!sendAll(fd, out.str()) || toLower(request.headers["connection"]) == "close") {
+            break;
+        }
+    }
+
+    // Close under the lock, so that stop() never shuts down a descriptor reused by another
+    // connection.
+    UniqueLock lock(&this->mutex);
+    this->connectionFds.erase(
+        std::find(this->connectionFds.begin(), this->connectionFds.end(), fd));
+    close(fd);
+}
+
+bool MockS3Server::readRequest(int fd, string &buffer, Request &request) {
+    request = Request();
+
+    string line;
+    if (!takeLine(fd, buffer, line)) {
+        return false;
+    }
+
+    // METHOD /bucket/key?query HTTP/1.1
+    stringstream requestLine(line);
+    string target;
+    requestLine >> request.method >> target;
+
+    size_t queryPos = target.find('?');
+    string path = target.substr(0, queryPos);
+    if (queryPos != string::npos) {
+        stringstream query(target.substr(queryPos + 1));
+        string item;
+        while (std::getline(query, item, '&')) {
+            size_t eq = item.find('=');
+            request.query[uriDecode(item.substr(0, eq))] =
+                (eq == string::npos) ? "" : uriDecode(item.substr(eq + 1));
+        }
+    }
+
+    size_t start = path.find_first_not_of('/');
+    if (start != string::npos) {
+        size_t slash = path.find('/', start);
+        request.bucket = uriDecode(path.substr(start, slash - start));
+        if (slash != string::npos) {
+            request.key = uriDecode(path.substr(slash + 1));
+        }
+    }
+
+    while (true) {
+        if (!takeLine(fd, buffer, line)) {
+            return false;
+        }
+        if (line.empty()) {
+            break;
+        }
+        size_t colon = line.find(':');
+        if (colon != string::npos) {
+            request.headers[toLower(line.substr(0, colon))] = trim(line.substr(colon + 1));
+        }
+    }
+
+    if (toLower(request.headers["expect"]) == "100-continue" &&
+        !sendAll(fd, "HTTP/1.1 100 Continue\r\n\r\n")) {
+        return false;
+    }
+
+    // curl sends bodies of unknown length, e.g. of POST, chunked. They must be read up to the
+    // last chunk, or the rest of them is taken for the next request of the connection.
+    if (toLower(request.headers["transfer-encoding"]) == "chunked") {
+        while (true) {
+            if (!takeLine(fd, buffer, line)) {
+                return false;
+            }
+            size_t length = strtoul(line.c_str(), NULL, 16);
+            if (length == 0) {
+                // Trailers, up to an empty line
+                do {
+                    if (!takeLine(fd, buffer, line)) {
+                        return false;
+                    }
+                } while (!line.empty());
+                break;
+            }
+            if (!takeBytes(fd, buffer, length, request.body) || !takeLine(fd, buffer, line)) {
+                return false;
+            }
+        }
+    } else if (request.headers.find("content-length") != request.headers.end()) {
+        size_t length = strtoul(request.headers["content-length"].c_str(), NULL, 10);
+        if (!takeBytes(fd, buffer, length, request.body)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void MockS3Server::handleRequest(const Request &request, Reply &reply) {
+    UniqueLock lock(&this->mutex);
+    this->requestCount++;
+
+    // Real S3 rejects a Host header that is not its own.
+    map<string, string>::const_iterator host = request.headers.find("host");
+    stringstream expectedHost;
+    expectedHost << "127.0.0.1:" << this->port;
+    if (host != request.headers.end() && host->second != expectedHost.str() &&
+        host->second != "127.0.0.1") {
+        replyError(reply, 400, "InvalidArgument", "Invalid Host header.");
+        return;
+    }
+
+    if (request.method == "GET") {
+        this->handleGet(request, reply);
+    } else if (request.method == "HEAD") {
+        this->handleHead(request, reply);
+    } else if (request.method == "PUT") {
+        this->handlePut(request, reply);
+    } else if (request.method == "POST") {
+        this->handlePost(request, reply);
+    } else if (request.method == "DELETE") {
+        this->handleDelete(request, reply);
+    } else {
+        replyError(reply, 400, "InvalidRequest", "Unsupported method.");
+    }
+}
+
+void MockS3Server::handleGet(const Request &request, Reply &reply) {
+    if (request.key.empty()) {
+        this->listBucket(request, reply);
+        return;
+    }
+
+    map<string, string> &bucket = this->objects[request.bucket];
+    map<string, string>::iterator object = bucket.find(request.key);
+    if (object == bucket.end()) {
+        replyError(reply, 404, "NoSuchKey", "The specified key does not exist.");
+        return;
+    }
+
+    const string &data = object->second;
+    map<string, string>::const_iterator range = request.headers.find("range");
+    if (range == request.headers.end() || range->second.compare(0, 6, "bytes=") != 0) {
+        reply.body = data;
+        return;
+    }
+
+    // bytes=first-[last]
+    string spec = range->second.substr(6);
+    size_t dash = spec.find('-');
+    uint64_t first = strtoull(spec.substr(0, dash).c_str(), NULL, 10);
+    uint64_t last = data.size() - 1;
+    if (dash != string::npos && dash + 1 < spec.size()) {
+        last = std::min(last, (uint64_t)strtoull(spec.substr(dash + 1).c_str(), NULL, 10));
+    }
+    if (data.empty() || first > last) {
+        replyError(reply, 416, "InvalidRange", "The requested range is not satisfiable");
+        return;
+    }
+
+    stringstream contentRange;
+    contentRange << "bytes " << first << "-" << last << "/" << data.size();
+    reply.code = 206;
+    reply.headers["Content-Range"] = contentRange.str();
+    reply.body = data.substr(first, last - first + 1);
+}
+
+void MockS3Server::handleHead(const Request &request, Reply &reply) {
+    map<string, string> &bucket = this->objects[request.bucket];
+    map<string, string>::iterator object = bucket.find(request.key);
+    if (object == bucket.end()) {
+        reply.code = 404;
+        return;
+    }
+    reply.headers["Content-Length"] = std::to_string((unsigned long long)object->second.size());
+}
+
+void MockS3Server::handlePut(const Request &request, Reply &reply) {
+    map<string, string>::const_iterator uploadId = request.query.find("uploadId");
+    if (uploadId == request.query.end()) {
+        this->objects[request.bucket][request.key] = request.body;
+    } else {
+        map<string, Upload>::iterator upload = this->uploads.find(uploadId->second);
+        map<string, string>::const_iterator partNumber = request.query.find("partNumber");
+        if (upload == this->uploads.end() || partNumber == request.query.end()) {
+            replyError(reply, 404, "NoSuchUpload", "The specified upload does not exist.");
+            return;
+        }
+        upload->second.parts[strtoull(partNumber->second.c_str(), NULL, 10)] = request.body;
+    }
+
+    MD5Calc md5;
+    md5.Update(request.body.data(), request.body.size());
+    reply.headers["ETag"] = "\"" + string(md5.Get()) + "\"";
+}
+
+void MockS3Server::handlePost(const Request &request, Reply &reply) {
+    if (request.query.count("uploads")) {
+        string uploadId = std::to_string((unsigned long long)this->nextUploadId++);
+        Upload &upload = this->uploads[uploadId];
+        upload.bucket = request.bucket;
+        upload.key = request.key;
+
+        replyXml(reply, 200,
+                 "<InitiateMultipartUploadResult><Bucket>" + xmlEscape(request.bucket) +
+                     "</Bucket><Key>" + xmlEscape(request.key) + "</Key><UploadId>" + uploadId +
+                     "</UploadId></InitiateMultipartUploadResult>");
+        return;
+    }
+
+    map<string, string>::const_iterator uploadId = request.query.find("uploadId");
+    if (uploadId == request.query.end()) {
+        replyError(reply, 400, "InvalidRequest", "Unsupported POST request.");
+        return;
+    }
+
+    map<string, Upload>::iterator upload = this->uploads.find(uploadId->second);
+    if (upload == this->uploads.end()) {
+        replyError(reply, 404, "NoSuchUpload", "The specified upload does not exist.");
+        return;
+    }
+
+    // Concatenate the parts listed, in the order listed.
+    string data;
+    const string tag = "<PartNumber>";
+    for (size_t pos = request.body.find(tag); pos != string::npos;
+         pos = request.body.find(tag, pos + 1)) {
+        uint64_t number = strtoull(request.body.c_str() + pos + tag.size(), NULL, 10);
+        map<uint64_t, string>::iterator part = upload->second.parts.find(number);
+        if (part != upload->second.parts.end()) {
+            data += part->second;
+        }
+    }
+    this->objects[upload->second.bucket][upload->second.key] = data;
+
+    replyXml(reply, 200,
+             "<CompleteMultipartUploadResult><Bucket>" + xmlEscape(upload->second.bucket) +
+                 "</Bucket><Key>" + xmlEscape(upload->second.key) +
+                 "</Key></CompleteMultipartUploadResult>");
+    this->uploads.erase(upload);
+}
+
+void MockS3Server::handleDelete(const Request &request, Reply &reply) {
+    map<string, string>::const_iterator uploadId = request.query.find("uploadId");
+    if (uploadId != request.query.end()) {
+        if (this->uploads.erase(uploadId->second) == 0) {
+            replyError(reply, 404, "NoSuchUpload", "The specified upload does not exist.");
+            return;
+        }
+    } else {
+        this->objects[request.bucket].erase(request.key);
+    }
+    reply.code = 204;
+}
+
+void MockS3Server::listBucket(const Request &request, Reply &reply) {
+    map<string, string>::const_iterator i = request.query.find("prefix");
+    string prefix = (i == request.query.end()) ? "" : i->second;
+    i = request.query.find("marker");
+    string marker = (i == request.query.end()) ? "" : i->second;
+
+    stringstream contents;
+    bool truncated = false;
+    uint64_t count = 0;
+    map<string, string> &bucket = this->objects[request.bucket];
+    for (map<string, string>::iterator object = bucket.upper_bound(marker);
+         object != bucket.end(); object++) {
+        if (object->first.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+        if (count == this->pageSize) {
+            truncated = true;
+            break;
+        }
+        contents << "<Contents><Key>" << xmlEscape(object->first) << "</Key><Size>"
+                 << object->second.size() << "</Size></Contents>";
+        count++;
+    }
+
+    stringstream xml;
+    xml << "<ListBucketResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">"
+        << "<Name>" << xmlEscape(request.bucket) << "</Name>"
+        << "<Prefix>" << xmlEscape(prefix) << "</Prefix>"
+        << "<Marker>" << xmlEscape(marker) << "</Marker>"
+        << "<MaxKeys>" << this->pageSize << "</MaxKeys>"
+        << "<IsTruncated>" << (truncated ? "true" : "false") << "</IsTruncated>"
+        << contents.str() << "</ListBucketResult>";
+    replyXml(reply, 200, xml.str());
+}
+
+void MockS3Server::replyXml(Reply &reply, int code, const string &xml) {
+    reply.code = code;
+    reply.headers["Content-Type"] = "application/xml";
+    reply.body = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n" + xml;
+}
+
+void MockS3Server::replyError(Reply &reply, int code, const string &error,
+                              const string &message) {
+    replyXml(reply, code, "<Error><Code>" + error + "</Code><Message>" + xmlEscape(message) +
+                              "</Message></Error>");
+}
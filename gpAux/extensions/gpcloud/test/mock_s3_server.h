@@ -0,0 +1,101 @@
+#ifndef TEST_MOCK_S3_SERVER_H_
+#define TEST_MOCK_S3_SERVER_H_
+
+#include "s3common_headers.h"
+
+// An in-process stand-in for S3, for tests to send real HTTP requests to without the network.
+// It keeps objects in memory, does not check signatures, and supports what gpcloud uses: listing
+// with prefix, marker and pagination, GET with a byte range, HEAD, PUT, and multipart upload
+// (initiate, upload part, complete, abort).
+//
+// Connections are kept alive, one thread each, and counted, so that tests can tell whether curl
+// handles were reused.
+class MockS3Server {
+   public:
+    MockS3Server();
+    ~MockS3Server();
+
+    // Listen on an ephemeral port of 127.0.0.1, return false if that fails.
+    bool start();
+    void stop();
+
+    uint16_t getPort() const {
+        return this->port;
+    }
+
+    // e.g. "http://127.0.0.1:12345"
+    string getEndpoint() const;
+
+    void putObject(const string &bucket, const string &key, const string &data);
+    bool getObject(const string &bucket, const string &key, string &data);
+
+    void setPageSize(uint64_t pageSize) {
+        this->pageSize = pageSize;
+    }
+
+    uint64_t getConnectionCount();
+    uint64_t getRequestCount();
+
+   private:
+    struct Request {
+        string method;
+        string bucket;
+        string key;
+        map<string, string> query;
+        map<string, string> headers;  // with lower case names
+        string body;
+    };
+
+    struct Reply {
+        Reply() : code(200) {
+        }
+
+        int code;
+        map<string, string> headers;
+        string body;
+    };
+
+    struct Upload {
+        string bucket;
+        string key;
+        map<uint64_t, string> parts;
+    };
+
+    static void *acceptThreadFunc(void *p);
+    static void *connectionThreadFunc(void *p);
+
+    void acceptConnections();
+    void serveConnection(int fd);
+    bool readRequest(int fd, string &buffer, Request &request);
+    void handleRequest(const Request &request, Reply &reply);
+
+    void handleGet(const Request &request, Reply &reply);
+    void handleHead(const Request &request, Reply &reply);
+    void handlePut(const Request &request, Reply &reply);
+    void handlePost(const Request &request, Reply &reply);
+    void handleDelete(const Request &request, Reply &reply);
+    void listBucket(const Request &request, Reply &reply);
+
+    static void replyXml(Reply &reply, int code, const string &xml);
+    static void replyError(Reply &reply, int code, const string &error, const string &message);
+
+    int listenFd;
+    uint16_t port;
+    uint64_t pageSize;
+
+    pthread_t acceptThread;
+    bool running;
+
+    pthread_mutex_t mutex;
+    vector<pthread_t> connectionThreads;
+    vector<int> connectionFds;
+    uint64_t connectionCount;
+    uint64_t requestCount;
+    uint64_t nextUploadId;
+
+    // bucket -> key -> data
+    map<string, map<string, string> > objects;
+    map<string, Upload> uploads;
+};
+
+#endif
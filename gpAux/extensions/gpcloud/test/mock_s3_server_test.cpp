@@ -0,0 +1,109 @@
+#include "mock_s3_server.h"
+#include "gtest/gtest.h"
+#include "s3interface.h"
+#include "s3restful_service.h"
+
+// Drives the mock server through S3InterfaceService, the way gpcloud talks to S3.
+class MockS3ServerTest : public testing::Test {
+   protected:
+    virtual void SetUp() {
+        ASSERT_TRUE(this->server.start());
+
+        std::stringstream url;
+        url << "s3://127.0.0.1:" << this->server.getPort() << "/bucket/data/";
+
+        this->params = S3Params(url.str(), false);
+        this->params.setCred("accessid", "secret", "");
+
+        this->restfulService = new S3RESTfulService(this->params);
+        this->interfaceService = new S3InterfaceService(this->params);
+        this->interfaceService->setRESTfulService(this->restfulService);
+
+        // The upload calls are only public through S3Interface
+        this->service = this->interfaceService;
+    }
+
+    virtual void TearDown() {
+        delete this->interfaceService;
+        delete this->restfulService;
+        this->server.stop();
+    }
+
+    S3Url keyUrl(const string &key) {
+        return S3Url(this->server.getEndpoint() + "/bucket/" + key, false);
+    }
+
+    MockS3Server server;
+    S3Params params;
+    S3RESTfulService *restfulService;
+    S3InterfaceService *interfaceService;
+    S3Interface *service;
+};
+
+TEST_F(MockS3ServerTest, ListBucketWithPrefixAndPages) {
+    this->server.setPageSize(2);
+    this->server.putObject("bucket", "data/a", "1");
+    this->server.putObject("bucket", "data/b", "22");
+    this->server.putObject("bucket", "data/c", "333");
+    this->server.putObject("bucket", "data/empty", "");
+    this->server.putObject("bucket", "other/d", "4444");
+
+    ListBucketResult result = this->service->listBucket(this->params.getS3Url());
+
+    ASSERT_EQ((size_t)3, result.contents.size());
+    EXPECT_EQ("data/a", result.contents[0].getName());
+    EXPECT_EQ((uint64_t)1, result.contents[0].getSize());
+    EXPECT_EQ("data/b", result.contents[1].getName());
+    EXPECT_EQ("data/c", result.contents[2].getName());
+    EXPECT_EQ((uint64_t)3, result.contents[2].getSize());
+
+    // One request per page of two keys
+    EXPECT_EQ((uint64_t)2, this->server.getRequestCount());
+}
+
+TEST_F(MockS3ServerTest, FetchDataWithRange) {
+    this->server.putObject("bucket", "data/a", "0123456789");
+
+    S3VectorUInt8 data;
+    EXPECT_EQ((uint64_t)4, this->service->fetchData(3, data, 4, this->keyUrl("data/a")));
+    EXPECT_EQ("3456", string(data.begin(), data.end()));
+
+    EXPECT_TRUE(this->service->checkKeyExistence(this->keyUrl("data/a")));
+    EXPECT_FALSE(this->service->checkKeyExistence(this->keyUrl("data/b")));
+    EXPECT_THROW(this->service->fetchData(0, data, 4, this->keyUrl("data/b")), S3LogicError);
+}
+
+TEST_F(MockS3ServerTest, MultiPartUpload) {
+    S3Url url = this->keyUrl("data/upload");
+
+    string uploadId = this->service->getUploadId(url);
+    EXPECT_FALSE(uploadId.empty());
+
+    const char *parts[] = {"abc", "defg"};
+    vector<string> etags;
+    for (int i = 0; i < 2; i++) {
+        S3VectorUInt8 data;
+        data.insert(data.end(), parts[i], parts[i] + strlen(parts[i]));
+        etags.push_back(this->service->uploadPartOfData(data, url, i + 1, uploadId));
+        EXPECT_FALSE(etags.back().empty());
+    }
+
+    string object;
+    EXPECT_FALSE(this->server.getObject("bucket", "data/upload", object));
+
+    EXPECT_TRUE(this->service->completeMultiPart(url, uploadId, etags));
+    EXPECT_TRUE(this->server.getObject("bucket", "data/upload", object));
+    EXPECT_EQ("abcdefg", object);
+}
+
+TEST_F(MockS3ServerTest, AbortUpload) {
+    S3Url url = this->keyUrl("data/upload");
+
+    string uploadId = this->service->getUploadId(url);
+
+    EXPECT_TRUE(this->service->abortUpload(url, uploadId));
+    EXPECT_THROW(this->service->abortUpload(url, uploadId), S3LogicError);
+
+    S3VectorUInt8 data(3);
+    EXPECT_THROW(this->service->uploadPartOfData(data, url, 1, uploadId), S3LogicError);
+}
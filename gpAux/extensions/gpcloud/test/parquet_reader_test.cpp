@@ -0,0 +1,388 @@
+#include "parquet_reader.cpp"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "mock_classes.h"
+
+using ::testing::Invoke;
+using ::testing::_;
+
+// Encodes thrift compact protocol, to make up footers.
+class ThriftCompactWriter {
+   public:
+    ThriftCompactWriter() : lastId(0) {
+    }
+
+    void byte(uint8_t value) {
+        this->data.push_back(value);
+    }
+
+    void varint(uint64_t value) {
+        while (value >= 0x80) {
+            this->byte((value & 0x7f) | 0x80);
+            value >>= 7;
+        }
+        this->byte(value);
+    }
+
+    void zigzag(int64_t value) {
+        this->varint(((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+    }
+
+    void binary(const string &value) {
+        this->varint(value.size());
+        this->data.insert(this->data.end(), value.begin(), value.end());
+    }
+
+    void field(int16_t id, uint8_t type) {
+        int16_t delta = id - this->lastId;
+        if (delta > 0 && delta <= 15) {
+            this->byte((delta << 4) | type);
+        } else {
+            this->byte(type);
+            this->zigzag(id);
+        }
+        this->lastId = id;
+    }
+
+    void list(uint8_t elementType, uint64_t size) {
+        if (size < 15) {
+            this->byte((size << 4) | elementType);
+        } else {
+            this->byte(0xf0 | elementType);
+            this->varint(size);
+        }
+    }
+
+    void beginStruct() {
+        this->lastIds.push_back(this->lastId);
+        this->lastId = 0;
+    }
+
+    void endStruct() {
+        this->byte(THRIFT_STOP);
+        this->lastId = this->lastIds.back();
+        this->lastIds.pop_back();
+    }
+
+    vector<uint8_t> data;
+
+   private:
+    int16_t lastId;
+    vector<int16_t> lastIds;
+};
+
+struct TestColumn {
+    string name;
+    uint64_t size;
+    bool hasDictionary;
+};
+
+// Make up a Parquet file of numOfRowGroups row groups of columns, the bytes of a column chunk are
+// all 'a' + index of the column.
+static vector<uint8_t> makeParquetFile(const vector<TestColumn> &columns, int numOfRowGroups) {
+    vector<uint8_t> file(PARQUET_MAGIC, PARQUET_MAGIC + PARQUET_MAGIC_LEN);
+
+    ThriftCompactWriter footer;
+    footer.beginStruct();
+
+    footer.field(1, THRIFT_I32);
+    footer.zigzag(1);
+
+    footer.field(2, THRIFT_LIST);
+    footer.list(THRIFT_STRUCT, columns.size());
+    for (size_t i = 0; i < columns.size(); i++) {
+        footer.beginStruct();
+        footer.field(4, THRIFT_BINARY);
+        footer.binary(columns[i].name);
+        footer.endStruct();
+    }
+
+    footer.field(3, THRIFT_I64);
+    footer.zigzag(1000);
+
+    footer.field(FILE_META_DATA_ROW_GROUPS, THRIFT_LIST);
+    footer.list(THRIFT_STRUCT, numOfRowGroups);
+    for (int g = 0; g < numOfRowGroups; g++) {
+        footer.beginStruct();
+        footer.field(ROW_GROUP_COLUMNS, THRIFT_LIST);
+        footer.list(THRIFT_STRUCT, columns.size());
+
+        for (size_t i = 0; i < columns.size(); i++) {
+            uint64_t offset = file.size();
+            file.insert(file.end(), columns[i].size, 'a' + i);
+
+            footer.beginStruct();
+            footer.field(2, THRIFT_I64);
+            footer.zigzag(offset);
+
+            footer.field(COLUMN_CHUNK_META_DATA, THRIFT_STRUCT);
+            footer.beginStruct();
+            footer.field(1, THRIFT_I32);
+            footer.zigzag(6);
+            footer.field(2, THRIFT_LIST);
+            footer.list(THRIFT_I32, 2);
+            footer.zigzag(0);
+            footer.zigzag(3);
+            footer.field(COLUMN_META_DATA_PATH_IN_SCHEMA, THRIFT_LIST);
+            footer.list(THRIFT_BINARY, 2);
+            footer.binary(columns[i].name);
+            footer.binary("element");
+            footer.field(5, THRIFT_I64);
+            footer.zigzag(500);
+            footer.field(COLUMN_META_DATA_TOTAL_COMPRESSED_SIZE, THRIFT_I64);
+            footer.zigzag(columns[i].size);
+            footer.field(COLUMN_META_DATA_DATA_PAGE_OFFSET, THRIFT_I64);
+            footer.zigzag(offset + (columns[i].hasDictionary ? columns[i].size / 2 : 0));
+            if (columns[i].hasDictionary) {
+                footer.field(COLUMN_META_DATA_DICTIONARY_PAGE_OFFSET, THRIFT_I64);
+                footer.zigzag(offset);
+            }
+
+            // Fields of other types to skip, a map and a boolean with an id after a long gap.
+            footer.field(12, THRIFT_MAP);
+            footer.varint(1);
+            footer.byte((THRIFT_BINARY << 4) | THRIFT_DOUBLE);
+            footer.binary("key");
+            footer.data.insert(footer.data.end(), 8, 0);
+            footer.field(40, THRIFT_BOOLEAN_TRUE);
+            footer.endStruct();
+
+            footer.endStruct();
+        }
+
+        footer.field(2, THRIFT_I64);
+        footer.zigzag(12345);
+        footer.endStruct();
+    }
+
+    footer.field(6, THRIFT_BINARY);
+    footer.binary("gpcloud test");
+    footer.endStruct();
+
+    file.insert(file.end(), footer.data.begin(), footer.data.end());
+
+    uint64_t footerLength = footer.data.size();
+    for (int i = 0; i < 4; i++) {
+        file.push_back((footerLength >> (8 * i)) & 0xff);
+    }
+    file.insert(file.end(), PARQUET_MAGIC, PARQUET_MAGIC + PARQUET_MAGIC_LEN);
+
+    return file;
+}
+
+// Reads the range of the key it is opened for.
+class MockRangeReader : public Reader {
+   public:
+    MockRangeReader() : data(NULL), offset(0), end(0), fetchedBytes(0) {
+    }
+
+    void open(const S3Params &params) {
+        this->offset = params.getKeyRangeOffset();
+        this->end = this->offset + params.getKeyRangeLength();
+        this->openedRanges.push_back(std::make_pair(this->offset, this->end));
+    }
+
+    uint64_t read(char *buf, uint64_t count) {
+        uint64_t length = std::min(count, this->end - this->offset);
+        memcpy(buf, this->data->data() + this->offset, length);
+        this->offset += length;
+        this->fetchedBytes += length;
+        return length;
+    }
+
+    void close() {
+    }
+
+    const vector<uint8_t> *data;
+    uint64_t offset;
+    uint64_t end;
+
+    uint64_t fetchedBytes;
+    vector<std::pair<uint64_t, uint64_t> > openedRanges;
+};
+
+class MockS3InterfaceForParquet : public MockS3Interface {
+   public:
+    uint64_t mockFetchData(uint64_t offset, S3VectorUInt8 &data, uint64_t len,
+                           const S3Url &s3Url) {
+        data.clear();
+        data.insert(data.end(), this->file.begin() + offset, this->file.begin() + offset + len);
+        return len;
+    }
+
+    vector<uint8_t> file;
+};
+
+class ParquetReaderTest : public testing::Test, public ParquetReader {
+   protected:
+    virtual void SetUp() {
+        this->setS3InterfaceService(&s3Interface);
+        this->setReader(&rangeReader);
+        rangeReader.data = &s3Interface.file;
+
+        EXPECT_CALL(s3Interface, fetchData(_, _, _, _))
+            .WillRepeatedly(Invoke(&s3Interface, &MockS3InterfaceForParquet::mockFetchData));
+    }
+
+    virtual void TearDown() {
+        this->close();
+    }
+
+    void openFile(const vector<uint8_t> &file, const vector<string> &columns) {
+        s3Interface.file = file;
+
+        S3Params params("s3://abc/def");
+        params.setKeySize(file.size());
+        params.setColumns(columns);
+        this->open(params);
+    }
+
+    vector<uint8_t> readAll() {
+        vector<uint8_t> result;
+        char buf[100000];
+        uint64_t count;
+        while ((count = this->read(buf, sizeof(buf))) > 0) {
+            result.insert(result.end(), buf, buf + count);
+        }
+        return result;
+    }
+
+    MockS3InterfaceForParquet s3Interface;
+    MockRangeReader rangeReader;
+};
+
+TEST(ParquetFooter, ParseColumnChunks) {
+    vector<TestColumn> columns = {{"a", 100, false}, {"b", 200, true}, {"c", 300, false}};
+    vector<uint8_t> file = makeParquetFile(columns, 2);
+
+    uint64_t footerLength = file[file.size() - 8] | (file[file.size() - 7] << 8);
+    vector<ParquetColumnChunk> chunks =
+        ParseParquetFooter(file.data() + file.size() - 8 - footerLength, footerLength);
+
+    ASSERT_EQ((size_t)6, chunks.size());
+    EXPECT_EQ("a", chunks[0].column);
+    EXPECT_EQ((uint64_t)4, chunks[0].offset);
+    EXPECT_EQ((uint64_t)100, chunks[0].length);
+    EXPECT_EQ("b", chunks[1].column);
+    EXPECT_EQ((uint64_t)104, chunks[1].offset);
+    EXPECT_EQ((uint64_t)200, chunks[1].length);
+    EXPECT_EQ("c", chunks[5].column);
+    EXPECT_EQ((uint64_t)904, chunks[5].offset);
+    EXPECT_EQ((uint64_t)300, chunks[5].length);
+}
+
+TEST(ParquetFooter, CorruptedFooterThrows) {
+    vector<TestColumn> columns = {{"a", 100, false}, {"b", 200, true}};
+    vector<uint8_t> file = makeParquetFile(columns, 1);
+
+    uint64_t footerLength = file[file.size() - 8] | (file[file.size() - 7] << 8);
+    const uint8_t *footer = file.data() + file.size() - 8 - footerLength;
+
+    EXPECT_THROW(ParseParquetFooter(footer, footerLength - 10), S3RuntimeError);
+
+    vector<uint8_t> garbage(footerLength, 0x19);
+    EXPECT_THROW(ParseParquetFooter(garbage.data(), garbage.size()), S3RuntimeError);
+}
+
+TEST_F(ParquetReaderTest, ReadChosenColumnsOnly) {
+    uint64_t chunkSize = 2 * S3_PARQUET_RANGE_MERGE_GAP;
+    vector<TestColumn> columns = {
+        {"a", chunkSize, false}, {"b", chunkSize, true}, {"c", chunkSize, false}};
+    vector<uint8_t> file = makeParquetFile(columns, 2);
+
+    this->openFile(file, {"B"});
+
+    const vector<ParquetSegment> &segments = this->getSegments();
+    ASSERT_EQ((size_t)7, segments.size());
+    EXPECT_EQ(PARQUET_SEGMENT_FETCH, segments[0].type);
+    EXPECT_EQ(PARQUET_SEGMENT_ZERO, segments[1].type);
+    EXPECT_EQ(PARQUET_SEGMENT_FETCH, segments[2].type);
+    EXPECT_EQ(PARQUET_SEGMENT_ZERO, segments[3].type);
+    EXPECT_EQ(PARQUET_SEGMENT_FETCH, segments[4].type);
+    EXPECT_EQ(PARQUET_SEGMENT_ZERO, segments[5].type);
+    EXPECT_EQ(PARQUET_SEGMENT_TAIL, segments[6].type);
+
+    vector<uint8_t> result = this->readAll();
+    ASSERT_EQ(file.size(), result.size());
+
+    // Chunks of 'b' are read, those of 'a' and 'c' are zeros, the rest is as it is.
+    for (size_t i = 0; i < file.size(); i++) {
+        if ((file[i] == 'a' || file[i] == 'c') && i < this->tailOffset) {
+            ASSERT_EQ(0, result[i]) << i;
+        } else {
+            ASSERT_EQ(file[i], result[i]) << i;
+        }
+    }
+
+    EXPECT_EQ(4 + 2 * chunkSize, rangeReader.fetchedBytes);
+    EXPECT_EQ((size_t)3, rangeReader.openedRanges.size());
+}
+
+TEST_F(ParquetReaderTest, CloseRangesAreFetchedAsOne) {
+    uint64_t chunkSize = S3_PARQUET_RANGE_MERGE_GAP / 4;
+    vector<TestColumn> columns = {
+        {"a", chunkSize, false}, {"b", chunkSize, false}, {"c", chunkSize, false}};
+    vector<uint8_t> file = makeParquetFile(columns, 1);
+
+    this->openFile(file, {"a", "c"});
+
+    const vector<ParquetSegment> &segments = this->getSegments();
+    ASSERT_EQ((size_t)2, segments.size());
+    EXPECT_EQ(PARQUET_SEGMENT_FETCH, segments[0].type);
+    EXPECT_EQ((uint64_t)0, segments[0].offset);
+    EXPECT_EQ(PARQUET_SEGMENT_TAIL, segments[1].type);
+
+    EXPECT_TRUE(file == this->readAll());
+    EXPECT_EQ((size_t)1, rangeReader.openedRanges.size());
+}
+
+TEST_F(ParquetReaderTest, UnknownColumnReadsNoChunk) {
+    uint64_t chunkSize = 2 * S3_PARQUET_RANGE_MERGE_GAP;
+    vector<TestColumn> columns = {{"a", chunkSize, false}, {"b", chunkSize, false}};
+    vector<uint8_t> file = makeParquetFile(columns, 1);
+
+    this->openFile(file, {"x"});
+
+    vector<uint8_t> result = this->readAll();
+    ASSERT_EQ(file.size(), result.size());
+    EXPECT_EQ((uint64_t)4, rangeReader.fetchedBytes);
+    EXPECT_EQ(0, memcmp(file.data(), result.data(), 4));
+    EXPECT_EQ(0, result[4]);
+}
+
+TEST_F(ParquetReaderTest, LongFooterIsFetchedAgain) {
+    // Columns of long names make a footer longer than the prefetched tail.
+    vector<TestColumn> columns;
+    for (int i = 0; i < 20; i++) {
+        columns.push_back({string(4000, 'a' + i), 1000, false});
+    }
+    vector<uint8_t> file = makeParquetFile(columns, 1);
+
+    // The other columns are in the gap before it, which is small enough to be fetched along.
+    this->openFile(file, {string(4000, 'a' + 19)});
+
+    EXPECT_TRUE(file.size() - this->tailOffset > S3_PARQUET_FOOTER_PREFETCH_SIZE);
+    EXPECT_TRUE(file == this->readAll());
+}
+
+TEST_F(ParquetReaderTest, NotParquetIsReadAsWhole) {
+    string text(100000, 'x');
+    vector<uint8_t> file(text.begin(), text.end());
+
+    this->openFile(file, {"a"});
+
+    const vector<ParquetSegment> &segments = this->getSegments();
+    ASSERT_EQ((size_t)1, segments.size());
+    EXPECT_EQ(PARQUET_SEGMENT_FETCH, segments[0].type);
+    EXPECT_EQ(file.size(), segments[0].length);
+
+    EXPECT_TRUE(file == this->readAll());
+    EXPECT_EQ(file.size(), rangeReader.fetchedBytes);
+}
+
+TEST_F(ParquetReaderTest, EmptyKey) {
+    this->openFile(vector<uint8_t>(), {"a"});
+
+    char buf[16];
+    EXPECT_EQ((uint64_t)0, this->read(buf, sizeof(buf)));
+}
@@ -285,3 +285,346 @@ TEST_F(S3BucketReaderTest, ReadBucketFileWithHeaderAndFuzyMatch) {
     eolString[0] = '\n';
     eolString[1] = '\0';
 }
+
+// Serves getKeySize() bytes for each key it is opened for, and logs what
+// S3BucketReader asks for.
+class LoggingS3Reader : public Reader {
+   public:
+    LoggingS3Reader(vector<string>& log) : log(log), keySize(0), remaining(0), opened(false) {
+    }
+
+    void open(const S3Params& params) {
+        this->keySize = params.getKeySize();
+        this->remaining = this->keySize;
+        this->opened = true;
+        log.push_back("open " + std::to_string((unsigned long long)keySize) + " with " +
+                      std::to_string((unsigned long long)params.getNumOfChunks()) + " chunks");
+    }
+
+    uint64_t read(char* buf, uint64_t count) {
+        uint64_t readCount = std::min(count, this->remaining);
+        memset(buf, 'a', readCount);
+        this->remaining -= readCount;
+        return readCount;
+    }
+
+    void close() {
+        if (this->opened) {
+            log.push_back("close " + std::to_string((unsigned long long)keySize));
+            this->opened = false;
+        }
+    }
+
+   private:
+    vector<string>& log;
+    uint64_t keySize;
+    uint64_t remaining;
+    bool opened;
+};
+
+class S3BucketReaderPrefetchTest : public S3BucketReaderTest {
+   protected:
+    virtual void SetUp() {
+        S3BucketReaderTest::SetUp();
+
+        for (int i = 0; i < 3; i++) {
+            readers.push_back(new LoggingS3Reader(log));
+        }
+        bucketReader->setPrefetchReaders(readers);
+
+        params = S3Params("https://s3-us-east-2.amazonaws.com/s3test.pivotal.io/whatever");
+        params.setChunkSize(25);
+        params.setNumOfChunks(2);
+    }
+
+    virtual void TearDown() {
+        S3BucketReaderTest::TearDown();
+
+        for (size_t i = 0; i < readers.size(); i++) {
+            delete readers[i];
+        }
+    }
+
+    vector<string> log;
+    vector<Reader*> readers;
+    S3Params params;
+};
+
+TEST_F(S3BucketReaderPrefetchTest, SmallKeysArePrefetchedWithinBudget) {
+    ListBucketResult result;
+    result.contents.emplace_back("foo", 10);
+    result.contents.emplace_back("bar", 20);
+    result.contents.emplace_back("baz", 5);
+
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(1).WillOnce(Return(result));
+
+    bucketReader->open(params);
+
+    EXPECT_EQ((uint64_t)10, bucketReader->read(buf, sizeof(buf)));
+    ASSERT_EQ((size_t)2, log.size());
+    EXPECT_EQ("open 10 with 1 chunks", log[0]);
+    EXPECT_EQ("open 20 with 1 chunks", log[1]);
+
+    EXPECT_EQ((uint64_t)20, bucketReader->read(buf, sizeof(buf)));
+    ASSERT_EQ((size_t)4, log.size());
+    EXPECT_EQ("close 10", log[2]);
+    EXPECT_EQ("open 5 with 1 chunks", log[3]);
+
+    EXPECT_EQ((uint64_t)5, bucketReader->read(buf, sizeof(buf)));
+    EXPECT_EQ((uint64_t)0, bucketReader->read(buf, sizeof(buf)));
+    ASSERT_EQ((size_t)6, log.size());
+    EXPECT_EQ("close 20", log[4]);
+    EXPECT_EQ("close 5", log[5]);
+}
+
+TEST_F(S3BucketReaderPrefetchTest, BigKeyWaitsForBudget) {
+    ListBucketResult result;
+    result.contents.emplace_back("foo", 10);
+    result.contents.emplace_back("bar", 60);
+    result.contents.emplace_back("baz", 5);
+
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(1).WillOnce(Return(result));
+
+    bucketReader->open(params);
+
+    // "bar" needs 3 chunks, it is capped to threadnum, which "foo" doesn't leave.
+    EXPECT_EQ((uint64_t)10, bucketReader->read(buf, sizeof(buf)));
+    ASSERT_EQ((size_t)1, log.size());
+    EXPECT_EQ("open 10 with 1 chunks", log[0]);
+
+    EXPECT_EQ((uint64_t)60, bucketReader->read(buf, sizeof(buf)));
+    ASSERT_EQ((size_t)3, log.size());
+    EXPECT_EQ("close 10", log[1]);
+    EXPECT_EQ("open 60 with 2 chunks", log[2]);
+
+    EXPECT_EQ((uint64_t)5, bucketReader->read(buf, sizeof(buf)));
+    ASSERT_EQ((size_t)5, log.size());
+    EXPECT_EQ("close 60", log[3]);
+    EXPECT_EQ("open 5 with 1 chunks", log[4]);
+}
+
+TEST_F(S3BucketReaderPrefetchTest, PrefetchIsBoundedByReaders) {
+    ListBucketResult result;
+    for (int i = 1; i <= 5; i++) {
+        result.contents.emplace_back("foo" + std::to_string((unsigned long long)i), i);
+    }
+
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(1).WillOnce(Return(result));
+
+    params.setChunkSize(100);
+    params.setNumOfChunks(8);
+    bucketReader->open(params);
+
+    EXPECT_EQ((uint64_t)1, bucketReader->read(buf, sizeof(buf)));
+    EXPECT_EQ((size_t)3, log.size());
+}
+
+TEST_F(S3BucketReaderPrefetchTest, CloseClosesPrefetchedKeys) {
+    ListBucketResult result;
+    result.contents.emplace_back("foo", 10);
+    result.contents.emplace_back("bar", 20);
+
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(1).WillOnce(Return(result));
+
+    bucketReader->open(params);
+
+    EXPECT_EQ((uint64_t)10, bucketReader->read(buf, sizeof(buf)));
+    bucketReader->close();
+
+    ASSERT_EQ((size_t)4, log.size());
+    EXPECT_EQ("close 10", log[2]);
+    EXPECT_EQ("close 20", log[3]);
+}
+
+TEST_F(S3BucketReaderTest, KeysAreAssignedBySize) {
+    ListBucketResult result;
+    result.contents.emplace_back("k0", 100);
+    result.contents.emplace_back("k1", 10);
+    result.contents.emplace_back("k2", 10);
+    result.contents.emplace_back("k3", 10);
+    result.contents.emplace_back("k4", 70);
+
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(2).WillRepeatedly(Return(result));
+
+    S3Params params("https://s3-us-east-2.amazonaws.com/s3test.pivotal.io/whatever");
+    s3ext_segnum = 2;
+
+    s3ext_segid = 0;
+    bucketReader->open(params);
+    ASSERT_EQ((size_t)1, bucketReader->getKeyParts().size());
+    EXPECT_EQ((uint64_t)0, bucketReader->getKeyParts()[0].keyIndex);
+    bucketReader->close();
+
+    // The biggest key is left alone, the others are read in list order.
+    s3ext_segid = 1;
+    bucketReader->open(params);
+    ASSERT_EQ((size_t)4, bucketReader->getKeyParts().size());
+    EXPECT_EQ((uint64_t)1, bucketReader->getKeyParts()[0].keyIndex);
+    EXPECT_EQ((uint64_t)2, bucketReader->getKeyParts()[1].keyIndex);
+    EXPECT_EQ((uint64_t)3, bucketReader->getKeyParts()[2].keyIndex);
+    EXPECT_EQ((uint64_t)4, bucketReader->getKeyParts()[3].keyIndex);
+}
+
+// Serves the requested byte range of a fixed content.
+class RangeS3Reader : public Reader {
+   public:
+    RangeS3Reader(const string& content) : content(content), pos(0), end(0) {
+    }
+
+    void open(const S3Params& params) {
+        this->pos = params.getKeyRangeOffset();
+        this->end = params.getKeyRangeLength() == 0
+                        ? content.size()
+                        : params.getKeyRangeOffset() + params.getKeyRangeLength();
+    }
+
+    uint64_t read(char* buf, uint64_t count) {
+        uint64_t readCount = std::min(count, this->end - this->pos);
+        memcpy(buf, this->content.data() + this->pos, readCount);
+        this->pos += readCount;
+        return readCount;
+    }
+
+    void close() {
+    }
+
+   private:
+    string content;
+    uint64_t pos;
+    uint64_t end;
+};
+
+class S3BucketReaderSplitTest : public S3BucketReaderTest {
+   protected:
+    virtual void SetUp() {
+        S3BucketReaderTest::SetUp();
+
+        params = S3Params("https://s3-us-east-2.amazonaws.com/s3test.pivotal.io/whatever");
+        params.setChunkSize(5);
+        params.setSplitSize(5);
+
+        s3ext_segid = 0;
+        s3ext_segnum = 1;
+    }
+
+    // Reads content as a single key on every segment, returns what each one got. With borrow,
+    // data is borrowed instead of read.
+    vector<string> readOnSegments(const string& content, int32_t segnum, bool borrow = false) {
+        ListBucketResult result;
+        result.contents.emplace_back("foo", content.size());
+        EXPECT_CALL(s3Interface, listBucket(_)).WillRepeatedly(Return(result));
+
+        vector<string> output;
+        for (int32_t segid = 0; segid < segnum; segid++) {
+            s3ext_segid = segid;
+            s3ext_segnum = segnum;
+
+            RangeS3Reader reader(content);
+            S3BucketReader segmentReader;
+            segmentReader.setS3InterfaceService(&s3Interface);
+            segmentReader.setUpstreamReader(&reader);
+            segmentReader.open(params);
+
+            string data;
+            uint64_t readCount;
+            if (borrow) {
+                const char* lent;
+                while ((readCount = segmentReader.borrow(&lent, 3)) != 0) {
+                    data.append(lent, readCount);
+                    segmentReader.release();
+                }
+                segmentReader.release();
+            } else {
+                while ((readCount = segmentReader.read(buf, 3)) != 0) {
+                    data.append(buf, readCount);
+                }
+            }
+            output.push_back(data);
+        }
+        return output;
+    }
+
+    S3Params params;
+};
+
+TEST_F(S3BucketReaderSplitTest, BigKeyIsSplitAtLineEnds) {
+    EXPECT_CALL(s3Interface, checkCompressionType(_))
+        .WillRepeatedly(Return(S3_COMPRESSION_PLAIN));
+
+    // Parts are [0, 5), [5, 10), [10, 15), [15, 20) and [20, 22), the line "ddddddd\n" starts
+    // in the third part and covers the fourth.
+    vector<string> output = readOnSegments("aaa\nbbbb\ncc\nddddddd\ne\n", 3);
+
+    std::multiset<string> lines;
+    for (size_t i = 0; i < output.size(); i++) {
+        EXPECT_TRUE(output[i].empty() || output[i][output[i].size() - 1] == '\n');
+
+        std::istringstream lineStream(output[i]);
+        string line;
+        while (std::getline(lineStream, line)) {
+            lines.insert(line);
+        }
+    }
+
+    std::multiset<string> expected = {"aaa", "bbbb", "cc", "ddddddd", "e"};
+    EXPECT_EQ(expected, lines);
+}
+
+TEST_F(S3BucketReaderSplitTest, BorrowGetsSameDataAsRead) {
+    EXPECT_CALL(s3Interface, checkCompressionType(_))
+        .WillRepeatedly(Return(S3_COMPRESSION_PLAIN));
+
+    const string content = "aaa\nbbbb\ncc\nddddddd\ne\n";
+    EXPECT_EQ(readOnSegments(content, 3), readOnSegments(content, 3, true));
+    EXPECT_EQ(readOnSegments(content, 5), readOnSegments(content, 5, true));
+}
+
+TEST_F(S3BucketReaderSplitTest, SplitPartsOnOneSegment) {
+    EXPECT_CALL(s3Interface, checkCompressionType(_))
+        .WillRepeatedly(Return(S3_COMPRESSION_PLAIN));
+
+    vector<string> output = readOnSegments("aaa\nbbbb\ncc\nddddddd\ne\n", 1);
+
+    ASSERT_EQ((size_t)1, output.size());
+    EXPECT_EQ("aaa\nbbbb\ncc\nddddddd\ne\n", output[0]);
+}
+
+TEST_F(S3BucketReaderSplitTest, LineCoveringWholePart) {
+    EXPECT_CALL(s3Interface, checkCompressionType(_))
+        .WillRepeatedly(Return(S3_COMPRESSION_PLAIN));
+
+    vector<string> output = readOnSegments("a\nbbbbbbbbbbbbbbbbbb\nc\n", 5);
+
+    string data;
+    for (size_t i = 0; i < output.size(); i++) {
+        data += output[i];
+    }
+    EXPECT_EQ((size_t)23, data.size());
+    EXPECT_NE(string::npos, data.find("bbbbbbbbbbbbbbbbbb\n"));
+}
+
+TEST_F(S3BucketReaderSplitTest, CompressedKeyIsNotSplit) {
+    EXPECT_CALL(s3Interface, checkCompressionType(_)).WillRepeatedly(Return(S3_COMPRESSION_GZIP));
+
+    ListBucketResult result;
+    result.contents.emplace_back("foo", 22);
+    EXPECT_CALL(s3Interface, listBucket(_)).WillOnce(Return(result));
+
+    bucketReader->open(params);
+    ASSERT_EQ((size_t)1, bucketReader->getKeyParts().size());
+    EXPECT_FALSE(bucketReader->getKeyParts()[0].isSplit);
+}
+
+TEST_F(S3BucketReaderSplitTest, KeyWithHeaderIsNotSplit) {
+    hasHeader = true;
+
+    ListBucketResult result;
+    result.contents.emplace_back("foo", 22);
+    EXPECT_CALL(s3Interface, listBucket(_)).WillOnce(Return(result));
+
+    bucketReader->open(params);
+    ASSERT_EQ((size_t)1, bucketReader->getKeyParts().size());
+    EXPECT_FALSE(bucketReader->getKeyParts()[0].isSplit);
+
+    hasHeader = false;
+}
@@ -49,6 +49,17 @@ TEST_F(S3CommonReaderTest, OpenGZip) {
     ASSERT_TRUE(NULL != dynamic_cast<DecompressReader *>(this->upstreamReader));
 }
 
+TEST_F(S3CommonReaderTest, OpenBzip2) {
+    // test case for: the file format is bzip2, then decompressReader should be called
+    EXPECT_CALL(mockS3Interface, checkCompressionType(_)).WillOnce(Return(S3_COMPRESSION_BZIP2));
+    S3Params params("s3://abc/def");
+    params.setNumOfChunks(1);
+    params.setChunkSize(1024 * 1024 * 2);
+    this->open(params);
+
+    ASSERT_EQ(this->upstreamReader, &this->decompressReader);
+}
+
 TEST_F(S3CommonReaderTest, OpenPlain) {
     // test case for: the file format is gzip, then S3keyReader should be called
     EXPECT_CALL(mockS3Interface, checkCompressionType(_)).WillOnce(Return(S3_COMPRESSION_PLAIN));
@@ -61,6 +72,19 @@ TEST_F(S3CommonReaderTest, OpenPlain) {
     ASSERT_TRUE(NULL != dynamic_cast<S3KeyReader *>(this->upstreamReader));
 }
 
+TEST_F(S3CommonReaderTest, OpenPlainWithColumns) {
+    // test case for: the file is not compressed and columns are given, then parquetReader should
+    // be called
+    EXPECT_CALL(mockS3Interface, checkCompressionType(_)).WillOnce(Return(S3_COMPRESSION_PLAIN));
+    S3Params params("s3://abc/def");
+    params.setNumOfChunks(1);
+    params.setChunkSize(1024 * 1024 * 2);
+    params.setColumns(vector<string>(1, "a"));
+    this->open(params);
+
+    ASSERT_EQ(this->upstreamReader, &this->parquetReader);
+}
+
 TEST_F(S3CommonReaderTest, ReadGZip) {
     Byte compressionBuff[0x100];
     uLong compressedLen = sizeof(compressionBuff);
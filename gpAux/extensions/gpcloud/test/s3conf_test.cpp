@@ -19,6 +19,8 @@ TEST(Config, Basic) {
 
     EXPECT_EQ((uint64_t)6, params.getNumOfChunks());
     EXPECT_EQ((uint64_t)(64 * 1024 * 1024 + 1), params.getChunkSize());
+    EXPECT_EQ((uint64_t)(1024 * 1024 * 1024), params.getSplitSize());
+    EXPECT_EQ(1, params.getGzipLevel());
 
     EXPECT_EQ(EXT_INFO, s3ext_loglevel);
     EXPECT_EQ(STDERR_LOG, s3ext_logtype);
@@ -29,20 +31,41 @@ TEST(Config, Basic) {
     EXPECT_EQ((uint64_t)1024, params.getLowSpeedLimit());
     EXPECT_EQ((uint64_t)600, params.getLowSpeedTime());
 
+    EXPECT_EQ((uint64_t)4, params.getMaxConnections());
+    EXPECT_EQ((uint64_t)30, params.getConnectionIdleTimeout());
+
+    EXPECT_EQ("", params.getListCacheDir());
+    EXPECT_EQ((uint64_t)300, params.getListCacheTtl());
+
     EXPECT_FALSE(params.isDebugCurl());
 
     EXPECT_EQ(SSE_S3, params.getSSEType());
 }
 
+TEST(Config, Columns) {
+    S3Params params = InitConfig("s3://abc/a config=data/s3test.conf columns=a,,B");
+    ASSERT_EQ((size_t)2, params.getColumns().size());
+    EXPECT_EQ("a", params.getColumns()[0]);
+    EXPECT_EQ("B", params.getColumns()[1]);
+
+    params = InitConfig("s3://abc/a config=data/s3test.conf");
+    EXPECT_TRUE(params.getColumns().empty());
+}
+
 TEST(Config, SpecialSectionValues) {
     S3Params params = InitConfig("s3://abc/a config=data/s3test.conf section=special_over");
 
     EXPECT_EQ((uint64_t)8, params.getNumOfChunks());
     EXPECT_EQ((uint64_t)(128 * 1024 * 1024), params.getChunkSize());
+    EXPECT_EQ(9, params.getGzipLevel());
 
     EXPECT_EQ((uint64_t)10240, params.getLowSpeedLimit());
     EXPECT_EQ((uint64_t)60, params.getLowSpeedTime());
 
+    EXPECT_EQ((uint64_t)64, params.getMaxConnections());
+    EXPECT_EQ((uint64_t)3600, params.getConnectionIdleTimeout());
+    EXPECT_EQ((uint64_t)86400, params.getListCacheTtl());
+
     EXPECT_FALSE(params.isDebugCurl());
     EXPECT_EQ(SSE_NONE, params.getSSEType());
 }
@@ -52,6 +75,11 @@ TEST(Config, SpecialSectionLowValues) {
 
     EXPECT_EQ((uint64_t)1, params.getNumOfChunks());
     EXPECT_EQ((uint64_t)(8 * 1024 * 1024), params.getChunkSize());
+    EXPECT_EQ((uint64_t)0, params.getSplitSize());
+    EXPECT_EQ(1, params.getGzipLevel());
+
+    EXPECT_EQ((uint64_t)0, params.getMaxConnections());
+    EXPECT_EQ((uint64_t)1, params.getConnectionIdleTimeout());
 }
 
 TEST(Config, SpecialSectionWrongKeyName) {
@@ -59,12 +87,27 @@ TEST(Config, SpecialSectionWrongKeyName) {
 
     EXPECT_EQ((uint64_t)4, params.getNumOfChunks());
     EXPECT_EQ((uint64_t)(64 * 1024 * 1024), params.getChunkSize());
+    EXPECT_EQ((uint64_t)0, params.getSplitSize());
+
+    EXPECT_TRUE(params.isAutoCompress());
+    EXPECT_FALSE(params.isGzipParallel());
+    EXPECT_EQ(6, params.getGzipLevel());
+    EXPECT_TRUE(params.isDecompressThread());
+
+    EXPECT_EQ((uint64_t)8, params.getMaxConnections());
+    EXPECT_EQ((uint64_t)60, params.getConnectionIdleTimeout());
+
+    EXPECT_EQ("/tmp/gpcloud_list_cache", params.getListCacheDir());
+    EXPECT_EQ((uint64_t)0, params.getListCacheTtl());
 }
 
 TEST(Config, SpecialSwitches) {
     S3Params params = InitConfig("s3://abc/a config=data/s3test.conf section=special_switches");
 
     EXPECT_TRUE(params.isDebugCurl());
+    EXPECT_FALSE(params.isAutoCompress());
+    EXPECT_TRUE(params.isGzipParallel());
+    EXPECT_FALSE(params.isDecompressThread());
 }
 
 TEST(Config, SectionExist) {
@@ -0,0 +1,83 @@
+#include "s3curl_pool.cpp"
+#include "gtest/gtest.h"
+
+TEST(S3CurlPool, GetEndpoint) {
+    EXPECT_EQ("https://s3-us-west-2.amazonaws.com",
+              S3CurlPool::getEndpoint("https://s3-us-west-2.amazonaws.com/bucket/prefix/key"));
+    EXPECT_EQ("http://localhost:8553", S3CurlPool::getEndpoint("http://localhost:8553/bucket"));
+    EXPECT_EQ("https://s3.amazonaws.com",
+              S3CurlPool::getEndpoint("https://s3.amazonaws.com?uploads"));
+    EXPECT_EQ("https://s3.amazonaws.com", S3CurlPool::getEndpoint("https://s3.amazonaws.com"));
+    EXPECT_EQ("s3.amazonaws.com", S3CurlPool::getEndpoint("s3.amazonaws.com/bucket"));
+}
+
+TEST(S3CurlPool, ReleasedHandleIsReused) {
+    S3CurlPool &pool = S3CurlPool::getInstance();
+    string url = "https://reuse.example.com/bucket/key";
+
+    CURL *handle = pool.acquire(url);
+    ASSERT_TRUE(handle != NULL);
+    EXPECT_EQ((size_t)0, pool.getIdleCount(url));
+
+    pool.release(url, handle, 2, 60);
+    EXPECT_EQ((size_t)1, pool.getIdleCount("https://reuse.example.com/bucket/otherkey"));
+
+    EXPECT_EQ(handle, pool.acquire("https://reuse.example.com/otherbucket"));
+    EXPECT_EQ((size_t)0, pool.getIdleCount(url));
+
+    pool.release(url, handle, 0, 60);
+    EXPECT_EQ((size_t)0, pool.getIdleCount(url));
+}
+
+TEST(S3CurlPool, OtherEndpointDoesNotReuse) {
+    S3CurlPool &pool = S3CurlPool::getInstance();
+    string url = "https://one.example.com/bucket/key";
+    string otherUrl = "https://two.example.com/bucket/key";
+
+    CURL *handle = pool.acquire(url);
+    pool.release(url, handle, 2, 60);
+
+    CURL *otherHandle = pool.acquire(otherUrl);
+    EXPECT_NE(handle, otherHandle);
+    EXPECT_EQ((size_t)1, pool.getIdleCount(url));
+
+    pool.release(otherUrl, otherHandle, 0, 60);
+    pool.release(url, pool.acquire(url), 0, 60);
+    EXPECT_EQ((size_t)0, pool.getIdleCount(url));
+}
+
+TEST(S3CurlPool, KeepsAtMostMaxIdleHandles) {
+    S3CurlPool &pool = S3CurlPool::getInstance();
+    string url = "https://max.example.com/bucket/key";
+
+    CURL *handles[3];
+    for (int i = 0; i < 3; i++) {
+        handles[i] = pool.acquire(url);
+    }
+    for (int i = 0; i < 3; i++) {
+        pool.release(url, handles[i], 2, 60);
+    }
+    EXPECT_EQ((size_t)2, pool.getIdleCount(url));
+
+    // The most recently released handle is reused first.
+    CURL *handle = pool.acquire(url);
+    EXPECT_EQ(handles[1], handle);
+
+    pool.release(url, handle, 0, 60);
+    pool.release(url, pool.acquire(url), 0, 60);
+    EXPECT_EQ((size_t)0, pool.getIdleCount(url));
+}
+
+TEST(S3CurlPool, ExpiredHandleIsEvicted) {
+    S3CurlPool &pool = S3CurlPool::getInstance();
+    string url = "https://expire.example.com/bucket/key";
+    string otherUrl = "https://other.example.com/bucket/key";
+
+    pool.release(url, pool.acquire(url), 2, 0);
+
+    // Any acquire evicts the expired handles of all endpoints.
+    CURL *handle = pool.acquire(otherUrl);
+    EXPECT_EQ((size_t)0, pool.getIdleCount(url));
+
+    pool.release(otherUrl, handle, 0, 60);
+}
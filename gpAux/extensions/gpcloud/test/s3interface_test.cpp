@@ -411,6 +411,42 @@ TEST_F(S3InterfaceServiceTest, checkItsGzipCompressed) {
     EXPECT_EQ(S3_COMPRESSION_GZIP, this->checkCompressionType(s3Url));
 }
 
+TEST_F(S3InterfaceServiceTest, checkItsZstdCompressed) {
+    uint8_t raw[] = {0x28, 0xb5, 0x2f, 0xfd};
+    Response response(RESPONSE_OK, vector<uint8_t>(raw, raw + sizeof(raw)));
+    EXPECT_CALL(mockRESTfulService, get(_, _)).WillOnce(Return(response));
+
+    S3Url s3Url("https://s3-us-west-2.amazonaws.com/s3test.pivotal.io/whatever");
+    EXPECT_EQ(S3_COMPRESSION_ZSTD, this->checkCompressionType(s3Url));
+}
+
+TEST_F(S3InterfaceServiceTest, checkItsLz4Compressed) {
+    uint8_t raw[] = {0x04, 0x22, 0x4d, 0x18};
+    Response response(RESPONSE_OK, vector<uint8_t>(raw, raw + sizeof(raw)));
+    EXPECT_CALL(mockRESTfulService, get(_, _)).WillOnce(Return(response));
+
+    S3Url s3Url("https://s3-us-west-2.amazonaws.com/s3test.pivotal.io/whatever");
+    EXPECT_EQ(S3_COMPRESSION_LZ4, this->checkCompressionType(s3Url));
+}
+
+TEST_F(S3InterfaceServiceTest, checkItsBzip2Compressed) {
+    uint8_t raw[] = {'B', 'Z', 'h', '9'};
+    Response response(RESPONSE_OK, vector<uint8_t>(raw, raw + sizeof(raw)));
+    EXPECT_CALL(mockRESTfulService, get(_, _)).WillOnce(Return(response));
+
+    S3Url s3Url("https://s3-us-west-2.amazonaws.com/s3test.pivotal.io/whatever");
+    EXPECT_EQ(S3_COMPRESSION_BZIP2, this->checkCompressionType(s3Url));
+}
+
+TEST_F(S3InterfaceServiceTest, checkItsNotBzip2Compressed) {
+    uint8_t raw[] = {'B', 'Z', 'h', 'a'};
+    Response response(RESPONSE_OK, vector<uint8_t>(raw, raw + sizeof(raw)));
+    EXPECT_CALL(mockRESTfulService, get(_, _)).WillOnce(Return(response));
+
+    S3Url s3Url("https://s3-us-west-2.amazonaws.com/s3test.pivotal.io/whatever");
+    EXPECT_EQ(S3_COMPRESSION_PLAIN, this->checkCompressionType(s3Url));
+}
+
 TEST_F(S3InterfaceServiceTest, checkItsNotCompressed) {
     vector<uint8_t> raw;
     raw.resize(4);
@@ -290,6 +290,76 @@ TEST_F(S3KeyReaderTest, ReadWithSingleChunkNormalCase) {
     EXPECT_EQ((uint64_t)0, this->read(buffer, 32));
 }
 
+TEST_F(S3KeyReaderTest, BorrowWithSingleChunk) {
+    S3Params params("s3://abc/def");
+    params.setNumOfChunks(1);
+    params.setKeySize(128);
+    params.setChunkSize(64);
+
+    EXPECT_CALL(s3Interface, fetchData(_, _, _, _))
+        .WillOnce(Invoke(MockFetchData(64, 64)))
+        .WillOnce(Invoke(MockFetchData(64, 64)));
+
+    this->open(params);
+
+    // Data is lent from the chunk, one span after another.
+    const char *first = NULL;
+    EXPECT_EQ((uint64_t)32, this->borrow(&first, 32));
+    this->release();
+
+    const char *second = NULL;
+    EXPECT_EQ((uint64_t)32, this->borrow(&second, 64));
+    EXPECT_EQ(first + 32, second);
+
+    // The chunk is not refilled before its data is released.
+    EXPECT_EQ(ReadyToRead, this->getChunkBuffers()[0].getStatus());
+    this->release();
+
+    const char *data = NULL;
+    EXPECT_EQ((uint64_t)64, this->borrow(&data, 64));
+    this->release();
+
+    // A missing eol is lent at the end of key.
+    EXPECT_EQ((uint64_t)1, this->borrow(&data, 64));
+    EXPECT_EQ('\n', data[0]);
+    this->release();
+
+    EXPECT_EQ((uint64_t)0, this->borrow(&data, 64));
+    this->release();
+}
+
+TEST_F(S3KeyReaderTest, ReadRangeOfKey) {
+    S3Params params("s3://abc/def");
+    params.setNumOfChunks(1);
+    params.setKeySize(255);
+    params.setChunkSize(64);
+    params.setKeyRange(100, 50);
+
+    EXPECT_CALL(s3Interface, fetchData(100, _, 50, _)).WillOnce(Invoke(MockFetchData(50, 64)));
+
+    this->open(params);
+
+    // No eol is appended before the end of key.
+    EXPECT_EQ((uint64_t)50, this->read(buffer, 64));
+    EXPECT_EQ((uint64_t)0, this->read(buffer, 64));
+}
+
+TEST_F(S3KeyReaderTest, ReadRangeToEndOfKey) {
+    S3Params params("s3://abc/def");
+    params.setNumOfChunks(1);
+    params.setKeySize(255);
+    params.setChunkSize(64);
+    params.setKeyRange(200, 55);
+
+    EXPECT_CALL(s3Interface, fetchData(200, _, 55, _)).WillOnce(Invoke(MockFetchData(55, 64)));
+
+    this->open(params);
+
+    EXPECT_EQ((uint64_t)55, this->read(buffer, 64));
+    EXPECT_EQ((uint64_t)1, this->read(buffer, 64));
+    EXPECT_EQ((uint64_t)0, this->read(buffer, 64));
+}
+
 TEST_F(S3KeyReaderTest, ReadWithSmallBuffer) {
     S3Params params("s3://abc/def");
 
@@ -186,3 +186,143 @@ TEST_F(S3KeyWriterTest, TestWriteAbortInClosing) {
     EXPECT_THROW(this->close(), S3QueryAbort);
     QueryCancelPending = false;
 }
+
+TEST_F(S3KeyWriterTest, TestPartSizeGrows) {
+    EXPECT_CALL(mockS3Interface, getUploadId(_)).WillOnce(Return("uploadId"));
+
+    this->open(testParams);
+    EXPECT_EQ((uint64_t)1000, this->getPartSize());
+
+    this->partNumber = S3_UPLOAD_PARTS_PER_SIZE_STEP - 1;
+    EXPECT_EQ((uint64_t)1000, this->getPartSize());
+
+    this->partNumber = S3_UPLOAD_PARTS_PER_SIZE_STEP;
+    EXPECT_EQ((uint64_t)2000, this->getPartSize());
+
+    this->partNumber = S3_UPLOAD_MAX_PARTS - 1;
+    EXPECT_EQ((uint64_t)10000, this->getPartSize());
+
+    this->partNumber = 0;
+}
+
+TEST_F(S3KeyWriterTest, TestTooManyParts) {
+    testParams.setChunkSize(0x10);
+
+    char data[0x100];
+    EXPECT_CALL(this->mockS3Interface, getUploadId(_)).WillOnce(Return("uploadid1"));
+    EXPECT_CALL(this->mockS3Interface, abortUpload(_, "uploadid1")).WillOnce(Return(true));
+
+    this->open(testParams);
+    this->partNumber = S3_UPLOAD_MAX_PARTS;
+
+    EXPECT_THROW(this->write(data, sizeof(data)), S3RuntimeError);
+    EXPECT_THROW(this->close(), S3RuntimeError);
+}
+
+TEST_F(S3KeyWriterTest, TestRetryFailedPart) {
+    testParams.setChunkSize(0x100);
+    this->retryDelay = 1;
+
+    char data[0x100];
+    EXPECT_CALL(this->mockS3Interface, getUploadId(_)).WillOnce(Return("uploadid1"));
+    EXPECT_CALL(this->mockS3Interface, uploadPartOfData(_, _, 1, "uploadid1"))
+        .WillOnce(Throw(S3ConnectionError("")))
+        .WillOnce(Throw(S3LogicError("SlowDown", "")))
+        .WillOnce(Invoke(MockUploadPartOfData(0x100)));
+    EXPECT_CALL(this->mockS3Interface, completeMultiPart(_, "uploadid1", _))
+        .WillOnce(Return(true));
+
+    this->open(testParams);
+    ASSERT_EQ(sizeof(data), this->write(data, sizeof(data)));
+    this->close();
+}
+
+TEST_F(S3KeyWriterTest, TestAbortAfterRetries) {
+    testParams.setChunkSize(0x100);
+    this->retryDelay = 1;
+
+    char data[0x100];
+    EXPECT_CALL(this->mockS3Interface, getUploadId(_)).WillOnce(Return("uploadid1"));
+    EXPECT_CALL(this->mockS3Interface, uploadPartOfData(_, _, 1, "uploadid1"))
+        .Times(S3_UPLOAD_PART_MAX_RETRIES + 1)
+        .WillRepeatedly(Throw(S3ConnectionError("")));
+    EXPECT_CALL(this->mockS3Interface, abortUpload(_, "uploadid1")).WillOnce(Return(true));
+
+    this->open(testParams);
+    ASSERT_EQ(sizeof(data), this->write(data, sizeof(data)));
+    EXPECT_THROW(this->close(), S3ConnectionError);
+
+    // The upload is gone, nothing is left to close.
+    this->close();
+}
+
+TEST_F(S3KeyWriterTest, TestLogicErrorIsNotRetried) {
+    testParams.setChunkSize(0x100);
+    this->retryDelay = 1;
+
+    char data[0x100];
+    EXPECT_CALL(this->mockS3Interface, getUploadId(_)).WillOnce(Return("uploadid1"));
+    EXPECT_CALL(this->mockS3Interface, uploadPartOfData(_, _, 1, "uploadid1"))
+        .WillOnce(Throw(S3LogicError("AccessDenied", "")));
+    EXPECT_CALL(this->mockS3Interface, abortUpload(_, "uploadid1")).WillOnce(Return(true));
+
+    this->open(testParams);
+    ASSERT_EQ(sizeof(data), this->write(data, sizeof(data)));
+    EXPECT_THROW(this->close(), S3LogicError);
+}
+
+class MockConcurrentUpload {
+   public:
+    MockConcurrentUpload(uint64_t *running, uint64_t *maxRunning, pthread_mutex_t *mutex)
+        : running(running), maxRunning(maxRunning), mutex(mutex) {
+    }
+
+    string operator()(S3VectorUInt8 &data, const S3Url &s3Url, uint64_t partNumber,
+                      const string &uploadId) {
+        {
+            UniqueLock lock(mutex);
+            (*running)++;
+            *maxRunning = std::max(*maxRunning, *running);
+        }
+
+        usleep(5 * 1000);
+
+        UniqueLock lock(mutex);
+        (*running)--;
+        return "\"etag" + std::to_string((unsigned long long)partNumber) + "\"";
+    }
+
+   private:
+    uint64_t *running;
+    uint64_t *maxRunning;
+    pthread_mutex_t *mutex;
+};
+
+TEST_F(S3KeyWriterTest, TestPartsAreUploadedByPool) {
+    testParams.setChunkSize(0x100);
+
+    uint64_t running = 0;
+    uint64_t maxRunning = 0;
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+    vector<string> expectedEtags;
+    for (int i = 1; i <= 10; i++) {
+        expectedEtags.push_back("\"etag" + std::to_string((unsigned long long)i) + "\"");
+    }
+
+    char data[0x100 * 10];
+    EXPECT_CALL(this->mockS3Interface, getUploadId(_)).WillOnce(Return("uploadid1"));
+    EXPECT_CALL(this->mockS3Interface, uploadPartOfData(_, _, _, "uploadid1"))
+        .Times(10)
+        .WillRepeatedly(Invoke(MockConcurrentUpload(&running, &maxRunning, &mutex)));
+    EXPECT_CALL(this->mockS3Interface, completeMultiPart(_, "uploadid1", expectedEtags))
+        .WillOnce(Return(true));
+
+    this->open(testParams);
+    ASSERT_EQ(sizeof(data), this->write(data, sizeof(data)));
+    EXPECT_LE(this->pendingParts, testParams.getNumOfChunks());
+    this->close();
+
+    EXPECT_LE(maxRunning, testParams.getNumOfChunks());
+    EXPECT_TRUE(this->threadList.empty());
+}
@@ -0,0 +1,154 @@
+#include "s3listing_cache.cpp"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "mock_classes.h"
+
+#include <dirent.h>
+
+using ::testing::Return;
+using ::testing::_;
+
+class S3ListingCacheTest : public testing::Test {
+   protected:
+    virtual void SetUp() {
+        char tmpDir[] = "/tmp/gpcloud_listing_test.XXXXXX";
+        ASSERT_TRUE(mkdtemp(tmpDir) != NULL);
+        this->tmpDir = tmpDir;
+        this->cacheDir = this->tmpDir + "/cache";
+
+        this->cred.accessID = "accessid";
+
+        this->result.Name = "bucket";
+        this->result.Prefix = "prefix";
+        this->result.contents.emplace_back("prefix/a", 1024);
+        this->result.contents.emplace_back("prefix/with space", 0);
+        this->result.contents.emplace_back("prefix/with\nnewline", 42);
+    }
+
+    virtual void TearDown() {
+        removeFiles(this->cacheDir);
+        rmdir(this->cacheDir.c_str());
+        rmdir(this->tmpDir.c_str());
+    }
+
+    static void removeFiles(const string &dir) {
+        DIR *d = opendir(dir.c_str());
+        if (d == NULL) {
+            return;
+        }
+
+        struct dirent *entry;
+        while ((entry = readdir(d)) != NULL) {
+            if (strcmp(entry->d_name, ".") && strcmp(entry->d_name, "..")) {
+                unlink((dir + "/" + entry->d_name).c_str());
+            }
+        }
+        closedir(d);
+    }
+
+    static void expectSameListing(const ListBucketResult &expected,
+                                  const ListBucketResult &actual) {
+        EXPECT_EQ(expected.Name, actual.Name);
+        EXPECT_EQ(expected.Prefix, actual.Prefix);
+        ASSERT_EQ(expected.contents.size(), actual.contents.size());
+        for (size_t i = 0; i < expected.contents.size(); i++) {
+            EXPECT_EQ(expected.contents[i].getName(), actual.contents[i].getName());
+            EXPECT_EQ(expected.contents[i].getSize(), actual.contents[i].getSize());
+        }
+    }
+
+    string tmpDir;
+    string cacheDir;
+    S3Credential cred;
+    ListBucketResult result;
+
+    MockS3Interface s3Interface;
+};
+
+TEST_F(S3ListingCacheTest, EmptyDirDisablesCache) {
+    S3Url s3Url("https://s3-us-west-2.amazonaws.com/bucket/prefix");
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(2).WillRepeatedly(Return(result));
+
+    S3ListingCache cache("", 3600);
+    expectSameListing(result, cache.listBucket(&s3Interface, s3Url, cred));
+    expectSameListing(result, cache.listBucket(&s3Interface, s3Url, cred));
+}
+
+TEST_F(S3ListingCacheTest, ListingIsReusedWithinTtl) {
+    S3Url s3Url("https://s3-us-west-2.amazonaws.com/bucket/prefix");
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(1).WillOnce(Return(result));
+
+    S3ListingCache cache(this->cacheDir, 3600);
+    expectSameListing(result, cache.listBucket(&s3Interface, s3Url, cred));
+    expectSameListing(result, cache.listBucket(&s3Interface, s3Url, cred));
+
+    struct stat st;
+    ASSERT_EQ(0, stat(this->cacheDir.c_str(), &st));
+    EXPECT_EQ((mode_t)0700, st.st_mode & 0777);
+}
+
+TEST_F(S3ListingCacheTest, EmptyListingIsReused) {
+    S3Url s3Url("https://s3-us-west-2.amazonaws.com/bucket/prefix");
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(1).WillOnce(Return(ListBucketResult()));
+
+    S3ListingCache cache(this->cacheDir, 3600);
+    expectSameListing(ListBucketResult(), cache.listBucket(&s3Interface, s3Url, cred));
+    expectSameListing(ListBucketResult(), cache.listBucket(&s3Interface, s3Url, cred));
+}
+
+TEST_F(S3ListingCacheTest, ListingIsNotReusedWithoutTtl) {
+    S3Url s3Url("https://s3-us-west-2.amazonaws.com/bucket/prefix");
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(2).WillRepeatedly(Return(result));
+
+    S3ListingCache cache(this->cacheDir, 0);
+    expectSameListing(result, cache.listBucket(&s3Interface, s3Url, cred));
+    expectSameListing(result, cache.listBucket(&s3Interface, s3Url, cred));
+}
+
+TEST_F(S3ListingCacheTest, ListingIsNotSharedAcrossLocationsOrCredentials) {
+    S3Url s3Url("https://s3-us-west-2.amazonaws.com/bucket/prefix");
+    S3Url otherUrl("https://s3-us-west-2.amazonaws.com/bucket/prefix2");
+    S3Credential otherCred;
+    otherCred.accessID = "otheraccessid";
+
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(3).WillRepeatedly(Return(result));
+
+    S3ListingCache cache(this->cacheDir, 3600);
+    cache.listBucket(&s3Interface, s3Url, cred);
+    cache.listBucket(&s3Interface, otherUrl, cred);
+    cache.listBucket(&s3Interface, s3Url, otherCred);
+
+    EXPECT_NE(S3ListingCache::getCacheKey(s3Url, cred), S3ListingCache::getCacheKey(otherUrl, cred));
+    EXPECT_NE(S3ListingCache::getCacheKey(s3Url, cred),
+              S3ListingCache::getCacheKey(s3Url, otherCred));
+}
+
+TEST_F(S3ListingCacheTest, CorruptedListingIsIgnored) {
+    S3Url s3Url("https://s3-us-west-2.amazonaws.com/bucket/prefix");
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(2).WillRepeatedly(Return(result));
+
+    S3ListingCache cache(this->cacheDir, 3600);
+    cache.listBucket(&s3Interface, s3Url, cred);
+
+    // Cut the listing short.
+    string path = cache.getCachePath(s3Url, cred);
+    struct stat st;
+    ASSERT_EQ(0, stat(path.c_str(), &st));
+    ASSERT_EQ(0, truncate(path.c_str(), st.st_size - 5));
+
+    expectSameListing(result, cache.listBucket(&s3Interface, s3Url, cred));
+}
+
+TEST_F(S3ListingCacheTest, DirAccessibleByOthersIsNotUsed) {
+    S3Url s3Url("https://s3-us-west-2.amazonaws.com/bucket/prefix");
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(2).WillRepeatedly(Return(result));
+
+    ASSERT_EQ(0, mkdir(this->cacheDir.c_str(), 0777));
+    ASSERT_EQ(0, chmod(this->cacheDir.c_str(), 0777));
+
+    S3ListingCache cache(this->cacheDir, 3600);
+    cache.listBucket(&s3Interface, s3Url, cred);
+    cache.listBucket(&s3Interface, s3Url, cred);
+
+    EXPECT_NE(0, access(cache.getCachePath(s3Url, cred).c_str(), F_OK));
+}
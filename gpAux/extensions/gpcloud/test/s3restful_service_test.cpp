@@ -1,11 +1,32 @@
 #include "s3restful_service.cpp"
 #include "gtest/gtest.h"
+#include "mock_s3_server.h"
 
-TEST(S3RESTfulService, GetWithWrongHeader) {
+// Requests go to a local mock S3 server holding bucket/index.html.
+class S3RESTfulServiceTest : public testing::Test {
+   protected:
+    virtual void SetUp() {
+        ASSERT_TRUE(this->server.start());
+        this->server.putObject("bucket", "index.html", string(16 * 1024, 'a'));
+
+        this->existingUrl = this->server.getEndpoint() + "/bucket/index.html";
+        this->missingUrl = this->server.getEndpoint() + "/bucket/pivotal.html";
+    }
+
+    virtual void TearDown() {
+        this->server.stop();
+    }
+
+    MockS3Server server;
+    string existingUrl;
+    string missingUrl;
+};
+
+TEST_F(S3RESTfulServiceTest, GetWithWrongHeader) {
     HTTPHeaders headers;
     S3RESTfulService service;
 
-    string url = "https://www.bing.com/";
+    string url = this->existingUrl;
     headers.Add(HOST, url);
     headers.Add(CONTENTTYPE, "plain/text");
 
@@ -14,12 +35,12 @@ TEST(S3RESTfulService, GetWithWrongHeader) {
     EXPECT_EQ(RESPONSE_ERROR, resp.getStatus());
 }
 
-TEST(S3RESTfulService, GetWithEmptyHeader) {
+TEST_F(S3RESTfulServiceTest, GetWithEmptyHeader) {
     HTTPHeaders headers;
     string url;
     S3RESTfulService service;
 
-    url = "https://www.bing.com/";
+    url = this->existingUrl;
 
     Response resp = service.get(url, headers);
 
@@ -36,12 +57,12 @@ TEST(S3RESTfulService, GetWithoutURL) {
     EXPECT_THROW(service.get(url, headers), S3ConnectionError);
 }
 
-TEST(S3RESTfulService, GetWithWrongURL) {
+TEST_F(S3RESTfulServiceTest, GetWithWrongURL) {
     HTTPHeaders headers;
     string url;
     S3RESTfulService service;
 
-    url = "https://www.bing.com/pivotal.html";
+    url = this->missingUrl;
 
     Response resp = service.get(url, headers);
 
@@ -66,7 +87,7 @@ TEST(S3RESTfulService, PutWithoutURL) {
     EXPECT_THROW(service.put(url, headers, data), S3ConnectionError);
 }
 
-TEST(S3RESTfulService, PutToServerWithBlindPutService) {
+TEST_F(S3RESTfulServiceTest, PutToServerWithBlindPutService) {
     HTTPHeaders headers;
     string url;
     S3RESTfulService service;
@@ -76,14 +97,18 @@ TEST(S3RESTfulService, PutToServerWithBlindPutService) {
     for (int i = 0; i < 10; i++) data.push_back('a' + i);
     data.push_back(0);
 
-    url = "https://www.bing.com";
+    url = this->server.getEndpoint() + "/bucket/upload";
 
     Response resp = service.put(url, headers, data);
 
     EXPECT_EQ(RESPONSE_OK, resp.getStatus());
+
+    string object;
+    EXPECT_TRUE(this->server.getObject("bucket", "upload", object));
+    EXPECT_EQ(string(data.begin(), data.end()), object);
 }
 
-TEST(S3RESTfulService, PutToServerWith404Page) {
+TEST_F(S3RESTfulServiceTest, PutToServerWith404Page) {
     HTTPHeaders headers;
     string url;
     S3RESTfulService service;
@@ -93,7 +118,7 @@ TEST(S3RESTfulService, PutToServerWith404Page) {
     for (int i = 0; i < 10; i++) data.push_back('a' + i);
     data.push_back(0);
 
-    url = "https://www.bing.com/pivotal.html";
+    url = this->missingUrl + "?partNumber=1&uploadId=abcdefghij";
 
     Response resp = service.put(url, headers, data);
 
@@ -157,39 +182,39 @@ TEST(S3RESTfulService, HeadWithoutURL) {
     EXPECT_THROW(service.head(url, headers), S3ConnectionError);
 }
 
-TEST(S3RESTfulService, HeadWithCorrectURLAndDebugParam) {
+TEST_F(S3RESTfulServiceTest, HeadWithCorrectURLAndDebugParam) {
     HTTPHeaders headers;
 
     string url;
     S3RESTfulService service;
 
-    url = "https://www.bing.com/";
+    url = this->existingUrl;
 
     ResponseCode code = service.head(url, headers);
 
     EXPECT_EQ(200, code);
 }
 
-TEST(S3RESTfulService, HeadWithWrongURL) {
+TEST_F(S3RESTfulServiceTest, HeadWithWrongURL) {
     HTTPHeaders headers;
 
     string url;
     S3RESTfulService service;
 
-    url = "https://www.bing.com/pivotal.html";
+    url = this->missingUrl;
 
     ResponseCode code = service.head(url, headers);
 
     EXPECT_EQ(404, code);
 }
 
-TEST(S3RESTfulService, HeadWithCorrectURL) {
+TEST_F(S3RESTfulServiceTest, HeadWithCorrectURL) {
     HTTPHeaders headers;
 
     string url;
     S3RESTfulService service;
 
-    url = "https://www.bing.com/";
+    url = this->existingUrl;
 
     ResponseCode code = service.head(url, headers);
 
@@ -205,27 +230,27 @@ TEST(S3RESTfulService, PostWithoutURL) {
     EXPECT_THROW(service.post(url, headers, vector<uint8_t>()), S3ConnectionError);
 }
 
-TEST(S3RESTfulService, PostToServerWithBlindPutServiceAndDebugParam) {
+TEST_F(S3RESTfulServiceTest, PostToServerWithBlindPutServiceAndDebugParam) {
     HTTPHeaders headers;
 
     string url;
     S3RESTfulService service;
 
     headers.Add(CONTENTLENGTH, "3");
-    url = "https://www.bing.com/?abcdefghij";
+    url = this->existingUrl + "?uploads";
 
     Response resp = service.post(url, headers, vector<uint8_t>({1, 2, 3}));
 
     EXPECT_EQ(RESPONSE_OK, resp.getStatus());
 }
 
-TEST(S3RESTfulService, PostToServerWithBlindPutService) {
+TEST_F(S3RESTfulServiceTest, PostToServerWithBlindPutService) {
     HTTPHeaders headers;
 
     string url;
     S3RESTfulService service;
 
-    url = "https://www.bing.com/?abcdefghij";
+    url = this->existingUrl + "?uploads";
 
     headers.Add(CONTENTLENGTH, "3");
     Response resp = service.post(url, headers, vector<uint8_t>({1, 2, 3}));
@@ -233,13 +258,13 @@ TEST(S3RESTfulService, PostToServerWithBlindPutService) {
     EXPECT_EQ(RESPONSE_OK, resp.getStatus());
 }
 
-TEST(S3RESTfulService, PostToServerWith404Page) {
+TEST_F(S3RESTfulServiceTest, PostToServerWith404Page) {
     HTTPHeaders headers;
 
     string url;
     S3RESTfulService service;
 
-    url = "https://www.bing.com/pivotal.html/?abcdefghij";
+    url = this->missingUrl + "?uploadId=abcdefghij";
 
     headers.Add(CONTENTLENGTH, "3");
     Response resp = service.post(url, headers, vector<uint8_t>({1, 2, 3}));
@@ -248,13 +273,13 @@ TEST(S3RESTfulService, PostToServerWith404Page) {
     EXPECT_EQ("Server returned error, error code is 404", resp.getMessage());
 }
 
-TEST(S3RESTfulService, PostToServerWithData) {
+TEST_F(S3RESTfulServiceTest, PostToServerWithData) {
     HTTPHeaders headers;
 
     string url;
     S3RESTfulService service;
 
-    url = "https://www.bing.com";
+    url = this->existingUrl + "?uploads";
 
     /* data = "abcdefghij", length = 11 (including '\0') */
     vector<uint8_t> data;
@@ -321,20 +346,56 @@ TEST(S3RESTfulService, DISABLED_DeleteToDummyServerWithData) {
     EXPECT_EQ(RESPONSE_OK, resp.getStatus());
 }
 
-TEST(S3RESTfulService, GetWithWrongProxy) {
+TEST_F(S3RESTfulServiceTest, GetWithWrongProxy) {
     HTTPHeaders headers;
     S3RESTfulService service("https://127.0.0.1:8080");
 
-    string url = "https://www.bing.com/";
+    string url = this->existingUrl;
 
     EXPECT_THROW(service.get(url, headers), S3ConnectionError);
 }
 
-TEST(S3RESTfulService, GetWithWrongProxyUrl) {
+TEST_F(S3RESTfulServiceTest, GetWithWrongProxyUrl) {
     HTTPHeaders headers;
     S3RESTfulService service("https://xx.proxy");
 
-    string url = "https://www.bing.com/";
+    string url = this->existingUrl;
 
     EXPECT_THROW(service.get(url, headers), S3ResolveError);
-}
\ No newline at end of file
+}
+
+TEST_F(S3RESTfulServiceTest, GetWithConnectionReuse) {
+    HTTPHeaders headers;
+    S3Params params;
+    params.setMaxConnections(2);
+    params.setConnectionIdleTimeout(60);
+    S3RESTfulService service(params);
+
+    string url = this->existingUrl;
+
+    Response resp = service.get(url, headers);
+    EXPECT_EQ(RESPONSE_OK, resp.getStatus());
+    EXPECT_EQ((size_t)1, S3CurlPool::getInstance().getIdleCount(url));
+
+    resp = service.get(url, headers);
+    EXPECT_EQ(RESPONSE_OK, resp.getStatus());
+    EXPECT_EQ((size_t)1, S3CurlPool::getInstance().getIdleCount(url));
+
+    // Both requests went over the same connection
+    EXPECT_EQ((uint64_t)2, this->server.getRequestCount());
+    EXPECT_EQ((uint64_t)1, this->server.getConnectionCount());
+}
+
+TEST_F(S3RESTfulServiceTest, GetWithoutConnectionReuse) {
+    HTTPHeaders headers;
+    S3Params params;
+    S3RESTfulService service(params);
+
+    string url = this->existingUrl;
+
+    EXPECT_EQ(RESPONSE_OK, service.get(url, headers).getStatus());
+    EXPECT_EQ(RESPONSE_OK, service.get(url, headers).getStatus());
+
+    EXPECT_EQ((uint64_t)2, this->server.getRequestCount());
+    EXPECT_EQ((uint64_t)2, this->server.getConnectionCount());
+}
@@ -22,6 +22,7 @@
 #include "cdb/cdbexplain.h"		/* me */
 #include "cdb/cdbpartition.h"
 #include "cdb/cdbvars.h"		/* Gp_segment */
+#include "codegen/codegen_wrapper.h"	/* CodeGeneratorManagerGetTimes() */
 #include "executor/execUtils.h"
 #include "executor/instrument.h"	/* Instrumentation */
 #include "lib/stringinfo.h"		/* StringInfo */
@@ -100,6 +101,8 @@ typedef struct CdbExplain_StatInst
 	ExplainSortMethod sortMethod;	/* Type of sort */
 	ExplainSortSpaceType sortSpaceType; /* Sort space type */
 	long		sortSpaceUsed;	/* Memory / Disk used by sort(KBytes) */
+	double		codegenGenerateTime;	/* generating code (ms) */
+	double		codegenCompileTime; /* compiling generated code (ms) */
 	int			bnotes;			/* Offset to beginning of node's extra text */
 	int			enotes;			/* Offset to end of node's extra text */
 } CdbExplain_StatInst;
@@ -169,6 +172,9 @@ typedef struct CdbExplain_NodeSummary
 	CdbExplain_Agg totalPartTableScanned;
 	/* Summary of space used by sort */
 	CdbExplain_Agg sortSpaceUsed[NUM_SORT_SPACE_TYPE][NUM_SORT_METHOD];
+	/* Time spent on generated code (ms) */
+	CdbExplain_Agg codegenGenerateTime;
+	CdbExplain_Agg codegenCompileTime;
 
 	/* insts array info */
 	int			segindex0;		/* segment id of insts[0] */
@@ -913,6 +919,7 @@ cdbexplain_collectStatsFromNode(PlanState *planstate, CdbExplain_SendStatCtx *ct
 {
 	CdbExplain_StatInst *si = &ctx->hdr.inst[0];
 	Instrumentation *instr = planstate->instrument;
+	CodegenTimes codegenTimes = {0, 0};
 
 	Insist(instr);
 
@@ -953,6 +960,11 @@ cdbexplain_collectStatsFromNode(PlanState *planstate, CdbExplain_SendStatCtx *ct
 	si->sortMethod = String2ExplainSortMethod(instr->sortMethod);
 	si->sortSpaceType = String2ExplainSortSpaceType(instr->sortSpaceType, si->sortMethod);
 	si->sortSpaceUsed = instr->sortSpaceUsed;
+
+	/* The code generator manager of the node lives until ExecEndNode(). */
+	CodeGeneratorManagerGetTimes(planstate->CodegenManager, &codegenTimes);
+	si->codegenGenerateTime = codegenTimes.generate;
+	si->codegenCompileTime = codegenTimes.compile;
 }								/* cdbexplain_collectStatsFromNode */
 
 
@@ -1080,6 +1092,8 @@ cdbexplain_depositStatsToNode(PlanState *planstate, CdbExplain_RecvStatCtx *ctx)
 	CdbExplain_DepStatAcc peakMemBalance;
 	CdbExplain_DepStatAcc totalPartTableScanned;
 	CdbExplain_DepStatAcc sortSpaceUsed[NUM_SORT_SPACE_TYPE][NUM_SORT_METHOD];
+	CdbExplain_DepStatAcc codegenGenerateTime;
+	CdbExplain_DepStatAcc codegenCompileTime;
 	int			imsgptr;
 	int			nInst;
 
@@ -1104,6 +1118,8 @@ cdbexplain_depositStatsToNode(PlanState *planstate, CdbExplain_RecvStatCtx *ctx)
 	cdbexplain_depStatAcc_init0(&totalWorkfileCreated);
 	cdbexplain_depStatAcc_init0(&peakMemBalance);
 	cdbexplain_depStatAcc_init0(&totalPartTableScanned);
+	cdbexplain_depStatAcc_init0(&codegenGenerateTime);
+	cdbexplain_depStatAcc_init0(&codegenCompileTime);
 	for (int idx = 0; idx < NUM_SORT_METHOD; ++idx)
 	{
 		cdbexplain_depStatAcc_init0(&sortSpaceUsed[MEMORY_SORT_SPACE_TYPE - 1][idx]);
@@ -1160,6 +1176,11 @@ cdbexplain_depositStatsToNode(PlanState *planstate, CdbExplain_RecvStatCtx *ctx)
 			Assert(rsi->sortSpaceType <= NUM_SORT_SPACE_TYPE);
 			cdbexplain_depStatAcc_upd(&sortSpaceUsed[rsi->sortSpaceType - 1][rsi->sortMethod - 1], (double) rsi->sortSpaceUsed, rsh, rsi, nsi);
 		}
+		if (rsi->codegenGenerateTime > 0 || rsi->codegenCompileTime > 0)
+		{
+			cdbexplain_depStatAcc_upd(&codegenGenerateTime, rsi->codegenGenerateTime, rsh, rsi, nsi);
+			cdbexplain_depStatAcc_upd(&codegenCompileTime, rsi->codegenCompileTime, rsh, rsi, nsi);
+		}
 
 		/* Update per-slice accumulators. */
 		cdbexplain_depStatAcc_upd(&peakmemused, rsh->worker.peakmemused, rsh, rsi, nsi);
@@ -1175,6 +1196,8 @@ cdbexplain_depositStatsToNode(PlanState *planstate, CdbExplain_RecvStatCtx *ctx)
 	ns->totalWorkfileCreated = totalWorkfileCreated.agg;
 	ns->peakMemBalance = peakMemBalance.agg;
 	ns->totalPartTableScanned = totalPartTableScanned.agg;
+	ns->codegenGenerateTime = codegenGenerateTime.agg;
+	ns->codegenCompileTime = codegenCompileTime.agg;
 	for (int idx = 0; idx < NUM_SORT_METHOD; ++idx)
 	{
 		ns->sortSpaceUsed[MEMORY_SORT_SPACE_TYPE - 1][idx] = sortSpaceUsed[MEMORY_SORT_SPACE_TYPE - 1][idx].agg;
@@ -1762,6 +1785,34 @@ cdbexplain_showExecStats(struct PlanState *planstate,
 		}
 	}
 
+	/*
+	 * Time spent generating and compiling code for this node, if any.
+	 */
+	if (ns->codegenGenerateTime.vcnt > 0)
+	{
+		char		generatebuf[50];
+
+		appendStringInfoFill(str, 2 * indent, ' ');
+		cdbexplain_formatSeconds(generatebuf, sizeof(generatebuf),
+								 ns->codegenGenerateTime.vmax / 1000.0);
+		cdbexplain_formatSeconds(maxbuf, sizeof(maxbuf),
+								 ns->codegenCompileTime.vmax / 1000.0);
+		if (ns->codegenGenerateTime.vcnt == 1)
+			appendStringInfo(str,
+							 "Codegen:  generate %s, compile %s.\n",
+							 generatebuf,
+							 maxbuf);
+		else
+		{
+			cdbexplain_formatSeg(segbuf, sizeof(segbuf), ns->codegenCompileTime.imax, ns->ninst);
+			appendStringInfo(str,
+							 "Codegen:  generate %s max, compile %s max%s.\n",
+							 generatebuf,
+							 maxbuf,
+							 segbuf);
+		}
+	}
+
 	/*
 	 * What value of work_mem would suffice to eliminate workfile I/O?
 	 */
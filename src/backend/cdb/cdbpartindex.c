@@ -27,8 +27,10 @@
 #include "parser/parse_expr.h"
 #include "utils/builtins.h"
 #include "utils/fmgroids.h"
+#include "utils/inval.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
+#include "utils/syscache.h"
 
 /* initial estimate for number of logical indexes */
 #define INITIAL_NUM_LOGICAL_INDEXES_ESTIMATE 100
@@ -1552,3 +1554,423 @@ logicalIndexInfoForIndexOid(Oid rootOid, Oid indexOid)
 
 	return plogicalIndexInfo;
 }
+
+/*
+ * Cache of the logical indexes, part constraints and default levels of the
+ * partitioned tables, by root, along with their number of leaf parts and
+ * whether any part is Parquet or randomly distributed.
+ *
+ * Building any of them reads the catalog for every part of the table, which
+ * takes seconds with thousands of parts, and ORCA asks for them whenever it
+ * translates the table or any of its indexes. So each of them is built once,
+ * on demand, and kept until the root or any of its parts is invalidated, or
+ * pg_partition, pg_partition_rule or pg_constraint changes.
+ */
+typedef struct PartInfoCacheEntry
+{
+	Oid			rootOid;		/* hash key, must be first */
+	MemoryContext context;		/* holds all of the entry but itself */
+	Oid		   *relids;			/* the root and all its parts, sorted */
+	int			numRelids;
+	bool		haveLogicalIndexes;
+	LogicalIndexes *logicalIndexes;
+	bool		haveDefaultLevels;
+	List	   *defaultLevels;
+	bool		havePartConstraints;
+	Node	   *partConstraints;
+	int			numLeafParts;	/* -1 if not known yet */
+	int			hasParquetChildren;		/* -1 if not known yet */
+	int			childDistributionMismatch;	/* -1 if not known yet */
+} PartInfoCacheEntry;
+
+static HTAB *PartInfoCache = NULL;
+static MemoryContext PartInfoCacheContext = NULL;
+static bool PartInfoCacheCallbacksRegistered = false;
+
+static int
+oid_compare(const void *a, const void *b)
+{
+	Oid			oa = *((const Oid *) a);
+	Oid			ob = *((const Oid *) b);
+
+	if (oa == ob)
+		return 0;
+	return (oa > ob) ? 1 : -1;
+}
+
+static void
+resetPartInfoCache(void)
+{
+	if (PartInfoCache == NULL)
+		return;
+
+	MemoryContextDelete(PartInfoCacheContext);
+	PartInfoCacheContext = NULL;
+	PartInfoCache = NULL;
+}
+
+static void
+partInfoCacheSyscacheCallback(Datum arg, int cacheid, ItemPointer tuplePtr)
+{
+	resetPartInfoCache();
+}
+
+static void
+partInfoCacheRelcacheCallback(Datum arg, Oid relid)
+{
+	HASH_SEQ_STATUS status;
+	PartInfoCacheEntry *entry;
+
+	if (PartInfoCache == NULL)
+		return;
+
+	/* InvalidOid means all relations */
+	if (!OidIsValid(relid))
+	{
+		resetPartInfoCache();
+		return;
+	}
+
+	hash_seq_init(&status, PartInfoCache);
+	while ((entry = (PartInfoCacheEntry *) hash_seq_search(&status)) != NULL)
+	{
+		if (bsearch(&relid, entry->relids, entry->numRelids, sizeof(Oid),
+					oid_compare) != NULL)
+		{
+			MemoryContextDelete(entry->context);
+			hash_search(PartInfoCache, &entry->rootOid, HASH_REMOVE, NULL);
+		}
+	}
+}
+
+/*
+ * Return the cache entry of a partitioned table, creating it if needed.
+ */
+static PartInfoCacheEntry *
+getPartInfoCacheEntry(Oid rootOid)
+{
+	PartInfoCacheEntry *entry;
+	List	   *relids;
+	ListCell   *lc;
+	bool		found;
+	int			i;
+
+	if (!PartInfoCacheCallbacksRegistered)
+	{
+		CacheRegisterSyscacheCallback(PARTOID, partInfoCacheSyscacheCallback, (Datum) 0);
+		CacheRegisterSyscacheCallback(PARTRULEOID, partInfoCacheSyscacheCallback, (Datum) 0);
+		CacheRegisterSyscacheCallback(CONSTROID, partInfoCacheSyscacheCallback, (Datum) 0);
+		CacheRegisterRelcacheCallback(partInfoCacheRelcacheCallback, (Datum) 0);
+		PartInfoCacheCallbacksRegistered = true;
+	}
+
+	if (PartInfoCache == NULL)
+	{
+		HASHCTL		ctl;
+
+		PartInfoCacheContext = AllocSetContextCreate(CacheMemoryContext,
+													 "Partition info cache",
+													 ALLOCSET_DEFAULT_MINSIZE,
+													 ALLOCSET_DEFAULT_INITSIZE,
+													 ALLOCSET_DEFAULT_MAXSIZE);
+
+		MemSet(&ctl, 0, sizeof(ctl));
+		ctl.keysize = sizeof(Oid);
+		ctl.entrysize = sizeof(PartInfoCacheEntry);
+		ctl.hash = oid_hash;
+		ctl.hcxt = PartInfoCacheContext;
+		PartInfoCache = hash_create("Partition info cache", 16, &ctl,
+									HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+	}
+
+	entry = (PartInfoCacheEntry *) hash_search(PartInfoCache, &rootOid,
+											   HASH_FIND, NULL);
+	if (entry)
+		return entry;
+
+	/*
+	 * Collect the parts before entering the entry, as reading the catalog
+	 * may process invalidations, which could reset the cache.
+	 */
+	relids = find_all_inheritors(rootOid);
+
+	if (PartInfoCache == NULL)
+	{
+		list_free(relids);
+		return getPartInfoCacheEntry(rootOid);
+	}
+
+	entry = (PartInfoCacheEntry *) hash_search(PartInfoCache, &rootOid,
+											   HASH_ENTER, &found);
+	Assert(!found);
+
+	entry->context = AllocSetContextCreate(PartInfoCacheContext,
+										   "Partition info cache entry",
+										   ALLOCSET_SMALL_MINSIZE,
+										   ALLOCSET_SMALL_INITSIZE,
+										   ALLOCSET_DEFAULT_MAXSIZE);
+	entry->numRelids = list_length(relids);
+	entry->relids = (Oid *) MemoryContextAlloc(entry->context,
+											   Max(entry->numRelids, 1) * sizeof(Oid));
+	i = 0;
+	foreach(lc, relids)
+		entry->relids[i++] = lfirst_oid(lc);
+	qsort(entry->relids, entry->numRelids, sizeof(Oid), oid_compare);
+	list_free(relids);
+
+	entry->haveLogicalIndexes = false;
+	entry->logicalIndexes = NULL;
+	entry->haveDefaultLevels = false;
+	entry->defaultLevels = NIL;
+	entry->havePartConstraints = false;
+	entry->partConstraints = NULL;
+	entry->numLeafParts = -1;
+	entry->hasParquetChildren = -1;
+	entry->childDistributionMismatch = -1;
+
+	return entry;
+}
+
+/*
+ * Return the entry of a partitioned table, to remember something computed
+ * from the catalog, or NULL if the cache has been reset in the meantime.
+ */
+static PartInfoCacheEntry *
+findPartInfoCacheEntry(Oid rootOid)
+{
+	if (PartInfoCache == NULL)
+		return NULL;
+
+	return (PartInfoCacheEntry *) hash_search(PartInfoCache, &rootOid,
+											  HASH_FIND, NULL);
+}
+
+/*
+ * Copy logical indexes into the current memory context.
+ */
+static LogicalIndexes *
+copyLogicalIndexes(LogicalIndexes *from)
+{
+	LogicalIndexes *li;
+
+	if (from == NULL)
+		return NULL;
+
+	li = (LogicalIndexes *) palloc0(sizeof(LogicalIndexes));
+	li->numLogicalIndexes = from->numLogicalIndexes;
+	li->logicalIndexInfo = (LogicalIndexInfo **)
+		palloc0(Max(from->numLogicalIndexes, 1) * sizeof(LogicalIndexInfo *));
+
+	for (int i = 0; i < from->numLogicalIndexes; i++)
+	{
+		LogicalIndexInfo *src = from->logicalIndexInfo[i];
+		LogicalIndexInfo *dst = (LogicalIndexInfo *) palloc(sizeof(LogicalIndexInfo));
+
+		memcpy(dst, src, sizeof(LogicalIndexInfo));
+		dst->indexKeys = (AttrNumber *) palloc(Max(src->nColumns, 1) * sizeof(AttrNumber));
+		memcpy(dst->indexKeys, src->indexKeys, src->nColumns * sizeof(AttrNumber));
+		dst->indPred = (List *) copyObject(src->indPred);
+		dst->indExprs = (List *) copyObject(src->indExprs);
+		dst->partCons = (Node *) copyObject(src->partCons);
+		dst->defaultLevels = (List *) copyObject(src->defaultLevels);
+		li->logicalIndexInfo[i] = dst;
+	}
+
+	return li;
+}
+
+/*
+ * GetLogicalIndexInfo
+ *   Same as BuildLogicalIndexInfo, but cached by root.
+ *
+ *   Memory for result is allocated from caller context.
+ */
+LogicalIndexes *
+GetLogicalIndexInfo(Oid rootOid)
+{
+	PartInfoCacheEntry *entry = getPartInfoCacheEntry(rootOid);
+
+	if (!entry->haveLogicalIndexes)
+	{
+		LogicalIndexes *li = BuildLogicalIndexInfo(rootOid);
+		MemoryContext oldcontext;
+
+		/* the entry is gone if the catalog has changed in the meantime */
+		entry = findPartInfoCacheEntry(rootOid);
+		if (entry == NULL)
+			return li;
+
+		oldcontext = MemoryContextSwitchTo(entry->context);
+		entry->logicalIndexes = copyLogicalIndexes(li);
+		entry->haveLogicalIndexes = true;
+		MemoryContextSwitchTo(oldcontext);
+
+		return li;
+	}
+
+	return copyLogicalIndexes(entry->logicalIndexes);
+}
+
+/*
+ * get_relation_part_default_levels
+ *  return the levels at which a partitioned table has default parts, given
+ *  the oid of the root.
+ *
+ *  Same as the default levels returned by get_relation_part_constraints, but
+ *  without looking up the constraints of the parts, and cached by root.
+ */
+List *
+get_relation_part_default_levels(Oid rootOid)
+{
+	PartInfoCacheEntry *entry;
+	List	   *partkeys;
+	List	   *defaultLevels = NIL;
+	MemoryContext oldcontext;
+	int			nLevels;
+
+	if (!rel_is_partitioned(rootOid))
+		return NIL;
+
+	entry = getPartInfoCacheEntry(rootOid);
+	if (entry->haveDefaultLevels)
+		return list_copy(entry->defaultLevels);
+
+	partkeys = rel_partition_keys_ordered(rootOid);
+	nLevels = list_length(partkeys);
+	list_free(partkeys);
+
+	for (int level = 0; level < nLevels; level++)
+	{
+		PartitionNode *pn = get_parts(rootOid, level, 0 /* parent */ , false /* inctemplate */ , false /* includesubparts */ );
+
+		if (pn && pn->default_part)
+			defaultLevels = lappend_int(defaultLevels, level);
+	}
+
+	entry = findPartInfoCacheEntry(rootOid);
+	if (entry)
+	{
+		oldcontext = MemoryContextSwitchTo(entry->context);
+		entry->defaultLevels = list_copy(defaultLevels);
+		entry->haveDefaultLevels = true;
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	return defaultLevels;
+}
+
+/*
+ * get_relation_part_constraints_cached
+ *  Same as get_relation_part_constraints, but cached by root.
+ *
+ *  Memory for result is allocated from caller context.
+ */
+Node *
+get_relation_part_constraints_cached(Oid rootOid, List **defaultLevels)
+{
+	PartInfoCacheEntry *entry;
+	Node	   *partCons;
+	MemoryContext oldcontext;
+
+	if (!rel_is_partitioned(rootOid))
+		return NULL;
+
+	entry = getPartInfoCacheEntry(rootOid);
+	if (entry->havePartConstraints)
+	{
+		*defaultLevels = list_concat(*defaultLevels, list_copy(entry->defaultLevels));
+		return (Node *) copyObject(entry->partConstraints);
+	}
+
+	partCons = get_relation_part_constraints(rootOid, defaultLevels);
+
+	entry = findPartInfoCacheEntry(rootOid);
+	if (entry)
+	{
+		oldcontext = MemoryContextSwitchTo(entry->context);
+		entry->partConstraints = (Node *) copyObject(partCons);
+		if (!entry->haveDefaultLevels)
+		{
+			entry->defaultLevels = list_copy(*defaultLevels);
+			entry->haveDefaultLevels = true;
+		}
+		entry->havePartConstraints = true;
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	return partCons;
+}
+
+/*
+ * countLeafPartTables_cached
+ *  Same as countLeafPartTables, but cached by root.
+ */
+int
+countLeafPartTables_cached(Oid rootOid)
+{
+	PartInfoCacheEntry *entry = getPartInfoCacheEntry(rootOid);
+	int			count;
+
+	if (entry->numLeafParts >= 0)
+		return entry->numLeafParts;
+
+	count = countLeafPartTables(rootOid);
+
+	entry = findPartInfoCacheEntry(rootOid);
+	if (entry)
+		entry->numLeafParts = count;
+
+	return count;
+}
+
+/*
+ * has_parquet_children_cached
+ *  Same as has_parquet_children, but cached by root.
+ */
+bool
+has_parquet_children_cached(Oid rootOid)
+{
+	PartInfoCacheEntry *entry;
+	bool		result;
+
+	if (!rel_is_partitioned(rootOid))
+		return has_parquet_children(rootOid);
+
+	entry = getPartInfoCacheEntry(rootOid);
+	if (entry->hasParquetChildren >= 0)
+		return entry->hasParquetChildren;
+
+	result = has_parquet_children(rootOid);
+
+	entry = findPartInfoCacheEntry(rootOid);
+	if (entry)
+		entry->hasParquetChildren = result;
+
+	return result;
+}
+
+/*
+ * child_distribution_mismatch_cached
+ *  Same as child_distribution_mismatch, but cached by root.
+ */
+bool
+child_distribution_mismatch_cached(Relation rel)
+{
+	PartInfoCacheEntry *entry;
+	bool		result;
+
+	if (!rel_is_partitioned(RelationGetRelid(rel)))
+		return child_distribution_mismatch(rel);
+
+	entry = getPartInfoCacheEntry(RelationGetRelid(rel));
+	if (entry->childDistributionMismatch >= 0)
+		return entry->childDistributionMismatch;
+
+	result = child_distribution_mismatch(rel);
+
+	entry = findPartInfoCacheEntry(RelationGetRelid(rel));
+	if (entry)
+		entry->childDistributionMismatch = result;
+
+	return result;
+}
@@ -0,0 +1,617 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    advance_aggregates_batch_codegen.cc
+//
+//  @doc:
+//    Generates code for AdvanceAggregatesBatch function.
+//
+//---------------------------------------------------------------------------
+#include <assert.h>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "codegen/advance_aggregates_batch_codegen.h"
+#include "codegen/utils/gp_codegen_utils.h"
+#include "codegen/utils/utility.h"
+
+#include "llvm/IR/IRBuilder.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "executor/nodeAgg.h"
+#include "fmgr.h"
+#include "nodes/execnodes.h"
+#include "utils/elog.h"
+#include "utils/fmgroids.h"
+#include "utils/numeric.h"
+}
+
+using gpcodegen::AdvanceAggregatesBatchCodegen;
+
+constexpr char AdvanceAggregatesBatchCodegen::kAdvanceAggregatesBatchPrefix[];
+
+AdvanceAggregatesBatchCodegen::AdvanceAggregatesBatchCodegen(
+    CodegenManager* manager,
+    AdvanceAggregatesBatchFn regular_func_ptr,
+    AdvanceAggregatesBatchFn* ptr_to_regular_func_ptr,
+    AggState *aggstate)
+: BaseCodegen(manager,
+              kAdvanceAggregatesBatchPrefix,
+              regular_func_ptr,
+              ptr_to_regular_func_ptr),
+              aggstate_(aggstate) {
+}
+
+bool AdvanceAggregatesBatchCodegen::IsSupportedAggregate(
+    struct AggStatePerAggData* peraggstate) {
+  Oid transfn_oid = peraggstate->transfn.fn_oid;
+
+  if (nullptr == peraggstate->aggref || peraggstate->numSortCols > 0) {
+    elog(DEBUG1, "We don't codegen DISTINCT, ORDER BY and percentile "
+         "aggregates in batches");
+    return false;
+  }
+
+  bool is_avg = false;
+  switch (transfn_oid) {
+    case F_INT8INC:
+    case F_INT8INC_ANY:
+    case F_INT4_SUM:
+    case F_INT4LARGER:
+    case F_INT4SMALLER:
+    case F_INT8LARGER:
+    case F_INT8SMALLER:
+      break;
+    case F_INT4_AVG_ACCUM:
+    case F_FLOAT8_AVG_ACCUM:
+      is_avg = true;
+      break;
+    default:
+      elog(DEBUG1, "We don't codegen batches of transition function "
+           "with oid = %d", transfn_oid);
+      return false;
+  }
+
+  // Apart from avg's IntFloatAvgTransdata, the transition values we handle
+  // are int8 or int4 Datums.
+  if (!is_avg && !peraggstate->transtypeByVal) {
+    elog(DEBUG1, "We don't codegen batches of aggregate with "
+         "pass-by-reference transition type %d", transfn_oid);
+    return false;
+  }
+  int expected_nargs = (F_INT8INC == transfn_oid) ? 0 : 1;
+  if (peraggstate->numArguments != expected_nargs) {
+    elog(DEBUG1, "Unexpected number of arguments for transition function "
+         "with oid = %d", transfn_oid);
+    return false;
+  }
+  return true;
+}
+
+void AdvanceAggregatesBatchCodegen::GenerateRegularAdvanceAggregate(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    int aggno,
+    llvm::Value* llvm_pergroupstate,
+    llvm::Value* llvm_values,
+    llvm::Value* llvm_isnull,
+    llvm::Value* llvm_nrows) {
+  auto irb = codegen_utils->ir_builder();
+  llvm::Function* llvm_advance_aggregate_batch =
+      codegen_utils->GetOrRegisterExternalFunction(advance_aggregate_batch,
+                                                   "advance_aggregate_batch");
+  irb->CreateCall(llvm_advance_aggregate_batch, {
+      codegen_utils->GetConstant(aggstate_),
+      codegen_utils->GetConstant<int>(aggno),
+      llvm_pergroupstate,
+      llvm_values,
+      llvm_isnull,
+      irb->CreateTrunc(llvm_nrows, codegen_utils->GetType<int>())});
+}
+
+void AdvanceAggregatesBatchCodegen::GenerateColumnLoop(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    llvm::Value* llvm_values,
+    llvm::Value* llvm_isnull,
+    llvm::Value* llvm_nrows,
+    const LoopBodyFn& body,
+    std::vector<llvm::Value*>* llvm_accs) {
+  assert(nullptr != llvm_accs);
+  auto irb = codegen_utils->ir_builder();
+  llvm::BasicBlock* preheader_block = irb->GetInsertBlock();
+  llvm::Function* func = preheader_block->getParent();
+
+  llvm::BasicBlock* loop_header_block = codegen_utils->CreateBasicBlock(
+      "column_loop_header_block", func);
+  llvm::BasicBlock* loop_body_block = codegen_utils->CreateBasicBlock(
+      "column_loop_body_block", func);
+  llvm::BasicBlock* loop_exit_block = codegen_utils->CreateBasicBlock(
+      "column_loop_exit_block", func);
+
+  irb->CreateBr(loop_header_block);
+
+  // loop_header_block
+  // -----------------
+  // for (row = 0; row < nrows; row++)
+  irb->SetInsertPoint(loop_header_block);
+  llvm::PHINode* llvm_row = irb->CreatePHI(
+      codegen_utils->GetType<int64_t>(), 2);
+  llvm_row->addIncoming(codegen_utils->GetConstant<int64_t>(0),
+                        preheader_block);
+  std::vector<llvm::PHINode*> llvm_acc_phis;
+  for (llvm::Value* llvm_acc : *llvm_accs) {
+    llvm::PHINode* llvm_acc_phi = irb->CreatePHI(llvm_acc->getType(), 2);
+    llvm_acc_phi->addIncoming(llvm_acc, preheader_block);
+    llvm_acc_phis.push_back(llvm_acc_phi);
+  }
+  irb->CreateCondBr(irb->CreateICmpSLT(llvm_row, llvm_nrows),
+                    loop_body_block /* true */,
+                    loop_exit_block /* false */);
+
+  // loop_body_block
+  // ---------------
+  // Fold values[row] and isnull[row] into the accumulators.
+  irb->SetInsertPoint(loop_body_block);
+  llvm::Value* llvm_value = irb->CreateLoad(irb->CreateInBoundsGEP(
+      codegen_utils->GetType<Datum>(), llvm_values, llvm_row));
+  llvm::Value* llvm_value_isnull = irb->CreateLoad(irb->CreateInBoundsGEP(
+      codegen_utils->GetType<bool>(), llvm_isnull, llvm_row));
+  std::vector<llvm::Value*> llvm_next_accs(llvm_acc_phis.begin(),
+                                           llvm_acc_phis.end());
+  body(llvm_value, llvm_value_isnull, &llvm_next_accs);
+  assert(llvm_next_accs.size() == llvm_acc_phis.size());
+  llvm::Value* llvm_next_row = irb->CreateNSWAdd(
+      llvm_row, codegen_utils->GetConstant<int64_t>(1));
+  llvm::BasicBlock* loop_latch_block = irb->GetInsertBlock();
+  llvm_row->addIncoming(llvm_next_row, loop_latch_block);
+  for (std::size_t i = 0; i < llvm_acc_phis.size(); ++i) {
+    llvm_acc_phis[i]->addIncoming(llvm_next_accs[i], loop_latch_block);
+  }
+  irb->CreateBr(loop_header_block);
+
+  // loop_exit_block
+  // ---------------
+  irb->SetInsertPoint(loop_exit_block);
+  llvm_accs->assign(llvm_acc_phis.begin(), llvm_acc_phis.end());
+}
+
+bool AdvanceAggregatesBatchCodegen::GenerateAdvanceAggregate(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    int aggno,
+    llvm::Value* llvm_pergroupstate,
+    llvm::Value* llvm_values,
+    llvm::Value* llvm_isnull,
+    llvm::Value* llvm_nrows,
+    llvm::BasicBlock* overflow_block) {
+  auto irb = codegen_utils->ir_builder();
+  llvm::Function* func = irb->GetInsertBlock()->getParent();
+  AggStatePerAgg peraggstate = &aggstate_->peragg[aggno];
+  Oid transfn_oid = peraggstate->transfn.fn_oid;
+
+  // The other aggregates are advanced by the regular code, so that they
+  // don't keep the supported ones from being generated.
+  if (!IsSupportedAggregate(peraggstate)) {
+    GenerateRegularAdvanceAggregate(codegen_utils, aggno, llvm_pergroupstate,
+                                    llvm_values, llvm_isnull, llvm_nrows);
+    return true;
+  }
+
+  // External functions
+  llvm::Function* llvm_pg_detoast_datum =
+      codegen_utils->GetOrRegisterExternalFunction(pg_detoast_datum,
+                                                   "pg_detoast_datum");
+  llvm::Function* llvm_varsize =
+      codegen_utils->GetOrRegisterExternalFunction(VARSIZE_regular,
+                                                   "VARSIZE_regular");
+
+  llvm::Value* llvm_transValue_ptr = codegen_utils->GetPointerToMember(
+      llvm_pergroupstate, &AggStatePerGroupData::transValue);
+  llvm::Value* llvm_transValueIsNull_ptr = codegen_utils->GetPointerToMember(
+      llvm_pergroupstate, &AggStatePerGroupData::transValueIsNull);
+  llvm::Value* llvm_noTransValue_ptr = codegen_utils->GetPointerToMember(
+      llvm_pergroupstate, &AggStatePerGroupData::noTransValue);
+
+  // Block that every case below ends up in.
+  llvm::BasicBlock* advance_aggregate_done_block =
+      codegen_utils->CreateBasicBlock(
+          "advance_aggregate_done_block_aggno_" + std::to_string(aggno),
+          func);
+  llvm::BasicBlock* update_block = codegen_utils->CreateBasicBlock(
+      "update_block_aggno_" + std::to_string(aggno), func);
+  llvm::BasicBlock* store_block = codegen_utils->CreateBasicBlock(
+      "store_block_aggno_" + std::to_string(aggno), func);
+
+  llvm::Value* llvm_false = codegen_utils->GetConstant<bool>(false);
+
+  switch (transfn_oid) {
+    case F_INT8INC:
+    case F_INT8INC_ANY: {
+      // count is strict with an initial value of 0, so the transition value
+      // is NULL only if it has been NULL all along.
+      irb->CreateCondBr(irb->CreateLoad(llvm_transValueIsNull_ptr),
+                        advance_aggregate_done_block /* true */,
+                        update_block /* false */);
+
+      // update_block
+      // ------------
+      // count(*) counts every row; count(any) the rows with non-NULL input.
+      irb->SetInsertPoint(update_block);
+      llvm::Value* llvm_count = llvm_nrows;
+      if (F_INT8INC_ANY == transfn_oid) {
+        std::vector<llvm::Value*> llvm_accs = {
+            codegen_utils->GetConstant<int64_t>(0)};
+        GenerateColumnLoop(
+            codegen_utils, llvm_values, llvm_isnull, llvm_nrows,
+            [codegen_utils, irb](llvm::Value* llvm_value,
+                                 llvm::Value* llvm_value_isnull,
+                                 std::vector<llvm::Value*>* llvm_accs) {
+              (*llvm_accs)[0] = irb->CreateAdd(
+                  (*llvm_accs)[0],
+                  irb->CreateZExt(irb->CreateNot(llvm_value_isnull),
+                                  codegen_utils->GetType<int64_t>()));
+            },
+            &llvm_accs);
+        llvm_count = llvm_accs[0];
+      }
+      llvm::Value* llvm_add_output =
+          codegen_utils->CreateAddOverflow<int64_t>(
+              irb->CreateLoad(llvm_transValue_ptr), llvm_count);
+      irb->CreateCondBr(irb->CreateExtractValue(llvm_add_output, 1),
+                        overflow_block /* true */,
+                        store_block /* false */);
+
+      // store_block
+      // -----------
+      irb->SetInsertPoint(store_block);
+      irb->CreateStore(irb->CreateExtractValue(llvm_add_output, 0),
+                       llvm_transValue_ptr);
+      irb->CreateBr(advance_aggregate_done_block);
+      break;
+    }
+    case F_INT4_SUM: {
+      // int4_sum is not strict: the first non-NULL input replaces a NULL
+      // transition value, NULL inputs leave it unchanged. Like int4_sum, we
+      // don't check the int8 sum for overflow.
+      irb->CreateBr(update_block);
+
+      // update_block
+      // ------------
+      irb->SetInsertPoint(update_block);
+      std::vector<llvm::Value*> llvm_accs = {
+          codegen_utils->GetConstant<int64_t>(0),  // sum
+          codegen_utils->GetConstant<bool>(false)};  // seen non-NULL input
+      GenerateColumnLoop(
+          codegen_utils, llvm_values, llvm_isnull, llvm_nrows,
+          [codegen_utils, irb](llvm::Value* llvm_value,
+                               llvm::Value* llvm_value_isnull,
+                               std::vector<llvm::Value*>* llvm_accs) {
+            llvm::Value* llvm_addend = irb->CreateSelect(
+                llvm_value_isnull,
+                codegen_utils->GetConstant<int64_t>(0),
+                irb->CreateSExt(
+                    codegen_utils->CreateDatumToCppTypeCast<int32_t>(
+                        llvm_value),
+                    codegen_utils->GetType<int64_t>()));
+            (*llvm_accs)[0] = irb->CreateAdd((*llvm_accs)[0], llvm_addend);
+            (*llvm_accs)[1] = irb->CreateOr(
+                (*llvm_accs)[1], irb->CreateNot(llvm_value_isnull));
+          },
+          &llvm_accs);
+      irb->CreateCondBr(llvm_accs[1],
+                        store_block /* true */,
+                        advance_aggregate_done_block /* false */);
+
+      // store_block
+      // -----------
+      // transValue = (transValueIsNull ? 0 : transValue) + sum
+      irb->SetInsertPoint(store_block);
+      llvm::Value* llvm_base = irb->CreateSelect(
+          irb->CreateLoad(llvm_transValueIsNull_ptr),
+          codegen_utils->GetConstant<int64_t>(0),
+          irb->CreateLoad(llvm_transValue_ptr));
+      irb->CreateStore(irb->CreateAdd(llvm_base, llvm_accs[0]),
+                       llvm_transValue_ptr);
+      irb->CreateStore(llvm_false, llvm_transValueIsNull_ptr);
+      irb->CreateStore(llvm_false, llvm_noTransValue_ptr);
+      irb->CreateBr(advance_aggregate_done_block);
+      break;
+    }
+    case F_INT4LARGER:
+    case F_INT4SMALLER:
+    case F_INT8LARGER:
+    case F_INT8SMALLER: {
+      bool is_int8 = (F_INT8LARGER == transfn_oid ||
+                      F_INT8SMALLER == transfn_oid);
+      bool is_larger = (F_INT4LARGER == transfn_oid ||
+                        F_INT8LARGER == transfn_oid);
+      llvm::CmpInst::Predicate pred =
+          is_larger ? llvm::CmpInst::ICMP_SGT : llvm::CmpInst::ICMP_SLT;
+      // The value that any input replaces, used while there is no
+      // transition value yet.
+      llvm::Value* llvm_identity = nullptr;
+      if (is_int8) {
+        llvm_identity = codegen_utils->GetConstant<int64_t>(
+            is_larger ? std::numeric_limits<int64_t>::min() :
+                std::numeric_limits<int64_t>::max());
+      } else {
+        llvm_identity = codegen_utils->GetConstant<int32_t>(
+            is_larger ? std::numeric_limits<int32_t>::min() :
+                std::numeric_limits<int32_t>::max());
+      }
+
+      // These are strict: the first non-NULL input becomes the transition
+      // value, and a NULL transition value after that stays NULL.
+      llvm::Value* llvm_noTransValue = irb->CreateLoad(llvm_noTransValue_ptr);
+      irb->CreateCondBr(
+          irb->CreateAnd(irb->CreateNot(llvm_noTransValue),
+                         irb->CreateLoad(llvm_transValueIsNull_ptr)),
+          advance_aggregate_done_block /* true */,
+          update_block /* false */);
+
+      // update_block
+      // ------------
+      irb->SetInsertPoint(update_block);
+      llvm::Value* llvm_transValue = irb->CreateLoad(llvm_transValue_ptr);
+      llvm_transValue = is_int8 ?
+          codegen_utils->CreateDatumToCppTypeCast<int64_t>(llvm_transValue) :
+          codegen_utils->CreateDatumToCppTypeCast<int32_t>(llvm_transValue);
+      std::vector<llvm::Value*> llvm_accs = {
+          irb->CreateSelect(llvm_noTransValue, llvm_identity, llvm_transValue),
+          codegen_utils->GetConstant<bool>(false)};  // seen non-NULL input
+      GenerateColumnLoop(
+          codegen_utils, llvm_values, llvm_isnull, llvm_nrows,
+          [codegen_utils, irb, is_int8, pred](
+              llvm::Value* llvm_value,
+              llvm::Value* llvm_value_isnull,
+              std::vector<llvm::Value*>* llvm_accs) {
+            llvm::Value* llvm_input = is_int8 ?
+                codegen_utils->CreateDatumToCppTypeCast<int64_t>(llvm_value) :
+                codegen_utils->CreateDatumToCppTypeCast<int32_t>(llvm_value);
+            llvm::Value* llvm_replace = irb->CreateAnd(
+                irb->CreateNot(llvm_value_isnull),
+                irb->CreateICmp(pred, llvm_input, (*llvm_accs)[0]));
+            (*llvm_accs)[0] = irb->CreateSelect(llvm_replace, llvm_input,
+                                                (*llvm_accs)[0]);
+            (*llvm_accs)[1] = irb->CreateOr(
+                (*llvm_accs)[1], irb->CreateNot(llvm_value_isnull));
+          },
+          &llvm_accs);
+      irb->CreateCondBr(llvm_accs[1],
+                        store_block /* true */,
+                        advance_aggregate_done_block /* false */);
+
+      // store_block
+      // -----------
+      irb->SetInsertPoint(store_block);
+      irb->CreateStore(codegen_utils->CreateCppTypeToDatumCast(llvm_accs[0]),
+                       llvm_transValue_ptr);
+      irb->CreateStore(llvm_false, llvm_transValueIsNull_ptr);
+      irb->CreateStore(llvm_false, llvm_noTransValue_ptr);
+      irb->CreateBr(advance_aggregate_done_block);
+      break;
+    }
+    case F_INT4_AVG_ACCUM:
+    case F_FLOAT8_AVG_ACCUM: {
+      bool is_int4 = (F_INT4_AVG_ACCUM == transfn_oid);
+      llvm::BasicBlock* check_transdata_block =
+          codegen_utils->CreateBasicBlock(
+              "check_transdata_block_aggno_" + std::to_string(aggno), func);
+      llvm::BasicBlock* regular_block = codegen_utils->CreateBasicBlock(
+          "regular_block_aggno_" + std::to_string(aggno), func);
+
+      // The avg transition functions are strict.
+      irb->CreateCondBr(irb->CreateLoad(llvm_transValueIsNull_ptr),
+                        advance_aggregate_done_block /* true */,
+                        check_transdata_block /* false */);
+
+      // check_transdata_block
+      // ---------------------
+      // The transition function updates the IntFloatAvgTransdata in place
+      // once it exists. Until then (i.e. for the first input of the group),
+      // the initial empty bytea has to be replaced, which we leave to the
+      // regular code.
+      irb->SetInsertPoint(check_transdata_block);
+      llvm::Value* llvm_transdata_ptr =
+          codegen_utils->CreateDatumToCppTypeCast<void*>(
+              irb->CreateLoad(llvm_transValue_ptr));
+      llvm::Value* llvm_detoasted_ptr = irb->CreateCall(
+          llvm_pg_detoast_datum, {llvm_transdata_ptr});
+      llvm::Value* llvm_in_place = irb->CreateAnd(
+          irb->CreateICmpEQ(llvm_detoasted_ptr, llvm_transdata_ptr),
+          irb->CreateICmpEQ(
+              irb->CreateCall(llvm_varsize, {llvm_detoasted_ptr}),
+              codegen_utils->GetConstant<uint32>(
+                  sizeof(IntFloatAvgTransdata))));
+      irb->CreateCondBr(llvm_in_place,
+                        update_block /* true */,
+                        regular_block /* false */);
+
+      // regular_block
+      // -------------
+      irb->SetInsertPoint(regular_block);
+      GenerateRegularAdvanceAggregate(codegen_utils, aggno, llvm_pergroupstate,
+                                      llvm_values, llvm_isnull, llvm_nrows);
+      irb->CreateBr(advance_aggregate_done_block);
+
+      // update_block
+      // ------------
+      // transdata->count += count; transdata->sum += ... in input order, so
+      // that the float8 sum comes out exactly as with the regular code.
+      irb->SetInsertPoint(update_block);
+      llvm::Value* llvm_sum_ptr = codegen_utils->GetPointerToMember(
+          llvm_transdata_ptr, &IntFloatAvgTransdata::sum);
+      llvm::Value* llvm_count_ptr = codegen_utils->GetPointerToMember(
+          llvm_transdata_ptr, &IntFloatAvgTransdata::count);
+      std::vector<llvm::Value*> llvm_accs = {
+          irb->CreateLoad(llvm_sum_ptr),
+          irb->CreateLoad(llvm_count_ptr)};
+      GenerateColumnLoop(
+          codegen_utils, llvm_values, llvm_isnull, llvm_nrows,
+          [codegen_utils, irb, is_int4](
+              llvm::Value* llvm_value,
+              llvm::Value* llvm_value_isnull,
+              std::vector<llvm::Value*>* llvm_accs) {
+            llvm::Value* llvm_input = is_int4 ?
+                irb->CreateSIToFP(
+                    codegen_utils->CreateDatumToCppTypeCast<int32_t>(
+                        llvm_value),
+                    codegen_utils->GetType<float8>()) :
+                codegen_utils->CreateDatumToCppTypeCast<float8>(llvm_value);
+            (*llvm_accs)[0] = irb->CreateSelect(
+                llvm_value_isnull,
+                (*llvm_accs)[0],
+                irb->CreateFAdd((*llvm_accs)[0], llvm_input));
+            (*llvm_accs)[1] = irb->CreateAdd(
+                (*llvm_accs)[1],
+                irb->CreateZExt(irb->CreateNot(llvm_value_isnull),
+                                codegen_utils->GetType<int64>()));
+          },
+          &llvm_accs);
+      irb->CreateBr(store_block);
+
+      // store_block
+      // -----------
+      irb->SetInsertPoint(store_block);
+      irb->CreateStore(llvm_accs[0], llvm_sum_ptr);
+      irb->CreateStore(llvm_accs[1], llvm_count_ptr);
+      irb->CreateBr(advance_aggregate_done_block);
+      break;
+    }
+    default:
+      assert(false && "IsSupportedAggregate() let an unknown one through");
+      return false;
+  }
+
+  irb->SetInsertPoint(advance_aggregate_done_block);
+  return true;
+}
+
+bool AdvanceAggregatesBatchCodegen::GenerateAdvanceAggregatesBatch(
+    gpcodegen::GpCodegenUtils* codegen_utils) {
+  assert(nullptr != codegen_utils);
+  if (nullptr == aggstate_ || nullptr == aggstate_->inputbatch) {
+    return false;
+  }
+
+  // A function calling the regular code for every aggregate would be no
+  // faster than the regular advance_aggregates_batch.
+  bool has_supported_aggregate = false;
+  for (int aggno = 0; aggno < aggstate_->numaggs; aggno++) {
+    has_supported_aggregate |= IsSupportedAggregate(&aggstate_->peragg[aggno]);
+  }
+  if (!has_supported_aggregate) {
+    return false;
+  }
+
+  auto irb = codegen_utils->ir_builder();
+
+  llvm::Function* advance_aggregates_batch_func =
+      CreateFunction<AdvanceAggregatesBatchFn>(
+          codegen_utils, GetUniqueFuncName());
+
+  // BasicBlock of function entry.
+  llvm::BasicBlock* entry_block = codegen_utils->CreateBasicBlock(
+      "entry_block", advance_aggregates_batch_func);
+  llvm::BasicBlock* implementation_block = codegen_utils->CreateBasicBlock(
+      "implementation_block", advance_aggregates_batch_func);
+  llvm::BasicBlock* error_aggstate_block = codegen_utils->CreateBasicBlock(
+      "error_aggstate_block", advance_aggregates_batch_func);
+  llvm::BasicBlock* overflow_block = codegen_utils->CreateBasicBlock(
+      "overflow_block", advance_aggregates_batch_func);
+
+  // Function arguments to advance_aggregates_batch
+  llvm::Value* llvm_aggstate_arg = ArgumentByPosition(
+      advance_aggregates_batch_func, 0);
+  llvm::Value* llvm_pergroup_arg = ArgumentByPosition(
+      advance_aggregates_batch_func, 1);
+  llvm::Value* llvm_values_arg = ArgumentByPosition(
+      advance_aggregates_batch_func, 2);
+  llvm::Value* llvm_isnull_arg = ArgumentByPosition(
+      advance_aggregates_batch_func, 3);
+  llvm::Value* llvm_nrows_arg = ArgumentByPosition(
+      advance_aggregates_batch_func, 4);
+
+  // Generation-time constants
+  llvm::Value* llvm_aggstate = codegen_utils->GetConstant(aggstate_);
+
+  // entry block
+  // ----------
+  irb->SetInsertPoint(entry_block);
+
+#ifdef CODEGEN_DEBUG
+  EXPAND_CREATE_ELOG(codegen_utils, DEBUG1,
+                     "Codegen'ed advance_aggregates_batch called!");
+#endif
+
+  // Compare aggstate given during code generation and the one passed
+  // in as an argument to advance_aggregates_batch
+  irb->CreateCondBr(
+      irb->CreateICmpEQ(llvm_aggstate, llvm_aggstate_arg),
+      implementation_block /* true */,
+      error_aggstate_block /* false */);
+
+  // implementation block
+  // ----------
+  irb->SetInsertPoint(implementation_block);
+  llvm::Value* llvm_nrows = irb->CreateSExt(
+      llvm_nrows_arg, codegen_utils->GetType<int64_t>());
+
+  for (int aggno = 0; aggno < aggstate_->numaggs; aggno++) {
+    llvm::Value* llvm_pergroupstate = irb->CreateGEP(
+        llvm_pergroup_arg, {codegen_utils->GetConstant(
+            sizeof(AggStatePerGroupData) * aggno)});
+    llvm::Value* llvm_values = irb->CreateInBoundsGEP(
+        codegen_utils->GetType<Datum>(), llvm_values_arg,
+        codegen_utils->GetConstant<int64_t>(aggno * AGG_INPUT_BATCH_SIZE));
+    llvm::Value* llvm_isnull = irb->CreateInBoundsGEP(
+        codegen_utils->GetType<bool>(), llvm_isnull_arg,
+        codegen_utils->GetConstant<int64_t>(aggno * AGG_INPUT_BATCH_SIZE));
+
+    bool isGenerated = GenerateAdvanceAggregate(
+        codegen_utils, aggno, llvm_pergroupstate, llvm_values, llvm_isnull,
+        llvm_nrows, overflow_block);
+    if (!isGenerated)
+      return false;
+  }
+
+  irb->CreateRetVoid();
+
+  // Error aggstate block
+  // ---------------
+  irb->SetInsertPoint(error_aggstate_block);
+
+  EXPAND_CREATE_ELOG(codegen_utils, ERROR,
+                     "Codegened advance_aggregates_batch: "
+                     "use of different aggstate.");
+
+  irb->CreateRetVoid();
+
+  // Overflow block
+  // ---------------
+  irb->SetInsertPoint(overflow_block);
+  EXPAND_CREATE_EREPORT(codegen_utils,
+                        ERROR,
+                        ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE,
+                        "bigint out of range");
+  irb->CreateRetVoid();
+
+  return true;
+}
+
+
+bool AdvanceAggregatesBatchCodegen::GenerateCodeInternal(
+    GpCodegenUtils* codegen_utils) {
+  bool isGenerated = GenerateAdvanceAggregatesBatch(codegen_utils);
+
+  if (isGenerated) {
+    elog(DEBUG1, "AdvanceAggregatesBatch was generated successfully!");
+    return true;
+  } else {
+    elog(DEBUG1, "AdvanceAggregatesBatch generation failed!");
+    return false;
+  }
+}
@@ -21,6 +21,7 @@ extern "C" {
 #include "utils/palloc.h"
 #include "executor/executor.h"
 #include "nodes/nodes.h"
+#include "utils/tuplesort.h"
 }
 
 namespace llvm {
@@ -310,6 +311,51 @@ bool AdvanceAggregatesCodegen::GenerateAdvanceTransitionFunction(
   return true;
 }
 
+void AdvanceAggregatesCodegen::GenerateAdvanceOrderedAggregate(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    int aggno,
+    const std::vector<llvm::Value*>& llvm_in_args,
+    const std::vector<llvm::Value*>& llvm_in_args_isNull,
+    llvm::BasicBlock* end_advance_aggregate_block) {
+  auto irb = codegen_utils->ir_builder();
+  AggStatePerAgg peraggstate = &aggstate_->peragg[aggno];
+  assert(1 == peraggstate->numInputs);
+  assert(peraggstate->numArguments <= peraggstate->numInputs);
+
+  // External functions
+  llvm::Function* llvm_tuplesort_putdatum =
+      codegen_utils->GetOrRegisterExternalFunction(
+          switcheroo_tuplesort_putdatum, "switcheroo_tuplesort_putdatum");
+
+  llvm::BasicBlock* putdatum_block = codegen_utils->CreateBasicBlock(
+      "putdatum_block_aggno_" + std::to_string(aggno),
+      irb->GetInsertBlock()->getParent());
+
+  // If the transfn is strict, we want to check for nullity before storing
+  // the row in the sorter, to save space if there are a lot of nulls.
+  if (peraggstate->transfn.fn_strict && peraggstate->numArguments > 0) {
+    irb->CreateCondBr(llvm_in_args_isNull[1],
+                      end_advance_aggregate_block /* true */,
+                      putdatum_block /* false */);
+  } else {
+    irb->CreateBr(putdatum_block);
+  }
+
+  // putdatum_block
+  // --------------
+  // OK, put the tuple into the tuplesort object. The sorter is created for
+  // every group, so it is read from the peraggstate at runtime.
+  irb->SetInsertPoint(putdatum_block);
+  llvm::Value* llvm_sortstate = irb->CreateLoad(
+      codegen_utils->GetPointerToMember(
+          codegen_utils->GetConstant(peraggstate),
+          &AggStatePerAggData::sortstate));
+  // tuplesort_putdatum(peraggstate->sortstate, value, isnull);
+  irb->CreateCall(llvm_tuplesort_putdatum, {
+      llvm_sortstate, llvm_in_args[1], llvm_in_args_isNull[1]});
+  irb->CreateBr(end_advance_aggregate_block);
+}
+
 bool AdvanceAggregatesCodegen::GenerateAdvanceAggregates(
     gpcodegen::GpCodegenUtils* codegen_utils) {
 
@@ -340,6 +386,12 @@ bool AdvanceAggregatesCodegen::GenerateAdvanceAggregates(
   llvm::Function* llvm_ExecVariableList =
       codegen_utils->GetOrRegisterExternalFunction(ExecVariableList,
                                                    "ExecVariableList");
+  llvm::Function* llvm_ExecEvalExprSwitchContext =
+      codegen_utils->GetOrRegisterExternalFunction(
+          ExecEvalExprSwitchContext, "ExecEvalExprSwitchContext");
+  llvm::Function* llvm_advance_aggregate_row =
+      codegen_utils->GetOrRegisterExternalFunction(advance_aggregate_row,
+                                                   "advance_aggregate_row");
 
   // Function argument to advance_aggregates
   llvm::Value* llvm_aggstate_arg = ArgumentByPosition(
@@ -377,6 +429,11 @@ bool AdvanceAggregatesCodegen::GenerateAdvanceAggregates(
     llvm::BasicBlock* advance_aggregate_block = codegen_utils->
         CreateBasicBlock("advance_aggregate_block_aggno_"
             + std::to_string(aggno), advance_aggregates_func);
+    // Block that the code of each aggregate function ends up in, and which
+    // continues with the next one.
+    llvm::BasicBlock* end_advance_aggregate_block = codegen_utils->
+        CreateBasicBlock("end_advance_aggregate_block_aggno_"
+            + std::to_string(aggno), advance_aggregates_func);
 
     irb->CreateBr(advance_aggregate_block);
 
@@ -386,28 +443,61 @@ bool AdvanceAggregatesCodegen::GenerateAdvanceAggregates(
     irb->SetInsertPoint(advance_aggregate_block);
 
     AggStatePerAgg peraggstate = &aggstate_->peragg[aggno];
+    Aggref *aggref = peraggstate->aggref;
 
-    if (peraggstate->numSortCols > 0) {
-      elog(DEBUG1, "We don't codegen DISTINCT and/or ORDER BY case");
+    if (peraggstate->numSortCols > 0 && peraggstate->numInputs != 1) {
+      elog(DEBUG1, "We don't codegen DISTINCT and/or ORDER BY case with "
+           "more than one input");
       return false;
     }
 
-    Aggref *aggref = peraggstate->aggref;
-    if (!aggref) {
-      elog(DEBUG1, "We don't codegen non-aggref functions");
-      return false;
+    // Skip anything FILTERed out {{
+    ExprState* filter = peraggstate->aggrefstate ?
+        peraggstate->aggrefstate->aggfilter : nullptr;
+    if (nullptr != filter) {
+      llvm::BasicBlock* filter_passed_block = codegen_utils->
+          CreateBasicBlock("filter_passed_block_aggno_"
+              + std::to_string(aggno), advance_aggregates_func);
+      llvm::Value* llvm_filter_isnull_ptr = irb->CreateAlloca(
+          codegen_utils->GetType<bool>(), nullptr, "filter_isnull_ptr");
+      // res = ExecEvalExprSwitchContext(filter, aggstate->tmpcontext,
+      //                                 &isnull, NULL);
+      llvm::Value* llvm_filter_res = irb->CreateCall(
+          llvm_ExecEvalExprSwitchContext, {
+              codegen_utils->GetConstant(filter),
+              codegen_utils->GetConstant(aggstate_->tmpcontext),
+              llvm_filter_isnull_ptr,
+              codegen_utils->GetConstant<ExprDoneCond *>(nullptr)});
+      // if (isnull || !DatumGetBool(res))
+      //     continue;
+      irb->CreateCondBr(
+          irb->CreateOr(
+              irb->CreateLoad(llvm_filter_isnull_ptr),
+              irb->CreateNot(
+                  codegen_utils->CreateDatumToCppTypeCast<bool>(
+                      llvm_filter_res))),
+          end_advance_aggregate_block /* true */,
+          filter_passed_block /* false */);
+      irb->SetInsertPoint(filter_passed_block);
     }
+    // }} Skip anything FILTERed out
 
     assert(peraggstate->evalproj);
+    assert(peraggstate->evaldesc);
     // Number of attributes to be retrieved. This is one less than
     // number of arguments of the transition function, since the transition
     // value is passed as the first argument to the transition function.
+    // For ordered aggregates, these are the inputs put in the sorter, and for
+    // percentile functions, all the attributes of the projection.
     int nargs = peraggstate->transfn.fn_nargs - 1;
+    if (nullptr == aggref || peraggstate->numSortCols > 0) {
+      nargs = peraggstate->evaldesc->natts;
+    }
     assert(nargs >= 0);
 
-    // Since we do not support ordered functions, we do not need to store
-    // the value of the variables, which are used as input to the aggregate
-    // function, in a slot.
+    // Since we do not support ordered functions with more than one input, we
+    // do not need to store the value of the variables, which are used as
+    // input to the aggregate function, in a slot.
     llvm::Value* llvm_in_args_ptr = irb->CreateAlloca(
         codegen_utils->GetType<Datum>(),
         codegen_utils->GetConstant(nargs));
@@ -464,17 +554,45 @@ bool AdvanceAggregatesCodegen::GenerateAdvanceAggregates(
               codegen_utils->GetConstant(i)));
     }
 
-    gpcodegen::PGFuncGeneratorInfo pg_func_info(
-        advance_aggregates_func,
-        overflow_block,
-        llvm_in_args,
-        llvm_in_args_isNull);
+    if (peraggstate->numSortCols > 0) {
+      // DISTINCT and/or ORDER BY case
+      assert(nullptr != aggref);
+      GenerateAdvanceOrderedAggregate(codegen_utils, aggno, llvm_in_args,
+                                      llvm_in_args_isNull,
+                                      end_advance_aggregate_block);
+    } else if (nullptr == aggref ||
+        nullptr == gpcodegen::OpExprTreeGenerator::GetPGFuncGenerator(
+            peraggstate->transfn.fn_oid)) {
+      // Percentile functions, and transition functions we have no
+      // generator for, e.g. the numeric ones, are called through fmgr.
+      elog(DEBUG1, "Calling transition function with oid = %d through fmgr",
+           peraggstate->transfn.fn_oid);
+      irb->CreateCall(llvm_advance_aggregate_row, {
+          llvm_aggstate,
+          codegen_utils->GetConstant<int>(aggno),
+          irb->CreateGEP(llvm_pergroup_arg, {codegen_utils->GetConstant(
+              sizeof(AggStatePerGroupData) * aggno)}),
+          llvm_in_args_ptr,
+          llvm_in_isnulls_ptr,
+          codegen_utils->GetConstant<int>(nargs),
+          llvm_mem_manager_arg});
+      irb->CreateBr(end_advance_aggregate_block);
+    } else {
+      gpcodegen::PGFuncGeneratorInfo pg_func_info(
+          advance_aggregates_func,
+          overflow_block,
+          llvm_in_args,
+          llvm_in_args_isNull);
+
+      bool isGenerated = GenerateAdvanceTransitionFunction(
+          codegen_utils, llvm_pergroup_arg, aggno,
+          &pg_func_info, llvm_mem_manager_arg);
+      if (!isGenerated)
+        return false;
+      irb->CreateBr(end_advance_aggregate_block);
+    }
 
-    bool isGenerated = GenerateAdvanceTransitionFunction(
-        codegen_utils, llvm_pergroup_arg, aggno,
-        &pg_func_info, llvm_mem_manager_arg);
-    if (!isGenerated)
-      return false;
+    irb->SetInsertPoint(end_advance_aggregate_block);
   }  // End of for loop
 
   irb->CreateRetVoid();
@@ -0,0 +1,181 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    bool_expr_tree_generator.cc
+//
+//  @doc:
+//    Object that generate code for AND, OR and NOT expressions.
+//
+//---------------------------------------------------------------------------
+
+#include <assert.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "codegen/bool_expr_tree_generator.h"
+#include "codegen/expr_tree_generator.h"
+#include "codegen/utils/gp_codegen_utils.h"
+
+#include "llvm/IR/IRBuilder.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "nodes/execnodes.h"
+#include "nodes/nodes.h"
+#include "nodes/pg_list.h"
+#include "nodes/primnodes.h"
+#include "utils/elog.h"
+}
+
+using gpcodegen::BoolExprTreeGenerator;
+using gpcodegen::ExprTreeGenerator;
+using gpcodegen::GpCodegenUtils;
+
+bool BoolExprTreeGenerator::VerifyAndCreateExprTree(
+    const ExprState* expr_state,
+    ExprTreeGeneratorInfo* gen_info,
+    std::unique_ptr<ExprTreeGenerator>* expr_tree) {
+  assert(nullptr != expr_state &&
+         nullptr != expr_state->expr &&
+         T_BoolExpr == nodeTag(expr_state->expr) &&
+         nullptr != expr_tree);
+  expr_tree->reset(nullptr);
+
+  const BoolExprState* bool_state =
+      reinterpret_cast<const BoolExprState*>(expr_state);
+  BoolExpr* bool_expr = reinterpret_cast<BoolExpr*>(expr_state->expr);
+  if (NOT_EXPR == bool_expr->boolop) {
+    assert(1 == list_length(bool_state->args));
+  }
+
+  ListCell *cell = nullptr;
+  std::vector<std::unique_ptr<ExprTreeGenerator>> expr_tree_arguments;
+  foreach(cell, bool_state->args) {
+    ExprState *argstate = reinterpret_cast<ExprState*>(lfirst(cell));
+    assert(nullptr != argstate);
+    std::unique_ptr<ExprTreeGenerator> arg(nullptr);
+    if (!ExprTreeGenerator::VerifyAndCreateExprTree(argstate,
+                                                    gen_info,
+                                                    &arg)) {
+      return false;
+    }
+    assert(nullptr != arg);
+    expr_tree_arguments.push_back(std::move(arg));
+  }
+  expr_tree->reset(new BoolExprTreeGenerator(expr_state,
+                                             std::move(expr_tree_arguments)));
+  return true;
+}
+
+BoolExprTreeGenerator::BoolExprTreeGenerator(
+    const ExprState* expr_state,
+    std::vector<
+        std::unique_ptr<ExprTreeGenerator>>&& arguments)  // NOLINT(build/c++11)
+    :  ExprTreeGenerator(expr_state, ExprTreeNodeType::kBoolExpr),
+       arguments_(std::move(arguments)) {
+}
+
+bool BoolExprTreeGenerator::GenerateCode(GpCodegenUtils* codegen_utils,
+                                         const ExprTreeGeneratorInfo& gen_info,
+                                         llvm::Value** llvm_out_value,
+                                         llvm::Value* const llvm_isnull_ptr) {
+  assert(nullptr != llvm_out_value);
+  assert(nullptr != llvm_isnull_ptr);
+  *llvm_out_value = nullptr;
+  BoolExpr* bool_expr = reinterpret_cast<BoolExpr*>(expr_state()->expr);
+  auto irb = codegen_utils->ir_builder();
+
+  switch (bool_expr->boolop) {
+    case AND_EXPR:
+      return GenerateAndOr(codegen_utils, gen_info, true,
+                           llvm_out_value, llvm_isnull_ptr);
+    case OR_EXPR:
+      return GenerateAndOr(codegen_utils, gen_info, false,
+                           llvm_out_value, llvm_isnull_ptr);
+    case NOT_EXPR: {
+      assert(1 == arguments_.size());
+      // Same as ExecEvalNot: NULL stays NULL, otherwise negate.
+      llvm::Value* llvm_arg = nullptr;
+      if (!arguments_[0]->GenerateCode(codegen_utils, gen_info,
+                                       &llvm_arg, llvm_isnull_ptr)) {
+        return false;
+      }
+      *llvm_out_value = codegen_utils->CreateCppTypeToDatumCast(
+          irb->CreateNot(
+              codegen_utils->CreateDatumToCppTypeCast<bool>(llvm_arg)));
+      return true;
+    }
+    default:
+      elog(WARNING, "Unknown boolean operator %d", bool_expr->boolop);
+      return false;
+  }
+}
+
+bool BoolExprTreeGenerator::GenerateAndOr(
+    GpCodegenUtils* codegen_utils,
+    const ExprTreeGeneratorInfo& gen_info,
+    bool is_and,
+    llvm::Value** llvm_out_value,
+    llvm::Value* const llvm_isnull_ptr) {
+  auto irb = codegen_utils->ir_builder();
+  llvm::Function* llvm_main_func = gen_info.llvm_main_func;
+
+  // An AND is decided as soon as an argument is false, an OR as soon as an
+  // argument is true.
+  llvm::BasicBlock* llvm_decided_block = codegen_utils->CreateBasicBlock(
+      is_and ? "and_false_block" : "or_true_block", llvm_main_func);
+  llvm::BasicBlock* llvm_done_block = codegen_utils->CreateBasicBlock(
+      is_and ? "and_done_block" : "or_done_block", llvm_main_func);
+
+  llvm::Value* llvm_any_null = codegen_utils->GetConstant<bool>(false);
+  for (auto& arg : arguments_) {
+    llvm::Value* llvm_arg_isnull_ptr = irb->CreateAlloca(
+        codegen_utils->GetType<bool>(), nullptr, "isNull");
+    irb->CreateStore(codegen_utils->GetConstant<bool>(false),
+                     llvm_arg_isnull_ptr);
+    llvm::Value* llvm_arg = nullptr;
+    if (!arg->GenerateCode(codegen_utils, gen_info,
+                           &llvm_arg, llvm_arg_isnull_ptr)) {
+      return false;
+    }
+    llvm::Value* llvm_arg_isnull = irb->CreateLoad(llvm_arg_isnull_ptr);
+    llvm::Value* llvm_arg_bool =
+        codegen_utils->CreateDatumToCppTypeCast<bool>(llvm_arg);
+    if (is_and) {
+      llvm_arg_bool = irb->CreateNot(llvm_arg_bool);
+    }
+    llvm::Value* llvm_is_decided = irb->CreateAnd(
+        irb->CreateNot(llvm_arg_isnull), llvm_arg_bool);
+    llvm_any_null = irb->CreateOr(llvm_any_null, llvm_arg_isnull);
+
+    llvm::BasicBlock* llvm_next_block = codegen_utils->CreateBasicBlock(
+        "next_arg_block", llvm_main_func);
+    irb->CreateCondBr(llvm_is_decided, llvm_decided_block, llvm_next_block);
+    irb->SetInsertPoint(llvm_next_block);
+  }
+
+  // All arguments evaluated without deciding the result: NULL if any of
+  // them was NULL, otherwise true for AND and false for OR.
+  irb->CreateStore(llvm_any_null, llvm_isnull_ptr);
+  llvm::Value* llvm_undecided_value = is_and ?
+      irb->CreateNot(llvm_any_null) : codegen_utils->GetConstant<bool>(false);
+  llvm::BasicBlock* llvm_undecided_block = irb->GetInsertBlock();
+  irb->CreateBr(llvm_done_block);
+
+  irb->SetInsertPoint(llvm_decided_block);
+  irb->CreateStore(codegen_utils->GetConstant<bool>(false), llvm_isnull_ptr);
+  irb->CreateBr(llvm_done_block);
+
+  irb->SetInsertPoint(llvm_done_block);
+  llvm::PHINode* llvm_result = irb->CreatePHI(
+      codegen_utils->GetType<bool>(), 2);
+  llvm_result->addIncoming(llvm_undecided_value, llvm_undecided_block);
+  llvm_result->addIncoming(codegen_utils->GetConstant<bool>(!is_and),
+                           llvm_decided_block);
+  *llvm_out_value = codegen_utils->CreateCppTypeToDatumCast(llvm_result);
+  return true;
+}
@@ -0,0 +1,165 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    calc_hash_value_codegen.cc
+//
+//  @doc:
+//    Generates code for calc_hash_value function.
+//
+//---------------------------------------------------------------------------
+#include <assert.h>
+#include <cstdint>
+
+#include "codegen/calc_hash_value_codegen.h"
+#include "codegen/pg_hash_func_generator.h"
+#include "codegen/utils/gp_codegen_utils.h"
+#include "codegen/utils/utility.h"
+
+#include "llvm/IR/IRBuilder.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "access/hash.h"
+#include "executor/execHHashagg.h"
+#include "nodes/execnodes.h"
+#include "nodes/plannodes.h"
+#include "utils/elog.h"
+}
+
+namespace llvm {
+class BasicBlock;
+class Function;
+class Value;
+}  // namespace llvm
+
+using gpcodegen::CalcHashValueCodegen;
+using gpcodegen::PGHashFuncGenerator;
+
+constexpr char CalcHashValueCodegen::kCalcHashValuePrefix[];
+
+CalcHashValueCodegen::CalcHashValueCodegen(
+    CodegenManager* manager,
+    CalcHashValueFn regular_func_ptr,
+    CalcHashValueFn* ptr_to_regular_func_ptr,
+    AggState *aggstate)
+: BaseCodegen(manager,
+              kCalcHashValuePrefix,
+              regular_func_ptr,
+              ptr_to_regular_func_ptr),
+              aggstate_(aggstate) {
+}
+
+bool CalcHashValueCodegen::GenerateCalcHashValue(
+    gpcodegen::GpCodegenUtils* codegen_utils) {
+  assert(nullptr != codegen_utils);
+  assert(nullptr != aggstate_);
+  static_assert(sizeof(HashKey) == sizeof(uint32_t),
+      "sizeof(HashKey) doesn't match sizeof(uint32)");
+
+  Agg* agg = reinterpret_cast<Agg*>(aggstate_->ss.ps.plan);
+  if (agg->aggstrategy != AGG_HASHED ||
+      agg->numCols <= 0 ||
+      nullptr == aggstate_->hashfunctions) {
+    elog(DEBUG1, "Cannot generate code for calc_hash_value "
+                 "because the Agg node does not use hashing.");
+    return false;
+  }
+
+  for (int i = 0; i < agg->numCols; i++) {
+    if (agg->grpColIdx[i] <= 0) {
+      elog(DEBUG1, "Cannot generate code for calc_hash_value "
+                   "because of system attribute %d.", agg->grpColIdx[i]);
+      return false;
+    }
+    if (!PGHashFuncGenerator::IsSupported(
+        aggstate_->hashfunctions[i].fn_oid)) {
+      elog(DEBUG1, "Cannot generate code for calc_hash_value "
+                   "because hash function %u is not supported.",
+                   aggstate_->hashfunctions[i].fn_oid);
+      return false;
+    }
+  }
+
+  llvm::Function* calc_hash_value_func = CreateFunction<CalcHashValueFn>(
+      codegen_utils, GetUniqueFuncName());
+
+  auto irb = codegen_utils->ir_builder();
+
+  // External functions
+  llvm::Function* llvm_slot_getattr =
+      codegen_utils->GetOrRegisterExternalFunction(slot_getattr_regular,
+                                                   "slot_getattr_regular");
+  llvm::Function* llvm_hash_any =
+      codegen_utils->GetOrRegisterExternalFunction(hash_any, "hash_any");
+
+  // BasicBlocks
+  llvm::BasicBlock* entry_block = codegen_utils->CreateBasicBlock(
+      "entry", calc_hash_value_func);
+
+  // Function arguments to calc_hash_value
+  llvm::Value* llvm_inputslot_arg =
+      ArgumentByPosition(calc_hash_value_func, 1);
+
+  // Entry block
+  // -----------
+  irb->SetInsertPoint(entry_block);
+#ifdef CODEGEN_DEBUG
+  EXPAND_CREATE_ELOG(codegen_utils,
+                     DEBUG1,
+                     "Codegen'ed calc_hash_value called!");
+#endif
+  // Local replacement for hashtable->hashkey_buf, which only serves as
+  // scratch space for hash_any.
+  llvm::Value* llvm_hashkey_buf = irb->CreateAlloca(
+      codegen_utils->GetType<HashKey>(),
+      codegen_utils->GetConstant<int32_t>(agg->numCols),
+      "hashkey_buf");
+  llvm::Value* llvm_isnull_ptr =
+      irb->CreateAlloca(codegen_utils->GetType<bool>(), nullptr, "isnull");
+
+  for (int i = 0; i < agg->numCols; i++) {
+    // Datum value = slot_getattr(inputslot, att, &isnull);
+    llvm::Value* llvm_value = irb->CreateCall(llvm_slot_getattr, {
+        llvm_inputslot_arg,
+        codegen_utils->GetConstant<int32_t>(agg->grpColIdx[i]),
+        llvm_isnull_ptr});
+    llvm::Value* llvm_isnull = irb->CreateLoad(llvm_isnull_ptr);
+
+    // The hash of a garbage Datum is computed without side effects, so a
+    // select is cheaper than branching on isnull.
+    llvm::Value* llvm_hashkey = PGHashFuncGenerator::GenerateHashDatum(
+        codegen_utils, aggstate_->hashfunctions[i].fn_oid, llvm_value);
+    assert(nullptr != llvm_hashkey);
+    irb->CreateStore(
+        irb->CreateSelect(llvm_isnull,
+                          codegen_utils->GetConstant<HashKey>(0xdeadbeef),
+                          llvm_hashkey),
+        irb->CreateInBoundsGEP(llvm_hashkey_buf,
+                               {codegen_utils->GetConstant(i)}));
+  }
+
+  // return hash_any(hashkey_buf, numCols * sizeof(HashKey));
+  llvm::Value* llvm_hash = irb->CreateCall(llvm_hash_any, {
+      irb->CreateBitCast(llvm_hashkey_buf,
+                         codegen_utils->GetType<unsigned char*>()),
+      codegen_utils->GetConstant<int32_t>(
+          static_cast<int32_t>(agg->numCols * sizeof(HashKey)))});
+  irb->CreateRet(codegen_utils->CreateDatumToCppTypeCast<uint32_t>(llvm_hash));
+
+  return true;
+}
+
+bool CalcHashValueCodegen::GenerateCodeInternal(
+    GpCodegenUtils* codegen_utils) {
+  bool isGenerated = GenerateCalcHashValue(codegen_utils);
+
+  if (isGenerated) {
+    elog(DEBUG1, "calc_hash_value was generated successfully!");
+    return true;
+  } else {
+    elog(DEBUG1, "calc_hash_value generation failed!");
+    return false;
+  }
+}
@@ -0,0 +1,198 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    case_expr_tree_generator.cc
+//
+//  @doc:
+//    Object that generate code for CASE expression.
+//
+//---------------------------------------------------------------------------
+
+#include <assert.h>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "codegen/case_expr_tree_generator.h"
+#include "codegen/expr_tree_generator.h"
+#include "codegen/utils/gp_codegen_utils.h"
+
+#include "llvm/IR/IRBuilder.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "nodes/execnodes.h"
+#include "nodes/nodes.h"
+#include "nodes/pg_list.h"
+#include "nodes/primnodes.h"
+#include "utils/elog.h"
+}
+
+using gpcodegen::CaseExprTreeGenerator;
+using gpcodegen::ExprTreeGenerator;
+using gpcodegen::GpCodegenUtils;
+
+bool CaseExprTreeGenerator::VerifyAndCreateExprTree(
+    const ExprState* expr_state,
+    ExprTreeGeneratorInfo* gen_info,
+    std::unique_ptr<ExprTreeGenerator>* expr_tree) {
+  assert(nullptr != expr_state &&
+         nullptr != expr_state->expr &&
+         T_CaseExpr == nodeTag(expr_state->expr) &&
+         nullptr != expr_tree);
+  expr_tree->reset(nullptr);
+  const CaseExprState* case_state =
+      reinterpret_cast<const CaseExprState*>(expr_state);
+
+  std::unique_ptr<ExprTreeGenerator> arg(nullptr);
+  if (nullptr != case_state->arg &&
+      !ExprTreeGenerator::VerifyAndCreateExprTree(case_state->arg,
+                                                  gen_info,
+                                                  &arg)) {
+    return false;
+  }
+
+  ListCell *cell = nullptr;
+  std::vector<WhenClause> when_clauses;
+  foreach(cell, case_state->args) {
+    CaseWhenState *when_state = reinterpret_cast<CaseWhenState*>(lfirst(cell));
+    assert(nullptr != when_state);
+    std::unique_ptr<ExprTreeGenerator> condition(nullptr);
+    std::unique_ptr<ExprTreeGenerator> result(nullptr);
+    if (!ExprTreeGenerator::VerifyAndCreateExprTree(when_state->expr,
+                                                    gen_info,
+                                                    &condition) ||
+        !ExprTreeGenerator::VerifyAndCreateExprTree(when_state->result,
+                                                    gen_info,
+                                                    &result)) {
+      return false;
+    }
+    when_clauses.emplace_back(std::move(condition), std::move(result));
+  }
+
+  std::unique_ptr<ExprTreeGenerator> default_result(nullptr);
+  if (nullptr != case_state->defresult &&
+      !ExprTreeGenerator::VerifyAndCreateExprTree(case_state->defresult,
+                                                  gen_info,
+                                                  &default_result)) {
+    return false;
+  }
+
+  expr_tree->reset(new CaseExprTreeGenerator(expr_state,
+                                             std::move(arg),
+                                             std::move(when_clauses),
+                                             std::move(default_result)));
+  return true;
+}
+
+CaseExprTreeGenerator::CaseExprTreeGenerator(
+    const ExprState* expr_state,
+    std::unique_ptr<ExprTreeGenerator> arg,
+    std::vector<WhenClause>&& when_clauses,  // NOLINT(build/c++11)
+    std::unique_ptr<ExprTreeGenerator> default_result)
+    :  ExprTreeGenerator(expr_state, ExprTreeNodeType::kCase),
+       arg_(std::move(arg)),
+       when_clauses_(std::move(when_clauses)),
+       default_result_(std::move(default_result)) {
+}
+
+bool CaseExprTreeGenerator::GenerateCode(GpCodegenUtils* codegen_utils,
+                                         const ExprTreeGeneratorInfo& gen_info,
+                                         llvm::Value** llvm_out_value,
+                                         llvm::Value* const llvm_isnull_ptr) {
+  assert(nullptr != llvm_out_value);
+  assert(nullptr != llvm_isnull_ptr);
+  assert(nullptr != gen_info.econtext);
+  *llvm_out_value = nullptr;
+  auto irb = codegen_utils->ir_builder();
+  llvm::Function* llvm_main_func = gen_info.llvm_main_func;
+
+  // The econtext outlives the generated code, so its caseValue fields can be
+  // addressed directly.
+  llvm::Value* llvm_case_value_ptr =
+      codegen_utils->GetConstant(&gen_info.econtext->caseValue_datum);
+  llvm::Value* llvm_case_isnull_ptr =
+      codegen_utils->GetConstant(&gen_info.econtext->caseValue_isNull);
+
+  // save_datum = econtext->caseValue_datum; {{{
+  llvm::Value* llvm_save_value = irb->CreateLoad(llvm_case_value_ptr);
+  llvm::Value* llvm_save_isnull = irb->CreateLoad(llvm_case_isnull_ptr);
+  // }}}
+
+  if (nullptr != arg_) {
+    llvm::Value* llvm_arg_isnull_ptr = irb->CreateAlloca(
+        codegen_utils->GetType<bool>(), nullptr, "caseValue_isNull");
+    irb->CreateStore(codegen_utils->GetConstant<bool>(false),
+                     llvm_arg_isnull_ptr);
+    llvm::Value* llvm_arg = nullptr;
+    if (!arg_->GenerateCode(codegen_utils, gen_info,
+                            &llvm_arg, llvm_arg_isnull_ptr)) {
+      return false;
+    }
+    irb->CreateStore(llvm_arg, llvm_case_value_ptr);
+    irb->CreateStore(irb->CreateLoad(llvm_arg_isnull_ptr),
+                     llvm_case_isnull_ptr);
+  }
+
+  llvm::BasicBlock* llvm_done_block = codegen_utils->CreateBasicBlock(
+      "case_done_block", llvm_main_func);
+  std::vector<std::pair<llvm::Value*, llvm::BasicBlock*>> llvm_results;
+
+  for (auto& when_clause : when_clauses_) {
+    llvm::Value* llvm_condition = nullptr;
+    if (!when_clause.first->GenerateCode(codegen_utils, gen_info,
+                                         &llvm_condition, llvm_isnull_ptr)) {
+      return false;
+    }
+    // A NULL condition is not considered true.
+    llvm::Value* llvm_is_true = irb->CreateAnd(
+        codegen_utils->CreateDatumToCppTypeCast<bool>(llvm_condition),
+        irb->CreateNot(irb->CreateLoad(llvm_isnull_ptr)));
+
+    llvm::BasicBlock* llvm_then_block = codegen_utils->CreateBasicBlock(
+        "case_then_block", llvm_main_func);
+    llvm::BasicBlock* llvm_next_block = codegen_utils->CreateBasicBlock(
+        "case_next_block", llvm_main_func);
+    irb->CreateCondBr(llvm_is_true, llvm_then_block, llvm_next_block);
+
+    irb->SetInsertPoint(llvm_then_block);
+    irb->CreateStore(llvm_save_value, llvm_case_value_ptr);
+    irb->CreateStore(llvm_save_isnull, llvm_case_isnull_ptr);
+    llvm::Value* llvm_result = nullptr;
+    if (!when_clause.second->GenerateCode(codegen_utils, gen_info,
+                                          &llvm_result, llvm_isnull_ptr)) {
+      return false;
+    }
+    llvm_results.emplace_back(llvm_result, irb->GetInsertBlock());
+    irb->CreateBr(llvm_done_block);
+
+    irb->SetInsertPoint(llvm_next_block);
+  }
+
+  // No WHEN clause matched.
+  irb->CreateStore(llvm_save_value, llvm_case_value_ptr);
+  irb->CreateStore(llvm_save_isnull, llvm_case_isnull_ptr);
+  llvm::Value* llvm_default = nullptr;
+  if (nullptr != default_result_) {
+    if (!default_result_->GenerateCode(codegen_utils, gen_info,
+                                       &llvm_default, llvm_isnull_ptr)) {
+      return false;
+    }
+  } else {
+    irb->CreateStore(codegen_utils->GetConstant<bool>(true), llvm_isnull_ptr);
+    llvm_default = codegen_utils->GetConstant<Datum>(0);
+  }
+  llvm_results.emplace_back(llvm_default, irb->GetInsertBlock());
+  irb->CreateBr(llvm_done_block);
+
+  irb->SetInsertPoint(llvm_done_block);
+  llvm::PHINode* llvm_out_phi = irb->CreatePHI(
+      codegen_utils->GetType<Datum>(), llvm_results.size());
+  for (auto& result : llvm_results) {
+    llvm_out_phi->addIncoming(result.first, result.second);
+  }
+  *llvm_out_value = llvm_out_phi;
+  return true;
+}
@@ -0,0 +1,71 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    case_test_expr_tree_generator.cc
+//
+//  @doc:
+//    Object that generate code for the placeholder of a CASE test value.
+//
+//---------------------------------------------------------------------------
+
+#include <assert.h>
+#include <memory>
+#include <utility>
+
+#include "codegen/expr_tree_generator.h"
+#include "codegen/case_test_expr_tree_generator.h"
+#include "codegen/utils/gp_codegen_utils.h"
+
+#include "llvm/IR/IRBuilder.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "nodes/execnodes.h"
+#include "nodes/nodes.h"
+#include "nodes/primnodes.h"
+#include "utils/elog.h"
+}
+
+using gpcodegen::CaseTestExprTreeGenerator;
+using gpcodegen::ExprTreeGenerator;
+using gpcodegen::GpCodegenUtils;
+
+bool CaseTestExprTreeGenerator::VerifyAndCreateExprTree(
+    const ExprState* expr_state,
+    ExprTreeGeneratorInfo* gen_info,
+    std::unique_ptr<ExprTreeGenerator>* expr_tree) {
+  assert(nullptr != expr_state &&
+         nullptr != expr_state->expr &&
+         T_CaseTestExpr == nodeTag(expr_state->expr) &&
+         nullptr != expr_tree);
+  expr_tree->reset(new CaseTestExprTreeGenerator(expr_state));
+  return true;
+}
+
+CaseTestExprTreeGenerator::CaseTestExprTreeGenerator(
+    const ExprState* expr_state) :
+    ExprTreeGenerator(expr_state, ExprTreeNodeType::kCaseTest) {
+}
+
+bool CaseTestExprTreeGenerator::GenerateCode(
+    GpCodegenUtils* codegen_utils,
+    const ExprTreeGeneratorInfo& gen_info,
+    llvm::Value** llvm_out_value,
+    llvm::Value* const llvm_isnull_ptr) {
+  assert(nullptr != llvm_out_value);
+  assert(nullptr != llvm_isnull_ptr);
+  assert(nullptr != gen_info.econtext);
+  auto irb = codegen_utils->ir_builder();
+
+  // *isNull = econtext->caseValue_isNull;
+  irb->CreateStore(
+      irb->CreateLoad(
+          codegen_utils->GetConstant(&gen_info.econtext->caseValue_isNull)),
+      llvm_isnull_ptr);
+  // return econtext->caseValue_datum;
+  *llvm_out_value = irb->CreateLoad(
+      codegen_utils->GetConstant(&gen_info.econtext->caseValue_datum));
+  return true;
+}
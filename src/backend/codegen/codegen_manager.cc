@@ -10,15 +10,20 @@
 //
 //---------------------------------------------------------------------------
 #include <assert.h>
+#include <pthread.h>
+#include <signal.h>
+#include <chrono>  // NOLINT(build/c++11)
 #include <iosfwd>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "llvm/Support/raw_ostream.h"
 
 #include "codegen/codegen_interface.h"
 #include "codegen/codegen_manager.h"
+#include "codegen/codegen_module_cache.h"
 #include "codegen/codegen_wrapper.h"
 #include "codegen/utils/codegen_utils.h"
 #include "codegen/utils/gp_codegen_utils.h"
@@ -29,39 +34,113 @@ extern "C" {
 }
 
 using gpcodegen::CodegenManager;
+using gpcodegen::CodegenModuleCache;
 
-CodegenManager::CodegenManager(const std::string& module_name) {
+constexpr char kParameterVariantModuleSuffix[] = "_parameter_variant";
+
+namespace {
+
+// The CodegenManager of this backend that owns the background compilation
+// thread, if any. A backend runs at most one such thread; the managers that
+// come later compile synchronously.
+CodegenManager* background_compilation_owner = nullptr;
+
+// Adds the milliseconds elapsed during its lifetime to a counter.
+class ScopedTimer {
+ public:
+  explicit ScopedTimer(double* elapsed_ms)
+      : elapsed_ms_(elapsed_ms),
+        start_(std::chrono::steady_clock::now()) {
+  }
+
+  ~ScopedTimer() {
+    *elapsed_ms_ += std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start_).count();
+  }
+
+ private:
+  double* elapsed_ms_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace
+
+bool codegen_compilation_pending = false;
+
+CodegenManager::CodegenManager(const std::string& module_name)
+    : parameter_change_count_(0),
+      is_cacheable_(false),
+      has_compilation_thread_(false),
+      is_compilation_relocatable_(false),
+      is_compilation_done_(false),
+      is_compilation_successful_(false),
+      generate_time_ms_(0),
+      compile_time_ms_(0),
+      background_compile_time_ms_(0) {
   module_name_ = module_name;
   codegen_utils_.reset(new gpcodegen::GpCodegenUtils(module_name));
+  parameter_variant_codegen_utils_ = CreateParameterVariantUtils();
+}
+
+CodegenManager::~CodegenManager() {
+  // A module whose compilation finished after the last swap is not cached,
+  // since its functions were never set up.
+  WaitForBackgroundCompilation();
+  if (is_cacheable_ && IsModuleCacheEnabled()) {
+    CodegenModuleCache::GetInstance()->Checkin(
+        module_fingerprint_,
+        std::move(codegen_utils_),
+        std::move(compiled_function_names_));
+  }
 }
 
 bool CodegenManager::EnrollCodeGenerator(
     CodegenFuncLifespan funcLifespan, CodegenInterface* generator) {
-  // Only CodegenFuncLifespan_Parameter_Invariant is supported as of now
-  assert(funcLifespan == CodegenFuncLifespan_Parameter_Invariant);
   assert(nullptr != generator);
-  enrolled_code_generators_.emplace_back(generator);
-  return true;
+  switch (funcLifespan) {
+    case CodegenFuncLifespan_Parameter_Invariant:
+      enrolled_code_generators_.emplace_back(generator);
+      return true;
+    case CodegenFuncLifespan_Parameter_Variant:
+      parameter_variant_code_generators_.emplace_back(generator);
+      return true;
+  }
+  assert(false);
+  return false;
 }
 
 unsigned int CodegenManager::GenerateCode() {
+  ScopedTimer timer(&generate_time_ms_);
+  // Any previously computed fingerprint is stale now.
+  module_fingerprint_.clear();
   // First, allow all code generators to initialize their dependencies
+  // NB: These lists are still volatile at this time, as more generators may be
+  // enrolled as we iterate to initialize dependencies.
+  for (size_t i = 0; i < parameter_variant_code_generators_.size(); ++i) {
+    parameter_variant_code_generators_[i]->InitDependencies();
+  }
   for (size_t i = 0; i < enrolled_code_generators_.size(); ++i) {
-    // NB: This list is still volatile at this time, as more generators may be
-    // enrolled as we iterate to initialize dependencies.
     enrolled_code_generators_[i]->InitDependencies();
   }
-  // Then ask them to generate code
+  // Then ask them to generate code. Invariant generators go first, so that
+  // variant generators can tell that shared dependencies were generated into
+  // the other module.
   unsigned int success_count = 0;
   for (std::unique_ptr<CodegenInterface>& generator :
       enrolled_code_generators_) {
     success_count += generator->GenerateCode(codegen_utils_.get());
   }
+  for (std::unique_ptr<CodegenInterface>& generator :
+      parameter_variant_code_generators_) {
+    success_count += generator->GenerateCode(
+        parameter_variant_codegen_utils_.get());
+  }
   return success_count;
 }
 
 unsigned int CodegenManager::PrepareGeneratedFunctions() {
-  unsigned int success_count = 0;
+  ScopedTimer timer(&compile_time_ms_);
+  unsigned int success_count = PrepareParameterVariantFunctions();
 
   // If no generator registered, just return with success count as 0
   if (enrolled_code_generators_.empty()) {
@@ -77,6 +156,17 @@ unsigned int CodegenManager::PrepareGeneratedFunctions() {
   STATIC_ASSERT_OPTIMIZATION_LEVEL(kAggressive,
                                    CODEGEN_OPTIMIZATION_LEVEL_AGGRESSIVE);
 
+  bool is_relocatable = false;
+  if (IsModuleCacheEnabled()) {
+    unsigned int cached_count = 0;
+    if (PrepareCachedFunctions(&cached_count)) {
+      return success_count + cached_count;
+    }
+    // Compile pointer constants as loads from a binding table, so that the
+    // compiled module can be rebound to the objects of a later query.
+    is_relocatable = codegen_utils_->MakeExternalVariablesRelocatable();
+  }
+
   // Call GpCodegenUtils to compile entire module
   bool compilation_status = codegen_utils_->PrepareForExecution(
       gpcodegen::GpCodegenUtils::OptimizationLevel(codegen_optimization_level),
@@ -86,25 +176,233 @@ unsigned int CodegenManager::PrepareGeneratedFunctions() {
     return success_count;
   }
 
+  // Generators keep using the regular functions until the background thread
+  // is done, see SwapInCompiledFunctions().
+  if (codegen_async_compile) {
+    is_compilation_relocatable_ = is_relocatable;
+    if (StartBackgroundCompilation()) {
+      return success_count;
+    }
+  }
+
+  return success_count + SetToCompiledFunctions(is_relocatable);
+}
+
+unsigned int CodegenManager::SetToCompiledFunctions(bool is_relocatable) {
   // On successful compilation, go through all generator and swap
   // the pointer so compiled function get called
+  unsigned int success_count = 0;
   gpcodegen::GpCodegenUtils* codegen_utils = codegen_utils_.get();
+  compiled_function_names_.clear();
   for (std::unique_ptr<CodegenInterface>& generator :
       enrolled_code_generators_) {
-    success_count += generator->SetToGenerated(codegen_utils);
+    bool is_set_to_generated = generator->SetToGenerated(codegen_utils);
+    compiled_function_names_.push_back(
+        is_set_to_generated ? generator->GetUniqueFuncName() : "");
+    success_count += is_set_to_generated;
   }
+  is_cacheable_ = is_relocatable && success_count > 0;
   return success_count;
 }
 
-void CodegenManager::NotifyParameterChange() {
-  // no support for parameter change yet
-  assert(false);
+bool CodegenManager::StartBackgroundCompilation() {
+  assert(!has_compilation_thread_);
+  if (nullptr != background_compilation_owner) {
+    return false;
+  }
+  is_compilation_done_.store(false, std::memory_order_relaxed);
+
+  // Signal handlers of the backend must only ever run on its main thread, so
+  // the compilation thread starts out with all signals blocked.
+  sigset_t all_signals;
+  sigset_t old_signals;
+  sigfillset(&all_signals);
+  pthread_sigmask(SIG_SETMASK, &all_signals, &old_signals);
+  int pthread_err = pthread_create(&compilation_thread_, nullptr,
+                                   CompileInBackground, this);
+  pthread_sigmask(SIG_SETMASK, &old_signals, nullptr);
+
+  if (0 != pthread_err) {
+    elog(DEBUG1, "Could not start background compilation: error %d",
+         pthread_err);
+    return false;
+  }
+  has_compilation_thread_ = true;
+  background_compilation_owner = this;
+  codegen_compilation_pending = true;
+  return true;
+}
+
+void* CodegenManager::CompileInBackground(void* manager) {
+  CodegenManager* self = static_cast<CodegenManager*>(manager);
+  // Must not call into the backend (elog, palloc, ...) from this thread.
+  {
+    ScopedTimer timer(&self->background_compile_time_ms_);
+    self->is_compilation_successful_ =
+        self->codegen_utils_->FinalizeCompilation();
+  }
+  self->is_compilation_done_.store(true, std::memory_order_release);
+  return nullptr;
+}
+
+void CodegenManager::WaitForBackgroundCompilation() {
+  if (!has_compilation_thread_) {
+    return;
+  }
+  pthread_join(compilation_thread_, nullptr);
+  has_compilation_thread_ = false;
+  background_compilation_owner = nullptr;
+  codegen_compilation_pending = false;
+}
+
+void CodegenManager::AbortBackgroundCompilation() {
+  if (nullptr != background_compilation_owner) {
+    background_compilation_owner->WaitForBackgroundCompilation();
+  }
+}
+
+unsigned int CodegenManager::SwapInCompiledFunctions() {
+  if (!has_compilation_thread_ ||
+      !is_compilation_done_.load(std::memory_order_acquire)) {
+    return 0;
+  }
+  WaitForBackgroundCompilation();
+  if (!is_compilation_successful_) {
+    return 0;
+  }
+  ScopedTimer timer(&compile_time_ms_);
+  return SetToCompiledFunctions(is_compilation_relocatable_);
+}
+
+const std::string& CodegenManager::GetModuleFingerprint() {
+  if (module_fingerprint_.empty()) {
+    module_fingerprint_ = codegen_utils_->GetModuleFingerprint();
+    module_fingerprint_ += "; optimization level " +
+        std::to_string(codegen_optimization_level) + "\n";
+  }
+  return module_fingerprint_;
+}
+
+bool CodegenManager::PrepareCachedFunctions(unsigned int* success_count) {
+  assert(nullptr != success_count);
+  std::vector<std::string> function_names;
+  std::unique_ptr<gpcodegen::GpCodegenUtils> cached_codegen_utils =
+      CodegenModuleCache::GetInstance()->Checkout(GetModuleFingerprint(),
+                                                  &function_names);
+  if (nullptr == cached_codegen_utils) {
+    return false;
+  }
+  // Identical fingerprints imply identical enrollment and external variables,
+  // so this only fails if the cache was handed an inconsistent entry; in that
+  // case drop it and compile our own module.
+  if (function_names.size() != enrolled_code_generators_.size() ||
+      !cached_codegen_utils->RebindExternalVariables(*codegen_utils_)) {
+    return false;
+  }
+
+  *success_count = 0;
+  for (size_t i = 0; i < enrolled_code_generators_.size(); ++i) {
+    if (!function_names[i].empty()) {
+      *success_count += enrolled_code_generators_[i]->SetToGenerated(
+          cached_codegen_utils.get(), function_names[i]);
+    }
+  }
+  // The freshly generated module is not needed anymore.
+  codegen_utils_ = std::move(cached_codegen_utils);
+  compiled_function_names_ = std::move(function_names);
+  is_cacheable_ = true;
+  return true;
+}
+
+unsigned int CodegenManager::PrepareParameterVariantFunctions() {
+  unsigned int success_count = 0;
+  if (parameter_variant_code_generators_.empty()) {
+    return success_count;
+  }
+
+  bool compilation_status = parameter_variant_codegen_utils_->
+      PrepareForExecution(gpcodegen::GpCodegenUtils::OptimizationLevel(
+                              codegen_optimization_level),
+                          true);
+  if (!compilation_status) {
+    return success_count;
+  }
+
+  for (std::unique_ptr<CodegenInterface>& generator :
+      parameter_variant_code_generators_) {
+    success_count += generator->SetToGenerated(
+        parameter_variant_codegen_utils_.get());
+  }
+  return success_count;
+}
+
+std::unique_ptr<gpcodegen::GpCodegenUtils>
+CodegenManager::CreateParameterVariantUtils() {
+  return std::unique_ptr<gpcodegen::GpCodegenUtils>(
+      new gpcodegen::GpCodegenUtils(
+          module_name_ + kParameterVariantModuleSuffix));
+}
+
+unsigned int CodegenManager::NotifyParameterChange() {
+  if (parameter_variant_code_generators_.empty()) {
+    return 0;
+  }
+
+  // Functions generated for the old parameter values must not be called
+  // anymore, and their module goes away with them.
+  for (std::unique_ptr<CodegenInterface>& generator :
+      parameter_variant_code_generators_) {
+    generator->Reset();
+  }
+  parameter_variant_codegen_utils_ = CreateParameterVariantUtils();
+
+  // Regenerating on every rescan of e.g. a correlated subplan costs more than
+  // it saves, so give up after a while and stay on the regular functions.
+  if (parameter_change_count_ >= codegen_max_parameter_regenerations) {
+    return 0;
+  }
+  parameter_change_count_++;
+
+  unsigned int generated_count = 0;
+  {
+    ScopedTimer timer(&generate_time_ms_);
+    for (std::unique_ptr<CodegenInterface>& generator :
+        parameter_variant_code_generators_) {
+      generated_count += generator->GenerateCode(
+          parameter_variant_codegen_utils_.get());
+    }
+  }
+  if (0 == generated_count) {
+    return 0;
+  }
+  ScopedTimer timer(&compile_time_ms_);
+  return PrepareParameterVariantFunctions();
 }
 
 bool CodegenManager::InvalidateGeneratedFunctions() {
-  // no support for invalidation of generated function
-  assert(false);
-  return false;
+  // Functions compiled in the background must not be swapped in afterwards.
+  WaitForBackgroundCompilation();
+  for (std::unique_ptr<CodegenInterface>& generator :
+      enrolled_code_generators_) {
+    generator->Reset();
+  }
+  for (std::unique_ptr<CodegenInterface>& generator :
+      parameter_variant_code_generators_) {
+    generator->Reset();
+  }
+  parameter_variant_codegen_utils_ = CreateParameterVariantUtils();
+  return true;
+}
+
+void CodegenManager::GetTimes(CodegenTimes* times) const {
+  assert(nullptr != times);
+  times->generate = generate_time_ms_;
+  times->compile = compile_time_ms_;
+  // The time of a background compilation is only known once it is done.
+  if (!has_compilation_thread_ ||
+      is_compilation_done_.load(std::memory_order_acquire)) {
+    times->compile += background_compile_time_ms_;
+  }
 }
 
 const std::string& CodegenManager::GetExplainString() {
@@ -113,6 +411,24 @@ const std::string& CodegenManager::GetExplainString() {
 
 void CodegenManager::AccumulateExplainString() {
   explain_string_.clear();
+  if (IsModuleCacheEnabled() && !enrolled_code_generators_.empty()) {
+    // Probe the cache before optimizing below changes the module.
+    CodegenModuleCache* cache = CodegenModuleCache::GetInstance();
+    explain_string_ += "; module cache: ";
+    explain_string_ += cache->Contains(GetModuleFingerprint()) ? "hit" : "miss";
+    explain_string_ += " (backend hits: " + std::to_string(cache->hits()) +
+        ", misses: " + std::to_string(cache->misses()) + ")\n";
+  }
+  // Report which expressions were compiled and why others were rejected.
+  for (const auto* generators : {&enrolled_code_generators_,
+                                 &parameter_variant_code_generators_}) {
+    for (const auto& generator : *generators) {
+      std::string summary = generator->GetExplainSummary();
+      if (!summary.empty()) {
+        explain_string_ += "; " + summary + "\n";
+      }
+    }
+  }
   // This is called only when EXPLAIN CODEGEN. Because we don't want to compile
   // at this time, we need to call CodegenUtils::Optimize to "optimize" LLVM IR.
   codegen_utils_->Optimize(gpcodegen::CodegenUtils::OptimizationLevel(
@@ -121,4 +437,11 @@ void CodegenManager::AccumulateExplainString() {
                            false);
   llvm::raw_string_ostream out(explain_string_);
   codegen_utils_->PrintUnderlyingModules(out);
+  if (!parameter_variant_code_generators_.empty()) {
+    parameter_variant_codegen_utils_->Optimize(
+        gpcodegen::CodegenUtils::OptimizationLevel(codegen_optimization_level),
+        gpcodegen::CodegenUtils::SizeLevel::kNormal,
+        false);
+    parameter_variant_codegen_utils_->PrintUnderlyingModules(out);
+  }
 }
@@ -0,0 +1,93 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    codegen_module_cache.cc
+//
+//  @doc:
+//    Implementation of the per-backend cache of compiled codegen modules
+//
+//---------------------------------------------------------------------------
+#include <assert.h>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "codegen/codegen_config.h"
+#include "codegen/codegen_module_cache.h"
+#include "codegen/utils/gp_codegen_utils.h"
+
+using gpcodegen::CodegenModuleCache;
+using gpcodegen::GpCodegenUtils;
+
+CodegenModuleCache::CodegenModuleCache()
+    : hits_(0), misses_(0) {
+}
+
+CodegenModuleCache::~CodegenModuleCache() {
+  Clear();
+}
+
+CodegenModuleCache* CodegenModuleCache::GetInstance() {
+  // Never destroyed: compiled modules must not be torn down after LLVM's own
+  // static state at backend exit.
+  static CodegenModuleCache* instance = new CodegenModuleCache();
+  return instance;
+}
+
+std::unique_ptr<GpCodegenUtils> CodegenModuleCache::Checkout(
+    const std::string& fingerprint,
+    std::vector<std::string>* function_names) {
+  assert(nullptr != function_names);
+  auto it = index_.find(fingerprint);
+  if (it == index_.end()) {
+    misses_++;
+    return nullptr;
+  }
+  hits_++;
+  std::list<Entry>::iterator entry = it->second;
+  index_.erase(it);
+  std::unique_ptr<GpCodegenUtils> codegen_utils =
+      std::move(entry->codegen_utils);
+  *function_names = std::move(entry->function_names);
+  entries_.erase(entry);
+  return codegen_utils;
+}
+
+void CodegenModuleCache::Checkin(
+    const std::string& fingerprint,
+    std::unique_ptr<GpCodegenUtils> codegen_utils,
+    std::vector<std::string> function_names) {
+  assert(nullptr != codegen_utils);
+  if (codegen_module_cache_size <= 0) {
+    Clear();
+    return;
+  }
+  entries_.push_front(Entry{fingerprint,
+                            std::move(codegen_utils),
+                            std::move(function_names)});
+  index_.emplace(fingerprint, entries_.begin());
+  EvictTo(codegen_module_cache_size);
+}
+
+void CodegenModuleCache::Clear() {
+  EvictTo(0);
+}
+
+void CodegenModuleCache::EvictTo(std::size_t max_entries) {
+  while (entries_.size() > max_entries) {
+    std::list<Entry>::iterator victim = std::prev(entries_.end());
+    auto range = index_.equal_range(victim->fingerprint);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second == victim) {
+        index_.erase(it);
+        break;
+      }
+    }
+    entries_.erase(victim);
+  }
+}
@@ -24,10 +24,15 @@
 #include "codegen/expr_tree_generator.h"
 #include "codegen/utils/gp_codegen_utils.h"
 #include "codegen/advance_aggregates_codegen.h"
+#include "codegen/advance_aggregates_batch_codegen.h"
+#include "codegen/calc_hash_value_codegen.h"
+#include "codegen/exec_hash_get_hash_value_codegen.h"
+#include "codegen/tupsort_compare_datum_codegen.h"
 
 extern "C" {
 #include "lib/stringinfo.h"
 #include "postgres.h"  // NOLINT(build/include)
+#include "utils/resowner.h"
 }
 
 using gpcodegen::CodegenManager;
@@ -35,10 +40,31 @@ using gpcodegen::BaseCodegen;
 using gpcodegen::ExecVariableListCodegen;
 using gpcodegen::ExecEvalExprCodegen;
 using gpcodegen::AdvanceAggregatesCodegen;
+using gpcodegen::AdvanceAggregatesBatchCodegen;
+using gpcodegen::ExecHashGetHashValueCodegen;
+using gpcodegen::CalcHashValueCodegen;
+using gpcodegen::TupsortCompareDatumCodegen;
 
 // Current code generator manager that oversees all code generators
 static void* ActiveCodeGeneratorManager = nullptr;
 
+// true once AbortBackgroundCompilationCallback() is registered
+static bool abort_callback_registered = false;
+
+// The executor does not end its nodes, and so does not destroy their
+// managers, when a transaction aborts. Join the background compilation
+// thread from here instead, so that it neither outlives the query nor keeps
+// the later managers from compiling in the background.
+static void AbortBackgroundCompilationCallback(ResourceReleasePhase phase,
+                                               bool isCommit,
+                                               bool isTopLevel,
+                                               void* arg) {
+  if (phase != RESOURCE_RELEASE_AFTER_LOCKS || isCommit) {
+    return;
+  }
+  CodegenManager::AbortBackgroundCompilation();
+}
+
 // Perform global set-up tasks for code generation. Returns 0 on
 // success, nonzero on error.
 unsigned int InitCodegen() {
@@ -49,6 +75,11 @@ void* CodeGeneratorManagerCreate(const char* module_name) {
   if (!codegen) {
     return nullptr;
   }
+  if (!abort_callback_registered) {
+    RegisterResourceReleaseCallback(AbortBackgroundCompilationCallback,
+                                    nullptr);
+    abort_callback_registered = true;
+  }
   return new CodegenManager(module_name);
 }
 
@@ -67,9 +98,19 @@ unsigned int CodeGeneratorManagerPrepareGeneratedFunctions(void* manager) {
 }
 
 unsigned int CodeGeneratorManagerNotifyParameterChange(void* manager) {
-  // parameter change notification is not supported yet
-  assert(false);
-  return 0;
+  if (!codegen || nullptr == manager) {
+    return 0;
+  }
+  return static_cast<CodegenManager*>(manager)->NotifyParameterChange();
+}
+
+unsigned int CodeGeneratorManagerSwapInCompiledFunctions(void* manager) {
+  // Not gated by the codegen guc, which may have been turned off after the
+  // compilation was started.
+  if (nullptr == manager) {
+    return 0;
+  }
+  return static_cast<CodegenManager*>(manager)->SwapInCompiledFunctions();
 }
 
 void CodeGeneratorManagerAccumulateExplainString(void* manager) {
@@ -91,6 +132,17 @@ char* CodeGeneratorManagerGetExplainString(void* manager) {
   return return_string->data;
 }
 
+void CodeGeneratorManagerGetTimes(void* manager, CodegenTimes* times) {
+  assert(nullptr != times);
+  // Not gated by the codegen guc, like CodeGeneratorManagerDestroy().
+  if (nullptr == manager) {
+    times->generate = 0;
+    times->compile = 0;
+    return;
+  }
+  static_cast<CodegenManager*>(manager)->GetTimes(times);
+}
+
 void CodeGeneratorManagerDestroy(void* manager) {
   delete (static_cast<CodegenManager*>(manager));
 }
@@ -132,6 +184,7 @@ void* ExecVariableListCodegenEnroll(
   ExecVariableListCodegen* generator =
       CodegenManager::CreateAndEnrollGenerator<ExecVariableListCodegen>(
           manager,
+          CodegenFuncLifespan_Parameter_Invariant,
           regular_func_ptr,
           ptr_to_chosen_func_ptr,
           proj_info,
@@ -150,6 +203,9 @@ void* ExecEvalExprCodegenEnroll(
   ExecEvalExprCodegen* generator =
       CodegenManager::CreateAndEnrollGenerator<ExecEvalExprCodegen>(
           manager,
+          ExecEvalExprCodegen::DependsOnParameters(exprstate) ?
+              CodegenFuncLifespan_Parameter_Variant :
+              CodegenFuncLifespan_Parameter_Invariant,
           regular_func_ptr,
           ptr_to_chosen_func_ptr,
           exprstate,
@@ -167,9 +223,80 @@ void* AdvanceAggregatesCodegenEnroll(
   AdvanceAggregatesCodegen* generator =
       CodegenManager::CreateAndEnrollGenerator<AdvanceAggregatesCodegen>(
           manager,
+          CodegenFuncLifespan_Parameter_Invariant,
+          regular_func_ptr,
+          ptr_to_chosen_func_ptr,
+          aggstate);
+  return generator;
+}
+
+void* AdvanceAggregatesBatchCodegenEnroll(
+    AdvanceAggregatesBatchFn regular_func_ptr,
+    AdvanceAggregatesBatchFn* ptr_to_chosen_func_ptr,
+    AggState *aggstate) {
+  CodegenManager* manager = static_cast<CodegenManager*>(
+      GetActiveCodeGeneratorManager());
+  AdvanceAggregatesBatchCodegen* generator =
+      CodegenManager::CreateAndEnrollGenerator<AdvanceAggregatesBatchCodegen>(
+          manager,
+          CodegenFuncLifespan_Parameter_Invariant,
           regular_func_ptr,
           ptr_to_chosen_func_ptr,
           aggstate);
   return generator;
 }
 
+
+void* ExecHashGetHashValueCodegenEnroll(
+    ExecHashGetHashValueFn regular_func_ptr,
+    ExecHashGetHashValueFn* ptr_to_chosen_func_ptr,
+    List *hashkeys,
+    List *hash_operators,
+    bool outer_tuple) {
+  CodegenManager* manager = static_cast<CodegenManager*>(
+      GetActiveCodeGeneratorManager());
+  ExecHashGetHashValueCodegen* generator =
+      CodegenManager::CreateAndEnrollGenerator<ExecHashGetHashValueCodegen>(
+          manager,
+          CodegenFuncLifespan_Parameter_Invariant,
+          regular_func_ptr,
+          ptr_to_chosen_func_ptr,
+          hashkeys,
+          hash_operators,
+          outer_tuple);
+  return generator;
+}
+
+void* CalcHashValueCodegenEnroll(
+    CalcHashValueFn regular_func_ptr,
+    CalcHashValueFn* ptr_to_chosen_func_ptr,
+    AggState *aggstate) {
+  CodegenManager* manager = static_cast<CodegenManager*>(
+      GetActiveCodeGeneratorManager());
+  CalcHashValueCodegen* generator =
+      CodegenManager::CreateAndEnrollGenerator<CalcHashValueCodegen>(
+          manager,
+          CodegenFuncLifespan_Parameter_Invariant,
+          regular_func_ptr,
+          ptr_to_chosen_func_ptr,
+          aggstate);
+  return generator;
+}
+
+void* TupsortCompareDatumCodegenEnroll(
+    TupsortCompareDatumFn regular_func_ptr,
+    TupsortCompareDatumFn* ptr_to_chosen_func_ptr,
+    int nkeys,
+    Oid *sort_operators) {
+  CodegenManager* manager = static_cast<CodegenManager*>(
+      GetActiveCodeGeneratorManager());
+  TupsortCompareDatumCodegen* generator =
+      CodegenManager::CreateAndEnrollGenerator<TupsortCompareDatumCodegen>(
+          manager,
+          CodegenFuncLifespan_Parameter_Invariant,
+          regular_func_ptr,
+          ptr_to_chosen_func_ptr,
+          nkeys,
+          sort_operators);
+  return generator;
+}
@@ -34,7 +34,9 @@ extern "C" {
 #include "nodes/execnodes.h"
 #include "utils/elog.h"
 #include "executor/tuptable.h"
+#include "nodes/nodeFuncs.h"
 #include "nodes/nodes.h"
+#include "nodes/primnodes.h"
 }
 
 namespace llvm {
@@ -48,6 +50,27 @@ using gpcodegen::SlotGetAttrCodegen;
 
 constexpr char ExecEvalExprCodegen::kExecEvalExprPrefix[];
 
+namespace {
+
+bool ContainsParamWalker(Node* node, void* context) {
+  if (nullptr == node) {
+    return false;
+  }
+  if (IsA(node, Param)) {
+    return true;
+  }
+  return expression_tree_walker(
+      node, reinterpret_cast<bool (*)()>(ContainsParamWalker), context);
+}
+
+}  // namespace
+
+bool ExecEvalExprCodegen::DependsOnParameters(const ExprState* exprstate) {
+  assert(nullptr != exprstate);
+  return ContainsParamWalker(reinterpret_cast<Node*>(exprstate->expr),
+                             nullptr);
+}
+
 ExecEvalExprCodegen::ExecEvalExprCodegen(
     CodegenManager* manager,
     ExecEvalExprFn regular_func_ptr,
@@ -69,11 +92,28 @@ bool ExecEvalExprCodegen::InitDependencies() {
   OpExprTreeGenerator::InitializeSupportedFunction();
   ExprTreeGenerator::VerifyAndCreateExprTree(
         exprstate_, &gen_info_, &expr_tree_generator_);
-  // Prepare dependent slot_getattr() generation
-  PrepareSlotGetAttr();
+  // Prepare dependent slot_getattr() generation. A parameter variant
+  // expression is generated into a different module than the shared
+  // slot_getattr(), so it calls the regular one instead.
+  if (!DependsOnParameters(exprstate_)) {
+    PrepareSlotGetAttr();
+  }
   return true;
 }
 
+std::string ExecEvalExprCodegen::GetExplainSummary() const {
+  std::string summary = std::string(kExecEvalExprPrefix) + "(" +
+      ExprTreeGenerator::GetExprName(exprstate_->expr) + "): ";
+  if (IsGenerated()) {
+    return summary + "compiled";
+  }
+  if (nullptr == expr_tree_generator_) {
+    return summary + "rejected (" + (gen_info_.rejection_reason.empty() ?
+        "unsupported expression" : gen_info_.rejection_reason) + ")";
+  }
+  return summary + "generation failed";
+}
+
 void ExecEvalExprCodegen::PrepareSlotGetAttr() {
   TupleTableSlot* slot = nullptr;
   assert(nullptr != plan_state_);
@@ -0,0 +1,264 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    exec_hash_get_hash_value_codegen.cc
+//
+//  @doc:
+//    Generates code for ExecHashGetHashValue function.
+//
+//---------------------------------------------------------------------------
+#include <assert.h>
+#include <cstdint>
+#include <vector>
+
+#include "codegen/exec_hash_get_hash_value_codegen.h"
+#include "codegen/pg_hash_func_generator.h"
+#include "codegen/utils/gp_codegen_utils.h"
+#include "codegen/utils/utility.h"
+
+#include "llvm/IR/IRBuilder.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "executor/executor.h"
+#include "executor/nodeHash.h"
+#include "nodes/execnodes.h"
+#include "nodes/pg_list.h"
+#include "nodes/primnodes.h"
+#include "utils/elog.h"
+#include "utils/lsyscache.h"
+}
+
+namespace llvm {
+class BasicBlock;
+class Function;
+class Value;
+}  // namespace llvm
+
+using gpcodegen::ExecHashGetHashValueCodegen;
+using gpcodegen::PGHashFuncGenerator;
+
+constexpr char ExecHashGetHashValueCodegen::kExecHashGetHashValuePrefix[];
+
+namespace {
+
+// Generation-time information about one hash key
+struct HashKeyInfo {
+  Var* var;
+  Oid hash_func_oid;
+  bool is_strict;
+};
+
+}  // namespace
+
+ExecHashGetHashValueCodegen::ExecHashGetHashValueCodegen(
+    CodegenManager* manager,
+    ExecHashGetHashValueFn regular_func_ptr,
+    ExecHashGetHashValueFn* ptr_to_regular_func_ptr,
+    List* hashkeys,
+    List* hash_operators,
+    bool outer_tuple)
+: BaseCodegen(manager,
+              kExecHashGetHashValuePrefix,
+              regular_func_ptr,
+              ptr_to_regular_func_ptr),
+              hashkeys_(hashkeys),
+              hash_operators_(hash_operators),
+              outer_tuple_(outer_tuple) {
+}
+
+bool ExecHashGetHashValueCodegen::GenerateExecHashGetHashValue(
+    gpcodegen::GpCodegenUtils* codegen_utils) {
+  assert(nullptr != codegen_utils);
+  static_assert(sizeof(Datum) == sizeof(int64_t),
+      "sizeof(Datum) doesn't match sizeof(int64)");
+
+  if (NIL == hashkeys_ ||
+      list_length(hashkeys_) != list_length(hash_operators_)) {
+    elog(DEBUG1, "Cannot generate code for ExecHashGetHashValue "
+                 "because hash keys and operators do not match.");
+    return false;
+  }
+
+  // Resolve, like ExecHashTableCreate, the hash function and strictness of
+  // every key.
+  std::vector<HashKeyInfo> key_infos;
+  ListCell* lc_key;
+  ListCell* lc_op;
+  forboth(lc_key, hashkeys_, lc_op, hash_operators_) {
+    ExprState* keyexpr = reinterpret_cast<ExprState*>(lfirst(lc_key));
+    Oid hashop = lfirst_oid(lc_op);
+    RegProcedure left_hashfn;
+    RegProcedure right_hashfn;
+
+    if (nullptr == keyexpr->expr || !IsA(keyexpr->expr, Var)) {
+      elog(DEBUG1, "Cannot generate code for ExecHashGetHashValue "
+                   "because a hash key is not a plain Var.");
+      return false;
+    }
+    Var* var = reinterpret_cast<Var*>(keyexpr->expr);
+    if (var->varattno <= 0) {
+      elog(DEBUG1, "Cannot generate code for ExecHashGetHashValue "
+                   "because of system attribute %d.", var->varattno);
+      return false;
+    }
+    if (!get_op_hash_functions(hashop, &left_hashfn, &right_hashfn)) {
+      elog(DEBUG1, "Cannot generate code for ExecHashGetHashValue "
+                   "because hash operator %u has no hash function.", hashop);
+      return false;
+    }
+    Oid hash_func_oid = outer_tuple_ ? left_hashfn : right_hashfn;
+    if (!PGHashFuncGenerator::IsSupported(hash_func_oid)) {
+      elog(DEBUG1, "Cannot generate code for ExecHashGetHashValue "
+                   "because hash function %u is not supported.",
+                   hash_func_oid);
+      return false;
+    }
+    key_infos.push_back({var, hash_func_oid, op_strict(hashop)});
+  }
+
+  llvm::Function* exec_hash_get_hash_value_func =
+      CreateFunction<ExecHashGetHashValueFn>(
+          codegen_utils, GetUniqueFuncName());
+
+  auto irb = codegen_utils->ir_builder();
+
+  // External functions
+  llvm::Function* llvm_slot_getattr =
+      codegen_utils->GetOrRegisterExternalFunction(slot_getattr_regular,
+                                                   "slot_getattr_regular");
+  llvm::Function* llvm_ResetExprContext =
+      codegen_utils->GetOrRegisterExternalFunction(ResetExprContext,
+                                                   "ResetExprContext");
+
+  // BasicBlocks
+  llvm::BasicBlock* entry_block = codegen_utils->CreateBasicBlock(
+      "entry", exec_hash_get_hash_value_func);
+  llvm::BasicBlock* main_block = codegen_utils->CreateBasicBlock(
+      "main", exec_hash_get_hash_value_func);
+  llvm::BasicBlock* fallback_block = codegen_utils->CreateBasicBlock(
+      "fallback", exec_hash_get_hash_value_func);
+
+  // Generation-time constants
+  llvm::Value* llvm_hashkeys = codegen_utils->GetConstant(hashkeys_);
+  llvm::Value* llvm_true = codegen_utils->GetConstant<bool>(true);
+
+  // Function arguments to ExecHashGetHashValue
+  llvm::Value* llvm_econtext_arg =
+      ArgumentByPosition(exec_hash_get_hash_value_func, 2);
+  llvm::Value* llvm_hashkeys_arg =
+      ArgumentByPosition(exec_hash_get_hash_value_func, 3);
+  llvm::Value* llvm_keep_nulls_arg =
+      ArgumentByPosition(exec_hash_get_hash_value_func, 5);
+  llvm::Value* llvm_hashvalue_arg =
+      ArgumentByPosition(exec_hash_get_hash_value_func, 6);
+  llvm::Value* llvm_hashkeys_null_arg =
+      ArgumentByPosition(exec_hash_get_hash_value_func, 7);
+
+  // Entry block
+  // -----------
+  irb->SetInsertPoint(entry_block);
+#ifdef CODEGEN_DEBUG
+  EXPAND_CREATE_ELOG(codegen_utils,
+                     DEBUG1,
+                     "Codegen'ed ExecHashGetHashValue called!");
+#endif
+  irb->CreateCondBr(
+      irb->CreateICmpEQ(llvm_hashkeys, llvm_hashkeys_arg),
+      main_block /* true */,
+      fallback_block /* false */);
+
+  // Main block
+  // ----------
+  irb->SetInsertPoint(main_block);
+  irb->CreateCall(llvm_ResetExprContext, {llvm_econtext_arg});
+
+  llvm::Value* llvm_isnull_ptr =
+      irb->CreateAlloca(codegen_utils->GetType<bool>(), nullptr, "isnull");
+  llvm::Value* llvm_hashkey = codegen_utils->GetConstant<uint32_t>(0);
+  llvm::Value* llvm_result = llvm_true;
+  llvm::Value* llvm_hashkeys_null = llvm_true;
+  // A null key of a strict operator rejects the tuple unless keep_nulls
+  llvm::Value* llvm_reject_nulls = irb->CreateNot(llvm_keep_nulls_arg);
+
+  for (const HashKeyInfo& key_info : key_infos) {
+    // hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+    llvm_hashkey = irb->CreateOr(irb->CreateShl(llvm_hashkey, 1),
+                                 irb->CreateLShr(llvm_hashkey, 31));
+
+    // Pick the slot the same way ExecEvalScalarVar does
+    llvm::Value* llvm_slot = nullptr;
+    switch (key_info.var->varno) {
+      case INNER:
+        llvm_slot = irb->CreateLoad(codegen_utils->GetPointerToMember(
+            llvm_econtext_arg, &ExprContext::ecxt_innertuple));
+        break;
+      case OUTER:
+        llvm_slot = irb->CreateLoad(codegen_utils->GetPointerToMember(
+            llvm_econtext_arg, &ExprContext::ecxt_outertuple));
+        break;
+      default:
+        llvm_slot = irb->CreateLoad(codegen_utils->GetPointerToMember(
+            llvm_econtext_arg, &ExprContext::ecxt_scantuple));
+        break;
+    }
+
+    llvm::Value* llvm_keyval = irb->CreateCall(llvm_slot_getattr, {
+        llvm_slot,
+        codegen_utils->GetConstant<int32_t>(key_info.var->varattno),
+        llvm_isnull_ptr});
+    llvm::Value* llvm_isnull = irb->CreateLoad(llvm_isnull_ptr);
+    llvm_hashkeys_null = irb->CreateAnd(llvm_hashkeys_null, llvm_isnull);
+
+    // if (!isNull && result) hashkey ^= hash(keyval);
+    // The hash of a garbage Datum is computed without side effects, so a
+    // select is cheaper than branching on isnull.
+    llvm::Value* llvm_hkey = PGHashFuncGenerator::GenerateHashDatum(
+        codegen_utils, key_info.hash_func_oid, llvm_keyval);
+    assert(nullptr != llvm_hkey);
+    llvm_hashkey = irb->CreateSelect(
+        irb->CreateAnd(irb->CreateNot(llvm_isnull), llvm_result),
+        irb->CreateXor(llvm_hashkey, llvm_hkey),
+        llvm_hashkey);
+
+    if (key_info.is_strict) {
+      // if (isNull && !keep_nulls) result = false;
+      llvm_result = irb->CreateAnd(
+          llvm_result,
+          irb->CreateNot(irb->CreateAnd(llvm_isnull, llvm_reject_nulls)));
+    }
+  }
+
+  irb->CreateStore(llvm_hashkeys_null, llvm_hashkeys_null_arg);
+  irb->CreateStore(llvm_hashkey, llvm_hashvalue_arg);
+  irb->CreateRet(llvm_result);
+
+  // Fall back Block
+  // ---------------
+  irb->SetInsertPoint(fallback_block);
+  EXPAND_CREATE_ELOG(codegen_utils,
+                     DEBUG1,
+                     "Falling back to regular ExecHashGetHashValue");
+
+  codegen_utils->CreateFallback<ExecHashGetHashValueFn>(
+      codegen_utils->GetOrRegisterExternalFunction(ExecHashGetHashValue,
+                                                   "ExecHashGetHashValue"),
+      exec_hash_get_hash_value_func);
+
+  return true;
+}
+
+bool ExecHashGetHashValueCodegen::GenerateCodeInternal(
+    GpCodegenUtils* codegen_utils) {
+  bool isGenerated = GenerateExecHashGetHashValue(codegen_utils);
+
+  if (isGenerated) {
+    elog(DEBUG1, "ExecHashGetHashValue was generated successfully!");
+    return true;
+  } else {
+    elog(DEBUG1, "ExecHashGetHashValue generation failed!");
+    return false;
+  }
+}
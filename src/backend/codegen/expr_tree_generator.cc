@@ -11,10 +11,18 @@
 //---------------------------------------------------------------------------
 #include <cassert>
 #include <memory>
+#include <string>
 
+#include "codegen/bool_expr_tree_generator.h"
+#include "codegen/case_expr_tree_generator.h"
+#include "codegen/case_test_expr_tree_generator.h"
 #include "codegen/const_expr_tree_generator.h"
 #include "codegen/expr_tree_generator.h"
+#include "codegen/null_test_expr_tree_generator.h"
 #include "codegen/op_expr_tree_generator.h"
+#include "codegen/param_expr_tree_generator.h"
+#include "codegen/relabel_type_expr_tree_generator.h"
+#include "codegen/scalar_array_op_expr_tree_generator.h"
 #include "codegen/var_expr_tree_generator.h"
 
 extern "C" {
@@ -35,10 +43,14 @@ bool ExprTreeGenerator::VerifyAndCreateExprTree(
          nullptr != expr_tree);
 
   if (!(IsA(expr_state, FuncExprState) ||
-      IsA(expr_state, ExprState))) {
-    elog(DEBUG1, "Input expression state type (%d) is not supported",
-         expr_state->type);
-    return false;
+      IsA(expr_state, ExprState) ||
+      IsA(expr_state, BoolExprState) ||
+      IsA(expr_state, CaseExprState) ||
+      IsA(expr_state, NullTestState) ||
+      IsA(expr_state, ScalarArrayOpExprState) ||
+      IsA(expr_state, GenericExprState))) {
+    return Reject(gen_info, "expression state type " +
+                  std::to_string(expr_state->type) + " is not supported");
   }
   expr_tree->reset(nullptr);
   bool supported_expr_tree = false;
@@ -58,13 +70,86 @@ bool ExprTreeGenerator::VerifyAndCreateExprTree(
           expr_state, gen_info, expr_tree);
       break;
     }
+    case T_Param: {
+      supported_expr_tree = ParamExprTreeGenerator::VerifyAndCreateExprTree(
+          expr_state, gen_info, expr_tree);
+      break;
+    }
+    case T_BoolExpr: {
+      supported_expr_tree = BoolExprTreeGenerator::VerifyAndCreateExprTree(
+          expr_state, gen_info, expr_tree);
+      break;
+    }
+    case T_CaseExpr: {
+      supported_expr_tree = CaseExprTreeGenerator::VerifyAndCreateExprTree(
+          expr_state, gen_info, expr_tree);
+      break;
+    }
+    case T_CaseTestExpr: {
+      supported_expr_tree =
+          CaseTestExprTreeGenerator::VerifyAndCreateExprTree(
+              expr_state, gen_info, expr_tree);
+      break;
+    }
+    case T_NullTest: {
+      supported_expr_tree =
+          NullTestExprTreeGenerator::VerifyAndCreateExprTree(
+              expr_state, gen_info, expr_tree);
+      break;
+    }
+    case T_ScalarArrayOpExpr: {
+      supported_expr_tree =
+          ScalarArrayOpExprTreeGenerator::VerifyAndCreateExprTree(
+              expr_state, gen_info, expr_tree);
+      break;
+    }
+    case T_RelabelType: {
+      supported_expr_tree =
+          RelabelTypeExprTreeGenerator::VerifyAndCreateExprTree(
+              expr_state, gen_info, expr_tree);
+      break;
+    }
     default : {
-      supported_expr_tree = false;
-      elog(DEBUG1, "Unsupported expression tree %d found",
-           nodeTag(expr_state->expr));
+      supported_expr_tree = Reject(
+          gen_info, GetExprName(expr_state->expr) + " is not supported");
     }
   }
   assert((!supported_expr_tree && nullptr == expr_tree->get()) ||
          (supported_expr_tree && nullptr != expr_tree->get()));
   return supported_expr_tree;
 }
+
+bool ExprTreeGenerator::Reject(ExprTreeGeneratorInfo* gen_info,
+                               const std::string& reason) {
+  assert(nullptr != gen_info);
+  elog(DEBUG1, "Cannot generate code for expression: %s", reason.c_str());
+  if (gen_info->rejection_reason.empty()) {
+    gen_info->rejection_reason = reason;
+  }
+  return false;
+}
+
+std::string ExprTreeGenerator::GetExprName(const Expr* expr) {
+  assert(nullptr != expr);
+  switch (nodeTag(expr)) {
+    case T_Var: return "Var";
+    case T_Const: return "Const";
+    case T_Param: return "Param";
+    case T_Aggref: return "Aggref";
+    case T_FuncExpr: return "FuncExpr";
+    case T_OpExpr: return "OpExpr";
+    case T_DistinctExpr: return "DistinctExpr";
+    case T_ScalarArrayOpExpr: return "ScalarArrayOpExpr";
+    case T_BoolExpr: return "BoolExpr";
+    case T_SubPlan: return "SubPlan";
+    case T_RelabelType: return "RelabelType";
+    case T_CoerceViaIO: return "CoerceViaIO";
+    case T_CaseExpr: return "CaseExpr";
+    case T_CaseTestExpr: return "CaseTestExpr";
+    case T_CoalesceExpr: return "CoalesceExpr";
+    case T_NullIfExpr: return "NullIfExpr";
+    case T_NullTest: return "NullTest";
+    case T_BooleanTest: return "BooleanTest";
+    default: return "node type " + std::to_string(nodeTag(expr));
+  }
+}
@@ -0,0 +1,169 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    advance_aggregates_batch_codegen.h
+//
+//  @doc:
+//    Headers for AdvanceAggregatesBatch codegen.
+//
+//---------------------------------------------------------------------------
+
+#ifndef GPCODEGEN_ADVANCE_AGGREGATES_BATCH_CODEGEN_H_  // NOLINT(build/header_guard)
+#define GPCODEGEN_ADVANCE_AGGREGATES_BATCH_CODEGEN_H_
+
+#include <functional>
+#include <vector>
+
+#include "codegen/base_codegen.h"
+#include "codegen/codegen_wrapper.h"
+
+namespace llvm {
+class BasicBlock;
+class Function;
+class Value;
+}  // namespace llvm
+
+namespace gpcodegen {
+
+/** \addtogroup gpcodegen
+ *  @{
+ */
+
+class AdvanceAggregatesBatchCodegen
+    : public BaseCodegen<AdvanceAggregatesBatchFn> {
+ public:
+  /**
+   * @brief Constructor
+   *
+   * @param regular_func_ptr        Regular version of the target function.
+   * @param ptr_to_chosen_func_ptr  Reference to the function pointer that the
+   *                                caller will call.
+   * @param aggstate                The AggState to use for generating code.
+   *
+   * @note 	The ptr_to_chosen_func_ptr can refer to either the generated
+   *        function or the corresponding regular version.
+   *
+   **/
+  explicit AdvanceAggregatesBatchCodegen(
+      CodegenManager* manager,
+      AdvanceAggregatesBatchFn regular_func_ptr,
+      AdvanceAggregatesBatchFn* ptr_to_regular_func_ptr,
+      AggState *aggstate);
+
+  virtual ~AdvanceAggregatesBatchCodegen() = default;
+
+  /**
+   * @brief Check if the generated loops handle an aggregate.
+   *
+   * @param peraggstate The per-aggregate state of the aggregate.
+   *
+   * @return true if the aggregate gets its own loop; the other aggregates are
+   *         advanced by calling advance_aggregate_batch().
+   **/
+  static bool IsSupportedAggregate(struct AggStatePerAggData* peraggstate);
+
+ protected:
+  /**
+   * @brief Generate code for advance_aggregates_batch.
+   *
+   * @param codegen_utils
+   *
+   * @return true on successful generation; false otherwise.
+   *
+   * Each aggregate is advanced with a loop over its input column that keeps
+   * the running transition value in registers and handles NULL inputs with
+   * selects instead of branches, so that LLVM can vectorize it. Only count,
+   * sum(int4), min/max(int4/int8) and avg(int4/float8) get such a loop, the
+   * other aggregates of the node call the regular advance_aggregate_batch().
+   * Nothing is generated if no aggregate of the node gets a loop.
+   */
+  bool GenerateCodeInternal(gpcodegen::GpCodegenUtils* codegen_utils) final;
+
+ private:
+  /**
+   * @brief Generates the body of one loop iteration.
+   *
+   * Given the Datum and null flag of the current row, updates the given
+   * accumulators in place.
+   **/
+  typedef std::function<void(llvm::Value* llvm_value,
+                             llvm::Value* llvm_isnull,
+                             std::vector<llvm::Value*>* llvm_accs)> LoopBodyFn;
+
+  AggState *aggstate_;
+
+  static constexpr char kAdvanceAggregatesBatchPrefix[] =
+      "AdvanceAggregatesBatch";
+
+  /**
+   * @brief Generates runtime code that implements advance_aggregates_batch.
+   *
+   * @param codegen_utils Utility to ease the code generation process.
+   * @return true on successful generation.
+   **/
+  bool GenerateAdvanceAggregatesBatch(gpcodegen::GpCodegenUtils* codegen_utils);
+
+  /**
+   * @brief Generates the code that advances one aggregate for the batch.
+   *
+   * @param codegen_utils Utility to ease the code generation process.
+   * @param aggno ith aggregate function
+   * @param llvm_pergroupstate Pointer to the aggregate's AggStatePerGroupData
+   * @param llvm_values Pointer to the aggregate's column of input values
+   * @param llvm_isnull Pointer to the aggregate's column of null flags
+   * @param llvm_nrows Number of rows in the batch, as int64
+   * @param overflow_block Block to branch to after reporting an overflow
+   *
+   * @return true on successful generation; false otherwise.
+   **/
+  bool GenerateAdvanceAggregate(gpcodegen::GpCodegenUtils* codegen_utils,
+                                int aggno,
+                                llvm::Value* llvm_pergroupstate,
+                                llvm::Value* llvm_values,
+                                llvm::Value* llvm_isnull,
+                                llvm::Value* llvm_nrows,
+                                llvm::BasicBlock* overflow_block);
+
+  /**
+   * @brief Generates a call to advance_aggregate_batch() that advances one
+   *        aggregate for the batch with the regular code.
+   *
+   * @param codegen_utils Utility to ease the code generation process.
+   * @param aggno ith aggregate function
+   * @param llvm_pergroupstate Pointer to the aggregate's AggStatePerGroupData
+   * @param llvm_values Pointer to the aggregate's column of input values
+   * @param llvm_isnull Pointer to the aggregate's column of null flags
+   * @param llvm_nrows Number of rows in the batch, as int64
+   **/
+  void GenerateRegularAdvanceAggregate(gpcodegen::GpCodegenUtils* codegen_utils,
+                                       int aggno,
+                                       llvm::Value* llvm_pergroupstate,
+                                       llvm::Value* llvm_values,
+                                       llvm::Value* llvm_isnull,
+                                       llvm::Value* llvm_nrows);
+
+  /**
+   * @brief Generates a loop over the rows of the batch.
+   *
+   * @param codegen_utils Utility to ease the code generation process.
+   * @param llvm_values Pointer to the column of input values
+   * @param llvm_isnull Pointer to the column of null flags
+   * @param llvm_nrows Number of rows in the batch, as int64
+   * @param body Generates the update of the accumulators for one row
+   * @param llvm_accs Initial values of the accumulators on input, their values
+   *        after the last row on output
+   **/
+  void GenerateColumnLoop(gpcodegen::GpCodegenUtils* codegen_utils,
+                          llvm::Value* llvm_values,
+                          llvm::Value* llvm_isnull,
+                          llvm::Value* llvm_nrows,
+                          const LoopBodyFn& body,
+                          std::vector<llvm::Value*>* llvm_accs);
+};
+
+/** @} */
+
+}  // namespace gpcodegen
+#endif  // GPCODEGEN_ADVANCE_AGGREGATES_BATCH_CODEGEN_H_
@@ -53,10 +53,10 @@ class AdvanceAggregatesCodegen: public BaseCodegen<AdvanceAggregatesFn> {
    *
    * @return true on successful generation; false otherwise.
    *
-   * This implementation does not support percentile and ordered aggregates.
-   *
-   * If at execution time, we see any of the above types of attributes,
-   * we fall backs to the regular function.
+   * Transition functions without a generator, as well as those of
+   * percentile functions, are called through fmgr for the current row.
+   * DISTINCT and ORDER BY aggregates are supported when they have a single
+   * input; otherwise we fall back to the regular function.
    *
    */
   bool GenerateCodeInternal(gpcodegen::GpCodegenUtils* codegen_utils) final;
@@ -96,6 +96,24 @@ class AdvanceAggregatesCodegen: public BaseCodegen<AdvanceAggregatesFn> {
       int aggno,
       gpcodegen::PGFuncGeneratorInfo* pg_func_info,
       llvm::Value* llvm_mem_manager_arg);
+
+  /**
+   * @brief Generates runtime code that puts the input of a DISTINCT and/or
+   * ORDER BY aggregate with a single input into its sorter.
+   *
+   * @param codegen_utils Utility to ease the code generation process.
+   * @param aggno ith aggregate function
+   * @param llvm_in_args Evaluated inputs, starting at position 1
+   * @param llvm_in_args_isNull Null flags of the inputs, starting at
+   *        position 1
+   * @param end_advance_aggregate_block LLVM block to continue with
+   */
+  void GenerateAdvanceOrderedAggregate(
+      gpcodegen::GpCodegenUtils* codegen_utils,
+      int aggno,
+      const std::vector<llvm::Value*>& llvm_in_args,
+      const std::vector<llvm::Value*>& llvm_in_args_isNull,
+      llvm::BasicBlock* end_advance_aggregate_block);
 };
 
 /** @} */
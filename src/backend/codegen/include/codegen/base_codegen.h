@@ -100,13 +100,18 @@ class BaseCodegen: public CodegenInterface {
   }
 
   bool SetToGenerated(gpcodegen::GpCodegenUtils* codegen_utils) final {
+    return SetToGenerated(codegen_utils, GetUniqueFuncName());
+  }
+
+  bool SetToGenerated(gpcodegen::GpCodegenUtils* codegen_utils,
+                      const std::string& func_name) final {
     if (false == IsGenerated()) {
       assert(*ptr_to_chosen_func_ptr_ == regular_func_ptr_);
       return false;
     }
 
     FuncPtrType compiled_func_ptr = codegen_utils->GetFunctionPointer<
-        FuncPtrType>(GetUniqueFuncName());
+        FuncPtrType>(func_name);
 
     if (nullptr != compiled_func_ptr) {
       *ptr_to_chosen_func_ptr_ = compiled_func_ptr;
@@ -131,6 +136,10 @@ class BaseCodegen: public CodegenInterface {
     return is_generated_;
   }
 
+  std::string GetExplainSummary() const override {
+    return "";
+  }
+
   /**
    * @return Regular version of the target function.
    *
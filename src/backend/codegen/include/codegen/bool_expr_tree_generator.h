@@ -0,0 +1,75 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    bool_expr_tree_generator.h
+//
+//  @doc:
+//    Object that generate code for AND, OR and NOT expressions.
+//
+//---------------------------------------------------------------------------
+#ifndef GPCODEGEN_BOOL_EXPR_TREE_GENERATOR_H_  // NOLINT(build/header_guard)
+#define GPCODEGEN_BOOL_EXPR_TREE_GENERATOR_H_
+
+#include <memory>
+#include <vector>
+
+#include "codegen/expr_tree_generator.h"
+
+#include "llvm/IR/Value.h"
+
+namespace gpcodegen {
+
+/** \addtogroup gpcodegen
+ *  @{
+ */
+
+/**
+ * @brief Object that generate code for AND, OR and NOT expressions.
+ *
+ * @note AND and OR short-circuit in the same order as ExecEvalAnd and
+ *       ExecEvalOr, and follow SQL's three-valued logic for NULL arguments.
+ **/
+class BoolExprTreeGenerator : public ExprTreeGenerator {
+ public:
+  static bool VerifyAndCreateExprTree(
+      const ExprState* expr_state,
+      ExprTreeGeneratorInfo* gen_info,
+      std::unique_ptr<ExprTreeGenerator>* expr_tree);
+
+  bool GenerateCode(gpcodegen::GpCodegenUtils* codegen_utils,
+                    const ExprTreeGeneratorInfo& gen_info,
+                    llvm::Value** llvm_out_value,
+                    llvm::Value* const llvm_isnull_ptr) final;
+
+ protected:
+  /**
+   * @brief Constructor.
+   *
+   * @param expr_state Expression state
+   * @param arguments Arguments of the boolean expression
+   **/
+  BoolExprTreeGenerator(
+      const ExprState* expr_state,
+      std::vector<
+          std::unique_ptr<
+              ExprTreeGenerator>>&& arguments);  // NOLINT(build/c++11)
+
+ private:
+  /**
+   * @brief Generate code for AND (is_and = true) or OR (is_and = false).
+   **/
+  bool GenerateAndOr(gpcodegen::GpCodegenUtils* codegen_utils,
+                     const ExprTreeGeneratorInfo& gen_info,
+                     bool is_and,
+                     llvm::Value** llvm_out_value,
+                     llvm::Value* const llvm_isnull_ptr);
+
+  std::vector<std::unique_ptr<ExprTreeGenerator>> arguments_;
+};
+
+/** @} */
+}  // namespace gpcodegen
+
+#endif  // GPCODEGEN_BOOL_EXPR_TREE_GENERATOR_H_
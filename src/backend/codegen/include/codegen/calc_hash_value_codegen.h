@@ -0,0 +1,82 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    calc_hash_value_codegen.h
+//
+//  @doc:
+//    Headers for calc_hash_value codegen.
+//
+//---------------------------------------------------------------------------
+
+#ifndef GPCODEGEN_CALCHASHVALUE_CODEGEN_H_  // NOLINT(build/header_guard)
+#define GPCODEGEN_CALCHASHVALUE_CODEGEN_H_
+
+#include "codegen/base_codegen.h"
+#include "codegen/codegen_wrapper.h"
+
+namespace gpcodegen {
+
+/** \addtogroup gpcodegen
+ *  @{
+ */
+
+class CalcHashValueCodegen: public BaseCodegen<CalcHashValueFn> {
+ public:
+  /**
+   * @brief Constructor
+   *
+   * @param regular_func_ptr        Regular version of the target function.
+   * @param ptr_to_chosen_func_ptr  Reference to the function pointer that the
+   *                                caller will call.
+   * @param aggstate                The AggState of a hashed Agg node.
+   *
+   * @note 	The ptr_to_chosen_func_ptr can refer to either the generated
+   *        function or the corresponding regular version.
+   *
+   **/
+  explicit CalcHashValueCodegen(
+      CodegenManager* manager,
+      CalcHashValueFn regular_func_ptr,
+      CalcHashValueFn* ptr_to_regular_func_ptr,
+      AggState *aggstate);
+
+  virtual ~CalcHashValueCodegen() = default;
+
+ protected:
+  /**
+   * @brief Generate code for calc_hash_value.
+   *
+   * @param codegen_utils
+   *
+   * @return true on successful generation; false otherwise.
+   *
+   * The generated function unrolls the loop over the grouping columns and
+   * inlines their hash functions instead of calling them through the fmgr.
+   * The per-column hash keys are then combined with hash_any, exactly like
+   * the regular version does, so that both versions agree on every hash value.
+   *
+   * This implementation only supports grouping columns whose hash function
+   * can be inlined (see PGHashFuncGenerator).
+   */
+  bool GenerateCodeInternal(gpcodegen::GpCodegenUtils* codegen_utils) final;
+
+ private:
+  AggState *aggstate_;
+
+  static constexpr char kCalcHashValuePrefix[] = "calc_hash_value";
+
+  /**
+   * @brief Generates runtime code that implements calc_hash_value.
+   *
+   * @param codegen_utils Utility to ease the code generation process.
+   * @return true on successful generation.
+   **/
+  bool GenerateCalcHashValue(gpcodegen::GpCodegenUtils* codegen_utils);
+};
+
+/** @} */
+
+}  // namespace gpcodegen
+#endif  // GPCODEGEN_CALCHASHVALUE_CODEGEN_H_
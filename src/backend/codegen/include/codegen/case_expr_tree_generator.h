@@ -0,0 +1,75 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    case_expr_tree_generator.h
+//
+//  @doc:
+//    Object that generate code for CASE expression.
+//
+//---------------------------------------------------------------------------
+#ifndef GPCODEGEN_CASE_EXPR_TREE_GENERATOR_H_  // NOLINT(build/header_guard)
+#define GPCODEGEN_CASE_EXPR_TREE_GENERATOR_H_
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "codegen/expr_tree_generator.h"
+
+#include "llvm/IR/Value.h"
+
+namespace gpcodegen {
+
+/** \addtogroup gpcodegen
+ *  @{
+ */
+
+/**
+ * @brief Object that generate code for CASE expression.
+ *
+ * @note As in ExecEvalCase, the value of the test expression (if any) is
+ *       stored in econtext->caseValue_datum for CaseTestExpr placeholders,
+ *       and the previous value is restored before evaluating the result.
+ **/
+class CaseExprTreeGenerator : public ExprTreeGenerator {
+ public:
+  static bool VerifyAndCreateExprTree(
+      const ExprState* expr_state,
+      ExprTreeGeneratorInfo* gen_info,
+      std::unique_ptr<ExprTreeGenerator>* expr_tree);
+
+  bool GenerateCode(gpcodegen::GpCodegenUtils* codegen_utils,
+                    const ExprTreeGeneratorInfo& gen_info,
+                    llvm::Value** llvm_out_value,
+                    llvm::Value* const llvm_isnull_ptr) final;
+
+ protected:
+  using WhenClause = std::pair<std::unique_ptr<ExprTreeGenerator>,
+                               std::unique_ptr<ExprTreeGenerator>>;
+
+  /**
+   * @brief Constructor.
+   *
+   * @param expr_state Expression state
+   * @param arg Test expression, nullptr if there is none
+   * @param when_clauses Condition and result of each WHEN clause
+   * @param default_result ELSE expression, nullptr if there is none
+   **/
+  CaseExprTreeGenerator(
+      const ExprState* expr_state,
+      std::unique_ptr<ExprTreeGenerator> arg,
+      std::vector<WhenClause>&& when_clauses,  // NOLINT(build/c++11)
+      std::unique_ptr<ExprTreeGenerator> default_result);
+
+ private:
+  std::unique_ptr<ExprTreeGenerator> arg_;
+  std::vector<WhenClause> when_clauses_;
+  std::unique_ptr<ExprTreeGenerator> default_result_;
+};
+
+/** @} */
+}  // namespace gpcodegen
+
+#endif  // GPCODEGEN_CASE_EXPR_TREE_GENERATOR_H_
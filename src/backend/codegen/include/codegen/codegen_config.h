@@ -21,11 +21,18 @@ extern bool codegen_exec_variable_list;
 extern bool codegen_slot_getattr;
 extern bool codegen_exec_eval_expr;
 extern bool codegen_advance_aggregate;
+extern bool codegen_advance_aggregates_batch;
+extern bool codegen_exec_hash_get_hash_value;
+extern bool codegen_calc_hash_value;
+extern bool codegen_tupsort_compare_datum;
 // TODO(shardikar): Retire this GUC after performing experiments to find the
 // tradeoff of codegen-ing slot_getattr() (potentially by measuring the
 // difference in the number of instructions) when one of the first few
 // attributes is varlen.
 extern int codegen_varlen_tolerance;
+extern int codegen_module_cache_size;
+extern int codegen_max_parameter_regenerations;
+extern bool codegen_async_compile;
 }
 
 namespace gpcodegen {
@@ -39,6 +46,10 @@ class ExecVariableListCodegen;
 class SlotGetAttrCodegen;
 class ExecEvalExprCodegen;
 class AdvanceAggregatesCodegen;
+class AdvanceAggregatesBatchCodegen;
+class ExecHashGetHashValueCodegen;
+class CalcHashValueCodegen;
+class TupsortCompareDatumCodegen;
 
 class CodegenConfig {
  public:
@@ -73,6 +84,26 @@ inline bool CodegenConfig::IsGeneratorEnabled<AdvanceAggregatesCodegen>() {
   return codegen_advance_aggregate;
 }
 
+template<>
+inline bool CodegenConfig::IsGeneratorEnabled<AdvanceAggregatesBatchCodegen>() {
+  return codegen_advance_aggregates_batch;
+}
+
+template<>
+inline bool CodegenConfig::IsGeneratorEnabled<ExecHashGetHashValueCodegen>() {
+  return codegen_exec_hash_get_hash_value;
+}
+
+template<>
+inline bool CodegenConfig::IsGeneratorEnabled<CalcHashValueCodegen>() {
+  return codegen_calc_hash_value;
+}
+
+template<>
+inline bool CodegenConfig::IsGeneratorEnabled<TupsortCompareDatumCodegen>() {
+  return codegen_tupsort_compare_datum;
+}
+
 
 /** @} */
 
@@ -66,6 +66,20 @@ class CodegenInterface {
    **/
   virtual bool SetToGenerated(gpcodegen::GpCodegenUtils* codegen_utils) = 0;
 
+  /**
+   * @brief Sets up the caller to use the named compiled function instead of
+   *        the regular version.
+   *
+   * @param codegen_utils Facilitates in obtaining the function pointer from
+   *        the compiled module.
+   * @param func_name Name of the compiled function. This differs from
+   *        GetUniqueFuncName() when the module was compiled for an earlier
+   *        generator that produced identical code.
+   * @return true on successfully setting to generated functions
+   **/
+  virtual bool SetToGenerated(gpcodegen::GpCodegenUtils* codegen_utils,
+                              const std::string& func_name) = 0;
+
   /**
    * @brief Resets the state of the generator, including reverting back to
    *        the regular version of the function.
@@ -92,6 +106,13 @@ class CodegenInterface {
    **/
   virtual bool IsGenerated() const = 0;
 
+  /**
+   * @return One line summary of the generator shown by EXPLAIN CODEGEN, or
+   *         an empty string if there is nothing to report.
+   *
+   **/
+  virtual std::string GetExplainSummary() const = 0;
+
  protected:
   /**
    * @brief	Utility function to construct a unique function name from the
@@ -13,6 +13,9 @@
 #ifndef GPCODEGEN_CODEGEN_MANAGER_H_  // NOLINT(build/header_guard)
 #define GPCODEGEN_CODEGEN_MANAGER_H_
 
+#include <pthread.h>
+
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <string>
@@ -46,7 +49,12 @@ class CodegenManager {
    **/
   explicit CodegenManager(const std::string& module_name);
 
-  ~CodegenManager() = default;
+  /**
+   * @brief Destructor. Waits for any background compilation and returns the
+   *        compiled module to the module cache (see codegen_module_cache_size)
+   *        so that later queries with identical generated code can reuse it.
+   **/
+  ~CodegenManager();
 
   /**
    * @brief Template function to facilitate enroll for any type of
@@ -58,6 +66,8 @@ class CodegenManager {
    * @tparam Args Variable argument that ClassType will take in its constructor
    *
    * @param manager Current Codegen Manager
+   * @param funcLifespan Life span of the generated function, see
+   *                     EnrollCodeGenerator()
    * @param regular_func_ptr Regular version of the target function.
    * @param ptr_to_chosen_func_ptr Pointer to the function pointer that the
    *                               caller will call.
@@ -78,6 +88,7 @@ class CodegenManager {
   template <typename ClassType, typename FuncType, typename ...Args>
   static ClassType* CreateAndEnrollGenerator(
       CodegenManager* manager,
+      CodegenFuncLifespan funcLifespan,
       FuncType regular_func_ptr,
       FuncType* ptr_to_chosen_func_ptr,
       Args&&... args) {  // NOLINT(build/c++11)
@@ -102,8 +113,7 @@ class CodegenManager {
         regular_func_ptr,
         ptr_to_chosen_func_ptr,
         std::forward<Args>(args)...);
-    bool is_enrolled = manager->EnrollCodeGenerator(
-        CodegenFuncLifespan_Parameter_Invariant, generator);
+    bool is_enrolled = manager->EnrollCodeGenerator(funcLifespan, generator);
     assert(is_enrolled);
     return generator;
   }
@@ -113,6 +123,12 @@ class CodegenManager {
    *
    * @note Manager manages the memory of enrolled generator.
    *
+   * @note Parameter variant generators are generated into a separate module
+   *       that is regenerated on every NotifyParameterChange(), so that they
+   *       can specialize on the current parameter values. They must not call
+   *       functions generated by parameter invariant generators, which live
+   *       in a different module.
+   *
    * @param funcLifespan Life span of the enrolling generator. Based on life span,
    *                     corresponding GpCodegenUtils will be used for code generation
    * @param generator    Generator that needs to be enrolled with manager.
@@ -132,23 +148,70 @@ class CodegenManager {
    * @brief Compile all the generated functions. On success,
    *        a pointer to the generated method becomes available to the caller.
    *
+   * @note If the module cache is enabled and a module with identical code was
+   *       compiled by an earlier manager in this backend, that module is
+   *       reused instead of compiling again.
+   *
+   * @note If codegen_async_compile is set, machine code for the parameter
+   *       invariant functions is generated on a background thread, and
+   *       callers keep using the regular functions until
+   *       SwapInCompiledFunctions() finds the compilation finished.
+   *
    * @return The number of enrolled codegen that successully generated code
    *         and 0 on failure
    **/
   unsigned int PrepareGeneratedFunctions();
 
+  /**
+   * @brief Set up generators to use their compiled functions if this
+   *        manager's background compilation has finished. Never blocks.
+   *
+   * @note  This is meant to be called by the executor between tuples, so
+   *        that the background thread never writes to executor state and a
+   *        function pointer never changes in the middle of a call.
+   *
+   * @return The number of generators that were set up.
+   **/
+  unsigned int SwapInCompiledFunctions();
+
+  /**
+   * @return true if a background compilation was started and its functions
+   *         were not swapped in yet.
+   **/
+  bool HasPendingCompilation() const {
+    return has_compilation_thread_;
+  }
+
+  /**
+   * @brief Block until the background compilation of the backend, if any, has
+   *        finished, and give up on its functions.
+   *
+   * @note  Called when a transaction aborts, since the manager that owns the
+   *        thread is then never destroyed.
+   **/
+  static void AbortBackgroundCompilation();
+
   /**
    * @brief 	Notifies the manager of a parameter change.
    *
    * @note 	This is called during a ReScan or other parameter change process.
-   * 			Upon receiving this notification the manager may invalidate all the
-   * 			generated code that depend on parameters.
+   * 			Upon receiving this notification the manager reverts all parameter
+   * 			variant generators to the regular functions and, unless they were
+   * 			already regenerated codegen_max_parameter_regenerations times,
+   * 			generates and compiles them again for the new parameter values.
+   * 			Parameter invariant functions are left untouched.
    *
+   * @return The number of parameter variant generators that are using
+   *         regenerated functions.
    **/
-  void NotifyParameterChange();
+  unsigned int NotifyParameterChange();
 
   /**
-   * @brief Invalidate all generated functions.
+   * @brief Invalidate all generated functions, reverting every enrolled
+   *        generator to the regular version of its target function.
+   *
+   * @note  The compiled invariant module is kept alive until the manager is
+   *        destroyed, since it may be cached for later queries.
    *
    * @return true if successfully invalidated.
    **/
@@ -158,7 +221,8 @@ class CodegenManager {
    * @return Number of enrolled generators.
    **/
   size_t GetEnrollmentCount() {
-    return enrolled_code_generators_.size();
+    return enrolled_code_generators_.size() +
+        parameter_variant_code_generators_.size();
   }
 
   /*
@@ -172,18 +236,142 @@ class CodegenManager {
    */
   const std::string& GetExplainString();
 
+  /**
+   * @brief Fill in the time spent generating and compiling code so far,
+   *        including regenerations after parameter changes and a finished
+   *        background compilation.
+   *
+   * @param times Time in milliseconds for each phase.
+   **/
+  void GetTimes(CodegenTimes* times) const;
+
  private:
+  /**
+   * @return true if compiled modules are shared across queries.
+   **/
+  static bool IsModuleCacheEnabled() {
+    return codegen_module_cache_size > 0;
+  }
+
+  /**
+   * @return Fingerprint of the generated module and optimization level,
+   *         computed on first use after GenerateCode().
+   **/
+  const std::string& GetModuleFingerprint();
+
+  /**
+   * @brief Try to take a module with identical code from the module cache and
+   *        set up all generators to use its compiled functions.
+   *
+   * @param success_count Set to the number of generators that were set up.
+   * @return true on a cache hit.
+   **/
+  bool PrepareCachedFunctions(unsigned int* success_count);
+
+  /**
+   * @brief Compile the parameter variant module and set up the parameter
+   *        variant generators to use its functions.
+   *
+   * @return The number of parameter variant generators that were set up.
+   **/
+  unsigned int PrepareParameterVariantFunctions();
+
+  /**
+   * @brief Set up the parameter invariant generators to use the functions of
+   *        the compiled module, and record their names for the module cache.
+   *
+   * @param is_relocatable true if the module may be cached.
+   * @return The number of generators that were set up.
+   **/
+  unsigned int SetToCompiledFunctions(bool is_relocatable);
+
+  /**
+   * @brief Start generating machine code for the parameter invariant module
+   *        on a background thread, unless another manager of the backend
+   *        already has one running.
+   *
+   * @return true if the thread was started.
+   **/
+  bool StartBackgroundCompilation();
+
+  /**
+   * @brief Block until the background compilation, if any, has finished.
+   **/
+  void WaitForBackgroundCompilation();
+
+  /**
+   * @brief Entry point of the background compilation thread.
+   *
+   * @param manager The CodegenManager whose module is compiled.
+   **/
+  static void* CompileInBackground(void* manager);
+
+  /**
+   * @return A fresh GpCodegenUtils for the parameter variant generators.
+   **/
+  std::unique_ptr<gpcodegen::GpCodegenUtils> CreateParameterVariantUtils();
+
   // GpCodegenUtils provides a facade to LLVM subsystem.
   std::unique_ptr<gpcodegen::GpCodegenUtils> codegen_utils_;
 
   std::string module_name_;
 
-  // List of all enrolled code generators.
+  // GpCodegenUtils of the parameter variant generators, replaced on every
+  // parameter change.
+  std::unique_ptr<gpcodegen::GpCodegenUtils> parameter_variant_codegen_utils_;
+
+  // List of all enrolled parameter invariant code generators.
   std::vector<std::unique_ptr<CodegenInterface>> enrolled_code_generators_;
 
+  // List of all enrolled parameter variant code generators.
+  std::vector<std::unique_ptr<CodegenInterface>>
+      parameter_variant_code_generators_;
+
+  // Number of parameter changes notified so far.
+  int parameter_change_count_;
+
   // Holds the dumped IR of all underlying modules for EXPLAIN CODEGEN queries
   std::string explain_string_;
 
+  // Fingerprint of the generated module, used as the module cache key.
+  std::string module_fingerprint_;
+
+  // Names of the compiled functions in enrollment order (empty for generators
+  // that did not generate), recorded for the module cache.
+  std::vector<std::string> compiled_function_names_;
+
+  // true if the module was compiled relocatable and at least one function
+  // was successfully set up, so it can be returned to the module cache.
+  bool is_cacheable_;
+
+  // Thread generating machine code for codegen_utils_, valid while
+  // has_compilation_thread_ is set. Only the background thread touches
+  // codegen_utils_ until it is joined.
+  pthread_t compilation_thread_;
+  bool has_compilation_thread_;
+
+  // true if the module compiled in the background may be cached.
+  bool is_compilation_relocatable_;
+
+  // Set by the background thread once it is done with codegen_utils_.
+  std::atomic<bool> is_compilation_done_;
+
+  // Result of the background compilation, valid once is_compilation_done_ is
+  // set.
+  bool is_compilation_successful_;
+
+  // Milliseconds spent in GenerateCode() and in regenerating the parameter
+  // variant functions.
+  double generate_time_ms_;
+
+  // Milliseconds the backend spent compiling and setting up compiled
+  // functions, or taking them from the module cache.
+  double compile_time_ms_;
+
+  // Milliseconds the background thread spent generating machine code, valid
+  // once is_compilation_done_ is set.
+  double background_compile_time_ms_;
+
   DISALLOW_COPY_AND_ASSIGN(CodegenManager);
 };
 
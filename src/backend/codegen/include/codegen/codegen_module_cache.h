@@ -0,0 +1,143 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    codegen_module_cache.h
+//
+//  @doc:
+//    Per-backend cache of compiled codegen modules, shared across queries
+//
+//---------------------------------------------------------------------------
+
+#ifndef GPCODEGEN_CODEGEN_MODULE_CACHE_H_  // NOLINT(build/header_guard)
+#define GPCODEGEN_CODEGEN_MODULE_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "codegen/utils/macros.h"
+
+namespace gpcodegen {
+
+/** \addtogroup gpcodegen
+ *  @{
+ */
+
+// Forward declaration of GpCodegenUtils that holds a compiled module
+class GpCodegenUtils;
+
+/**
+ * @brief Cache of compiled modules that outlives the CodegenManager that
+ *        compiled them.
+ *
+ * Entries are keyed by the fingerprint of the module (see
+ * CodegenUtils::GetModuleFingerprint()). A CodegenManager checks a module
+ * out on a hit, rebinds its external variables to its own runtime objects and
+ * checks it back in when it is destroyed, so that an entry is never used by
+ * two managers at the same time. The cache keeps at most
+ * codegen_module_cache_size idle modules, evicting the least recently checked
+ * in ones.
+ **/
+class CodegenModuleCache {
+ public:
+  /**
+   * @return The cache of the current backend.
+   **/
+  static CodegenModuleCache* GetInstance();
+
+  /**
+   * @brief Take a compiled module with the given fingerprint out of the cache.
+   *
+   * @param fingerprint    Fingerprint of the module to look for.
+   * @param function_names Set to the names of the compiled functions, in
+   *                       enrollment order of the generators that compiled
+   *                       them (empty for generators that failed).
+   * @return The compiled module, or nullptr on a miss.
+   **/
+  std::unique_ptr<GpCodegenUtils> Checkout(
+      const std::string& fingerprint,
+      std::vector<std::string>* function_names);
+
+  /**
+   * @brief Return a compiled module to the cache, making it available to
+   *        later queries.
+   *
+   * @param fingerprint    Fingerprint of the module before compilation.
+   * @param codegen_utils  Relocatable compiled module.
+   * @param function_names Names of the compiled functions, in enrollment
+   *                       order.
+   **/
+  void Checkin(const std::string& fingerprint,
+               std::unique_ptr<GpCodegenUtils> codegen_utils,
+               std::vector<std::string> function_names);
+
+  /**
+   * @return true if a compiled module with the given fingerprint is
+   *         available, without taking it out or counting a hit or miss.
+   **/
+  bool Contains(const std::string& fingerprint) const {
+    return index_.find(fingerprint) != index_.end();
+  }
+
+  /**
+   * @return Number of idle modules held by the cache.
+   **/
+  std::size_t size() const {
+    return entries_.size();
+  }
+
+  /**
+   * @return Number of successful checkouts in this backend.
+   **/
+  std::uint64_t hits() const {
+    return hits_;
+  }
+
+  /**
+   * @return Number of failed checkouts in this backend.
+   **/
+  std::uint64_t misses() const {
+    return misses_;
+  }
+
+  /**
+   * @brief Drop all idle modules.
+   **/
+  void Clear();
+
+ private:
+  struct Entry {
+    std::string fingerprint;
+    std::unique_ptr<GpCodegenUtils> codegen_utils;
+    std::vector<std::string> function_names;
+  };
+
+  CodegenModuleCache();
+
+  ~CodegenModuleCache();
+
+  // Evict least recently checked in entries until at most max_entries remain.
+  void EvictTo(std::size_t max_entries);
+
+  // Idle entries, most recently checked in first.
+  std::list<Entry> entries_;
+
+  // Fingerprint to entries. Structurally identical nodes of the same plan may
+  // check in several modules with the same fingerprint.
+  std::unordered_multimap<std::string, std::list<Entry>::iterator> index_;
+
+  std::uint64_t hits_;
+  std::uint64_t misses_;
+
+  DISALLOW_COPY_AND_ASSIGN(CodegenModuleCache);
+};
+
+/** @} */
+
+}  // namespace gpcodegen
+#endif  // GPCODEGEN_CODEGEN_MODULE_CACHE_H_
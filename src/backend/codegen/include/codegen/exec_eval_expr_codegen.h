@@ -51,6 +51,21 @@ class ExecEvalExprCodegen: public BaseCodegen<ExecEvalExprFn> {
 
   bool InitDependencies() override;
 
+  /**
+   * @return Whether the expression was compiled, or why it was rejected.
+   **/
+  std::string GetExplainSummary() const override;
+
+  /**
+   * @brief Check if an expression refers to any parameter.
+   *
+   * @param exprstate The ExprState of the expression.
+   *
+   * @return true if the generated function has to be enrolled with
+   *         CodegenFuncLifespan_Parameter_Variant.
+   **/
+  static bool DependsOnParameters(const ExprState* exprstate);
+
  protected:
   /**
    * @brief Generate code for expression evaluation.
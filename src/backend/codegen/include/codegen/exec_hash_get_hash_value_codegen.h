@@ -0,0 +1,94 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    exec_hash_get_hash_value_codegen.h
+//
+//  @doc:
+//    Headers for ExecHashGetHashValue codegen.
+//
+//---------------------------------------------------------------------------
+
+#ifndef GPCODEGEN_EXECHASHGETHASHVALUE_CODEGEN_H_  // NOLINT(build/header_guard)
+#define GPCODEGEN_EXECHASHGETHASHVALUE_CODEGEN_H_
+
+#include "codegen/base_codegen.h"
+#include "codegen/codegen_wrapper.h"
+
+namespace gpcodegen {
+
+/** \addtogroup gpcodegen
+ *  @{
+ */
+
+class ExecHashGetHashValueCodegen
+    : public BaseCodegen<ExecHashGetHashValueFn> {
+ public:
+  /**
+   * @brief Constructor
+   *
+   * @param regular_func_ptr        Regular version of the target function.
+   * @param ptr_to_chosen_func_ptr  Reference to the function pointer that the
+   *                                caller will call.
+   * @param hashkeys                List of ExprStates of the hash keys.
+   * @param hash_operators          List of Oids of the hash join operators.
+   * @param outer_tuple             true if the keys are those of the outer
+   *                                side of the join.
+   *
+   * @note 	The ptr_to_chosen_func_ptr can refer to either the generated
+   *        function or the corresponding regular version.
+   *
+   **/
+  explicit ExecHashGetHashValueCodegen(
+      CodegenManager* manager,
+      ExecHashGetHashValueFn regular_func_ptr,
+      ExecHashGetHashValueFn* ptr_to_regular_func_ptr,
+      List* hashkeys,
+      List* hash_operators,
+      bool outer_tuple);
+
+  virtual ~ExecHashGetHashValueCodegen() = default;
+
+ protected:
+  /**
+   * @brief Generate code for ExecHashGetHashValue.
+   *
+   * @param codegen_utils
+   *
+   * @return true on successful generation; false otherwise.
+   *
+   * The generated function unrolls the loop over the hash keys, fetches each
+   * key straight from its slot and inlines the hash function of the join
+   * operator. Strictness of the operators is resolved at generation time.
+   *
+   * This implementation only supports hash keys that are plain Vars of a type
+   * whose hash function can be inlined (see PGHashFuncGenerator). Since such
+   * keys never allocate memory, the generated function does not switch to
+   * the per-tuple memory context.
+   *
+   * If at execution time the function is called for a different list of
+   * hash keys, we fall back to the regular function.
+   */
+  bool GenerateCodeInternal(gpcodegen::GpCodegenUtils* codegen_utils) final;
+
+ private:
+  List* hashkeys_;
+  List* hash_operators_;
+  bool outer_tuple_;
+
+  static constexpr char kExecHashGetHashValuePrefix[] = "ExecHashGetHashValue";
+
+  /**
+   * @brief Generates runtime code that implements ExecHashGetHashValue.
+   *
+   * @param codegen_utils Utility to ease the code generation process.
+   * @return true on successful generation.
+   **/
+  bool GenerateExecHashGetHashValue(gpcodegen::GpCodegenUtils* codegen_utils);
+};
+
+/** @} */
+
+}  // namespace gpcodegen
+#endif  // GPCODEGEN_EXECHASHGETHASHVALUE_CODEGEN_H_
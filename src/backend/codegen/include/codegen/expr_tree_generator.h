@@ -39,7 +39,14 @@ namespace gpcodegen {
 enum class ExprTreeNodeType {
   kConst = 0,
   kVar = 1,
-  kOperator = 2
+  kOperator = 2,
+  kParam = 3,
+  kBoolExpr = 4,
+  kCase = 5,
+  kCaseTest = 6,
+  kNullTest = 7,
+  kScalarArrayOp = 8,
+  kRelabel = 9
 };
 
 /**
@@ -73,6 +80,10 @@ struct ExprTreeGeneratorInfo {
   // pointer to the external function otherwise.
   llvm::Function* llvm_slot_getattr_func;
 
+  // Why the ExprTreeGenerator::VerifyAndCreateExprTree pass rejected the
+  // expression, if it did. Keeps the innermost (i.e. first) reason.
+  std::string rejection_reason;
+
   ExprTreeGeneratorInfo(
     ExprContext* econtext,
     llvm::Function* llvm_main_func,
@@ -106,6 +117,22 @@ class ExprTreeGenerator {
       ExprTreeGeneratorInfo* gen_info,
       std::unique_ptr<ExprTreeGenerator>* expr_tree);
 
+  /**
+   * @brief Record the reason why an expression tree cannot be generated.
+   *
+   * @param gen_info    Information needed for generating the expression tree.
+   * @param reason      Human readable reason, shown in EXPLAIN CODEGEN.
+   *
+   * @return false, so that callers can return its result directly.
+   **/
+  static bool Reject(ExprTreeGeneratorInfo* gen_info,
+                     const std::string& reason);
+
+  /**
+   * @return Readable name of the type of the given expression node.
+   **/
+  static std::string GetExprName(const Expr* expr);
+
   /**
    * @brief Generate the code for given expression.
    *
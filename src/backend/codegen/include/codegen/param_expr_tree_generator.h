@@ -0,0 +1,57 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    param_expr_tree_generator.h
+//
+//  @doc:
+//    Object that generate code for param expression.
+//
+//---------------------------------------------------------------------------
+#ifndef GPCODEGEN_PARAM_EXPR_TREE_GENERATOR_H_  // NOLINT(build/header_guard)
+#define GPCODEGEN_PARAM_EXPR_TREE_GENERATOR_H_
+
+#include "codegen/expr_tree_generator.h"
+
+#include "llvm/IR/Value.h"
+
+namespace gpcodegen {
+
+/** \addtogroup gpcodegen
+ *  @{
+ */
+
+/**
+ * @brief Object that generate code for param expression.
+ *
+ * @note The current value of the parameter is embedded into the generated
+ *       code as a constant, so the enclosing generator must be enrolled with
+ *       CodegenFuncLifespan_Parameter_Variant to be regenerated whenever the
+ *       parameter changes.
+ **/
+class ParamExprTreeGenerator : public ExprTreeGenerator {
+ public:
+  static bool VerifyAndCreateExprTree(
+      const ExprState* expr_state,
+      ExprTreeGeneratorInfo* gen_info,
+      std::unique_ptr<ExprTreeGenerator>* expr_tree);
+
+  bool GenerateCode(gpcodegen::GpCodegenUtils* codegen_utils,
+                    const ExprTreeGeneratorInfo& gen_info,
+                    llvm::Value** llvm_out_value,
+                    llvm::Value* const llvm_isnull_ptr) final;
+
+ protected:
+  /**
+   * @brief Constructor.
+   *
+   * @param expr_state Expression state from epxression tree
+   **/
+  explicit ParamExprTreeGenerator(const ExprState* expr_state);
+};
+
+/** @} */
+}  // namespace gpcodegen
+
+#endif  // GPCODEGEN_PARAM_EXPR_TREE_GENERATOR_H_
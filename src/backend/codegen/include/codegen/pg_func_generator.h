@@ -499,9 +499,11 @@ class PGGenericFuncGenerator : public  PGFuncGeneratorInterface {
     // function's execution
     llvm::Value* llvm_func_generation_tmp_value = nullptr;
     // Generate code for the built-in function
-    this->func_ptr_(codegen_utils,
-                    pg_processed_func_info,
-                    &llvm_func_generation_tmp_value);
+    if (!this->func_ptr_(codegen_utils,
+                         pg_processed_func_info,
+                         &llvm_func_generation_tmp_value)) {
+      return false;
+    }
     // Keep track of the last created block during execution of the built-in
     // function. This will be used as an incoming edge to the phi node.
     llvm::BasicBlock* func_generation_last_block = irb->GetInsertBlock();
@@ -0,0 +1,83 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    pg_hash_func_generator.h
+//
+//  @doc:
+//    Static generators for the hash support functions of fixed length types
+//
+//---------------------------------------------------------------------------
+#ifndef GPCODEGEN_PG_HASH_FUNC_GENERATOR_H_  // NOLINT(build/header_guard)
+#define GPCODEGEN_PG_HASH_FUNC_GENERATOR_H_
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+}
+
+namespace llvm {
+class Value;
+}  // namespace llvm
+
+namespace gpcodegen {
+
+/** \addtogroup gpcodegen
+ *  @{
+ */
+
+class GpCodegenUtils;
+
+/**
+ * @brief Class with static member functions that inline the hash support
+ *        functions (hashint4, hashint8, ...) used by hash join and hash
+ *        aggregation.
+ **/
+class PGHashFuncGenerator {
+ public:
+  /**
+   * @param hash_func_oid Oid of the hash support function
+   *
+   * @return true if GenerateHashDatum can inline the given hash function.
+   **/
+  static bool IsSupported(Oid hash_func_oid);
+
+  /**
+   * @brief Create instructions that compute the same uint32 value as calling
+   *        the given hash function on a not null Datum.
+   *
+   * @param codegen_utils Utility to easy code generation.
+   * @param hash_func_oid Oid of the hash support function
+   * @param llvm_datum    Datum to hash
+   *
+   * @return llvm value of the 32 bit hash, or nullptr if the function is not
+   *         supported.
+   **/
+  static llvm::Value* GenerateHashDatum(GpCodegenUtils* codegen_utils,
+                                        Oid hash_func_oid,
+                                        llvm::Value* llvm_datum);
+
+  /**
+   * @brief Create instructions for hash_uint32.
+   *
+   * @param codegen_utils Utility to easy code generation.
+   * @param llvm_key      32 bit key to hash
+   *
+   * @return llvm value of the 32 bit hash.
+   **/
+  static llvm::Value* GenerateHashUInt32(GpCodegenUtils* codegen_utils,
+                                         llvm::Value* llvm_key);
+
+ private:
+  /**
+   * @brief Create instructions for the rot() macro of hashfunc.c
+   **/
+  static llvm::Value* GenerateRotate(GpCodegenUtils* codegen_utils,
+                                     llvm::Value* llvm_value,
+                                     int k);
+};
+
+/** @} */
+}  // namespace gpcodegen
+
+#endif  // GPCODEGEN_PG_HASH_FUNC_GENERATOR_H_
@@ -16,14 +16,18 @@
 #include "codegen/utils/gp_codegen_utils.h"
 #include "codegen/pg_func_generator.h"
 #include "codegen/pg_func_generator_interface.h"
+#include "codegen/pg_text_func_generator.h"
 
 #include "llvm/IR/Constant.h"
 #include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/InstrTypes.h"
 #include "llvm/IR/Value.h"
 
 extern "C" {
 #include "postgres.h"  // NOLINT(build/include)
 #include "c.h"  // NOLINT(build/include)
+#include "catalog/pg_type.h"
+#include "utils/array.h"
 #include "utils/numeric.h"
 }
 
@@ -65,6 +69,26 @@ class PGNumericFuncGenerator {
       const gpcodegen::PGFuncGeneratorInfo& pg_func_info,
       llvm::Value** llvm_out_value);
 
+  /**
+   * @brief  Create LLVM instructions for float8_accum and float4_accum, the
+   *         transition functions of the float variance and stddev
+   *         aggregates. Like the regular functions do when called by an
+   *         aggregate node, the float8[3] transition array {N, sum(X),
+   *         sum(X*X)} is updated in place.
+   *
+   * @tparam CType              Data type of input argument.
+   * @param  codegen_utils      Utility for easy code generation.
+   * @param  pg_func_info       Details for pgfunc generation
+   * @param  llvm_out_value     Variable to keep the result
+   *
+   * @return true if generation was successful otherwise return false.
+   **/
+  template<typename CType>
+  static bool GenerateFloatAccum(
+      gpcodegen::GpCodegenUtils* codegen_utils,
+      const gpcodegen::PGFuncGeneratorInfo& pg_func_info,
+      llvm::Value** llvm_out_value);
+
   /**
    * @brief Create LLVM instructions for intfloat_avg_amalg_demalg function,
    *        which is called by int8_avg_amalg and float8_avg_amalg
@@ -81,6 +105,25 @@ class PGNumericFuncGenerator {
       const gpcodegen::PGFuncGeneratorInfo& pg_func_info,
       llvm::Value** llvm_out_value);
 
+  /**
+   * @brief Create LLVM instructions for numeric_eq, numeric_ne, numeric_lt,
+   *        numeric_le, numeric_gt and numeric_ge, i.e.
+   *        (cmp_numerics(arg0, arg1) <pred> 0).
+   *
+   * @tparam pred               Predicate applied on the result of
+   *                            cmp_numerics.
+   * @param  codegen_utils      Utility for easy code generation.
+   * @param  pg_func_info       Details for pgfunc generation
+   * @param  llvm_out_value     Variable to keep the result
+   *
+   * @return true if generation was successful otherwise return false.
+   **/
+  template<llvm::CmpInst::Predicate pred>
+  static bool NumericCmp(
+      gpcodegen::GpCodegenUtils* codegen_utils,
+      const gpcodegen::PGFuncGeneratorInfo& pg_func_info,
+      llvm::Value** llvm_out_value);
+
  private:
   /**
    * @brief A helper function that creates LLVM instructions that check if a
@@ -114,6 +157,41 @@ class PGNumericFuncGenerator {
   static bool GeneratePallocTransdata(gpcodegen::GpCodegenUtils* codegen_utils,
                                       llvm::Value* llvm_in_transdata_ptr,
                                       llvm::Value** llvm_out_trandata_ptr);
+
+  /**
+   * @brief A helper function that creates LLVM instructions which implement
+   *        check_float8_array(transarray, caller, 3) of float.c.
+   *
+   * @param codegen_utils      Utility for easy code generation.
+   * @param pg_func_info       Details for pgfunc generation
+   * @param llvm_transarray    Pointer to the detoasted transition array
+   * @param caller             Name of the function, for the error message
+   *
+   * @return Pointer to the float8 values of the array.
+   **/
+  static llvm::Value* GenerateFloat8ArrayValues(
+      gpcodegen::GpCodegenUtils* codegen_utils,
+      const gpcodegen::PGFuncGeneratorInfo& pg_func_info,
+      llvm::Value* llvm_transarray,
+      const char* caller);
+
+  /**
+   * @brief A helper function that creates LLVM instructions which implement
+   *        CHECKFLOATVAL(val, isinf(arg0) || isinf(arg1), true), i.e. error
+   *        out if an addition of finite values overflowed.
+   *
+   * @param codegen_utils      Utility for easy code generation.
+   * @param pg_func_info       Details for pgfunc generation
+   * @param llvm_val           Result of the operation
+   * @param llvm_arg0          First operand
+   * @param llvm_arg1          Second operand
+   **/
+  static void GenerateFloatOverflowCheck(
+      gpcodegen::GpCodegenUtils* codegen_utils,
+      const gpcodegen::PGFuncGeneratorInfo& pg_func_info,
+      llvm::Value* llvm_val,
+      llvm::Value* llvm_arg0,
+      llvm::Value* llvm_arg1);
 };
 
 template<typename CType>
@@ -156,6 +234,85 @@ bool PGNumericFuncGenerator::GenerateIntFloatAvgAccum(
   return true;
 }
 
+template<typename CType>
+bool PGNumericFuncGenerator::GenerateFloatAccum(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    const gpcodegen::PGFuncGeneratorInfo& pg_func_info,
+    llvm::Value** llvm_out_value) {
+  llvm::Function* llvm_pg_detoast_datum = codegen_utils->
+      GetOrRegisterExternalFunction(pg_detoast_datum, "pg_detoast_datum");
+
+  auto irb = codegen_utils->ir_builder();
+
+  // ArrayType *transarray = PG_GETARG_ARRAYTYPE_P(0);
+  llvm::Value* llvm_transarray =
+      irb->CreateCall(llvm_pg_detoast_datum, {pg_func_info.llvm_args[0]});
+  // float4_accum does its computations as float8, too.
+  llvm::Value* llvm_newval = codegen_utils->CreateCast<float8, CType>(
+      pg_func_info.llvm_args[1]);
+
+  // transvalues = check_float8_array(transarray, "float8_accum", 3);
+  llvm::Value* llvm_transvalues = GenerateFloat8ArrayValues(
+      codegen_utils, pg_func_info, llvm_transarray,
+      sizeof(CType) == sizeof(float8) ? "float8_accum" : "float4_accum");
+  llvm::Value* llvm_N_ptr = irb->CreateInBoundsGEP(
+      codegen_utils->GetType<float8>(), llvm_transvalues,
+      codegen_utils->GetConstant(0));
+  llvm::Value* llvm_sumX_ptr = irb->CreateInBoundsGEP(
+      codegen_utils->GetType<float8>(), llvm_transvalues,
+      codegen_utils->GetConstant(1));
+  llvm::Value* llvm_sumX2_ptr = irb->CreateInBoundsGEP(
+      codegen_utils->GetType<float8>(), llvm_transvalues,
+      codegen_utils->GetConstant(2));
+  llvm::Value* llvm_sumX = irb->CreateLoad(llvm_sumX_ptr);
+  llvm::Value* llvm_sumX2 = irb->CreateLoad(llvm_sumX2_ptr);
+
+  // N += 1.0;
+  llvm::Value* llvm_new_N = irb->CreateFAdd(
+      irb->CreateLoad(llvm_N_ptr), codegen_utils->GetConstant<float8>(1.0));
+  // sumX += newval;
+  // CHECKFLOATVAL(sumX, isinf(transvalues[1]) || isinf(newval), true); {{
+  llvm::Value* llvm_new_sumX = irb->CreateFAdd(llvm_sumX, llvm_newval);
+  GenerateFloatOverflowCheck(codegen_utils, pg_func_info,
+                             llvm_new_sumX, llvm_sumX, llvm_newval);
+  // }}
+  // sumX2 += newval * newval;
+  // CHECKFLOATVAL(sumX2, isinf(transvalues[2]) || isinf(newval), true); {{
+  llvm::Value* llvm_new_sumX2 = irb->CreateFAdd(
+      llvm_sumX2, irb->CreateFMul(llvm_newval, llvm_newval));
+  GenerateFloatOverflowCheck(codegen_utils, pg_func_info,
+                             llvm_new_sumX2, llvm_sumX2, llvm_newval);
+  // }}
+  irb->CreateStore(llvm_new_N, llvm_N_ptr);
+  irb->CreateStore(llvm_new_sumX, llvm_sumX_ptr);
+  irb->CreateStore(llvm_new_sumX2, llvm_sumX2_ptr);
+
+  *llvm_out_value = llvm_transarray;
+  return true;
+}
+
+template<llvm::CmpInst::Predicate pred>
+bool PGNumericFuncGenerator::NumericCmp(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    const gpcodegen::PGFuncGeneratorInfo& pg_func_info,
+    llvm::Value** llvm_out_value) {
+  llvm::Function* llvm_cmp_numerics = codegen_utils->
+      GetOrRegisterExternalFunction(cmp_numerics, "cmp_numerics");
+  auto irb = codegen_utils->ir_builder();
+
+  // Unlike the avg transition functions, these are called on values read
+  // straight from the tuple, so only detoast when needed.
+  llvm::Value* llvm_num1 = PGTextFuncGenerator::GenerateDetoast(
+      codegen_utils, pg_func_info.llvm_args[0]);
+  llvm::Value* llvm_num2 = PGTextFuncGenerator::GenerateDetoast(
+      codegen_utils, pg_func_info.llvm_args[1]);
+  llvm::Value* llvm_cmp_result = irb->CreateCall(llvm_cmp_numerics,
+                                                 {llvm_num1, llvm_num2});
+  *llvm_out_value = irb->CreateICmp(pred, llvm_cmp_result,
+                                    codegen_utils->GetConstant<int>(0));
+  return true;
+}
+
 /** @} */
 }  // namespace gpcodegen
 
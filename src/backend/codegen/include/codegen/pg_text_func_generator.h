@@ -0,0 +1,203 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    pg_text_func_generator.h
+//
+//  @doc:
+//    Base class for text and bpchar functions to generate code
+//
+//---------------------------------------------------------------------------
+
+#ifndef GPDB_PG_TEXT_FUNC_GENERATOR_H_  // NOLINT(build/header_guard)
+#define GPDB_PG_TEXT_FUNC_GENERATOR_H_
+
+#include "codegen/utils/gp_codegen_utils.h"
+#include "codegen/pg_func_generator_interface.h"
+
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/InstrTypes.h"
+#include "llvm/IR/Value.h"
+
+namespace llvm {
+class Value;
+}
+
+namespace gpcodegen {
+
+/** \addtogroup gpcodegen
+ *  @{
+ */
+
+class GpCodegenUtils;
+struct PGFuncGeneratorInfo;
+
+/**
+ * @brief Class with Static member function to generate code for text and
+ *        bpchar operators.
+ *
+ * @note Ordering comparisons are only generated when LC_COLLATE is C, where
+ *       varstr_cmp reduces to a byte-wise comparison. Equality never depends
+ *       on the collation.
+ **/
+class PGTextFuncGenerator {
+ public:
+  /**
+   * @brief Create LLVM instructions for texteq (negate = false) and
+   *        textne (negate = true).
+   *
+   * @param codegen_utils      Utility for easy code generation.
+   * @param pg_func_info       Details for pgfunc generation
+   * @param llvm_out_value     Variable to keep the result
+   *
+   * @return true if generation was successful otherwise return false.
+   **/
+  template <bool negate>
+  static bool TextEq(gpcodegen::GpCodegenUtils* codegen_utils,
+                     const gpcodegen::PGFuncGeneratorInfo& pg_func_info,
+                     llvm::Value** llvm_out_value) {
+    return GenerateEq(codegen_utils, pg_func_info, false, negate,
+                      llvm_out_value);
+  }
+
+  /**
+   * @brief Create LLVM instructions for bpchareq (negate = false) and
+   *        bpcharne (negate = true), which ignore trailing spaces.
+   **/
+  template <bool negate>
+  static bool BpcharEq(gpcodegen::GpCodegenUtils* codegen_utils,
+                       const gpcodegen::PGFuncGeneratorInfo& pg_func_info,
+                       llvm::Value** llvm_out_value) {
+    return GenerateEq(codegen_utils, pg_func_info, true, negate,
+                      llvm_out_value);
+  }
+
+  /**
+   * @brief Create LLVM instructions for text_lt, text_le, text_gt and
+   *        text_ge, i.e. (text_cmp(arg0, arg1) <pred> 0).
+   **/
+  template <llvm::CmpInst::Predicate pred>
+  static bool TextCmp(gpcodegen::GpCodegenUtils* codegen_utils,
+                      const gpcodegen::PGFuncGeneratorInfo& pg_func_info,
+                      llvm::Value** llvm_out_value) {
+    return GenerateCmp(codegen_utils, pg_func_info, false, pred,
+                       llvm_out_value);
+  }
+
+  /**
+   * @brief Create LLVM instructions for bpcharlt, bpcharle, bpchargt and
+   *        bpcharge, which ignore trailing spaces.
+   **/
+  template <llvm::CmpInst::Predicate pred>
+  static bool BpcharCmp(gpcodegen::GpCodegenUtils* codegen_utils,
+                        const gpcodegen::PGFuncGeneratorInfo& pg_func_info,
+                        llvm::Value** llvm_out_value) {
+    return GenerateCmp(codegen_utils, pg_func_info, true, pred,
+                       llvm_out_value);
+  }
+
+  /**
+   * @brief Create LLVM instructions for textlike (negate = false) and
+   *        textnlike (negate = true).
+   *
+   * @note Only constant patterns that are a literal, optionally followed by
+   *       '%', are supported. These become an equality or prefix check.
+   **/
+  template <bool negate>
+  static bool TextLike(gpcodegen::GpCodegenUtils* codegen_utils,
+                       const gpcodegen::PGFuncGeneratorInfo& pg_func_info,
+                       llvm::Value** llvm_out_value) {
+    return GenerateLike(codegen_utils, pg_func_info, negate, llvm_out_value);
+  }
+
+  /**
+   * @brief Create LLVM instructions that return a pointer to the given
+   *        varlena in plain 4-byte header format, calling pg_detoast_datum
+   *        only if it is compressed, external or has a short header.
+   *
+   * @param codegen_utils      Utility for easy code generation.
+   * @param llvm_varlena_ptr   Pointer to the (possibly toasted) varlena
+   *
+   * @return Pointer to the detoasted varlena
+   **/
+  static llvm::Value* GenerateDetoast(gpcodegen::GpCodegenUtils* codegen_utils,
+                                      llvm::Value* llvm_varlena_ptr);
+
+  /**
+   * @brief Create LLVM instructions equivalent to VARDATA_ANY and
+   *        VARSIZE_ANY_EXHDR on a varlena, detoasting it only if it is
+   *        neither a plain nor a short header varlena.
+   *
+   * @param codegen_utils      Utility for easy code generation.
+   * @param llvm_varlena_ptr   Pointer to the (possibly toasted) varlena
+   * @param llvm_out_data      Pointer to the data of the varlena
+   * @param llvm_out_len       Length of the data as int32
+   **/
+  static void GenerateVarlenaDataAndLength(
+      gpcodegen::GpCodegenUtils* codegen_utils,
+      llvm::Value* llvm_varlena_ptr,
+      llvm::Value** llvm_out_data,
+      llvm::Value** llvm_out_len);
+
+  /**
+   * @brief Create LLVM instructions equivalent to text_cmp (is_bpchar =
+   *        false) or bpcharcmp (is_bpchar = true) when LC_COLLATE is C.
+   *
+   * @param codegen_utils      Utility for easy code generation.
+   * @param llvm_arg0          Pointer to the first (possibly toasted) varlena
+   * @param llvm_arg1          Pointer to the second (possibly toasted) varlena
+   * @param is_bpchar          Ignore trailing spaces
+   *
+   * @return int32 that is < 0, 0 or > 0 like the result of memcmp
+   *
+   * @note The caller must check lc_collate_is_c() at generation time.
+   **/
+  static llvm::Value* GenerateTextCompare(
+      gpcodegen::GpCodegenUtils* codegen_utils,
+      llvm::Value* llvm_arg0,
+      llvm::Value* llvm_arg1,
+      bool is_bpchar);
+
+ private:
+  static bool GenerateEq(gpcodegen::GpCodegenUtils* codegen_utils,
+                         const gpcodegen::PGFuncGeneratorInfo& pg_func_info,
+                         bool is_bpchar,
+                         bool negate,
+                         llvm::Value** llvm_out_value);
+
+  static bool GenerateCmp(gpcodegen::GpCodegenUtils* codegen_utils,
+                          const gpcodegen::PGFuncGeneratorInfo& pg_func_info,
+                          bool is_bpchar,
+                          llvm::CmpInst::Predicate pred,
+                          llvm::Value** llvm_out_value);
+
+  static bool GenerateLike(gpcodegen::GpCodegenUtils* codegen_utils,
+                           const gpcodegen::PGFuncGeneratorInfo& pg_func_info,
+                           bool negate,
+                           llvm::Value** llvm_out_value);
+
+  /**
+   * @brief Create LLVM instructions that implement bcTruelen, i.e. the
+   *        length of the data without trailing spaces.
+   **/
+  static llvm::Value* GenerateBpcharTrueLen(
+      gpcodegen::GpCodegenUtils* codegen_utils,
+      llvm::Value* llvm_data,
+      llvm::Value* llvm_len);
+
+  /**
+   * @brief Create LLVM instructions that fetch data and length of both
+   *        arguments, trimming trailing spaces for bpchar.
+   **/
+  static void GenerateArgs(gpcodegen::GpCodegenUtils* codegen_utils,
+                           const gpcodegen::PGFuncGeneratorInfo& pg_func_info,
+                           bool is_bpchar,
+                           llvm::Value* llvm_data[2],
+                           llvm::Value* llvm_len[2]);
+};
+
+/** @} */
+}  // namespace gpcodegen
+
+#endif  // GPDB_PG_TEXT_FUNC_GENERATOR_H_
@@ -0,0 +1,76 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    scalar_array_op_expr_tree_generator.h
+//
+//  @doc:
+//    Object that generate code for scalar op ANY/ALL (array) expression.
+//
+//---------------------------------------------------------------------------
+#ifndef GPCODEGEN_SCALAR_ARRAY_OP_EXPR_TREE_GENERATOR_H_  // NOLINT(build/header_guard)
+#define GPCODEGEN_SCALAR_ARRAY_OP_EXPR_TREE_GENERATOR_H_
+
+#include <memory>
+#include <vector>
+
+#include "codegen/expr_tree_generator.h"
+
+#include "llvm/IR/Value.h"
+
+namespace gpcodegen {
+
+/** \addtogroup gpcodegen
+ *  @{
+ */
+
+/**
+ * @brief Object that generate code for scalar op ANY/ALL (array) expression,
+ *        e.g. x IN (1, 2, 3).
+ *
+ * @note Only constant arrays of pass-by-value elements are supported. The
+ *       array is deconstructed at generation time and the comparison with
+ *       each element is unrolled into the generated code.
+ **/
+class ScalarArrayOpExprTreeGenerator : public ExprTreeGenerator {
+ public:
+  static bool VerifyAndCreateExprTree(
+      const ExprState* expr_state,
+      ExprTreeGeneratorInfo* gen_info,
+      std::unique_ptr<ExprTreeGenerator>* expr_tree);
+
+  bool GenerateCode(gpcodegen::GpCodegenUtils* codegen_utils,
+                    const ExprTreeGeneratorInfo& gen_info,
+                    llvm::Value** llvm_out_value,
+                    llvm::Value* const llvm_isnull_ptr) final;
+
+  // Arrays with more elements are left to ExecEvalScalarArrayOp, as the
+  // unrolled code would get too large.
+  static constexpr int kMaxArrayElements = 64;
+
+ protected:
+  /**
+   * @brief Constructor.
+   *
+   * @param expr_state Expression state
+   * @param scalar Left hand side of the operator
+   * @param elements Elements of the constant array
+   * @param element_nulls Whether each element of the array is NULL
+   **/
+  ScalarArrayOpExprTreeGenerator(
+      const ExprState* expr_state,
+      std::unique_ptr<ExprTreeGenerator> scalar,
+      std::vector<Datum>&& elements,  // NOLINT(build/c++11)
+      std::vector<bool>&& element_nulls);  // NOLINT(build/c++11)
+
+ private:
+  std::unique_ptr<ExprTreeGenerator> scalar_;
+  std::vector<Datum> elements_;
+  std::vector<bool> element_nulls_;
+};
+
+/** @} */
+}  // namespace gpcodegen
+
+#endif  // GPCODEGEN_SCALAR_ARRAY_OP_EXPR_TREE_GENERATOR_H_
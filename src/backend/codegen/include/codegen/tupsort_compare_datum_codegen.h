@@ -0,0 +1,141 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    tupsort_compare_datum_codegen.h
+//
+//  @doc:
+//    Headers for tupsort_compare_datum codegen.
+//
+//---------------------------------------------------------------------------
+
+#ifndef GPCODEGEN_TUPSORT_COMPARE_DATUM_CODEGEN_H_  // NOLINT(build/header_guard)
+#define GPCODEGEN_TUPSORT_COMPARE_DATUM_CODEGEN_H_
+
+#include "codegen/base_codegen.h"
+#include "codegen/codegen_wrapper.h"
+
+namespace llvm {
+class Value;
+}  // namespace llvm
+
+namespace gpcodegen {
+
+/** \addtogroup gpcodegen
+ *  @{
+ */
+
+class TupsortCompareDatumCodegen
+    : public BaseCodegen<TupsortCompareDatumFn> {
+ public:
+  /**
+   * @brief Constructor
+   *
+   * @param regular_func_ptr        Regular version of the target function.
+   * @param ptr_to_chosen_func_ptr  Reference to the function pointer that the
+   *                                caller will call.
+   * @param nkeys                   Number of sort keys.
+   * @param sort_operators          Array of Oids of the ordering operators
+   *                                of the sort keys.
+   *
+   * @note 	The ptr_to_chosen_func_ptr can refer to either the generated
+   *        function or the corresponding regular version.
+   *
+   **/
+  explicit TupsortCompareDatumCodegen(
+      CodegenManager* manager,
+      TupsortCompareDatumFn regular_func_ptr,
+      TupsortCompareDatumFn* ptr_to_regular_func_ptr,
+      int nkeys,
+      Oid* sort_operators);
+
+  virtual ~TupsortCompareDatumCodegen() = default;
+
+  /**
+   * @brief Generates the 3-way comparison of two non-null datums.
+   *
+   * @param codegen_utils Utility to ease the code generation process.
+   * @param sort_func_oid Oid of the btree comparison function of the level
+   * @param llvm_d1 First Datum
+   * @param llvm_d2 Second Datum
+   *
+   * @return int32 that is < 0, 0 or > 0, or nullptr if the comparison
+   *         function is not supported.
+   *
+   * @note Text and bpchar datums must not be toasted, and must only be
+   *       compared this way when LC_COLLATE is C.
+   **/
+  static llvm::Value* GenerateCompare(gpcodegen::GpCodegenUtils* codegen_utils,
+                                      Oid sort_func_oid,
+                                      llvm::Value* llvm_d1,
+                                      llvm::Value* llvm_d2);
+
+  /**
+   * @brief Generates a check that a varlena has a plain 4-byte header or a
+   *        short header, i.e. that its data can be read without calling
+   *        pg_detoast_datum, which would leak the detoasted copy in the sort
+   *        context on every comparison.
+   *
+   * @param codegen_utils Utility to ease the code generation process.
+   * @param llvm_varlena_ptr Pointer to the varlena
+   *
+   * @return bool that is false for compressed and external values.
+   **/
+  static llvm::Value* GenerateIsUntoasted(
+      gpcodegen::GpCodegenUtils* codegen_utils,
+      llvm::Value* llvm_varlena_ptr);
+
+ protected:
+  /**
+   * @brief Looks up the btree comparison function of an ordering operator.
+   *
+   * @param sort_operator Oid of the ordering operator of a sort key
+   * @param sort_func_oid Set to the oid of the comparison function
+   * @param reverse Set to true if the operator sorts in descending order
+   *
+   * @return false if the operator is not a valid ordering operator.
+   **/
+  virtual bool GetSortKeyCompareFunction(Oid sort_operator,
+                                         Oid* sort_func_oid,
+                                         bool* reverse);
+
+  /**
+   * @brief Generate code for tupsort_compare_datum.
+   *
+   * @param codegen_utils
+   *
+   * @return true on successful generation; false otherwise.
+   *
+   * The generated function finds the level being compared from the position
+   * of the MKLvContext in its MKContext and jumps to an inlined comparison
+   * of the key type of that level, with the sort direction resolved at
+   * generation time. NULLs never reach the comparison since the MK sort and
+   * heap order them with the compflags of the entries.
+   *
+   * Integer, oid, char, bool, float, date and timestamp keys are supported,
+   * as well as text and bpchar keys when LC_COLLATE is C. Other levels, and
+   * MKContexts with a different number of levels, fall back to the regular
+   * function.
+   */
+  bool GenerateCodeInternal(gpcodegen::GpCodegenUtils* codegen_utils) final;
+
+ private:
+  int nkeys_;
+  Oid* sort_operators_;
+
+  static constexpr char kTupsortCompareDatumPrefix[] = "TupsortCompareDatum";
+
+  /**
+   * @brief Generates runtime code that implements tupsort_compare_datum.
+   *
+   * @param codegen_utils Utility to ease the code generation process.
+   * @return true on successful generation.
+   **/
+  bool GenerateTupsortCompareDatum(gpcodegen::GpCodegenUtils* codegen_utils);
+};
+
+/** @} */
+
+}  // namespace gpcodegen
+#endif  // GPCODEGEN_TUPSORT_COMPARE_DATUM_CODEGEN_H_
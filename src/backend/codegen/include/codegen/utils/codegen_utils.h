@@ -470,6 +470,20 @@ class CodegenUtils {
   bool PrepareForExecution(const OptimizationLevel cpu_opt_level,
                            const bool optimize_for_host_cpu);
 
+  /**
+   * @brief Generate machine code for all functions up front, instead of on
+   *        the first call to GetFunctionPointer().
+   *
+   * @note PrepareForExecution() should be called before calling this method.
+   *       It only touches the state of this CodegenUtils, so it may run on a
+   *       different thread than the one that generated the code, as long as
+   *       no other method is called until it returns.
+   *
+   * @return true if machine code was generated, false if
+   *         PrepareForExecution() has not been called successfully.
+   **/
+  bool FinalizeCompilation();
+
   /**
    * @brief Get a pointer to the compiled machine-code version of a function
    *        generated by this CodegenUtils.
@@ -525,6 +539,53 @@ class CodegenUtils {
    */
   void PrintUnderlyingModules(llvm::raw_ostream& out); // NOLINT
 
+  /**
+   * @brief Compute a fingerprint of the code held by this CodegenUtils.
+   *
+   * Generated functions are identified by their position in the module rather
+   * than by their (globally unique) names, and external global variables by
+   * their per-module placeholder names, so that two modules generated from
+   * structurally identical plans have equal fingerprints even if they were
+   * generated for different runtime objects. Addresses of registered external
+   * functions are part of the fingerprint since they are resolved into the
+   * compiled code.
+   *
+   * @note Must be called before PrepareForExecution().
+   *
+   * @return A string that is equal for any two modules whose compiled code is
+   *         interchangeable after RebindExternalVariables().
+   **/
+  std::string GetModuleFingerprint();
+
+  /**
+   * @brief Make the external global variables (i.e. pointer constants) of the
+   *        module rebindable after compilation.
+   *
+   * Every use of an external global variable is rewritten to load its address
+   * from a binding table owned by this CodegenUtils, instead of having the
+   * address resolved into the machine code. This costs one load per use, but
+   * allows the compiled code to be reused for other runtime objects by calling
+   * RebindExternalVariables().
+   *
+   * @note Must be called before PrepareForExecution().
+   *
+   * @return true if all uses were rewritten, false if some use could not be
+   *         rewritten and the compiled code must not be rebound.
+   **/
+  bool MakeExternalVariablesRelocatable();
+
+  /**
+   * @brief Bind the external global variables of the compiled module to the
+   *        addresses recorded by another, not yet compiled, CodegenUtils
+   *        holding the same code.
+   *
+   * @param other CodegenUtils whose module has the same fingerprint as the
+   *        one compiled by this CodegenUtils.
+   * @return true on success, false if this CodegenUtils was not made
+   *         relocatable or the external variables of both do not match.
+   **/
+  bool RebindExternalVariables(const CodegenUtils& other);
+
  protected:
   /**
    * @return LLVMContext
@@ -561,6 +622,8 @@ class CodegenUtils {
 
   static constexpr char kExternalVariableNamePrefix[] = "_gpcodegenv";
   static constexpr char kExternalFunctionNamePrefix[] = "_gpcodegenx";
+  static constexpr char kExternalVariableBindingSuffix[] = "_binding";
+  static constexpr char kFingerprintFunctionNamePrefix[] = "_gpcodegenf";
 
   // Used internally when CreateFunction is called. Given the ReturnType
   // and ArgumentTypes this will create an LLVM functions in the module
@@ -659,6 +722,12 @@ class CodegenUtils {
   std::vector<std::pair<const std::string, const std::uint64_t>>
       external_global_variables_;
 
+  // Binding table holding the address of each entry of
+  // 'external_global_variables_', allocated by
+  // MakeExternalVariablesRelocatable(). When set, PrepareForExecution() maps
+  // the binding global of each external variable to its slot in this table.
+  std::unique_ptr<std::uint64_t[]> external_variable_bindings_;
+
   // Counters for external variables/functions registered in this CodegenUtils.
   // Used by GenerateExternalVariableName() and GenerateExternalFunctionName(),
   // respectively, to generate unique names for functions/globals.
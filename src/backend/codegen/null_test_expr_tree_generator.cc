@@ -0,0 +1,104 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    null_test_expr_tree_generator.cc
+//
+//  @doc:
+//    Object that generate code for IS [NOT] NULL expression.
+//
+//---------------------------------------------------------------------------
+
+#include <assert.h>
+#include <memory>
+#include <utility>
+
+#include "codegen/expr_tree_generator.h"
+#include "codegen/null_test_expr_tree_generator.h"
+#include "codegen/utils/gp_codegen_utils.h"
+
+#include "llvm/IR/IRBuilder.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "nodes/execnodes.h"
+#include "nodes/nodes.h"
+#include "nodes/primnodes.h"
+#include "utils/elog.h"
+}
+
+using gpcodegen::NullTestExprTreeGenerator;
+using gpcodegen::ExprTreeGenerator;
+using gpcodegen::GpCodegenUtils;
+
+bool NullTestExprTreeGenerator::VerifyAndCreateExprTree(
+    const ExprState* expr_state,
+    ExprTreeGeneratorInfo* gen_info,
+    std::unique_ptr<ExprTreeGenerator>* expr_tree) {
+  assert(nullptr != expr_state &&
+         nullptr != expr_state->expr &&
+         T_NullTest == nodeTag(expr_state->expr) &&
+         nullptr != expr_tree);
+  expr_tree->reset(nullptr);
+  const NullTestState* null_test_state =
+      reinterpret_cast<const NullTestState*>(expr_state);
+  if (null_test_state->argisrow) {
+    return Reject(gen_info, "NullTest on a row type is not supported");
+  }
+  std::unique_ptr<ExprTreeGenerator> arg(nullptr);
+  if (!ExprTreeGenerator::VerifyAndCreateExprTree(null_test_state->arg,
+                                                  gen_info,
+                                                  &arg)) {
+    return false;
+  }
+  expr_tree->reset(new NullTestExprTreeGenerator(expr_state, std::move(arg)));
+  return true;
+}
+
+NullTestExprTreeGenerator::NullTestExprTreeGenerator(
+    const ExprState* expr_state,
+    std::unique_ptr<ExprTreeGenerator> arg) :
+    ExprTreeGenerator(expr_state, ExprTreeNodeType::kNullTest),
+    arg_(std::move(arg)) {
+}
+
+bool NullTestExprTreeGenerator::GenerateCode(
+    GpCodegenUtils* codegen_utils,
+    const ExprTreeGeneratorInfo& gen_info,
+    llvm::Value** llvm_out_value,
+    llvm::Value* const llvm_isnull_ptr) {
+  assert(nullptr != llvm_out_value);
+  assert(nullptr != llvm_isnull_ptr);
+  *llvm_out_value = nullptr;
+  NullTest* null_test = reinterpret_cast<NullTest*>(expr_state()->expr);
+  auto irb = codegen_utils->ir_builder();
+
+  llvm::Value* llvm_arg_isnull_ptr = irb->CreateAlloca(
+      codegen_utils->GetType<bool>(), nullptr, "isNull");
+  irb->CreateStore(codegen_utils->GetConstant<bool>(false),
+                   llvm_arg_isnull_ptr);
+  llvm::Value* llvm_arg = nullptr;
+  if (!arg_->GenerateCode(codegen_utils, gen_info,
+                          &llvm_arg, llvm_arg_isnull_ptr)) {
+    return false;
+  }
+  llvm::Value* llvm_arg_isnull = irb->CreateLoad(llvm_arg_isnull_ptr);
+
+  // The result of a null test is never NULL.
+  irb->CreateStore(codegen_utils->GetConstant<bool>(false), llvm_isnull_ptr);
+  switch (null_test->nulltesttype) {
+    case IS_NULL:
+      *llvm_out_value =
+          codegen_utils->CreateCppTypeToDatumCast(llvm_arg_isnull);
+      return true;
+    case IS_NOT_NULL:
+      *llvm_out_value = codegen_utils->CreateCppTypeToDatumCast(
+          irb->CreateNot(llvm_arg_isnull));
+      return true;
+    default:
+      elog(WARNING, "Unrecognized nulltesttype: %d",
+           static_cast<int>(null_test->nulltesttype));
+      return false;
+  }
+}
@@ -13,6 +13,7 @@
 #include <assert.h>
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
@@ -26,6 +27,7 @@
 #include "codegen/pg_arith_func_generator.h"
 #include "codegen/pg_date_func_generator.h"
 #include "codegen/pg_numeric_func_generator.h"
+#include "codegen/pg_text_func_generator.h"
 
 #include "llvm/IR/IRBuilder.h"
 
@@ -49,6 +51,7 @@ using gpcodegen::GpCodegenUtils;
 using gpcodegen::PGFuncGeneratorInterface;
 using gpcodegen::PGFuncGeneratorFn;
 using gpcodegen::CodeGenFuncMap;
+using gpcodegen::PGTextFuncGenerator;
 using llvm::IRBuilder;
 
 
@@ -73,6 +76,83 @@ void OpExprTreeGenerator::InitializeSupportedFunction() {
           &IRBuilder<>::CreateICmpSLE,
           true));
 
+  supported_function_[65] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int32_t, int32_t>(
+          65,
+          "int4eq",
+          &IRBuilder<>::CreateICmpEQ,
+          true));
+
+  supported_function_[144] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int32_t, int32_t>(
+          144,
+          "int4ne",
+          &IRBuilder<>::CreateICmpNE,
+          true));
+
+  supported_function_[66] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int32_t, int32_t>(
+          66,
+          "int4lt",
+          &IRBuilder<>::CreateICmpSLT,
+          true));
+
+  supported_function_[147] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int32_t, int32_t>(
+          147,
+          "int4gt",
+          &IRBuilder<>::CreateICmpSGT,
+          true));
+
+  supported_function_[150] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int32_t, int32_t>(
+          150,
+          "int4ge",
+          &IRBuilder<>::CreateICmpSGE,
+          true));
+
+  supported_function_[467] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int64_t, int64_t>(
+          467,
+          "int8eq",
+          &IRBuilder<>::CreateICmpEQ,
+          true));
+
+  supported_function_[468] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int64_t, int64_t>(
+          468,
+          "int8ne",
+          &IRBuilder<>::CreateICmpNE,
+          true));
+
+  supported_function_[469] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int64_t, int64_t>(
+          469,
+          "int8lt",
+          &IRBuilder<>::CreateICmpSLT,
+          true));
+
+  supported_function_[470] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int64_t, int64_t>(
+          470,
+          "int8gt",
+          &IRBuilder<>::CreateICmpSGT,
+          true));
+
+  supported_function_[471] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int64_t, int64_t>(
+          471,
+          "int8le",
+          &IRBuilder<>::CreateICmpSLE,
+          true));
+
+  supported_function_[472] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int64_t, int64_t>(
+          472,
+          "int8ge",
+          &IRBuilder<>::CreateICmpSGE,
+          true));
+
   supported_function_[177] = std::unique_ptr<PGFuncGeneratorInterface>(
       new PGGenericFuncGenerator<int32_t, int32_t, int32_t>(
           177,
@@ -92,6 +172,16 @@ void OpExprTreeGenerator::InitializeSupportedFunction() {
           CreateArgumentNullChecks,
           false));
 
+  // Like int4_sum, int2_sum is not strict.
+  supported_function_[1840] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<int64_t, int64_t, int16_t>(
+          1840,
+          "int2_sum",
+          &PGArithFuncGenerator<int64_t, int64_t, int16_t>::AddWithOverflow,
+          &PGArithFuncGenerator<int64_t, int64_t, int16_t>::
+          CreateArgumentNullChecks,
+          false));
+
   supported_function_[181] = std::unique_ptr<PGFuncGeneratorInterface>(
       new PGGenericFuncGenerator<int32_t, int32_t, int32_t>(
           181,
@@ -178,6 +268,47 @@ void OpExprTreeGenerator::InitializeSupportedFunction() {
           nullptr,
           true));
 
+  supported_function_[1962] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<void*, void*, int16_t>(
+          1962,
+          "int2_avg_accum",
+          &PGNumericFuncGenerator::GenerateIntFloatAvgAccum<int16_t>,
+          nullptr,
+          true));
+
+  supported_function_[3100] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<void*, void*, int64_t>(
+          3100,
+          "int8_avg_accum",
+          &PGNumericFuncGenerator::GenerateIntFloatAvgAccum<int64_t>,
+          nullptr,
+          true));
+
+  supported_function_[3106] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<void*, void*, float>(
+          3106,
+          "float4_avg_accum",
+          &PGNumericFuncGenerator::GenerateIntFloatAvgAccum<float>,
+          nullptr,
+          true));
+
+  // Transition functions of the float variance and stddev aggregates.
+  supported_function_[222] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<void*, void*, float8>(
+          222,
+          "float8_accum",
+          &PGNumericFuncGenerator::GenerateFloatAccum<float8>,
+          nullptr,
+          true));
+
+  supported_function_[208] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<void*, void*, float>(
+          208,
+          "float4_accum",
+          &PGNumericFuncGenerator::GenerateFloatAccum<float>,
+          nullptr,
+          true));
+
   supported_function_[6009] = std::unique_ptr<PGFuncGeneratorInterface>(
       new PGGenericFuncGenerator<void*, void*, void*>(
           6009,
@@ -193,6 +324,289 @@ void OpExprTreeGenerator::InitializeSupportedFunction() {
           &PGNumericFuncGenerator::GenerateIntFloatAvgAmalg,
           nullptr,
           true));
+
+  // Text and bpchar comparisons. Binary compatible types such as varchar
+  // reach these through a RelabelType.
+  supported_function_[67] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          67,
+          "texteq",
+          &PGTextFuncGenerator::TextEq<false>,
+          nullptr,
+          true));
+
+  supported_function_[157] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          157,
+          "textne",
+          &PGTextFuncGenerator::TextEq<true>,
+          nullptr,
+          true));
+
+  supported_function_[740] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          740,
+          "text_lt",
+          &PGTextFuncGenerator::TextCmp<llvm::CmpInst::ICMP_SLT>,
+          nullptr,
+          true));
+
+  supported_function_[741] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          741,
+          "text_le",
+          &PGTextFuncGenerator::TextCmp<llvm::CmpInst::ICMP_SLE>,
+          nullptr,
+          true));
+
+  supported_function_[742] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          742,
+          "text_gt",
+          &PGTextFuncGenerator::TextCmp<llvm::CmpInst::ICMP_SGT>,
+          nullptr,
+          true));
+
+  supported_function_[743] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          743,
+          "text_ge",
+          &PGTextFuncGenerator::TextCmp<llvm::CmpInst::ICMP_SGE>,
+          nullptr,
+          true));
+
+  supported_function_[1048] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1048,
+          "bpchareq",
+          &PGTextFuncGenerator::BpcharEq<false>,
+          nullptr,
+          true));
+
+  supported_function_[1053] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1053,
+          "bpcharne",
+          &PGTextFuncGenerator::BpcharEq<true>,
+          nullptr,
+          true));
+
+  supported_function_[1049] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1049,
+          "bpcharlt",
+          &PGTextFuncGenerator::BpcharCmp<llvm::CmpInst::ICMP_SLT>,
+          nullptr,
+          true));
+
+  supported_function_[1050] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1050,
+          "bpcharle",
+          &PGTextFuncGenerator::BpcharCmp<llvm::CmpInst::ICMP_SLE>,
+          nullptr,
+          true));
+
+  supported_function_[1051] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1051,
+          "bpchargt",
+          &PGTextFuncGenerator::BpcharCmp<llvm::CmpInst::ICMP_SGT>,
+          nullptr,
+          true));
+
+  supported_function_[1052] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1052,
+          "bpcharge",
+          &PGTextFuncGenerator::BpcharCmp<llvm::CmpInst::ICMP_SGE>,
+          nullptr,
+          true));
+
+  supported_function_[850] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          850,
+          "textlike",
+          &PGTextFuncGenerator::TextLike<false>,
+          nullptr,
+          true));
+
+  supported_function_[1569] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1569,
+          "like",
+          &PGTextFuncGenerator::TextLike<false>,
+          nullptr,
+          true));
+
+  supported_function_[1631] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1631,
+          "bpcharlike",
+          &PGTextFuncGenerator::TextLike<false>,
+          nullptr,
+          true));
+
+  supported_function_[851] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          851,
+          "textnlike",
+          &PGTextFuncGenerator::TextLike<true>,
+          nullptr,
+          true));
+
+  supported_function_[1570] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1570,
+          "notlike",
+          &PGTextFuncGenerator::TextLike<true>,
+          nullptr,
+          true));
+
+  supported_function_[1632] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1632,
+          "bpcharnlike",
+          &PGTextFuncGenerator::TextLike<true>,
+          nullptr,
+          true));
+
+  // Numeric comparisons.
+  supported_function_[1718] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1718,
+          "numeric_eq",
+          &PGNumericFuncGenerator::NumericCmp<llvm::CmpInst::ICMP_EQ>,
+          nullptr,
+          true));
+
+  supported_function_[1719] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1719,
+          "numeric_ne",
+          &PGNumericFuncGenerator::NumericCmp<llvm::CmpInst::ICMP_NE>,
+          nullptr,
+          true));
+
+  supported_function_[1720] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1720,
+          "numeric_gt",
+          &PGNumericFuncGenerator::NumericCmp<llvm::CmpInst::ICMP_SGT>,
+          nullptr,
+          true));
+
+  supported_function_[1721] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1721,
+          "numeric_ge",
+          &PGNumericFuncGenerator::NumericCmp<llvm::CmpInst::ICMP_SGE>,
+          nullptr,
+          true));
+
+  supported_function_[1722] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1722,
+          "numeric_lt",
+          &PGNumericFuncGenerator::NumericCmp<llvm::CmpInst::ICMP_SLT>,
+          nullptr,
+          true));
+
+  supported_function_[1723] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGGenericFuncGenerator<bool, void*, void*>(
+          1723,
+          "numeric_le",
+          &PGNumericFuncGenerator::NumericCmp<llvm::CmpInst::ICMP_SLE>,
+          nullptr,
+          true));
+
+#ifdef HAVE_INT64_TIMESTAMP
+  // Timestamp and timestamptz comparisons, which are plain int64 comparisons
+  // with integer datetimes.
+  supported_function_[2052] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int64_t, int64_t>(
+          2052,
+          "timestamp_eq",
+          &IRBuilder<>::CreateICmpEQ,
+          true));
+
+  supported_function_[2053] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int64_t, int64_t>(
+          2053,
+          "timestamp_ne",
+          &IRBuilder<>::CreateICmpNE,
+          true));
+
+  supported_function_[2054] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int64_t, int64_t>(
+          2054,
+          "timestamp_lt",
+          &IRBuilder<>::CreateICmpSLT,
+          true));
+
+  supported_function_[2055] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int64_t, int64_t>(
+          2055,
+          "timestamp_le",
+          &IRBuilder<>::CreateICmpSLE,
+          true));
+
+  supported_function_[2056] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int64_t, int64_t>(
+          2056,
+          "timestamp_ge",
+          &IRBuilder<>::CreateICmpSGE,
+          true));
+
+  supported_function_[2057] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int64_t, int64_t>(
+          2057,
+          "timestamp_gt",
+          &IRBuilder<>::CreateICmpSGT,
+          true));
+
+  supported_function_[1152] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int64_t, int64_t>(
+          1152,
+          "timestamptz_eq",
+          &IRBuilder<>::CreateICmpEQ,
+          true));
+
+  supported_function_[1153] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int64_t, int64_t>(
+          1153,
+          "timestamptz_ne",
+          &IRBuilder<>::CreateICmpNE,
+          true));
+
+  supported_function_[1154] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int64_t, int64_t>(
+          1154,
+          "timestamptz_lt",
+          &IRBuilder<>::CreateICmpSLT,
+          true));
+
+  supported_function_[1155] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int64_t, int64_t>(
+          1155,
+          "timestamptz_le",
+          &IRBuilder<>::CreateICmpSLE,
+          true));
+
+  supported_function_[1156] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int64_t, int64_t>(
+          1156,
+          "timestamptz_ge",
+          &IRBuilder<>::CreateICmpSGE,
+          true));
+
+  supported_function_[1157] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int64_t, int64_t>(
+          1157,
+          "timestamptz_gt",
+          &IRBuilder<>::CreateICmpSGT,
+          true));
+#endif  // HAVE_INT64_TIMESTAMP
 }
 
 PGFuncGeneratorInterface* OpExprTreeGenerator::GetPGFuncGenerator(
@@ -226,8 +640,8 @@ bool OpExprTreeGenerator::VerifyAndCreateExprTree(
   expr_tree->reset(nullptr);
   PGFuncGeneratorInterface* pg_func_gen = GetPGFuncGenerator(op_expr->opfuncid);
   if (nullptr == pg_func_gen) {
-    elog(DEBUG1, "Unsupported operator %d.", op_expr->opfuncid);
-    return false;
+    return Reject(gen_info, "operator function " +
+                  std::to_string(op_expr->opfuncid) + " is not supported");
   }
 
   List *arguments = reinterpret_cast<const FuncExprState*>(expr_state)->args;
@@ -0,0 +1,113 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    param_expr_tree_generator.cc
+//
+//  @doc:
+//    Object that generate code for param expression.
+//
+//---------------------------------------------------------------------------
+
+#include <assert.h>
+#include <memory>
+#include <string>
+
+#include "codegen/expr_tree_generator.h"
+#include "codegen/param_expr_tree_generator.h"
+#include "codegen/utils/gp_codegen_utils.h"
+
+#include "llvm/IR/Constant.h"
+
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "nodes/execnodes.h"
+#include "nodes/nodes.h"
+#include "nodes/params.h"
+#include "nodes/primnodes.h"
+#include "utils/elog.h"
+}
+namespace llvm {
+class Value;
+}  // namespace llvm
+
+
+using gpcodegen::ParamExprTreeGenerator;
+using gpcodegen::ExprTreeGenerator;
+
+bool ParamExprTreeGenerator::VerifyAndCreateExprTree(
+    const ExprState* expr_state,
+    ExprTreeGeneratorInfo* gen_info,
+    std::unique_ptr<ExprTreeGenerator>* expr_tree) {
+  assert(nullptr != expr_state &&
+         nullptr != expr_state->expr &&
+         T_Param == nodeTag(expr_state->expr) &&
+         nullptr != expr_tree);
+  Param* param_expr = reinterpret_cast<Param*>(expr_state->expr);
+  if (PARAM_EXTERN != param_expr->paramkind &&
+      PARAM_EXEC != param_expr->paramkind) {
+    return Reject(gen_info, "param kind " +
+                  std::to_string(param_expr->paramkind) + " is not supported");
+  }
+  expr_tree->reset(new ParamExprTreeGenerator(expr_state));
+  return true;
+}
+
+ParamExprTreeGenerator::ParamExprTreeGenerator(const ExprState* expr_state) :
+    ExprTreeGenerator(expr_state, ExprTreeNodeType::kParam) {
+}
+
+bool ParamExprTreeGenerator::GenerateCode(GpCodegenUtils* codegen_utils,
+                                          const ExprTreeGeneratorInfo& gen_info,
+                                          llvm::Value** llvm_out_value,
+                                          llvm::Value* const llvm_isnull_ptr) {
+  assert(nullptr != llvm_out_value);
+  assert(nullptr != llvm_isnull_ptr);
+  assert(nullptr != gen_info.econtext);
+  auto irb = codegen_utils->ir_builder();
+  Param* param_expr = reinterpret_cast<Param*>(expr_state()->expr);
+  int param_id = param_expr->paramid;
+  Datum value = 0;
+  bool isnull = false;
+
+  if (PARAM_EXEC == param_expr->paramkind) {
+    if (nullptr == gen_info.econtext->ecxt_param_exec_vals) {
+      return false;
+    }
+    ParamExecData* prm = &gen_info.econtext->ecxt_param_exec_vals[param_id];
+    // The value of an init plan is computed lazily by ExecEvalParam, which we
+    // don't want to trigger while generating code.
+    if (nullptr != prm->execPlan) {
+      elog(DEBUG1, "Param %d is not evaluated yet", param_id);
+      return false;
+    }
+    value = prm->value;
+    isnull = prm->isnull;
+  } else {
+    assert(PARAM_EXTERN == param_expr->paramkind);
+    ParamListInfo param_info = gen_info.econtext->ecxt_param_list_info;
+    if (nullptr == param_info ||
+        param_id <= 0 || param_id > param_info->numParams) {
+      return false;
+    }
+    ParamExternData* prm = &param_info->params[param_id - 1];
+    if (!OidIsValid(prm->ptype)) {
+      return false;
+    }
+    assert(prm->ptype == param_expr->paramtype);
+    value = prm->value;
+    isnull = prm->isnull;
+  }
+
+  // The value is valid until the next parameter change, upon which this code
+  // gets regenerated.
+  *llvm_out_value = codegen_utils->GetConstant(value);
+  // *isNull = prm->isnull;
+  irb->CreateStore(
+      codegen_utils->GetConstant<bool>(isnull),
+      llvm_isnull_ptr);
+
+  return true;
+}
@@ -0,0 +1,134 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    pg_hash_func_generator.cc
+//
+//  @doc:
+//    Static generators for the hash support functions of fixed length types
+//
+//---------------------------------------------------------------------------
+
+#include <assert.h>
+#include <cstdint>
+
+#include "codegen/pg_hash_func_generator.h"
+#include "codegen/utils/gp_codegen_utils.h"
+
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Value.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "c.h"  // NOLINT(build/include)
+#include "utils/fmgroids.h"
+}
+
+using gpcodegen::GpCodegenUtils;
+using gpcodegen::PGHashFuncGenerator;
+
+bool PGHashFuncGenerator::IsSupported(Oid hash_func_oid) {
+  switch (hash_func_oid) {
+    case F_HASHINT2:
+    case F_HASHINT4:
+    case F_HASHOID:
+    case F_HASHCHAR:
+    case F_HASHINT8:
+    case F_HASHENUM:
+      return true;
+    default:
+      return false;
+  }
+}
+
+llvm::Value* PGHashFuncGenerator::GenerateHashDatum(
+    GpCodegenUtils* codegen_utils,
+    Oid hash_func_oid,
+    llvm::Value* llvm_datum) {
+  assert(nullptr != codegen_utils);
+  assert(nullptr != llvm_datum);
+  llvm::IRBuilder<>* irb = codegen_utils->ir_builder();
+  llvm::Value* llvm_key = nullptr;
+
+  switch (hash_func_oid) {
+    case F_HASHINT2:
+      // hash_uint32((int32) PG_GETARG_INT16(0))
+      llvm_key = irb->CreateSExt(
+          codegen_utils->CreateDatumToCppTypeCast<int16_t>(llvm_datum),
+          codegen_utils->GetType<uint32_t>());
+      break;
+    case F_HASHCHAR:
+      // hash_uint32((int32) PG_GETARG_CHAR(0)), char is signed
+      llvm_key = irb->CreateSExt(
+          codegen_utils->CreateDatumToCppTypeCast<int8_t>(llvm_datum),
+          codegen_utils->GetType<uint32_t>());
+      break;
+    case F_HASHINT4:
+    case F_HASHOID:
+    case F_HASHENUM:
+      llvm_key = codegen_utils->CreateDatumToCppTypeCast<uint32_t>(llvm_datum);
+      break;
+    case F_HASHINT8: {
+      // lohalf ^= (val >= 0) ? hihalf : ~hihalf;
+      llvm::Value* llvm_lohalf =
+          codegen_utils->CreateDatumToCppTypeCast<uint32_t>(llvm_datum);
+      llvm::Value* llvm_hihalf = irb->CreateTrunc(
+          irb->CreateAShr(llvm_datum, 32),
+          codegen_utils->GetType<uint32_t>());
+      llvm::Value* llvm_is_non_negative = irb->CreateICmpSGE(
+          llvm_datum, codegen_utils->GetConstant<int64_t>(0));
+      llvm_key = irb->CreateXor(
+          llvm_lohalf,
+          irb->CreateSelect(llvm_is_non_negative,
+                            llvm_hihalf,
+                            irb->CreateNot(llvm_hihalf)));
+      break;
+    }
+    default:
+      return nullptr;
+  }
+
+  return GenerateHashUInt32(codegen_utils, llvm_key);
+}
+
+llvm::Value* PGHashFuncGenerator::GenerateHashUInt32(
+    GpCodegenUtils* codegen_utils,
+    llvm::Value* llvm_key) {
+  assert(nullptr != codegen_utils);
+  assert(nullptr != llvm_key);
+  llvm::IRBuilder<>* irb = codegen_utils->ir_builder();
+
+  // a = b = c = 0x9e3779b9 + (uint32) sizeof(uint32) + 3923095;
+  // a += k;
+  llvm::Value* llvm_init = codegen_utils->GetConstant<uint32_t>(
+      0x9e3779b9 + static_cast<uint32_t>(sizeof(uint32_t)) + 3923095);
+  llvm::Value* a = irb->CreateAdd(llvm_init, llvm_key);
+  llvm::Value* b = llvm_init;
+  llvm::Value* c = llvm_init;
+
+  // final(a, b, c), where each step is "x ^= y; x -= rot(y, k);"
+  auto final_step = [&](llvm::Value* x, llvm::Value* y, int k) {
+    return irb->CreateSub(irb->CreateXor(x, y),
+                          GenerateRotate(codegen_utils, y, k));
+  };
+  c = final_step(c, b, 14);
+  a = final_step(a, c, 11);
+  b = final_step(b, a, 25);
+  c = final_step(c, b, 16);
+  a = final_step(a, c, 4);
+  b = final_step(b, a, 14);
+  c = final_step(c, b, 24);
+
+  return c;
+}
+
+llvm::Value* PGHashFuncGenerator::GenerateRotate(
+    GpCodegenUtils* codegen_utils,
+    llvm::Value* llvm_value,
+    int k) {
+  assert(k > 0 && k < 32);
+  llvm::IRBuilder<>* irb = codegen_utils->ir_builder();
+  return irb->CreateOr(irb->CreateShl(llvm_value, k),
+                       irb->CreateLShr(llvm_value, 32 - k));
+}
@@ -12,6 +12,8 @@
 
 #include "codegen/pg_numeric_func_generator.h"
 
+#include <limits>
+
 using gpcodegen::GpCodegenUtils;
 using gpcodegen::PGNumericFuncGenerator;
 using gpcodegen::PGFuncGeneratorInfo;
@@ -158,3 +160,98 @@ bool PGNumericFuncGenerator::GeneratePallocTransdata(
   *llvm_out_trandata_ptr = llvm_transdata_ptr;
   return true;
 }
+
+llvm::Value* PGNumericFuncGenerator::GenerateFloat8ArrayValues(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    const gpcodegen::PGFuncGeneratorInfo& pg_func_info,
+    llvm::Value* llvm_transarray,
+    const char* caller) {
+  auto irb = codegen_utils->ir_builder();
+
+  llvm::BasicBlock* valid_array_block = codegen_utils->CreateBasicBlock(
+      "valid_array_block", pg_func_info.llvm_main_func);
+  llvm::BasicBlock* invalid_array_block = codegen_utils->CreateBasicBlock(
+      "invalid_array_block", pg_func_info.llvm_main_func);
+
+  // if (ARR_NDIM(transarray) != 1 ||
+  //     ARR_DIMS(transarray)[0] != n ||
+  //     ARR_HASNULL(transarray) ||
+  //     ARR_ELEMTYPE(transarray) != FLOAT8OID) {{
+  llvm::Value* llvm_ndim = irb->CreateLoad(
+      codegen_utils->GetPointerToMember(llvm_transarray, &ArrayType::ndim));
+  llvm::Value* llvm_dim0 = irb->CreateLoad(irb->CreateBitCast(
+      irb->CreateInBoundsGEP(llvm_transarray,
+                             codegen_utils->GetConstant(sizeof(ArrayType))),
+      codegen_utils->GetType<int*>()));
+  llvm::Value* llvm_dataoffset = irb->CreateLoad(
+      codegen_utils->GetPointerToMember(llvm_transarray,
+                                        &ArrayType::dataoffset));
+  llvm::Value* llvm_elemtype = irb->CreateLoad(
+      codegen_utils->GetPointerToMember(llvm_transarray,
+                                        &ArrayType::elemtype));
+  llvm::Value* llvm_is_valid = irb->CreateAnd(
+      irb->CreateAnd(
+          irb->CreateICmpEQ(llvm_ndim, codegen_utils->GetConstant<int>(1)),
+          irb->CreateICmpEQ(llvm_dim0, codegen_utils->GetConstant<int>(3))),
+      irb->CreateAnd(
+          irb->CreateICmpEQ(llvm_dataoffset,
+                            codegen_utils->GetConstant<int32>(0)),
+          irb->CreateICmpEQ(llvm_elemtype,
+                            codegen_utils->GetConstant<Oid>(FLOAT8OID))));
+  irb->CreateCondBr(llvm_is_valid, valid_array_block, invalid_array_block);
+  // }}
+
+  irb->SetInsertPoint(invalid_array_block);
+  // elog(ERROR, "%s: expected %d-element float8 array", caller, n);
+  EXPAND_CREATE_ELOG(codegen_utils, ERROR,
+                     "%s: expected 3-element float8 array",
+                     codegen_utils->GetConstant(caller));
+  irb->CreateBr(pg_func_info.llvm_error_block);
+
+  irb->SetInsertPoint(valid_array_block);
+  // return (float8 *) ARR_DATA_PTR(transarray);
+  return irb->CreateBitCast(
+      irb->CreateInBoundsGEP(llvm_transarray, codegen_utils->GetConstant(
+          static_cast<int64>(ARR_OVERHEAD_NONULLS(1)))),
+      codegen_utils->GetType<float8*>());
+}
+
+void PGNumericFuncGenerator::GenerateFloatOverflowCheck(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    const gpcodegen::PGFuncGeneratorInfo& pg_func_info,
+    llvm::Value* llvm_val,
+    llvm::Value* llvm_arg0,
+    llvm::Value* llvm_arg1) {
+  auto irb = codegen_utils->ir_builder();
+
+  llvm::Value* llvm_inf = codegen_utils->GetConstant<float8>(
+      std::numeric_limits<float8>::infinity());
+  llvm::Value* llvm_minus_inf = codegen_utils->GetConstant<float8>(
+      -std::numeric_limits<float8>::infinity());
+  auto is_inf = [irb, llvm_inf, llvm_minus_inf](llvm::Value* llvm_x) {
+    return irb->CreateOr(irb->CreateFCmpOEQ(llvm_x, llvm_inf),
+                         irb->CreateFCmpOEQ(llvm_x, llvm_minus_inf));
+  };
+
+  llvm::BasicBlock* overflow_block = codegen_utils->CreateBasicBlock(
+      "float_overflow_block", pg_func_info.llvm_main_func);
+  llvm::BasicBlock* non_overflow_block = codegen_utils->CreateBasicBlock(
+      "float_non_overflow_block", pg_func_info.llvm_main_func);
+
+  // if (isinf(val) && !(isinf(arg0) || isinf(arg1)))
+  irb->CreateCondBr(
+      irb->CreateAnd(is_inf(llvm_val),
+                     irb->CreateNot(irb->CreateOr(is_inf(llvm_arg0),
+                                                  is_inf(llvm_arg1)))),
+      overflow_block /* true */,
+      non_overflow_block /* false */);
+
+  irb->SetInsertPoint(overflow_block);
+  EXPAND_CREATE_EREPORT(codegen_utils,
+                        ERROR,
+                        ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE,
+                        "value out of range: overflow");
+  irb->CreateBr(pg_func_info.llvm_error_block);
+
+  irb->SetInsertPoint(non_overflow_block);
+}
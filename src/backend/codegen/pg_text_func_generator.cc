@@ -0,0 +1,397 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    pg_text_func_generator.cc
+//
+//  @doc:
+//    Base class for text and bpchar functions to generate code
+//
+//---------------------------------------------------------------------------
+
+#include <assert.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "codegen/pg_func_generator_interface.h"
+#include "codegen/pg_text_func_generator.h"
+#include "codegen/utils/gp_codegen_utils.h"
+
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/IRBuilder.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "fmgr.h"
+#include "utils/elog.h"
+#include "utils/pg_locale.h"
+}
+
+using gpcodegen::GpCodegenUtils;
+using gpcodegen::PGTextFuncGenerator;
+using gpcodegen::PGFuncGeneratorInfo;
+
+llvm::Value* PGTextFuncGenerator::GenerateDetoast(
+    GpCodegenUtils* codegen_utils,
+    llvm::Value* llvm_varlena_ptr) {
+  auto irb = codegen_utils->ir_builder();
+  llvm::Function* llvm_main_func = irb->GetInsertBlock()->getParent();
+  llvm::Function* llvm_pg_detoast_datum = codegen_utils->
+      GetOrRegisterExternalFunction(pg_detoast_datum, "pg_detoast_datum");
+
+  llvm::BasicBlock* llvm_entry_block = irb->GetInsertBlock();
+  llvm::BasicBlock* llvm_detoast_block = codegen_utils->CreateBasicBlock(
+      "detoast_block", llvm_main_func);
+  llvm::BasicBlock* llvm_detoast_done_block = codegen_utils->CreateBasicBlock(
+      "detoast_done_block", llvm_main_func);
+
+  // if (VARATT_IS_EXTENDED(ptr)) ptr = pg_detoast_datum(ptr); {{{
+  llvm::Value* llvm_header = irb->CreateLoad(llvm_varlena_ptr);
+  llvm::Value* llvm_is_4b_u = irb->CreateICmpEQ(
+      irb->CreateAnd(llvm_header, codegen_utils->GetConstant<uint8_t>(0xC0)),
+      codegen_utils->GetConstant<uint8_t>(0));
+  irb->CreateCondBr(llvm_is_4b_u, llvm_detoast_done_block,
+                    llvm_detoast_block);
+
+  irb->SetInsertPoint(llvm_detoast_block);
+  llvm::Value* llvm_detoasted_ptr = irb->CreateCall(
+      llvm_pg_detoast_datum, {llvm_varlena_ptr});
+  irb->CreateBr(llvm_detoast_done_block);
+
+  irb->SetInsertPoint(llvm_detoast_done_block);
+  llvm::PHINode* llvm_result = irb->CreatePHI(
+      codegen_utils->GetType<void*>(), 2);
+  llvm_result->addIncoming(llvm_varlena_ptr, llvm_entry_block);
+  llvm_result->addIncoming(llvm_detoasted_ptr, llvm_detoast_block);
+  // }}}
+  return llvm_result;
+}
+
+void PGTextFuncGenerator::GenerateVarlenaDataAndLength(
+    GpCodegenUtils* codegen_utils,
+    llvm::Value* llvm_varlena_ptr,
+    llvm::Value** llvm_out_data,
+    llvm::Value** llvm_out_len) {
+  assert(nullptr != llvm_out_data);
+  assert(nullptr != llvm_out_len);
+  auto irb = codegen_utils->ir_builder();
+  llvm::Function* llvm_main_func = irb->GetInsertBlock()->getParent();
+
+  llvm::BasicBlock* llvm_short_block = codegen_utils->CreateBasicBlock(
+      "varlena_short_block", llvm_main_func);
+  llvm::BasicBlock* llvm_long_block = codegen_utils->CreateBasicBlock(
+      "varlena_long_block", llvm_main_func);
+  llvm::BasicBlock* llvm_done_block = codegen_utils->CreateBasicBlock(
+      "varlena_done_block", llvm_main_func);
+
+  // Short header datums, which are the common case for small values read
+  // from disk, don't need to be detoasted.
+  // VARATT_IS_1B(ptr) && !VARATT_IS_1B_E(ptr) {{{
+  llvm::Value* llvm_header = irb->CreateLoad(llvm_varlena_ptr);
+  llvm::Value* llvm_is_short = irb->CreateAnd(
+      irb->CreateICmpEQ(
+          irb->CreateAnd(llvm_header,
+                         codegen_utils->GetConstant<uint8_t>(0x80)),
+          codegen_utils->GetConstant<uint8_t>(0x80)),
+      irb->CreateICmpNE(llvm_header,
+                        codegen_utils->GetConstant<uint8_t>(0x80)));
+  irb->CreateCondBr(llvm_is_short, llvm_short_block, llvm_long_block);
+  // }}}
+
+  // VARSIZE_1B(ptr) - VARHDRSZ_SHORT and VARDATA_1B(ptr) {{{
+  irb->SetInsertPoint(llvm_short_block);
+  llvm::Value* llvm_short_len = irb->CreateSub(
+      irb->CreateZExt(
+          irb->CreateAnd(llvm_header,
+                         codegen_utils->GetConstant<uint8_t>(0x7F)),
+          codegen_utils->GetType<int32_t>()),
+      codegen_utils->GetConstant<int32_t>(VARHDRSZ_SHORT));
+  llvm::Value* llvm_short_data = irb->CreateInBoundsGEP(
+      llvm_varlena_ptr, {codegen_utils->GetConstant<int32_t>(VARHDRSZ_SHORT)});
+  irb->CreateBr(llvm_done_block);
+  // }}}
+
+  // VARSIZE_4B(ptr) - VARHDRSZ and VARDATA_4B(ptr) {{{
+  irb->SetInsertPoint(llvm_long_block);
+  llvm::Value* llvm_plain_ptr = GenerateDetoast(codegen_utils,
+                                                llvm_varlena_ptr);
+  // The 4-byte header is stored in network byte order, with the two flag
+  // bits in the first byte.
+  llvm::Value* llvm_long_size = codegen_utils->GetConstant<int32_t>(0);
+  for (int i = 0; i < 4; ++i) {
+    llvm::Value* llvm_byte = irb->CreateLoad(irb->CreateInBoundsGEP(
+        llvm_plain_ptr, {codegen_utils->GetConstant<int32_t>(i)}));
+    if (0 == i) {
+      llvm_byte = irb->CreateAnd(llvm_byte,
+                                 codegen_utils->GetConstant<uint8_t>(0x3F));
+    }
+    llvm_long_size = irb->CreateOr(
+        irb->CreateShl(llvm_long_size, 8),
+        irb->CreateZExt(llvm_byte, codegen_utils->GetType<int32_t>()));
+  }
+  llvm::Value* llvm_long_len = irb->CreateSub(
+      llvm_long_size, codegen_utils->GetConstant<int32_t>(VARHDRSZ));
+  llvm::Value* llvm_long_data = irb->CreateInBoundsGEP(
+      llvm_plain_ptr, {codegen_utils->GetConstant<int32_t>(VARHDRSZ)});
+  llvm::BasicBlock* llvm_long_end_block = irb->GetInsertBlock();
+  irb->CreateBr(llvm_done_block);
+  // }}}
+
+  irb->SetInsertPoint(llvm_done_block);
+  llvm::PHINode* llvm_data = irb->CreatePHI(
+      codegen_utils->GetType<char*>(), 2);
+  llvm_data->addIncoming(llvm_short_data, llvm_short_block);
+  llvm_data->addIncoming(llvm_long_data, llvm_long_end_block);
+  llvm::PHINode* llvm_len = irb->CreatePHI(
+      codegen_utils->GetType<int32_t>(), 2);
+  llvm_len->addIncoming(llvm_short_len, llvm_short_block);
+  llvm_len->addIncoming(llvm_long_len, llvm_long_end_block);
+  *llvm_out_data = llvm_data;
+  *llvm_out_len = llvm_len;
+}
+
+llvm::Value* PGTextFuncGenerator::GenerateBpcharTrueLen(
+    GpCodegenUtils* codegen_utils,
+    llvm::Value* llvm_data,
+    llvm::Value* llvm_len) {
+  auto irb = codegen_utils->ir_builder();
+  llvm::Function* llvm_main_func = irb->GetInsertBlock()->getParent();
+
+  llvm::BasicBlock* llvm_entry_block = irb->GetInsertBlock();
+  llvm::BasicBlock* llvm_loop_cond_block = codegen_utils->CreateBasicBlock(
+      "truelen_cond_block", llvm_main_func);
+  llvm::BasicBlock* llvm_loop_body_block = codegen_utils->CreateBasicBlock(
+      "truelen_body_block", llvm_main_func);
+  llvm::BasicBlock* llvm_done_block = codegen_utils->CreateBasicBlock(
+      "truelen_done_block", llvm_main_func);
+  irb->CreateBr(llvm_loop_cond_block);
+
+  // for (i = len; i > 0 && s[i - 1] == ' '; i--); return i; {{{
+  irb->SetInsertPoint(llvm_loop_cond_block);
+  llvm::PHINode* llvm_i = irb->CreatePHI(codegen_utils->GetType<int32_t>(), 2);
+  llvm_i->addIncoming(llvm_len, llvm_entry_block);
+  irb->CreateCondBr(
+      irb->CreateICmpSGT(llvm_i, codegen_utils->GetConstant<int32_t>(0)),
+      llvm_loop_body_block, llvm_done_block);
+
+  irb->SetInsertPoint(llvm_loop_body_block);
+  llvm::Value* llvm_i_minus_1 = irb->CreateSub(
+      llvm_i, codegen_utils->GetConstant<int32_t>(1));
+  llvm::Value* llvm_char = irb->CreateLoad(
+      irb->CreateInBoundsGEP(llvm_data, {llvm_i_minus_1}));
+  llvm_i->addIncoming(llvm_i_minus_1, llvm_loop_body_block);
+  irb->CreateCondBr(
+      irb->CreateICmpEQ(llvm_char, codegen_utils->GetConstant<char>(' ')),
+      llvm_loop_cond_block, llvm_done_block);
+  // }}}
+
+  irb->SetInsertPoint(llvm_done_block);
+  return llvm_i;
+}
+
+void PGTextFuncGenerator::GenerateArgs(
+    GpCodegenUtils* codegen_utils,
+    const PGFuncGeneratorInfo& pg_func_info,
+    bool is_bpchar,
+    llvm::Value* llvm_data[2],
+    llvm::Value* llvm_len[2]) {
+  assert(pg_func_info.llvm_args.size() >= 2);
+  for (int i = 0; i < 2; ++i) {
+    GenerateVarlenaDataAndLength(codegen_utils, pg_func_info.llvm_args[i],
+                                 &llvm_data[i], &llvm_len[i]);
+    if (is_bpchar) {
+      llvm_len[i] = GenerateBpcharTrueLen(codegen_utils,
+                                          llvm_data[i], llvm_len[i]);
+    }
+  }
+}
+
+bool PGTextFuncGenerator::GenerateEq(
+    GpCodegenUtils* codegen_utils,
+    const PGFuncGeneratorInfo& pg_func_info,
+    bool is_bpchar,
+    bool negate,
+    llvm::Value** llvm_out_value) {
+  auto irb = codegen_utils->ir_builder();
+  llvm::Function* llvm_memcmp =
+      codegen_utils->GetOrRegisterExternalFunction(memcmp, "memcmp");
+
+  llvm::Value* llvm_data[2];
+  llvm::Value* llvm_len[2];
+  GenerateArgs(codegen_utils, pg_func_info, is_bpchar, llvm_data, llvm_len);
+
+  llvm::BasicBlock* llvm_entry_block = irb->GetInsertBlock();
+  llvm::BasicBlock* llvm_memcmp_block = codegen_utils->CreateBasicBlock(
+      "eq_memcmp_block", pg_func_info.llvm_main_func);
+  llvm::BasicBlock* llvm_done_block = codegen_utils->CreateBasicBlock(
+      "eq_done_block", pg_func_info.llvm_main_func);
+
+  // Since we only care about equality or not-equality, we can avoid all the
+  // expense of strcoll() here, and just do bitwise comparison.
+  irb->CreateCondBr(irb->CreateICmpEQ(llvm_len[0], llvm_len[1]),
+                    llvm_memcmp_block, llvm_done_block);
+
+  irb->SetInsertPoint(llvm_memcmp_block);
+  llvm::Value* llvm_memcmp_result = irb->CreateCall(llvm_memcmp, {
+      llvm_data[0], llvm_data[1],
+      irb->CreateZExt(llvm_len[0], codegen_utils->GetType<size_t>())});
+  llvm::Value* llvm_is_equal = irb->CreateICmpEQ(
+      llvm_memcmp_result, codegen_utils->GetConstant<int>(0));
+  irb->CreateBr(llvm_done_block);
+
+  irb->SetInsertPoint(llvm_done_block);
+  llvm::PHINode* llvm_result = irb->CreatePHI(
+      codegen_utils->GetType<bool>(), 2);
+  llvm_result->addIncoming(codegen_utils->GetConstant<bool>(false),
+                           llvm_entry_block);
+  llvm_result->addIncoming(llvm_is_equal, llvm_memcmp_block);
+
+  *llvm_out_value = negate ? irb->CreateNot(llvm_result) : llvm_result;
+  return true;
+}
+
+bool PGTextFuncGenerator::GenerateCmp(
+    GpCodegenUtils* codegen_utils,
+    const PGFuncGeneratorInfo& pg_func_info,
+    bool is_bpchar,
+    llvm::CmpInst::Predicate pred,
+    llvm::Value** llvm_out_value) {
+  if (!lc_collate_is_c()) {
+    elog(DEBUG1, "Text ordering is only generated when LC_COLLATE is C");
+    return false;
+  }
+  assert(pg_func_info.llvm_args.size() >= 2);
+  auto irb = codegen_utils->ir_builder();
+  llvm::Value* llvm_cmp_result = GenerateTextCompare(
+      codegen_utils, pg_func_info.llvm_args[0], pg_func_info.llvm_args[1],
+      is_bpchar);
+  *llvm_out_value = irb->CreateICmp(pred, llvm_cmp_result,
+                                    codegen_utils->GetConstant<int>(0));
+  return true;
+}
+
+llvm::Value* PGTextFuncGenerator::GenerateTextCompare(
+    GpCodegenUtils* codegen_utils,
+    llvm::Value* llvm_arg0,
+    llvm::Value* llvm_arg1,
+    bool is_bpchar) {
+  assert(lc_collate_is_c());
+  auto irb = codegen_utils->ir_builder();
+  llvm::Function* llvm_memcmp =
+      codegen_utils->GetOrRegisterExternalFunction(memcmp, "memcmp");
+
+  llvm::Value* llvm_args[2] = {llvm_arg0, llvm_arg1};
+  llvm::Value* llvm_data[2];
+  llvm::Value* llvm_len[2];
+  for (int i = 0; i < 2; ++i) {
+    GenerateVarlenaDataAndLength(codegen_utils, llvm_args[i],
+                                 &llvm_data[i], &llvm_len[i]);
+    if (is_bpchar) {
+      llvm_len[i] = GenerateBpcharTrueLen(codegen_utils,
+                                          llvm_data[i], llvm_len[i]);
+    }
+  }
+
+  // varstr_cmp() for C collation {{{
+  // result = memcmp(arg1, arg2, Min(len1, len2));
+  llvm::Value* llvm_min_len = irb->CreateSelect(
+      irb->CreateICmpSLT(llvm_len[0], llvm_len[1]), llvm_len[0], llvm_len[1]);
+  llvm::Value* llvm_memcmp_result = irb->CreateCall(llvm_memcmp, {
+      llvm_data[0], llvm_data[1],
+      irb->CreateZExt(llvm_min_len, codegen_utils->GetType<size_t>())});
+  // if ((result == 0) && (len1 != len2)) result = (len1 < len2) ? -1 : 1;
+  llvm::Value* llvm_cmp_result = irb->CreateSelect(
+      irb->CreateICmpEQ(llvm_memcmp_result,
+                        codegen_utils->GetConstant<int>(0)),
+      irb->CreateSub(llvm_len[0], llvm_len[1]),
+      llvm_memcmp_result);
+  // }}}
+  return llvm_cmp_result;
+}
+
+bool PGTextFuncGenerator::GenerateLike(
+    GpCodegenUtils* codegen_utils,
+    const PGFuncGeneratorInfo& pg_func_info,
+    bool negate,
+    llvm::Value** llvm_out_value) {
+  assert(pg_func_info.llvm_args.size() >= 2);
+  auto irb = codegen_utils->ir_builder();
+
+  // The pattern must be known at generation time, i.e. a Const whose
+  // pointer was embedded into the generated code.
+  llvm::ConstantExpr* llvm_pattern_expr =
+      llvm::dyn_cast<llvm::ConstantExpr>(pg_func_info.llvm_args[1]);
+  llvm::ConstantInt* llvm_pattern_const = nullptr;
+  if (nullptr != llvm_pattern_expr &&
+      llvm::Instruction::IntToPtr == llvm_pattern_expr->getOpcode()) {
+    llvm_pattern_const =
+        llvm::dyn_cast<llvm::ConstantInt>(llvm_pattern_expr->getOperand(0));
+  }
+  if (nullptr == llvm_pattern_const) {
+    elog(DEBUG1, "LIKE is only generated for constant patterns");
+    return false;
+  }
+  struct varlena* pattern = pg_detoast_datum_packed(
+      reinterpret_cast<struct varlena*>(llvm_pattern_const->getZExtValue()));
+  const char* pattern_data = VARDATA_ANY(pattern);
+  int pattern_len = VARSIZE_ANY_EXHDR(pattern);
+
+  // Split 'literal%%%' into the literal and the trailing wildcards.
+  int literal_len = 0;
+  while (literal_len < pattern_len && '%' != pattern_data[literal_len]) {
+    if ('_' == pattern_data[literal_len] ||
+        '\\' == pattern_data[literal_len]) {
+      elog(DEBUG1, "LIKE pattern with '_' or escapes is not supported");
+      return false;
+    }
+    literal_len++;
+  }
+  for (int i = literal_len; i < pattern_len; ++i) {
+    if ('%' != pattern_data[i]) {
+      elog(DEBUG1, "LIKE pattern is neither a literal nor a prefix");
+      return false;
+    }
+  }
+  bool is_prefix = literal_len < pattern_len;
+
+  llvm::Function* llvm_memcmp =
+      codegen_utils->GetOrRegisterExternalFunction(memcmp, "memcmp");
+  llvm::Value* llvm_data = nullptr;
+  llvm::Value* llvm_len = nullptr;
+  GenerateVarlenaDataAndLength(codegen_utils, pg_func_info.llvm_args[0],
+                               &llvm_data, &llvm_len);
+  llvm::Value* llvm_literal_len =
+      codegen_utils->GetConstant<int32_t>(literal_len);
+  llvm::Value* llvm_len_matches = is_prefix ?
+      irb->CreateICmpSGE(llvm_len, llvm_literal_len) :
+      irb->CreateICmpEQ(llvm_len, llvm_literal_len);
+
+  llvm::BasicBlock* llvm_entry_block = irb->GetInsertBlock();
+  llvm::BasicBlock* llvm_memcmp_block = codegen_utils->CreateBasicBlock(
+      "like_memcmp_block", pg_func_info.llvm_main_func);
+  llvm::BasicBlock* llvm_done_block = codegen_utils->CreateBasicBlock(
+      "like_done_block", pg_func_info.llvm_main_func);
+  irb->CreateCondBr(llvm_len_matches, llvm_memcmp_block, llvm_done_block);
+
+  irb->SetInsertPoint(llvm_memcmp_block);
+  llvm::Value* llvm_literal = irb->CreateGlobalStringPtr(
+      std::string(pattern_data, literal_len), "like_literal");
+  llvm::Value* llvm_memcmp_result = irb->CreateCall(llvm_memcmp, {
+      llvm_data, llvm_literal,
+      codegen_utils->GetConstant<size_t>(literal_len)});
+  llvm::Value* llvm_is_match = irb->CreateICmpEQ(
+      llvm_memcmp_result, codegen_utils->GetConstant<int>(0));
+  irb->CreateBr(llvm_done_block);
+
+  irb->SetInsertPoint(llvm_done_block);
+  llvm::PHINode* llvm_result = irb->CreatePHI(
+      codegen_utils->GetType<bool>(), 2);
+  llvm_result->addIncoming(codegen_utils->GetConstant<bool>(false),
+                           llvm_entry_block);
+  llvm_result->addIncoming(llvm_is_match, llvm_memcmp_block);
+
+  *llvm_out_value = negate ? irb->CreateNot(llvm_result) : llvm_result;
+  return true;
+}
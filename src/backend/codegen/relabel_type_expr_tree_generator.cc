@@ -0,0 +1,71 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    relabel_type_expr_tree_generator.cc
+//
+//  @doc:
+//    Object that generate code for binary-compatible casts.
+//
+//---------------------------------------------------------------------------
+
+#include <assert.h>
+#include <memory>
+#include <utility>
+
+#include "codegen/expr_tree_generator.h"
+#include "codegen/relabel_type_expr_tree_generator.h"
+#include "codegen/utils/gp_codegen_utils.h"
+
+#include "llvm/IR/IRBuilder.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "nodes/execnodes.h"
+#include "nodes/nodes.h"
+#include "nodes/primnodes.h"
+#include "utils/elog.h"
+}
+
+using gpcodegen::RelabelTypeExprTreeGenerator;
+using gpcodegen::ExprTreeGenerator;
+using gpcodegen::GpCodegenUtils;
+
+bool RelabelTypeExprTreeGenerator::VerifyAndCreateExprTree(
+    const ExprState* expr_state,
+    ExprTreeGeneratorInfo* gen_info,
+    std::unique_ptr<ExprTreeGenerator>* expr_tree) {
+  assert(nullptr != expr_state &&
+         nullptr != expr_state->expr &&
+         T_RelabelType == nodeTag(expr_state->expr) &&
+         nullptr != expr_tree);
+  expr_tree->reset(nullptr);
+  const GenericExprState* generic_state =
+      reinterpret_cast<const GenericExprState*>(expr_state);
+  std::unique_ptr<ExprTreeGenerator> arg(nullptr);
+  if (!ExprTreeGenerator::VerifyAndCreateExprTree(generic_state->arg,
+                                                  gen_info,
+                                                  &arg)) {
+    return false;
+  }
+  expr_tree->reset(new RelabelTypeExprTreeGenerator(expr_state,
+                                                    std::move(arg)));
+  return true;
+}
+
+RelabelTypeExprTreeGenerator::RelabelTypeExprTreeGenerator(
+    const ExprState* expr_state,
+    std::unique_ptr<ExprTreeGenerator> arg) :
+    ExprTreeGenerator(expr_state, ExprTreeNodeType::kRelabel),
+    arg_(std::move(arg)) {
+}
+
+bool RelabelTypeExprTreeGenerator::GenerateCode(
+    GpCodegenUtils* codegen_utils,
+    const ExprTreeGeneratorInfo& gen_info,
+    llvm::Value** llvm_out_value,
+    llvm::Value* const llvm_isnull_ptr) {
+  return arg_->GenerateCode(codegen_utils, gen_info,
+                            llvm_out_value, llvm_isnull_ptr);
+}
@@ -0,0 +1,251 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    scalar_array_op_expr_tree_generator.cc
+//
+//  @doc:
+//    Object that generate code for scalar op ANY/ALL (array) expression.
+//
+//---------------------------------------------------------------------------
+
+#include <assert.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "codegen/expr_tree_generator.h"
+#include "codegen/op_expr_tree_generator.h"
+#include "codegen/pg_func_generator_interface.h"
+#include "codegen/scalar_array_op_expr_tree_generator.h"
+#include "codegen/utils/gp_codegen_utils.h"
+
+#include "llvm/IR/IRBuilder.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "nodes/execnodes.h"
+#include "nodes/nodes.h"
+#include "nodes/pg_list.h"
+#include "nodes/primnodes.h"
+#include "utils/array.h"
+#include "utils/elog.h"
+#include "utils/lsyscache.h"
+}
+
+using gpcodegen::ScalarArrayOpExprTreeGenerator;
+using gpcodegen::ExprTreeGenerator;
+using gpcodegen::GpCodegenUtils;
+using gpcodegen::OpExprTreeGenerator;
+using gpcodegen::PGFuncGeneratorInterface;
+using gpcodegen::PGFuncGeneratorInfo;
+
+constexpr int ScalarArrayOpExprTreeGenerator::kMaxArrayElements;
+
+bool ScalarArrayOpExprTreeGenerator::VerifyAndCreateExprTree(
+    const ExprState* expr_state,
+    ExprTreeGeneratorInfo* gen_info,
+    std::unique_ptr<ExprTreeGenerator>* expr_tree) {
+  assert(nullptr != expr_state &&
+         nullptr != expr_state->expr &&
+         T_ScalarArrayOpExpr == nodeTag(expr_state->expr) &&
+         nullptr != expr_tree);
+  expr_tree->reset(nullptr);
+  ScalarArrayOpExpr* op_expr =
+      reinterpret_cast<ScalarArrayOpExpr*>(expr_state->expr);
+
+  PGFuncGeneratorInterface* pg_func_gen =
+      OpExprTreeGenerator::GetPGFuncGenerator(op_expr->opfuncid);
+  if (nullptr == pg_func_gen) {
+    return Reject(gen_info, "ScalarArrayOpExpr operator function " +
+                  std::to_string(op_expr->opfuncid) + " is not supported");
+  }
+  // ExecEvalScalarArrayOp calls non-strict functions with NULL arguments,
+  // which we don't replicate.
+  if (!pg_func_gen->IsStrict() || 2 != pg_func_gen->GetTotalArgCount()) {
+    return Reject(gen_info, "ScalarArrayOpExpr operator function " +
+                  std::to_string(op_expr->opfuncid) +
+                  " is not a strict binary function");
+  }
+
+  List *arguments = reinterpret_cast<const ScalarArrayOpExprState*>(
+      expr_state)->fxprstate.args;
+  assert(2 == list_length(arguments));
+  ExprState *scalar_state = reinterpret_cast<ExprState*>(linitial(arguments));
+  ExprState *array_state = reinterpret_cast<ExprState*>(lsecond(arguments));
+
+  if (!IsA(array_state->expr, Const) ||
+      reinterpret_cast<Const*>(array_state->expr)->constisnull) {
+    return Reject(gen_info, "ScalarArrayOpExpr on a non-constant array");
+  }
+  ArrayType* array = DatumGetArrayTypeP(
+      reinterpret_cast<Const*>(array_state->expr)->constvalue);
+  int16 typlen = 0;
+  bool typbyval = false;
+  char typalign = 0;
+  get_typlenbyvalalign(ARR_ELEMTYPE(array), &typlen, &typbyval, &typalign);
+  if (!typbyval) {
+    return Reject(gen_info,
+                  "ScalarArrayOpExpr on an array of pass-by-reference type");
+  }
+  if (ArrayGetNItems(ARR_NDIM(array), ARR_DIMS(array)) > kMaxArrayElements) {
+    return Reject(gen_info, "ScalarArrayOpExpr array has more than " +
+                  std::to_string(kMaxArrayElements) + " elements");
+  }
+
+  std::unique_ptr<ExprTreeGenerator> scalar(nullptr);
+  if (!ExprTreeGenerator::VerifyAndCreateExprTree(scalar_state,
+                                                  gen_info,
+                                                  &scalar)) {
+    return false;
+  }
+
+  Datum* element_values = nullptr;
+  bool* element_isnulls = nullptr;
+  int num_elements = 0;
+  deconstruct_array(array, ARR_ELEMTYPE(array), typlen, typbyval, typalign,
+                    &element_values, &element_isnulls, &num_elements);
+  std::vector<Datum> elements(element_values, element_values + num_elements);
+  std::vector<bool> element_nulls(element_isnulls,
+                                  element_isnulls + num_elements);
+  if (nullptr != element_values) {
+    pfree(element_values);
+  }
+  if (nullptr != element_isnulls) {
+    pfree(element_isnulls);
+  }
+
+  expr_tree->reset(new ScalarArrayOpExprTreeGenerator(
+      expr_state, std::move(scalar),
+      std::move(elements), std::move(element_nulls)));
+  return true;
+}
+
+ScalarArrayOpExprTreeGenerator::ScalarArrayOpExprTreeGenerator(
+    const ExprState* expr_state,
+    std::unique_ptr<ExprTreeGenerator> scalar,
+    std::vector<Datum>&& elements,  // NOLINT(build/c++11)
+    std::vector<bool>&& element_nulls)  // NOLINT(build/c++11)
+    :  ExprTreeGenerator(expr_state, ExprTreeNodeType::kScalarArrayOp),
+       scalar_(std::move(scalar)),
+       elements_(std::move(elements)),
+       element_nulls_(std::move(element_nulls)) {
+  assert(elements_.size() == element_nulls_.size());
+}
+
+bool ScalarArrayOpExprTreeGenerator::GenerateCode(
+    GpCodegenUtils* codegen_utils,
+    const ExprTreeGeneratorInfo& gen_info,
+    llvm::Value** llvm_out_value,
+    llvm::Value* const llvm_isnull_ptr) {
+  assert(nullptr != llvm_out_value);
+  assert(nullptr != llvm_isnull_ptr);
+  *llvm_out_value = nullptr;
+  ScalarArrayOpExpr* op_expr =
+      reinterpret_cast<ScalarArrayOpExpr*>(expr_state()->expr);
+  bool use_or = op_expr->useOr;
+  auto irb = codegen_utils->ir_builder();
+  llvm::Function* llvm_main_func = gen_info.llvm_main_func;
+
+  PGFuncGeneratorInterface* pg_func_gen =
+      OpExprTreeGenerator::GetPGFuncGenerator(op_expr->opfuncid);
+  assert(nullptr != pg_func_gen);
+
+  // If the array is empty, we return either FALSE or TRUE per the useOr flag.
+  // This is correct even if the scalar is NULL.
+  if (elements_.empty()) {
+    irb->CreateStore(codegen_utils->GetConstant<bool>(false),
+                     llvm_isnull_ptr);
+    *llvm_out_value = codegen_utils->GetConstant<Datum>(!use_or);
+    return true;
+  }
+
+  llvm::Value* llvm_scalar_isnull_ptr = irb->CreateAlloca(
+      codegen_utils->GetType<bool>(), nullptr, "isNull");
+  irb->CreateStore(codegen_utils->GetConstant<bool>(false),
+                   llvm_scalar_isnull_ptr);
+  llvm::Value* llvm_scalar = nullptr;
+  if (!scalar_->GenerateCode(codegen_utils, gen_info,
+                             &llvm_scalar, llvm_scalar_isnull_ptr)) {
+    return false;
+  }
+
+  llvm::BasicBlock* llvm_scalar_null_block = codegen_utils->CreateBasicBlock(
+      "scalar_null_block", llvm_main_func);
+  llvm::BasicBlock* llvm_compare_block = codegen_utils->CreateBasicBlock(
+      "compare_block", llvm_main_func);
+  llvm::BasicBlock* llvm_decided_block = codegen_utils->CreateBasicBlock(
+      "decided_block", llvm_main_func);
+  llvm::BasicBlock* llvm_done_block = codegen_utils->CreateBasicBlock(
+      "scalar_array_op_done_block", llvm_main_func);
+
+  // The function is strict, so a NULL scalar yields NULL.
+  irb->CreateCondBr(irb->CreateLoad(llvm_scalar_isnull_ptr),
+                    llvm_scalar_null_block, llvm_compare_block);
+
+  irb->SetInsertPoint(llvm_compare_block);
+  llvm::Value* llvm_false = codegen_utils->GetConstant<bool>(false);
+  llvm::Value* llvm_any_null = llvm_false;
+  llvm::Value* llvm_func_isnull_ptr = irb->CreateAlloca(
+      codegen_utils->GetType<bool>(), nullptr, "func_isNull");
+  for (size_t i = 0; i < elements_.size(); ++i) {
+    if (element_nulls_[i]) {
+      // Strict function on a NULL element: the comparison yields NULL.
+      llvm_any_null = codegen_utils->GetConstant<bool>(true);
+      continue;
+    }
+    irb->CreateStore(llvm_false, llvm_func_isnull_ptr);
+    llvm::Value* llvm_cmp = nullptr;
+    PGFuncGeneratorInfo pg_func_info(
+        llvm_main_func,
+        gen_info.llvm_error_block,
+        {llvm_scalar, codegen_utils->GetConstant<Datum>(elements_[i])},
+        {llvm_false, llvm_false});
+    if (!pg_func_gen->GenerateCode(codegen_utils, pg_func_info,
+                                   &llvm_cmp, llvm_func_isnull_ptr)) {
+      return false;
+    }
+    llvm::Value* llvm_cmp_isnull = irb->CreateLoad(llvm_func_isnull_ptr);
+    llvm::Value* llvm_cmp_bool = codegen_utils->CreateDatumToCppTypeCast<bool>(
+        codegen_utils->CreateCppTypeToDatumCast(llvm_cmp));
+    if (!use_or) {
+      llvm_cmp_bool = irb->CreateNot(llvm_cmp_bool);
+    }
+    llvm_any_null = irb->CreateOr(llvm_any_null, llvm_cmp_isnull);
+
+    // For ANY a true comparison decides the result, for ALL a false one.
+    llvm::BasicBlock* llvm_next_block = codegen_utils->CreateBasicBlock(
+        "next_element_block", llvm_main_func);
+    irb->CreateCondBr(
+        irb->CreateAnd(irb->CreateNot(llvm_cmp_isnull), llvm_cmp_bool),
+        llvm_decided_block, llvm_next_block);
+    irb->SetInsertPoint(llvm_next_block);
+  }
+  // No comparison decided the result: it is !useOr, or NULL if any
+  // comparison was NULL.
+  irb->CreateStore(llvm_any_null, llvm_isnull_ptr);
+  llvm::BasicBlock* llvm_undecided_block = irb->GetInsertBlock();
+  irb->CreateBr(llvm_done_block);
+
+  irb->SetInsertPoint(llvm_decided_block);
+  irb->CreateStore(llvm_false, llvm_isnull_ptr);
+  irb->CreateBr(llvm_done_block);
+
+  irb->SetInsertPoint(llvm_scalar_null_block);
+  irb->CreateStore(codegen_utils->GetConstant<bool>(true), llvm_isnull_ptr);
+  irb->CreateBr(llvm_done_block);
+
+  irb->SetInsertPoint(llvm_done_block);
+  llvm::PHINode* llvm_result = irb->CreatePHI(
+      codegen_utils->GetType<Datum>(), 3);
+  llvm_result->addIncoming(codegen_utils->GetConstant<Datum>(!use_or),
+                           llvm_undecided_block);
+  llvm_result->addIncoming(codegen_utils->GetConstant<Datum>(use_or),
+                           llvm_decided_block);
+  llvm_result->addIncoming(codegen_utils->GetConstant<Datum>(0),
+                           llvm_scalar_null_block);
+  *llvm_out_value = llvm_result;
+  return true;
+}
@@ -0,0 +1,405 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    codegen_agg_unittest.cc
+//
+//  @doc:
+//    Unit tests for the aggregate code generators
+//
+//  @test:
+//
+//---------------------------------------------------------------------------
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "access/tupdesc.h"
+#include "executor/nodeAgg.h"
+#include "fmgr.h"
+#include "nodes/execnodes.h"
+#include "nodes/pg_list.h"
+#include "nodes/primnodes.h"
+#include "utils/fmgroids.h"
+#undef newNode  // undef newNode so it doesn't have name collision with llvm
+#include "utils/elog.h"
+#undef elog
+#define elog(...)
+}
+
+#include "codegen/utils/codegen_utils.h"
+#include "codegen/utils/gp_codegen_utils.h"
+#include "codegen/codegen_manager.h"
+#include "codegen/codegen_wrapper.h"
+#include "codegen/advance_aggregates_batch_codegen.h"
+#include "codegen/advance_aggregates_codegen.h"
+#include "codegen/op_expr_tree_generator.h"
+
+extern bool codegen_validate_functions;
+
+namespace gpcodegen {
+
+class CodegenAggTestEnvironment : public ::testing::Environment {
+ public:
+  virtual void SetUp() {
+    ASSERT_EQ(InitCodegen(), 1);
+  }
+};
+
+class CodegenAggTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    manager_.reset(new CodegenManager("CodegenAggTest"));
+    codegen_validate_functions = true;
+    memset(&aggstate_, 0, sizeof(aggstate_));
+    memset(&aggref_, 0, sizeof(aggref_));
+    memset(&inputbatch_, 0, sizeof(inputbatch_));
+  }
+
+  // Set up the AggState of a plain Agg with one aggregate per transition
+  // function, each taking a column of the input batch unless it is count(*).
+  void SetUpAggregates(const std::vector<Oid>& transfn_oids) {
+    int numaggs = transfn_oids.size();
+    peragg_.assign(numaggs, AggStatePerAggData());
+    pergroup_.assign(numaggs, AggStatePerGroupData());
+    values_.assign(numaggs * AGG_INPUT_BATCH_SIZE, 0);
+    isnull_.assign(numaggs * AGG_INPUT_BATCH_SIZE, false);
+    for (int aggno = 0; aggno < numaggs; aggno++) {
+      AggStatePerAgg peraggstate = &peragg_[aggno];
+      peraggstate->aggref = &aggref_;
+      peraggstate->transfn.fn_oid = transfn_oids[aggno];
+      peraggstate->transtypeByVal = true;
+      peraggstate->numArguments = (F_INT8INC == transfn_oids[aggno]) ? 0 : 1;
+    }
+    inputbatch_.values = values_.data();
+    inputbatch_.isnull = reinterpret_cast<bool*>(isnull_.data());
+    aggstate_.numaggs = numaggs;
+    aggstate_.peragg = peragg_.data();
+    aggstate_.inputbatch = &inputbatch_;
+  }
+
+  // Enroll the batch generator and generate its code
+  unsigned int GenerateAdvanceAggregatesBatch() {
+    EXPECT_TRUE(manager_->EnrollCodeGenerator(
+        CodegenFuncLifespan_Parameter_Invariant,
+        new AdvanceAggregatesBatchCodegen(manager_.get(),
+                                          advance_aggregates_batch,
+                                          &advance_aggregates_batch_fn_,
+                                          &aggstate_)));
+    return manager_->GenerateCode();
+  }
+
+  std::unique_ptr<CodegenManager> manager_;
+  AggState aggstate_;
+  Aggref aggref_;
+  AggInputBatch inputbatch_;
+  std::vector<AggStatePerAggData> peragg_;
+  std::vector<AggStatePerGroupData> pergroup_;
+  std::vector<Datum> values_;
+  std::vector<char> isnull_;
+  AdvanceAggregatesBatchFn advance_aggregates_batch_fn_ =
+      advance_aggregates_batch;
+};
+
+// Test that the generated loops agree with the transition functions
+TEST_F(CodegenAggTest, AdvanceAggregatesBatchTest) {
+  SetUpAggregates({F_INT8INC, F_INT8INC_ANY, F_INT4LARGER, F_INT4_SUM});
+  EXPECT_EQ(1, GenerateAdvanceAggregatesBatch());
+  EXPECT_EQ(1, manager_->PrepareGeneratedFunctions());
+  ASSERT_TRUE(advance_aggregates_batch != advance_aggregates_batch_fn_);
+
+  // Every tenth input is NULL
+  const int nrows = 100;
+  for (int aggno = 1; aggno < aggstate_.numaggs; aggno++) {
+    for (int row = 0; row < nrows; row++) {
+      values_[aggno * AGG_INPUT_BATCH_SIZE + row] = Int32GetDatum(row);
+      isnull_[aggno * AGG_INPUT_BATCH_SIZE + row] = (0 == row % 10);
+    }
+  }
+  // count starts at 0, max without a transition value and sum at NULL
+  pergroup_[0].transValue = Int64GetDatum(0);
+  pergroup_[1].transValue = Int64GetDatum(0);
+  pergroup_[2].transValueIsNull = true;
+  pergroup_[2].noTransValue = true;
+  pergroup_[3].transValueIsNull = true;
+  pergroup_[3].noTransValue = true;
+
+  advance_aggregates_batch_fn_(&aggstate_, pergroup_.data(), values_.data(),
+                               reinterpret_cast<bool*>(isnull_.data()),
+                               nrows);
+  EXPECT_EQ(100, DatumGetInt64(pergroup_[0].transValue));
+  EXPECT_EQ(90, DatumGetInt64(pergroup_[1].transValue));
+  EXPECT_FALSE(pergroup_[2].transValueIsNull);
+  EXPECT_EQ(99, DatumGetInt32(pergroup_[2].transValue));
+  EXPECT_FALSE(pergroup_[3].transValueIsNull);
+  // Sum of 0..99 without 0, 10, ..., 90
+  EXPECT_EQ(4950 - 450, DatumGetInt64(pergroup_[3].transValue));
+
+  // A batch of NULLs leaves max and sum alone
+  for (int row = 0; row < nrows; row++) {
+    isnull_[2 * AGG_INPUT_BATCH_SIZE + row] = true;
+    isnull_[3 * AGG_INPUT_BATCH_SIZE + row] = true;
+  }
+  advance_aggregates_batch_fn_(&aggstate_, pergroup_.data(), values_.data(),
+                               reinterpret_cast<bool*>(isnull_.data()),
+                               nrows);
+  EXPECT_EQ(200, DatumGetInt64(pergroup_[0].transValue));
+  EXPECT_EQ(99, DatumGetInt32(pergroup_[2].transValue));
+  EXPECT_EQ(4500, DatumGetInt64(pergroup_[3].transValue));
+}
+
+// Test which aggregates get their own loop
+TEST_F(CodegenAggTest, IsSupportedAggregateTest) {
+  SetUpAggregates({F_INT8INC, F_INT4_SUM, F_INT8_SUM});
+  EXPECT_TRUE(AdvanceAggregatesBatchCodegen::IsSupportedAggregate(
+      &peragg_[0]));
+  EXPECT_TRUE(AdvanceAggregatesBatchCodegen::IsSupportedAggregate(
+      &peragg_[1]));
+  EXPECT_FALSE(AdvanceAggregatesBatchCodegen::IsSupportedAggregate(
+      &peragg_[2]));
+
+  // Pass-by-reference transition types are only handled for avg
+  peragg_[1].transtypeByVal = false;
+  EXPECT_FALSE(AdvanceAggregatesBatchCodegen::IsSupportedAggregate(
+      &peragg_[1]));
+
+  // Nor are ordered aggregates
+  peragg_[0].numSortCols = 1;
+  EXPECT_FALSE(AdvanceAggregatesBatchCodegen::IsSupportedAggregate(
+      &peragg_[0]));
+}
+
+// Test that an unsupported aggregate does not keep the others from being
+// generated, and that it goes through advance_aggregate_batch
+TEST_F(CodegenAggTest, AdvanceAggregatesBatchFallbackTest) {
+  // sum(int8), whose transition type is numeric
+  SetUpAggregates({F_INT8INC, F_INT8_SUM});
+  peragg_[1].transtypeByVal = false;
+  EXPECT_EQ(1, GenerateAdvanceAggregatesBatch());
+
+  manager_->AccumulateExplainString();
+  const std::string& explain_string = manager_->GetExplainString();
+  EXPECT_NE(std::string::npos,
+            explain_string.find("@advance_aggregate_batch("));
+}
+
+// Test that nothing is generated if no aggregate gets its own loop
+TEST_F(CodegenAggTest, AdvanceAggregatesBatchNoSupportedAggregateTest) {
+  SetUpAggregates({F_INT8_SUM});
+  peragg_[0].transtypeByVal = false;
+  EXPECT_EQ(0, GenerateAdvanceAggregatesBatch());
+  EXPECT_EQ(0, manager_->PrepareGeneratedFunctions());
+  ASSERT_TRUE(advance_aggregates_batch == advance_aggregates_batch_fn_);
+}
+
+// Input of the current row, as evaluated by the input expression of the
+// aggregates, and the result of their FILTER expression.
+Datum current_input = 0;
+bool current_input_isnull = false;
+Datum current_filter = 0;
+bool current_filter_isnull = false;
+
+Datum EvalCurrentInput(ExprState* expression, ExprContext* econtext,
+                       bool* isNull, ExprDoneCond* isDone) {
+  if (nullptr != isDone) {
+    *isDone = ExprSingleResult;
+  }
+  *isNull = current_input_isnull;
+  return current_input;
+}
+
+Datum EvalCurrentFilter(ExprState* expression, ExprContext* econtext,
+                        bool* isNull, ExprDoneCond* isDone) {
+  if (nullptr != isDone) {
+    *isDone = ExprSingleResult;
+  }
+  *isNull = current_filter_isnull;
+  return current_filter;
+}
+
+// Strict transition function that sums int4 inputs into an int8, which has
+// no generator and is called through advance_aggregate_row.
+Datum TestInt4SumTransFn(PG_FUNCTION_ARGS) {
+  PG_RETURN_INT64(PG_GETARG_INT64(0) + PG_GETARG_INT32(1));
+}
+
+class CodegenAdvanceAggregatesTest : public CodegenAggTest {
+ protected:
+  virtual void SetUp() {
+    CodegenAggTest::SetUp();
+    memset(&tmpcontext_, 0, sizeof(tmpcontext_));
+    memset(&aggrefstate_, 0, sizeof(aggrefstate_));
+    memset(&filter_, 0, sizeof(filter_));
+    memset(&input_, 0, sizeof(input_));
+    memset(&input_gstate_, 0, sizeof(input_gstate_));
+    memset(&input_tle_, 0, sizeof(input_tle_));
+    memset(&input_cell_, 0, sizeof(input_cell_));
+    memset(&input_list_, 0, sizeof(input_list_));
+    memset(&evalproj_, 0, sizeof(evalproj_));
+    memset(&evaldesc_, 0, sizeof(evaldesc_));
+    current_input = 0;
+    current_input_isnull = false;
+    current_filter = BoolGetDatum(true);
+    current_filter_isnull = false;
+
+    // A single input, evaluated through ExecTargetList
+    input_.evalfunc = EvalCurrentInput;
+    input_tle_.resno = 1;
+    input_gstate_.xprstate.expr = reinterpret_cast<Expr*>(&input_tle_);
+    input_gstate_.arg = &input_;
+    input_cell_.data.ptr_value = &input_gstate_;
+    input_list_.type = T_List;
+    input_list_.length = 1;
+    input_list_.head = &input_cell_;
+    input_list_.tail = &input_cell_;
+    evalproj_.pi_isVarList = false;
+    evalproj_.pi_targetlist = &input_list_;
+    evalproj_.pi_exprContext = &tmpcontext_;
+    evalproj_.pi_itemIsDone = &item_is_done_;
+    evaldesc_.natts = 1;
+    aggref_.args = &input_list_;
+    filter_.evalfunc = EvalCurrentFilter;
+    aggstate_.tmpcontext = &tmpcontext_;
+  }
+
+  // Set up the AggState of a plain Agg with one aggregate of a single input
+  // per transition function. Those without a generator call
+  // TestInt4SumTransFn.
+  void SetUpRowAggregates(const std::vector<Oid>& transfn_oids) {
+    SetUpAggregates(transfn_oids);
+    for (AggStatePerAggData& peraggstate : peragg_) {
+      peraggstate.aggrefstate = &aggrefstate_;
+      peraggstate.evalproj = &evalproj_;
+      peraggstate.evaldesc = &evaldesc_;
+      peraggstate.numArguments = 1;
+      peraggstate.numInputs = 1;
+      peraggstate.transfn.fn_nargs = 2;
+      peraggstate.transfn.fn_addr = TestInt4SumTransFn;
+      // int4_sum is not strict, TestInt4SumTransFn is
+      peraggstate.transfn.fn_strict =
+          (F_INT4_SUM != peraggstate.transfn.fn_oid);
+    }
+  }
+
+  // Enroll the generator and generate its code
+  unsigned int GenerateAdvanceAggregates() {
+    EXPECT_TRUE(manager_->EnrollCodeGenerator(
+        CodegenFuncLifespan_Parameter_Invariant,
+        new AdvanceAggregatesCodegen(manager_.get(),
+                                     advance_aggregates,
+                                     &advance_aggregates_fn_,
+                                     &aggstate_)));
+    return manager_->GenerateCode();
+  }
+
+  std::string GetExplainString() {
+    manager_->AccumulateExplainString();
+    return manager_->GetExplainString();
+  }
+
+  // Advance the aggregates for one row
+  void AdvanceRow(int32_t value, bool isnull) {
+    current_input = Int32GetDatum(value);
+    current_input_isnull = isnull;
+    advance_aggregates_fn_(&aggstate_, pergroup_.data(), nullptr);
+  }
+
+  ExprContext tmpcontext_;
+  AggrefExprState aggrefstate_;
+  ExprState filter_;
+  ExprState input_;
+  GenericExprState input_gstate_;
+  TargetEntry input_tle_;
+  ListCell input_cell_;
+  List input_list_;
+  ExprDoneCond item_is_done_;
+  ProjectionInfo evalproj_;
+  tupleDesc evaldesc_;
+  AdvanceAggregatesFn advance_aggregates_fn_ = advance_aggregates;
+};
+
+// Test that rows whose FILTER is false or NULL are not aggregated
+TEST_F(CodegenAdvanceAggregatesTest, AdvanceAggregatesFilterTest) {
+  SetUpRowAggregates({F_INT4_SUM});
+  aggrefstate_.aggfilter = &filter_;
+  pergroup_[0].transValueIsNull = true;
+  pergroup_[0].noTransValue = true;
+  EXPECT_EQ(1, GenerateAdvanceAggregates());
+  EXPECT_EQ(1, manager_->PrepareGeneratedFunctions());
+  ASSERT_TRUE(advance_aggregates != advance_aggregates_fn_);
+
+  // FILTER (WHERE value % 3 = 0), which is NULL for 5
+  for (int32_t value = 1; value <= 10; value++) {
+    current_filter = BoolGetDatum(0 == value % 3);
+    current_filter_isnull = (5 == value);
+    AdvanceRow(value, false);
+  }
+  EXPECT_FALSE(pergroup_[0].transValueIsNull);
+  EXPECT_EQ(3 + 6 + 9, DatumGetInt64(pergroup_[0].transValue));
+}
+
+// Test that a transition function without a generator is called through
+// advance_aggregate_row, next to a generated one
+TEST_F(CodegenAdvanceAggregatesTest, AdvanceAggregateRowFallbackTest) {
+  SetUpRowAggregates({F_INT4_SUM, InvalidOid});
+  ASSERT_EQ(nullptr, OpExprTreeGenerator::GetPGFuncGenerator(InvalidOid));
+  pergroup_[0].transValueIsNull = true;
+  pergroup_[0].noTransValue = true;
+  pergroup_[1].transValue = Int64GetDatum(0);
+  EXPECT_EQ(1, GenerateAdvanceAggregates());
+  EXPECT_NE(std::string::npos,
+            GetExplainString().find("@advance_aggregate_row("));
+  EXPECT_EQ(1, manager_->PrepareGeneratedFunctions());
+  ASSERT_TRUE(advance_aggregates != advance_aggregates_fn_);
+
+  // The strict transition function skips NULLs
+  for (int32_t value = 1; value <= 10; value++) {
+    AdvanceRow(value, 0 == value % 4);
+  }
+  EXPECT_EQ(55 - 4 - 8, DatumGetInt64(pergroup_[0].transValue));
+  EXPECT_FALSE(pergroup_[1].transValueIsNull);
+  EXPECT_EQ(55 - 4 - 8, DatumGetInt64(pergroup_[1].transValue));
+}
+
+// Test that the input of an ORDER BY aggregate goes to its sorter, except
+// NULLs when the transition function is strict. The sorter itself needs
+// the catalog, so only the NULLs are run.
+TEST_F(CodegenAdvanceAggregatesTest, AdvanceOrderedAggregateTest) {
+  SetUpRowAggregates({F_INT4_SUM});
+  peragg_[0].numSortCols = 1;
+  peragg_[0].sortstate = nullptr;
+  peragg_[0].transfn.fn_strict = true;
+  EXPECT_EQ(1, GenerateAdvanceAggregates());
+  EXPECT_NE(std::string::npos,
+            GetExplainString().find("@switcheroo_tuplesort_putdatum("));
+  EXPECT_EQ(1, manager_->PrepareGeneratedFunctions());
+  ASSERT_TRUE(advance_aggregates != advance_aggregates_fn_);
+
+  AdvanceRow(0, true);
+  EXPECT_EQ(0, DatumGetInt64(pergroup_[0].transValue));
+}
+
+// Test that ORDER BY aggregates with more than one input are not generated
+TEST_F(CodegenAdvanceAggregatesTest, AdvanceOrderedAggregateInputsTest) {
+  SetUpRowAggregates({F_INT4_SUM});
+  peragg_[0].numSortCols = 1;
+  peragg_[0].numInputs = 2;
+  EXPECT_EQ(0, GenerateAdvanceAggregates());
+  ASSERT_TRUE(advance_aggregates == advance_aggregates_fn_);
+}
+
+}  // namespace gpcodegen
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  AddGlobalTestEnvironment(new gpcodegen::CodegenAggTestEnvironment);
+  return RUN_ALL_TESTS();
+}
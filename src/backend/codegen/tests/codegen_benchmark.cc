@@ -0,0 +1,264 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    codegen_benchmark.cc
+//
+//  @doc:
+//    Micro-benchmarks for generated code: compile latency per
+//    codegen_optimization_level and per-tuple time of the generated
+//    ExecVariableList and slot_getattr against the regular functions.
+//
+//  @test:
+//    The number of tuples per measurement can be set with the
+//    CODEGEN_BENCHMARK_TUPLES environment variable.
+//
+//---------------------------------------------------------------------------
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#undef newNode  // undef newNode so it doesn't have name collision with llvm
+#include "access/htup.h"
+#include "access/tupdesc.h"
+#include "executor/tuptable.h"
+#include "nodes/execnodes.h"
+#include "nodes/pg_list.h"
+#include "utils/elog.h"
+#include "utils/guc.h"
+#include "utils/memutils.h"
+#undef elog
+#define elog(...)
+}
+
+#include "codegen/codegen_manager.h"
+#include "codegen/codegen_wrapper.h"
+#include "codegen/exec_variable_list_codegen.h"
+#include "codegen/utils/codegen_utils.h"
+
+namespace gpcodegen {
+
+namespace {
+
+constexpr int kDefaultBenchmarkTuples = 1000000;
+
+int BenchmarkTuples() {
+  const char* env = std::getenv("CODEGEN_BENCHMARK_TUPLES");
+  return (nullptr != env && std::atoi(env) > 0) ? std::atoi(env)
+                                                : kDefaultBenchmarkTuples;
+}
+
+// A synthetic table layout: a fixed width byval column type per attribute,
+// and how often an attribute is NULL.
+struct TupleLayout {
+  std::string name;
+  std::vector<int> attlens;  // 4 (int4) or 8 (int8) for each attribute
+  int null_every;            // every null_every'th attribute is NULL; 0: none
+  bool project_last_only;    // project only the last attribute
+};
+
+}  // namespace
+
+class CodegenBenchmarkEnvironment : public ::testing::Environment {
+ public:
+  virtual void SetUp() {
+    MemoryContextInit();
+    ASSERT_EQ(InitCodegen(), 1);
+    codegen = true;
+    codegen_validate_functions = false;
+    codegen_async_compile = false;
+    // Every measurement must pay for compilation.
+    codegen_module_cache_size = 0;
+  }
+};
+
+class CodegenBenchmark : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    ntuples_ = BenchmarkTuples();
+  }
+
+  virtual void TearDown() {
+    codegen_optimization_level = CODEGEN_OPTIMIZATION_LEVEL_DEFAULT;
+  }
+
+  // Builds a slot with a heap tuple of the given layout, and a simple Var
+  // list projection over it, as ExecBuildProjectionInfo would for a scan.
+  void SetUpLayout(const TupleLayout& layout) {
+    int natts = layout.attlens.size();
+    TupleDesc tupdesc = CreateTemplateTupleDesc(natts, false);
+    for (int i = 0; i < natts; ++i) {
+      Form_pg_attribute attr = tupdesc->attrs[i];
+      memset(attr, 0, ATTRIBUTE_FIXED_PART_SIZE);
+      attr->attnum = i + 1;
+      attr->attlen = layout.attlens[i];
+      attr->attbyval = true;
+      attr->attalign = 8 == layout.attlens[i] ? 'd' : 'i';
+      attr->attstorage = 'p';
+      attr->attnotnull = 0 == layout.null_every;
+    }
+    slot_ = MakeSingleTupleTableSlot(tupdesc);
+
+    std::vector<Datum> values(natts);
+    // std::vector<bool> is packed, so use a plain array
+    std::unique_ptr<bool[]> isnull(new bool[natts]);
+    for (int i = 0; i < natts; ++i) {
+      values[i] = Int64GetDatum(i * 1000 + 7);
+      isnull[i] = 0 != layout.null_every && 0 == (i + 1) % layout.null_every;
+    }
+    tuple_ = heap_form_tuple(tupdesc, values.data(), isnull.get());
+
+    econtext_ = static_cast<ExprContext*>(palloc0(sizeof(ExprContext)));
+    econtext_->ecxt_scantuple = slot_;
+
+    int first_attno = layout.project_last_only ? natts : 1;
+    nprojected_ = natts - first_attno + 1;
+    proj_info_ = static_cast<ProjectionInfo*>(palloc0(sizeof(ProjectionInfo)));
+    proj_info_->type = T_ProjectionInfo;
+    proj_info_->pi_exprContext = econtext_;
+    proj_info_->pi_isVarList = true;
+    proj_info_->pi_varSlotOffsets =
+        static_cast<int*>(palloc(nprojected_ * sizeof(int)));
+    proj_info_->pi_varNumbers =
+        static_cast<int*>(palloc(nprojected_ * sizeof(int)));
+    proj_info_->pi_targetlist = NIL;
+    for (int i = 0; i < nprojected_; ++i) {
+      proj_info_->pi_varSlotOffsets[i] = offsetof(ExprContext, ecxt_scantuple);
+      proj_info_->pi_varNumbers[i] = first_attno + i;
+      // Only the length of the target list is looked at.
+      proj_info_->pi_targetlist = lappend(proj_info_->pi_targetlist, nullptr);
+    }
+    proj_info_->pi_lastScanVar = natts;
+  }
+
+  // Average nanoseconds per tuple to store a fresh tuple in the slot and
+  // project it with fn.
+  double NanosPerTuple(ExecVariableListFn fn,
+                       std::vector<Datum>* values,
+                       std::vector<bool>* isnull) {
+    std::unique_ptr<bool[]> isnull_array(new bool[nprojected_]);
+    values->resize(nprojected_);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ntuples_; ++i) {
+      ExecStoreHeapTuple(tuple_, slot_, InvalidBuffer, false);
+      fn(proj_info_, values->data(), isnull_array.get());
+    }
+    auto end = std::chrono::steady_clock::now();
+    isnull->assign(isnull_array.get(), isnull_array.get() + nprojected_);
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+        ntuples_;
+  }
+
+  // Generates and compiles ExecVariableList at each optimization level and
+  // reports the compile latency and the per-tuple time against the regular
+  // function.
+  void RunLayout(const TupleLayout& layout) {
+    SetUpLayout(layout);
+
+    std::vector<Datum> regular_values;
+    std::vector<bool> regular_isnull;
+    double regular_ns = NanosPerTuple(ExecVariableList,
+                                      &regular_values, &regular_isnull);
+
+    std::cout << layout.name << ": regular " << std::fixed
+              << std::setprecision(1) << regular_ns << " ns/tuple"
+              << std::endl;
+
+    for (int level = CODEGEN_OPTIMIZATION_LEVEL_NONE;
+         level <= CODEGEN_OPTIMIZATION_LEVEL_AGGRESSIVE; ++level) {
+      codegen_optimization_level = level;
+      CodegenManager manager("CodegenBenchmark");
+      ExecVariableListFn exec_variable_list_fn = ExecVariableList;
+      ASSERT_TRUE(manager.EnrollCodeGenerator(
+          CodegenFuncLifespan_Parameter_Invariant,
+          new ExecVariableListCodegen(&manager,
+                                      ExecVariableList,
+                                      &exec_variable_list_fn,
+                                      proj_info_,
+                                      slot_)));
+      ASSERT_EQ(1, manager.GenerateCode());
+      ASSERT_EQ(1, manager.PrepareGeneratedFunctions());
+      ASSERT_NE(ExecVariableList, exec_variable_list_fn);
+
+      CodegenTimes times;
+      manager.GetTimes(&times);
+
+      std::vector<Datum> generated_values;
+      std::vector<bool> generated_isnull;
+      double generated_ns = NanosPerTuple(exec_variable_list_fn,
+                                          &generated_values,
+                                          &generated_isnull);
+      EXPECT_EQ(regular_isnull, generated_isnull);
+      for (int i = 0; i < nprojected_; ++i) {
+        if (!regular_isnull[i]) {
+          EXPECT_EQ(regular_values[i], generated_values[i]);
+        }
+      }
+
+      std::cout << layout.name << ": O" << level
+                << " generate " << std::setprecision(3) << times.generate
+                << " ms, compile " << times.compile << " ms, "
+                << std::setprecision(1) << generated_ns << " ns/tuple, "
+                << std::setprecision(2) << regular_ns / generated_ns
+                << "x speedup" << std::endl;
+    }
+  }
+
+  int ntuples_;
+  int nprojected_;
+  TupleTableSlot* slot_;
+  HeapTuple tuple_;
+  ExprContext* econtext_;
+  ProjectionInfo* proj_info_;
+};
+
+TEST_F(CodegenBenchmark, NarrowInt4Test) {
+  RunLayout({"8 x int4", std::vector<int>(8, 4), 0, false});
+}
+
+TEST_F(CodegenBenchmark, WideMixedTest) {
+  std::vector<int> attlens;
+  for (int i = 0; i < 32; ++i) {
+    attlens.push_back(0 == i % 2 ? 4 : 8);
+  }
+  RunLayout({"32 x int4/int8", attlens, 0, false});
+}
+
+TEST_F(CodegenBenchmark, WideMixedNullsTest) {
+  std::vector<int> attlens;
+  for (int i = 0; i < 32; ++i) {
+    attlens.push_back(0 == i % 2 ? 4 : 8);
+  }
+  RunLayout({"32 x int4/int8, every 3rd NULL", attlens, 3, false});
+}
+
+// Projecting only the last attribute is dominated by the deforming done by
+// the generated slot_getattr.
+TEST_F(CodegenBenchmark, SlotGetAttrLastAttributeTest) {
+  std::vector<int> attlens;
+  for (int i = 0; i < 32; ++i) {
+    attlens.push_back(0 == i % 2 ? 4 : 8);
+  }
+  RunLayout({"32 x int4/int8, last attribute", attlens, 0, true});
+}
+
+}  // namespace gpcodegen
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  AddGlobalTestEnvironment(new gpcodegen::CodegenBenchmarkEnvironment);
+  return RUN_ALL_TESTS();
+}
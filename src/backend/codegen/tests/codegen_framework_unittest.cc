@@ -13,6 +13,7 @@
 //---------------------------------------------------------------------------
 
 #include <cassert>
+#include <chrono>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
@@ -22,6 +23,7 @@
 #include <limits>
 #include <memory>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -58,6 +60,7 @@ extern "C" {
 #include "codegen/utils/gp_codegen_utils.h"
 #include "codegen/utils/utility.h"
 #include "codegen/codegen_manager.h"
+#include "codegen/codegen_module_cache.h"
 #include "codegen/codegen_wrapper.h"
 #include "codegen/codegen_interface.h"
 #include "codegen/base_codegen.h"
@@ -69,6 +72,7 @@ namespace gpcodegen {
 typedef int (*SumFunc) (int x, int y);
 typedef void (*UncompilableFunc)(int x);
 typedef int (*MulFunc) (int x, int y);
+typedef int (*AddPointeeFunc) (int x);
 
 template <typename dest_type, typename src_type>
 using DatumCastFn = dest_type (*)(src_type);
@@ -85,6 +89,10 @@ int MulFuncRegular(int x, int y) {
   return x * y;
 }
 
+int AddPointeeFuncRegular(int x) {
+  return x;
+}
+
 SumFunc sum_func_ptr = nullptr;
 SumFunc failed_func_ptr = nullptr;
 UncompilableFunc uncompilable_func_ptr = nullptr;
@@ -202,6 +210,83 @@ class FailingCodeGenerator : public BaseCodegen<SumFunc> {
   static constexpr char kFailingFuncNamePrefix[] = "SumFuncFailing";
 };
 
+// Generates a function that adds the int pointed to by the addend given at
+// construction time to its argument.
+class AddPointeeCodeGenerator : public BaseCodegen<AddPointeeFunc> {
+ public:
+  explicit AddPointeeCodeGenerator(gpcodegen::CodegenManager* manager,
+                                   AddPointeeFunc regular_func_ptr,
+                                   AddPointeeFunc* ptr_to_regular_func_ptr,
+                                   const int* addend) :
+                                   BaseCodegen(manager,
+                                               kAddPointeeFuncNamePrefix,
+                                               regular_func_ptr,
+                                               ptr_to_regular_func_ptr),
+                                   addend_(addend) {
+  }
+
+  virtual ~AddPointeeCodeGenerator() = default;
+
+ protected:
+  bool GenerateCodeInternal(gpcodegen::GpCodegenUtils* codegen_utils) final {
+    llvm::Function* add_func
+       = CreateFunction<AddPointeeFunc>(codegen_utils, GetUniqueFuncName());
+    llvm::BasicBlock* add_body = codegen_utils->CreateBasicBlock("body",
+                                                                  add_func);
+    codegen_utils->ir_builder()->SetInsertPoint(add_body);
+    llvm::Value* llvm_addend = codegen_utils->ir_builder()->CreateLoad(
+        codegen_utils->GetConstant(addend_));
+    codegen_utils->ir_builder()->CreateRet(
+        codegen_utils->ir_builder()->CreateAdd(
+            ArgumentByPosition(add_func, 0), llvm_addend));
+    return true;
+  }
+
+ public:
+  static constexpr char kAddPointeeFuncNamePrefix[] = "AddPointeeFunc";
+
+ private:
+  const int* addend_;
+};
+
+// Generates a function that adds the current value of the addend given at
+// construction time to its argument, i.e. specializes on a parameter.
+class AddParameterCodeGenerator : public BaseCodegen<AddPointeeFunc> {
+ public:
+  explicit AddParameterCodeGenerator(gpcodegen::CodegenManager* manager,
+                                     AddPointeeFunc regular_func_ptr,
+                                     AddPointeeFunc* ptr_to_regular_func_ptr,
+                                     const int* addend) :
+                                     BaseCodegen(manager,
+                                                 kAddParameterFuncNamePrefix,
+                                                 regular_func_ptr,
+                                                 ptr_to_regular_func_ptr),
+                                     addend_(addend) {
+  }
+
+  virtual ~AddParameterCodeGenerator() = default;
+
+ protected:
+  bool GenerateCodeInternal(gpcodegen::GpCodegenUtils* codegen_utils) final {
+    llvm::Function* add_func
+       = CreateFunction<AddPointeeFunc>(codegen_utils, GetUniqueFuncName());
+    llvm::BasicBlock* add_body = codegen_utils->CreateBasicBlock("body",
+                                                                  add_func);
+    codegen_utils->ir_builder()->SetInsertPoint(add_body);
+    codegen_utils->ir_builder()->CreateRet(
+        codegen_utils->ir_builder()->CreateAdd(
+            ArgumentByPosition(add_func, 0),
+            codegen_utils->GetConstant<int>(*addend_)));
+    return true;
+  }
+
+ public:
+  static constexpr char kAddParameterFuncNamePrefix[] = "AddParameterFunc";
+
+ private:
+  const int* addend_;
+};
+
 template <bool GEN_SUCCESS>
 class UncompilableCodeGenerator : public BaseCodegen<UncompilableFunc> {
  public:
@@ -314,6 +399,8 @@ class CppToDatumCastGenerator :
 constexpr char SumCodeGenerator::kAddFuncNamePrefix[];
 constexpr char FailingCodeGenerator::kFailingFuncNamePrefix[];
 constexpr char MulOverflowCodeGenerator::kMulFuncNamePrefix[];
+constexpr char AddPointeeCodeGenerator::kAddPointeeFuncNamePrefix[];
+constexpr char AddParameterCodeGenerator::kAddParameterFuncNamePrefix[];
 template <typename dest_type>
 constexpr char
 DatumToCppCastGenerator<dest_type>::kDatumToCppCastFuncNamePrefix[];
@@ -832,6 +919,201 @@ TEST_F(CodegenManagerTest, TestDatumItemPtrCast) {
                         {p1, p2});
 }
 
+TEST_F(CodegenManagerTest, ModuleCacheReuseTest) {
+  codegen_module_cache_size = 4;
+  CodegenModuleCache* cache = CodegenModuleCache::GetInstance();
+  cache->Clear();
+  std::uint64_t hits = cache->hits();
+  std::uint64_t misses = cache->misses();
+
+  int first_addend = 1;
+  AddPointeeFunc first_func_ptr = nullptr;
+  ASSERT_TRUE(manager_->EnrollCodeGenerator(
+      CodegenFuncLifespan_Parameter_Invariant,
+      new AddPointeeCodeGenerator(manager_.get(), AddPointeeFuncRegular,
+                                  &first_func_ptr, &first_addend)));
+  EXPECT_EQ(1, manager_->GenerateCode());
+  EXPECT_EQ(1, manager_->PrepareGeneratedFunctions());
+  EXPECT_EQ(misses + 1, cache->misses());
+  ASSERT_TRUE(AddPointeeFuncRegular != first_func_ptr);
+  EXPECT_EQ(3, first_func_ptr(2));
+
+  // Destroying the manager returns the compiled module to the cache
+  manager_.reset(new CodegenManager("CodegenManagerTest"));
+  EXPECT_EQ(1, cache->size());
+  ASSERT_TRUE(AddPointeeFuncRegular == first_func_ptr);
+
+  // An identical generator for another addend reuses the compiled module,
+  // rebound to the new addend
+  int second_addend = 10;
+  AddPointeeFunc second_func_ptr = nullptr;
+  ASSERT_TRUE(manager_->EnrollCodeGenerator(
+      CodegenFuncLifespan_Parameter_Invariant,
+      new AddPointeeCodeGenerator(manager_.get(), AddPointeeFuncRegular,
+                                  &second_func_ptr, &second_addend)));
+  EXPECT_EQ(1, manager_->GenerateCode());
+  EXPECT_EQ(1, manager_->PrepareGeneratedFunctions());
+  EXPECT_EQ(hits + 1, cache->hits());
+  EXPECT_EQ(0, cache->size());
+  ASSERT_TRUE(AddPointeeFuncRegular != second_func_ptr);
+  EXPECT_EQ(12, second_func_ptr(2));
+  second_addend = 20;
+  EXPECT_EQ(22, second_func_ptr(2));
+
+  manager_.reset(nullptr);
+  EXPECT_EQ(1, cache->size());
+
+  codegen_module_cache_size = 0;
+  cache->Clear();
+  EXPECT_EQ(0, cache->size());
+}
+
+TEST_F(CodegenManagerTest, ParameterVariantRegenerationTest) {
+  int old_max_parameter_regenerations = codegen_max_parameter_regenerations;
+  codegen_max_parameter_regenerations = 1;
+
+  int addend = 1;
+  AddPointeeFunc add_func_ptr = nullptr;
+  sum_func_ptr = nullptr;
+  ASSERT_TRUE(manager_->EnrollCodeGenerator(
+      CodegenFuncLifespan_Parameter_Variant,
+      new AddParameterCodeGenerator(manager_.get(), AddPointeeFuncRegular,
+                                    &add_func_ptr, &addend)));
+  EnrollCodegen<SumCodeGenerator, SumFunc>(SumFuncRegular, &sum_func_ptr);
+  EXPECT_EQ(2, manager_->GetEnrollmentCount());
+
+  EXPECT_EQ(2, manager_->GenerateCode());
+  EXPECT_EQ(2, manager_->PrepareGeneratedFunctions());
+  ASSERT_TRUE(AddPointeeFuncRegular != add_func_ptr);
+  ASSERT_TRUE(SumFuncRegular != sum_func_ptr);
+  SumFunc invariant_func_ptr = sum_func_ptr;
+  EXPECT_EQ(3, add_func_ptr(2));
+
+  // Regenerated for the new value, leaving the invariant function alone
+  addend = 10;
+  EXPECT_EQ(1, manager_->NotifyParameterChange());
+  ASSERT_TRUE(AddPointeeFuncRegular != add_func_ptr);
+  EXPECT_EQ(12, add_func_ptr(2));
+  EXPECT_EQ(invariant_func_ptr, sum_func_ptr);
+  EXPECT_EQ(5, sum_func_ptr(2, 3));
+
+  // Past the regeneration limit we fall back to the regular function
+  addend = 20;
+  EXPECT_EQ(0, manager_->NotifyParameterChange());
+  ASSERT_TRUE(AddPointeeFuncRegular == add_func_ptr);
+  EXPECT_EQ(invariant_func_ptr, sum_func_ptr);
+
+  EXPECT_TRUE(manager_->InvalidateGeneratedFunctions());
+  ASSERT_TRUE(AddPointeeFuncRegular == add_func_ptr);
+  ASSERT_TRUE(SumFuncRegular == sum_func_ptr);
+
+  codegen_max_parameter_regenerations = old_max_parameter_regenerations;
+}
+
+TEST_F(CodegenManagerTest, BackgroundCompilationTest) {
+  bool old_async_compile = codegen_async_compile;
+  codegen_async_compile = true;
+
+  sum_func_ptr = nullptr;
+  EnrollCodegen<SumCodeGenerator, SumFunc>(SumFuncRegular, &sum_func_ptr);
+  EXPECT_EQ(1, manager_->GenerateCode());
+
+  // Callers keep using the regular function until the swap
+  EXPECT_EQ(0, manager_->PrepareGeneratedFunctions());
+  ASSERT_TRUE(manager_->HasPendingCompilation());
+  ASSERT_TRUE(SumFuncRegular == sum_func_ptr);
+
+  unsigned int swapped_count = 0;
+  for (int i = 0; i < 1000 && 0 == swapped_count; ++i) {
+    swapped_count = manager_->SwapInCompiledFunctions();
+    if (0 == swapped_count) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+  EXPECT_EQ(1, swapped_count);
+  EXPECT_FALSE(manager_->HasPendingCompilation());
+  ASSERT_TRUE(SumFuncRegular != sum_func_ptr);
+  EXPECT_EQ(5, sum_func_ptr(2, 3));
+  EXPECT_EQ(0, manager_->SwapInCompiledFunctions());
+
+  codegen_async_compile = old_async_compile;
+}
+
+TEST_F(CodegenManagerTest, BackgroundCompilationLimitTest) {
+  bool old_async_compile = codegen_async_compile;
+  codegen_async_compile = true;
+
+  sum_func_ptr = nullptr;
+  EnrollCodegen<SumCodeGenerator, SumFunc>(SumFuncRegular, &sum_func_ptr);
+  EXPECT_EQ(1, manager_->GenerateCode());
+  EXPECT_EQ(0, manager_->PrepareGeneratedFunctions());
+  ASSERT_TRUE(manager_->HasPendingCompilation());
+
+  // While the first manager owns the background thread, another one of the
+  // same backend compiles synchronously
+  std::unique_ptr<CodegenManager> other_manager(
+      new CodegenManager("CodegenManagerTestOther"));
+  SumFunc other_sum_func_ptr = nullptr;
+  ASSERT_TRUE(other_manager->EnrollCodeGenerator(
+      CodegenFuncLifespan_Parameter_Invariant,
+      new SumCodeGenerator(other_manager.get(), SumFuncRegular,
+                           &other_sum_func_ptr)));
+  EXPECT_EQ(1, other_manager->GenerateCode());
+  EXPECT_EQ(1, other_manager->PrepareGeneratedFunctions());
+  EXPECT_FALSE(other_manager->HasPendingCompilation());
+  ASSERT_TRUE(SumFuncRegular != other_sum_func_ptr);
+  EXPECT_EQ(5, other_sum_func_ptr(2, 3));
+
+  // Once the first manager is done with it, the thread is available again
+  manager_.reset(nullptr);
+  std::unique_ptr<CodegenManager> last_manager(
+      new CodegenManager("CodegenManagerTestLast"));
+  SumFunc last_sum_func_ptr = nullptr;
+  ASSERT_TRUE(last_manager->EnrollCodeGenerator(
+      CodegenFuncLifespan_Parameter_Invariant,
+      new SumCodeGenerator(last_manager.get(), SumFuncRegular,
+                           &last_sum_func_ptr)));
+  EXPECT_EQ(1, last_manager->GenerateCode());
+  EXPECT_EQ(0, last_manager->PrepareGeneratedFunctions());
+  EXPECT_TRUE(last_manager->HasPendingCompilation());
+
+  codegen_async_compile = old_async_compile;
+}
+
+TEST_F(CodegenManagerTest, AbortBackgroundCompilationTest) {
+  bool old_async_compile = codegen_async_compile;
+  codegen_async_compile = true;
+
+  sum_func_ptr = nullptr;
+  EnrollCodegen<SumCodeGenerator, SumFunc>(SumFuncRegular, &sum_func_ptr);
+  EXPECT_EQ(1, manager_->GenerateCode());
+  EXPECT_EQ(0, manager_->PrepareGeneratedFunctions());
+  ASSERT_TRUE(manager_->HasPendingCompilation());
+  EXPECT_TRUE(codegen_compilation_pending);
+
+  // An abort joins the thread even though the manager is not destroyed, and
+  // the compiled functions are never swapped in
+  CodegenManager::AbortBackgroundCompilation();
+  EXPECT_FALSE(manager_->HasPendingCompilation());
+  EXPECT_FALSE(codegen_compilation_pending);
+  EXPECT_EQ(0, manager_->SwapInCompiledFunctions());
+  ASSERT_TRUE(SumFuncRegular == sum_func_ptr);
+
+  // The next manager may compile in the background again
+  std::unique_ptr<CodegenManager> other_manager(
+      new CodegenManager("CodegenManagerTestOther"));
+  SumFunc other_sum_func_ptr = nullptr;
+  ASSERT_TRUE(other_manager->EnrollCodeGenerator(
+      CodegenFuncLifespan_Parameter_Invariant,
+      new SumCodeGenerator(other_manager.get(), SumFuncRegular,
+                           &other_sum_func_ptr)));
+  EXPECT_EQ(1, other_manager->GenerateCode());
+  EXPECT_EQ(0, other_manager->PrepareGeneratedFunctions());
+  EXPECT_TRUE(other_manager->HasPendingCompilation());
+
+  codegen_async_compile = old_async_compile;
+}
+
 }  // namespace gpcodegen
 
 int main(int argc, char **argv) {
@@ -12,6 +12,7 @@
 //
 //---------------------------------------------------------------------------
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
@@ -30,8 +31,17 @@
 
 extern "C" {
 #include "postgres.h"  // NOLINT(build/include)
+#include "fmgr.h"
+#include "catalog/pg_type.h"
+#include "nodes/execnodes.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/date.h"
+#include "utils/tuplesort_mk.h"
+#include "utils/tuplesort_mk_details.h"
 #undef newNode  // undef newNode so it doesn't have name collision with llvm
 #include "utils/elog.h"
+#include "utils/fmgroids.h"
 #undef elog
 #define elog(...)
 }
@@ -63,6 +73,10 @@ extern "C" {
 #include "codegen/base_codegen.h"
 #include "codegen/pg_func_generator.h"
 #include "codegen/pg_arith_func_generator.h"
+#include "codegen/pg_hash_func_generator.h"
+#include "codegen/pg_numeric_func_generator.h"
+#include "codegen/pg_text_func_generator.h"
+#include "codegen/tupsort_compare_datum_codegen.h"
 
 
 namespace gpcodegen {
@@ -377,6 +391,528 @@ TEST_F(CodegenPGFuncGeneratorTest, PGGenericFuncGeneratorOneArgTest) {
   EXPECT_EQ(3, fn(2));
 }
 
+// Reference implementation of hash_uint32 from hashfunc.c
+static uint32_t ReferenceHashUInt32(uint32_t k) {
+  auto rot = [](uint32_t x, int r) { return (x << r) | (x >> (32 - r)); };
+  uint32_t a, b, c;
+  a = b = c = 0x9e3779b9 + static_cast<uint32_t>(sizeof(uint32_t)) + 3923095;
+  a += k;
+  c ^= b; c -= rot(b, 14);
+  a ^= c; a -= rot(c, 11);
+  b ^= a; b -= rot(a, 25);
+  c ^= b; c -= rot(b, 16);
+  a ^= c; a -= rot(c, 4);
+  b ^= a; b -= rot(a, 14);
+  c ^= b; c -= rot(b, 24);
+  return c;
+}
+
+// Test that the inlined hashint4 and hashint8 agree with the regular ones
+TEST_F(CodegenPGFuncGeneratorTest, PGHashFuncGeneratorTest) {
+  using HashFn = uint32_t (*) (Datum);
+
+  EXPECT_TRUE(PGHashFuncGenerator::IsSupported(F_HASHINT4));
+  EXPECT_TRUE(PGHashFuncGenerator::IsSupported(F_HASHINT8));
+  EXPECT_FALSE(PGHashFuncGenerator::IsSupported(F_HASHTEXT));
+
+  auto irb = codegen_utils_->ir_builder();
+  for (Oid hash_func_oid : {F_HASHINT4, F_HASHINT8}) {
+    llvm::Function* hash_fn = codegen_utils_->CreateFunction<HashFn>(
+        "hash_fn_" + std::to_string(hash_func_oid));
+    irb->SetInsertPoint(codegen_utils_->CreateBasicBlock("main", hash_fn));
+    llvm::Value* result = PGHashFuncGenerator::GenerateHashDatum(
+        codegen_utils_.get(), hash_func_oid, ArgumentByPosition(hash_fn, 0));
+    ASSERT_NE(nullptr, result);
+    irb->CreateRet(result);
+    EXPECT_FALSE(llvm::verifyFunction(*hash_fn));
+  }
+  EXPECT_FALSE(llvm::verifyModule(*codegen_utils_->module()));
+
+  EXPECT_TRUE(codegen_utils_->PrepareForExecution(
+      CodegenUtils::OptimizationLevel::kNone,
+      true));
+
+  HashFn hashint4_fn = codegen_utils_->GetFunctionPointer<HashFn>(
+      "hash_fn_" + std::to_string(F_HASHINT4));
+  HashFn hashint8_fn = codegen_utils_->GetFunctionPointer<HashFn>(
+      "hash_fn_" + std::to_string(F_HASHINT8));
+
+  for (int32_t value : {0, 1, -1, 42, std::numeric_limits<int32_t>::max(),
+                        std::numeric_limits<int32_t>::min()}) {
+    uint32_t expected = ReferenceHashUInt32(static_cast<uint32_t>(value));
+    EXPECT_EQ(expected, hashint4_fn(static_cast<Datum>(value)));
+    // hashint8 is compatible with hashint4 for logically equal inputs
+    EXPECT_EQ(expected, hashint8_fn(static_cast<Datum>(
+        static_cast<int64_t>(value))));
+  }
+
+  int64_t big_value = (INT64CONST(7) << 40) + 5;
+  EXPECT_EQ(ReferenceHashUInt32(static_cast<uint32_t>(5) ^ (7 << 8)),
+            hashint8_fn(static_cast<Datum>(big_value)));
+}
+
+// Helper to build a text datum with either a 1-byte or a 4-byte header.
+std::vector<char> MakeTextDatum(const std::string& str, bool short_header) {
+  size_t header_size = short_header ? VARHDRSZ_SHORT : VARHDRSZ;
+  std::vector<char> buffer(header_size + str.size());
+  if (short_header) {
+    SET_VARSIZE_1B(buffer.data(), buffer.size());
+  } else {
+    SET_VARSIZE(buffer.data(), buffer.size());
+  }
+  std::copy(str.begin(), str.end(), buffer.begin() + header_size);
+  return buffer;
+}
+
+TEST_F(CodegenPGFuncGeneratorTest, PGTextFuncGeneratorEqTest) {
+  using TextEqFn = bool (*) (Datum, Datum);
+
+  auto irb = codegen_utils_->ir_builder();
+  std::vector<std::pair<std::string, PGFuncGeneratorFn>> generators = {
+      {"texteq_fn", &PGTextFuncGenerator::TextEq<false>},
+      {"bpchareq_fn", &PGTextFuncGenerator::BpcharEq<false>}};
+  for (auto& generator : generators) {
+    llvm::Function* eq_fn =
+        codegen_utils_->CreateFunction<TextEqFn>(generator.first);
+    irb->SetInsertPoint(codegen_utils_->CreateBasicBlock("main", eq_fn));
+    std::vector<llvm::Value*> args = {
+        irb->CreateIntToPtr(ArgumentByPosition(eq_fn, 0),
+                            codegen_utils_->GetType<void*>()),
+        irb->CreateIntToPtr(ArgumentByPosition(eq_fn, 1),
+                            codegen_utils_->GetType<void*>())};
+    PGFuncGeneratorInfo pg_gen_info(eq_fn, nullptr, args, {});
+    llvm::Value* result = nullptr;
+    EXPECT_TRUE(generator.second(codegen_utils_.get(), pg_gen_info, &result));
+    irb->CreateRet(result);
+    EXPECT_FALSE(llvm::verifyFunction(*eq_fn));
+  }
+  EXPECT_FALSE(llvm::verifyModule(*codegen_utils_->module()));
+
+  EXPECT_TRUE(codegen_utils_->PrepareForExecution(
+      CodegenUtils::OptimizationLevel::kNone,
+      true));
+  TextEqFn texteq_fn = codegen_utils_->GetFunctionPointer<TextEqFn>(
+      "texteq_fn");
+  TextEqFn bpchareq_fn = codegen_utils_->GetFunctionPointer<TextEqFn>(
+      "bpchareq_fn");
+
+  auto as_datum = [](const std::vector<char>& buffer) {
+    return reinterpret_cast<Datum>(buffer.data());
+  };
+  std::vector<char> abc_short = MakeTextDatum("abc", true);
+  std::vector<char> abc_long = MakeTextDatum("abc", false);
+  std::vector<char> abd_long = MakeTextDatum("abd", false);
+  std::vector<char> abc_padded = MakeTextDatum("abc  ", true);
+  std::vector<char> empty = MakeTextDatum("", false);
+
+  EXPECT_TRUE(texteq_fn(as_datum(abc_short), as_datum(abc_long)));
+  EXPECT_FALSE(texteq_fn(as_datum(abc_long), as_datum(abd_long)));
+  EXPECT_FALSE(texteq_fn(as_datum(abc_long), as_datum(abc_padded)));
+  EXPECT_FALSE(texteq_fn(as_datum(empty), as_datum(abc_short)));
+  EXPECT_TRUE(texteq_fn(as_datum(empty), as_datum(empty)));
+
+  // bpchar ignores trailing spaces
+  EXPECT_TRUE(bpchareq_fn(as_datum(abc_long), as_datum(abc_padded)));
+  EXPECT_FALSE(bpchareq_fn(as_datum(abd_long), as_datum(abc_padded)));
+  std::vector<char> spaces = MakeTextDatum("  ", true);
+  EXPECT_TRUE(bpchareq_fn(as_datum(empty), as_datum(spaces)));
+}
+
+// Helper to build the float8[3] transition array {N, sum(X), sum(X*X)} of
+// the float variance and stddev aggregates.
+std::vector<float8> MakeFloat8AccumArray(float8 N, float8 sumX, float8 sumX2) {
+  const std::size_t nbytes = ARR_OVERHEAD_NONULLS(1) + 3 * sizeof(float8);
+  std::vector<float8> buffer(nbytes / sizeof(float8));
+  ArrayType* array = reinterpret_cast<ArrayType*>(buffer.data());
+  SET_VARSIZE(array, nbytes);
+  array->ndim = 1;
+  array->dataoffset = 0;
+  array->elemtype = FLOAT8OID;
+  ARR_DIMS(array)[0] = 3;
+  ARR_LBOUND(array)[0] = 1;
+  float8* transvalues = reinterpret_cast<float8*>(ARR_DATA_PTR(array));
+  transvalues[0] = N;
+  transvalues[1] = sumX;
+  transvalues[2] = sumX2;
+  return buffer;
+}
+
+// Call a float accum function the way an Agg node does, so that it updates
+// the transition array in place.
+Datum CallFloatAccum(PGFunction accum_func, Datum transarray, Datum newval) {
+  AggState aggstate;
+  memset(&aggstate, 0, sizeof(aggstate));
+  aggstate.ss.ps.type = T_AggState;
+  FunctionCallInfoData fcinfo;
+  InitFunctionCallInfoData(fcinfo, nullptr, 2,
+                           reinterpret_cast<Node*>(&aggstate), nullptr);
+  fcinfo.arg[0] = transarray;
+  fcinfo.argnull[0] = false;
+  fcinfo.arg[1] = newval;
+  fcinfo.argnull[1] = false;
+  return accum_func(&fcinfo);
+}
+
+bool Float8Identical(float8 a, float8 b) {
+  return std::isnan(a) ? std::isnan(b) : a == b;
+}
+
+// Test that the generated float8_accum and float4_accum update the
+// transition array like the regular functions do
+TEST_F(CodegenPGFuncGeneratorTest, PGNumericFuncGeneratorFloatAccumTest) {
+  using AccumFn = Datum (*) (Datum, Datum, bool, bool);
+
+  auto irb = codegen_utils_->ir_builder();
+  std::vector<std::pair<std::string, PGFuncGeneratorInterface*>> generators = {
+      {"float8_accum_fn", new PGGenericFuncGenerator<void*, void*, float8>(
+          222,
+          "float8_accum",
+          &PGNumericFuncGenerator::GenerateFloatAccum<float8>,
+          nullptr,
+          true)},
+      {"float4_accum_fn", new PGGenericFuncGenerator<void*, void*, float>(
+          208,
+          "float4_accum",
+          &PGNumericFuncGenerator::GenerateFloatAccum<float>,
+          nullptr,
+          true)}};
+  for (auto& generator : generators) {
+    std::unique_ptr<PGFuncGeneratorInterface> pg_func_gen(generator.second);
+    llvm::Function* accum_fn =
+        codegen_utils_->CreateFunction<AccumFn>(generator.first);
+    llvm::BasicBlock* main_block =
+        codegen_utils_->CreateBasicBlock("main", accum_fn);
+    llvm::BasicBlock* error_block =
+        codegen_utils_->CreateBasicBlock("error", accum_fn);
+    irb->SetInsertPoint(main_block);
+
+    llvm::Value* result;
+    std::vector<llvm::Value*> args = {
+        ArgumentByPosition(accum_fn, 0),
+        ArgumentByPosition(accum_fn, 1)};
+    std::vector<llvm::Value*> args_isNull = {
+        ArgumentByPosition(accum_fn, 2),
+        ArgumentByPosition(accum_fn, 3)};
+    llvm::Value* llvm_isNull = irb->CreateAlloca(
+        codegen_utils_->GetType<bool>(), nullptr, "isNull");
+    irb->CreateStore(codegen_utils_->GetConstant<bool>(false), llvm_isNull);
+    PGFuncGeneratorInfo pg_gen_info(accum_fn, error_block, args,
+                                    args_isNull);
+    EXPECT_TRUE(pg_func_gen->GenerateCode(codegen_utils_.get(),
+                                          pg_gen_info, &result, llvm_isNull));
+    irb->CreateRet(codegen_utils_->CreateCppTypeToDatumCast(result));
+
+    irb->SetInsertPoint(error_block);
+    irb->CreateRet(codegen_utils_->GetConstant<Datum>(0));
+    EXPECT_FALSE(llvm::verifyFunction(*accum_fn));
+  }
+  EXPECT_FALSE(llvm::verifyModule(*codegen_utils_->module()));
+
+  EXPECT_TRUE(codegen_utils_->PrepareForExecution(
+      CodegenUtils::OptimizationLevel::kNone,
+      true));
+  AccumFn float8_accum_fn = codegen_utils_->GetFunctionPointer<AccumFn>(
+      "float8_accum_fn");
+  AccumFn float4_accum_fn = codegen_utils_->GetFunctionPointer<AccumFn>(
+      "float4_accum_fn");
+
+  // Infinities and NaNs go through without an overflow error
+  const std::vector<float8> inputs = {
+      1.5, -2.0, 0.0, 1e10, -1e-10, 3.0,
+      std::numeric_limits<float8>::infinity(),
+      std::numeric_limits<float8>::quiet_NaN(), 1.0};
+  struct AccumTestCase {
+    AccumFn generated_fn;
+    PGFunction regular_func;
+    bool is_float4;
+  };
+  for (const AccumTestCase& test_case : std::vector<AccumTestCase>{
+      {float8_accum_fn, float8_accum, false},
+      {float4_accum_fn, float4_accum, true}}) {
+    std::vector<float8> generated_array = MakeFloat8AccumArray(0, 0, 0);
+    std::vector<float8> regular_array = MakeFloat8AccumArray(0, 0, 0);
+    Datum generated_transarray = PointerGetDatum(generated_array.data());
+    Datum regular_transarray = PointerGetDatum(regular_array.data());
+    for (float8 input : inputs) {
+      Datum newval = test_case.is_float4 ?
+          Float4GetDatum(static_cast<float4>(input)) : Float8GetDatum(input);
+      EXPECT_EQ(generated_transarray,
+                test_case.generated_fn(generated_transarray, newval,
+                                       false, false));
+      EXPECT_EQ(regular_transarray,
+                CallFloatAccum(test_case.regular_func, regular_transarray,
+                               newval));
+
+      float8* generated_values = reinterpret_cast<float8*>(ARR_DATA_PTR(
+          reinterpret_cast<ArrayType*>(generated_array.data())));
+      float8* regular_values = reinterpret_cast<float8*>(ARR_DATA_PTR(
+          reinterpret_cast<ArrayType*>(regular_array.data())));
+      for (int i = 0; i < 3; i++) {
+        EXPECT_TRUE(Float8Identical(regular_values[i], generated_values[i]))
+            << "transvalues[" << i << "] after " << input << ": "
+            << generated_values[i] << " instead of " << regular_values[i];
+      }
+    }
+  }
+}
+
+int Sign(int32_t value) {
+  return (value > 0) - (value < 0);
+}
+
+// Test that the generated sort key comparisons agree with the btree
+// comparison functions
+TEST_F(CodegenPGFuncGeneratorTest, TupsortCompareDatumGenerateCompareTest) {
+  using CompareFn = int32_t (*) (Datum, Datum);
+
+  std::vector<char> text_empty = MakeTextDatum("", false);
+  std::vector<char> text_a = MakeTextDatum("a", true);
+  std::vector<char> text_abc_short = MakeTextDatum("abc", true);
+  std::vector<char> text_abc_long = MakeTextDatum("abc", false);
+  std::vector<char> text_abc_padded = MakeTextDatum("abc  ", true);
+  std::vector<char> text_abd = MakeTextDatum("abd", false);
+  std::vector<char> text_high = MakeTextDatum("ab\xff", true);
+  std::vector<Datum> text_values;
+  for (const std::vector<char>* buffer : {&text_empty, &text_a,
+      &text_abc_short, &text_abc_long, &text_abc_padded, &text_abd,
+      &text_high}) {
+    text_values.push_back(reinterpret_cast<Datum>(buffer->data()));
+  }
+  const float4 float4_nan = std::numeric_limits<float4>::quiet_NaN();
+  const float4 float4_inf = std::numeric_limits<float4>::infinity();
+  const float8 float8_nan = std::numeric_limits<float8>::quiet_NaN();
+  const float8 float8_inf = std::numeric_limits<float8>::infinity();
+
+  struct CompareTestCase {
+    Oid sort_func_oid;
+    PGFunction regular_func;
+    std::vector<Datum> values;
+  };
+  std::vector<CompareTestCase> test_cases = {
+      {F_BTINT2CMP, btint2cmp,
+       {Int16GetDatum(SHRT_MIN), Int16GetDatum(-1), Int16GetDatum(0),
+        Int16GetDatum(1), Int16GetDatum(SHRT_MAX)}},
+      {F_BTINT4CMP, btint4cmp,
+       {Int32GetDatum(INT_MIN), Int32GetDatum(-1), Int32GetDatum(0),
+        Int32GetDatum(1), Int32GetDatum(INT_MAX)}},
+      {F_DATE_CMP, date_cmp,
+       {DateADTGetDatum(INT_MIN), DateADTGetDatum(-1), DateADTGetDatum(0),
+        DateADTGetDatum(INT_MAX)}},
+      {F_BTINT8CMP, btint8cmp,
+       {Int64GetDatum(std::numeric_limits<int64_t>::min()),
+        Int64GetDatum(-1), Int64GetDatum(0), Int64GetDatum(INT64CONST(1) << 40),
+        Int64GetDatum(std::numeric_limits<int64_t>::max())}},
+      {F_BTOIDCMP, btoidcmp,
+       {ObjectIdGetDatum(0), ObjectIdGetDatum(1), ObjectIdGetDatum(0x7FFFFFFF),
+        ObjectIdGetDatum(0x80000000), ObjectIdGetDatum(0xFFFFFFFF)}},
+      {F_BTCHARCMP, btcharcmp,
+       {CharGetDatum('\0'), CharGetDatum('a'), CharGetDatum('z'),
+        CharGetDatum(static_cast<char>(0x80)),
+        CharGetDatum(static_cast<char>(0xFF))}},
+      {F_BTBOOLCMP, btboolcmp,
+       {BoolGetDatum(false), BoolGetDatum(true)}},
+      // NaNs are equal to each other and larger than anything else
+      {F_BTFLOAT4CMP, btfloat4cmp,
+       {Float4GetDatum(-float4_inf), Float4GetDatum(-1.5), Float4GetDatum(-0.0),
+        Float4GetDatum(0.0), Float4GetDatum(1.5), Float4GetDatum(float4_inf),
+        Float4GetDatum(float4_nan), Float4GetDatum(-float4_nan)}},
+      {F_BTFLOAT8CMP, btfloat8cmp,
+       {Float8GetDatum(-float8_inf), Float8GetDatum(-1.5), Float8GetDatum(-0.0),
+        Float8GetDatum(0.0), Float8GetDatum(1.5), Float8GetDatum(float8_inf),
+        Float8GetDatum(float8_nan), Float8GetDatum(-float8_nan)}},
+      // The test runs in the C locale, which is the only one the generated
+      // text comparisons are used with
+      {F_BTTEXTCMP, bttextcmp, text_values},
+      {F_BPCHARCMP, bpcharcmp, text_values}};
+
+  auto irb = codegen_utils_->ir_builder();
+  for (const CompareTestCase& test_case : test_cases) {
+    llvm::Function* compare_fn = codegen_utils_->CreateFunction<CompareFn>(
+        "compare_fn_" + std::to_string(test_case.sort_func_oid));
+    irb->SetInsertPoint(codegen_utils_->CreateBasicBlock("main", compare_fn));
+    llvm::Value* result = TupsortCompareDatumCodegen::GenerateCompare(
+        codegen_utils_.get(), test_case.sort_func_oid,
+        ArgumentByPosition(compare_fn, 0), ArgumentByPosition(compare_fn, 1));
+    ASSERT_NE(nullptr, result);
+    irb->CreateRet(result);
+    EXPECT_FALSE(llvm::verifyFunction(*compare_fn));
+  }
+  EXPECT_EQ(nullptr, TupsortCompareDatumCodegen::GenerateCompare(
+      codegen_utils_.get(), F_BTINT24CMP,
+      codegen_utils_->GetConstant<Datum>(0),
+      codegen_utils_->GetConstant<Datum>(0)));
+  EXPECT_FALSE(llvm::verifyModule(*codegen_utils_->module()));
+
+  EXPECT_TRUE(codegen_utils_->PrepareForExecution(
+      CodegenUtils::OptimizationLevel::kNone,
+      true));
+
+  for (const CompareTestCase& test_case : test_cases) {
+    CompareFn compare_fn = codegen_utils_->GetFunctionPointer<CompareFn>(
+        "compare_fn_" + std::to_string(test_case.sort_func_oid));
+    ASSERT_NE(nullptr, compare_fn);
+    for (std::size_t i = 0; i < test_case.values.size(); ++i) {
+      for (std::size_t j = 0; j < test_case.values.size(); ++j) {
+        SCOPED_TRACE("sort function " +
+                     std::to_string(test_case.sort_func_oid) + ", values " +
+                     std::to_string(i) + " and " + std::to_string(j));
+        Datum d1 = test_case.values[i];
+        Datum d2 = test_case.values[j];
+        EXPECT_EQ(Sign(DatumGetInt32(DirectFunctionCall2(
+                      test_case.regular_func, d1, d2))),
+                  Sign(compare_fn(d1, d2)));
+      }
+    }
+  }
+}
+
+// Test that compressed and external text is left to the regular comparison
+TEST_F(CodegenPGFuncGeneratorTest, TupsortCompareDatumIsUntoastedTest) {
+  using IsUntoastedFn = bool (*) (Datum);
+
+  auto irb = codegen_utils_->ir_builder();
+  llvm::Function* is_untoasted_fn =
+      codegen_utils_->CreateFunction<IsUntoastedFn>("is_untoasted_fn");
+  irb->SetInsertPoint(codegen_utils_->CreateBasicBlock("main",
+                                                       is_untoasted_fn));
+  irb->CreateRet(TupsortCompareDatumCodegen::GenerateIsUntoasted(
+      codegen_utils_.get(),
+      irb->CreateIntToPtr(ArgumentByPosition(is_untoasted_fn, 0),
+                          codegen_utils_->GetType<void*>())));
+  EXPECT_FALSE(llvm::verifyFunction(*is_untoasted_fn));
+
+  EXPECT_TRUE(codegen_utils_->PrepareForExecution(
+      CodegenUtils::OptimizationLevel::kNone,
+      true));
+  IsUntoastedFn is_untoasted = codegen_utils_->GetFunctionPointer<
+      IsUntoastedFn>("is_untoasted_fn");
+
+  auto as_datum = [](const std::vector<char>& buffer) {
+    return reinterpret_cast<Datum>(buffer.data());
+  };
+  std::vector<char> plain = MakeTextDatum("abc", false);
+  std::vector<char> short_header = MakeTextDatum("abc", true);
+  std::vector<char> compressed = MakeTextDatum("abc", false);
+  SET_VARSIZE_COMPRESSED(compressed.data(), compressed.size());
+  std::vector<char> external(VARHDRSZ_EXTERNAL + 16, 0);
+  SET_VARSIZE_1B_E(external.data(), external.size());
+
+  EXPECT_TRUE(is_untoasted(as_datum(plain)));
+  EXPECT_TRUE(is_untoasted(as_datum(short_header)));
+  EXPECT_FALSE(is_untoasted(as_datum(compressed)));
+  EXPECT_FALSE(is_untoasted(as_datum(external)));
+}
+
+// TupsortCompareDatumCodegen whose sort operators are indexes in a list of
+// comparison functions, so that the test does not look up the catalog.
+class TupsortCompareDatumTestCodegen : public TupsortCompareDatumCodegen {
+ public:
+  TupsortCompareDatumTestCodegen(
+      TupsortCompareDatumFn* ptr_to_chosen_func_ptr,
+      int nkeys,
+      Oid* sort_operators,
+      const std::vector<std::pair<Oid, bool>>& sort_funcs)
+  : TupsortCompareDatumCodegen(nullptr, tupsort_compare_datum,
+                               ptr_to_chosen_func_ptr, nkeys,
+                               sort_operators),
+    sort_funcs_(sort_funcs) {
+  }
+
+ protected:
+  bool GetSortKeyCompareFunction(Oid sort_operator,
+                                 Oid* sort_func_oid,
+                                 bool* reverse) override {
+    if (sort_operator >= sort_funcs_.size()) {
+      return false;
+    }
+    *sort_func_oid = sort_funcs_[sort_operator].first;
+    *reverse = sort_funcs_[sort_operator].second;
+    return true;
+  }
+
+ private:
+  std::vector<std::pair<Oid, bool>> sort_funcs_;
+};
+
+// Compare two entries of a level like the MK sort does: by their flags
+// first, which order the NULLs, then by their datums.
+int32_t CompareEntries(TupsortCompareDatumFn compare_fn,
+                       MKEntry* a, MKEntry* b,
+                       MKLvContext* lvctxt, MKContext* mkctxt) {
+  int32_t result = a->compflags - b->compflags;
+  if (0 == result && !mke_is_null(a)) {
+    result = compare_fn(a, b, lvctxt, mkctxt);
+  }
+  return result;
+}
+
+// Test the generated tupsort_compare_datum on int4 levels, which the regular
+// function compares without calling the comparison function
+TEST_F(CodegenPGFuncGeneratorTest, TupsortCompareDatumCodegenTest) {
+  // Level 0 is int4 descending, level 1 is int4 through btint24cmp, which is
+  // not supported and falls back to the regular function
+  Oid sort_operators[] = {0, 1};
+  TupsortCompareDatumFn compare_fn = nullptr;
+  TupsortCompareDatumTestCodegen generator(
+      &compare_fn, 2, sort_operators,
+      {{F_BTINT4CMP, true}, {F_BTINT24CMP, false}});
+  ASSERT_TRUE(tupsort_compare_datum == compare_fn);
+  EXPECT_TRUE(generator.GenerateCode(codegen_utils_.get()));
+  EXPECT_TRUE(codegen_utils_->PrepareForExecution(
+      CodegenUtils::OptimizationLevel::kNone,
+      true));
+  EXPECT_TRUE(generator.SetToGenerated(codegen_utils_.get()));
+  ASSERT_TRUE(tupsort_compare_datum != compare_fn);
+
+  MKLvContext lvctxt[3];
+  memset(lvctxt, 0, sizeof(lvctxt));
+  for (MKLvContext& level : lvctxt) {
+    level.lvtype = MKLV_TYPE_INT32;
+    level.scanKey.sk_flags = SK_BT_DESC;
+  }
+  MKContext mkctxt;
+  memset(&mkctxt, 0, sizeof(mkctxt));
+  mkctxt.total_lv = 2;
+  mkctxt.lvctxt = lvctxt;
+
+  // NULLs first, then 1, 2, then NULLs last
+  std::vector<MKEntry> entries(4);
+  for (MKEntry& entry : entries) {
+    mke_blank(&entry);
+  }
+  mke_set_null(&entries[0], true);
+  mke_set_not_null(&entries[1]);
+  entries[1].d = Int32GetDatum(1);
+  mke_set_not_null(&entries[2]);
+  entries[2].d = Int32GetDatum(2);
+  mke_set_null(&entries[3], false);
+
+  for (int lv = 0; lv < 2; lv++) {
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+      for (std::size_t j = 0; j < entries.size(); ++j) {
+        SCOPED_TRACE("level " + std::to_string(lv) + ", entries " +
+                     std::to_string(i) + " and " + std::to_string(j));
+        EXPECT_EQ(Sign(CompareEntries(tupsort_compare_datum,
+                                      &entries[i], &entries[j],
+                                      &lvctxt[lv], &mkctxt)),
+                  Sign(CompareEntries(compare_fn, &entries[i], &entries[j],
+                                      &lvctxt[lv], &mkctxt)));
+      }
+    }
+  }
+  EXPECT_EQ(1, compare_fn(&entries[1], &entries[2], &lvctxt[0], &mkctxt));
+
+  // A level that is ascending for the regular function tells which one ran
+  lvctxt[0].scanKey.sk_flags = 0;
+  lvctxt[1].scanKey.sk_flags = 0;
+  EXPECT_EQ(1, compare_fn(&entries[1], &entries[2], &lvctxt[0], &mkctxt));
+  EXPECT_EQ(-1, compare_fn(&entries[1], &entries[2], &lvctxt[1], &mkctxt));
+
+  // An MKContext with another number of levels goes to the regular function
+  mkctxt.total_lv = 3;
+  EXPECT_EQ(-1, compare_fn(&entries[1], &entries[2], &lvctxt[0], &mkctxt));
+}
+
 }  // namespace gpcodegen
 
 
@@ -0,0 +1,397 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    tupsort_compare_datum_codegen.cc
+//
+//  @doc:
+//    Generates code for tupsort_compare_datum function.
+//
+//---------------------------------------------------------------------------
+#include <assert.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "codegen/pg_text_func_generator.h"
+#include "codegen/tupsort_compare_datum_codegen.h"
+#include "codegen/utils/gp_codegen_utils.h"
+#include "codegen/utils/utility.h"
+
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IRBuilder.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "utils/elog.h"
+#include "utils/fmgroids.h"
+#include "utils/lsyscache.h"
+#include "utils/pg_locale.h"
+#include "utils/tuplesort_mk.h"
+#include "utils/tuplesort_mk_details.h"
+}
+
+namespace llvm {
+class BasicBlock;
+class Function;
+}  // namespace llvm
+
+using gpcodegen::TupsortCompareDatumCodegen;
+using gpcodegen::PGTextFuncGenerator;
+
+constexpr char TupsortCompareDatumCodegen::kTupsortCompareDatumPrefix[];
+
+namespace {
+
+// timestamp_cmp shares its C function with timestamptz_cmp, so F_TIMESTAMP_CMP
+// is the oid of the latter (see pg_proc.h)
+constexpr Oid kTimestampCmp = 2045;
+constexpr Oid kTimestampTzCmp = F_TIMESTAMP_CMP;
+
+// Generation-time information about one sort key
+struct SortKeyInfo {
+  Oid sort_func_oid;
+  bool reverse;
+  bool is_supported;
+};
+
+bool IsTextCompare(Oid sort_func_oid) {
+  return F_BTTEXTCMP == sort_func_oid || F_BPCHARCMP == sort_func_oid;
+}
+
+bool IsSupported(Oid sort_func_oid) {
+  switch (sort_func_oid) {
+    case F_BTINT2CMP:
+    case F_BTINT4CMP:
+    case F_BTINT8CMP:
+    case F_BTOIDCMP:
+    case F_BTCHARCMP:
+    case F_BTBOOLCMP:
+    case F_BTFLOAT4CMP:
+    case F_BTFLOAT8CMP:
+    case F_DATE_CMP:
+#ifdef HAVE_INT64_TIMESTAMP
+    case kTimestampCmp:
+    case kTimestampTzCmp:
+#endif  // HAVE_INT64_TIMESTAMP
+      return true;
+    case F_BTTEXTCMP:
+    case F_BPCHARCMP:
+      // With any other collation the MK sort compares strxfrm'ed keys
+      return lc_collate_is_c();
+    default:
+      return false;
+  }
+}
+
+// (a > b) - (a < b)
+llvm::Value* GenerateIntCompare(gpcodegen::GpCodegenUtils* codegen_utils,
+                                llvm::Value* llvm_a,
+                                llvm::Value* llvm_b,
+                                bool is_signed) {
+  auto irb = codegen_utils->ir_builder();
+  llvm::Value* llvm_gt = is_signed ? irb->CreateICmpSGT(llvm_a, llvm_b) :
+      irb->CreateICmpUGT(llvm_a, llvm_b);
+  llvm::Value* llvm_lt = is_signed ? irb->CreateICmpSLT(llvm_a, llvm_b) :
+      irb->CreateICmpULT(llvm_a, llvm_b);
+  return irb->CreateSub(
+      irb->CreateZExt(llvm_gt, codegen_utils->GetType<int32_t>()),
+      irb->CreateZExt(llvm_lt, codegen_utils->GetType<int32_t>()));
+}
+
+// float8_cmp_internal(): NaNs are equal to each other and larger than
+// any non-NaN value.
+llvm::Value* GenerateFloatCompare(gpcodegen::GpCodegenUtils* codegen_utils,
+                                  llvm::Value* llvm_a,
+                                  llvm::Value* llvm_b) {
+  auto irb = codegen_utils->ir_builder();
+  llvm::Value* llvm_a_isnan = irb->CreateFCmpUNO(llvm_a, llvm_a);
+  llvm::Value* llvm_b_isnan = irb->CreateFCmpUNO(llvm_b, llvm_b);
+  // Ordered comparisons are false as soon as one side is NaN
+  llvm::Value* llvm_gt = irb->CreateOr(
+      irb->CreateFCmpOGT(llvm_a, llvm_b),
+      irb->CreateAnd(llvm_a_isnan, irb->CreateNot(llvm_b_isnan)));
+  llvm::Value* llvm_lt = irb->CreateOr(
+      irb->CreateFCmpOLT(llvm_a, llvm_b),
+      irb->CreateAnd(llvm_b_isnan, irb->CreateNot(llvm_a_isnan)));
+  return irb->CreateSub(
+      irb->CreateZExt(llvm_gt, codegen_utils->GetType<int32_t>()),
+      irb->CreateZExt(llvm_lt, codegen_utils->GetType<int32_t>()));
+}
+
+}  // namespace
+
+TupsortCompareDatumCodegen::TupsortCompareDatumCodegen(
+    CodegenManager* manager,
+    TupsortCompareDatumFn regular_func_ptr,
+    TupsortCompareDatumFn* ptr_to_regular_func_ptr,
+    int nkeys,
+    Oid* sort_operators)
+: BaseCodegen(manager,
+              kTupsortCompareDatumPrefix,
+              regular_func_ptr,
+              ptr_to_regular_func_ptr),
+              nkeys_(nkeys),
+              sort_operators_(sort_operators) {
+}
+
+bool TupsortCompareDatumCodegen::GetSortKeyCompareFunction(
+    Oid sort_operator,
+    Oid* sort_func_oid,
+    bool* reverse) {
+  return get_compare_function_for_ordering_op(sort_operator, sort_func_oid,
+                                              reverse);
+}
+
+llvm::Value* TupsortCompareDatumCodegen::GenerateIsUntoasted(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    llvm::Value* llvm_varlena_ptr) {
+  auto irb = codegen_utils->ir_builder();
+  llvm::Value* llvm_header = irb->CreateLoad(llvm_varlena_ptr);
+  // VARATT_IS_4B_U(ptr)
+  llvm::Value* llvm_is_4b_u = irb->CreateICmpEQ(
+      irb->CreateAnd(llvm_header, codegen_utils->GetConstant<uint8_t>(0xC0)),
+      codegen_utils->GetConstant<uint8_t>(0));
+  // VARATT_IS_1B(ptr) && !VARATT_IS_1B_E(ptr)
+  llvm::Value* llvm_is_short = irb->CreateAnd(
+      irb->CreateICmpEQ(
+          irb->CreateAnd(llvm_header,
+                         codegen_utils->GetConstant<uint8_t>(0x80)),
+          codegen_utils->GetConstant<uint8_t>(0x80)),
+      irb->CreateICmpNE(llvm_header,
+                        codegen_utils->GetConstant<uint8_t>(0x80)));
+  return irb->CreateOr(llvm_is_4b_u, llvm_is_short);
+}
+
+llvm::Value* TupsortCompareDatumCodegen::GenerateCompare(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    Oid sort_func_oid,
+    llvm::Value* llvm_d1,
+    llvm::Value* llvm_d2) {
+  switch (sort_func_oid) {
+    case F_BTINT2CMP:
+      return GenerateIntCompare(
+          codegen_utils,
+          codegen_utils->CreateDatumToCppTypeCast<int16_t>(llvm_d1),
+          codegen_utils->CreateDatumToCppTypeCast<int16_t>(llvm_d2),
+          true);
+    case F_BTINT4CMP:
+    case F_DATE_CMP:
+      return GenerateIntCompare(
+          codegen_utils,
+          codegen_utils->CreateDatumToCppTypeCast<int32_t>(llvm_d1),
+          codegen_utils->CreateDatumToCppTypeCast<int32_t>(llvm_d2),
+          true);
+    case F_BTINT8CMP:
+#ifdef HAVE_INT64_TIMESTAMP
+    case kTimestampCmp:
+    case kTimestampTzCmp:
+#endif  // HAVE_INT64_TIMESTAMP
+      return GenerateIntCompare(
+          codegen_utils,
+          codegen_utils->CreateDatumToCppTypeCast<int64_t>(llvm_d1),
+          codegen_utils->CreateDatumToCppTypeCast<int64_t>(llvm_d2),
+          true);
+    case F_BTOIDCMP:
+      return GenerateIntCompare(
+          codegen_utils,
+          codegen_utils->CreateDatumToCppTypeCast<uint32_t>(llvm_d1),
+          codegen_utils->CreateDatumToCppTypeCast<uint32_t>(llvm_d2),
+          false);
+    case F_BTCHARCMP:
+    case F_BTBOOLCMP:
+      // Both compare the values as uint8
+      return GenerateIntCompare(
+          codegen_utils,
+          codegen_utils->CreateDatumToCppTypeCast<uint8_t>(llvm_d1),
+          codegen_utils->CreateDatumToCppTypeCast<uint8_t>(llvm_d2),
+          false);
+    case F_BTFLOAT4CMP:
+      return GenerateFloatCompare(
+          codegen_utils,
+          codegen_utils->CreateDatumToCppTypeCast<float>(llvm_d1),
+          codegen_utils->CreateDatumToCppTypeCast<float>(llvm_d2));
+    case F_BTFLOAT8CMP:
+      return GenerateFloatCompare(
+          codegen_utils,
+          codegen_utils->CreateDatumToCppTypeCast<double>(llvm_d1),
+          codegen_utils->CreateDatumToCppTypeCast<double>(llvm_d2));
+    case F_BTTEXTCMP:
+    case F_BPCHARCMP:
+      return PGTextFuncGenerator::GenerateTextCompare(
+          codegen_utils,
+          codegen_utils->CreateDatumToCppTypeCast<void*>(llvm_d1),
+          codegen_utils->CreateDatumToCppTypeCast<void*>(llvm_d2),
+          F_BPCHARCMP == sort_func_oid);
+    default:
+      return nullptr;
+  }
+}
+
+bool TupsortCompareDatumCodegen::GenerateTupsortCompareDatum(
+    gpcodegen::GpCodegenUtils* codegen_utils) {
+  assert(nullptr != codegen_utils);
+  static_assert(sizeof(Datum) == sizeof(int64_t),
+      "sizeof(Datum) doesn't match sizeof(int64)");
+
+  if (nkeys_ <= 0 || nullptr == sort_operators_) {
+    elog(DEBUG1, "Cannot generate code for tupsort_compare_datum "
+                 "because there are no sort keys.");
+    return false;
+  }
+
+  // Resolve, like create_mksort_context, the comparison function and
+  // direction of every sort key.
+  std::vector<SortKeyInfo> key_infos;
+  bool any_supported = false;
+  for (int i = 0; i < nkeys_; i++) {
+    SortKeyInfo key_info;
+    if (!GetSortKeyCompareFunction(sort_operators_[i],
+                                   &key_info.sort_func_oid,
+                                   &key_info.reverse)) {
+      elog(DEBUG1, "Cannot generate code for tupsort_compare_datum "
+                   "because operator %u is not a valid ordering operator.",
+                   sort_operators_[i]);
+      return false;
+    }
+    key_info.is_supported = IsSupported(key_info.sort_func_oid);
+    if (!key_info.is_supported) {
+      elog(DEBUG1, "Sort key %d of tupsort_compare_datum falls back to "
+                   "comparison function %u.", i, key_info.sort_func_oid);
+    }
+    any_supported |= key_info.is_supported;
+    key_infos.push_back(key_info);
+  }
+  if (!any_supported) {
+    elog(DEBUG1, "Cannot generate code for tupsort_compare_datum "
+                 "because no comparison function is supported.");
+    return false;
+  }
+
+  llvm::Function* tupsort_compare_datum_func =
+      CreateFunction<TupsortCompareDatumFn>(
+          codegen_utils, GetUniqueFuncName());
+
+  auto irb = codegen_utils->ir_builder();
+
+  // BasicBlocks
+  llvm::BasicBlock* entry_block = codegen_utils->CreateBasicBlock(
+      "entry", tupsort_compare_datum_func);
+  llvm::BasicBlock* dispatch_block = codegen_utils->CreateBasicBlock(
+      "dispatch", tupsort_compare_datum_func);
+  llvm::BasicBlock* fallback_block = codegen_utils->CreateBasicBlock(
+      "fallback", tupsort_compare_datum_func);
+
+  // Function arguments to tupsort_compare_datum
+  llvm::Value* llvm_v1_arg =
+      ArgumentByPosition(tupsort_compare_datum_func, 0);
+  llvm::Value* llvm_v2_arg =
+      ArgumentByPosition(tupsort_compare_datum_func, 1);
+  llvm::Value* llvm_lvctxt_arg =
+      ArgumentByPosition(tupsort_compare_datum_func, 2);
+  llvm::Value* llvm_mkctxt_arg =
+      ArgumentByPosition(tupsort_compare_datum_func, 3);
+
+  // Entry block
+  // -----------
+  irb->SetInsertPoint(entry_block);
+#ifdef CODEGEN_DEBUG
+  EXPAND_CREATE_ELOG(codegen_utils,
+                     DEBUG1,
+                     "Codegen'ed tupsort_compare_datum called!");
+#endif
+  llvm::Value* llvm_total_lv = irb->CreateLoad(
+      codegen_utils->GetPointerToMember(llvm_mkctxt_arg,
+                                        &MKContext::total_lv));
+  irb->CreateCondBr(
+      irb->CreateICmpEQ(llvm_total_lv,
+                        codegen_utils->GetConstant<int32_t>(nkeys_)),
+      dispatch_block /* true */,
+      fallback_block /* false */);
+
+  // Dispatch block
+  // --------------
+  // The level is given by the offset of lvctxt in mkctxt->lvctxt
+  irb->SetInsertPoint(dispatch_block);
+  llvm::Value* llvm_lvctxt_base = irb->CreateLoad(
+      codegen_utils->GetPointerToMember(llvm_mkctxt_arg,
+                                        &MKContext::lvctxt));
+  llvm::Value* llvm_lv_offset = irb->CreateSub(
+      irb->CreatePtrToInt(llvm_lvctxt_arg, codegen_utils->GetType<int64_t>()),
+      irb->CreatePtrToInt(llvm_lvctxt_base,
+                          codegen_utils->GetType<int64_t>()));
+  llvm::SwitchInst* llvm_switch = irb->CreateSwitch(
+      llvm_lv_offset, fallback_block, nkeys_);
+
+  for (int i = 0; i < nkeys_; i++) {
+    const SortKeyInfo& key_info = key_infos[i];
+    if (!key_info.is_supported) {
+      continue;
+    }
+    llvm::BasicBlock* level_block = codegen_utils->CreateBasicBlock(
+        "level_" + std::to_string(i), tupsort_compare_datum_func);
+    llvm_switch->addCase(
+        llvm::cast<llvm::ConstantInt>(codegen_utils->GetConstant<int64_t>(
+            i * sizeof(MKLvContext))),
+        level_block);
+
+    // Level block
+    // -----------
+    irb->SetInsertPoint(level_block);
+    llvm::Value* llvm_d1 = irb->CreateLoad(
+        codegen_utils->GetPointerToMember(llvm_v1_arg, &MKEntry::d));
+    llvm::Value* llvm_d2 = irb->CreateLoad(
+        codegen_utils->GetPointerToMember(llvm_v2_arg, &MKEntry::d));
+
+    if (IsTextCompare(key_info.sort_func_oid)) {
+      // Leave compressed and external values to the regular function
+      llvm::BasicBlock* text_block = codegen_utils->CreateBasicBlock(
+          "level_" + std::to_string(i) + "_text",
+          tupsort_compare_datum_func);
+      irb->CreateCondBr(
+          irb->CreateAnd(
+              GenerateIsUntoasted(
+                  codegen_utils,
+                  codegen_utils->CreateDatumToCppTypeCast<void*>(llvm_d1)),
+              GenerateIsUntoasted(
+                  codegen_utils,
+                  codegen_utils->CreateDatumToCppTypeCast<void*>(llvm_d2))),
+          text_block /* true */,
+          fallback_block /* false */);
+      irb->SetInsertPoint(text_block);
+    }
+
+    llvm::Value* llvm_result = GenerateCompare(
+        codegen_utils, key_info.sort_func_oid, llvm_d1, llvm_d2);
+    assert(nullptr != llvm_result);
+    if (key_info.reverse) {
+      llvm_result = irb->CreateNeg(llvm_result);
+    }
+    irb->CreateRet(llvm_result);
+  }
+
+  // Fall back Block
+  // ---------------
+  irb->SetInsertPoint(fallback_block);
+  codegen_utils->CreateFallback<TupsortCompareDatumFn>(
+      codegen_utils->GetOrRegisterExternalFunction(tupsort_compare_datum,
+                                                   "tupsort_compare_datum"),
+      tupsort_compare_datum_func);
+
+  return true;
+}
+
+bool TupsortCompareDatumCodegen::GenerateCodeInternal(
+    GpCodegenUtils* codegen_utils) {
+  bool isGenerated = GenerateTupsortCompareDatum(codegen_utils);
+
+  if (isGenerated) {
+    elog(DEBUG1, "tupsort_compare_datum was generated successfully!");
+    return true;
+  } else {
+    elog(DEBUG1, "tupsort_compare_datum generation failed!");
+    return false;
+  }
+}
@@ -14,6 +14,7 @@
 //
 //---------------------------------------------------------------------------
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -22,6 +23,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "codegen/utils/codegen_utils.h"
 #include "llvm/ADT/StringRef.h"
@@ -36,6 +38,7 @@
 #include "llvm/IR/GlobalValue.h"
 #include "llvm/IR/GlobalVariable.h"
 #include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Type.h"
@@ -44,6 +47,7 @@
 #include "llvm/Support/Host.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
 #include "llvm/Transforms/IPO.h"
@@ -76,10 +80,68 @@ inline llvm::CodeGenOpt::Level OptLevelCodegenToLLVM(
   }
 }
 
+// Replace the use(s) of 'value' by 'user' with an instruction produced by
+// 'materialize', which is given the instruction to insert before. For PHI
+// nodes the instruction is placed at the end of the corresponding incoming
+// block, so that it still dominates the use.
+template <typename Materializer>
+void MaterializeAtUse(llvm::Instruction* user,
+                      llvm::Value* value,
+                      Materializer materialize) {
+  llvm::PHINode* phi = llvm::dyn_cast<llvm::PHINode>(user);
+  if (nullptr != phi) {
+    for (unsigned i = 0; i < phi->getNumIncomingValues(); ++i) {
+      if (phi->getIncomingValue(i) == value) {
+        phi->setIncomingValue(
+            i, materialize(phi->getIncomingBlock(i)->getTerminator()));
+      }
+    }
+    return;
+  }
+  for (const llvm::Use& operand : user->operands()) {
+    if (operand.get() == value) {
+      user->replaceUsesOfWith(value, materialize(user));
+      return;
+    }
+  }
+}
+
+// Rewrite the constant expressions using 'constant' (e.g. GEPs and bitcasts
+// folded by the IRBuilder) into instructions at each of their uses, so that
+// 'constant' is afterwards only used directly by instructions. Returns false
+// if some use is not an instruction or a constant expression.
+bool ExpandConstantExprUses(llvm::Constant* constant) {
+  std::vector<llvm::User*> users(constant->user_begin(), constant->user_end());
+  for (llvm::User* user : users) {
+    if (llvm::isa<llvm::Instruction>(user)) {
+      continue;
+    }
+    llvm::ConstantExpr* expr = llvm::dyn_cast<llvm::ConstantExpr>(user);
+    if (nullptr == expr || !ExpandConstantExprUses(expr)) {
+      return false;
+    }
+    expr->removeDeadConstantUsers();
+    std::vector<llvm::User*> expr_users(expr->user_begin(), expr->user_end());
+    for (llvm::User* expr_user : expr_users) {
+      MaterializeAtUse(llvm::cast<llvm::Instruction>(expr_user), expr,
+                       [expr](llvm::Instruction* insert_before) {
+                         llvm::Instruction* instruction =
+                             expr->getAsInstruction();
+                         instruction->insertBefore(insert_before);
+                         return instruction;
+                       });
+    }
+  }
+  constant->removeDeadConstantUsers();
+  return true;
+}
+
 }  // namespace
 
 constexpr char CodegenUtils::kExternalVariableNamePrefix[];
 constexpr char CodegenUtils::kExternalFunctionNamePrefix[];
+constexpr char CodegenUtils::kExternalVariableBindingSuffix[];
+constexpr char CodegenUtils::kFingerprintFunctionNamePrefix[];
 
 CodegenUtils::CodegenUtils(llvm::StringRef module_name)
     : ir_builder_(context_),
@@ -260,9 +322,9 @@ bool CodegenUtils::PrepareForExecution(const OptimizationLevel cpu_opt_level,
   // Note that on OSX, C symbol names all have a leading underscore prepended to
   // them. We must replicate this when adding global mappings to the
   // ExecutionEngine so that names are properly resolved.
-  for (const std::pair<const std::string,
-                       const std::uint64_t>& external_global_variable
-       : external_global_variables_) {
+  for (std::size_t i = 0; i < external_global_variables_.size(); ++i) {
+    const std::pair<const std::string, const std::uint64_t>&
+        external_global_variable = external_global_variables_[i];
     engine_->addGlobalMapping(
 #ifdef __APPLE__
         std::string(1, '_') + external_global_variable.first,
@@ -270,6 +332,17 @@ bool CodegenUtils::PrepareForExecution(const OptimizationLevel cpu_opt_level,
         external_global_variable.first,
 #endif
         external_global_variable.second);
+
+    // If the module was made relocatable, uses of the variable load its
+    // address from the corresponding slot of the binding table instead.
+    if (external_variable_bindings_) {
+      engine_->addGlobalMapping(
+#ifdef __APPLE__
+          std::string(1, '_') +
+#endif
+          external_global_variable.first + kExternalVariableBindingSuffix,
+          reinterpret_cast<std::uint64_t>(&external_variable_bindings_[i]));
+    }
   }
 
   // Map registered external functions to their actual locations in memory.
@@ -288,6 +361,16 @@ bool CodegenUtils::PrepareForExecution(const OptimizationLevel cpu_opt_level,
   return true;
 }
 
+bool CodegenUtils::FinalizeCompilation() {
+  if (engine_.get() == nullptr) {
+    return false;
+  }
+  // MCJIT generates code for all its modules and applies relocations here,
+  // after which looking up function addresses is cheap.
+  engine_->finalizeObject();
+  return true;
+}
+
 void CodegenUtils::PrintUnderlyingModules(llvm::raw_ostream& out) {
   // Print the main module
   out << "==== MAIN MODULE ====" << "\n";
@@ -304,6 +387,116 @@ void CodegenUtils::PrintUnderlyingModules(llvm::raw_ostream& out) {
   out.flush();
 }
 
+std::string CodegenUtils::GetModuleFingerprint() {
+  assert(nullptr != module_.get());
+  std::string fingerprint;
+  llvm::raw_string_ostream out(fingerprint);
+
+  // Temporarily rename generated functions (and the module itself) so that
+  // the printed IR does not depend on their globally unique names.
+  std::vector<std::pair<llvm::Function*, std::string>> original_names;
+  for (llvm::Function& function : *module_) {
+    if (!function.isDeclaration()) {
+      original_names.emplace_back(&function, function.getName());
+    }
+  }
+  for (std::size_t i = 0; i < original_names.size(); ++i) {
+    original_names[i].first->setName(
+        kFingerprintFunctionNamePrefix + std::to_string(i));
+  }
+  const std::string module_identifier = module_->getModuleIdentifier();
+  module_->setModuleIdentifier("");
+
+  module_->print(out, nullptr);
+  for (std::unique_ptr<llvm::Module>& auxiliary_module : auxiliary_modules_) {
+    auxiliary_module->print(out, nullptr);
+  }
+
+  module_->setModuleIdentifier(module_identifier);
+  for (std::pair<llvm::Function*, std::string>& original_name
+       : original_names) {
+    original_name.first->setName(original_name.second);
+  }
+
+  // Registered external functions are bound at compile time, so their
+  // addresses must match too. Sort them by name to be independent of the
+  // iteration order of 'external_functions_'.
+  std::vector<std::pair<std::string, std::uint64_t>> external_functions;
+  for (const std::pair<const std::uint64_t, std::string>& external_function
+       : external_functions_) {
+    external_functions.emplace_back(external_function.second,
+                                    external_function.first);
+  }
+  std::sort(external_functions.begin(), external_functions.end());
+  for (const std::pair<std::string, std::uint64_t>& external_function
+       : external_functions) {
+    out << "; " << external_function.first << " = "
+        << external_function.second << "\n";
+  }
+
+  out.flush();
+  return fingerprint;
+}
+
+bool CodegenUtils::MakeExternalVariablesRelocatable() {
+  assert(nullptr == engine_.get());
+  assert(nullptr != module_.get());
+
+  bool all_uses_rewritten = true;
+  external_variable_bindings_.reset(
+      new std::uint64_t[external_global_variables_.size()]);
+  for (std::size_t i = 0; i < external_global_variables_.size(); ++i) {
+    const std::string& name = external_global_variables_[i].first;
+    external_variable_bindings_[i] = external_global_variables_[i].second;
+
+    llvm::GlobalVariable* variable = module_->getNamedGlobal(name);
+    if (nullptr == variable || variable->use_empty()) {
+      continue;
+    }
+    if (!ExpandConstantExprUses(variable)) {
+      all_uses_rewritten = false;
+      continue;
+    }
+
+    llvm::GlobalVariable* binding = new llvm::GlobalVariable(
+        *module_,
+        variable->getType(),
+        false,
+        llvm::GlobalValue::ExternalLinkage,
+        nullptr,
+        name + kExternalVariableBindingSuffix);
+    std::vector<llvm::User*> users(variable->user_begin(),
+                                   variable->user_end());
+    for (llvm::User* user : users) {
+      MaterializeAtUse(llvm::cast<llvm::Instruction>(user), variable,
+                       [binding](llvm::Instruction* insert_before) {
+                         return new llvm::LoadInst(binding, "",
+                                                   insert_before);
+                       });
+    }
+  }
+  return all_uses_rewritten;
+}
+
+bool CodegenUtils::RebindExternalVariables(const CodegenUtils& other) {
+  if (!external_variable_bindings_ ||
+      other.external_global_variables_.size() !=
+          external_global_variables_.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < external_global_variables_.size(); ++i) {
+    if (other.external_global_variables_[i].first !=
+        external_global_variables_[i].first) {
+      return false;
+    }
+  }
+  for (std::size_t i = 0; i < external_global_variables_.size(); ++i) {
+    external_variable_bindings_[i] =
+        other.external_global_variables_[i].second;
+  }
+  return true;
+}
+
 llvm::GlobalVariable* CodegenUtils::AddExternalGlobalVariable(
     llvm::Type* type,
     const void* address) {
@@ -12,6 +12,7 @@
  */
 #include "postgres.h"
 
+#include "codegen/codegen_wrapper.h"
 #include "executor/execdebug.h"
 #include "executor/instrument.h"
 #include "executor/nodeAgg.h"
@@ -116,6 +117,14 @@ ExecReScan(PlanState *node, ExprContext *exprCtxt)
 			UpdateChangedParamSet(node->lefttree, node->chgParam);
 		if (node->righttree != NULL)
 			UpdateChangedParamSet(node->righttree, node->chgParam);
+
+		/*
+		 * Generated code that embeds parameter values is stale now; let the
+		 * code generator manager regenerate it or fall back to the regular
+		 * functions.
+		 */
+		if (node->CodegenManager != NULL)
+			(void) CodeGeneratorManagerNotifyParameterChange(node->CodegenManager);
 	}
 
 	/* Shut down any SRFs in the plan node's targetlist */
@@ -116,7 +116,6 @@ static void *readHashEntry(AggState *aggstate,
 						   int32 *p_input_size);
 
 /* Methods for hash table */
-static uint32 calc_hash_value(AggState* aggstate, TupleTableSlot *inputslot);
 static void spill_hash_table(AggState *aggstate);
 static void expand_hash_table(AggState *aggstate);
 static void init_agg_hash_iter(HashAggTable* ht);
@@ -888,7 +887,7 @@ agg_hash_initial_pass(AggState *aggstate)
 
 		/* Find or (if there's room) build a hash table entry for the
 		 * input tuple's group. */
-		hashkey = calc_hash_value(aggstate, outerslot);
+		hashkey = call_calc_hash_value(aggstate, outerslot);
 		entry = lookup_agg_hash_entry(aggstate, (void *)outerslot,
 									  INPUT_RECORD_TUPLE, 0, hashkey, &isNew);
 		
@@ -953,6 +952,13 @@ agg_hash_initial_pass(AggState *aggstate)
 			break;
 		}
 
+		/*
+		 * This loop consumes all input in one call, so pick up functions
+		 * compiled in the background here rather than in ExecProcNode.
+		 */
+		if (CodeGeneratorManagerCompilationPending())
+			(void) CodeGeneratorManagerSwapInCompiledFunctions(aggstate->ss.ps.CodegenManager);
+
 		/* Read the next tuple */
 		outerslot = ExecProcNode(outerPlanState(aggstate));
 	}
@@ -80,6 +80,7 @@
  */
 #include "postgres.h"
 
+#include "executor/execHHashagg.h"
 #include "executor/executor.h"
 #include "executor/instrument.h"
 #include "executor/nodeAgg.h"
@@ -108,6 +109,7 @@
 #include "executor/nodeValuesscan.h"
 #include "executor/nodeWorktablescan.h"
 #include "miscadmin.h"
+#include "nodes/nodeFuncs.h"
 
 #include "cdb/cdbvars.h"
 #include "cdb/ml_ipc.h"			/* interconnect context */
@@ -131,6 +133,8 @@
 #include "pg_trace.h"
 #include "tcop/tcopprot.h"
 #include "utils/debugbreak.h"
+#include "utils/tuplesort_mk.h"
+#include "utils/tuplesort_mk_details.h"
 
 #include "codegen/codegen_wrapper.h"
 
@@ -162,6 +166,9 @@ static void
 static void
 			EnrollProjInfoTargetList(PlanState *result, ProjectionInfo *ProjInfo);
 
+static bool
+			IsCodegenWorthwhile(Plan *node);
+
 /*
  * setSubplanSliceId
  *	 Set the slice id info for the given subplan.
@@ -596,6 +603,26 @@ ExecInitNode(Plan *node, EState *estate, int eflags)
 			{
 			result = (PlanState *) ExecInitHashJoin((HashJoin *) node,
 													estate, eflags);
+#ifdef USE_CODEGEN
+			if (NULL != result)
+			{
+				HashJoinState *hjstate = (HashJoinState *) result;
+				HashState  *hashstate = (HashState *) innerPlanState(hjstate);
+
+				/*
+				 * The hash keys of both sides are only known once the join
+				 * is initialized, so enroll the Hash node's generator here.
+				 */
+				enroll_ExecHashGetHashValue_codegen(ExecHashGetHashValue,
+						&hjstate->ExecHashGetHashValue_gen_info.ExecHashGetHashValue_fn,
+						hjstate, hjstate->hj_OuterHashKeys,
+						hjstate->hj_HashOperators, true);
+				enroll_ExecHashGetHashValue_codegen(ExecHashGetHashValue,
+						&hashstate->ExecHashGetHashValue_gen_info.ExecHashGetHashValue_fn,
+						hashstate, hashstate->hashkeys,
+						hjstate->hj_HashOperators, false);
+			}
+#endif
 			}
 			END_MEMORY_ACCOUNT();
 			break;
@@ -634,6 +661,16 @@ ExecInitNode(Plan *node, EState *estate, int eflags)
 			{
 			result = (PlanState *) ExecInitSort((Sort *) node,
 												estate, eflags);
+#ifdef USE_CODEGEN
+			if (NULL != result && gp_enable_mk_sort)
+			{
+			  SortState *sortstate = (SortState *) result;
+			  enroll_tupsort_compare_datum_codegen(tupsort_compare_datum,
+			        &sortstate->tupsort_compare_datum_gen_info.tupsort_compare_datum_fn,
+			        sortstate, ((Sort *) node)->numCols,
+			        ((Sort *) node)->sortOperators);
+			}
+#endif
 			}
 			END_MEMORY_ACCOUNT();
 			break;
@@ -660,7 +697,20 @@ ExecInitNode(Plan *node, EState *estate, int eflags)
 			  }
 			  enroll_AdvanceAggregates_codegen(advance_aggregates,
 			        &aggstate->AdvanceAggregates_gen_info.AdvanceAggregates_fn,
-			        aggstate);			}
+			        aggstate);
+			  if (NULL != aggstate->inputbatch)
+			  {
+			    enroll_AdvanceAggregatesBatch_codegen(advance_aggregates_batch,
+			          &aggstate->AdvanceAggregatesBatch_gen_info.AdvanceAggregatesBatch_fn,
+			          aggstate);
+			  }
+			  if (((Agg *) node)->aggstrategy == AGG_HASHED)
+			  {
+			    enroll_calc_hash_value_codegen(calc_hash_value,
+			          &aggstate->calc_hash_value_gen_info.calc_hash_value_fn,
+			          aggstate);
+			  }
+			}
 			}
 			END_MEMORY_ACCOUNT();
 			break;
@@ -727,6 +777,18 @@ ExecInitNode(Plan *node, EState *estate, int eflags)
 			{
 			result = (PlanState *) ExecInitMotion((Motion *) node,
 												  estate, eflags);
+#ifdef USE_CODEGEN
+			if (NULL != result && gp_enable_motion_mk_sort &&
+				((Motion *) node)->sendSorted &&
+				((MotionState *) result)->mstype == MOTIONSTATE_RECV)
+			{
+			  MotionState *motionstate = (MotionState *) result;
+			  enroll_tupsort_compare_datum_codegen(tupsort_compare_datum,
+			        &motionstate->tupsort_compare_datum_gen_info.tupsort_compare_datum_fn,
+			        motionstate, ((Motion *) node)->numSortCols,
+			        ((Motion *) node)->sortOperators);
+			}
+#endif
 			}
 			END_MEMORY_ACCOUNT();
 			break;
@@ -846,9 +908,10 @@ ExecInitNode(Plan *node, EState *estate, int eflags)
 				(eflags & EXEC_FLAG_EXPLAIN_CODEGEN) &&
 				!(eflags & EXEC_FLAG_EXPLAIN_ONLY);
 
-		if (!isAlienPlanNode ||
+		if ((!isAlienPlanNode ||
 				isExplainAnalyzeCodegenOnMaster ||
-				isExplainCodegenOnMaster)
+				isExplainCodegenOnMaster) &&
+				IsCodegenWorthwhile(node))
 		{
 			(void) CodeGeneratorManagerGenerateCode(CodegenManager);
 			if (isExplainAnalyzeCodegenOnMaster ||
@@ -948,6 +1011,48 @@ EnrollProjInfoTargetList(PlanState *result, ProjectionInfo *ProjInfo)
 }
 
 
+/*
+ * Walker for IsCodegenWorthwhile: counts the nodes of an expression tree.
+ */
+static bool
+CountExpressionNodesWalker(Node *node, int *count)
+{
+	if (node == NULL)
+		return false;
+
+	(*count)++;
+	return expression_tree_walker(node, CountExpressionNodesWalker,
+								  (void *) count);
+}
+
+/* ----------------------------------------------------------------
+ *	  IsCodegenWorthwhile
+ *
+ *	  Decide whether the estimated cost of evaluating the expressions of
+ *	  a plan node, i.e. its estimated rows times the number of nodes in
+ *	  its expressions, reaches codegen_cost_threshold. Below that, the
+ *	  time spent generating and compiling code is unlikely to pay off.
+ * ----------------------------------------------------------------
+ */
+static bool
+IsCodegenWorthwhile(Plan *node)
+{
+	int			exprNodeCount = 0;
+
+	if (codegen_cost_threshold <= 0)
+		return true;
+
+	CountExpressionNodesWalker((Node *) node->qual, &exprNodeCount);
+	CountExpressionNodesWalker((Node *) node->targetlist, &exprNodeCount);
+	if (IsA(node, NestLoop) ||
+		IsA(node, MergeJoin) ||
+		IsA(node, HashJoin))
+		CountExpressionNodesWalker((Node *) ((Join *) node)->joinqual,
+								   &exprNodeCount);
+
+	return node->plan_rows * exprNodeCount >= codegen_cost_threshold;
+}
+
 /* ----------------------------------------------------------------
  *		ExecSliceDependencyNode
  *
@@ -1024,6 +1129,10 @@ ExecProcNode(PlanState *node)
 	if (node->chgParam != NULL) /* something changed */
 		ExecReScan(node, NULL); /* let ReScan handle this */
 
+	/* Switch to generated functions once their background compilation is done */
+	if (CodeGeneratorManagerCompilationPending() && node->CodegenManager != NULL)
+		(void) CodeGeneratorManagerSwapInCompiledFunctions(node->CodegenManager);
+
 	if (node->instrument)
 		InstrStartNode(node->instrument);
 
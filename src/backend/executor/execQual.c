@@ -6360,9 +6360,6 @@ ExecTargetList(List *targetlist,
  *
  * Results are stored into the passed values and isnull arrays.
  */
-#ifndef USE_CODEGEN
-static
-#endif
 void
 ExecVariableList(ProjectionInfo *projInfo,
 				 Datum *values,
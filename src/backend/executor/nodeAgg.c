@@ -99,6 +99,7 @@
 #include "parser/parse_oper.h"
 #include "utils/acl.h"
 #include "utils/builtins.h"
+#include "utils/guc.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/syscache.h"
@@ -151,6 +152,9 @@ static void finalize_aggregate(AggState *aggstate,
 static Bitmapset *find_unaggregated_cols(AggState *aggstate);
 static bool find_unaggregated_cols_walker(Node *node, Bitmapset **colnos);
 static void clear_agg_object(AggState *aggstate);
+static bool agg_can_batch_input(AggState *aggstate);
+static void agg_batch_collect(AggState *aggstate);
+static void agg_batch_flush(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_direct(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_hash_table(AggState *aggstate);
 static void ExecAggExplainEnd(PlanState *planstate, struct StringInfoData *buf);
@@ -581,6 +585,173 @@ advance_aggregates(AggState *aggstate, AggStatePerGroup pergroup,
 	} /* aggno loop */
 }
 
+/*
+ * Advance a single aggregate for one input row.  values and isnull hold the
+ * nvalues evaluated inputs of the aggregate, which are passed to the
+ * transition function as arguments 1 and up.
+ *
+ * The generated advance_aggregates calls this for transition functions that
+ * it has no generator for, e.g. the numeric ones, so that the rest of the
+ * aggregates of the node can still be advanced by generated code.
+ */
+void
+advance_aggregate_row(AggState *aggstate, int aggno,
+					  AggStatePerGroup pergroupstate,
+					  Datum *values, bool *isnull, int nvalues,
+					  MemoryManagerContainer *mem_manager)
+{
+	AggStatePerAgg peraggstate = &aggstate->peragg[aggno];
+	FunctionCallInfoData fcinfo;
+	int			i;
+
+	Assert(nvalues < FUNC_MAX_ARGS);
+	for (i = 0; i < nvalues; i++)
+	{
+		fcinfo.arg[i + 1] = values[i];
+		fcinfo.argnull[i + 1] = isnull[i];
+	}
+	advance_transition_function(aggstate, peraggstate, pergroupstate,
+								&fcinfo, mem_manager);
+}
+
+/*
+ * Advance a single aggregate for a batch of input rows.  values and isnull
+ * are the aggregate's column of the input batch; they are not looked at if
+ * the aggregate takes no arguments, i.e. count(*).
+ *
+ * The generated batch function calls this for aggregates, or states of an
+ * aggregate, that it does not handle in its own loops.
+ */
+void
+advance_aggregate_batch(AggState *aggstate, int aggno,
+						AggStatePerGroup pergroupstate,
+						Datum *values, bool *isnull, int nrows)
+{
+	AggStatePerAgg peraggstate = &aggstate->peragg[aggno];
+	int			row;
+
+	for (row = 0; row < nrows; row++)
+	{
+		FunctionCallInfoData fcinfo;
+
+		if (peraggstate->numArguments > 0)
+		{
+			fcinfo.arg[1] = values[row];
+			fcinfo.argnull[1] = isnull[row];
+		}
+		advance_transition_function(aggstate, peraggstate, pergroupstate,
+									&fcinfo, &(aggstate->mem_manager));
+	}
+}
+
+/*
+ * Advance all the aggregates for a batch of input rows collected by
+ * agg_batch_collect().  values and isnull hold one column of
+ * AGG_INPUT_BATCH_SIZE entries per aggregate.
+ *
+ * This is equivalent to calling advance_aggregates() for each row, since
+ * the aggregates are independent of each other.  Its purpose is to give the
+ * generated code a whole column at a time, which it can run through in a
+ * tight loop.
+ */
+void
+advance_aggregates_batch(AggState *aggstate, AggStatePerGroup pergroup,
+						 Datum *values, bool *isnull, int nrows)
+{
+	int			aggno;
+
+	for (aggno = 0; aggno < aggstate->numaggs; aggno++)
+	{
+		advance_aggregate_batch(aggstate, aggno, &pergroup[aggno],
+								values + aggno * AGG_INPUT_BATCH_SIZE,
+								isnull + aggno * AGG_INPUT_BATCH_SIZE,
+								nrows);
+	}
+}
+
+/*
+ * Can the input of this Agg node be collected into batches?
+ *
+ * We only batch plain aggregation outside of ROLLUP, where every input tuple
+ * goes into the same group, and only when each aggregate takes at most one
+ * argument that is a plain column of a pass-by-value type.  Aggregates with
+ * DISTINCT, ORDER BY or FILTER, and percentile functions, are not batched.
+ */
+static bool
+agg_can_batch_input(AggState *aggstate)
+{
+	Agg		   *node = (Agg *) aggstate->ss.ps.plan;
+	int			aggno;
+
+	if (!codegen || !codegen_advance_aggregates_batch)
+		return false;
+
+	if (node->aggstrategy != AGG_PLAIN || node->inputHasGrouping ||
+		node->lastAgg || aggstate->numaggs == 0)
+		return false;
+
+	for (aggno = 0; aggno < aggstate->numaggs; aggno++)
+	{
+		AggStatePerAgg peraggstate = &aggstate->peragg[aggno];
+
+		if (peraggstate->aggref == NULL ||
+			peraggstate->numSortCols > 0 ||
+			peraggstate->aggrefstate->aggfilter != NULL ||
+			peraggstate->numArguments > 1)
+			return false;
+
+		if (peraggstate->numArguments == 1 &&
+			(!peraggstate->evalproj->pi_isVarList ||
+			 !peraggstate->evaldesc->attrs[0]->attbyval))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Append the aggregate inputs of the current input tuple, which has been
+ * stored in tmpcontext->ecxt_outertuple, to the input batch.  The batch is
+ * flushed into aggstate->pergroup once it is full.
+ */
+static void
+agg_batch_collect(AggState *aggstate)
+{
+	AggInputBatch *batch = aggstate->inputbatch;
+	int			aggno;
+
+	for (aggno = 0; aggno < aggstate->numaggs; aggno++)
+	{
+		AggStatePerAgg peraggstate = &aggstate->peragg[aggno];
+		int			offset = aggno * AGG_INPUT_BATCH_SIZE + batch->nrows;
+
+		/* The inputs are pass-by-value, so they outlive the tuple */
+		if (peraggstate->numArguments > 0)
+			call_ExecVariableList(peraggstate->evalproj,
+								  &batch->values[offset],
+								  &batch->isnull[offset]);
+	}
+
+	if (++batch->nrows == AGG_INPUT_BATCH_SIZE)
+		agg_batch_flush(aggstate);
+}
+
+/*
+ * Advance the aggregates with the rows collected in the input batch, if any.
+ */
+static void
+agg_batch_flush(AggState *aggstate)
+{
+	AggInputBatch *batch = aggstate->inputbatch;
+
+	if (batch->nrows == 0)
+		return;
+
+	call_AdvanceAggregatesBatch(aggstate, aggstate->pergroup,
+								batch->values, batch->isnull, batch->nrows);
+	batch->nrows = 0;
+}
+
 /*
  * Run the transition function for a DISTINCT or ORDER BY aggregate
  * with only one input.  This is called after we have completed
@@ -1232,7 +1403,10 @@ agg_retrieve_direct(AggState *aggstate)
 					if (!aggstate->has_partial_agg)
 					{
 						has_partial_agg = true;
-						call_AdvanceAggregates(aggstate, pergroup, &(aggstate->mem_manager));
+						if (aggstate->inputbatch != NULL)
+							agg_batch_collect(aggstate);
+						else
+							call_AdvanceAggregates(aggstate, pergroup, &(aggstate->mem_manager));
 					}
 
 					/* Reset per-input-tuple context after each tuple */
@@ -1247,11 +1421,20 @@ agg_retrieve_direct(AggState *aggstate)
 						break;
 					}
 
+					/*
+					 * This loop consumes all input in one call, so pick up functions
+					 * compiled in the background here rather than in ExecProcNode.
+					 */
+					if (CodeGeneratorManagerCompilationPending())
+						(void) CodeGeneratorManagerSwapInCompiledFunctions(aggstate->ss.ps.CodegenManager);
+
 					outerslot = ExecProcNode(outerPlan);
 					if (TupIsNull(outerslot))
 					{
 						/* no more outer-plan tuples avaiable */
 						aggstate->agg_done = true;
+						if (aggstate->inputbatch != NULL)
+							agg_batch_flush(aggstate);
 						break;
 					}
 
@@ -1636,6 +1819,10 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 	aggstate->pergroup = NULL;
 	aggstate->grp_firstTuple = NULL;
 	aggstate->hashtable = NULL;
+#ifdef USE_CODEGEN
+	/* Set the default location for calc_hash_value */
+	aggstate->calc_hash_value_gen_info.calc_hash_value_fn = calc_hash_value;
+#endif
 
 	/*
 	 * Create expression contexts.	We need two, one for per-input-tuple
@@ -2338,6 +2525,18 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 
 	aggstate->num_attrs = 0;
 
+	/* Collect the input into batches, if possible */
+	aggstate->inputbatch = NULL;
+	if (agg_can_batch_input(aggstate))
+	{
+		AggInputBatch *batch = (AggInputBatch *) palloc0(sizeof(AggInputBatch));
+
+		batch->values = (Datum *)
+			palloc(sizeof(Datum) * AGG_INPUT_BATCH_SIZE * aggstate->numaggs);
+		batch->isnull = (bool *)
+			palloc0(sizeof(bool) * AGG_INPUT_BATCH_SIZE * aggstate->numaggs);
+		aggstate->inputbatch = batch;
+	}
 
 	/* Set the default memory manager */
 	aggstate->mem_manager.alloc = cxt_alloc;
@@ -2443,6 +2642,9 @@ ExecReScanAgg(AggState *node, ExprContext *exprCtxt)
 	ExecClearTuple(node->ss.ss_ScanTupleSlot);
 	node->has_partial_agg = false;
 
+	if (node->inputbatch != NULL)
+		node->inputbatch->nrows = 0;
+
 	/* Forget current agg values */
 	MemSet(econtext->ecxt_aggvalues, 0, sizeof(Datum) * node->numaggs);
 	MemSet(econtext->ecxt_aggnulls, 0, sizeof(bool) * node->numaggs);
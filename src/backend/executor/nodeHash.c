@@ -129,8 +129,8 @@ MultiExecHash(HashState *node)
 		econtext->ecxt_innertuple = slot;
 		bool hashkeys_null = false;
 
-		if (ExecHashGetHashValue(node, hashtable, econtext, hashkeys, false,
-								 node->hs_keepnull, &hashvalue, &hashkeys_null))
+		if (call_ExecHashGetHashValue(node, node, hashtable, econtext, hashkeys, false,
+									  node->hs_keepnull, &hashvalue, &hashkeys_null))
 		{
 			ExecHashTableInsert(node, hashtable, slot, hashvalue);
 		}
@@ -186,6 +186,10 @@ ExecInitHash(Hash *node, EState *estate, int eflags)
 	hashstate->ps.state = estate;
 	hashstate->hashtable = NULL;
 	hashstate->hashkeys = NIL;	/* will be set by parent HashJoin */
+#ifdef USE_CODEGEN
+	/* Set the default location for ExecHashGetHashValue */
+	hashstate->ExecHashGetHashValue_gen_info.ExecHashGetHashValue_fn = ExecHashGetHashValue;
+#endif
 
 	/*
 	 * Miscellaneous initialization
@@ -452,6 +452,10 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 	hjstate->js.ps.plan = (Plan *) node;
 	hjstate->js.ps.state = estate;
 	hjstate->reuse_hashtable = (eflags & EXEC_FLAG_REWIND) != 0;
+#ifdef USE_CODEGEN
+	/* Set the default location for ExecHashGetHashValue */
+	hjstate->ExecHashGetHashValue_gen_info.ExecHashGetHashValue_fn = ExecHashGetHashValue;
+#endif
 
 	/*
 	 * Miscellaneous initialization
@@ -723,12 +727,12 @@ ExecHashJoinOuterGetTuple(PlanState *outerNode,
 			bool hashkeys_null = false;
 			bool keep_nulls = (HASHJOIN_IS_OUTER(hjstate))||
 					hjstate->hj_nonequijoin;
-			if (ExecHashGetHashValue(hashState, hashtable, econtext,
-									 hjstate->hj_OuterHashKeys,
-									 true,		/* outer tuple */
-									 keep_nulls,
-									 hashvalue,
-									 &hashkeys_null))
+			if (call_ExecHashGetHashValue(hjstate, hashState, hashtable, econtext,
+										  hjstate->hj_OuterHashKeys,
+										  true,		/* outer tuple */
+										  keep_nulls,
+										  hashvalue,
+										  &hashkeys_null))
 			{
 				/* remember outer relation is not empty for possible rescan */
 				hjstate->hj_OuterNotEmpty = true;
@@ -597,6 +597,10 @@ execMotionSortedReceiver_mk(MotionState * node)
     {
         Assert(ctxt->readers); 
         Assert(!ctxt->heap);
+#ifdef USE_CODEGEN
+        /* Use the comparator chosen by codegen when the heap is built */
+        ctxt->mkctxt.compareDatum = node->tupsort_compare_datum_gen_info.tupsort_compare_datum_fn;
+#endif
         ctxt->heap = mkheap_from_reader(ctxt->readers, node->numInputSegs, &ctxt->mkctxt);
         node->tupleheapReady = true;
     }
@@ -866,6 +870,10 @@ ExecInitMotion(Motion * node, EState *estate, int eflags)
 	motionstate->stopRequested = false;
 	motionstate->hashExpr = NULL;
 	motionstate->cdbhash = NULL;
+#ifdef USE_CODEGEN
+	/* Set the default location for tupsort_compare_datum */
+	motionstate->tupsort_compare_datum_gen_info.tupsort_compare_datum_fn = tupsort_compare_datum;
+#endif
 
     /* Look up the sending gang's slice table entry. */
     sendSlice = (Slice *)list_nth(sliceTable->slices, node->motionID);
@@ -22,6 +22,7 @@
 #include "lib/stringinfo.h"             /* StringInfo */
 #include "miscadmin.h"
 #include "utils/tuplesort.h"
+#include "utils/tuplesort_mk_details.h"
 #include "cdb/cdbvars.h" /* CDB *//* gp_sort_flags */
 #include "utils/workfile_mgr.h"
 #include "executor/instrument.h"
@@ -160,6 +161,11 @@ ExecSort(SortState *node)
 
 		tuplesort_set_gpmon(tuplesortstate, &node->ss.ps.gpmon_pkt,
 							&node->ss.ps.gpmon_plan_tick);
+
+#ifdef USE_CODEGEN
+		tuplesort_set_compare_datum(tuplesortstate,
+				node->tupsort_compare_datum_gen_info.tupsort_compare_datum_fn);
+#endif
 	}
 
 	/*
@@ -292,6 +298,10 @@ ExecInitSort(Sort *node, EState *estate, int eflags)
 	sortstate->sort_Done = false;
 	sortstate->tuplesortstate = palloc0(sizeof(GenericTupStore));
 	sortstate->share_lk_ctxt = NULL;
+#ifdef USE_CODEGEN
+	/* Set the default location for tupsort_compare_datum */
+	sortstate->tupsort_compare_datum_gen_info.tupsort_compare_datum_fn = tupsort_compare_datum;
+#endif
 
 	/* CDB */
 
@@ -139,6 +139,13 @@ CGPOptimizer::InitGPOPT ()
   gpos_init(&params);
   gpdxl_init();
   gpopt_init();
+
+  // the objects of the shared metadata cache are evicted by the backend that
+  // has changed the catalog, whether it plans queries with ORCA or not
+  if (gpdb::FMDCacheSharedEnabled())
+  {
+	gpdb::RegisterMDCacheInvalidationCallbacks();
+  }
 }
 
 //---------------------------------------------------------------------------
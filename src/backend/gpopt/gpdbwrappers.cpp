@@ -32,13 +32,20 @@
 
 #include "utils/ext_alloc.h"
 
+// is a batch of wrapper calls running, see GP_WRAP_BATCH_START?
+static bool fWrapBatch = false;
+
+// the wrappers called in a batch run in the exception frame of the batch;
+// this is only safe as long as the batch block keeps to the invariant
+// documented at GP_WRAP_BATCH_START in gpdbwrappers.h
 #define GP_WRAP_START	\
 	sigjmp_buf local_sigjmp_buf;	\
 	{	\
 		CAutoExceptionStack aes((void **) &PG_exception_stack, (void**) &error_context_stack);	\
-		if (0 == sigsetjmp(local_sigjmp_buf, 0))	\
+		if (fWrapBatch || 0 == sigsetjmp(local_sigjmp_buf, 0))	\
 		{	\
-			aes.SetLocalJmp(&local_sigjmp_buf)
+			if (!fWrapBatch)	\
+				aes.SetLocalJmp(&local_sigjmp_buf)
 
 #define GP_WRAP_END	\
 		}	\
@@ -50,358 +57,6 @@
 
 using namespace gpos;
 
-bool
-gpdb::FBoolFromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetBool(d);
-	}
-	GP_WRAP_END;
-	return false;
-}
-
-Datum
-gpdb::DDatumFromBool
-	(
-	bool b
-	)
-{
-	GP_WRAP_START;
-	{
-		return BoolGetDatum(b);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-char
-gpdb::CCharFromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetChar(d);
-	}
-	GP_WRAP_END;
-	return '\0';
-}
-
-Datum
-gpdb::DDatumFromChar
-	(
-	char c
-	)
-{
-	GP_WRAP_START;
-	{
-		return CharGetDatum(c);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-int8
-gpdb::CInt8FromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetInt8(d);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-Datum
-gpdb::DDatumFromInt8
-	(
-	int8 i8
-	)
-{
-	GP_WRAP_START;
-	{
-		return Int8GetDatum(i8);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-uint8
-gpdb::UcUint8FromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetUInt8(d);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-Datum
-gpdb::DDatumFromUint8
-	(
-	uint8 ui8
-	)
-{
-	GP_WRAP_START;
-	{
-		return UInt8GetDatum(ui8);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-int16
-gpdb::SInt16FromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetInt16(d);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-Datum
-gpdb::DDatumFromInt16
-	(
-	int16 i16
-	)
-{
-	GP_WRAP_START;
-	{
-		return Int16GetDatum(i16);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-uint16
-gpdb::UsUint16FromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetUInt16(d);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-Datum
-gpdb::DDatumFromUint16
-	(
-	uint16 ui16
-	)
-{
-	GP_WRAP_START;
-	{
-		return UInt16GetDatum(ui16);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-int32
-gpdb::IInt32FromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetInt32(d);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-Datum
-gpdb::DDatumFromInt32
-	(
-	int32 i32
-	)
-{
-	GP_WRAP_START;
-	{
-		return Int32GetDatum(i32);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-uint32
-gpdb::UlUint32FromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetUInt32(d);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-Datum
-gpdb::DDatumFromUint32
-	(
-	uint32 ui32
-	)
-{
-	GP_WRAP_START;
-	{
-		return UInt32GetDatum(ui32);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-int64
-gpdb::LlInt64FromDatum
-	(
-	Datum d
-	)
-{
-	Datum d2 = d;
-	GP_WRAP_START;
-	{
-		return DatumGetInt64(d2);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-Datum
-gpdb::DDatumFromInt64
-	(
-	int64 i64
-	)
-{
-	int64 ii64 = i64;
-	GP_WRAP_START;
-	{
-		return Int64GetDatum(ii64);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-uint64
-gpdb::UllUint64FromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetUInt64(d);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-Datum
-gpdb::DDatumFromUint64
-	(
-	uint64 ui64
-	)
-{
-	GP_WRAP_START;
-	{
-		return UInt64GetDatum(ui64);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-Oid
-gpdb::OidFromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetObjectId(d);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-void *
-gpdb::PvPointerFromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetPointer(d);
-	}
-	GP_WRAP_END;
-	return NULL;
-}
-
-float4
-gpdb::FpFloat4FromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetFloat4(d);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-float8
-gpdb::DFloat8FromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetFloat8(d);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-Datum
-gpdb::DDatumFromPointer
-	(
-	const void *p
-	)
-{
-	GP_WRAP_START;
-	{
-		return PointerGetDatum(p);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
 bool
 gpdb::FAggregateExists
 	(
@@ -1014,12 +669,27 @@ gpdb::PnodePartConstraintRel
 	GP_WRAP_START;
 	{
 		/* catalog tables: pg_partition, pg_partition_rule, pg_constraint */
-		return get_relation_part_constraints(oidRel, pplDefaultLevels);
+		return get_relation_part_constraints_cached(oidRel, pplDefaultLevels);
 	}
 	GP_WRAP_END;
 	return NULL;
 }
 
+List *
+gpdb::PlPartDefaultLevelsRel
+	(
+	Oid oidRel
+	)
+{
+	GP_WRAP_START;
+	{
+		/* catalog tables: pg_partition, pg_partition_rule */
+		return get_relation_part_default_levels(oidRel);
+	}
+	GP_WRAP_END;
+	return NIL;
+}
+
 bool
 gpdb::FHasExternalPartition
 	(
@@ -1539,108 +1209,6 @@ gpdb::PlCopy
 	return NIL;
 }
 
-ListCell *
-gpdb::PlcListHead
-	(
-	List *l
-	)
-{
-	GP_WRAP_START;
-	{
-		return list_head(l);
-	}
-	GP_WRAP_END;
-	return NULL;
-}
-
-ListCell *
-gpdb::PlcListTail
-	(
-	List *l
-	)
-{
-	GP_WRAP_START;
-	{
-		return list_tail(l);
-	}
-	GP_WRAP_END;
-	return NULL;
-}
-
-uint32
-gpdb::UlListLength
-	(
-	List *l
-	)
-{
-	GP_WRAP_START;
-	{
-		return list_length(l);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-void *
-gpdb::PvListNth
-	(
-	List *list,
-	int n
-	)
-{
-	GP_WRAP_START;
-	{
-		return list_nth(list, n);
-	}
-	GP_WRAP_END;
-	return NULL;
-}
-
-int
-gpdb::IListNth
-	(
-	List *list,
-	int n
-	)
-{
-	GP_WRAP_START;
-	{
-		return list_nth_int(list, n);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-Oid
-gpdb::OidListNth
-	(
-	List *list,
-	int n
-	)
-{
-	GP_WRAP_START;
-	{
-		return list_nth_oid(list, n);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-bool
-gpdb::FMemberOid
-	(
-	List *list,
-	Oid oid
-	)
-{
-	GP_WRAP_START;
-	{
-		return list_member_oid(list, oid);
-	}
-	GP_WRAP_END;
-	return false;
-}
-
 void
 gpdb::FreeList
 	(
@@ -2279,7 +1847,7 @@ gpdb::FHasParquetChildren
 	GP_WRAP_START;
 	{
 		/* catalog tables: pg_inherits, pg_class */
-		return has_parquet_children(oidRel);
+		return has_parquet_children_cached(oidRel);
 	}
 	GP_WRAP_END;
 	return false;
@@ -2309,7 +1877,7 @@ gpdb::FChildPartDistributionMismatch
     GP_WRAP_START;
     {
     	/* catalog tables: pg_class, pg_inherits */
-    	return child_distribution_mismatch(rel);
+    	return child_distribution_mismatch_cached(rel);
     }
     GP_WRAP_END;
     return false;
@@ -2413,7 +1981,7 @@ gpdb::Plgidx
 	GP_WRAP_START;
 	{
 		/* catalog tables: pg_partition, pg_partition_rule, pg_index */
-		return BuildLogicalIndexInfo(oid);
+		return GetLogicalIndexInfo(oid);
 	}
 	GP_WRAP_END;
 	return NULL;
@@ -2952,7 +2520,7 @@ gpdb::UlLeafPartitions
 	GP_WRAP_START;
 	{
 		/* catalog tables: pg_partition, pg_partition_rules */
-		return countLeafPartTables(oidRelation);
+		return countLeafPartTables_cached(oidRelation);
 	}
 	GP_WRAP_END;
 
@@ -2960,16 +2528,28 @@ gpdb::UlLeafPartitions
 }
 
 /*
- * To detect changes to catalog tables that require resetting the Metadata
- * Cache, we use the normal PostgreSQL catalog cache invalidation mechanism.
- * We register a callback to a cache on all the catalog tables that contain
- * information that's contained in the ORCA metadata cache.
-
- * There is no fine-grained mechanism in the metadata cache for invalidating
- * individual entries ATM, so we just blow the whole cache whenever anything
- * changes. The callback simply increments a counter. Whenever we start
- * planning a query, we check the counter to see if it has changed since the
- * last planned query, and reset the whole cache if it has.
+ * To detect changes to catalog tables that require evicting objects from the
+ * Metadata Cache, we use the normal PostgreSQL catalog cache invalidation
+ * mechanism. We register a callback to a cache on all the catalog tables that
+ * contain information that's contained in the ORCA metadata cache.
+ *
+ * The callbacks only remember what has been invalidated: the relation
+ * callback the relations invalidated, and the syscache callback the caches
+ * invalidated. A syscache invalidation carries only the TID of the catalog
+ * tuple, not the OID of the object, so the objects are evicted by the kind of
+ * object the cache feeds (see CMDCacheInvalidator). Whenever we start planning
+ * a query, we fetch the invalidations since the last planned query and evict
+ * the affected objects. When a relation invalidation is for all relations
+ * (after a shared invalidation queue overflow), or when more relations have
+ * been invalidated than we can remember, the whole cache is reset instead.
+ *
+ * When the metadata cache shared by all the sessions is enabled (see
+ * utils/cache/optmdcache.c), the callbacks also evict its objects right away,
+ * as the invalidations are processed. Every backend registers the callbacks
+ * at startup then, for the objects to be evicted even by the backends that
+ * never plan a query with ORCA, like the one that has changed the catalog.
+ * The statistics of a pg_statistic change are evicted by the relation
+ * invalidation that comes along, unless there is none (see FMDCacheNeedsReset).
  *
  * To make sure we've covered all catalog tables that contain information
  * that's stored in the metadata cache, there are "catalog tables: xxx"
@@ -2978,117 +2558,329 @@ gpdb::UlLeafPartitions
  * anything fetched via the wrapper functions in this file can end up in the
  * metadata cache and hence need to have an invalidation callback registered.
  */
-static bool mdcache_invalidation_counter_registered = false;
-static int64 mdcache_invalidation_counter = 0;
-static int64 last_mdcache_invalidation_counter = 0;
+#define MDCACHE_MAX_INVALIDATED_RELS	64
+
+/* These are all the catalog tables that we care about. */
+static const int mdcache_syscaches[] = {
+	AGGFNOID,			/* pg_aggregate */
+	AMOPOPID,			/* pg_amop */
+	CASTSOURCETARGET,	/* pg_cast */
+	CONSTROID,			/* pg_constraint */
+	OPEROID,			/* pg_operator */
+	OPFAMILYOID,		/* pg_opfamily */
+	PARTOID,			/* pg_partition */
+	PARTRULEOID,		/* pg_partition_rule */
+	STATRELATT,			/* pg_statistics */
+	TYPEOID,			/* pg_type */
+	PROCOID,			/* pg_proc */
+
+	/*
+	 * lookup_type_cache() will also access pg_opclass, via GetDefaultOpClass(),
+	 * but there is no syscache for it. Postgres doesn't seem to worry about
+	 * invalidating the type cache on updates to pg_opclass, so we don't
+	 * worry about that either.
+	 */
+	/* pg_opclass */
+
+	/*
+	 * Information from the following catalogs are included in the
+	 * relcache, and any updates will generate relcache invalidation
+	 * event. We'll catch the relcache invalidation event and don't need
+	 * to register a catcache callback for them.
+	 */
+	/* pg_class */
+	/* pg_index */
+	/* pg_trigger */
+
+	/*
+	 * pg_exttable is only updated when a new external table is dropped/created,
+	 * which will trigger a relcache invalidation event.
+	 */
+	/* pg_exttable */
+
+	/*
+	 * XXX: no syscache on pg_inherits. Is that OK? For any partitioning
+	 * changes, I think there will also be updates on pg_partition and/or
+	 * pg_partition_rules.
+	 */
+	/* pg_inherits */
+
+	/*
+	 * We assume that gp_segment_config will not change on the fly in a way that
+	 * would affect ORCA
+	 */
+	/* gp_segment_config */
+};
+
+static bool mdcache_invalidation_callbacks_registered = false;
+static bool mdcache_needs_reset = false;
+static Oid	mdcache_invalidated_rels[MDCACHE_MAX_INVALIDATED_RELS];
+static int	mdcache_num_invalidated_rels = 0;
+static bool mdcache_invalidated_syscaches[lengthof(mdcache_syscaches)];
 
 static void
-mdsyscache_invalidation_counter_callback(Datum arg, int cacheid,  ItemPointer tuplePtr)
+mdsyscache_invalidation_callback(Datum arg, int cacheid,  ItemPointer tuplePtr)
 {
-	mdcache_invalidation_counter++;
+	unsigned int i;
+
+	for (i = 0; i < lengthof(mdcache_syscaches); i++)
+	{
+		if (mdcache_syscaches[i] == cacheid)
+			mdcache_invalidated_syscaches[i] = true;
+	}
+
+	OptMDCacheInvalidateKinds(OptMDCacheSyscacheKinds(cacheid));
 }
 
 static void
-mdrelcache_invalidation_counter_callback(Datum arg, Oid relid)
+mdrelcache_invalidation_callback(Datum arg, Oid relid)
 {
-	mdcache_invalidation_counter++;
+	int			i;
+
+	if (OidIsValid(relid))
+		OptMDCacheInvalidateOid(relid);
+	else
+		OptMDCacheInvalidateAll();
+
+	if (mdcache_needs_reset)
+		return;
+
+	/* InvalidOid means all relations */
+	if (!OidIsValid(relid) ||
+		mdcache_num_invalidated_rels == MDCACHE_MAX_INVALIDATED_RELS)
+	{
+		mdcache_needs_reset = true;
+		return;
+	}
+
+	for (i = 0; i < mdcache_num_invalidated_rels; i++)
+	{
+		if (mdcache_invalidated_rels[i] == relid)
+			return;
+	}
+	mdcache_invalidated_rels[mdcache_num_invalidated_rels++] = relid;
 }
 
 static void
 register_mdcache_invalidation_callbacks(void)
 {
-	/* These are all the catalog tables that we care about. */
-	int			metadata_caches[] = {
-		AGGFNOID,			/* pg_aggregate */
-		AMOPOPID,			/* pg_amop */
-		CASTSOURCETARGET,	/* pg_cast */
-		CONSTROID,			/* pg_constraint */
-		OPEROID,			/* pg_operator */
-		OPFAMILYOID,		/* pg_opfamily */
-		PARTOID,			/* pg_partition */
-		PARTRULEOID,		/* pg_partition_rule */
-		STATRELATT,			/* pg_statistics */
-		TYPEOID,			/* pg_type */
-		PROCOID,			/* pg_proc */
-
-		/*
-		 * lookup_type_cache() will also access pg_opclass, via GetDefaultOpClass(),
-		 * but there is no syscache for it. Postgres doesn't seem to worry about
-		 * invalidating the type cache on updates to pg_opclass, so we don't
-		 * worry about that either.
-		 */
-		/* pg_opclass */
-
-		/*
-		 * Information from the following catalogs are included in the
-		 * relcache, and any updates will generate relcache invalidation
-		 * event. We'll catch the relcache invalidation event and don't need
-		 * to register a catcache callback for them.
-		 */
-		/* pg_class */
-		/* pg_index */
-		/* pg_trigger */
-
-		/*
-		 * pg_exttable is only updated when a new external table is dropped/created,
-		 * which will trigger a relcache invalidation event.
-		 */
-		/* pg_exttable */
-
-		/*
-		 * XXX: no syscache on pg_inherits. Is that OK? For any partitioning
-		 * changes, I think there will also be updates on pg_partition and/or
-		 * pg_partition_rules.
-		 */
-		/* pg_inherits */
-
-		/*
-		 * We assume that gp_segment_config will not change on the fly in a way that
-		 * would affect ORCA
-		 */
-		/* gp_segment_config */
-	};
 	unsigned int i;
 
-	for (i = 0; i < lengthof(metadata_caches); i++)
+	for (i = 0; i < lengthof(mdcache_syscaches); i++)
 	{
-		CacheRegisterSyscacheCallback(metadata_caches[i],
-									  &mdsyscache_invalidation_counter_callback,
+		CacheRegisterSyscacheCallback(mdcache_syscaches[i],
+									  &mdsyscache_invalidation_callback,
 									  (Datum) 0);
 	}
 
 	/* also register the relcache callback */
-	CacheRegisterRelcacheCallback(&mdrelcache_invalidation_counter_callback,
+	CacheRegisterRelcacheCallback(&mdrelcache_invalidation_callback,
 								  (Datum) 0);
+
+	mdcache_invalidation_callbacks_registered = true;
+}
+
+// Register the invalidation callbacks of the metadata cache, unless they
+// have been already
+void
+gpdb::RegisterMDCacheInvalidationCallbacks(void)
+{
+	GP_WRAP_START;
+	{
+		if (!mdcache_invalidation_callbacks_registered)
+			register_mdcache_invalidation_callbacks();
+		return;
+	}
+	GP_WRAP_END;
 }
 
-// Has there been any catalog changes since last call?
+// Has there been any catalog changes since last call that need the whole
+// cache to be reset? If not, return the relations and the syscaches
+// invalidated since last call
 bool
 gpdb::FMDCacheNeedsReset
 		(
-			void
+			List **pplRelOids,
+			List **pplCacheIds
 		)
 {
 	GP_WRAP_START;
 	{
-		if (!mdcache_invalidation_counter_registered)
-		{
+		bool		needs_reset = mdcache_needs_reset;
+		unsigned int i;
+
+		if (!mdcache_invalidation_callbacks_registered)
 			register_mdcache_invalidation_callbacks();
-			mdcache_invalidation_counter_registered = true;
-		}
-		if (last_mdcache_invalidation_counter == mdcache_invalidation_counter)
-			return false;
-		else
+
+		*pplRelOids = NIL;
+		*pplCacheIds = NIL;
+		if (!needs_reset)
 		{
-			last_mdcache_invalidation_counter = mdcache_invalidation_counter;
-			return true;
+			for (i = 0; i < (unsigned int) mdcache_num_invalidated_rels; i++)
+				*pplRelOids = lappend_oid(*pplRelOids, mdcache_invalidated_rels[i]);
+
+			for (i = 0; i < lengthof(mdcache_syscaches); i++)
+			{
+				if (mdcache_invalidated_syscaches[i])
+					*pplCacheIds = lappend_int(*pplCacheIds, mdcache_syscaches[i]);
+			}
 		}
+
+		mdcache_needs_reset = false;
+		mdcache_num_invalidated_rels = 0;
+		memset(mdcache_invalidated_syscaches, 0, sizeof(mdcache_invalidated_syscaches));
+
+		return needs_reset;
 	}
 	GP_WRAP_END;
 
 	return true;
 }
 
+// Is the metadata cache shared by all the sessions enabled?
+bool
+gpdb::FMDCacheSharedEnabled(void)
+{
+	return OptMDCacheSharedEnabled();
+}
+
+// Can the current transaction use the metadata cache shared by all the
+// sessions?
+bool
+gpdb::FMDCacheSharedUsable(void)
+{
+	return OptMDCacheSharedUsable();
+}
+
+// Generation of the shared metadata cache, to be taken before translating an
+// object to be added to it
+uint32
+gpdb::UlMDCacheSharedGeneration(void)
+{
+	GP_WRAP_START;
+	{
+		return OptMDCacheGeneration();
+	}
+	GP_WRAP_END;
+
+	return 0;
+}
+
+// Look up an object in the shared metadata cache, return a copy of its DXL,
+// to be freed by the caller, or NULL if it is not there
+char *
+gpdb::SzMDCacheSharedLookup
+		(
+			const char *szKey,
+			Size *pulLen,
+			OptMDCacheKind *pkind,
+			Oid *rgoidDeps,
+			int *piDeps
+		)
+{
+	GP_WRAP_START;
+	{
+		return OptMDCacheLookup(szKey, pulLen, pkind, rgoidDeps, piDeps);
+	}
+	GP_WRAP_END;
+
+	return NULL;
+}
+
+// Add an object to the shared metadata cache
+void
+gpdb::MDCacheSharedInsert
+		(
+			const char *szKey,
+			const char *szData,
+			Size ulLen,
+			OptMDCacheKind kind,
+			const Oid *rgoidDeps,
+			int iDeps,
+			uint32 ulGeneration
+		)
+{
+	GP_WRAP_START;
+	{
+		OptMDCacheInsert(szKey, szData, ulLen, kind, rgoidDeps, iDeps, ulGeneration);
+		return;
+	}
+	GP_WRAP_END;
+}
+
+// Look up the plan of a query in the plan cache
+PlannedStmt *
+gpdb::PplstmtPlanCacheLookup
+		(
+			Query *pquery,
+			OrcaPlanCacheProbe *pprobe
+		)
+{
+	GP_WRAP_START;
+	{
+		return OrcaPlanCacheLookup(pquery, pprobe);
+	}
+	GP_WRAP_END;
+
+	return NULL;
+}
+
+// Add the plan optimized for a query to the plan cache
+void
+gpdb::PlanCacheInsert
+		(
+			OrcaPlanCacheProbe *pprobe,
+			PlannedStmt *pplstmt
+		)
+{
+	GP_WRAP_START;
+	{
+		OrcaPlanCacheInsert(pprobe, pplstmt);
+		return;
+	}
+	GP_WRAP_END;
+}
+
+// Evict the cached plans affected by invalidated relations and syscaches
+void
+gpdb::PlanCacheInvalidate
+		(
+			List *plRelOids,
+			List *plCacheIds
+		)
+{
+	GP_WRAP_START;
+	{
+		OrcaPlanCacheInvalidate(plRelOids, plCacheIds);
+		return;
+	}
+	GP_WRAP_END;
+}
+
+// Evict all the cached plans
+void
+gpdb::PlanCacheReset(void)
+{
+	GP_WRAP_START;
+	{
+		OrcaPlanCacheReset();
+		return;
+	}
+	GP_WRAP_END;
+}
+
+gpdb::CAutoWrapBatch::CAutoWrapBatch()
+	:
+	m_fOuterBatch(fWrapBatch)
+{
+	fWrapBatch = true;
+}
+
+gpdb::CAutoWrapBatch::~CAutoWrapBatch()
+{
+	fWrapBatch = m_fOuterBatch;
+}
+
 // Functions for ORCA's memory consumption to be tracked by GPDB
 void *
 gpdb::OptimizerAlloc
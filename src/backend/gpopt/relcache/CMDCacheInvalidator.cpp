@@ -0,0 +1,543 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2017 Pivotal Software, Inc.
+//
+//	@filename:
+//		CMDCacheInvalidator.cpp
+//
+//	@doc:
+//		Implementation of the eviction of the metadata cache objects affected
+//		by catalog changes
+//
+//	@test:
+//
+//
+//---------------------------------------------------------------------------
+
+#include "postgres.h"
+#include "nodes/pg_list.h"
+#include "utils/rel.h"
+#include "utils/syscache.h"
+
+#include "gpopt/gpdbwrappers.h"
+#include "gpopt/relcache/CMDCacheInvalidator.h"
+#include "gpopt/mdcache/CMDCache.h"
+#include "gpopt/mdcache/CMDKey.h"
+
+#include "gpos/memory/CCacheAccessor.h"
+#include "gpos/memory/CMemoryPoolManager.h"
+
+#include "naucrates/md/CMDIdGPDB.h"
+#include "naucrates/md/CMDIdRelStats.h"
+#include "naucrates/md/CMDIdColStats.h"
+#include "naucrates/md/CMDIdCast.h"
+#include "naucrates/md/CMDIdScCmp.h"
+#include "naucrates/md/IMDRelation.h"
+#include "naucrates/md/IMDTrigger.h"
+#include "naucrates/md/IMDCheckConstraint.h"
+
+using namespace gpos;
+using namespace gpopt;
+using namespace gpmd;
+
+// objects registered before the whole cache is reset, the registry keeps the
+// objects evicted by the cache quota and those registered again after being
+// evicted
+#define GPOPT_MDCACHE_MAX_REGISTERED	(100 * 1024)
+
+// accessor of the metadata cache
+typedef CCacheAccessor<IMDCacheObject*, CMDKey*> CacheAccessorMD;
+
+IMemoryPool *CMDCacheInvalidator::m_pmp = NULL;
+
+CMDCacheInvalidator::HMUlPdrgpmdid *CMDCacheInvalidator::m_phmulpdrgpmdid = NULL;
+
+DrgPmdid *CMDCacheInvalidator::m_rgpdrgpmdidKind[OPTMDCACHE_NUM_KINDS];
+
+ULONG CMDCacheInvalidator::m_ulRegistered = 0;
+
+BOOL CMDCacheInvalidator::m_fPartitioned = false;
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDCacheInvalidator::Release
+//
+//	@doc:
+//		Release the registry
+//
+//---------------------------------------------------------------------------
+void
+CMDCacheInvalidator::Release()
+{
+	if (NULL == m_pmp)
+	{
+		return;
+	}
+
+	m_phmulpdrgpmdid->Release();
+	m_phmulpdrgpmdid = NULL;
+	for (ULONG ul = 0; ul < OPTMDCACHE_NUM_KINDS; ul++)
+	{
+		m_rgpdrgpmdidKind[ul]->Release();
+		m_rgpdrgpmdidKind[ul] = NULL;
+	}
+
+	CMemoryPoolManager::Pmpm()->Destroy(m_pmp);
+	m_pmp = NULL;
+	m_ulRegistered = 0;
+	m_fPartitioned = false;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDCacheInvalidator::Reset
+//
+//	@doc:
+//		Reset the registry, the metadata cache has no objects
+//
+//---------------------------------------------------------------------------
+void
+CMDCacheInvalidator::Reset()
+{
+	Release();
+
+	m_pmp = CMemoryPoolManager::Pmpm()->PmpCreate(CMemoryPoolManager::EatTracker, false /* fThreadSafe */, ULLONG_MAX);
+	m_phmulpdrgpmdid = GPOS_NEW(m_pmp) HMUlPdrgpmdid(m_pmp);
+	for (ULONG ul = 0; ul < OPTMDCACHE_NUM_KINDS; ul++)
+	{
+		m_rgpdrgpmdidKind[ul] = GPOS_NEW(m_pmp) DrgPmdid(m_pmp);
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDCacheInvalidator::PmdidCopy
+//
+//	@doc:
+//		Copy of the given mdid in the memory pool of the registry, as the
+//		mdids given are released along with the memory pool of the query
+//
+//---------------------------------------------------------------------------
+IMDId *
+CMDCacheInvalidator::PmdidCopy
+	(
+	IMDId *pmdid
+	)
+{
+	switch (pmdid->Emdidt())
+	{
+		case IMDId::EmdidGPDB:
+			return GPOS_NEW(m_pmp) CMDIdGPDB(*CMDIdGPDB::PmdidConvert(pmdid));
+
+		case IMDId::EmdidRelStats:
+			return GPOS_NEW(m_pmp) CMDIdRelStats
+						(
+						CMDIdGPDB::PmdidConvert(PmdidCopy(CMDIdRelStats::PmdidConvert(pmdid)->PmdidRel()))
+						);
+
+		case IMDId::EmdidColStats:
+		{
+			CMDIdColStats *pmdidColStats = CMDIdColStats::PmdidConvert(pmdid);
+			return GPOS_NEW(m_pmp) CMDIdColStats
+						(
+						CMDIdGPDB::PmdidConvert(PmdidCopy(pmdidColStats->PmdidRel())),
+						pmdidColStats->UlPos()
+						);
+		}
+
+		case IMDId::EmdidCastFunc:
+		{
+			CMDIdCast *pmdidCast = CMDIdCast::PmdidConvert(pmdid);
+			return GPOS_NEW(m_pmp) CMDIdCast
+						(
+						CMDIdGPDB::PmdidConvert(PmdidCopy(pmdidCast->PmdidSrc())),
+						CMDIdGPDB::PmdidConvert(PmdidCopy(pmdidCast->PmdidDest()))
+						);
+		}
+
+		case IMDId::EmdidScCmp:
+		{
+			CMDIdScCmp *pmdidScCmp = CMDIdScCmp::PmdidConvert(pmdid);
+			return GPOS_NEW(m_pmp) CMDIdScCmp
+						(
+						CMDIdGPDB::PmdidConvert(PmdidCopy(pmdidScCmp->PmdidLeft())),
+						CMDIdGPDB::PmdidConvert(PmdidCopy(pmdidScCmp->PmdidRight())),
+						pmdidScCmp->Ecmpt()
+						);
+		}
+
+		default:
+			return NULL;
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDCacheInvalidator::Emdk
+//
+//	@doc:
+//		Kind of the given cached object
+//
+//---------------------------------------------------------------------------
+OptMDCacheKind
+CMDCacheInvalidator::Emdk
+	(
+	const IMDCacheObject *pimdobj
+	)
+{
+	switch (pimdobj->Emdt())
+	{
+		case IMDCacheObject::EmdtRel:
+			return OPTMDCACHE_KIND_REL;
+		case IMDCacheObject::EmdtInd:
+			return OPTMDCACHE_KIND_INDEX;
+		case IMDCacheObject::EmdtType:
+			return OPTMDCACHE_KIND_TYPE;
+		case IMDCacheObject::EmdtOp:
+			return OPTMDCACHE_KIND_OP;
+		case IMDCacheObject::EmdtFunc:
+			return OPTMDCACHE_KIND_FUNC;
+		case IMDCacheObject::EmdtAgg:
+			return OPTMDCACHE_KIND_AGG;
+		case IMDCacheObject::EmdtTrigger:
+			return OPTMDCACHE_KIND_TRIGGER;
+		case IMDCacheObject::EmdtCheckConstraint:
+			return OPTMDCACHE_KIND_CHECKCONSTRAINT;
+		case IMDCacheObject::EmdtCastFunc:
+			return OPTMDCACHE_KIND_CAST;
+		case IMDCacheObject::EmdtScCmp:
+			return OPTMDCACHE_KIND_SCCMP;
+		case IMDCacheObject::EmdtRelStats:
+		case IMDCacheObject::EmdtColStats:
+		default:
+			return OPTMDCACHE_KIND_STATS;
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDCacheInvalidator::Register
+//
+//	@doc:
+//		Register an object under the given oid, taking over a reference of
+//		its mdid
+//
+//---------------------------------------------------------------------------
+void
+CMDCacheInvalidator::Register
+	(
+	OID oid,
+	IMDId *pmdid
+	)
+{
+	DrgPmdid *pdrgpmdid = m_phmulpdrgpmdid->PtLookup(&oid);
+	if (NULL == pdrgpmdid)
+	{
+		pdrgpmdid = GPOS_NEW(m_pmp) DrgPmdid(m_pmp);
+		m_phmulpdrgpmdid->FInsert(GPOS_NEW(m_pmp) ULONG(oid), pdrgpmdid);
+	}
+
+	pdrgpmdid->Append(pmdid);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDCacheInvalidator::UlDeps
+//
+//	@doc:
+//		Kind of an object translated by the relcache provider and the oids of
+//		the catalog objects it is translated from, at most
+//		OPTMDCACHE_MAX_DEPS. Returns the number of oids, zero for an object
+//		that cannot be registered. Tells as well if the object belongs to a
+//		partitioned table, whose objects are evicted when any of its parts is
+//		invalidated.
+//
+//---------------------------------------------------------------------------
+ULONG
+CMDCacheInvalidator::UlDeps
+	(
+	IMDId *pmdid,
+	const IMDCacheObject *pimdobj,
+	OptMDCacheKind *pemdk,
+	Oid *rgoidDeps,
+	BOOL *pfPartitioned
+	)
+{
+	ULONG ulDeps = 0;
+
+	*pemdk = Emdk(pimdobj);
+	*pfPartitioned = false;
+
+	switch (pmdid->Emdidt())
+	{
+		case IMDId::EmdidGPDB:
+		{
+			OID oid = CMDIdGPDB::PmdidConvert(pmdid)->OidObjectId();
+			rgoidDeps[ulDeps++] = oid;
+
+			switch (pimdobj->Emdt())
+			{
+				case IMDCacheObject::EmdtRel:
+					*pfPartitioned = dynamic_cast<const IMDRelation *>(pimdobj)->FPartitioned();
+					break;
+
+				case IMDCacheObject::EmdtInd:
+				{
+					// an index is changed along with its relation, and the
+					// index of a partitioned table along with the root
+					Relation relIndex = gpdb::RelGetRelation(oid);
+					if (NULL == relIndex)
+					{
+						return 0;
+					}
+					OID oidRel = relIndex->rd_index->indrelid;
+					gpdb::CloseRelation(relIndex);
+
+					rgoidDeps[ulDeps++] = oidRel;
+					if (!gpdb::FRelPartIsNone(oidRel))
+					{
+						*pfPartitioned = true;
+						OID oidRoot = gpdb::OidRootPartition(oidRel);
+						if (InvalidOid != oidRoot && oidRoot != oidRel)
+						{
+							rgoidDeps[ulDeps++] = oidRoot;
+						}
+					}
+					break;
+				}
+
+				case IMDCacheObject::EmdtTrigger:
+					rgoidDeps[ulDeps++] = CMDIdGPDB::PmdidConvert(dynamic_cast<const IMDTrigger *>(pimdobj)->PmdidRel())->OidObjectId();
+					break;
+
+				case IMDCacheObject::EmdtCheckConstraint:
+					rgoidDeps[ulDeps++] = CMDIdGPDB::PmdidConvert(dynamic_cast<const IMDCheckConstraint *>(pimdobj)->PmdidRel())->OidObjectId();
+					break;
+
+				default:
+					break;
+			}
+			break;
+		}
+
+		case IMDId::EmdidRelStats:
+			rgoidDeps[ulDeps++] = CMDIdGPDB::PmdidConvert(CMDIdRelStats::PmdidConvert(pmdid)->PmdidRel())->OidObjectId();
+			break;
+
+		case IMDId::EmdidColStats:
+			rgoidDeps[ulDeps++] = CMDIdGPDB::PmdidConvert(CMDIdColStats::PmdidConvert(pmdid)->PmdidRel())->OidObjectId();
+			break;
+
+		case IMDId::EmdidCastFunc:
+		{
+			CMDIdCast *pmdidCast = CMDIdCast::PmdidConvert(pmdid);
+			rgoidDeps[ulDeps++] = CMDIdGPDB::PmdidConvert(pmdidCast->PmdidSrc())->OidObjectId();
+			rgoidDeps[ulDeps++] = CMDIdGPDB::PmdidConvert(pmdidCast->PmdidDest())->OidObjectId();
+			break;
+		}
+
+		case IMDId::EmdidScCmp:
+		{
+			CMDIdScCmp *pmdidScCmp = CMDIdScCmp::PmdidConvert(pmdid);
+			rgoidDeps[ulDeps++] = CMDIdGPDB::PmdidConvert(pmdidScCmp->PmdidLeft())->OidObjectId();
+			rgoidDeps[ulDeps++] = CMDIdGPDB::PmdidConvert(pmdidScCmp->PmdidRight())->OidObjectId();
+			break;
+		}
+
+		default:
+			break;
+	}
+
+	GPOS_ASSERT(OPTMDCACHE_MAX_DEPS >= ulDeps);
+
+	return ulDeps;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDCacheInvalidator::Register
+//
+//	@doc:
+//		Register an object of the given kind under the oids of the catalog
+//		objects it is translated from
+//
+//---------------------------------------------------------------------------
+void
+CMDCacheInvalidator::Register
+	(
+	IMDId *pmdid,
+	OptMDCacheKind emdk,
+	const Oid *rgoidDeps,
+	ULONG ulDeps,
+	BOOL fPartitioned
+	)
+{
+	if (NULL == m_pmp || 0 == ulDeps)
+	{
+		return;
+	}
+
+	IMDId *pmdidCopy = PmdidCopy(pmdid);
+	if (NULL == pmdidCopy)
+	{
+		return;
+	}
+
+	for (ULONG ul = 0; ul < ulDeps; ul++)
+	{
+		pmdidCopy->AddRef();
+		Register(rgoidDeps[ul], pmdidCopy);
+	}
+	m_fPartitioned = m_fPartitioned || fPartitioned;
+
+	// the kind array takes over the reference of the copy
+	m_rgpdrgpmdidKind[emdk]->Append(pmdidCopy);
+	m_ulRegistered++;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDCacheInvalidator::Evict
+//
+//	@doc:
+//		Evict an object from the metadata cache, if it is there still. It is
+//		deleted once the accessors of the running query release it.
+//
+//---------------------------------------------------------------------------
+void
+CMDCacheInvalidator::Evict
+	(
+	IMDId *pmdid
+	)
+{
+	CMDKey mdkey(pmdid);
+	CacheAccessorMD cacc(CMDCache::Pcache());
+
+	if (NULL != cacc.PtLookup(&mdkey))
+	{
+		cacc.MarkForDeletion();
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDCacheInvalidator::EvictOid
+//
+//	@doc:
+//		Evict the objects registered under the given oid
+//
+//---------------------------------------------------------------------------
+void
+CMDCacheInvalidator::EvictOid
+	(
+	OID oid
+	)
+{
+	DrgPmdid *pdrgpmdid = m_phmulpdrgpmdid->PtLookup(&oid);
+	if (NULL == pdrgpmdid)
+	{
+		return;
+	}
+
+	for (ULONG ul = 0; ul < pdrgpmdid->UlLength(); ul++)
+	{
+		Evict((*pdrgpmdid)[ul]);
+	}
+	pdrgpmdid->Clear();
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDCacheInvalidator::EvictKind
+//
+//	@doc:
+//		Evict the objects registered of the given kind
+//
+//---------------------------------------------------------------------------
+void
+CMDCacheInvalidator::EvictKind
+	(
+	OptMDCacheKind emdk
+	)
+{
+	DrgPmdid *pdrgpmdid = m_rgpdrgpmdidKind[emdk];
+
+	for (ULONG ul = 0; ul < pdrgpmdid->UlLength(); ul++)
+	{
+		Evict((*pdrgpmdid)[ul]);
+	}
+	pdrgpmdid->Clear();
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDCacheInvalidator::FEvict
+//
+//	@doc:
+//		Evict the objects affected by the given invalidated relations and
+//		syscaches. Return false if the whole cache needs to be reset instead.
+//
+//		A pg_statistic change evicts all the statistics objects, even when
+//		relations were invalidated along with it: ANALYZE only invalidates
+//		the relation if its pg_class row changes, and a relation
+//		invalidation does not tell which statistics changed.
+//
+//---------------------------------------------------------------------------
+BOOL
+CMDCacheInvalidator::FEvict
+	(
+	List *plRelOids,
+	List *plCacheIds
+	)
+{
+	if (NULL == m_pmp || GPOPT_MDCACHE_MAX_REGISTERED < m_ulRegistered)
+	{
+		return false;
+	}
+
+	GPOS_TRY
+	{
+		ListCell *plc = NULL;
+		ForEach (plc, plRelOids)
+		{
+			OID oid = lfirst_oid(plc);
+			EvictOid(oid);
+
+			// a partitioned table is translated along with its parts
+			if (m_fPartitioned)
+			{
+				OID oidRoot = gpdb::OidRootPartition(oid);
+				if (InvalidOid != oidRoot)
+				{
+					EvictOid(oidRoot);
+				}
+			}
+		}
+
+		ULONG ulKindMask = 0;
+		ForEach (plc, plCacheIds)
+		{
+			ulKindMask |= OptMDCacheSyscacheKinds(lfirst_int(plc));
+		}
+
+		for (ULONG ul = 0; ul < OPTMDCACHE_NUM_KINDS; ul++)
+		{
+			if (0 != (ulKindMask & OPTMDCACHE_KIND_MASK(ul)))
+			{
+				EvictKind((OptMDCacheKind) ul);
+			}
+		}
+	}
+	GPOS_CATCH_EX(ex)
+	{
+		// the invalidations are consumed, do not leave stale objects behind
+		CMDCache::Shutdown();
+		Release();
+		GPOS_RETHROW(ex);
+	}
+	GPOS_CATCH_END;
+
+	return true;
+}
+
+// EOF
@@ -15,7 +15,9 @@
 //---------------------------------------------------------------------------
 
 #include "postgres.h"
+#include "gpopt/gpdbwrappers.h"
 #include "gpopt/relcache/CMDProviderRelcache.h"
+#include "gpopt/relcache/CMDCacheInvalidator.h"
 #include "gpopt/translate/CTranslatorRelcacheToDXL.h"
 #include "gpopt/mdcache/CMDAccessor.h"
 
@@ -45,12 +47,49 @@ CMDProviderRelcache::CMDProviderRelcache
 	GPOS_ASSERT(NULL != m_pmp);
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDProviderRelcache::FSharedKey
+//
+//	@doc:
+//		Key of the given object in the shared metadata cache, its mdid in
+//		ASCII. Returns false if the mdid does not fit in a key.
+//
+//---------------------------------------------------------------------------
+BOOL
+CMDProviderRelcache::FSharedKey
+	(
+	IMDId *pmdid,
+	CHAR *szKey
+	)
+{
+	const WCHAR *wsz = pmdid->Wsz();
+	ULONG ul = 0;
+
+	for (; L'\0' != wsz[ul]; ul++)
+	{
+		if (OPTMDCACHE_KEY_LEN - 1 == ul || 0x7f < wsz[ul])
+		{
+			return false;
+		}
+		szKey[ul] = (CHAR) wsz[ul];
+	}
+	szKey[ul] = '\0';
+
+	return true;
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CMDProviderRelcache::PstrObject
 //
 //	@doc:
-//		Returns the DXL of the requested object in the provided memory pool
+//		Returns the DXL of the requested object in the provided memory pool.
+//		When the metadata cache shared by all the sessions is enabled, the
+//		DXL is looked up there first, and added there once translated, but
+//		for the objects of partitioned tables: a part invalidated does not
+//		tell its root, so these are never shared. A transaction that may
+//		have changed the catalog does not use that cache at all.
 //
 //---------------------------------------------------------------------------
 CWStringBase *
@@ -62,12 +101,59 @@ CMDProviderRelcache::PstrObject
 	)
 	const
 {
+	CHAR szKey[OPTMDCACHE_KEY_LEN];
+	OptMDCacheKind emdk = OPTMDCACHE_KIND_REL;
+	Oid rgoidDeps[OPTMDCACHE_MAX_DEPS];
+	BOOL fShared = gpdb::FMDCacheSharedUsable() && FSharedKey(pmdid, szKey);
+	ULONG ulGeneration = 0;
+
+	if (fShared)
+	{
+		Size ulLen = 0;
+		int iDeps = 0;
+		char *szData = gpdb::SzMDCacheSharedLookup(szKey, &ulLen, &emdk, rgoidDeps, &iDeps);
+		if (NULL != szData)
+		{
+			// the object is to be cached, register it for invalidation
+			CMDCacheInvalidator::Register(pmdid, emdk, rgoidDeps, iDeps, false /*fPartitioned*/);
+
+			CWStringDynamic *pstr = GPOS_NEW(m_pmp) CWStringDynamic(m_pmp, (WCHAR *) szData);
+			gpdb::GPDBFree(szData);
+
+			return pstr;
+		}
+
+		// invalidations processed from now on, the pending ones included,
+		// tell that the translation may see the catalog as it was before
+		// the change
+		ulGeneration = gpdb::UlMDCacheSharedGeneration();
+	}
+
 	IMDCacheObject *pimdobj = CTranslatorRelcacheToDXL::Pimdobj(pmp, pmda, pmdid);
 
 	GPOS_ASSERT(NULL != pimdobj);
 
+	// the object is to be cached, register it for invalidation
+	BOOL fPartitioned = false;
+	ULONG ulDeps = CMDCacheInvalidator::UlDeps(pmdid, pimdobj, &emdk, rgoidDeps, &fPartitioned);
+	CMDCacheInvalidator::Register(pmdid, emdk, rgoidDeps, ulDeps, fPartitioned);
+
 	CWStringDynamic *pstr = CDXLUtils::PstrSerializeMDObj(m_pmp, pimdobj, true /*fSerializeHeaders*/, false /*findent*/);
 
+	if (fShared && 0 < ulDeps && !fPartitioned)
+	{
+		gpdb::MDCacheSharedInsert
+				(
+				szKey,
+				(const char *) pstr->Wsz(),
+				(pstr->UlLength() + 1) * GPOS_SIZEOF(WCHAR),
+				emdk,
+				rgoidDeps,
+				(int) ulDeps,
+				ulGeneration
+				);
+	}
+
 	// cleanup DXL object
 	pimdobj->Release();
 
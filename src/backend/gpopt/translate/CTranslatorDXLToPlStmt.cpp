@@ -1253,8 +1253,9 @@ CTranslatorDXLToPlStmt::PplanFunctionScanFromDXLTVF
 
 	pplan->targetlist = plTargetList;
 
+	// the loop only calls wrappers, so they share the exception frame of a batch
 	ListCell *plcTe = NULL;
-
+	GP_WRAP_BATCH_START;
 	ForEach (plcTe, plTargetList)
 	{
 		TargetEntry *pte = (TargetEntry *) lfirst(plcTe);
@@ -1266,6 +1267,7 @@ CTranslatorDXLToPlStmt::PplanFunctionScanFromDXLTVF
 		pfuncscan->funccoltypes = gpdb::PlAppendOid(pfuncscan->funccoltypes, oidType);
 		pfuncscan->funccoltypmods = gpdb::PlAppendInt(pfuncscan->funccoltypmods, typMod);
 	}
+	GP_WRAP_BATCH_END;
 
 	SetParamIds(pplan);
 
@@ -3151,9 +3153,11 @@ CTranslatorDXLToPlStmt::PshscanFromDXLCTEProducer
 			&(pplanMat->plan_width)
 			);
 
-		// create a target list for the newly added materialize
+		// create a target list for the newly added materialize; the loop
+		// only calls wrappers, so they share the exception frame of a batch
 		ListCell *plcTe = NULL;
 		pplanMat->targetlist = NIL;
+		GP_WRAP_BATCH_START;
 		ForEach (plcTe, pplan->targetlist)
 		{
 			TargetEntry *pte = (TargetEntry *) lfirst(plcTe);
@@ -3168,6 +3172,7 @@ CTranslatorDXLToPlStmt::PshscanFromDXLCTEProducer
 			TargetEntry *pteNew = gpdb::PteMakeTargetEntry((Expr *) pvarNew, pvar->varattno, PStrDup(pte->resname), pte->resjunk);
 			pplanMat->targetlist = gpdb::PlAppendElement(pplanMat->targetlist, pteNew);
 		}
+		GP_WRAP_BATCH_END;
 
 		pplanMat->lefttree = pplanChild;
 		pplanMat->nMotionNodes = pplanChild->nMotionNodes;
@@ -3443,9 +3443,19 @@ CTranslatorRelcacheToDXL::PmdpartcnstrRelation
 	bool fhasIndex
 	)
 {
-	// get the part constraints
+	// get the part constraints, which are only used for the indexes, and
+	// are expensive to build with many partitions: without indexes, look up
+	// the default partitions only
 	List *plDefaultLevelsRel = NIL;
-	Node *pnode = gpdb::PnodePartConstraintRel(oidRel, &plDefaultLevelsRel);
+	Node *pnode = NULL;
+	if (fhasIndex)
+	{
+		pnode = gpdb::PnodePartConstraintRel(oidRel, &plDefaultLevelsRel);
+	}
+	else
+	{
+		plDefaultLevelsRel = gpdb::PlPartDefaultLevelsRel(oidRel);
+	}
 
 	// don't retrieve part constraints if there are no indices
 	// and no default partitions at any level
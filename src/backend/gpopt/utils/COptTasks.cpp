@@ -17,6 +17,7 @@
 #include "gpopt/utils/CConstExprEvaluatorProxy.h"
 #include "gpopt/utils/COptTasks.h"
 #include "gpopt/relcache/CMDProviderRelcache.h"
+#include "gpopt/relcache/CMDCacheInvalidator.h"
 #include "gpopt/config/CConfigParamMapping.h"
 #include "gpopt/translate/CTranslatorDXLToExpr.h"
 #include "gpopt/translate/CTranslatorExprToDXL.h"
@@ -948,30 +949,64 @@ COptTasks::PvOptimizeTask
 	AUTO_MEM_POOL(amp);
 	IMemoryPool *pmp = amp.Pmp();
 
-	// Does the metadatacache need to be reset?
+	// Does the metadatacache need to be reset, or which of its objects
+	// need to be evicted?
 	//
 	// On the first call, before the cache has been initialized, we
 	// don't care about the return value of FMDCacheNeedsReset(). But
 	// we need to call it anyway, to give it a chance to initialize
 	// the invalidation mechanism.
-	bool reset_mdcache = gpdb::FMDCacheNeedsReset();
+	List *plInvalidRelOids = NIL;
+	List *plInvalidCacheIds = NIL;
+	bool reset_mdcache = gpdb::FMDCacheNeedsReset(&plInvalidRelOids, &plInvalidCacheIds);
 
 	// initialize metadata cache, or purge if needed, or change size if requested
 	if (!CMDCache::FInitialized())
 	{
 		CMDCache::Init();
 		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
+		CMDCacheInvalidator::Reset();
 	}
-	else if (reset_mdcache)
+	else if (reset_mdcache || !CMDCacheInvalidator::FEvict(plInvalidRelOids, plInvalidCacheIds))
 	{
 		CMDCache::Reset();
 		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
+		CMDCacheInvalidator::Reset();
 	}
 	else if (CMDCache::ULLGetCacheQuota() != (ULLONG) optimizer_mdcache_size * 1024L)
 	{
 		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
 	}
 
+	// evict the cached plans along with the metadata they were optimized with
+	if (reset_mdcache)
+	{
+		gpdb::PlanCacheReset();
+	}
+	else
+	{
+		gpdb::PlanCacheInvalidate(plInvalidRelOids, plInvalidCacheIds);
+	}
+	gpdb::FreeList(plInvalidRelOids);
+	gpdb::FreeList(plInvalidCacheIds);
+
+	// reuse the plan of a query that differs only in its literals, if cached
+	OrcaPlanCacheProbe probe;
+	probe.key = NULL;
+	BOOL fPlanCache = 0 < optimizer_plan_cache_size && poctx->m_fGeneratePlStmt && !poctx->m_fSerializePlanDXL;
+	if (fPlanCache)
+	{
+		poctx->m_pplstmt = gpdb::PplstmtPlanCacheLookup((Query*) poctx->m_pquery, &probe);
+		if (NULL != poctx->m_pplstmt)
+		{
+			if (!optimizer_metadata_caching)
+			{
+				CMDCache::Shutdown();
+			}
+
+			return NULL;
+		}
+	}
 
 	// load search strategy
 	DrgPss *pdrgpss = PdrgPssLoad(pmp, optimizer_search_strategy_path);
@@ -1068,6 +1103,11 @@ COptTasks::PvOptimizeTask
 				// always use poctx->m_pquery->canSetTag as the ptrquerytodxl->Pquery() is a mutated Query object
 				// that may not have the correct canSetTag
 				poctx->m_pplstmt = (PlannedStmt *) gpdb::PvCopyObject(Pplstmt(pmp, &mda, pdxlnPlan, poctx->m_pquery->canSetTag));
+
+				if (fPlanCache)
+				{
+					gpdb::PlanCacheInsert(&probe, poctx->m_pplstmt);
+				}
 			}
 
 			CStatisticsConfig *pstatsconf = pocconf->Pstatsconf();
@@ -1531,30 +1571,37 @@ COptTasks::PvEvalExprFromDXLTask
 	CDXLNode *pdxlnResult = NULL;
 	BOOL fReleaseCache = false;
 
-	// Does the metadatacache need to be reset?
+	// Does the metadatacache need to be reset, or which of its objects
+	// need to be evicted?
 	//
 	// On the first call, before the cache has been initialized, we
 	// don't care about the return value of FMDCacheNeedsReset(). But
 	// we need to call it anyway, to give it a chance to initialize
 	// the invalidation mechanism.
-	bool reset_mdcache = gpdb::FMDCacheNeedsReset();
+	List *plInvalidRelOids = NIL;
+	List *plInvalidCacheIds = NIL;
+	bool reset_mdcache = gpdb::FMDCacheNeedsReset(&plInvalidRelOids, &plInvalidCacheIds);
 
 	// initialize metadata cache, or purge if needed, or change size if requested
 	if (!CMDCache::FInitialized())
 	{
 		CMDCache::Init();
 		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
+		CMDCacheInvalidator::Reset();
 		fReleaseCache = true;
 	}
-	else if (reset_mdcache)
+	else if (reset_mdcache || !CMDCacheInvalidator::FEvict(plInvalidRelOids, plInvalidCacheIds))
 	{
 		CMDCache::Reset();
 		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
+		CMDCacheInvalidator::Reset();
 	}
 	else if (CMDCache::ULLGetCacheQuota() != (ULLONG) optimizer_mdcache_size * 1024L)
 	{
 		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
 	}
+	gpdb::FreeList(plInvalidRelOids);
+	gpdb::FreeList(plInvalidCacheIds);
 
 	GPOS_TRY
 	{
@@ -0,0 +1,683 @@
+/*-------------------------------------------------------------------------
+ *
+ * orcaplancache.c
+ *	  plan cache of the ORCA query planner
+ *
+ * Repeated queries that differ only in their literals are optimized by ORCA
+ * from scratch every time. When optimizer_plan_cache_size > 0, each session
+ * keeps the plans ORCA has produced, keyed by the query with its literals
+ * stripped, and reuses a plan for a query with other literals by binding
+ * them in place of the ones the plan was optimized for.
+ *
+ * The key is the query tree, after constant folding, with every constant
+ * other than NULLs and booleans replaced by a NULL of the same type, along
+ * with the values of the settings the plan depends on, see plan_cache_gucs.
+ * The literals of the query are
+ * found back in the plan by their values. A plan is cached only if all the
+ * literals are distinct and each of them appears in the plan: a literal that
+ * does not has been used by the optimizer to derive something else, e.g. a
+ * contradiction, which does not hold for other values. Plans that are
+ * directly dispatched to a segment, chosen by the literals, are not cached.
+ *
+ * A constant of the plan could happen to have the value of a literal without
+ * coming from it. So a plan is first cached as a candidate, and only used once
+ * the query has been optimized again with literals that are all different,
+ * into the same plan: the same nodes, with the same constants in the places
+ * of the literals and everywhere else.
+ *
+ * After binding the literals, the partitions statically selected by the plan
+ * are selected again. Everything else in the plan, including its estimates,
+ * is left as is.
+ *
+ * The plans are evicted along with the ORCA metadata cache objects they have
+ * been optimized with: the plans of a relation when it is invalidated, and all
+ * of them on any other catalog change, statistics included.
+ *
+ * Portions Copyright (c) 2017-Present, Pivotal Software, Inc.
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/optimizer/plan/orcaplancache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/hash.h"
+#include "cdb/cdbllize.h"
+#include "cdb/cdbpartition.h"
+#include "cdb/cdbvars.h"
+#include "cdb/partitionselection.h"
+#include "lib/stringinfo.h"
+#include "nodes/makefuncs.h"
+#include "nodes/nodeFuncs.h"
+#include "optimizer/orcaplancache.h"
+#include "optimizer/walkers.h"
+#include "utils/datum.h"
+#include "utils/guc.h"
+#include "utils/guc_tables.h"
+#include "utils/hsearch.h"
+#include "utils/memutils.h"
+
+typedef struct OrcaPlanCacheEntry
+{
+	uint32		hashkey;		/* hash of the key, must be first */
+	MemoryContext context;		/* holds all of the entry but itself */
+	char	   *key;			/* normalized query */
+	List	   *literals;		/* Consts stripped from the query of the plan */
+	PlannedStmt *plan;
+	char	   *signature;		/* of the plan, see plan_signature() */
+	bool		validated;		/* confirmed by a second optimization? */
+	List	   *relids;			/* relations the plan depends on */
+	double		optimize_ms;	/* time it took to optimize the query */
+	uint64		lastused;
+} OrcaPlanCacheEntry;
+
+/*
+ * Settings the plans depend on, by name prefix: those of ORCA, the planner
+ * methods it is hinted with, and the planner settings read by ORCA or by the
+ * translation of its plans.
+ */
+static const char *const plan_cache_gucs[] = {
+	"optimizer",
+	"enable_",
+	"gp_segments_for_planner",
+	"work_mem",
+	"planner_work_mem",
+	"statement_mem"
+};
+
+/* Context of the walks of a plan */
+typedef struct plan_consts_context
+{
+	plan_tree_base_prefix base; /* Required prefix for plan_tree_walker */
+	List	   *literals;
+	List	   *consts;			/* Consts of the plan, each once */
+	List	   *selectors;		/* PartitionSelectors of the plan, each once */
+	bool		directDispatch; /* is any node directly dispatched? */
+	StringInfo	signature;		/* or NULL */
+} plan_consts_context;
+
+static HTAB *OrcaPlanCache = NULL;
+static MemoryContext OrcaPlanCacheContext = NULL;
+static uint64 OrcaPlanCacheClock = 0;
+
+/* has the plan of a partitioned table been cached? */
+static bool OrcaPlanCachePartitioned = false;
+
+/* statistics */
+static uint64 OrcaPlanCacheHits = 0;
+static uint64 OrcaPlanCacheMisses = 0;
+static double OrcaPlanCacheSavedMs = 0.0;
+
+static Node *strip_literals_mutator(Node *node, List **literals);
+static char *plan_cache_key(Query *query, List **literals);
+static int	literal_index(List *literals, Const *con);
+static bool plan_consts_walker(Node *node, plan_consts_context *context);
+static void walk_plan(PlannedStmt *plan, plan_consts_context *context);
+static void remove_entry(OrcaPlanCacheEntry *entry);
+static void log_plan_cache(const char *event);
+
+/*
+ * Replace the literals of an expression by NULLs of their types, and append
+ * them to *literals.
+ */
+static Node *
+strip_literals_mutator(Node *node, List **literals)
+{
+	if (node == NULL)
+		return NULL;
+
+	if (IsA(node, Const))
+	{
+		Const	   *con = (Const *) node;
+
+		if (con->constisnull || con->consttype == BOOLOID)
+			return (Node *) copyObject(con);
+
+		*literals = lappend(*literals, copyObject(con));
+		return (Node *) makeConst(con->consttype, con->consttypmod,
+								  con->constlen, (Datum) 0, true,
+								  con->constbyval);
+	}
+
+	if (IsA(node, Query))
+		return (Node *) query_tree_mutator((Query *) node,
+										   strip_literals_mutator,
+										   (void *) literals, 0);
+
+	return expression_tree_mutator(node, strip_literals_mutator,
+								   (void *) literals);
+}
+
+/*
+ * Key of a query in the plan cache, NULL if its plan is not to be cached.
+ * The literals stripped from the query are returned in *literals.
+ */
+static char *
+plan_cache_key(Query *query, List **literals)
+{
+	struct config_generic **gucs = get_guc_variables();
+	int			ngucs = GetNumConfigOptions();
+	Query	   *normalized;
+	StringInfoData key;
+	char	   *tree;
+	char	   *p;
+	int			i;
+
+	if (query->commandType != CMD_SELECT || query->utilityStmt != NULL ||
+		query->intoClause != NULL || query->rowMarks != NIL)
+		return NULL;
+
+	*literals = NIL;
+	normalized = query_tree_mutator(query, strip_literals_mutator,
+									(void *) literals, 0);
+
+	initStringInfo(&key);
+
+	/*
+	 * The token locations depend on the length of the literals in the query
+	 * text, leave them out.
+	 */
+	tree = nodeToString(normalized);
+	for (p = tree; *p; p++)
+	{
+		appendStringInfoChar(&key, *p);
+		if (strncmp(p, " :location ", 11) == 0)
+		{
+			appendStringInfoString(&key, ":location");
+			for (p += 11; p[1] == '-' || isdigit((unsigned char) p[1]); p++)
+				;
+		}
+	}
+	pfree(tree);
+
+	/* the settings the plan is optimized with */
+	appendStringInfo(&key, " :segments %d", getgpsegmentCount());
+	for (i = 0; i < ngucs; i++)
+	{
+		struct config_generic *gconf = gucs[i];
+		bool		depends = false;
+		int			j;
+
+		for (j = 0; j < lengthof(plan_cache_gucs); j++)
+		{
+			if (strncmp(gconf->name, plan_cache_gucs[j],
+						strlen(plan_cache_gucs[j])) == 0)
+			{
+				depends = true;
+				break;
+			}
+		}
+		if (!depends)
+			continue;
+
+		appendStringInfo(&key, " :%s ", gconf->name);
+		switch (gconf->vartype)
+		{
+			case PGC_BOOL:
+				appendStringInfo(&key, "%d", *((struct config_bool *) gconf)->variable);
+				break;
+			case PGC_INT:
+				appendStringInfo(&key, "%d", *((struct config_int *) gconf)->variable);
+				break;
+			case PGC_REAL:
+				appendStringInfo(&key, "%g", *((struct config_real *) gconf)->variable);
+				break;
+			case PGC_STRING:
+				appendStringInfoString(&key, *((struct config_string *) gconf)->variable ?
+									   *((struct config_string *) gconf)->variable : "");
+				break;
+			case PGC_ENUM:
+				appendStringInfo(&key, "%d", *((struct config_enum *) gconf)->variable);
+				break;
+		}
+	}
+
+	return key.data;
+}
+
+/*
+ * Position of the literal that has the value of a constant, -1 if none.
+ */
+static int
+literal_index(List *literals, Const *con)
+{
+	ListCell   *lc;
+	int			i = 0;
+
+	if (con->constisnull)
+		return -1;
+
+	foreach(lc, literals)
+	{
+		Const	   *literal = (Const *) lfirst(lc);
+
+		if (literal->consttype == con->consttype &&
+			datumIsEqual(literal->constvalue, con->constvalue,
+						 literal->constbyval, literal->constlen))
+			return i;
+		i++;
+	}
+
+	return -1;
+}
+
+/*
+ * Collect the constants and the partition selectors of a plan, and build its
+ * signature: the tags of its nodes, with the position of the literal whose
+ * value each constant has, or the constant itself.
+ */
+static bool
+plan_consts_walker(Node *node, plan_consts_context *context)
+{
+	if (node == NULL)
+		return false;
+
+	if (context->signature)
+		appendStringInfo(context->signature, " %d", (int) nodeTag(node));
+
+	if (IsA(node, Const))
+	{
+		Const	   *con = (Const *) node;
+
+		context->consts = list_append_unique_ptr(context->consts, con);
+		if (context->signature)
+		{
+			int			i = literal_index(context->literals, con);
+
+			if (i >= 0)
+				appendStringInfo(context->signature, " $%d", i);
+			else
+			{
+				char	   *str = nodeToString(con);
+
+				appendStringInfo(context->signature, " %s", str);
+				pfree(str);
+			}
+		}
+		return false;
+	}
+
+	if (is_plan_node(node) && ((Plan *) node)->directDispatch.isDirectDispatch)
+		context->directDispatch = true;
+
+	if (IsA(node, PartitionSelector))
+	{
+		context->selectors = list_append_unique_ptr(context->selectors, node);
+
+		/* not walked by plan_tree_walker() */
+		if (plan_consts_walker(((PartitionSelector *) node)->printablePredicate,
+							   context))
+			return true;
+	}
+
+	return plan_tree_walker(node, plan_consts_walker, context);
+}
+
+static void
+walk_plan(PlannedStmt *plan, plan_consts_context *context)
+{
+	exec_init_plan_tree_base(&context->base, plan);
+	plan_consts_walker((Node *) plan->planTree, context);
+}
+
+static void
+remove_entry(OrcaPlanCacheEntry *entry)
+{
+	MemoryContextDelete(entry->context);
+	hash_search(OrcaPlanCache, &entry->hashkey, HASH_REMOVE, NULL);
+}
+
+static void
+log_plan_cache(const char *event)
+{
+	if (!optimizer_print_optimization_stats)
+		return;
+
+	elog(LOG, "GPORCA plan cache %s: " UINT64_FORMAT " hits, " UINT64_FORMAT
+		 " misses, %.3f ms saved",
+		 event, OrcaPlanCacheHits, OrcaPlanCacheMisses, OrcaPlanCacheSavedMs);
+}
+
+/*
+ * OrcaPlanCacheLookup
+ *		Look up the plan of a query in the plan cache.
+ *
+ * Return the plan, with the literals of the query bound, or NULL if it is not
+ * cached. The probe is to be given to OrcaPlanCacheInsert() with the plan
+ * optimized for the query then.
+ */
+PlannedStmt *
+OrcaPlanCacheLookup(Query *query, OrcaPlanCacheProbe *probe)
+{
+	OrcaPlanCacheEntry *entry = NULL;
+	plan_consts_context context;
+	PlannedStmt *plan;
+	ListCell   *lc;
+	instr_time	endtime;
+	double		elapsed_ms;
+
+	INSTR_TIME_SET_CURRENT(probe->starttime);
+	probe->literals = NIL;
+	probe->key = plan_cache_key(query, &probe->literals);
+	if (probe->key == NULL)
+		return NULL;
+	probe->hashkey = DatumGetUInt32(hash_any((unsigned char *) probe->key,
+											 strlen(probe->key)));
+
+	if (OrcaPlanCache)
+		entry = (OrcaPlanCacheEntry *) hash_search(OrcaPlanCache,
+												   &probe->hashkey,
+												   HASH_FIND, NULL);
+	if (entry == NULL || !entry->validated || strcmp(entry->key, probe->key) != 0)
+	{
+		OrcaPlanCacheMisses++;
+		log_plan_cache("miss");
+		return NULL;
+	}
+
+	/* bind the literals of the query in place of those of the plan */
+	plan = (PlannedStmt *) copyObject(entry->plan);
+
+	MemSet(&context, 0, sizeof(context));
+	context.literals = entry->literals;
+	walk_plan(plan, &context);
+
+	foreach(lc, context.consts)
+	{
+		Const	   *con = (Const *) lfirst(lc);
+		int			i = literal_index(entry->literals, con);
+
+		if (i >= 0)
+		{
+			Const	   *literal = (Const *) list_nth(probe->literals, i);
+
+			con->constvalue = datumCopy(literal->constvalue,
+										literal->constbyval,
+										literal->constlen);
+		}
+	}
+
+	/* and select the partitions statically selected for the new literals */
+	foreach(lc, context.selectors)
+	{
+		PartitionSelector *ps = (PartitionSelector *) lfirst(lc);
+
+		if (ps->staticSelection)
+		{
+			SelectedParts *sp = static_part_selection(ps);
+
+			ps->staticPartOids = sp->partOids;
+			ps->staticScanIds = sp->scanIds;
+		}
+	}
+
+	entry->lastused = ++OrcaPlanCacheClock;
+
+	INSTR_TIME_SET_CURRENT(endtime);
+	INSTR_TIME_SUBTRACT(endtime, probe->starttime);
+	elapsed_ms = INSTR_TIME_GET_MILLISEC(endtime);
+
+	OrcaPlanCacheHits++;
+	if (entry->optimize_ms > elapsed_ms)
+		OrcaPlanCacheSavedMs += entry->optimize_ms - elapsed_ms;
+	log_plan_cache("hit");
+
+	return plan;
+}
+
+/*
+ * OrcaPlanCacheInsert
+ *		Add the plan optimized for a query looked up in the plan cache.
+ *
+ * The first plan of a query is a candidate. It is used once the query is
+ * optimized again, with other literals, into the same plan.
+ */
+void
+OrcaPlanCacheInsert(OrcaPlanCacheProbe *probe, PlannedStmt *plan)
+{
+	OrcaPlanCacheEntry *entry;
+	plan_consts_context context;
+	MemoryContext oldcontext;
+	StringInfoData signature;
+	instr_time	endtime;
+	ListCell   *lc;
+	ListCell   *lc2;
+	int			i;
+	bool		found;
+
+	if (probe->key == NULL || plan == NULL || optimizer_plan_cache_size <= 0)
+		return;
+
+	INSTR_TIME_SET_CURRENT(endtime);
+	INSTR_TIME_SUBTRACT(endtime, probe->starttime);
+
+	/* the literals must be distinct */
+	i = 0;
+	foreach(lc, probe->literals)
+	{
+		if (literal_index(probe->literals, (Const *) lfirst(lc)) != i++)
+			return;
+	}
+
+	/* and each of them must be in the plan */
+	initStringInfo(&signature);
+	MemSet(&context, 0, sizeof(context));
+	context.literals = probe->literals;
+	context.signature = &signature;
+	walk_plan(plan, &context);
+
+	if (context.directDispatch)
+		return;
+
+	for (i = 0; i < list_length(probe->literals); i++)
+	{
+		bool		inplan = false;
+
+		foreach(lc, context.consts)
+		{
+			if (literal_index(probe->literals, (Const *) lfirst(lc)) == i)
+			{
+				inplan = true;
+				break;
+			}
+		}
+		if (!inplan)
+			return;
+	}
+
+	if (OrcaPlanCache == NULL)
+	{
+		HASHCTL		ctl;
+
+		OrcaPlanCacheContext = AllocSetContextCreate(CacheMemoryContext,
+													 "ORCA plan cache",
+													 ALLOCSET_DEFAULT_MINSIZE,
+													 ALLOCSET_DEFAULT_INITSIZE,
+													 ALLOCSET_DEFAULT_MAXSIZE);
+
+		MemSet(&ctl, 0, sizeof(ctl));
+		ctl.keysize = sizeof(uint32);
+		ctl.entrysize = sizeof(OrcaPlanCacheEntry);
+		ctl.hash = tag_hash;
+		ctl.hcxt = OrcaPlanCacheContext;
+		OrcaPlanCache = hash_create("ORCA plan cache", 64, &ctl,
+									HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+	}
+
+	entry = (OrcaPlanCacheEntry *) hash_search(OrcaPlanCache, &probe->hashkey,
+											   HASH_FIND, NULL);
+	if (entry && strcmp(entry->key, probe->key) == 0)
+	{
+		bool		validated;
+
+		if (entry->validated)
+			return;
+
+		/*
+		 * The plan of the candidate is confirmed if the literals are all
+		 * different, else wait for other ones.
+		 */
+		forboth(lc, entry->literals, lc2, probe->literals)
+		{
+			Const	   *old = (Const *) lfirst(lc);
+			Const	   *literal = (Const *) lfirst(lc2);
+
+			if (old->consttype == literal->consttype &&
+				datumIsEqual(old->constvalue, literal->constvalue,
+							 old->constbyval, old->constlen))
+				return;
+		}
+		validated = (strcmp(entry->signature, signature.data) == 0);
+
+		/* replace the candidate by the plan just optimized */
+		remove_entry(entry);
+		entry = NULL;
+		if (!validated)
+			return;
+
+		found = false;
+		entry = (OrcaPlanCacheEntry *) hash_search(OrcaPlanCache, &probe->hashkey,
+												   HASH_ENTER, &found);
+		entry->validated = true;
+	}
+	else
+	{
+		/* a query whose key collides replaces the other one */
+		if (entry)
+			remove_entry(entry);
+
+		while (hash_get_num_entries(OrcaPlanCache) >= optimizer_plan_cache_size)
+		{
+			HASH_SEQ_STATUS status;
+			OrcaPlanCacheEntry *victim = NULL;
+			OrcaPlanCacheEntry *e;
+
+			hash_seq_init(&status, OrcaPlanCache);
+			while ((e = (OrcaPlanCacheEntry *) hash_seq_search(&status)) != NULL)
+			{
+				if (victim == NULL || e->lastused < victim->lastused)
+					victim = e;
+			}
+			remove_entry(victim);
+		}
+
+		entry = (OrcaPlanCacheEntry *) hash_search(OrcaPlanCache, &probe->hashkey,
+												   HASH_ENTER, &found);
+		entry->validated = (probe->literals == NIL);
+	}
+
+	entry->context = AllocSetContextCreate(OrcaPlanCacheContext,
+										   "ORCA plan cache entry",
+										   ALLOCSET_SMALL_MINSIZE,
+										   ALLOCSET_SMALL_INITSIZE,
+										   ALLOCSET_DEFAULT_MAXSIZE);
+	entry->optimize_ms = INSTR_TIME_GET_MILLISEC(endtime);
+	entry->lastused = ++OrcaPlanCacheClock;
+
+	oldcontext = MemoryContextSwitchTo(entry->context);
+
+	entry->key = pstrdup(probe->key);
+	entry->literals = (List *) copyObject(probe->literals);
+	entry->plan = (PlannedStmt *) copyObject(plan);
+	entry->signature = pstrdup(signature.data);
+	entry->relids = NIL;
+	foreach(lc, plan->rtable)
+	{
+		RangeTblEntry *rte = (RangeTblEntry *) lfirst(lc);
+
+		if (rte->rtekind != RTE_RELATION)
+			continue;
+
+		entry->relids = list_append_unique_oid(entry->relids, rte->relid);
+		if (rel_is_partitioned(rte->relid))
+			OrcaPlanCachePartitioned = true;
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+
+	pfree(signature.data);
+}
+
+/*
+ * OrcaPlanCacheInvalidate
+ *		Evict the plans affected by the invalidation of the given relations
+ *		and syscaches, those of the ORCA metadata cache.
+ *
+ * A syscache invalidation evicts all the plans. That of pg_statistic too: an
+ * ANALYZE that leaves pg_class as it was does not invalidate the relation.
+ */
+void
+OrcaPlanCacheInvalidate(List *relids, List *cacheids)
+{
+	HASH_SEQ_STATUS status;
+	OrcaPlanCacheEntry *entry;
+	List	   *evict = NIL;
+	ListCell   *lc;
+
+	if (OrcaPlanCache == NULL)
+		return;
+
+	if (optimizer_plan_cache_size <= 0)
+	{
+		OrcaPlanCacheReset();
+		return;
+	}
+
+	if (cacheids != NIL)
+	{
+		OrcaPlanCacheReset();
+		return;
+	}
+
+	foreach(lc, relids)
+	{
+		Oid			relid = lfirst_oid(lc);
+
+		evict = lappend_oid(evict, relid);
+
+		/* a partitioned table is planned along with its parts */
+		if (OrcaPlanCachePartitioned)
+		{
+			Oid			root = rel_partition_get_master(relid);
+
+			if (OidIsValid(root))
+				evict = lappend_oid(evict, root);
+		}
+	}
+
+	if (evict == NIL)
+		return;
+
+	hash_seq_init(&status, OrcaPlanCache);
+	while ((entry = (OrcaPlanCacheEntry *) hash_seq_search(&status)) != NULL)
+	{
+		foreach(lc, evict)
+		{
+			if (list_member_oid(entry->relids, lfirst_oid(lc)))
+			{
+				remove_entry(entry);
+				break;
+			}
+		}
+	}
+
+	list_free(evict);
+}
+
+/*
+ * OrcaPlanCacheReset
+ *		Evict all the plans.
+ */
+void
+OrcaPlanCacheReset(void)
+{
+	if (OrcaPlanCache == NULL)
+		return;
+
+	MemoryContextDelete(OrcaPlanCacheContext);
+	OrcaPlanCacheContext = NULL;
+	OrcaPlanCache = NULL;
+	OrcaPlanCachePartitioned = false;
+}
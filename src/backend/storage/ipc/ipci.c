@@ -58,6 +58,7 @@
 #include "utils/backend_cancel.h"
 #include "utils/resource_manager.h"
 #include "utils/faultinjector.h"
+#include "utils/optmdcache.h"
 #include "utils/sharedsnapshot.h"
 #include "utils/simex.h"
 
@@ -221,6 +222,7 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 		size = add_size(size, SyncScanShmemSize());
 		size = add_size(size, CheckpointerShmemSize());
 		size = add_size(size, CancelBackendMsgShmemSize());
+		size = add_size(size, OptMDCacheShmemSize());
 
 		size = add_size(size, WalSndShmemSize());
 		size = add_size(size, WalRcvShmemSize());
@@ -406,6 +408,7 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 	SyncScanShmemInit();
 	workfile_mgr_cache_init();
 	BackendCancelShmemInit();
+	OptMDCacheShmemInit();
 
 #ifdef EXEC_BACKEND
 
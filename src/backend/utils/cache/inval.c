@@ -165,10 +165,11 @@ static TransInvalidationInfo *transInvalInfo = NULL;
  */
 /*
  * MAX_SYSCACHE_CALLBACKS has been bumped up in GPDB, because ORCA registers
- * a lot of callbacks.
+ * a lot of callbacks. So has MAX_RELCACHE_CALLBACKS, because the metadata
+ * cache of ORCA and the partition info cache register one each.
  */
 #define MAX_SYSCACHE_CALLBACKS 40
-#define MAX_RELCACHE_CALLBACKS 5
+#define MAX_RELCACHE_CALLBACKS 10
 
 static struct SYSCACHECALLBACK
 {
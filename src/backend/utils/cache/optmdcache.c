@@ -0,0 +1,602 @@
+/*-------------------------------------------------------------------------
+ *
+ * optmdcache.c
+ *	  Metadata cache of the ORCA optimizer shared by all the sessions.
+ *
+ * Each session of the ORCA optimizer keeps the metadata objects it has
+ * translated from the catalog in a cache of its own. When this cache is
+ * enabled (optimizer_mdcache_shared_size > 0), the objects are also kept in
+ * shared memory, serialized in DXL, so that a session finds the objects
+ * already translated by the others.
+ *
+ * An object is keyed by its database and its mdid, and is stored along with
+ * its kind and the oids of the catalog objects it is translated from. The
+ * invalidation callbacks of the optimizer evict the objects of a relation
+ * invalidated right away, and all the objects of the kinds translated from a
+ * catalog table whose syscache is invalidated. Every backend processes every
+ * invalidation, but the objects are gone after the first one, so the others
+ * find nothing to evict: a hash of the oids the objects depend on tells at
+ * once if there is any object of a relation, and the number of objects of
+ * each kind if there is any of the kinds.
+ *
+ * An object translated while an invalidation is processed may have been
+ * translated from the catalog as it was before the change, so it is not added
+ * if the generation of the cache, bumped by every invalidation, has changed
+ * since the translation started. Nor are the objects translated by a
+ * transaction that may have changed the catalog: no other session sees its
+ * changes before it commits, and no invalidation is sent if it aborts.
+ *
+ * The serialized objects are allocated one after the other from a fixed
+ * area. Evicted objects leave holes, when the area is full, the whole cache
+ * is cleared.
+ *
+ * Portions Copyright (c) 2017-Present Pivotal Software, Inc.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/utils/cache/optmdcache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/transam.h"
+#include "access/xact.h"
+#include "miscadmin.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "storage/spin.h"
+#include "utils/hsearch.h"
+#include "utils/inval.h"
+#include "utils/optmdcache.h"
+#include "utils/syscache.h"
+
+/* Expected average size of an object, to size the hash tables */
+#define OPTMDCACHE_AVG_OBJECT_SIZE	2048
+
+/* An object takes no more than this fraction of the area */
+#define OPTMDCACHE_MAX_OBJECT_FRACTION	4
+
+typedef struct OptMDCacheObjectKey
+{
+	Oid			dbid;
+	char		mdid[OPTMDCACHE_KEY_LEN];
+} OptMDCacheObjectKey;
+
+typedef struct OptMDCacheObject
+{
+	OptMDCacheObjectKey key;	/* hash key, must be first */
+	Size		offset;			/* of the serialized object in the area */
+	Size		len;
+	OptMDCacheKind kind;
+	int			ndeps;
+	Oid			deps[OPTMDCACHE_MAX_DEPS];
+} OptMDCacheObject;
+
+typedef struct OptMDCacheDepKey
+{
+	Oid			dbid;
+	Oid			oid;
+} OptMDCacheDepKey;
+
+typedef struct OptMDCacheDep
+{
+	OptMDCacheDepKey key;		/* hash key, must be first */
+	int			nobjects;		/* objects depending on the oid */
+} OptMDCacheDep;
+
+typedef struct OptMDCacheHeader
+{
+	slock_t		mutex;			/* protects generation */
+	uint32		generation;		/* bumped by every invalidation */
+	Size		size;			/* of the area */
+	Size		used;			/* bytes of the area allocated */
+	int			nobjects[OPTMDCACHE_NUM_KINDS];	/* objects of each kind */
+} OptMDCacheHeader;
+
+/* GUC */
+int			optimizer_mdcache_shared_size = 0;
+
+static OptMDCacheHeader *OptMDCache = NULL;
+static HTAB *OptMDCacheObjects = NULL;
+static HTAB *OptMDCacheDeps = NULL;
+static char *OptMDCacheArea = NULL;
+
+static int	OptMDCacheMaxObjects(void);
+static uint32 OptMDCacheReadGeneration(void);
+static void OptMDCacheRemove(OptMDCacheObject *object);
+static void OptMDCacheClear(void);
+static void OptMDCacheBumpGeneration(void);
+
+/*
+ * OptMDCacheSyscacheKinds
+ *		Kinds of objects translated from the catalog table of a syscache, as a
+ *		mask of OPTMDCACHE_KIND_MASK().
+ */
+uint32
+OptMDCacheSyscacheKinds(int cacheid)
+{
+	switch (cacheid)
+	{
+		case AGGFNOID:
+			return OPTMDCACHE_KIND_MASK(OPTMDCACHE_KIND_AGG);
+
+		/* operator classes, used by the comparisons of types and by indexes */
+		case AMOPOPID:
+		case OPFAMILYOID:
+			return OPTMDCACHE_KIND_MASK(OPTMDCACHE_KIND_OP) |
+				OPTMDCACHE_KIND_MASK(OPTMDCACHE_KIND_SCCMP) |
+				OPTMDCACHE_KIND_MASK(OPTMDCACHE_KIND_TYPE) |
+				OPTMDCACHE_KIND_MASK(OPTMDCACHE_KIND_INDEX);
+
+		case OPEROID:
+			return OPTMDCACHE_KIND_MASK(OPTMDCACHE_KIND_OP) |
+				OPTMDCACHE_KIND_MASK(OPTMDCACHE_KIND_SCCMP) |
+				OPTMDCACHE_KIND_MASK(OPTMDCACHE_KIND_TYPE);
+
+		case CASTSOURCETARGET:
+			return OPTMDCACHE_KIND_MASK(OPTMDCACHE_KIND_CAST);
+
+		/*
+		 * Check constraints added or dropped also update relchecks of
+		 * pg_class, which invalidates the relation.
+		 */
+		case CONSTROID:
+			return OPTMDCACHE_KIND_MASK(OPTMDCACHE_KIND_CHECKCONSTRAINT);
+
+		/* part constraints and the indexes of partitioned tables */
+		case PARTOID:
+		case PARTRULEOID:
+			return OPTMDCACHE_KIND_MASK(OPTMDCACHE_KIND_REL) |
+				OPTMDCACHE_KIND_MASK(OPTMDCACHE_KIND_INDEX);
+
+		case STATRELATT:
+			return OPTMDCACHE_KIND_MASK(OPTMDCACHE_KIND_STATS);
+
+		case TYPEOID:
+			return OPTMDCACHE_KIND_MASK(OPTMDCACHE_KIND_TYPE) |
+				OPTMDCACHE_KIND_MASK(OPTMDCACHE_KIND_CAST) |
+				OPTMDCACHE_KIND_MASK(OPTMDCACHE_KIND_SCCMP);
+
+		case PROCOID:
+			return OPTMDCACHE_KIND_MASK(OPTMDCACHE_KIND_FUNC) |
+				OPTMDCACHE_KIND_MASK(OPTMDCACHE_KIND_AGG) |
+				OPTMDCACHE_KIND_MASK(OPTMDCACHE_KIND_OP) |
+				OPTMDCACHE_KIND_MASK(OPTMDCACHE_KIND_CAST) |
+				OPTMDCACHE_KIND_MASK(OPTMDCACHE_KIND_TRIGGER);
+
+		default:
+			/* unknown cache, invalidate everything */
+			return OPTMDCACHE_ALL_KINDS;
+	}
+}
+
+static int
+OptMDCacheMaxObjects(void)
+{
+	Size		size = (Size) optimizer_mdcache_shared_size * 1024L;
+
+	return (int) Max(size / OPTMDCACHE_AVG_OBJECT_SIZE, 64);
+}
+
+/*
+ * OptMDCacheShmemSize -- estimate the size of the shared metadata cache.
+ */
+Size
+OptMDCacheShmemSize(void)
+{
+	Size		size;
+
+	if (optimizer_mdcache_shared_size <= 0)
+		return 0;
+
+	size = MAXALIGN(sizeof(OptMDCacheHeader));
+	size = add_size(size, hash_estimate_size(OptMDCacheMaxObjects(),
+											 sizeof(OptMDCacheObject)));
+	size = add_size(size, hash_estimate_size(OptMDCacheMaxObjects() * OPTMDCACHE_MAX_DEPS,
+											 sizeof(OptMDCacheDep)));
+	size = add_size(size, mul_size(optimizer_mdcache_shared_size, 1024));
+
+	return size;
+}
+
+/*
+ * OptMDCacheShmemInit -- initialize the shared metadata cache, empty.
+ */
+void
+OptMDCacheShmemInit(void)
+{
+	HASHCTL		info;
+	bool		found;
+
+	if (optimizer_mdcache_shared_size <= 0)
+		return;
+
+	OptMDCache = (OptMDCacheHeader *)
+		ShmemInitStruct("Optimizer MD Cache", sizeof(OptMDCacheHeader), &found);
+	if (!found)
+	{
+		MemSet(OptMDCache, 0, sizeof(OptMDCacheHeader));
+		SpinLockInit(&OptMDCache->mutex);
+		OptMDCache->size = (Size) optimizer_mdcache_shared_size * 1024L;
+	}
+
+	MemSet(&info, 0, sizeof(info));
+	info.keysize = sizeof(OptMDCacheObjectKey);
+	info.entrysize = sizeof(OptMDCacheObject);
+	info.hash = tag_hash;
+	OptMDCacheObjects = ShmemInitHash("Optimizer MD Cache Objects",
+									  OptMDCacheMaxObjects(),
+									  OptMDCacheMaxObjects(),
+									  &info,
+									  HASH_ELEM | HASH_FUNCTION);
+
+	MemSet(&info, 0, sizeof(info));
+	info.keysize = sizeof(OptMDCacheDepKey);
+	info.entrysize = sizeof(OptMDCacheDep);
+	info.hash = tag_hash;
+	OptMDCacheDeps = ShmemInitHash("Optimizer MD Cache Dependencies",
+								   OptMDCacheMaxObjects() * OPTMDCACHE_MAX_DEPS,
+								   OptMDCacheMaxObjects() * OPTMDCACHE_MAX_DEPS,
+								   &info,
+								   HASH_ELEM | HASH_FUNCTION);
+
+	OptMDCacheArea = (char *)
+		ShmemInitStruct("Optimizer MD Cache Area",
+						(Size) optimizer_mdcache_shared_size * 1024L, &found);
+
+	if (!OptMDCacheObjects || !OptMDCacheDeps)
+		ereport(FATAL,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("not enough shared memory for optimizer metadata cache")));
+}
+
+/*
+ * OptMDCacheSharedEnabled -- is the shared metadata cache enabled?
+ */
+bool
+OptMDCacheSharedEnabled(void)
+{
+	return OptMDCache != NULL;
+}
+
+/*
+ * OptMDCacheSharedUsable
+ *		Can the current transaction look up and add objects?
+ *
+ * A transaction with an xid may have changed the catalog. The objects it
+ * translates may show changes that the other sessions do not see, and the
+ * objects the other sessions have translated do not show them.
+ */
+bool
+OptMDCacheSharedUsable(void)
+{
+	return OptMDCacheSharedEnabled() &&
+		!TransactionIdIsValid(GetTopTransactionIdIfAny());
+}
+
+static uint32
+OptMDCacheReadGeneration(void)
+{
+	/* use volatile pointer to prevent code rearrangement */
+	volatile OptMDCacheHeader *header = OptMDCache;
+	uint32		generation;
+
+	SpinLockAcquire(&header->mutex);
+	generation = header->generation;
+	SpinLockRelease(&header->mutex);
+
+	return generation;
+}
+
+/*
+ * OptMDCacheGeneration
+ *		Current generation of the cache, to be taken before translating an
+ *		object and passed to OptMDCacheInsert().
+ *
+ * The invalidations pending for this backend are processed once the
+ * generation is taken. Another session may have bumped the generation
+ * already for a change that the syscaches of this backend do not show yet,
+ * processing the change bumps it again.
+ */
+uint32
+OptMDCacheGeneration(void)
+{
+	uint32		generation;
+
+	if (!OptMDCacheSharedEnabled())
+		return 0;
+
+	generation = OptMDCacheReadGeneration();
+	AcceptInvalidationMessages();
+
+	return generation;
+}
+
+static void
+OptMDCacheBumpGeneration(void)
+{
+	/* use volatile pointer to prevent code rearrangement */
+	volatile OptMDCacheHeader *header = OptMDCache;
+
+	SpinLockAcquire(&header->mutex);
+	header->generation++;
+	SpinLockRelease(&header->mutex);
+}
+
+/*
+ * Remove an object. The caller must hold OptMDCacheLock exclusively.
+ */
+static void
+OptMDCacheRemove(OptMDCacheObject *object)
+{
+	int			i;
+
+	for (i = 0; i < object->ndeps; i++)
+	{
+		OptMDCacheDepKey depkey;
+		OptMDCacheDep *dep;
+
+		depkey.dbid = object->key.dbid;
+		depkey.oid = object->deps[i];
+		dep = (OptMDCacheDep *) hash_search(OptMDCacheDeps, &depkey, HASH_FIND, NULL);
+		if (dep && --dep->nobjects <= 0)
+			hash_search(OptMDCacheDeps, &depkey, HASH_REMOVE, NULL);
+	}
+
+	OptMDCache->nobjects[object->kind]--;
+	hash_search(OptMDCacheObjects, &object->key, HASH_REMOVE, NULL);
+}
+
+/*
+ * Remove all the objects, of all the databases. The caller must hold
+ * OptMDCacheLock exclusively.
+ */
+static void
+OptMDCacheClear(void)
+{
+	HASH_SEQ_STATUS status;
+	OptMDCacheObject *object;
+	OptMDCacheDep *dep;
+
+	hash_seq_init(&status, OptMDCacheObjects);
+	while ((object = (OptMDCacheObject *) hash_seq_search(&status)) != NULL)
+		hash_search(OptMDCacheObjects, &object->key, HASH_REMOVE, NULL);
+
+	hash_seq_init(&status, OptMDCacheDeps);
+	while ((dep = (OptMDCacheDep *) hash_seq_search(&status)) != NULL)
+		hash_search(OptMDCacheDeps, &dep->key, HASH_REMOVE, NULL);
+
+	MemSet(OptMDCache->nobjects, 0, sizeof(OptMDCache->nobjects));
+	OptMDCache->used = 0;
+}
+
+/*
+ * OptMDCacheLookup
+ *		Look up an object of the current database by its mdid.
+ *
+ * Return a palloc'd copy of the serialized object, along with its kind and the
+ * oids it depends on, or NULL if it is not in the cache or the current
+ * transaction cannot use the cache.
+ */
+char *
+OptMDCacheLookup(const char *key, Size *len, OptMDCacheKind *kind,
+				 Oid *deps, int *ndeps)
+{
+	OptMDCacheObjectKey objkey;
+	OptMDCacheObject *object;
+	char	   *data = NULL;
+
+	if (!OptMDCacheSharedUsable() || strlen(key) >= OPTMDCACHE_KEY_LEN)
+		return NULL;
+
+	MemSet(&objkey, 0, sizeof(objkey));
+	objkey.dbid = MyDatabaseId;
+	strcpy(objkey.mdid, key);
+
+	LWLockAcquire(OptMDCacheLock, LW_SHARED);
+
+	object = (OptMDCacheObject *) hash_search(OptMDCacheObjects, &objkey, HASH_FIND, NULL);
+	if (object)
+	{
+		data = palloc(object->len);
+		memcpy(data, OptMDCacheArea + object->offset, object->len);
+		*len = object->len;
+		*kind = object->kind;
+		*ndeps = object->ndeps;
+		memcpy(deps, object->deps, object->ndeps * sizeof(Oid));
+	}
+
+	LWLockRelease(OptMDCacheLock);
+
+	return data;
+}
+
+/*
+ * OptMDCacheInsert
+ *		Add an object of the current database, unless it is there already,
+ *		the cache has been invalidated since the given generation, or the
+ *		current transaction cannot use the cache.
+ */
+void
+OptMDCacheInsert(const char *key, const char *data, Size len,
+				 OptMDCacheKind kind, const Oid *deps, int ndeps,
+				 uint32 generation)
+{
+	OptMDCacheObjectKey objkey;
+	OptMDCacheObject *object;
+	bool		found;
+	int			i;
+
+	Assert(ndeps <= OPTMDCACHE_MAX_DEPS);
+
+	if (!OptMDCacheSharedUsable() || strlen(key) >= OPTMDCACHE_KEY_LEN ||
+		len > OptMDCache->size / OPTMDCACHE_MAX_OBJECT_FRACTION)
+		return;
+
+	MemSet(&objkey, 0, sizeof(objkey));
+	objkey.dbid = MyDatabaseId;
+	strcpy(objkey.mdid, key);
+
+	LWLockAcquire(OptMDCacheLock, LW_EXCLUSIVE);
+
+	/*
+	 * Invalidations bump the generation before they take the lock to evict,
+	 * so an invalidation either is seen here, or evicts the object after it
+	 * is added.
+	 */
+	if (OptMDCacheReadGeneration() != generation)
+	{
+		LWLockRelease(OptMDCacheLock);
+		return;
+	}
+
+	if (OptMDCache->used + MAXALIGN(len) > OptMDCache->size)
+		OptMDCacheClear();
+
+	object = (OptMDCacheObject *) hash_search(OptMDCacheObjects, &objkey, HASH_ENTER_NULL, &found);
+	if (!object || found)
+	{
+		/* the hash table is full, or another session has added the object */
+		LWLockRelease(OptMDCacheLock);
+		return;
+	}
+
+	object->offset = OptMDCache->used;
+	object->len = len;
+	object->kind = kind;
+	object->ndeps = 0;
+	OptMDCache->nobjects[kind]++;
+
+	for (i = 0; i < ndeps; i++)
+	{
+		OptMDCacheDepKey depkey;
+		OptMDCacheDep *dep;
+
+		depkey.dbid = MyDatabaseId;
+		depkey.oid = deps[i];
+		dep = (OptMDCacheDep *) hash_search(OptMDCacheDeps, &depkey, HASH_ENTER_NULL, &found);
+		if (!dep)
+		{
+			OptMDCacheRemove(object);
+			LWLockRelease(OptMDCacheLock);
+			return;
+		}
+		if (!found)
+			dep->nobjects = 0;
+		dep->nobjects++;
+		object->deps[object->ndeps++] = deps[i];
+	}
+
+	memcpy(OptMDCacheArea + object->offset, data, len);
+	OptMDCache->used += MAXALIGN(len);
+
+	LWLockRelease(OptMDCacheLock);
+}
+
+/*
+ * OptMDCacheInvalidateOid
+ *		Evict the objects of the current database depending on an oid.
+ *
+ * This is called by invalidation callbacks, it must not fail.
+ */
+void
+OptMDCacheInvalidateOid(Oid oid)
+{
+	OptMDCacheDepKey depkey;
+	HASH_SEQ_STATUS status;
+	OptMDCacheObject *object;
+	int			i;
+
+	if (!OptMDCacheSharedEnabled())
+		return;
+
+	OptMDCacheBumpGeneration();
+
+	depkey.dbid = MyDatabaseId;
+	depkey.oid = oid;
+
+	/* most of the time, there is no object of it */
+	LWLockAcquire(OptMDCacheLock, LW_SHARED);
+	if (!hash_search(OptMDCacheDeps, &depkey, HASH_FIND, NULL))
+	{
+		LWLockRelease(OptMDCacheLock);
+		return;
+	}
+	LWLockRelease(OptMDCacheLock);
+
+	LWLockAcquire(OptMDCacheLock, LW_EXCLUSIVE);
+
+	hash_seq_init(&status, OptMDCacheObjects);
+	while ((object = (OptMDCacheObject *) hash_seq_search(&status)) != NULL)
+	{
+		if (object->key.dbid != MyDatabaseId)
+			continue;
+
+		for (i = 0; i < object->ndeps; i++)
+		{
+			if (object->deps[i] == oid)
+			{
+				OptMDCacheRemove(object);
+				break;
+			}
+		}
+	}
+
+	LWLockRelease(OptMDCacheLock);
+}
+
+/*
+ * OptMDCacheInvalidateKinds
+ *		Evict the objects of the current database of the given kinds.
+ *
+ * This is called by invalidation callbacks, it must not fail.
+ */
+void
+OptMDCacheInvalidateKinds(uint32 kinds)
+{
+	HASH_SEQ_STATUS status;
+	OptMDCacheObject *object;
+	bool		any = false;
+	int			i;
+
+	if (!OptMDCacheSharedEnabled())
+		return;
+
+	OptMDCacheBumpGeneration();
+
+	LWLockAcquire(OptMDCacheLock, LW_SHARED);
+	for (i = 0; i < OPTMDCACHE_NUM_KINDS; i++)
+	{
+		if ((kinds & OPTMDCACHE_KIND_MASK(i)) && OptMDCache->nobjects[i] > 0)
+			any = true;
+	}
+	LWLockRelease(OptMDCacheLock);
+
+	if (!any)
+		return;
+
+	LWLockAcquire(OptMDCacheLock, LW_EXCLUSIVE);
+
+	hash_seq_init(&status, OptMDCacheObjects);
+	while ((object = (OptMDCacheObject *) hash_seq_search(&status)) != NULL)
+	{
+		if (object->key.dbid == MyDatabaseId &&
+			(kinds & OPTMDCACHE_KIND_MASK(object->kind)))
+			OptMDCacheRemove(object);
+	}
+
+	LWLockRelease(OptMDCacheLock);
+}
+
+/*
+ * OptMDCacheInvalidateAll
+ *		Evict all the objects of the current database.
+ *
+ * This is called by invalidation callbacks, it must not fail.
+ */
+void
+OptMDCacheInvalidateAll(void)
+{
+	OptMDCacheInvalidateKinds(OPTMDCACHE_ALL_KINDS);
+}
@@ -42,6 +42,7 @@
 #include "utils/builtins.h"
 #include "utils/guc_tables.h"
 #include "utils/inval.h"
+#include "utils/optmdcache.h"
 #include "utils/resscheduler.h"
 #include "utils/resgroup.h"
 #include "utils/resource_manager.h"
@@ -430,6 +431,7 @@ bool		optimizer_minidump;
 int			optimizer_cost_model;
 bool		optimizer_metadata_caching;
 int			optimizer_mdcache_size;
+int			optimizer_plan_cache_size;
 bool		optimizer_use_gpdb_allocators;
 
 /* Optimizer debugging GUCs */
@@ -537,8 +539,16 @@ bool		codegen_exec_variable_list;
 bool		codegen_slot_getattr;
 bool		codegen_exec_eval_expr;
 bool		codegen_advance_aggregate;
+bool		codegen_advance_aggregates_batch;
+bool		codegen_exec_hash_get_hash_value;
+bool		codegen_calc_hash_value;
+bool		codegen_tupsort_compare_datum;
+bool		codegen_async_compile;
 int		codegen_varlen_tolerance;
+int		codegen_module_cache_size;
+int		codegen_max_parameter_regenerations;
 int		codegen_optimization_level;
+double		codegen_cost_threshold;
 
 /* System Information */
 static int	gp_server_version_num;
@@ -3347,6 +3357,71 @@ struct config_bool ConfigureNamesBool_gp[] =
 #endif
 		assign_codegen, NULL
 	},
+	{
+		{"codegen_advance_aggregates_batch", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Collect the input of plain aggregation into batches and advance the aggregates with generated loops over each batch."),
+			NULL,
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&codegen_advance_aggregates_batch,
+#ifdef USE_CODEGEN
+		true,
+#else
+		false,
+#endif
+		assign_codegen, NULL
+	},
+	{
+		{"codegen_exec_hash_get_hash_value", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Enable codegen for ExecHashGetHashValue"),
+			NULL,
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&codegen_exec_hash_get_hash_value,
+#ifdef USE_CODEGEN
+		true,
+#else
+		false,
+#endif
+		assign_codegen, NULL
+	},
+	{
+		{"codegen_calc_hash_value", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Enable codegen for hash aggregation's calc_hash_value"),
+			NULL,
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&codegen_calc_hash_value,
+#ifdef USE_CODEGEN
+		true,
+#else
+		false,
+#endif
+		assign_codegen, NULL
+	},
+	{
+		{"codegen_tupsort_compare_datum", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Enable codegen for the sort key comparison of MK sort and sorted Motion"),
+			NULL,
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&codegen_tupsort_compare_datum,
+#ifdef USE_CODEGEN
+		true,
+#else
+		false,
+#endif
+		assign_codegen, NULL
+	},
+	{
+		{"codegen_async_compile", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Compile generated code in a background thread while the plan starts executing with the regular functions."),
+			NULL,
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&codegen_async_compile,
+		false, assign_codegen, NULL
+	},
 	{
 		{"vmem_process_interrupt", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Checks for interrupts before reserving VMEM"),
@@ -4705,6 +4780,27 @@ struct config_int ConfigureNamesInt_gp[] =
 		16384, 0, INT_MAX, NULL, NULL
 	},
 
+	{
+		{"optimizer_mdcache_shared_size", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the MDCache shared by all the sessions."),
+			gettext_noop("Zero disables sharing the MDCache."),
+			GUC_UNIT_KB
+		},
+		&optimizer_mdcache_shared_size,
+		0, 0, INT_MAX / 1024, NULL, NULL
+	},
+
+	{
+		{"optimizer_plan_cache_size", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Sets the number of plans the GPORCA optimizer caches per session."),
+			gettext_noop("The plans are reused for queries that differ only in their constants. "
+						 "Zero disables the plan cache."),
+			GUC_GPDB_ADDOPT
+		},
+		&optimizer_plan_cache_size,
+		0, 0, INT_MAX, NULL, NULL
+	},
+
 	{
 		{"memory_profiler_dataset_size", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Set the size in GB"),
@@ -4780,6 +4876,31 @@ struct config_int ConfigureNamesInt_gp[] =
 		0, INT_MAX, NULL, NULL
 	},
 
+	{
+		{"codegen_module_cache_size", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Sets the maximum number of compiled code generation modules cached for reuse by later queries of the session."),
+			gettext_noop("Zero disables the cache."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&codegen_module_cache_size,
+		0, 0, INT_MAX, NULL, NULL
+	},
+
+	{
+		{"codegen_max_parameter_regenerations", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Sets the maximum number of times a plan node regenerates parameter dependent code before falling back to the regular functions."),
+			gettext_noop("Zero reverts to the regular functions on the first parameter change."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&codegen_max_parameter_regenerations,
+#ifdef USE_CODEGEN
+		8,
+#else
+		0,
+#endif
+		0, INT_MAX, NULL, NULL
+	},
+
 	{
 		{"dtx_phase2_retry_count", PGC_SUSET, DEVELOPER_OPTIONS,
 			gettext_noop("Maximum number of retries during two phase commit after which master PANICs."),
@@ -4819,6 +4940,16 @@ struct config_real ConfigureNamesReal_gp[] =
 		DEFAULT_CURSOR_TUPLE_FRACTION, 0.0, 1.0, NULL, NULL
 	},
 
+	{
+		{"codegen_cost_threshold", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Sets the minimum estimated cost of evaluating a plan node's expressions for which code is generated."),
+			gettext_noop("The cost is the estimated number of rows times the number of expression nodes of the plan node. Zero generates code regardless of cost."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&codegen_cost_threshold,
+		0.0, 0.0, DBL_MAX, NULL, NULL
+	},
+
 	{
 		{"gp_workfile_limit_per_segment", PGC_POSTMASTER, RESOURCES,
 			gettext_noop("Maximum disk space (in KB) used for workfiles per segment."),
@@ -682,6 +682,7 @@ create_mksort_context(
 
 	mkctxt->cpfr = tupsort_cpfr;
 	mkctxt->freeTup = freeTupleFn;
+	mkctxt->compareDatum = tupsort_compare_datum;
 	mkctxt->estimatedExtraForPrep = 0;
 
 	lc_guess_strxfrm_scaling_factor(&mkctxt->strxfrmScaleFactor, &mkctxt->strxfrmConstantFactor);
@@ -3677,4 +3678,19 @@ tuplesort_set_gpmon_mk(Tuplesortstate_mk *state, gpmon_packet_t *gpmon_pkt, int
 	state->gpmon_sort_tick = gpmon_tick;
 }
 
+/*
+ * tuplesort_set_compare_datum_mk
+ *
+ * Install a comparator for the prepared datums of the sort keys, typically
+ * one generated for the keys the sort was started with.  Must be called
+ * before the first tuple is put into the sort.
+ */
+void
+tuplesort_set_compare_datum_mk(Tuplesortstate_mk *state, TupsortCompareDatumFn compare_fn)
+{
+	Assert(compare_fn);
+	Assert(state->totalNumTuples == 0);
+	state->mkctxt.compareDatum = compare_fn;
+}
+
 /* EOF */
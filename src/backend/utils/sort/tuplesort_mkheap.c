@@ -164,7 +164,7 @@ mkheap_compare(MKHeap *heap, MKEntry *a, MKEntry *b)
 
 			Assert(lv < heap->mkctxt->total_lv);
 			Assert(lv == mke_get_lv(b));
-			ret = tupsort_compare_datum(a, b, heap->mkctxt->lvctxt + lv, heap->mkctxt);
+			ret = heap->mkctxt->compareDatum(a, b, heap->mkctxt->lvctxt + lv, heap->mkctxt);
 		}
 
 		/*
@@ -51,7 +51,7 @@ static inline int32 mkqs_comp(MKEntry *a, MKEntry *b, MKLvContext *ctxt, MKConte
 	int ret = a->compflags - b->compflags;
 
 	if (ret == 0 && !mke_is_null(a))
-		ret = tupsort_compare_datum(a, b, ctxt, mkctxt);
+		ret = mkctxt->compareDatum(a, b, ctxt, mkctxt);
 
 	return ret;
 }
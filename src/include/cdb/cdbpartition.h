@@ -118,6 +118,12 @@ all_partition_relids(PartitionNode *pn);
 extern Node *
 get_relation_part_constraints(Oid rootOid, List **defaultLevels);
 
+extern Node *
+get_relation_part_constraints_cached(Oid rootOid, List **defaultLevels);
+
+extern List *
+get_relation_part_default_levels(Oid rootOid);
+
 extern List *
 all_prule_relids(PartitionRule *prule);
 
@@ -229,6 +235,10 @@ extern void RemovePartitionEncodingByRelidAttribute(Oid relid, AttrNumber attnum
 extern Datum *get_partition_encoding_attoptions(Relation rel, Oid paroid);
 
 extern LogicalIndexes * BuildLogicalIndexInfo(Oid relid);
+extern LogicalIndexes * GetLogicalIndexInfo(Oid rootOid);
+extern int countLeafPartTables_cached(Oid rootOid);
+extern bool has_parquet_children_cached(Oid rootOid);
+extern bool child_distribution_mismatch_cached(Relation rel);
 extern Oid getPhysicalIndexRelid(Relation partRel, LogicalIndexInfo *iInfo);
 
 extern LogicalIndexInfo *logicalIndexInfoForIndexOid(Oid rootOid, Oid indexOid);
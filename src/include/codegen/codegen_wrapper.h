@@ -33,7 +33,14 @@ struct ExprState;
 struct PlanState;
 struct AggState;
 struct MemoryManagerContainer;
+struct AggStatePerAggData;
 struct AggStatePerGroupData;
+struct HashState;
+struct HashJoinTableData;
+struct List;
+struct MKEntry;
+struct MKLvContext;
+struct MKContext;
 /*
  * Enum used to mimic ExprDoneCond in ExecEvalExpr function pointer.
  */
@@ -42,9 +49,23 @@ typedef enum tmp_enum{
 }tmp_enum;
 
 typedef void (*AdvanceAggregatesFn) (struct AggState *aggstate, /*struct AggStatePerGroup*/struct AggStatePerGroupData *pergroup, struct MemoryManagerContainer *mem_manager);
+typedef void (*AdvanceAggregatesBatchFn) (struct AggState *aggstate, /*struct AggStatePerGroup*/struct AggStatePerGroupData *pergroup, Datum *values, bool *isnull, int nrows);
 typedef void (*ExecVariableListFn) (struct ProjectionInfo *projInfo, Datum *values, bool *isnull);
 typedef Datum (*ExecEvalExprFn) (struct ExprState *expression, struct ExprContext *econtext, bool *isNull, /*ExprDoneCond*/ tmp_enum *isDone);
 typedef Datum (*SlotGetAttrFn) (struct TupleTableSlot *slot, int attnum, bool *isnull);
+typedef bool (*ExecHashGetHashValueFn) (struct HashState *hashState, /*HashJoinTable*/ struct HashJoinTableData *hashtable, struct ExprContext *econtext, struct List *hashkeys, bool outer_tuple, bool keep_nulls, uint32 *hashvalue, bool *hashkeys_null);
+typedef uint32 (*CalcHashValueFn) (struct AggState *aggstate, struct TupleTableSlot *inputslot);
+typedef int32 (*TupsortCompareDatumFn) (struct MKEntry *v1, struct MKEntry *v2, struct MKLvContext *lvctxt, struct MKContext *mkctxt);
+
+/*
+ * Time, in milliseconds, that a code generator manager spent on the code of
+ * its plan node. Reported by EXPLAIN ANALYZE.
+ */
+typedef struct CodegenTimes
+{
+	double		generate;		/* building LLVM IR in the generators */
+	double		compile;		/* compiling the IR to machine code */
+} CodegenTimes;
 
 #ifndef USE_CODEGEN
 
@@ -53,8 +74,11 @@ typedef Datum (*SlotGetAttrFn) (struct TupleTableSlot *slot, int attnum, bool *i
 #define CodeGeneratorManagerGenerateCode(manager) ((unsigned int) 1)
 #define CodeGeneratorManagerPrepareGeneratedFunctions(manager) ((unsigned int) 1)
 #define CodeGeneratorManagerNotifyParameterChange(manager) ((unsigned int) 1)
+#define CodeGeneratorManagerSwapInCompiledFunctions(manager) ((unsigned int) 0)
+#define CodeGeneratorManagerCompilationPending() (false)
 #define CodeGeneratorManagerAccumulateExplainString(manager) ((void) 1)
 #define CodeGeneratorManagerGetExplainString(manager) ((char *) NULL)
+#define CodeGeneratorManagerGetTimes(manager, times) ((void) 1)
 #define CodeGeneratorManagerDestroy(manager) ((void) 1)
 #define GetActiveCodeGeneratorManager() ((void *) NULL)
 #define SetActiveCodeGeneratorManager(manager) ((void) 1)
@@ -67,6 +91,14 @@ typedef Datum (*SlotGetAttrFn) (struct TupleTableSlot *slot, int attnum, bool *i
 #define enroll_ExecVariableList_codegen(regular_func, ptr_to_chosen_func, proj_info, slot)
 #define call_AdvanceAggregates(aggstate, pergroup, mem_manager) advance_aggregates(aggstate, pergroup, mem_manager)
 #define enroll_AdvanceAggregates_codegen(regular_func, ptr_to_chosen_func, aggstate)
+#define call_AdvanceAggregatesBatch(aggstate, pergroup, values, isnull, nrows) advance_aggregates_batch(aggstate, pergroup, values, isnull, nrows)
+#define enroll_AdvanceAggregatesBatch_codegen(regular_func, ptr_to_chosen_func, aggstate)
+#define call_ExecHashGetHashValue(gen_info_holder, hashState, hashtable, econtext, hashkeys, outer_tuple, keep_nulls, hashvalue, hashkeys_null) \
+		ExecHashGetHashValue(hashState, hashtable, econtext, hashkeys, outer_tuple, keep_nulls, hashvalue, hashkeys_null)
+#define enroll_ExecHashGetHashValue_codegen(regular_func, ptr_to_chosen_func, gen_info_holder, hashkeys, hash_operators, outer_tuple)
+#define call_calc_hash_value(aggstate, inputslot) calc_hash_value(aggstate, inputslot)
+#define enroll_calc_hash_value_codegen(regular_func, ptr_to_chosen_func, aggstate)
+#define enroll_tupsort_compare_datum_codegen(regular_func, ptr_to_chosen_func, gen_info_holder, nkeys, sort_operators)
 #else
 
 /*
@@ -130,6 +162,23 @@ CodeGeneratorManagerPrepareGeneratedFunctions(void* manager);
 unsigned int
 CodeGeneratorManagerNotifyParameterChange(void* manager);
 
+/*
+ * Switches to the functions compiled in the background if their compilation
+ * has finished. Returns number of newly used generated functions
+ */
+unsigned int
+CodeGeneratorManagerSwapInCompiledFunctions(void* manager);
+
+/*
+ * true while a background compilation of the backend has not been swapped in
+ * yet. Lets the executor skip calling
+ * CodeGeneratorManagerSwapInCompiledFunctions() for every tuple when there is
+ * nothing to swap in
+ */
+extern bool codegen_compilation_pending;
+
+#define CodeGeneratorManagerCompilationPending() (codegen_compilation_pending)
+
 /*
  * Destroys a manager for an operator
  */
@@ -149,6 +198,12 @@ CodeGeneratorManagerAccumulateExplainString(void* manager);
 char*
 CodeGeneratorManagerGetExplainString(void* manager);
 
+/*
+ * Fill in the time the manager spent generating and compiling code so far
+ */
+void
+CodeGeneratorManagerGetTimes(void* manager, CodegenTimes* times);
+
 /*
  * Get the active code generator manager
  */
@@ -212,6 +267,41 @@ AdvanceAggregatesCodegenEnroll(AdvanceAggregatesFn regular_func_ptr,
 		AdvanceAggregatesFn* ptr_to_regular_func_ptr,
 		struct AggState *aggstate);
 
+/*
+ * Enroll and returns the pointer to AdvanceAggregatesBatchGenerator
+ */
+void*
+AdvanceAggregatesBatchCodegenEnroll(AdvanceAggregatesBatchFn regular_func_ptr,
+		AdvanceAggregatesBatchFn* ptr_to_regular_func_ptr,
+		struct AggState *aggstate);
+
+/*
+ * Enroll and returns the pointer to ExecHashGetHashValueGenerator
+ */
+void*
+ExecHashGetHashValueCodegenEnroll(ExecHashGetHashValueFn regular_func_ptr,
+		ExecHashGetHashValueFn* ptr_to_regular_func_ptr,
+		struct List *hashkeys,
+		struct List *hash_operators,
+		bool outer_tuple);
+
+/*
+ * Enroll and returns the pointer to CalcHashValueGenerator
+ */
+void*
+CalcHashValueCodegenEnroll(CalcHashValueFn regular_func_ptr,
+		CalcHashValueFn* ptr_to_regular_func_ptr,
+		struct AggState *aggstate);
+
+/*
+ * Enroll and returns the pointer to TupsortCompareDatumGenerator
+ */
+void*
+TupsortCompareDatumCodegenEnroll(TupsortCompareDatumFn regular_func_ptr,
+		TupsortCompareDatumFn* ptr_to_regular_func_ptr,
+		int nkeys,
+		Oid *sort_operators);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -269,6 +359,28 @@ AdvanceAggregatesCodegenEnroll(AdvanceAggregatesFn regular_func_ptr,
 #define call_AdvanceAggregates(aggstate, pergroup, mem_manager) \
 		aggstate->AdvanceAggregates_gen_info.AdvanceAggregates_fn(aggstate, pergroup, mem_manager)
 
+/*
+ * Call AdvanceAggregatesBatch using function pointer AdvanceAggregatesBatch_fn.
+ * Function pointer may point to regular version or generated function
+ */
+#define call_AdvanceAggregatesBatch(aggstate, pergroup, values, isnull, nrows) \
+		aggstate->AdvanceAggregatesBatch_gen_info.AdvanceAggregatesBatch_fn(aggstate, pergroup, values, isnull, nrows)
+
+/*
+ * Call ExecHashGetHashValue using function pointer ExecHashGetHashValue_fn of
+ * gen_info_holder, which is either the HashState or the HashJoinState.
+ * Function pointer may point to regular version or generated function
+ */
+#define call_ExecHashGetHashValue(gen_info_holder, hashState, hashtable, econtext, hashkeys, outer_tuple, keep_nulls, hashvalue, hashkeys_null) \
+		gen_info_holder->ExecHashGetHashValue_gen_info.ExecHashGetHashValue_fn(hashState, hashtable, econtext, hashkeys, outer_tuple, keep_nulls, hashvalue, hashkeys_null)
+
+/*
+ * Call calc_hash_value using function pointer calc_hash_value_fn.
+ * Function pointer may point to regular version or generated function
+ */
+#define call_calc_hash_value(aggstate, inputslot) \
+		aggstate->calc_hash_value_gen_info.calc_hash_value_fn(aggstate, inputslot)
+
 /*
  * Enrollment macros
  * The enrollment process also ensures that the generated function pointer
@@ -289,6 +401,26 @@ AdvanceAggregatesCodegenEnroll(AdvanceAggregatesFn regular_func_ptr,
 				regular_func, ptr_to_regular_func_ptr, aggstate); \
 				Assert(aggstate->AdvanceAggregates_gen_info.AdvanceAggregates_fn == regular_func); \
 
+#define enroll_AdvanceAggregatesBatch_codegen(regular_func, ptr_to_regular_func_ptr, aggstate) \
+		aggstate->AdvanceAggregatesBatch_gen_info.code_generator = AdvanceAggregatesBatchCodegenEnroll( \
+				regular_func, ptr_to_regular_func_ptr, aggstate); \
+				Assert(aggstate->AdvanceAggregatesBatch_gen_info.AdvanceAggregatesBatch_fn == regular_func); \
+
+#define enroll_ExecHashGetHashValue_codegen(regular_func, ptr_to_regular_func_ptr, gen_info_holder, hashkeys, hash_operators, outer_tuple) \
+		gen_info_holder->ExecHashGetHashValue_gen_info.code_generator = ExecHashGetHashValueCodegenEnroll( \
+				regular_func, ptr_to_regular_func_ptr, hashkeys, hash_operators, outer_tuple); \
+				Assert(gen_info_holder->ExecHashGetHashValue_gen_info.ExecHashGetHashValue_fn == regular_func); \
+
+#define enroll_calc_hash_value_codegen(regular_func, ptr_to_regular_func_ptr, aggstate) \
+		aggstate->calc_hash_value_gen_info.code_generator = CalcHashValueCodegenEnroll( \
+				regular_func, ptr_to_regular_func_ptr, aggstate); \
+				Assert(aggstate->calc_hash_value_gen_info.calc_hash_value_fn == regular_func); \
+
+#define enroll_tupsort_compare_datum_codegen(regular_func, ptr_to_regular_func_ptr, gen_info_holder, nkeys, sort_operators) \
+		gen_info_holder->tupsort_compare_datum_gen_info.code_generator = TupsortCompareDatumCodegenEnroll( \
+				regular_func, ptr_to_regular_func_ptr, nkeys, sort_operators); \
+				Assert(gen_info_holder->tupsort_compare_datum_gen_info.tupsort_compare_datum_fn == regular_func); \
+
 #endif //USE_CODEGEN
 
 #endif  // CODEGEN_WRAPPER_H_
@@ -216,6 +216,7 @@ typedef struct HashAggTable
 } HashAggTable;
 
 extern HashAggTable *create_agg_hash_table(AggState *aggstate);
+extern uint32 calc_hash_value(AggState* aggstate, TupleTableSlot *inputslot);
 extern bool agg_hash_initial_pass(AggState *aggstate);
 extern bool agg_hash_stream(AggState *aggstate);
 extern bool agg_hash_next_pass(AggState *aggstate);
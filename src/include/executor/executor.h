@@ -313,6 +313,8 @@ extern bool ExecTargetList(List *targetlist, ExprContext *econtext, Datum *value
 extern int	ExecCleanTargetListLength(List *targetlist);
 extern TupleTableSlot *ExecProject(ProjectionInfo *projInfo,
 			ExprDoneCond *isDone);
+extern void ExecVariableList(ProjectionInfo *projInfo, Datum *values,
+			bool *isnull);
 extern Datum ExecEvalFunctionArgToConst(FuncExpr *fexpr, int argno, bool *isnull);
 extern void GetNeededColumnsForScan(Node *expr, bool *mask, int n);
 extern bool isJoinExprNull(List *joinExpr, ExprContext *econtext);
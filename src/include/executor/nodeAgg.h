@@ -177,6 +177,18 @@ initialize_aggregates(AggState *aggstate,
 extern void 
 advance_aggregates(AggState *aggstate, AggStatePerGroup pergroup,
 				   MemoryManagerContainer *mem_manager);
+extern void
+advance_aggregate_row(AggState *aggstate, int aggno,
+					  AggStatePerGroup pergroupstate,
+					  Datum *values, bool *isnull, int nvalues,
+					  MemoryManagerContainer *mem_manager);
+extern void
+advance_aggregate_batch(AggState *aggstate, int aggno,
+						AggStatePerGroup pergroupstate,
+						Datum *values, bool *isnull, int nrows);
+extern void
+advance_aggregates_batch(AggState *aggstate, AggStatePerGroup pergroup,
+						 Datum *values, bool *isnull, int nrows);
 
 extern Oid resolve_polymorphic_transtype(Oid aggtranstype, Oid aggfnoid,
 										 Oid *inputTypes);
@@ -18,8 +18,12 @@
 #include "postgres.h"
 #include "access/attnum.h"
 #include "utils/faultinjector.h"
+#include "utils/optmdcache.h"
 #include "parser/parse_coerce.h"
 
+#include "gpos/error/CAutoExceptionStack.h"
+#include "naucrates/exception.h"
+
 // fwd declarations
 typedef struct SysScanDescData *SysScanDesc;
 typedef int LOCKMODE;
@@ -53,83 +57,85 @@ struct Motion;
 struct Var;
 struct Const;
 struct ArrayExpr;
+struct PlannedStmt;
+struct OrcaPlanCacheProbe;
 
 namespace gpdb {
 
 	// convert datum to bool
-	bool FBoolFromDatum(Datum d);
+	inline bool FBoolFromDatum(Datum d);
 
 	// convert bool to datum
-	Datum DDatumFromBool(bool b);
+	inline Datum DDatumFromBool(bool b);
 
 	// convert datum to char
-	char CCharFromDatum(Datum d);
+	inline char CCharFromDatum(Datum d);
 
 	// convert char to datum
-	Datum DDatumFromChar(char c);
+	inline Datum DDatumFromChar(char c);
 
 	// convert datum to int8
-	int8 CInt8FromDatum(Datum d);
+	inline int8 CInt8FromDatum(Datum d);
 
 	// convert int8 to datum
-	Datum DDatumFromInt8(int8 i8);
+	inline Datum DDatumFromInt8(int8 i8);
 
 	// convert datum to uint8
-	uint8 UcUint8FromDatum(Datum d);
+	inline uint8 UcUint8FromDatum(Datum d);
 
 	// convert uint8 to datum
-	Datum DDatumFromUint8(uint8 ui8);
+	inline Datum DDatumFromUint8(uint8 ui8);
 
 	// convert datum to int16
-	int16 SInt16FromDatum(Datum d);
+	inline int16 SInt16FromDatum(Datum d);
 
 	// convert int16 to datum
-	Datum DDatumFromInt16(int16 i16);
+	inline Datum DDatumFromInt16(int16 i16);
 
 	// convert datum to uint16
-	uint16 UsUint16FromDatum(Datum d);
+	inline uint16 UsUint16FromDatum(Datum d);
 
 	// convert uint16 to datum
-	Datum DDatumFromUint16(uint16 ui16);
+	inline Datum DDatumFromUint16(uint16 ui16);
 
 	// convert datum to int32
-	int32 IInt32FromDatum(Datum d);
+	inline int32 IInt32FromDatum(Datum d);
 
 	// convert int32 to datum
-	Datum DDatumFromInt32(int32 i32);
+	inline Datum DDatumFromInt32(int32 i32);
 
 	// convert datum to uint32
-	uint32 UlUint32FromDatum(Datum d);
+	inline uint32 UlUint32FromDatum(Datum d);
 
 	// convert uint32 to datum
-	Datum DDatumFromUint32(uint32 ui32);
+	inline Datum DDatumFromUint32(uint32 ui32);
 
 	// convert datum to int64
-	int64 LlInt64FromDatum(Datum d);
+	inline int64 LlInt64FromDatum(Datum d);
 
 	// convert int64 to datum
-	Datum DDatumFromInt64(int64 i64);
+	inline Datum DDatumFromInt64(int64 i64);
 
 	// convert datum to uint64
-	uint64 UllUint64FromDatum(Datum d);
+	inline uint64 UllUint64FromDatum(Datum d);
 
 	// convert uint64 to datum
-	Datum DDatumFromUint64(uint64 ui64);
+	inline Datum DDatumFromUint64(uint64 ui64);
 
 	// convert datum to oid
-	Oid OidFromDatum(Datum d);
+	inline Oid OidFromDatum(Datum d);
 
 	// convert datum to generic object with pointer handle
-	void *PvPointerFromDatum(Datum d);
+	inline void *PvPointerFromDatum(Datum d);
 
 	// convert datum to float4
-	float4 FpFloat4FromDatum(Datum d);
+	inline float4 FpFloat4FromDatum(Datum d);
 
 	// convert datum to float8
-	float8 DFloat8FromDatum(Datum d);
+	inline float8 DFloat8FromDatum(Datum d);
 
 	// convert pointer to datum
-	Datum DDatumFromPointer(const void *p);
+	inline Datum DDatumFromPointer(const void *p);
 
 	// does an aggregate exist with the given oid
 	bool FAggregateExists(Oid oid);
@@ -245,6 +251,9 @@ namespace gpdb {
 	// part constraint expression tree
 	Node *PnodePartConstraintRel(Oid oidRel, List **pplDefaultLevels);
 
+	// levels of a partitioned table having default partitions
+	List *PlPartDefaultLevelsRel(Oid oidRel);
+
 	// get the cast function for the specified source and destination types
 	bool FCastFunc(Oid oidSrc, Oid oidDest, bool *is_binary_coercible, Oid *oidCastFunc, CoercionPathType *pathtype);
 	
@@ -351,25 +360,28 @@ namespace gpdb {
 	List *PlCopy(List *list);
 
 	// first cell in a list
-	ListCell *PlcListHead(List *l);
+	inline ListCell *PlcListHead(List *l);
 
 	// last cell in a list
-	ListCell *PlcListTail(List *l);
+	inline ListCell *PlcListTail(List *l);
 
 	// number of items in a list
-	uint32 UlListLength(List *l);
+	inline uint32 UlListLength(List *l);
+
+	// nth cell in a list
+	inline ListCell *PlcListNthCell(List *list, int n);
 
 	// return the nth element in a list of pointers
-	void *PvListNth(List *list, int n);
+	inline void *PvListNth(List *list, int n);
 
 	// return the nth element in a list of ints
-	int IListNth(List *list, int n);
+	inline int IListNth(List *list, int n);
 
 	// return the nth element in a list of oids
-	Oid OidListNth(List *list, int n);
+	inline Oid OidListNth(List *list, int n);
 
 	// check whether the given oid is a member of the given list
-	bool FMemberOid(List *list, Oid oid);
+	inline bool FMemberOid(List *list, Oid oid);
 
 	// free list
 	void FreeList(List *plist);
@@ -632,16 +644,100 @@ namespace gpdb {
 	gpos::ULONG UlLeafPartitions(Oid oidRelation);
 
 	// Does the metadata cache need to be reset (because of a catalog
-	// table has been changed?)
-	bool FMDCacheNeedsReset(void);
+	// table has been changed?) If not, return the relations (a list of
+	// Oids) and the syscaches (a list of cache ids) invalidated since the
+	// last call, whose objects need to be evicted from the cache
+	bool FMDCacheNeedsReset(List **pplRelOids, List **pplCacheIds);
+
+	// register the invalidation callbacks of the metadata cache, if not yet
+	void RegisterMDCacheInvalidationCallbacks(void);
+
+	// is the metadata cache shared by all the sessions enabled?
+	bool FMDCacheSharedEnabled(void);
+
+	// can the current transaction use the shared metadata cache? Not if it
+	// may have changed the catalog
+	bool FMDCacheSharedUsable(void);
+
+	// generation of the shared metadata cache, bumped by every invalidation,
+	// the pending invalidations are processed once it is taken
+	uint32 UlMDCacheSharedGeneration(void);
+
+	// look up an object in the shared metadata cache by its mdid, return a
+	// palloc'd copy of its DXL, along with its kind and the oids it depends
+	// on, or NULL if it is not there
+	char *SzMDCacheSharedLookup(const char *szKey, Size *pulLen, OptMDCacheKind *pkind, Oid *rgoidDeps, int *piDeps);
+
+	// add an object to the shared metadata cache, unless the cache has been
+	// invalidated since the given generation
+	void MDCacheSharedInsert(const char *szKey, const char *szData, Size ulLen, OptMDCacheKind kind, const Oid *rgoidDeps, int iDeps, uint32 ulGeneration);
+
+	// look up the plan of a query in the plan cache, return it with the
+	// literals of the query bound, or NULL if it is not cached
+	PlannedStmt *PplstmtPlanCacheLookup(Query *pquery, OrcaPlanCacheProbe *pprobe);
+
+	// add the plan optimized for a query looked up in the plan cache
+	void PlanCacheInsert(OrcaPlanCacheProbe *pprobe, PlannedStmt *pplstmt);
+
+	// evict the cached plans affected by the given invalidated relations
+	// (a list of Oids) and syscaches (a list of cache ids)
+	void PlanCacheInvalidate(List *plRelOids, List *plCacheIds);
+
+	// evict all the cached plans
+	void PlanCacheReset(void);
 
 	// functions for tracking ORCA memory consumption
 	void *OptimizerAlloc(size_t size);
 
 	void OptimizerFree(void *ptr);
 
+	// scope of a batch of wrapper calls, see GP_WRAP_BATCH_START
+	class CAutoWrapBatch
+	{
+		private:
+			// was a batch already running when this one started
+			bool m_fOuterBatch;
+
+		public:
+			CAutoWrapBatch();
+
+			~CAutoWrapBatch();
+	};
+
 } //namespace gpdb
 
+// Run a block of code calling many wrapper functions in a single exception
+// frame, instead of one frame per call: the wrappers called in the block skip
+// their own sigsetjmp, and a backend error raised by any of them is turned
+// into a GPDB exception at the end of the block. The error longjmps straight
+// out of the frames of the block, so these must not hold objects with
+// destructors, nor call code that does.
+//
+// Since the wrappers rely on the batch frame, a block may only contain:
+//   - gpdb:: wrapper calls, which must not count on recovering from an
+//     error themselves: the error always ends the whole block;
+//   - plain C code on backend nodes, such as field accesses and the list
+//     macros, that cannot raise a backend error;
+//   - GPOS_ASSERT, whose C++ exception unwinds the batch like any other.
+// In particular it must not call into ORCA or GPOS, nor make backend calls
+// other than through the wrappers.
+#define GP_WRAP_BATCH_START	\
+	{	\
+		sigjmp_buf batch_sigjmp_buf;	\
+		CAutoExceptionStack aesBatch((void **) &PG_exception_stack, (void**) &error_context_stack);	\
+		gpdb::CAutoWrapBatch awb;	\
+		if (0 == sigsetjmp(batch_sigjmp_buf, 0))	\
+		{	\
+			aesBatch.SetLocalJmp(&batch_sigjmp_buf)
+
+#define GP_WRAP_BATCH_END	\
+		}	\
+		else	\
+		{	\
+			GPOS_RAISE(gpdxl::ExmaGPDB, gpdxl::ExmiGPDBError);	\
+		}	\
+	}
+
 #define ForEach(cell, l)	\
 	for ((cell) = gpdb::PlcListHead(l); (cell) != NULL; (cell) = lnext(cell))
 
@@ -706,6 +802,370 @@ extern PGDLLIMPORT Node *newNodeMacroHolder;
 
 #define PStrDup(str) gpdb::SzMemoryContextStrdup(CurrentMemoryContext, (str))
 
+// Pure accessors, which cannot raise a backend error, are inlined and run
+// without the exception frame of the other wrappers
+
+inline
+bool
+gpdb::FBoolFromDatum
+	(
+	Datum d
+	)
+{
+	return DatumGetBool(d);
+}
+
+inline
+Datum
+gpdb::DDatumFromBool
+	(
+	bool b
+	)
+{
+	return BoolGetDatum(b);
+}
+
+inline
+char
+gpdb::CCharFromDatum
+	(
+	Datum d
+	)
+{
+	return DatumGetChar(d);
+}
+
+inline
+Datum
+gpdb::DDatumFromChar
+	(
+	char c
+	)
+{
+	return CharGetDatum(c);
+}
+
+inline
+int8
+gpdb::CInt8FromDatum
+	(
+	Datum d
+	)
+{
+	return DatumGetInt8(d);
+}
+
+inline
+Datum
+gpdb::DDatumFromInt8
+	(
+	int8 i8
+	)
+{
+	return Int8GetDatum(i8);
+}
+
+inline
+uint8
+gpdb::UcUint8FromDatum
+	(
+	Datum d
+	)
+{
+	return DatumGetUInt8(d);
+}
+
+inline
+Datum
+gpdb::DDatumFromUint8
+	(
+	uint8 ui8
+	)
+{
+	return UInt8GetDatum(ui8);
+}
+
+inline
+int16
+gpdb::SInt16FromDatum
+	(
+	Datum d
+	)
+{
+	return DatumGetInt16(d);
+}
+
+inline
+Datum
+gpdb::DDatumFromInt16
+	(
+	int16 i16
+	)
+{
+	return Int16GetDatum(i16);
+}
+
+inline
+uint16
+gpdb::UsUint16FromDatum
+	(
+	Datum d
+	)
+{
+	return DatumGetUInt16(d);
+}
+
+inline
+Datum
+gpdb::DDatumFromUint16
+	(
+	uint16 ui16
+	)
+{
+	return UInt16GetDatum(ui16);
+}
+
+inline
+int32
+gpdb::IInt32FromDatum
+	(
+	Datum d
+	)
+{
+	return DatumGetInt32(d);
+}
+
+inline
+Datum
+gpdb::DDatumFromInt32
+	(
+	int32 i32
+	)
+{
+	return Int32GetDatum(i32);
+}
+
+inline
+uint32
+gpdb::UlUint32FromDatum
+	(
+	Datum d
+	)
+{
+	return DatumGetUInt32(d);
+}
+
+inline
+Datum
+gpdb::DDatumFromUint32
+	(
+	uint32 ui32
+	)
+{
+	return UInt32GetDatum(ui32);
+}
+
+inline
+int64
+gpdb::LlInt64FromDatum
+	(
+	Datum d
+	)
+{
+	return DatumGetInt64(d);
+}
+
+inline
+Datum
+gpdb::DDatumFromInt64
+	(
+	int64 i64
+	)
+{
+	return Int64GetDatum(i64);
+}
+
+inline
+uint64
+gpdb::UllUint64FromDatum
+	(
+	Datum d
+	)
+{
+	return DatumGetUInt64(d);
+}
+
+inline
+Datum
+gpdb::DDatumFromUint64
+	(
+	uint64 ui64
+	)
+{
+	return UInt64GetDatum(ui64);
+}
+
+inline
+Oid
+gpdb::OidFromDatum
+	(
+	Datum d
+	)
+{
+	return DatumGetObjectId(d);
+}
+
+inline
+void *
+gpdb::PvPointerFromDatum
+	(
+	Datum d
+	)
+{
+	return DatumGetPointer(d);
+}
+
+inline
+float4
+gpdb::FpFloat4FromDatum
+	(
+	Datum d
+	)
+{
+	return DatumGetFloat4(d);
+}
+
+inline
+float8
+gpdb::DFloat8FromDatum
+	(
+	Datum d
+	)
+{
+	return DatumGetFloat8(d);
+}
+
+inline
+Datum
+gpdb::DDatumFromPointer
+	(
+	const void *p
+	)
+{
+	return PointerGetDatum(p);
+}
+
+inline
+ListCell *
+gpdb::PlcListHead
+	(
+	List *l
+	)
+{
+	return (NIL == l) ? NULL : l->head;
+}
+
+inline
+ListCell *
+gpdb::PlcListTail
+	(
+	List *l
+	)
+{
+	return (NIL == l) ? NULL : l->tail;
+}
+
+inline
+uint32
+gpdb::UlListLength
+	(
+	List *l
+	)
+{
+	return (NIL == l) ? 0 : l->length;
+}
+
+// nth cell of a list, as list_nth_cell() in list.c
+inline
+ListCell *
+gpdb::PlcListNthCell
+	(
+	List *list,
+	int n
+	)
+{
+	Assert(NIL != list);
+	Assert(0 <= n && n < list->length);
+
+	if (n == list->length - 1)
+	{
+		return list->tail;
+	}
+
+	ListCell *plc = list->head;
+	for (; 0 < n; n--)
+	{
+		plc = plc->next;
+	}
+
+	return plc;
+}
+
+inline
+void *
+gpdb::PvListNth
+	(
+	List *list,
+	int n
+	)
+{
+	Assert(IsA(list, List));
+	return lfirst(PlcListNthCell(list, n));
+}
+
+inline
+int
+gpdb::IListNth
+	(
+	List *list,
+	int n
+	)
+{
+	Assert(IsA(list, IntList));
+	return lfirst_int(PlcListNthCell(list, n));
+}
+
+inline
+Oid
+gpdb::OidListNth
+	(
+	List *list,
+	int n
+	)
+{
+	Assert(IsA(list, OidList));
+	return lfirst_oid(PlcListNthCell(list, n));
+}
+
+inline
+bool
+gpdb::FMemberOid
+	(
+	List *list,
+	Oid oid
+	)
+{
+	for (ListCell *plc = PlcListHead(list); NULL != plc; plc = plc->next)
+	{
+		if (lfirst_oid(plc) == oid)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
 #endif // !GPDB_gpdbwrappers_H
 
 // EOF
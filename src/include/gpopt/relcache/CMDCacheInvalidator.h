@@ -0,0 +1,138 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2017 Pivotal Software, Inc.
+//
+//	@filename:
+//		CMDCacheInvalidator.h
+//
+//	@doc:
+//		Eviction of the metadata cache objects affected by catalog changes
+//
+//	@test:
+//
+//
+//---------------------------------------------------------------------------
+
+#ifndef GPMD_CMDCacheInvalidator_H
+#define GPMD_CMDCacheInvalidator_H
+
+#include "postgres.h"
+#include "utils/optmdcache.h"
+
+#include "gpos/base.h"
+#include "gpos/common/CHashMap.h"
+
+#include "naucrates/md/IMDId.h"
+#include "naucrates/md/IMDCacheObject.h"
+
+struct List;
+
+namespace gpmd
+{
+	using namespace gpos;
+
+	//---------------------------------------------------------------------------
+	//	@class:
+	//		CMDCacheInvalidator
+	//
+	//	@doc:
+	//		Registry of the objects in the metadata cache, by the oids of the
+	//		catalog objects they are translated from and by their kind, used to
+	//		evict only the objects affected by the relcache and syscache
+	//		invalidations instead of resetting the whole cache.
+	//
+	//		Every object translated by the relcache provider is registered
+	//		under the oids it depends on: its own oid, along with the oid of
+	//		the relation of an index, trigger or check constraint, statistics
+	//		under the oid of their relation, and casts and comparisons under
+	//		the oids of their types. The same kind and oids are kept along
+	//		with the objects in the shared metadata cache (see optmdcache.c),
+	//		so that an object found there is registered here as well.
+	//
+	//		A relcache invalidation evicts the objects
+	//		registered under the relation and under the root of its partitioned
+	//		table. A syscache invalidation carries no oid, so it evicts all the
+	//		objects of the kinds translated from the catalog table of the cache.
+	//
+	//---------------------------------------------------------------------------
+	class CMDCacheInvalidator
+	{
+		private:
+			// map of an oid to the objects registered under it
+			typedef CHashMap<ULONG, DrgPmdid, gpos::UlHash<ULONG>, gpos::FEqual<ULONG>,
+				CleanupDelete<ULONG>, CleanupRelease<DrgPmdid> > HMUlPdrgpmdid;
+
+			// memory pool of the registry
+			static
+			IMemoryPool *m_pmp;
+
+			// objects registered under each oid
+			static
+			HMUlPdrgpmdid *m_phmulpdrgpmdid;
+
+			// objects registered of each kind
+			static
+			DrgPmdid *m_rgpdrgpmdidKind[OPTMDCACHE_NUM_KINDS];
+
+			// number of objects registered since the last reset
+			static
+			ULONG m_ulRegistered;
+
+			// has a partitioned table been registered
+			static
+			BOOL m_fPartitioned;
+
+			// copy of the given mdid in the memory pool of the registry
+			static
+			IMDId *PmdidCopy(IMDId *pmdid);
+
+			// kind of the given cached object
+			static
+			OptMDCacheKind Emdk(const IMDCacheObject *pimdobj);
+
+			// register an object under the given oid
+			static
+			void Register(OID oid, IMDId *pmdid);
+
+			// evict an object from the metadata cache
+			static
+			void Evict(IMDId *pmdid);
+
+			// evict the objects registered under the given oid
+			static
+			void EvictOid(OID oid);
+
+			// evict the objects registered of the given kind
+			static
+			void EvictKind(OptMDCacheKind emdk);
+
+			// release the registry
+			static
+			void Release();
+
+		public:
+
+			// reset the registry, to be called whenever the metadata cache is
+			// initialized or reset
+			static
+			void Reset();
+
+			// kind of an object translated by the relcache provider and the
+			// oids it depends on, returns the number of oids
+			static
+			ULONG UlDeps(IMDId *pmdid, const IMDCacheObject *pimdobj, OptMDCacheKind *pemdk, Oid *rgoidDeps, BOOL *pfPartitioned);
+
+			// register an object of the given kind under the oids it depends on
+			static
+			void Register(IMDId *pmdid, OptMDCacheKind emdk, const Oid *rgoidDeps, ULONG ulDeps, BOOL fPartitioned);
+
+			// evict the objects affected by the given invalidated relations and
+			// syscaches, return false if the whole cache needs to be reset instead
+			static
+			BOOL FEvict(List *plRelOids, List *plCacheIds);
+	};
+}
+
+#endif // !GPMD_CMDCacheInvalidator_H
+
+// EOF
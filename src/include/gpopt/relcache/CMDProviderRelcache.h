@@ -52,6 +52,10 @@ namespace gpmd
 			// private copy ctor
 			CMDProviderRelcache(const CMDProviderRelcache&);
 
+			// key of the given object in the shared metadata cache
+			static
+			BOOL FSharedKey(IMDId *pmdid, CHAR *szKey);
+
 		public:
 			// ctor/dtor
 			explicit
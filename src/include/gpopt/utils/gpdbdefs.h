@@ -52,6 +52,7 @@ extern "C" {
 #include "utils/numeric.h"
 #include "optimizer/tlist.h"
 #include "optimizer/planmain.h"
+#include "optimizer/orcaplancache.h"
 #include "nodes/makefuncs.h"
 #include "catalog/pg_operator.h"
 #include "lib/stringinfo.h"
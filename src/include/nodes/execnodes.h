@@ -2218,6 +2218,14 @@ typedef struct MergeJoinState
 typedef struct HashJoinTupleData *HashJoinTuple;
 typedef struct HashJoinTableData *HashJoinTable;
 
+typedef struct ExecHashGetHashValueCodegenInfo
+{
+	/* Pointer to store ExecHashGetHashValueCodegen from Codegen */
+	void* code_generator;
+	/* Function pointer that points to either regular or generated ExecHashGetHashValue */
+	ExecHashGetHashValueFn ExecHashGetHashValue_fn;
+} ExecHashGetHashValueCodegenInfo;
+
 typedef struct HashJoinState
 {
 	JoinState	js;				/* its first field is NodeTag */
@@ -2244,6 +2252,11 @@ typedef struct HashJoinState
 	/* set if the operator created workfiles */
 	bool workfiles_created;
 	bool reuse_hashtable; /* Do we need to preserve hash table to support rescan */
+
+#ifdef USE_CODEGEN
+	/* hashes hj_OuterHashKeys */
+	ExecHashGetHashValueCodegenInfo ExecHashGetHashValue_gen_info;
+#endif
 } HashJoinState;
 
 
@@ -2319,6 +2332,14 @@ extern void shareinput_create_bufname_prefix(char* p, int size, int share_id);
  *	 SortState information
  * ----------------
  */
+typedef struct TupsortCompareDatumCodegenInfo
+{
+	/* Pointer to store TupsortCompareDatumCodegen from Codegen */
+	void* code_generator;
+	/* Function pointer that points to either regular or generated tupsort_compare_datum */
+	TupsortCompareDatumFn tupsort_compare_datum_fn;
+} TupsortCompareDatumCodegenInfo;
+
 typedef struct SortState
 {
 	ScanState	ss;				/* its first field is NodeTag */
@@ -2333,6 +2354,10 @@ typedef struct SortState
 
 	void	   *share_lk_ctxt;
 
+#ifdef USE_CODEGEN
+	/* compares the sort keys of the MK sort */
+	TupsortCompareDatumCodegenInfo tupsort_compare_datum_gen_info;
+#endif
 } SortState;
 
 /* ---------------------
@@ -2356,10 +2381,43 @@ typedef struct AdvanceAggregatesCodegenInfo
 	AdvanceAggregatesFn AdvanceAggregates_fn;
 } AdvanceAggregatesCodegenInfo;
 
+typedef struct AdvanceAggregatesBatchCodegenInfo
+{
+	/* Pointer to store AdvanceAggregatesBatchCodegen from Codegen */
+	void* code_generator;
+	/* Function pointer that points to either regular or generated advance_aggregates_batch */
+	AdvanceAggregatesBatchFn AdvanceAggregatesBatch_fn;
+} AdvanceAggregatesBatchCodegenInfo;
+
+typedef struct CalcHashValueCodegenInfo
+{
+	/* Pointer to store CalcHashValueCodegen from Codegen */
+	void* code_generator;
+	/* Function pointer that points to either regular or generated calc_hash_value */
+	CalcHashValueFn calc_hash_value_fn;
+} CalcHashValueCodegenInfo;
+
 /* these structs are private in nodeAgg.c: */
 typedef struct AggStatePerAggData *AggStatePerAgg;
 typedef struct AggStatePerGroupData *AggStatePerGroup;
 
+/*
+ * AggInputBatch -- aggregate inputs collected column by column
+ *
+ * In AGG_PLAIN mode, the input values of simple aggregates can be collected
+ * for AGG_INPUT_BATCH_SIZE input tuples before the transition functions are
+ * run over them (see advance_aggregates_batch).  The column of aggregate
+ * aggno starts at values[aggno * AGG_INPUT_BATCH_SIZE].
+ */
+#define AGG_INPUT_BATCH_SIZE 1024
+
+typedef struct AggInputBatch
+{
+	int			nrows;			/* number of rows collected so far */
+	Datum	   *values;			/* input values, numaggs columns */
+	bool	   *isnull;			/* null flags, same layout as values */
+} AggInputBatch;
+
 typedef enum HashAggStatus
 {
 	HASHAGG_BEFORE_FIRST_PASS,
@@ -2414,8 +2472,13 @@ typedef struct AggState
 	/* set if the operator created workfiles */
 	bool		workfiles_created;
 
+	/* input batch for AGG_PLAIN mode, NULL if the input is not batched */
+	AggInputBatch *inputbatch;
+
 #ifdef USE_CODEGEN
 	AdvanceAggregatesCodegenInfo AdvanceAggregates_gen_info;
+	AdvanceAggregatesBatchCodegenInfo AdvanceAggregatesBatch_gen_info;
+	CalcHashValueCodegenInfo calc_hash_value_gen_info;
 #endif
 } AggState;
 
@@ -2512,6 +2575,11 @@ typedef struct HashState
 	bool		hs_quit_if_hashkeys_null;	/* quit building hash table if hashkeys are all null */
 	bool		hs_hashkeys_null;	/* found an instance wherein hashkeys are all null */
 	/* hashkeys is same as parent's hj_InnerHashKeys */
+
+#ifdef USE_CODEGEN
+	/* hashes hashkeys */
+	ExecHashGetHashValueCodegenInfo ExecHashGetHashValue_gen_info;
+#endif
 } HashState;
 
 /* ----------------
@@ -2679,6 +2747,11 @@ typedef struct MotionState
 	Oid		   *outputFunArray;	/* output functions for each column (debug only) */
 
 	int			numInputSegs;	/* the number of segments on the sending slice */
+
+#ifdef USE_CODEGEN
+	/* compares the sort keys of the mk heap of a sorted receiver */
+	TupsortCompareDatumCodegenInfo tupsort_compare_datum_gen_info;
+#endif
 } MotionState;
 
 /*
@@ -0,0 +1,46 @@
+/*-------------------------------------------------------------------------
+ *
+ * orcaplancache.h
+ *	  prototypes for the plan cache of the ORCA query planner
+ *
+ * Portions Copyright (c) 2017-Present, Pivotal Software, Inc.
+ *
+ *
+ * IDENTIFICATION
+ *			src/include/optimizer/orcaplancache.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef ORCAPLANCACHE_H
+#define ORCAPLANCACHE_H
+
+#include "nodes/parsenodes.h"
+#include "nodes/plannodes.h"
+#include "portability/instr_time.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A query looked up in the plan cache, to add its plan to the cache once
+ * optimized.
+ */
+typedef struct OrcaPlanCacheProbe
+{
+	char	   *key;			/* normalized query, NULL if not cacheable */
+	uint32		hashkey;		/* hash of the key */
+	List	   *literals;		/* Consts stripped from the query */
+	instr_time	starttime;		/* when the lookup started */
+} OrcaPlanCacheProbe;
+
+extern PlannedStmt *OrcaPlanCacheLookup(Query *query, OrcaPlanCacheProbe *probe);
+extern void OrcaPlanCacheInsert(OrcaPlanCacheProbe *probe, PlannedStmt *plan);
+extern void OrcaPlanCacheInvalidate(List *relids, List *cacheids);
+extern void OrcaPlanCacheReset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ORCAPLANCACHE_H */
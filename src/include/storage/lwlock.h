@@ -101,6 +101,7 @@ typedef enum LWLockId
 	RelfilenodeGenLock,
 	FilespaceHashLock,
 	TablespaceHashLock,
+	OptMDCacheLock,
 #ifdef USE_SEGWALREP
 	GpReplicationConfigFileLock,
 #endif
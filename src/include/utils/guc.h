@@ -407,6 +407,7 @@ extern bool optimizer_minidump;
 extern int  optimizer_cost_model;
 extern bool optimizer_metadata_caching;
 extern int	optimizer_mdcache_size;
+extern int	optimizer_plan_cache_size;
 
 /* Optimizer debugging GUCs */
 extern bool optimizer_print_query;
@@ -518,7 +519,12 @@ extern bool init_codegen;
 extern bool codegen;
 extern bool codegen_validate_functions;
 extern int codegen_varlen_tolerance;
+extern int codegen_module_cache_size;
+extern int codegen_max_parameter_regenerations;
 extern int codegen_optimization_level;
+extern bool codegen_async_compile;
+extern bool codegen_advance_aggregates_batch;
+extern double codegen_cost_threshold;
 
 /**
  * Enable logging of DPE match in optimizer.
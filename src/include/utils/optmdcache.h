@@ -0,0 +1,75 @@
+/*-------------------------------------------------------------------------
+ *
+ * optmdcache.h
+ *	  Metadata cache of the ORCA optimizer shared by all the sessions.
+ *
+ * Portions Copyright (c) 2017-Present Pivotal Software, Inc.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/include/utils/optmdcache.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef OPTMDCACHE_H
+#define OPTMDCACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Kinds of metadata objects. A syscache invalidation carries no oid, it
+ * invalidates all the objects of the kinds translated from its catalog table.
+ */
+typedef enum OptMDCacheKind
+{
+	OPTMDCACHE_KIND_REL = 0,
+	OPTMDCACHE_KIND_INDEX,
+	OPTMDCACHE_KIND_TYPE,
+	OPTMDCACHE_KIND_OP,
+	OPTMDCACHE_KIND_FUNC,
+	OPTMDCACHE_KIND_AGG,
+	OPTMDCACHE_KIND_TRIGGER,
+	OPTMDCACHE_KIND_CHECKCONSTRAINT,
+	OPTMDCACHE_KIND_STATS,
+	OPTMDCACHE_KIND_CAST,
+	OPTMDCACHE_KIND_SCCMP,
+
+	OPTMDCACHE_NUM_KINDS
+} OptMDCacheKind;
+
+#define OPTMDCACHE_KIND_MASK(kind)	(1 << (kind))
+#define OPTMDCACHE_ALL_KINDS		((1 << OPTMDCACHE_NUM_KINDS) - 1)
+
+/* Max length of the key of an object, its mdid */
+#define OPTMDCACHE_KEY_LEN		64
+
+/* Max number of oids an object depends on */
+#define OPTMDCACHE_MAX_DEPS		4
+
+/* GUC */
+extern int	optimizer_mdcache_shared_size;
+
+extern uint32 OptMDCacheSyscacheKinds(int cacheid);
+
+extern Size OptMDCacheShmemSize(void);
+extern void OptMDCacheShmemInit(void);
+
+extern bool OptMDCacheSharedEnabled(void);
+extern bool OptMDCacheSharedUsable(void);
+extern uint32 OptMDCacheGeneration(void);
+extern char *OptMDCacheLookup(const char *key, Size *len, OptMDCacheKind *kind,
+							  Oid *deps, int *ndeps);
+extern void OptMDCacheInsert(const char *key, const char *data, Size len,
+							 OptMDCacheKind kind, const Oid *deps, int ndeps,
+							 uint32 generation);
+extern void OptMDCacheInvalidateOid(Oid oid);
+extern void OptMDCacheInvalidateKinds(uint32 kinds);
+extern void OptMDCacheInvalidateAll(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif   /* OPTMDCACHE_H */
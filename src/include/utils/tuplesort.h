@@ -555,6 +555,15 @@ switcheroo_tuplesort_set_gpmon(switcheroo_Tuplesortstate *state,
 		tuplesort_set_gpmon_pg((Tuplesortstate_pg *) state, gpmon_pkt, gpmon_tick);
 }
 
+/* There is no Postgres variant of this, the regular tuplesort uses fmgr */
+static inline void
+switcheroo_tuplesort_set_compare_datum(switcheroo_Tuplesortstate *state,
+									   TupsortCompareDatumFn compare_fn)
+{
+	if (state->is_mk_tuplesortstate)
+		tuplesort_set_compare_datum_mk((Tuplesortstate_mk *) state, compare_fn);
+}
+
 /* these are in tuplesort.h */
 #undef Tuplesortstate
 #define Tuplesortstate switcheroo_Tuplesortstate
@@ -588,6 +597,7 @@ switcheroo_tuplesort_set_gpmon(switcheroo_Tuplesortstate *state,
 #define tuplesort_restorepos_pos switcheroo_tuplesort_restorepos_pos
 #define tuplesort_set_instrument switcheroo_tuplesort_set_instrument
 #define tuplesort_set_gpmon switcheroo_tuplesort_set_gpmon
+#define tuplesort_set_compare_datum switcheroo_tuplesort_set_compare_datum
 
 #endif
 
@@ -16,6 +16,7 @@
 #ifndef TUPLESORT_MK_H
 #define TUPLESORT_MK_H
 
+#include "access/itup.h"
 #include "nodes/execnodes.h"
 #include "utils/workfile_mgr.h"
 #include "gpmon/gpmon.h"
@@ -90,5 +91,8 @@ tuplesort_set_gpmon_mk(Tuplesortstate_mk *state,
 					gpmon_packet_t *gpmon_pkt,
 					int *gpmon_tick);
 
+extern void tuplesort_set_compare_datum_mk(Tuplesortstate_mk *state,
+							TupsortCompareDatumFn compare_fn);
+
 
 #endif   /* TUPLESORT_MK_H */
@@ -266,6 +266,12 @@ typedef struct MKContext {
      */
     MKFreeTuple freeTup;
 
+    /*
+     * Compares the prepared datums of a level.  This is tupsort_compare_datum
+     * unless the caller installed a comparator generated for its sort keys.
+     */
+    MKCompare compareDatum;
+
 
     /* as calculated by estimateExtraSpace.  This is only valid before we've switched to buildruns mode
      *   It is only calculate when the fetchForPrep fn is set as well
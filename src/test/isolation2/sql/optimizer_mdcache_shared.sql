@@ -0,0 +1,44 @@
+-- With optimizer_mdcache_shared_size > 0, the metadata objects translated by
+-- ORCA are shared by all the sessions. A transaction that changes the catalog
+-- must not share objects showing its changes, which may roll back, and a
+-- session must not use objects translated before another session changed
+-- the catalog.
+
+1:set optimizer = on;
+2:set optimizer = on;
+1:drop table if exists mdcache_shared;
+1:create table mdcache_shared (a int, b int) distributed by (a);
+1:insert into mdcache_shared values (1, 1);
+
+-- A column dropped in a transaction that rolls back
+1:begin;
+1:alter table mdcache_shared drop column b;
+1:select * from mdcache_shared;
+2&:select * from mdcache_shared where b = 1;
+1:rollback;
+2<:
+1:select * from mdcache_shared where b = 1;
+
+-- An index created in a transaction that rolls back
+1:begin;
+1:create index mdcache_shared_b on mdcache_shared (b);
+1:select * from mdcache_shared where b = 1;
+2:select * from mdcache_shared where b = 1;
+1:rollback;
+2:select * from mdcache_shared where b = 1;
+
+-- A column added by another session, once it commits
+1:select * from mdcache_shared;
+2:begin;
+2:alter table mdcache_shared add column c int default 2;
+1&:select * from mdcache_shared where c = 2;
+2:commit;
+1<:
+2:select * from mdcache_shared where c = 2;
+
+-- A column dropped by another session
+2:alter table mdcache_shared drop column b;
+1:select * from mdcache_shared;
+2:select * from mdcache_shared;
+
+1:drop table mdcache_shared;
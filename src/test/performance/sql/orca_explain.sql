@@ -0,0 +1,3 @@
+-- The duration of this test is the time ORCA takes to optimize the queries
+SET optimizer = on;
+SELECT orca_perf_explain(500);
@@ -0,0 +1,32 @@
+-- A wide table, so that the plans ORCA translates have long target lists
+CREATE OR REPLACE FUNCTION orca_perf_setup(ncols int) RETURNS void AS $$
+DECLARE
+	cols text := 'c1 int';
+BEGIN
+	FOR i IN 2..ncols LOOP
+		cols := cols || ', c' || i || ' int';
+	END LOOP;
+	EXECUTE 'DROP TABLE IF EXISTS orca_perf_wide';
+	EXECUTE 'CREATE TABLE orca_perf_wide (' || cols || ') DISTRIBUTED BY (c1)';
+END;
+$$ LANGUAGE plpgsql;
+SELECT orca_perf_setup(200);
+
+-- Optimize, without running it, a query scanning a shared CTE of the wide
+-- table and filtering on a long IN list, the given number of times
+CREATE OR REPLACE FUNCTION orca_perf_explain(iterations int) RETURNS void AS $$
+DECLARE
+	inlist text := '1';
+	r record;
+BEGIN
+	FOR i IN 2..1000 LOOP
+		inlist := inlist || ', ' || i;
+	END LOOP;
+	FOR i IN 1..iterations LOOP
+		FOR r IN EXECUTE 'EXPLAIN WITH w AS (SELECT * FROM orca_perf_wide WHERE c2 IN (' || inlist || ')) '
+						 'SELECT * FROM w a JOIN w b ON a.c1 = b.c3' LOOP
+			NULL;
+		END LOOP;
+	END LOOP;
+END;
+$$ LANGUAGE plpgsql;
@@ -0,0 +1,63 @@
+--
+-- Plan cache of GPORCA: a plan is reused, with the new literals bound, for a
+-- query that differs only in its literals, and evicted by catalog changes.
+-- Cache hits and misses are logged with optimizer_print_optimization_stats.
+--
+-- start_matchsubs
+-- m/GPORCA plan cache \w+:/
+-- s/(GPORCA plan cache \w+):.*/$1/
+-- end_matchsubs
+-- start_matchignore
+-- m/^LOG:.*,THD\d+,/
+-- end_matchignore
+create schema orca_plan_cache;
+set search_path = orca_plan_cache;
+
+create table pc (a int, b int) distributed by (a);
+insert into pc select i, i % 10 from generate_series(1, 100) i;
+analyze pc;
+
+set optimizer_plan_cache_size = 16;
+set optimizer_print_optimization_stats = on;
+set log_statement = 'none';
+set log_min_duration_statement = -1;
+set client_min_messages = 'log';
+
+-- The first plan is a candidate, confirmed by the second optimization with
+-- other literals, and reused from then on with the literals bound
+select count(*) from pc where a <= 10;
+select count(*) from pc where a <= 20;
+select count(*) from pc where a <= 30;
+select count(*) from pc where a <= 5;
+
+-- Not with other planner settings
+set gp_segments_for_planner = 2;
+select count(*) from pc where a <= 40;
+reset gp_segments_for_planner;
+select count(*) from pc where a <= 45;
+
+-- Evicted when the table changes
+set client_min_messages = 'notice';
+alter table pc add column c int default 0;
+set client_min_messages = 'log';
+select count(*) from pc where a <= 50;
+select count(*) from pc where a <= 60;
+select count(*) from pc where a <= 70;
+
+-- Evicted when the statistics change, even though the table does not
+set client_min_messages = 'notice';
+analyze pc;
+set client_min_messages = 'log';
+select count(*) from pc where a <= 80;
+select count(*) from pc where a <= 90;
+select count(*) from pc where a <= 100;
+
+reset client_min_messages;
+reset log_min_duration_statement;
+reset log_statement;
+reset optimizer_print_optimization_stats;
+reset optimizer_plan_cache_size;
+
+-- start_ignore
+drop schema orca_plan_cache cascade;
+-- end_ignore
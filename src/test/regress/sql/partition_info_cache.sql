@@ -0,0 +1,51 @@
+--
+-- The partition info of a partitioned table is cached, by root, for ORCA to
+-- translate the table and its indexes. Check that it follows the changes to
+-- the partitions, and that the part constraints are not needed without
+-- indexes but for the default partitions.
+--
+set client_min_messages = warning;
+drop table if exists pic;
+drop table if exists pic_ex;
+
+create table pic (a int, b int) distributed by (a)
+partition by range (b) (start (0) end (30) every (10));
+insert into pic select i, i from generate_series(0, 29) i;
+
+-- Without indexes
+select count(*) from pic where b >= 10;
+
+alter table pic add partition start (30) end (40);
+insert into pic select i, i from generate_series(30, 39) i;
+select count(*) from pic where b >= 10;
+
+alter table pic add default partition other;
+insert into pic values (100, 100);
+select count(*) from pic where b >= 10;
+select count(*) from pic where b = 100;
+
+alter table pic drop partition for (0);
+select count(*) from pic;
+
+create table pic_ex (a int, b int) distributed by (a);
+insert into pic_ex select i, 15 from generate_series(1, 5) i;
+alter table pic exchange partition for (10) with table pic_ex;
+select count(*) from pic where b between 10 and 19;
+select count(*) from pic_ex;
+
+-- With indexes, the part constraints are used
+create index pic_b on pic (b);
+select count(*) from pic where b = 15;
+select count(*) from pic where b = 100;
+
+alter table pic drop default partition;
+select count(*) from pic where b = 100;
+
+alter table pic add partition start (40) end (50);
+insert into pic select i, i from generate_series(40, 49) i;
+select count(*) from pic where b = 45;
+select count(*) from pic where b >= 10;
+
+drop table pic;
+drop table pic_ex;
+reset client_min_messages;
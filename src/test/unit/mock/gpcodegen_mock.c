@@ -70,6 +70,15 @@ CodeGeneratorManagerGetExplainString(void* manager)
 	return NULL;
 }
 
+/*
+ * Fill in the time the manager spent generating and compiling code so far
+ */
+void
+CodeGeneratorManagerGetTimes(void* manager, CodegenTimes* times)
+{
+	elog(ERROR, "mock implementation of CodeGeneratorManager_GetTimes called");
+}
+
 // get the active code generator manager
 void*
 GetActiveCodeGeneratorManager()
@@ -120,3 +129,24 @@ AdvanceAggregatesCodegenEnroll(AdvanceAggregatesFn regular_func_ptr,
 	return NULL;
 }
 
+// Enroll and returns the pointer to AdvanceAggregatesBatchGenerator
+void*
+AdvanceAggregatesBatchCodegenEnroll(AdvanceAggregatesBatchFn regular_func_ptr,
+		AdvanceAggregatesBatchFn* ptr_to_regular_func_ptr,
+		struct AggState *aggstate) {
+	*ptr_to_regular_func_ptr = regular_func_ptr;
+	elog(ERROR, "mock implementation of AdvanceAggregatesBatchCodegenEnroll called");
+	return NULL;
+}
+
+
+// Enroll and returns the pointer to TupsortCompareDatumGenerator
+void*
+TupsortCompareDatumCodegenEnroll(TupsortCompareDatumFn regular_func_ptr,
+		TupsortCompareDatumFn* ptr_to_regular_func_ptr,
+		int nkeys,
+		Oid *sort_operators) {
+	*ptr_to_regular_func_ptr = regular_func_ptr;
+	elog(ERROR, "mock implementation of TupsortCompareDatumCodegenEnroll called");
+	return NULL;
+}